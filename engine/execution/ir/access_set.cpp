@@ -121,3 +121,351 @@ d_bool dom_detect_access_conflicts(const dom_access_set *a, const dom_access_set
     }
     return D_FALSE;
 }
+
+/* ---- Conflict index ---- */
+
+typedef struct dom_access_conflict_span {
+    u64 start_id;
+    u64 end_id;
+    u64 max_end_id;    /* largest end_id of this and every earlier span */
+} dom_access_conflict_span;
+
+/* Index ranges sorted by start_id. A range [s, e] overlaps a span iff the
+ * span starts at or before e and ends at or after s, so the spans starting
+ * at or before e are a prefix and the running max_end_id decides it with one
+ * binary search. Unlike a merged union this stays exact for inverted ranges,
+ * which ranges_overlap_index does not treat as empty. */
+typedef struct dom_access_conflict_spans {
+    dom_access_conflict_span *items;
+    u32 count;
+    u32 capacity;
+} dom_access_conflict_spans;
+
+/* Span storage stays with the table slot, so clearing keeps it. */
+struct dom_access_conflict_bucket {
+    u32 component_id;
+    u32 field_id;
+    u32 used;
+    u32 touched_sets;  /* non-index ranges of any kind of access */
+    u32 written_sets;  /* non-index write ranges */
+    dom_access_conflict_spans touched;  /* every index range */
+    dom_access_conflict_spans written;  /* index write ranges */
+};
+
+static d_bool range_is_index(const dom_access_range *r) {
+    return (r->kind == DOM_RANGE_INDEX_RANGE || r->kind == DOM_RANGE_SINGLE) ? D_TRUE : D_FALSE;
+}
+
+static d_bool set_is_malformed(const dom_access_set *set) {
+    return ((set->read_count > 0u && !set->read_ranges) ||
+            (set->write_count > 0u && !set->write_ranges) ||
+            (set->reduce_count > 0u && !set->reduce_ranges)) ? D_TRUE : D_FALSE;
+}
+
+static u32 bucket_hash(u32 component_id, u32 field_id) {
+    u32 h = component_id * 0x9E3779B1u;
+    h ^= field_id + 0x7F4A7C15u + (h << 6) + (h >> 2);
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+static const dom_access_conflict_bucket *bucket_find(const dom_access_conflict_index *idx,
+                                                     u32 component_id,
+                                                     u32 field_id) {
+    u32 mask;
+    u32 slot;
+    if (idx->bucket_capacity == 0u) {
+        return 0;
+    }
+    mask = idx->bucket_capacity - 1u;
+    slot = bucket_hash(component_id, field_id) & mask;
+    while (idx->buckets[slot].used) {
+        const dom_access_conflict_bucket *b = &idx->buckets[slot];
+        if (b->component_id == component_id && b->field_id == field_id) {
+            return b;
+        }
+        slot = (slot + 1u) & mask;
+    }
+    return 0;
+}
+
+static void spans_reset(dom_access_conflict_spans *s) {
+    s->items = 0;
+    s->count = 0u;
+    s->capacity = 0u;
+}
+
+static void spans_free(dom_access_conflict_spans *s) {
+    delete[] s->items;
+    spans_reset(s);
+}
+
+static void bucket_table_grow(dom_access_conflict_index *idx) {
+    u32 new_capacity = idx->bucket_capacity ? idx->bucket_capacity * 2u : 64u;
+    dom_access_conflict_bucket *old = idx->buckets;
+    u32 old_capacity = idx->bucket_capacity;
+    u32 i;
+    idx->buckets = new dom_access_conflict_bucket[new_capacity];
+    idx->bucket_capacity = new_capacity;
+    for (i = 0u; i < new_capacity; ++i) {
+        idx->buckets[i].used = 0u;
+        spans_reset(&idx->buckets[i].touched);
+        spans_reset(&idx->buckets[i].written);
+    }
+    for (i = 0u; i < old_capacity; ++i) {
+        if (old[i].used) {
+            u32 slot = bucket_hash(old[i].component_id, old[i].field_id) & (new_capacity - 1u);
+            while (idx->buckets[slot].used) {
+                slot = (slot + 1u) & (new_capacity - 1u);
+            }
+            idx->buckets[slot] = old[i];
+        } else {
+            spans_free(&old[i].touched);
+            spans_free(&old[i].written);
+        }
+    }
+    delete[] old;
+}
+
+static dom_access_conflict_bucket *bucket_get(dom_access_conflict_index *idx,
+                                              u32 component_id,
+                                              u32 field_id) {
+    u32 mask;
+    u32 slot;
+    dom_access_conflict_bucket *b;
+    if ((idx->bucket_count + 1u) * 2u > idx->bucket_capacity) {
+        bucket_table_grow(idx);
+    }
+    mask = idx->bucket_capacity - 1u;
+    slot = bucket_hash(component_id, field_id) & mask;
+    while (idx->buckets[slot].used) {
+        b = &idx->buckets[slot];
+        if (b->component_id == component_id && b->field_id == field_id) {
+            return b;
+        }
+        slot = (slot + 1u) & mask;
+    }
+    b = &idx->buckets[slot];
+    b->component_id = component_id;
+    b->field_id = field_id;
+    b->used = 1u;
+    b->touched_sets = 0u;
+    b->written_sets = 0u;
+    b->touched.count = 0u;
+    b->written.count = 0u;
+    idx->bucket_count += 1u;
+    return b;
+}
+
+/* Number of spans starting at or before `end`. */
+static u32 spans_upper_bound(const dom_access_conflict_spans *s, u64 end) {
+    u32 lo = 0u;
+    u32 hi = s->count;
+    while (lo < hi) {
+        const u32 mid = lo + ((hi - lo) >> 1);
+        if (s->items[mid].start_id <= end) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void span_push(dom_access_conflict_spans *s, const dom_access_range *r) {
+    dom_access_conflict_span *span;
+    const u64 end = (r->kind == DOM_RANGE_SINGLE) ? r->start_id : r->end_id;
+    u32 at;
+    u32 i;
+    if (s->count == s->capacity) {
+        u32 new_capacity = s->capacity ? s->capacity * 2u : 8u;
+        dom_access_conflict_span *grown = new dom_access_conflict_span[new_capacity];
+        for (i = 0u; i < s->count; ++i) {
+            grown[i] = s->items[i];
+        }
+        delete[] s->items;
+        s->items = grown;
+        s->capacity = new_capacity;
+    }
+    at = spans_upper_bound(s, r->start_id);
+    for (i = s->count; i > at; --i) {
+        s->items[i] = s->items[i - 1u];
+    }
+    s->count += 1u;
+    span = &s->items[at];
+    span->start_id = r->start_id;
+    span->end_id = end;
+    span->max_end_id = (at > 0u && s->items[at - 1u].max_end_id > end) ? s->items[at - 1u].max_end_id : end;
+    /* The running max is nondecreasing, so stop at the first span above it. */
+    for (i = at + 1u; i < s->count && s->items[i].max_end_id < end; ++i) {
+        s->items[i].max_end_id = end;
+    }
+}
+
+static void index_add_ranges(dom_access_conflict_index *idx,
+                             const dom_access_range *ranges,
+                             u32 count,
+                             d_bool written) {
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        const dom_access_range *r = &ranges[i];
+        dom_access_conflict_bucket *b = bucket_get(idx, r->component_id, r->field_id);
+        if (range_is_index(r)) {
+            span_push(&b->touched, r);
+            if (written) {
+                span_push(&b->written, r);
+            }
+        } else {
+            b->touched_sets += 1u;
+            if (written) {
+                b->written_sets += 1u;
+            }
+        }
+    }
+}
+
+/* Whether r overlaps a range in the touched (or written) group of its bucket. */
+static d_bool index_hits(const dom_access_conflict_index *idx,
+                         const dom_access_range *r,
+                         d_bool touched) {
+    const dom_access_conflict_bucket *b = bucket_find(idx, r->component_id, r->field_id);
+    const dom_access_conflict_spans *spans;
+    u32 at;
+    u64 start;
+    u64 end;
+    if (!b) {
+        return D_FALSE;
+    }
+    if ((touched ? b->touched_sets : b->written_sets) > 0u) {
+        return D_TRUE;
+    }
+    spans = touched ? &b->touched : &b->written;
+    if (!range_is_index(r)) {
+        return (spans->count > 0u) ? D_TRUE : D_FALSE;
+    }
+    start = r->start_id;
+    end = (r->kind == DOM_RANGE_SINGLE) ? r->start_id : r->end_id;
+    at = spans_upper_bound(spans, end);
+    return (at > 0u && spans->items[at - 1u].max_end_id >= start) ? D_TRUE : D_FALSE;
+}
+
+void dom_access_conflict_index_init(dom_access_conflict_index *idx) {
+    u32 i;
+    if (!idx) {
+        return;
+    }
+    idx->buckets = 0;
+    idx->bucket_capacity = 0u;
+    idx->bucket_count = 0u;
+    idx->set_count = 0u;
+    idx->reducer_count = 0u;
+    idx->malformed_count = 0u;
+    for (i = 0u; i < DOM_ACCESS_CONFLICT_OP_SLOTS; ++i) {
+        idx->sets_by_op[i] = 0u;
+        idx->reducers_by_op[i] = 0u;
+    }
+}
+
+void dom_access_conflict_index_free(dom_access_conflict_index *idx) {
+    u32 i;
+    if (!idx) {
+        return;
+    }
+    for (i = 0u; i < idx->bucket_capacity; ++i) {
+        spans_free(&idx->buckets[i].touched);
+        spans_free(&idx->buckets[i].written);
+    }
+    delete[] idx->buckets;
+    dom_access_conflict_index_init(idx);
+}
+
+void dom_access_conflict_index_clear(dom_access_conflict_index *idx) {
+    u32 i;
+    if (!idx) {
+        return;
+    }
+    if (idx->bucket_count > 0u) {
+        for (i = 0u; i < idx->bucket_capacity; ++i) {
+            idx->buckets[i].used = 0u;
+        }
+    }
+    idx->bucket_count = 0u;
+    idx->set_count = 0u;
+    idx->reducer_count = 0u;
+    idx->malformed_count = 0u;
+    for (i = 0u; i < DOM_ACCESS_CONFLICT_OP_SLOTS; ++i) {
+        idx->sets_by_op[i] = 0u;
+        idx->reducers_by_op[i] = 0u;
+    }
+}
+
+void dom_access_conflict_index_add(dom_access_conflict_index *idx, const dom_access_set *set) {
+    if (!idx || !set) {
+        return;
+    }
+    idx->set_count += 1u;
+    if (set->reduction_op < DOM_ACCESS_CONFLICT_OP_SLOTS) {
+        idx->sets_by_op[set->reduction_op] += 1u;
+    }
+    if (set->reduce_count > 0u) {
+        idx->reducer_count += 1u;
+        if (set->reduction_op < DOM_ACCESS_CONFLICT_OP_SLOTS) {
+            idx->reducers_by_op[set->reduction_op] += 1u;
+        }
+    }
+    if (set_is_malformed(set)) {
+        /* Conflicts with everything; its ranges need not be indexed. */
+        idx->malformed_count += 1u;
+        return;
+    }
+    index_add_ranges(idx, set->write_ranges, set->write_count, D_TRUE);
+    index_add_ranges(idx, set->read_ranges, set->read_count, D_FALSE);
+    index_add_ranges(idx, set->reduce_ranges, set->reduce_count, D_FALSE);
+}
+
+d_bool dom_access_conflict_index_conflicts(const dom_access_conflict_index *idx,
+                                           const dom_access_set *set) {
+    u32 op;
+    u32 same_op;
+    u32 i;
+    if (!idx || !set || idx->set_count == 0u) {
+        return D_FALSE;
+    }
+    /* A NULL range array conflicts on either side of the pair. */
+    if (idx->malformed_count > 0u || set_is_malformed(set)) {
+        return D_TRUE;
+    }
+    /* Reduce/Reduce: any reducer in a pair requires both to share a valid op. */
+    op = set->reduction_op;
+    if (op != DOM_REDUCE_NONE && op < DOM_ACCESS_CONFLICT_OP_SLOTS && op_is_allowed(op)) {
+        same_op = (set->reduce_count > 0u) ? idx->sets_by_op[op] : idx->reducers_by_op[op];
+    } else {
+        same_op = 0u;
+    }
+    if (set->reduce_count > 0u) {
+        if (idx->set_count > same_op) {
+            return D_TRUE;
+        }
+    } else if (idx->reducer_count > same_op) {
+        return D_TRUE;
+    }
+    /* Our writes against anything; our reads/reduces against their writes. */
+    for (i = 0u; i < set->write_count; ++i) {
+        if (index_hits(idx, &set->write_ranges[i], D_TRUE)) {
+            return D_TRUE;
+        }
+    }
+    for (i = 0u; i < set->read_count; ++i) {
+        if (index_hits(idx, &set->read_ranges[i], D_FALSE)) {
+            return D_TRUE;
+        }
+    }
+    for (i = 0u; i < set->reduce_count; ++i) {
+        if (index_hits(idx, &set->reduce_ranges[i], D_FALSE)) {
+            return D_TRUE;
+        }
+    }
+    return D_FALSE;
+}
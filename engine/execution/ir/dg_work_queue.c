@@ -18,24 +18,63 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 #include "det_invariants.h"
 
+typedef struct dg_work_run {
+    const dg_work_queue *q;     /* read from a queue, or ... */
+    const dg_work_item  *items; /* ... from an array, optionally via order[] */
+    const u32           *order;
+} dg_work_run;
+
+/* Ring index of logical position `index` (0 = next to pop). */
+static u32 dg_work_queue_ring(const dg_work_queue *q, u32 index) {
+    u32 to_end = q->capacity - q->head;
+    return (index < to_end) ? (q->head + index) : (index - to_end);
+}
+
+static dg_work_item *dg_work_queue_slot(const dg_work_queue *q, u32 index) {
+    return &q->items[dg_work_queue_ring(q, index)];
+}
+
+static const dg_work_item *dg_work_run_at(const dg_work_run *r, u32 index) {
+    if (r->q) {
+        return dg_work_queue_slot(r->q, index);
+    }
+    if (r->order) {
+        return &r->items[r->order[index]];
+    }
+    return &r->items[index];
+}
+
 static d_bool dg_work_queue_is_sorted(const dg_work_queue *q) {
     u32 i;
     if (!q || !q->items || q->count < 2u) {
         return D_TRUE;
     }
     for (i = 1u; i < q->count; ++i) {
-        if (dg_order_key_cmp(&q->items[i - 1u].key, &q->items[i].key) > 0) {
+        if (dg_order_key_cmp(&dg_work_queue_slot(q, i - 1u)->key, &dg_work_queue_slot(q, i)->key) > 0) {
             return D_FALSE;
         }
     }
     return D_TRUE;
 }
 
+/* Ordering against the immediate neighbours only; keeps debug pushes O(1). */
+static d_bool dg_work_queue_is_sorted_at(const dg_work_queue *q, u32 index) {
+    const dg_work_item *it = dg_work_queue_slot(q, index);
+    if (index > 0u && dg_order_key_cmp(&dg_work_queue_slot(q, index - 1u)->key, &it->key) > 0) {
+        return D_FALSE;
+    }
+    if (index + 1u < q->count && dg_order_key_cmp(&it->key, &dg_work_queue_slot(q, index + 1u)->key) > 0) {
+        return D_FALSE;
+    }
+    return D_TRUE;
+}
+
 void dg_work_queue_init(dg_work_queue *q) {
     if (!q) {
         return;
     }
     q->items = (dg_work_item *)0;
+    q->head = 0u;
     q->count = 0u;
     q->capacity = 0u;
     q->owns_storage = D_FALSE;
@@ -68,6 +107,7 @@ int dg_work_queue_reserve(dg_work_queue *q, u32 capacity) {
     memset(items, 0, sizeof(dg_work_item) * (size_t)capacity);
     q->items = items;
     q->capacity = capacity;
+    q->head = 0u;
     q->count = 0u;
     q->owns_storage = D_TRUE;
     q->probe_refused = 0u;
@@ -84,6 +124,7 @@ int dg_work_queue_use_storage(dg_work_queue *q, dg_work_item *storage, u32 capac
     }
     q->items = storage;
     q->capacity = capacity;
+    q->head = 0u;
     q->count = 0u;
     q->owns_storage = D_FALSE;
     q->probe_refused = 0u;
@@ -94,6 +135,7 @@ void dg_work_queue_clear(dg_work_queue *q) {
     if (!q) {
         return;
     }
+    q->head = 0u;
     q->count = 0u;
 }
 
@@ -109,6 +151,13 @@ u32 dg_work_queue_probe_refused(const dg_work_queue *q) {
     return q ? q->probe_refused : 0u;
 }
 
+static u32 dg_work_queue_free_slots(const dg_work_queue *q) {
+    if (!q->items || q->capacity == 0u) {
+        return 0u;
+    }
+    return q->capacity - q->count;
+}
+
 static u32 dg_work_queue_upper_bound(const dg_work_queue *q, const dg_order_key *key) {
     u32 lo = 0u;
     u32 hi;
@@ -121,7 +170,7 @@ static u32 dg_work_queue_upper_bound(const dg_work_queue *q, const dg_order_key
     while (lo < hi) {
         int cmp;
         mid = lo + ((hi - lo) / 2u);
-        cmp = dg_order_key_cmp(&q->items[mid].key, key);
+        cmp = dg_order_key_cmp(&dg_work_queue_slot(q, mid)->key, key);
         if (cmp <= 0) {
             lo = mid + 1u;
         } else {
@@ -131,8 +180,75 @@ static u32 dg_work_queue_upper_bound(const dg_work_queue *q, const dg_order_key
     return lo;
 }
 
+/* Drops the first n items. */
+static void dg_work_queue_drop_front(dg_work_queue *q, u32 n) {
+    q->count -= n;
+    q->head = (q->count != 0u) ? dg_work_queue_ring(q, n) : 0u;
+}
+
+/* Merges the n sorted run items into q, which has room for them. Runs from
+ * the back so every write lands on a slot that has already been read; on
+ * equal keys the run items go after the queued ones, as a push would. */
+static void dg_work_queue_merge_run(dg_work_queue *q, const dg_work_run *run, u32 n) {
+    u32 i = q->count;
+    u32 j = n;
+    u32 k = q->count + n;
+    while (j > 0u) {
+        const dg_work_item *next = dg_work_run_at(run, j - 1u);
+        if (i > 0u && dg_order_key_cmp(&dg_work_queue_slot(q, i - 1u)->key, &next->key) > 0) {
+            *dg_work_queue_slot(q, k - 1u) = *dg_work_queue_slot(q, i - 1u);
+            i -= 1u;
+        } else {
+            *dg_work_queue_slot(q, k - 1u) = *next;
+            j -= 1u;
+        }
+        k -= 1u;
+    }
+    q->count += n;
+}
+
+/* Stable bottom-up merge sort of item indices; returns whichever of the two
+ * buffers holds the result. */
+static const u32 *dg_work_queue_sort_order(const dg_work_item *items, u32 *order, u32 *tmp, u32 n) {
+    u32 width;
+    u32 i;
+    for (i = 0u; i < n; ++i) {
+        order[i] = i;
+    }
+    for (width = 1u; width < n; width = (width > n / 2u) ? n : width * 2u) {
+        u32 lo = 0u;
+        u32 *swap;
+        while (lo < n) {
+            u32 mid = (n - lo > width) ? lo + width : n;
+            u32 hi = (n - mid > width) ? mid + width : n;
+            u32 a = lo;
+            u32 b = mid;
+            u32 k = lo;
+            while (a < mid && b < hi) {
+                if (dg_order_key_cmp(&items[order[b]].key, &items[order[a]].key) < 0) {
+                    tmp[k++] = order[b++];
+                } else {
+                    tmp[k++] = order[a++];
+                }
+            }
+            while (a < mid) {
+                tmp[k++] = order[a++];
+            }
+            while (b < hi) {
+                tmp[k++] = order[b++];
+            }
+            lo = hi;
+        }
+        swap = order;
+        order = tmp;
+        tmp = swap;
+    }
+    return order;
+}
+
 int dg_work_queue_push(dg_work_queue *q, const dg_work_item *it) {
     u32 idx;
+    u32 k;
     if (!q || !it) {
         return -1;
     }
@@ -145,16 +261,72 @@ int dg_work_queue_push(dg_work_queue *q, const dg_work_item *it) {
         return -3;
     }
 
-    idx = dg_work_queue_upper_bound(q, &it->key);
-    if (idx < q->count) {
-        memmove(&q->items[idx + 1u], &q->items[idx],
-                sizeof(dg_work_item) * (size_t)(q->count - idx));
+    /* Producers mostly emit in key order; appending skips the search. */
+    if (q->count == 0u || dg_order_key_cmp(&dg_work_queue_slot(q, q->count - 1u)->key, &it->key) <= 0) {
+        idx = q->count;
+    } else {
+        idx = dg_work_queue_upper_bound(q, &it->key);
     }
-    q->items[idx] = *it;
+    if (idx < q->count - idx) {
+        /* Shift the front part down by one; head moves back. */
+        q->head = (q->head == 0u) ? (q->capacity - 1u) : (q->head - 1u);
+        for (k = 0u; k < idx; ++k) {
+            *dg_work_queue_slot(q, k) = *dg_work_queue_slot(q, k + 1u);
+        }
+    } else {
+        for (k = q->count; k > idx; --k) {
+            *dg_work_queue_slot(q, k) = *dg_work_queue_slot(q, k - 1u);
+        }
+    }
+    *dg_work_queue_slot(q, idx) = *it;
     q->count += 1u;
+#ifndef NDEBUG
+    DG_DET_GUARD_SORTED(dg_work_queue_is_sorted_at(q, idx) == D_TRUE);
+#endif
+    return 0;
+}
+
+int dg_work_queue_push_many(dg_work_queue *q, const dg_work_item *items, u32 count) {
+    dg_work_run run;
+    u32 accept;
+    u32 i;
+    if (!q || (!items && count != 0u)) {
+        return -1;
+    }
+    accept = dg_work_queue_free_slots(q);
+    if (accept > count) {
+        accept = count;
+    }
+    run.q = (const dg_work_queue *)0;
+    run.items = items;
+    run.order = (const u32 *)0;
+    for (i = 1u; i < accept; ++i) {
+        if (dg_order_key_cmp(&items[i - 1u].key, &items[i].key) > 0) {
+            break;
+        }
+    }
+    if (i < accept) {
+        u32 *order = (u32 *)malloc(sizeof(u32) * 2u * (size_t)accept);
+        if (!order) {
+            /* No sort scratch: fall back to single pushes, same result. */
+            for (i = 0u; i < accept; ++i) {
+                (void)dg_work_queue_push(q, &items[i]);
+            }
+        } else {
+            run.order = dg_work_queue_sort_order(items, order, order + accept, accept);
+            dg_work_queue_merge_run(q, &run, accept);
+            free(order);
+        }
+    } else if (accept > 0u) {
+        dg_work_queue_merge_run(q, &run, accept);
+    }
 #ifndef NDEBUG
     DG_DET_GUARD_SORTED(dg_work_queue_is_sorted(q) == D_TRUE);
 #endif
+    if (accept < count) {
+        q->probe_refused += (count - accept);
+        return 1;
+    }
     return 0;
 }
 
@@ -162,14 +334,14 @@ const dg_work_item *dg_work_queue_peek_next(const dg_work_queue *q) {
     if (!q || q->count == 0u || !q->items) {
         return (const dg_work_item *)0;
     }
-    return &q->items[0];
+    return dg_work_queue_slot(q, 0u);
 }
 
 const dg_work_item *dg_work_queue_at(const dg_work_queue *q, u32 index) {
     if (!q || !q->items || index >= q->count) {
         return (const dg_work_item *)0;
     }
-    return &q->items[index];
+    return dg_work_queue_slot(q, index);
 }
 
 d_bool dg_work_queue_pop_next(dg_work_queue *q, dg_work_item *out) {
@@ -177,46 +349,49 @@ d_bool dg_work_queue_pop_next(dg_work_queue *q, dg_work_item *out) {
         return D_FALSE;
     }
 #ifndef NDEBUG
-    DG_DET_GUARD_SORTED(dg_work_queue_is_sorted(q) == D_TRUE);
+    DG_DET_GUARD_SORTED(dg_work_queue_is_sorted_at(q, 0u) == D_TRUE);
 #endif
     if (out) {
-        *out = q->items[0];
-    }
-    if (q->count > 1u) {
-        memmove(&q->items[0], &q->items[1], sizeof(dg_work_item) * (size_t)(q->count - 1u));
+        *out = *dg_work_queue_slot(q, 0u);
     }
-    q->count -= 1u;
+    dg_work_queue_drop_front(q, 1u);
     return D_TRUE;
 }
 
 int dg_work_queue_merge(dg_work_queue *dst, dg_work_queue *src) {
-    dg_work_item it;
-    if (!dst || !src) {
+    dg_work_run run;
+    u32 accept;
+    if (!dst || !src || dst == src) {
         return -1;
     }
 #ifndef NDEBUG
     DG_DET_GUARD_SORTED(dg_work_queue_is_sorted(dst) == D_TRUE);
     DG_DET_GUARD_SORTED(dg_work_queue_is_sorted(src) == D_TRUE);
 #endif
-    /* Deterministic: consume src in its canonical order. */
-    while (src->count != 0u) {
-        const dg_work_item *next = dg_work_queue_peek_next(src);
-        if (!next) {
-            break;
-        }
-        it = *next;
-        if (dg_work_queue_push(dst, &it) != 0) {
-            /* dst full; refuse remaining items, but do not drop src contents. */
-            if (src->count > 1u) {
-                dst->probe_refused += (src->count - 1u);
-            }
-            return 1;
-        }
-        (void)dg_work_queue_pop_next(src, (dg_work_item *)0);
+    if (src->count == 0u || !src->items) {
+        return 0;
+    }
+    /* Deterministic: src is consumed in its canonical order, so the items
+     * that fit are its leading ones. */
+    accept = dg_work_queue_free_slots(dst);
+    if (accept > src->count) {
+        accept = src->count;
+    }
+    if (accept > 0u) {
+        run.q = src;
+        run.items = (const dg_work_item *)0;
+        run.order = (const u32 *)0;
+        dg_work_queue_merge_run(dst, &run, accept);
+        dg_work_queue_drop_front(src, accept);
     }
 #ifndef NDEBUG
     DG_DET_GUARD_SORTED(dg_work_queue_is_sorted(dst) == D_TRUE);
     DG_DET_GUARD_SORTED(dg_work_queue_is_sorted(src) == D_TRUE);
 #endif
+    if (src->count != 0u) {
+        /* dst full; refuse remaining items, but do not drop src contents. */
+        dst->probe_refused += src->count;
+        return 1;
+    }
     return 0;
 }
@@ -15,6 +15,11 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
  *
  * Queue ordering is always the canonical ascending order of dg_order_key.
  * No unordered containers or pointer-order behavior is permitted.
+ *
+ * Storage is a ring holding one sorted run starting at `head`: popping and
+ * pushing at either end are O(1), an out-of-order push shifts the shorter
+ * side, and merge/push_many insert a whole batch with one linear merge.
+ * Items with equal keys keep their push order.
  */
 #ifndef DG_WORK_QUEUE_H
 #define DG_WORK_QUEUE_H
@@ -27,6 +32,7 @@ extern "C" {
 
 typedef struct dg_work_queue {
     dg_work_item *items;
+    u32           head;     /* ring index of the first (lowest) item */
     u32           count;
     u32           capacity;
     d_bool        owns_storage;
@@ -51,7 +57,13 @@ u32 dg_work_queue_probe_refused(const dg_work_queue *q);
 /* Deterministic: inserts by canonical dg_order_key order (ascending). */
 int dg_work_queue_push(dg_work_queue *q, const dg_work_item *it);
 
-/* Read-only accessors. */
+/* Same result as pushing items[0..count) one at a time, in O(n log n).
+ * If q fills, the leading items that fit are kept and the rest are
+ * counted in probe_refused; returns 1 in that case.
+ */
+int dg_work_queue_push_many(dg_work_queue *q, const dg_work_item *items, u32 count);
+
+/* Read-only accessors; index 0 is the next item to pop. */
 const dg_work_item *dg_work_queue_peek_next(const dg_work_queue *q);
 const dg_work_item *dg_work_queue_at(const dg_work_queue *q, u32 index);
 
@@ -8,6 +8,8 @@ FORBIDDEN DEPENDENCIES: engine internal headers outside execution.
 DETERMINISM: Selection for authoritative tasks must be deterministic.
 */
 #include "kernel_selector.h"
+#include "simd_caps.h"
+#include "simd_kernels.h"
 #include "domino/execution/task_node.h"
 
 static d_bool dom_kernel_selector_allow_backend_for_class(u32 backend_id, u32 determinism_class)
@@ -41,11 +43,28 @@ static u32 dom_kernel_selector_allowed_mask(const dom_kernel_policy* policy, u32
 static u32 dom_kernel_selector_available_mask(const dom_kernel_select_request* req)
 {
     if (!req || req->available_backend_mask == 0u) {
-        return DOM_KERNEL_BACKEND_MASK_SCALAR;
+        return dom_kernel_selector_detect_backend_mask();
     }
     return req->available_backend_mask;
 }
 
+u32 dom_kernel_selector_detect_backend_mask(void)
+{
+    /* Detection is idempotent, so a racing first call only repeats the work. */
+    static volatile u32 g_detected_mask = 0u;
+    u32 mask = g_detected_mask;
+    if (mask == 0u) {
+        dom_simd_caps caps;
+        dom_simd_detect_caps(&caps);
+        mask = DOM_KERNEL_BACKEND_MASK_SCALAR;
+        if (dom_simd_kernel_tier(&caps) != 0u) {
+            mask |= DOM_KERNEL_BACKEND_MASK_SIMD;
+        }
+        g_detected_mask = mask;
+    }
+    return mask;
+}
+
 static u32 dom_kernel_selector_law_mask(const dom_kernel_select_request* req)
 {
     if (!req || req->law_backend_mask == 0u) {
@@ -36,7 +36,7 @@ typedef enum dom_kernel_select_reason {
 typedef struct dom_kernel_select_request {
     dom_kernel_op_id op_id;
     u32 determinism_class;
-    u32 available_backend_mask;
+    u32 available_backend_mask; /* 0 = detect from the running CPU */
     u32 law_backend_mask;
     u32 profile_flags;
     u32 derived_cpu_time_us;
@@ -48,6 +48,9 @@ typedef struct dom_kernel_select_result {
     u32 reason;
 } dom_kernel_select_result;
 
+/* Backends usable on this CPU: scalar, plus SIMD when a SIMD tier is detected. */
+u32 dom_kernel_selector_detect_backend_mask(void);
+
 int dom_kernel_select_backend(const dom_kernel_policy* policy,
                               const dom_kernel_select_request* req,
                               dom_kernel_select_result* out_result);
@@ -0,0 +1,94 @@
+/*
+FILE: engine/execution/kernels/simd/simd_isa.cpp
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino / execution/kernels/simd
+RESPONSIBILITY: Portable helpers used by the per-ISA tables for tails and fallbacks.
+ALLOWED DEPENDENCIES: engine/include public headers and C++98 headers only.
+FORBIDDEN DEPENDENCIES: engine internal headers outside execution.
+DETERMINISM: Matches the scalar kernels bit for bit.
+*/
+#include "simd_isa.h"
+
+#include <string.h>
+
+static const u8 g_dom_simd_popcount_nibble[16] = {
+    0u, 1u, 1u, 2u, 1u, 2u, 2u, 3u, 1u, 2u, 2u, 3u, 2u, 3u, 3u, 4u
+};
+
+u32 dom_simd_generic_nonzero_bits(const unsigned char* src, u32 width, u32 count)
+{
+    u32 bits = 0u;
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        const unsigned char* p = src + (size_t)i * width;
+        d_bool nonzero = D_FALSE;
+        if (width == 1u) {
+            nonzero = (p[0] != 0u) ? D_TRUE : D_FALSE;
+        } else if (width == 2u) {
+            u16 v;
+            memcpy(&v, p, sizeof(v));
+            nonzero = (v != 0u) ? D_TRUE : D_FALSE;
+        } else if (width == 4u) {
+            u32 v;
+            memcpy(&v, p, sizeof(v));
+            nonzero = (v != 0u) ? D_TRUE : D_FALSE;
+        } else if (width == 8u) {
+            u64 v;
+            memcpy(&v, p, sizeof(v));
+            nonzero = (v != 0u) ? D_TRUE : D_FALSE;
+        }
+        if (nonzero) {
+            bits |= (1u << i);
+        }
+    }
+    return bits;
+}
+
+u32 dom_simd_generic_popcount_bytes(const unsigned char* bytes, u32 count)
+{
+    u32 total = 0u;
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        total += g_dom_simd_popcount_nibble[bytes[i] & 0x0Fu];
+        total += g_dom_simd_popcount_nibble[bytes[i] >> 4u];
+    }
+    return total;
+}
+
+u32 dom_simd_generic_reduce_32(const unsigned char* src, u32 count, u32 mode, u32 acc)
+{
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        u32 value;
+        memcpy(&value, src + (size_t)i * sizeof(u32), sizeof(u32));
+        if (mode & DOM_SIMD_REDUCE_SIGNED) {
+            i32 sv = (i32)value;
+            i32 sa = (i32)acc;
+            if ((mode & DOM_SIMD_REDUCE_MAX) ? (sv > sa) : (sv < sa)) {
+                acc = value;
+            }
+        } else if ((mode & DOM_SIMD_REDUCE_MAX) ? (value > acc) : (value < acc)) {
+            acc = value;
+        }
+    }
+    return acc;
+}
+
+u64 dom_simd_generic_reduce_64(const unsigned char* src, u32 count, u32 mode, u64 acc)
+{
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        u64 value;
+        memcpy(&value, src + (size_t)i * sizeof(u64), sizeof(u64));
+        if (mode & DOM_SIMD_REDUCE_SIGNED) {
+            i64 sv = (i64)value;
+            i64 sa = (i64)acc;
+            if ((mode & DOM_SIMD_REDUCE_MAX) ? (sv > sa) : (sv < sa)) {
+                acc = value;
+            }
+        } else if ((mode & DOM_SIMD_REDUCE_MAX) ? (value > acc) : (value < acc)) {
+            acc = value;
+        }
+    }
+    return acc;
+}
@@ -0,0 +1,73 @@
+/*
+FILE: engine/execution/kernels/simd/simd_isa.h
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino / execution/kernels/simd
+RESPONSIBILITY: Per-ISA vector primitives backing the SIMD kernel backend.
+ALLOWED DEPENDENCIES: engine/include public headers, C++98 headers, and compiler intrinsics headers.
+FORBIDDEN DEPENDENCIES: engine internal headers outside execution.
+DETERMINISM: Every primitive must produce the same bits as the equivalent scalar loop.
+*/
+#ifndef DOMINO_EXECUTION_SIMD_ISA_H
+#define DOMINO_EXECUTION_SIMD_ISA_H
+
+#include "domino/core/types.h"
+
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define DOM_SIMD_ISA_X86 1
+#else
+#define DOM_SIMD_ISA_X86 0
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__aarch64__) || defined(_M_ARM64)
+#define DOM_SIMD_ISA_NEON 1
+#else
+#define DOM_SIMD_ISA_NEON 0
+#endif
+
+/* Reduction modes for reduce_32/reduce_64. */
+enum {
+    DOM_SIMD_REDUCE_MIN    = 0u,
+    DOM_SIMD_REDUCE_MAX    = 1u,
+    DOM_SIMD_REDUCE_SIGNED = 2u
+};
+
+/* Size of the repeating pattern passed to fill_pattern. */
+#define DOM_SIMD_FILL_PATTERN_BYTES 32u
+
+/*
+All primitives operate on contiguous, possibly unaligned memory. Strided views
+are handled by the callers in simd_kernels.cpp.
+*/
+typedef struct dom_simd_isa {
+    u32 cap; /* DOM_SIMD_CAP_* bit required to run this table */
+    /* Writes `bytes` bytes of the 32-byte repeating `pattern` at dst. */
+    void (*fill_pattern)(unsigned char* dst, size_t bytes, const unsigned char* pattern);
+    /* Wrapping sums; count may be zero. */
+    u32 (*sum_32)(const unsigned char* src, u32 count);
+    u64 (*sum_64)(const unsigned char* src, u32 count);
+    /* Min/max over count >= 1 elements; mode is DOM_SIMD_REDUCE_*. */
+    u32 (*reduce_32)(const unsigned char* src, u32 count, u32 mode);
+    u64 (*reduce_64)(const unsigned char* src, u32 count, u32 mode);
+    /* Bit k set when element k (width 1/2/4/8 bytes) is nonzero; count <= 32. */
+    u32 (*nonzero_bits)(const unsigned char* src, u32 width, u32 count);
+    /* Total set bits across count bytes. */
+    u32 (*popcount_bytes)(const unsigned char* bytes, u32 count);
+} dom_simd_isa;
+
+#if DOM_SIMD_ISA_X86
+extern const dom_simd_isa dom_simd_isa_sse2;
+extern const dom_simd_isa dom_simd_isa_avx2;
+#endif
+#if DOM_SIMD_ISA_NEON
+extern const dom_simd_isa dom_simd_isa_neon;
+#endif
+
+/* Portable helpers shared by the ISA tables for tails and fallbacks. */
+u32 dom_simd_generic_nonzero_bits(const unsigned char* src, u32 width, u32 count);
+u32 dom_simd_generic_popcount_bytes(const unsigned char* bytes, u32 count);
+u32 dom_simd_generic_reduce_32(const unsigned char* src, u32 count, u32 mode, u32 acc);
+u64 dom_simd_generic_reduce_64(const unsigned char* src, u32 count, u32 mode, u64 acc);
+
+#endif /* DOMINO_EXECUTION_SIMD_ISA_H */
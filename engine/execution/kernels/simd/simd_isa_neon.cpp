@@ -0,0 +1,166 @@
+/*
+FILE: engine/execution/kernels/simd/simd_isa_neon.cpp
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino / execution/kernels/simd
+RESPONSIBILITY: NEON primitive table for the SIMD kernel backend.
+ALLOWED DEPENDENCIES: engine/include public headers, C++98 headers, and compiler intrinsics headers.
+FORBIDDEN DEPENDENCIES: engine internal headers outside execution.
+DETERMINISM: Integer-only lane math; results match the scalar loops bit for bit.
+*/
+#include "simd_isa.h"
+#include "simd_caps.h"
+
+#if DOM_SIMD_ISA_NEON
+
+#include <string.h>
+#include <arm_neon.h>
+
+static void dom_neon_fill_pattern(unsigned char* dst, size_t bytes, const unsigned char* pattern)
+{
+    uint8x16_t v = vld1q_u8(pattern);
+    size_t i = 0u;
+    for (; i + 64u <= bytes; i += 64u) {
+        vst1q_u8(dst + i, v);
+        vst1q_u8(dst + i + 16u, v);
+        vst1q_u8(dst + i + 32u, v);
+        vst1q_u8(dst + i + 48u, v);
+    }
+    for (; i + 16u <= bytes; i += 16u) {
+        vst1q_u8(dst + i, v);
+    }
+    if (i < bytes) {
+        memcpy(dst + i, pattern, bytes - i);
+    }
+}
+
+static u32 dom_neon_sum_32(const unsigned char* src, u32 count)
+{
+    uint32x4_t acc0 = vdupq_n_u32(0u);
+    uint32x4_t acc1 = vdupq_n_u32(0u);
+    u32 lanes[4];
+    u32 total;
+    u32 i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+        acc0 = vaddq_u32(acc0, vreinterpretq_u32_u8(vld1q_u8(src + (size_t)i * 4u)));
+        acc1 = vaddq_u32(acc1, vreinterpretq_u32_u8(vld1q_u8(src + (size_t)i * 4u + 16u)));
+    }
+    vst1q_u32(lanes, vaddq_u32(acc0, acc1));
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; ++i) {
+        u32 value;
+        memcpy(&value, src + (size_t)i * 4u, sizeof(value));
+        total += value;
+    }
+    return total;
+}
+
+static u64 dom_neon_sum_64(const unsigned char* src, u32 count)
+{
+    uint64x2_t acc0 = vdupq_n_u64(0u);
+    uint64x2_t acc1 = vdupq_n_u64(0u);
+    u64 lanes[2];
+    u64 total;
+    u32 i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+        acc0 = vaddq_u64(acc0, vreinterpretq_u64_u8(vld1q_u8(src + (size_t)i * 8u)));
+        acc1 = vaddq_u64(acc1, vreinterpretq_u64_u8(vld1q_u8(src + (size_t)i * 8u + 16u)));
+    }
+    vst1q_u64(lanes, vaddq_u64(acc0, acc1));
+    total = lanes[0] + lanes[1];
+    for (; i < count; ++i) {
+        u64 value;
+        memcpy(&value, src + (size_t)i * 8u, sizeof(value));
+        total += value;
+    }
+    return total;
+}
+
+static u32 dom_neon_reduce_32(const unsigned char* src, u32 count, u32 mode)
+{
+    u32 first;
+    u32 lanes[4];
+    u32 acc;
+    u32 i = 0u;
+
+    memcpy(&first, src, sizeof(first));
+    if (mode & DOM_SIMD_REDUCE_SIGNED) {
+        int32x4_t accv = vdupq_n_s32((i32)first);
+        for (; i + 4u <= count; i += 4u) {
+            int32x4_t v = vreinterpretq_s32_u8(vld1q_u8(src + (size_t)i * 4u));
+            accv = (mode & DOM_SIMD_REDUCE_MAX) ? vmaxq_s32(accv, v) : vminq_s32(accv, v);
+        }
+        vst1q_u32(lanes, vreinterpretq_u32_s32(accv));
+    } else {
+        uint32x4_t accv = vdupq_n_u32(first);
+        for (; i + 4u <= count; i += 4u) {
+            uint32x4_t v = vreinterpretq_u32_u8(vld1q_u8(src + (size_t)i * 4u));
+            accv = (mode & DOM_SIMD_REDUCE_MAX) ? vmaxq_u32(accv, v) : vminq_u32(accv, v);
+        }
+        vst1q_u32(lanes, accv);
+    }
+    acc = dom_simd_generic_reduce_32((const unsigned char*)lanes, 4u, mode, lanes[0]);
+    return dom_simd_generic_reduce_32(src + (size_t)i * 4u, count - i, mode, acc);
+}
+
+static u64 dom_neon_reduce_64(const unsigned char* src, u32 count, u32 mode)
+{
+    u64 first;
+    u32 i = 0u;
+    memcpy(&first, src, sizeof(first));
+#if defined(__aarch64__) || defined(_M_ARM64)
+    {
+        u64 lanes[2];
+        u64 acc;
+        if (mode & DOM_SIMD_REDUCE_SIGNED) {
+            int64x2_t accv = vdupq_n_s64((i64)first);
+            for (; i + 2u <= count; i += 2u) {
+                int64x2_t v = vreinterpretq_s64_u8(vld1q_u8(src + (size_t)i * 8u));
+                uint64x2_t take = (mode & DOM_SIMD_REDUCE_MAX) ? vcgtq_s64(v, accv)
+                                                               : vcltq_s64(v, accv);
+                accv = vbslq_s64(take, v, accv);
+            }
+            vst1q_u64(lanes, vreinterpretq_u64_s64(accv));
+        } else {
+            uint64x2_t accv = vdupq_n_u64(first);
+            for (; i + 2u <= count; i += 2u) {
+                uint64x2_t v = vreinterpretq_u64_u8(vld1q_u8(src + (size_t)i * 8u));
+                uint64x2_t take = (mode & DOM_SIMD_REDUCE_MAX) ? vcgtq_u64(v, accv)
+                                                               : vcltq_u64(v, accv);
+                accv = vbslq_u64(take, v, accv);
+            }
+            vst1q_u64(lanes, accv);
+        }
+        acc = dom_simd_generic_reduce_64((const unsigned char*)lanes, 2u, mode, lanes[0]);
+        return dom_simd_generic_reduce_64(src + (size_t)i * 8u, count - i, mode, acc);
+    }
+#else
+    /* ARMv7 NEON lacks 64-bit compares. */
+    return dom_simd_generic_reduce_64(src, count, mode, first);
+#endif
+}
+
+static u32 dom_neon_popcount_bytes(const unsigned char* bytes, u32 count)
+{
+    uint64x2_t acc = vdupq_n_u64(0u);
+    u64 lanes[2];
+    u32 i = 0u;
+    for (; i + 16u <= count; i += 16u) {
+        uint8x16_t c = vcntq_u8(vld1q_u8(bytes + i));
+        acc = vaddq_u64(acc, vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(c))));
+    }
+    vst1q_u64(lanes, acc);
+    return (u32)(lanes[0] + lanes[1]) + dom_simd_generic_popcount_bytes(bytes + i, count - i);
+}
+
+const dom_simd_isa dom_simd_isa_neon = {
+    DOM_SIMD_CAP_NEON,
+    dom_neon_fill_pattern,
+    dom_neon_sum_32,
+    dom_neon_sum_64,
+    dom_neon_reduce_32,
+    dom_neon_reduce_64,
+    dom_simd_generic_nonzero_bits,
+    dom_neon_popcount_bytes
+};
+
+#endif /* DOM_SIMD_ISA_NEON */
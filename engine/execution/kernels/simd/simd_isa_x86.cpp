@@ -0,0 +1,412 @@
+/*
+FILE: engine/execution/kernels/simd/simd_isa_x86.cpp
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino / execution/kernels/simd
+RESPONSIBILITY: SSE2 and AVX2 primitive tables for the SIMD kernel backend.
+ALLOWED DEPENDENCIES: engine/include public headers, C++98 headers, and compiler intrinsics headers.
+FORBIDDEN DEPENDENCIES: engine internal headers outside execution.
+DETERMINISM: Integer-only lane math; results match the scalar loops bit for bit.
+NOTES: AVX2 code is compiled per function via target attributes so the rest of
+       the engine keeps its baseline instruction set; callers must only use the
+       AVX2 table when runtime detection reports DOM_SIMD_CAP_AVX2.
+*/
+#include "simd_isa.h"
+#include "simd_caps.h"
+
+#if DOM_SIMD_ISA_X86
+
+#include <string.h>
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DOM_SIMD_TARGET_SSE2 __attribute__((target("sse2")))
+#define DOM_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DOM_SIMD_TARGET_SSE2
+#define DOM_SIMD_TARGET_AVX2
+#endif
+
+/*------------------------------------------------------------
+ * SSE2
+ *------------------------------------------------------------*/
+
+DOM_SIMD_TARGET_SSE2
+static void dom_sse2_fill_pattern(unsigned char* dst, size_t bytes, const unsigned char* pattern)
+{
+    /* Element sizes that reach here divide 16, so both pattern halves match. */
+    __m128i v = _mm_loadu_si128((const __m128i*)pattern);
+    size_t i = 0u;
+    for (; i + 64u <= bytes; i += 64u) {
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 16u), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 32u), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 48u), v);
+    }
+    for (; i + 16u <= bytes; i += 16u) {
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+    if (i < bytes) {
+        memcpy(dst + i, pattern, bytes - i);
+    }
+}
+
+DOM_SIMD_TARGET_SSE2
+static u32 dom_sse2_sum_32(const unsigned char* src, u32 count)
+{
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    u32 lanes[4];
+    u32 total;
+    u32 i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+        acc0 = _mm_add_epi32(acc0, _mm_loadu_si128((const __m128i*)(src + (size_t)i * 4u)));
+        acc1 = _mm_add_epi32(acc1, _mm_loadu_si128((const __m128i*)(src + (size_t)i * 4u + 16u)));
+    }
+    acc0 = _mm_add_epi32(acc0, acc1);
+    _mm_storeu_si128((__m128i*)lanes, acc0);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; ++i) {
+        u32 value;
+        memcpy(&value, src + (size_t)i * 4u, sizeof(value));
+        total += value;
+    }
+    return total;
+}
+
+DOM_SIMD_TARGET_SSE2
+static u64 dom_sse2_sum_64(const unsigned char* src, u32 count)
+{
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    u64 lanes[2];
+    u64 total;
+    u32 i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+        acc0 = _mm_add_epi64(acc0, _mm_loadu_si128((const __m128i*)(src + (size_t)i * 8u)));
+        acc1 = _mm_add_epi64(acc1, _mm_loadu_si128((const __m128i*)(src + (size_t)i * 8u + 16u)));
+    }
+    acc0 = _mm_add_epi64(acc0, acc1);
+    _mm_storeu_si128((__m128i*)lanes, acc0);
+    total = lanes[0] + lanes[1];
+    for (; i < count; ++i) {
+        u64 value;
+        memcpy(&value, src + (size_t)i * 8u, sizeof(value));
+        total += value;
+    }
+    return total;
+}
+
+DOM_SIMD_TARGET_SSE2
+static u32 dom_sse2_reduce_32(const unsigned char* src, u32 count, u32 mode)
+{
+    /* SSE2 has no unsigned 32-bit compare: bias into signed range instead. */
+    const u32 bias = (mode & DOM_SIMD_REDUCE_SIGNED) ? 0u : 0x80000000u;
+    const __m128i biasv = _mm_set1_epi32((int)bias);
+    u32 first;
+    u32 lanes[4];
+    u32 acc;
+    u32 i = 0u;
+    __m128i accv;
+
+    memcpy(&first, src, sizeof(first));
+    accv = _mm_set1_epi32((int)(first ^ bias));
+    for (; i + 4u <= count; i += 4u) {
+        __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(src + (size_t)i * 4u)), biasv);
+        __m128i take = (mode & DOM_SIMD_REDUCE_MAX) ? _mm_cmpgt_epi32(v, accv)
+                                                    : _mm_cmpgt_epi32(accv, v);
+        accv = _mm_or_si128(_mm_and_si128(take, v), _mm_andnot_si128(take, accv));
+    }
+    accv = _mm_xor_si128(accv, biasv);
+    _mm_storeu_si128((__m128i*)lanes, accv);
+    acc = dom_simd_generic_reduce_32((const unsigned char*)lanes, 4u, mode, lanes[0]);
+    return dom_simd_generic_reduce_32(src + (size_t)i * 4u, count - i, mode, acc);
+}
+
+static u64 dom_sse2_reduce_64(const unsigned char* src, u32 count, u32 mode)
+{
+    /* No 64-bit compare before SSE4.2; the scalar loop is already optimal here. */
+    u64 first;
+    memcpy(&first, src, sizeof(first));
+    return dom_simd_generic_reduce_64(src, count, mode, first);
+}
+
+DOM_SIMD_TARGET_SSE2
+static u32 dom_sse2_zero_mask(const unsigned char* src, u32 width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_loadu_si128((const __m128i*)src);
+    if (width == 1u) {
+        return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+    }
+    if (width == 2u) {
+        __m128i c = _mm_cmpeq_epi16(v, zero);
+        return (u32)_mm_movemask_epi8(_mm_packs_epi16(c, c)) & 0xFFu;
+    }
+    if (width == 4u) {
+        return (u32)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, zero)));
+    }
+    {
+        __m128i c = _mm_cmpeq_epi32(v, zero);
+        __m128i both = _mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1)));
+        return (u32)_mm_movemask_pd(_mm_castsi128_pd(both));
+    }
+}
+
+static u32 dom_sse2_nonzero_bits(const unsigned char* src, u32 width, u32 count)
+{
+    u32 per;
+    u32 lane_mask;
+    u32 bits = 0u;
+    u32 i = 0u;
+    if (width != 1u && width != 2u && width != 4u && width != 8u) {
+        return dom_simd_generic_nonzero_bits(src, width, count);
+    }
+    per = 16u / width;
+    lane_mask = (1u << per) - 1u;
+    for (; i + per <= count; i += per) {
+        bits |= ((~dom_sse2_zero_mask(src + (size_t)i * width, width)) & lane_mask) << i;
+    }
+    if (i < count) {
+        bits |= dom_simd_generic_nonzero_bits(src + (size_t)i * width, width, count - i) << i;
+    }
+    return bits;
+}
+
+DOM_SIMD_TARGET_SSE2
+static u32 dom_sse2_popcount_bytes(const unsigned char* bytes, u32 count)
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    u64 lanes[2];
+    u32 i = 0u;
+    for (; i + 16u <= count; i += 16u) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(bytes + i));
+        x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), m1));
+        x = _mm_add_epi8(_mm_and_si128(x, m2), _mm_and_si128(_mm_srli_epi16(x, 2), m2));
+        x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), m4);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(x, zero));
+    }
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    return (u32)(lanes[0] + lanes[1]) + dom_simd_generic_popcount_bytes(bytes + i, count - i);
+}
+
+const dom_simd_isa dom_simd_isa_sse2 = {
+    DOM_SIMD_CAP_SSE2,
+    dom_sse2_fill_pattern,
+    dom_sse2_sum_32,
+    dom_sse2_sum_64,
+    dom_sse2_reduce_32,
+    dom_sse2_reduce_64,
+    dom_sse2_nonzero_bits,
+    dom_sse2_popcount_bytes
+};
+
+/*------------------------------------------------------------
+ * AVX2
+ *------------------------------------------------------------*/
+
+DOM_SIMD_TARGET_AVX2
+static void dom_avx2_fill_pattern(unsigned char* dst, size_t bytes, const unsigned char* pattern)
+{
+    __m256i v = _mm256_loadu_si256((const __m256i*)pattern);
+    size_t i = 0u;
+    for (; i + 128u <= bytes; i += 128u) {
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+        _mm256_storeu_si256((__m256i*)(dst + i + 32u), v);
+        _mm256_storeu_si256((__m256i*)(dst + i + 64u), v);
+        _mm256_storeu_si256((__m256i*)(dst + i + 96u), v);
+    }
+    for (; i + 32u <= bytes; i += 32u) {
+        _mm256_storeu_si256((__m256i*)(dst + i), v);
+    }
+    if (i < bytes) {
+        memcpy(dst + i, pattern, bytes - i);
+    }
+}
+
+DOM_SIMD_TARGET_AVX2
+static u32 dom_avx2_sum_32(const unsigned char* src, u32 count)
+{
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    u32 lanes[8];
+    u32 total = 0u;
+    u32 i = 0u;
+    u32 k;
+    for (; i + 16u <= count; i += 16u) {
+        acc0 = _mm256_add_epi32(acc0, _mm256_loadu_si256((const __m256i*)(src + (size_t)i * 4u)));
+        acc1 = _mm256_add_epi32(acc1, _mm256_loadu_si256((const __m256i*)(src + (size_t)i * 4u + 32u)));
+    }
+    acc0 = _mm256_add_epi32(acc0, acc1);
+    _mm256_storeu_si256((__m256i*)lanes, acc0);
+    for (k = 0u; k < 8u; ++k) {
+        total += lanes[k];
+    }
+    for (; i < count; ++i) {
+        u32 value;
+        memcpy(&value, src + (size_t)i * 4u, sizeof(value));
+        total += value;
+    }
+    return total;
+}
+
+DOM_SIMD_TARGET_AVX2
+static u64 dom_avx2_sum_64(const unsigned char* src, u32 count)
+{
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    u64 lanes[4];
+    u64 total;
+    u32 i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256((const __m256i*)(src + (size_t)i * 8u)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256((const __m256i*)(src + (size_t)i * 8u + 32u)));
+    }
+    acc0 = _mm256_add_epi64(acc0, acc1);
+    _mm256_storeu_si256((__m256i*)lanes, acc0);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < count; ++i) {
+        u64 value;
+        memcpy(&value, src + (size_t)i * 8u, sizeof(value));
+        total += value;
+    }
+    return total;
+}
+
+DOM_SIMD_TARGET_AVX2
+static u32 dom_avx2_reduce_32(const unsigned char* src, u32 count, u32 mode)
+{
+    u32 first;
+    u32 lanes[8];
+    u32 acc;
+    u32 i = 0u;
+    __m256i accv;
+
+    memcpy(&first, src, sizeof(first));
+    accv = _mm256_set1_epi32((int)first);
+    for (; i + 8u <= count; i += 8u) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + (size_t)i * 4u));
+        switch (mode) {
+        case DOM_SIMD_REDUCE_MIN:
+            accv = _mm256_min_epu32(accv, v);
+            break;
+        case DOM_SIMD_REDUCE_MAX:
+            accv = _mm256_max_epu32(accv, v);
+            break;
+        case DOM_SIMD_REDUCE_MIN | DOM_SIMD_REDUCE_SIGNED:
+            accv = _mm256_min_epi32(accv, v);
+            break;
+        default:
+            accv = _mm256_max_epi32(accv, v);
+            break;
+        }
+    }
+    _mm256_storeu_si256((__m256i*)lanes, accv);
+    acc = dom_simd_generic_reduce_32((const unsigned char*)lanes, 8u, mode, lanes[0]);
+    return dom_simd_generic_reduce_32(src + (size_t)i * 4u, count - i, mode, acc);
+}
+
+DOM_SIMD_TARGET_AVX2
+static u64 dom_avx2_reduce_64(const unsigned char* src, u32 count, u32 mode)
+{
+    const u64 bias = (mode & DOM_SIMD_REDUCE_SIGNED) ? 0u : 0x8000000000000000ull;
+    const __m256i biasv = _mm256_set1_epi64x((long long)bias);
+    u64 first;
+    u64 lanes[8];
+    u64 acc;
+    u32 i = 0u;
+    __m256i accv;
+    __m256i accw;
+
+    memcpy(&first, src, sizeof(first));
+    accv = _mm256_set1_epi64x((long long)(first ^ bias));
+    accw = accv;
+    /* Two accumulators hide the compare/blend latency chain. */
+    for (; i + 8u <= count; i += 8u) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(src + (size_t)i * 8u)), biasv);
+        __m256i w = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(src + (size_t)i * 8u + 32u)), biasv);
+        __m256i take_v = (mode & DOM_SIMD_REDUCE_MAX) ? _mm256_cmpgt_epi64(v, accv)
+                                                      : _mm256_cmpgt_epi64(accv, v);
+        __m256i take_w = (mode & DOM_SIMD_REDUCE_MAX) ? _mm256_cmpgt_epi64(w, accw)
+                                                      : _mm256_cmpgt_epi64(accw, w);
+        accv = _mm256_blendv_epi8(accv, v, take_v);
+        accw = _mm256_blendv_epi8(accw, w, take_w);
+    }
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_xor_si256(accv, biasv));
+    _mm256_storeu_si256((__m256i*)(lanes + 4), _mm256_xor_si256(accw, biasv));
+    acc = dom_simd_generic_reduce_64((const unsigned char*)lanes, 8u, mode, lanes[0]);
+    return dom_simd_generic_reduce_64(src + (size_t)i * 8u, count - i, mode, acc);
+}
+
+DOM_SIMD_TARGET_AVX2
+static u32 dom_avx2_zero_mask(const unsigned char* src, u32 width)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i v = _mm256_loadu_si256((const __m256i*)src);
+    if (width == 1u) {
+        return (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+    }
+    if (width == 4u) {
+        return (u32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, zero)));
+    }
+    return (u32)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, zero)));
+}
+
+static u32 dom_avx2_nonzero_bits(const unsigned char* src, u32 width, u32 count)
+{
+    u32 per;
+    u32 lane_mask;
+    u32 bits = 0u;
+    u32 i = 0u;
+    if (width != 1u && width != 4u && width != 8u) {
+        /* 16-bit lanes have no cheap 256-bit movemask; SSE2 handles them. */
+        return dom_sse2_nonzero_bits(src, width, count);
+    }
+    per = 32u / width;
+    lane_mask = (per == 32u) ? 0xFFFFFFFFu : ((1u << per) - 1u);
+    for (; i + per <= count; i += per) {
+        bits |= ((~dom_avx2_zero_mask(src + (size_t)i * width, width)) & lane_mask) << i;
+    }
+    if (i < count) {
+        bits |= dom_sse2_nonzero_bits(src + (size_t)i * width, width, count - i) << i;
+    }
+    return bits;
+}
+
+DOM_SIMD_TARGET_AVX2
+static u32 dom_avx2_popcount_bytes(const unsigned char* bytes, u32 count)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i acc = _mm256_setzero_si256();
+    u64 lanes[4];
+    u32 i = 0u;
+    for (; i + 32u <= count; i += 32u) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(bytes + i));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, low));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), low));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi),
+                                                   _mm256_setzero_si256()));
+    }
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    return (u32)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) +
+           dom_sse2_popcount_bytes(bytes + i, count - i);
+}
+
+const dom_simd_isa dom_simd_isa_avx2 = {
+    DOM_SIMD_CAP_AVX2,
+    dom_avx2_fill_pattern,
+    dom_avx2_sum_32,
+    dom_avx2_sum_64,
+    dom_avx2_reduce_32,
+    dom_avx2_reduce_64,
+    dom_avx2_nonzero_bits,
+    dom_avx2_popcount_bytes
+};
+
+#endif /* DOM_SIMD_ISA_X86 */
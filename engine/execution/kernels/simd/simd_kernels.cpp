@@ -6,13 +6,23 @@ RESPONSIBILITY: SIMD kernel implementations and registration.
 ALLOWED DEPENDENCIES: engine/include public headers and C++98 headers only.
 FORBIDDEN DEPENDENCIES: engine internal headers outside execution.
 DETERMINISM: SIMD variants must match scalar outputs for authoritative tasks.
+NOTES: Kernels are instantiated once per ISA table (simd_isa.h). Contiguous views
+       take the vector paths; strided views fall back to per-element loops that
+       mirror scalar_kernels.cpp.
 */
 #include "simd_kernels.h"
+#include "simd_isa.h"
 #include "op_ids.h"
 #include "scalar_kernels.h"
 
 #include <string.h>
 
+enum {
+    DOM_SIMD_OP_SUM = 0u,
+    DOM_SIMD_OP_MIN = 1u,
+    DOM_SIMD_OP_MAX = 2u
+};
+
 static u32 dom_simd_min_u32(u32 a, u32 b)
 {
     return (a < b) ? a : b;
@@ -56,6 +66,27 @@ static void dom_simd_clamp_range(u32 count, dom_entity_range range, u32* out_sta
     *out_end = end;
 }
 
+/* Width in bytes of the integer element types; 0 for anything else. */
+static u32 dom_simd_int_width(u32 element_type)
+{
+    switch (element_type) {
+    case DOM_ECS_ELEM_U8:
+    case DOM_ECS_ELEM_I8:
+        return 1u;
+    case DOM_ECS_ELEM_U16:
+    case DOM_ECS_ELEM_I16:
+        return 2u;
+    case DOM_ECS_ELEM_U32:
+    case DOM_ECS_ELEM_I32:
+        return 4u;
+    case DOM_ECS_ELEM_U64:
+    case DOM_ECS_ELEM_I64:
+        return 8u;
+    default:
+        return 0u;
+    }
+}
+
 static void dom_simd_mem_copy_view(const dom_kernel_call_context&,
                                    const dom_component_view* inputs,
                                    int input_count,
@@ -71,6 +102,7 @@ static void dom_simd_mem_copy_view(const dom_kernel_call_context&,
     u32 start;
     u32 end;
     u32 i;
+    u32 size;
     unsigned char* src_ptr;
     unsigned char* dst_ptr;
 
@@ -98,13 +130,35 @@ static void dom_simd_mem_copy_view(const dom_kernel_call_context&,
     }
     count = dom_simd_min_u32(src->count, dst->count);
     dom_simd_clamp_range(count, range, &start, &end);
-    for (i = start; i < end; ++i) {
-        size_t src_offset = (size_t)i * src->stride;
-        size_t dst_offset = (size_t)i * dst->stride;
-        memcpy(dst_ptr + dst_offset, src_ptr + src_offset, src->element_size);
+    if (start >= end) {
+        return;
+    }
+    size = src->element_size;
+
+    /* Dense columns collapse to one block copy, which libc already vectorizes. */
+    if (src->stride == size && dst->stride == size) {
+        memcpy(dst_ptr + (size_t)start * size,
+               src_ptr + (size_t)start * size,
+               (size_t)(end - start) * size);
+        return;
+    }
+    /* Fixed-size copies let the compiler emit single moves per element. */
+    if (size == 4u) {
+        for (i = start; i < end; ++i) {
+            memcpy(dst_ptr + (size_t)i * dst->stride, src_ptr + (size_t)i * src->stride, 4u);
+        }
+    } else if (size == 8u) {
+        for (i = start; i < end; ++i) {
+            memcpy(dst_ptr + (size_t)i * dst->stride, src_ptr + (size_t)i * src->stride, 8u);
+        }
+    } else {
+        for (i = start; i < end; ++i) {
+            memcpy(dst_ptr + (size_t)i * dst->stride, src_ptr + (size_t)i * src->stride, size);
+        }
     }
 }
 
+template <const dom_simd_isa& Isa>
 static void dom_simd_mem_fill_view(const dom_kernel_call_context&,
                                    const dom_component_view*,
                                    int,
@@ -119,6 +173,7 @@ static void dom_simd_mem_fill_view(const dom_kernel_call_context&,
     u32 start;
     u32 end;
     u32 i;
+    u32 size;
     unsigned char* dst_ptr;
 
     if (!outputs || output_count < 1 || !params) {
@@ -140,9 +195,21 @@ static void dom_simd_mem_fill_view(const dom_kernel_call_context&,
         return;
     }
     dom_simd_clamp_range(dst->count, range, &start, &end);
+    if (start >= end) {
+        return;
+    }
+    size = dst->element_size;
+
+    if (dst->stride == size && (DOM_SIMD_FILL_PATTERN_BYTES % size) == 0u) {
+        unsigned char pattern[DOM_SIMD_FILL_PATTERN_BYTES];
+        for (i = 0u; i < DOM_SIMD_FILL_PATTERN_BYTES; i += size) {
+            memcpy(pattern + i, fill->value, size);
+        }
+        Isa.fill_pattern(dst_ptr + (size_t)start * size, (size_t)(end - start) * size, pattern);
+        return;
+    }
     for (i = start; i < end; ++i) {
-        size_t dst_offset = (size_t)i * dst->stride;
-        memcpy(dst_ptr + dst_offset, fill->value, dst->element_size);
+        memcpy(dst_ptr + (size_t)i * dst->stride, fill->value, size);
     }
 }
 
@@ -183,22 +250,25 @@ static int dom_simd_reduce_params(const dom_component_view* src,
     return 1;
 }
 
-static void dom_simd_reduce_sum_int(const dom_kernel_call_context&,
-                                    const dom_component_view* inputs,
-                                    int input_count,
-                                    dom_component_view* outputs,
-                                    int output_count,
-                                    const void*,
-                                    size_t,
-                                    dom_entity_range range)
+/* Shared body of the integer reductions; result lands at dst[start] like the scalar path. */
+static void dom_simd_reduce_int(const dom_simd_isa& isa,
+                                u32 op,
+                                const dom_component_view* inputs,
+                                int input_count,
+                                dom_component_view* outputs,
+                                int output_count,
+                                dom_entity_range range)
 {
     const dom_component_view* src;
     dom_component_view* dst;
     u32 start;
     u32 end;
     u32 i;
+    u32 width;
+    u32 mode;
     unsigned char* src_ptr;
     unsigned char* dst_ptr;
+    unsigned char* out;
 
     if (!inputs || !outputs || input_count < 1 || output_count < 1) {
         return;
@@ -208,42 +278,297 @@ static void dom_simd_reduce_sum_int(const dom_kernel_call_context&,
     if (!dom_simd_reduce_params(src, dst, range, &start, &end, &src_ptr, &dst_ptr)) {
         return;
     }
-    if (src->element_type == DOM_ECS_ELEM_U64) {
+    if (src->element_type == DOM_ECS_ELEM_U64 || src->element_type == DOM_ECS_ELEM_I64) {
+        width = 8u;
+    } else if (src->element_type == DOM_ECS_ELEM_U32 || src->element_type == DOM_ECS_ELEM_I32) {
+        width = 4u;
+    } else {
+        return;
+    }
+    mode = (op == DOM_SIMD_OP_MAX) ? DOM_SIMD_REDUCE_MAX : DOM_SIMD_REDUCE_MIN;
+    if (src->element_type == DOM_ECS_ELEM_I64 || src->element_type == DOM_ECS_ELEM_I32) {
+        mode |= DOM_SIMD_REDUCE_SIGNED;
+    }
+    out = dst_ptr + (size_t)start * dst->stride;
+
+    if (src->stride == width) {
+        const unsigned char* base = src_ptr + (size_t)start * width;
+        u32 n = end - start;
+        if (width == 8u) {
+            u64 acc = (op == DOM_SIMD_OP_SUM) ? isa.sum_64(base, n) : isa.reduce_64(base, n, mode);
+            memcpy(out, &acc, sizeof(acc));
+        } else {
+            u32 acc = (op == DOM_SIMD_OP_SUM) ? isa.sum_32(base, n) : isa.reduce_32(base, n, mode);
+            memcpy(out, &acc, sizeof(acc));
+        }
+        return;
+    }
+
+    /* Strided views: same element order as the scalar kernels, branch hoisted. */
+    if (width == 8u) {
         u64 acc;
-        memcpy(&acc, src_ptr + (size_t)start * src->stride, sizeof(u64));
-        for (i = start + 1u; i < end; ++i) {
-            u64 value;
-            memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(u64));
-            acc += value;
+        memcpy(&acc, src_ptr + (size_t)start * src->stride, sizeof(acc));
+        if (op == DOM_SIMD_OP_SUM) {
+            for (i = start + 1u; i < end; ++i) {
+                u64 value;
+                memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(value));
+                acc += value;
+            }
+        } else {
+            for (i = start + 1u; i < end; ++i) {
+                u64 value;
+                memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(value));
+                if (mode & DOM_SIMD_REDUCE_SIGNED) {
+                    if ((mode & DOM_SIMD_REDUCE_MAX) ? ((i64)value > (i64)acc) : ((i64)value < (i64)acc)) {
+                        acc = value;
+                    }
+                } else if ((mode & DOM_SIMD_REDUCE_MAX) ? (value > acc) : (value < acc)) {
+                    acc = value;
+                }
+            }
         }
-        memcpy(dst_ptr + (size_t)start * dst->stride, &acc, sizeof(u64));
-    } else if (src->element_type == DOM_ECS_ELEM_U32) {
+        memcpy(out, &acc, sizeof(acc));
+    } else {
         u32 acc;
-        memcpy(&acc, src_ptr + (size_t)start * src->stride, sizeof(u32));
-        for (i = start + 1u; i < end; ++i) {
-            u32 value;
-            memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(u32));
-            acc += value;
+        memcpy(&acc, src_ptr + (size_t)start * src->stride, sizeof(acc));
+        if (op == DOM_SIMD_OP_SUM) {
+            for (i = start + 1u; i < end; ++i) {
+                u32 value;
+                memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(value));
+                acc += value;
+            }
+        } else {
+            for (i = start + 1u; i < end; ++i) {
+                u32 value;
+                memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(value));
+                if (mode & DOM_SIMD_REDUCE_SIGNED) {
+                    if ((mode & DOM_SIMD_REDUCE_MAX) ? ((i32)value > (i32)acc) : ((i32)value < (i32)acc)) {
+                        acc = value;
+                    }
+                } else if ((mode & DOM_SIMD_REDUCE_MAX) ? (value > acc) : (value < acc)) {
+                    acc = value;
+                }
+            }
+        }
+        memcpy(out, &acc, sizeof(acc));
+    }
+}
+
+template <const dom_simd_isa& Isa, u32 Op>
+static void dom_simd_reduce_int_kernel(const dom_kernel_call_context&,
+                                       const dom_component_view* inputs,
+                                       int input_count,
+                                       dom_component_view* outputs,
+                                       int output_count,
+                                       const void*,
+                                       size_t,
+                                       dom_entity_range range)
+{
+    dom_simd_reduce_int(Isa, Op, inputs, input_count, outputs, output_count, range);
+}
+
+static u32 dom_simd_read_u32_le(const unsigned char* bytes)
+{
+    return (u32)bytes[0] |
+           ((u32)bytes[1] << 8u) |
+           ((u32)bytes[2] << 16u) |
+           ((u32)bytes[3] << 24u);
+}
+
+/* Index of the lowest set bit; value must be nonzero. */
+static u32 dom_simd_lowest_bit64(u64 value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_ctzll(value);
+#else
+    u32 index = 0u;
+    while ((value & 1u) == 0u) {
+        value >>= 1u;
+        index += 1u;
+    }
+    return index;
+#endif
+}
+
+/* Fixed-size moves for the common strides; avoids a libc call per entity. */
+static void dom_simd_copy_entity(unsigned char* dst, const unsigned char* src, u32 stride)
+{
+    switch (stride) {
+    case 1u:
+        dst[0] = src[0];
+        break;
+    case 2u:
+        memcpy(dst, src, 2u);
+        break;
+    case 4u:
+        memcpy(dst, src, 4u);
+        break;
+    case 8u:
+        memcpy(dst, src, 8u);
+        break;
+    default:
+        memcpy(dst, src, stride);
+        break;
+    }
+}
+
+template <const dom_simd_isa& Isa>
+static void dom_simd_apply_delta_packed(const dom_kernel_call_context&,
+                                        const dom_component_view* inputs,
+                                        int input_count,
+                                        dom_component_view* outputs,
+                                        int output_count,
+                                        const void* params,
+                                        size_t,
+                                        dom_entity_range range)
+{
+    const dom_kernel_apply_delta_params* delta_params;
+    const dom_component_view* baseline_view;
+    dom_component_view* out_view;
+    const unsigned char* delta;
+    u32 delta_size;
+    u32 header_bytes;
+    u32 entity_count;
+    u32 stride;
+    u32 bitmask_bytes;
+    u32 payload_bytes;
+    u32 changed_total;
+    u32 output_bytes;
+    u32 baseline_bytes;
+    u32 i;
+    u32 start;
+    u32 end;
+    unsigned char* baseline_ptr;
+    unsigned char* out_ptr;
+    const unsigned char* bitmask;
+    const unsigned char* payload;
+    u32 payload_offset;
+    u32 byte_index;
+
+    if (!inputs || !outputs || input_count < 1 || output_count < 1 || !params) {
+        return;
+    }
+    baseline_view = &inputs[0];
+    out_view = &outputs[0];
+    if (!dom_simd_view_can_read(baseline_view) || !dom_simd_view_can_write(out_view)) {
+        return;
+    }
+    if (baseline_view->element_size != 1u || out_view->element_size != 1u) {
+        return;
+    }
+    if (baseline_view->stride < 1u || out_view->stride < 1u) {
+        return;
+    }
+    baseline_ptr = dom_simd_view_ptr(baseline_view);
+    out_ptr = dom_simd_view_ptr(out_view);
+    if (!baseline_ptr || !out_ptr) {
+        return;
+    }
+    delta_params = (const dom_kernel_apply_delta_params*)params;
+    delta = delta_params->delta_bytes;
+    delta_size = delta_params->delta_size;
+    if (!delta || delta_size < 24u) {
+        return;
+    }
+    header_bytes = 24u;
+    entity_count = dom_simd_read_u32_le(delta + 16u);
+    stride = dom_simd_read_u32_le(delta + 20u);
+    if (stride == 0u) {
+        return;
+    }
+    bitmask_bytes = (entity_count + 7u) / 8u;
+    if (delta_size < header_bytes + bitmask_bytes) {
+        return;
+    }
+    bitmask = delta + header_bytes;
+    payload = bitmask + bitmask_bytes;
+
+    changed_total = Isa.popcount_bytes(bitmask, bitmask_bytes);
+    payload_bytes = changed_total * stride;
+    if (delta_size < header_bytes + bitmask_bytes + payload_bytes) {
+        return;
+    }
+
+    output_bytes = out_view->count * out_view->stride;
+    baseline_bytes = baseline_view->count * baseline_view->stride;
+    if (output_bytes == 0u) {
+        return;
+    }
+    {
+        u32 copy_bytes = dom_simd_min_u32(output_bytes, baseline_bytes);
+        memmove(out_ptr, baseline_ptr, copy_bytes);
+    }
+
+    {
+        u32 max_entities = output_bytes / stride;
+        if (entity_count > max_entities) {
+            entity_count = max_entities;
         }
-        memcpy(dst_ptr + (size_t)start * dst->stride, &acc, sizeof(u32));
-    } else if (src->element_type == DOM_ECS_ELEM_I64) {
-        i64 acc;
-        memcpy(&acc, src_ptr + (size_t)start * src->stride, sizeof(i64));
-        for (i = start + 1u; i < end; ++i) {
-            i64 value;
-            memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(i64));
-            acc += value;
+        dom_simd_clamp_range(entity_count, range, &start, &end);
+    }
+    if (start >= end) {
+        return;
+    }
+
+    /*
+    The payload cursor at `start` is the popcount of the preceding bits. When
+    payload_bytes did not wrap, every changed entity in range stays inside both
+    the payload and the output, so the scalar bounds checks can never fire.
+    */
+    if ((u64)changed_total * (u64)stride > 0xFFFFFFFFull) {
+        payload_offset = 0u;
+        for (i = 0u; i < entity_count; ++i) {
+            if ((bitmask[i / 8u] & (1u << (i % 8u))) == 0u) {
+                continue;
+            }
+            if (payload_offset + stride > payload_bytes) {
+                break;
+            }
+            if (i >= start && i < end) {
+                u32 dst_offset = i * stride;
+                if (dst_offset + stride <= output_bytes) {
+                    memcpy(out_ptr + dst_offset, payload + payload_offset, stride);
+                }
+            }
+            payload_offset += stride;
         }
-        memcpy(dst_ptr + (size_t)start * dst->stride, &acc, sizeof(i64));
-    } else if (src->element_type == DOM_ECS_ELEM_I32) {
-        i32 acc;
-        memcpy(&acc, src_ptr + (size_t)start * src->stride, sizeof(i32));
-        for (i = start + 1u; i < end; ++i) {
-            i32 value;
-            memcpy(&value, src_ptr + (size_t)i * src->stride, sizeof(i32));
-            acc += value;
+        return;
+    }
+
+    payload_offset = Isa.popcount_bytes(bitmask, start / 8u);
+    if ((start % 8u) != 0u) {
+        u8 head = (u8)(bitmask[start / 8u] & ((1u << (start % 8u)) - 1u));
+        payload_offset += Isa.popcount_bytes(&head, 1u);
+    }
+    payload_offset *= stride;
+
+    /* Walk 64 mask bits at a time and visit only the set ones. */
+    for (byte_index = start / 8u; byte_index * 8u < end; byte_index += 8u) {
+        u32 base = byte_index * 8u;
+        u64 bits = 0u;
+        if (byte_index + 8u <= bitmask_bytes) {
+            u32 k;
+            for (k = 0u; k < 8u; ++k) {
+                bits |= (u64)bitmask[byte_index + k] << (k * 8u);
+            }
+        } else {
+            u32 k;
+            for (k = 0u; byte_index + k < bitmask_bytes; ++k) {
+                bits |= (u64)bitmask[byte_index + k] << (k * 8u);
+            }
+        }
+        if (base < start) {
+            bits &= ~(u64)0u << (start - base);
+        }
+        if (end - base < 64u) {
+            bits &= ((u64)1u << (end - base)) - 1u;
+        }
+        while (bits != 0u) {
+            u32 entity = base + dom_simd_lowest_bit64(bits);
+            bits &= bits - 1u;
+            dom_simd_copy_entity(out_ptr + (size_t)entity * stride, payload + payload_offset, stride);
+            payload_offset += stride;
         }
-        memcpy(dst_ptr + (size_t)start * dst->stride, &acc, sizeof(i32));
     }
 }
 
@@ -279,6 +604,7 @@ static u64 dom_simd_read_value_nonzero(const dom_component_view* view,
     return 0u;
 }
 
+template <const dom_simd_isa& Isa>
 static void dom_simd_build_visibility_mask(const dom_kernel_call_context&,
                                            const dom_component_view* inputs,
                                            int input_count,
@@ -296,6 +622,7 @@ static void dom_simd_build_visibility_mask(const dom_kernel_call_context&,
     u32 start;
     u32 end;
     u32 i;
+    u32 width;
     unsigned char* src_ptr;
     unsigned char* dst_ptr;
 
@@ -331,6 +658,26 @@ static void dom_simd_build_visibility_mask(const dom_kernel_call_context&,
     }
     dom_simd_clamp_range(entity_count, range, &start, &end);
 
+    width = dom_simd_int_width(src->element_type);
+    if (width != 0u && src->stride == width) {
+        /* One read-modify-write per 32-entity word, bits outside the range kept. */
+        i = start;
+        while (i < end) {
+            u32 word_index = i / 32u;
+            u32 lo = i % 32u;
+            u32 n = dom_simd_min_u32(32u - lo, end - i);
+            u32 range_bits = ((n == 32u) ? 0xFFFFFFFFu : ((1u << n) - 1u)) << lo;
+            u32 visible = Isa.nonzero_bits(src_ptr + (size_t)i * width, width, n) << lo;
+            unsigned char* word_ptr = dst_ptr + (size_t)word_index * dst->stride;
+            u32 word;
+            memcpy(&word, word_ptr, sizeof(word));
+            word = (word & ~range_bits) | visible;
+            memcpy(word_ptr, &word, sizeof(word));
+            i += n;
+        }
+        return;
+    }
+
     for (i = start; i < end; ++i) {
         u32 word_index = i / 32u;
         u32 bit_index = i % 32u;
@@ -345,28 +692,74 @@ static void dom_simd_build_visibility_mask(const dom_kernel_call_context&,
     }
 }
 
-void dom_register_simd_kernels(dom_kernel_registry* registry,
-                               const dom_simd_caps* caps)
+template <const dom_simd_isa& Isa>
+static void dom_simd_register_isa(dom_kernel_registry* registry)
 {
     dom_kernel_metadata meta;
-    u32 required_caps;
-    if (!registry || !caps) {
-        return;
-    }
-    if ((caps->mask & DOM_SIMD_CAP_ANY) == 0u) {
-        return;
-    }
-    required_caps = caps->mask & DOM_SIMD_CAP_ANY;
-    meta.capability_mask = required_caps;
+    meta.capability_mask = Isa.cap;
     meta.deterministic = D_TRUE;
     meta.flags = 0u;
 
     dom_kernel_register(registry, DOM_OP_MEM_COPY_VIEW, DOM_KERNEL_BACKEND_SIMD,
                         dom_simd_mem_copy_view, &meta);
     dom_kernel_register(registry, DOM_OP_MEM_FILL_VIEW, DOM_KERNEL_BACKEND_SIMD,
-                        dom_simd_mem_fill_view, &meta);
+                        dom_simd_mem_fill_view<Isa>, &meta);
     dom_kernel_register(registry, DOM_OP_REDUCE_SUM_INT, DOM_KERNEL_BACKEND_SIMD,
-                        dom_simd_reduce_sum_int, &meta);
+                        dom_simd_reduce_int_kernel<Isa, DOM_SIMD_OP_SUM>, &meta);
+    dom_kernel_register(registry, DOM_OP_REDUCE_MIN_INT, DOM_KERNEL_BACKEND_SIMD,
+                        dom_simd_reduce_int_kernel<Isa, DOM_SIMD_OP_MIN>, &meta);
+    dom_kernel_register(registry, DOM_OP_REDUCE_MAX_INT, DOM_KERNEL_BACKEND_SIMD,
+                        dom_simd_reduce_int_kernel<Isa, DOM_SIMD_OP_MAX>, &meta);
+    dom_kernel_register(registry, DOM_OP_APPLY_DELTA_PACKED, DOM_KERNEL_BACKEND_SIMD,
+                        dom_simd_apply_delta_packed<Isa>, &meta);
     dom_kernel_register(registry, DOM_OP_BUILD_VISIBILITY_MASK, DOM_KERNEL_BACKEND_SIMD,
-                        dom_simd_build_visibility_mask, &meta);
+                        dom_simd_build_visibility_mask<Isa>, &meta);
+}
+
+u32 dom_simd_kernel_tier(const dom_simd_caps* caps)
+{
+    if (!caps) {
+        return 0u;
+    }
+#if DOM_SIMD_ISA_X86
+    if (caps->mask & DOM_SIMD_CAP_AVX2) {
+        return DOM_SIMD_CAP_AVX2;
+    }
+    if (caps->mask & DOM_SIMD_CAP_SSE2) {
+        return DOM_SIMD_CAP_SSE2;
+    }
+#endif
+#if DOM_SIMD_ISA_NEON
+    if (caps->mask & DOM_SIMD_CAP_NEON) {
+        return DOM_SIMD_CAP_NEON;
+    }
+#endif
+    return 0u;
+}
+
+void dom_register_simd_kernels(dom_kernel_registry* registry,
+                               const dom_simd_caps* caps)
+{
+    u32 tier;
+    if (!registry || !caps) {
+        return;
+    }
+    tier = dom_simd_kernel_tier(caps);
+#if DOM_SIMD_ISA_X86
+    if (tier == DOM_SIMD_CAP_AVX2) {
+        dom_simd_register_isa<dom_simd_isa_avx2>(registry);
+        return;
+    }
+    if (tier == DOM_SIMD_CAP_SSE2) {
+        dom_simd_register_isa<dom_simd_isa_sse2>(registry);
+        return;
+    }
+#endif
+#if DOM_SIMD_ISA_NEON
+    if (tier == DOM_SIMD_CAP_NEON) {
+        dom_simd_register_isa<dom_simd_isa_neon>(registry);
+        return;
+    }
+#endif
+    (void)tier;
 }
@@ -16,6 +16,11 @@ DETERMINISM: SIMD variants must match scalar outputs for authoritative tasks.
 
 #include "kernel_registry.h"
 
+/* DOM_SIMD_CAP_* bit of the instruction set the SIMD backend would use for
+   caps (AVX2 > SSE2 > NEON), or 0 when no SIMD kernels are registered. */
+u32 dom_simd_kernel_tier(const dom_simd_caps* caps);
+
+/* Registers one SIMD entry per op, built for dom_simd_kernel_tier(caps). */
 void dom_register_simd_kernels(dom_kernel_registry* registry,
                                const dom_simd_caps* caps);
 
@@ -0,0 +1,313 @@
+/*
+FILE: source/domino/execution/scheduler/scheduler_graph.cpp
+MODULE: Domino
+RESPONSIBILITY: Shared TaskGraph validation and edge resolution for EXEC2/EXEC3 schedulers.
+*/
+#include "scheduler_graph.h"
+
+static d_bool task_is_valid(const dom_task_node *node) {
+    if (!node) {
+        return D_FALSE;
+    }
+    if (node->category > DOM_TASK_PRESENTATION) {
+        return D_FALSE;
+    }
+    if (node->determinism_class > DOM_DET_DERIVED) {
+        return D_FALSE;
+    }
+    if (node->fidelity_tier > DOM_FID_FOCUS) {
+        return D_FALSE;
+    }
+    if (node->access_set_id == 0u) {
+        return D_FALSE;
+    }
+    if (node->law_scope_ref == 0u) {
+        return D_FALSE;
+    }
+    if (node->category == DOM_TASK_AUTHORITATIVE) {
+        if (!node->law_targets || node->law_target_count == 0u) {
+            return D_FALSE;
+        }
+    }
+    if (node->commit_key.phase_id != node->phase_id) {
+        return D_FALSE;
+    }
+    if (node->commit_key.task_id != node->task_id) {
+        return D_FALSE;
+    }
+    return D_TRUE;
+}
+
+static u64 fingerprint_mix(u64 h, u64 v) {
+    h ^= v;
+    h *= 0x9E3779B97F4A7C15ull;
+    h ^= h >> 29;
+    return h;
+}
+
+u64 dom_sched_graph_fingerprint(const dom_task_graph &graph) {
+    u64 h = 0xCBF29CE484222325ull;
+    u32 i;
+    h = fingerprint_mix(h, ((u64)graph.task_count << 32) | (u64)graph.dependency_count);
+    if (graph.tasks) {
+        for (i = 0u; i < graph.task_count; ++i) {
+            const dom_task_node *node = &graph.tasks[i];
+            h = fingerprint_mix(h, node->task_id);
+            h = fingerprint_mix(h, ((u64)node->phase_id << 32) | (u64)node->category);
+            h = fingerprint_mix(h, ((u64)node->determinism_class << 32) | (u64)node->fidelity_tier);
+            h = fingerprint_mix(h, node->access_set_id);
+            h = fingerprint_mix(h, node->law_scope_ref);
+            h = fingerprint_mix(h, ((u64)node->law_target_count << 1) | (node->law_targets ? 1u : 0u));
+            h = fingerprint_mix(h, node->commit_key.task_id);
+            h = fingerprint_mix(h, (u64)node->commit_key.phase_id);
+        }
+    }
+    h = fingerprint_mix(h, graph.dependency_edges ? 1u : 0u);
+    if (graph.dependency_edges) {
+        for (i = 0u; i < graph.dependency_count; ++i) {
+            h = fingerprint_mix(h, graph.dependency_edges[i].from_task_id);
+            h = fingerprint_mix(h, graph.dependency_edges[i].to_task_id);
+        }
+    }
+    return h;
+}
+
+static u32 task_id_hash(u64 task_id) {
+    task_id ^= task_id >> 33;
+    task_id *= 0xFF51AFD7ED558CCDull;
+    task_id ^= task_id >> 33;
+    return (u32)task_id;
+}
+
+/* Open-addressing task id -> index table; slots hold index + 1. Duplicate
+ * ids resolve to their first task, as a front-to-back scan would. */
+static u32 *task_index_build(const dom_task_graph &graph, u32 *out_mask) {
+    u32 capacity = 16u;
+    u32 *slots;
+    u32 i;
+    while (capacity < graph.task_count * 2u) {
+        capacity *= 2u;
+    }
+    slots = new u32[capacity];
+    for (i = 0u; i < capacity; ++i) {
+        slots[i] = 0u;
+    }
+    for (i = 0u; i < graph.task_count; ++i) {
+        u32 slot = task_id_hash(graph.tasks[i].task_id) & (capacity - 1u);
+        while (slots[slot] != 0u && graph.tasks[slots[slot] - 1u].task_id != graph.tasks[i].task_id) {
+            slot = (slot + 1u) & (capacity - 1u);
+        }
+        if (slots[slot] == 0u) {
+            slots[slot] = i + 1u;
+        }
+    }
+    *out_mask = capacity - 1u;
+    return slots;
+}
+
+static int task_index_find(const dom_task_graph &graph, const u32 *slots, u32 mask, u64 task_id) {
+    u32 slot = task_id_hash(task_id) & mask;
+    while (slots[slot] != 0u) {
+        if (graph.tasks[slots[slot] - 1u].task_id == task_id) {
+            return (int)(slots[slot] - 1u);
+        }
+        slot = (slot + 1u) & mask;
+    }
+    return -1;
+}
+
+/* Kahn's algorithm over the in-phase edges; every cycle lies inside one
+ * phase because backward phase edges are rejected. */
+static d_bool graph_has_cycle(const dom_sched_graph *g) {
+    u32 *pending;
+    u32 *queue;
+    u32 head = 0u;
+    u32 tail = 0u;
+    u32 i;
+    if (g->task_count == 0u) {
+        return D_FALSE;
+    }
+    pending = new u32[g->task_count];
+    queue = new u32[g->task_count];
+    for (i = 0u; i < g->task_count; ++i) {
+        pending[i] = g->indegree[i];
+        if (pending[i] == 0u) {
+            queue[tail++] = i;
+        }
+    }
+    while (head < tail) {
+        u32 from = queue[head++];
+        u32 e;
+        for (e = g->succ_start[from]; e < g->succ_start[from + 1u]; ++e) {
+            u32 to = g->succ[e];
+            pending[to] -= 1u;
+            if (pending[to] == 0u) {
+                queue[tail++] = to;
+            }
+        }
+    }
+    delete[] pending;
+    delete[] queue;
+    return (tail < g->task_count) ? D_TRUE : D_FALSE;
+}
+
+void dom_sched_graph_init(dom_sched_graph *g) {
+    if (!g) {
+        return;
+    }
+    g->fingerprint = 0u;
+    g->compiled = D_FALSE;
+    g->valid = D_FALSE;
+    g->task_count = 0u;
+    g->succ_start = 0;
+    g->succ = 0;
+    g->indegree = 0;
+}
+
+void dom_sched_graph_free(dom_sched_graph *g) {
+    if (!g) {
+        return;
+    }
+    delete[] g->succ_start;
+    delete[] g->succ;
+    delete[] g->indegree;
+    dom_sched_graph_init(g);
+}
+
+static d_bool graph_compile(const dom_task_graph &graph, dom_sched_graph *out) {
+    u32 i;
+    u32 edge_count = graph.dependency_count;
+    u32 *slots;
+    u32 mask = 0u;
+    u32 *edge_from;
+    u32 *edge_to;
+    u32 *fill;
+    u32 in_phase = 0u;
+
+    for (i = 0u; i < graph.task_count; ++i) {
+        if (task_is_valid(&graph.tasks[i]) == D_FALSE) {
+            return D_FALSE;
+        }
+    }
+    if (edge_count > 0u && !graph.dependency_edges) {
+        return D_FALSE;
+    }
+    slots = task_index_build(graph, &mask);
+    edge_from = new u32[edge_count];
+    edge_to = new u32[edge_count];
+    for (i = 0u; i < edge_count; ++i) {
+        const dom_dependency_edge *edge = &graph.dependency_edges[i];
+        int from_index = task_index_find(graph, slots, mask, edge->from_task_id);
+        int to_index = task_index_find(graph, slots, mask, edge->to_task_id);
+        if (from_index < 0 || to_index < 0 ||
+            graph.tasks[from_index].phase_id > graph.tasks[to_index].phase_id) {
+            delete[] slots;
+            delete[] edge_from;
+            delete[] edge_to;
+            return D_FALSE;
+        }
+        edge_from[i] = (u32)from_index;
+        edge_to[i] = (u32)to_index;
+        if (graph.tasks[from_index].phase_id == graph.tasks[to_index].phase_id) {
+            in_phase += 1u;
+        }
+    }
+    delete[] slots;
+
+    out->task_count = graph.task_count;
+    out->succ_start = new u32[graph.task_count + 1u];
+    out->succ = new u32[in_phase];
+    out->indegree = new u32[graph.task_count];
+    fill = new u32[graph.task_count];
+    for (i = 0u; i <= graph.task_count; ++i) {
+        out->succ_start[i] = 0u;
+    }
+    for (i = 0u; i < graph.task_count; ++i) {
+        out->indegree[i] = 0u;
+    }
+    for (i = 0u; i < edge_count; ++i) {
+        if (graph.tasks[edge_from[i]].phase_id == graph.tasks[edge_to[i]].phase_id) {
+            out->succ_start[edge_from[i] + 1u] += 1u;
+        }
+    }
+    for (i = 0u; i < graph.task_count; ++i) {
+        out->succ_start[i + 1u] += out->succ_start[i];
+        fill[i] = out->succ_start[i];
+    }
+    for (i = 0u; i < edge_count; ++i) {
+        if (graph.tasks[edge_from[i]].phase_id == graph.tasks[edge_to[i]].phase_id) {
+            out->succ[fill[edge_from[i]]++] = edge_to[i];
+            out->indegree[edge_to[i]] += 1u;
+        }
+    }
+    delete[] fill;
+    delete[] edge_from;
+    delete[] edge_to;
+    return (graph_has_cycle(out) == D_TRUE) ? D_FALSE : D_TRUE;
+}
+
+d_bool dom_sched_graph_compile(const dom_task_graph &graph, dom_sched_graph *out) {
+    if (!out) {
+        return D_FALSE;
+    }
+    dom_sched_graph_free(out);
+    out->fingerprint = dom_sched_graph_fingerprint(graph);
+    out->compiled = D_TRUE;
+    out->task_count = graph.task_count;
+    if (graph.task_count > 0u && !graph.tasks) {
+        return D_FALSE;
+    }
+    out->valid = graph_compile(graph, out);
+    return out->valid;
+}
+
+const dom_sched_graph *dom_sched_graph_acquire(dom_sched_graph *cache,
+                                               const dom_task_graph &graph) {
+    if (!cache) {
+        return 0;
+    }
+    if (cache->compiled == D_FALSE ||
+        cache->task_count != graph.task_count ||
+        cache->fingerprint != dom_sched_graph_fingerprint(graph)) {
+        (void)dom_sched_graph_compile(graph, cache);
+    }
+    return (cache->valid == D_TRUE) ? cache : 0;
+}
+
+void dom_sched_ready_push(u32 *heap, u32 *count, u32 task_index) {
+    u32 pos = *count;
+    *count += 1u;
+    while (pos > 0u) {
+        u32 parent = (pos - 1u) / 2u;
+        if (heap[parent] <= task_index) {
+            break;
+        }
+        heap[pos] = heap[parent];
+        pos = parent;
+    }
+    heap[pos] = task_index;
+}
+
+u32 dom_sched_ready_pop(u32 *heap, u32 *count) {
+    u32 top = heap[0];
+    u32 last;
+    u32 pos = 0u;
+    *count -= 1u;
+    last = heap[*count];
+    for (;;) {
+        u32 child = pos * 2u + 1u;
+        if (child >= *count) {
+            break;
+        }
+        if (child + 1u < *count && heap[child + 1u] < heap[child]) {
+            child += 1u;
+        }
+        if (heap[child] >= last) {
+            break;
+        }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = last;
+    return top;
+}
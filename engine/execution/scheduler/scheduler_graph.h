@@ -0,0 +1,53 @@
+/*
+FILE: source/domino/execution/scheduler/scheduler_graph.h
+MODULE: Domino
+RESPONSIBILITY: Shared TaskGraph validation and edge resolution for EXEC2/EXEC3 schedulers.
+*/
+#ifndef DG_SCHEDULER_GRAPH_H
+#define DG_SCHEDULER_GRAPH_H
+
+#include "domino/execution/task_graph.h"
+
+#ifdef __cplusplus
+
+/* Validated, index-resolved form of a dom_task_graph.
+ *
+ * Only edges whose endpoints share a phase are kept (cross-phase edges are
+ * satisfied by phase order). They are stored per source task, in their
+ * original order: successors of task i are succ[succ_start[i] ..
+ * succ_start[i + 1]). indegree[i] counts in-phase predecessors. */
+struct dom_sched_graph {
+    u64 fingerprint;   /* dom_sched_graph_fingerprint of the compiled graph */
+    d_bool compiled;   /* fingerprint/valid describe a compile */
+    d_bool valid;
+    u32 task_count;
+    u32 *succ_start;
+    u32 *succ;
+    u32 *indegree;
+};
+
+void dom_sched_graph_init(dom_sched_graph *g);
+void dom_sched_graph_free(dom_sched_graph *g);
+
+/* Hash of everything compilation depends on: task ids, phases, validated
+ * node fields and dependency edges. */
+u64 dom_sched_graph_fingerprint(const dom_task_graph &graph);
+
+/* Validates task nodes and dependency edges and builds the compiled form in
+ * O(V + E). Returns D_FALSE (and marks out invalid) on invalid nodes,
+ * unknown task ids, backward phase edges or cycles. */
+d_bool dom_sched_graph_compile(const dom_task_graph &graph, dom_sched_graph *out);
+
+/* Returns `cache`, recompiled only when the graph's fingerprint differs from
+ * the last compile; NULL when the graph is invalid. */
+const dom_sched_graph *dom_sched_graph_acquire(dom_sched_graph *cache,
+                                               const dom_task_graph &graph);
+
+/* Min-heap of ready task indices. Popping the smallest index reproduces the
+ * reference pick: the first unscheduled task without pending predecessors. */
+void dom_sched_ready_push(u32 *heap, u32 *count, u32 task_index);
+u32 dom_sched_ready_pop(u32 *heap, u32 *count);
+
+#endif /* __cplusplus */
+
+#endif /* DG_SCHEDULER_GRAPH_H */
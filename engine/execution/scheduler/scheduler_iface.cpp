@@ -1,10 +1,16 @@
 /*
 FILE: source/domino/execution/scheduler/scheduler_iface.cpp
 MODULE: Domino
-RESPONSIBILITY: Scheduler interface default destructors.
+RESPONSIBILITY: Scheduler interface default destructors and sink hooks.
 */
 #include "domino/execution/scheduler_iface.h"
 
 IScheduleSink::~IScheduleSink() {}
 
+void IScheduleSink::on_commit(const dom_task_node &) {}
+
+d_bool IScheduleSink::allows_concurrent_tasks() const {
+    return D_FALSE;
+}
+
 IScheduler::~IScheduler() {}
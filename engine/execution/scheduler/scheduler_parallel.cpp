@@ -1,15 +1,288 @@
 /*
 FILE: source/domino/execution/scheduler/scheduler_parallel.cpp
 MODULE: Domino
-RESPONSIBILITY: Deterministic parallel scheduler shim (delegates to EXEC2 reference).
+RESPONSIBILITY: Deterministic parallel scheduler (EXEC3) over a work-stealing thread pool.
 */
 #include "scheduler_parallel.h"
 
+#include "scheduler_graph.h"
 #include "scheduler_single_thread.h"
+#include "thread_pool.h"
+#include "domino/system/dsys_trace.h"
+
+typedef struct dom_par_job {
+    IScheduleSink *sink;
+    dom_task_node node;
+    dom_law_decision decision;
+    u32 level;
+} dom_par_job;
+
+static void par_job_run(void *user_data) {
+    dom_par_job *job = (dom_par_job *)user_data;
+    if (job && job->sink) {
+        DSYS_TRACE_BEGIN("sched.task", job->node.task_id);
+        job->sink->on_task(job->node, job->decision);
+        DSYS_TRACE_END("sched.task");
+    }
+}
+
+static void push_event(dom_audit_event *events,
+                       u32 *event_count,
+                       u32 event_id,
+                       u64 task_id,
+                       u32 decision_kind,
+                       u32 refusal_code) {
+    dom_audit_event *event = &events[*event_count];
+    event->event_id = event_id;
+    event->task_id = task_id;
+    event->decision_kind = decision_kind;
+    event->refusal_code = refusal_code;
+    *event_count += 1u;
+}
+
+/* Runs admitted jobs wave by wave; jobs in a wave have no pending in-phase
+ * predecessors and pairwise disjoint access sets. */
+static void run_waves(dom_thread_pool *pool,
+                      dom_par_job *jobs,
+                      u32 job_count,
+                      u32 level_count) {
+    u32 *wave_start;
+    u32 *order;
+    u32 i;
+    u32 level;
+
+    if (job_count == 0u) {
+        return;
+    }
+    wave_start = new u32[level_count + 1u];
+    order = new u32[job_count];
+    for (i = 0u; i <= level_count; ++i) {
+        wave_start[i] = 0u;
+    }
+    for (i = 0u; i < job_count; ++i) {
+        wave_start[jobs[i].level + 1u] += 1u;
+    }
+    for (i = 1u; i <= level_count; ++i) {
+        wave_start[i] += wave_start[i - 1u];
+    }
+    for (i = 0u; i < job_count; ++i) {
+        u32 level_i = jobs[i].level;
+        order[wave_start[level_i]] = i;
+        wave_start[level_i] += 1u;
+    }
+    /* wave_start[l] now holds the end of wave l. */
+    i = 0u;
+    for (level = 0u; level < level_count; ++level) {
+        u32 end = wave_start[level];
+        DSYS_TRACE_BEGIN("sched.wave", end - i);
+        if (end - i == 1u) {
+            par_job_run(&jobs[order[i]]);
+        } else if (end > i) {
+            u32 k;
+            for (k = i; k < end; ++k) {
+                dom_thread_pool_task task;
+                task.task_id = jobs[order[k]].node.task_id;
+                task.fn = par_job_run;
+                task.user_data = &jobs[order[k]];
+                if (dom_thread_pool_submit(pool, &task) == D_FALSE) {
+                    par_job_run(&jobs[order[k]]);
+                }
+            }
+            dom_thread_pool_wait(pool);
+        }
+        DSYS_TRACE_END("sched.wave");
+        i = end;
+    }
+    delete[] wave_start;
+    delete[] order;
+}
+
+dom_scheduler_parallel::dom_scheduler_parallel() : m_pool(0) {
+    dom_sched_graph_init(&m_graph);
+    dom_access_conflict_index_init(&m_conflicts);
+}
+
+dom_scheduler_parallel::dom_scheduler_parallel(dom_thread_pool *pool) : m_pool(pool) {
+    dom_sched_graph_init(&m_graph);
+    dom_access_conflict_index_init(&m_conflicts);
+}
+
+dom_scheduler_parallel::~dom_scheduler_parallel() {
+    dom_sched_graph_free(&m_graph);
+    dom_access_conflict_index_free(&m_conflicts);
+}
+
+void dom_scheduler_parallel::set_thread_pool(dom_thread_pool *pool) {
+    m_pool = pool;
+}
+
+dom_thread_pool *dom_scheduler_parallel::thread_pool() const {
+    return m_pool;
+}
 
 void dom_scheduler_parallel::schedule(const dom_task_graph &graph,
                                       dom_execution_context &ctx,
                                       IScheduleSink &sink) {
-    dom_scheduler_single_thread ref;
-    ref.schedule(graph, ctx, sink);
+    u32 i;
+    u32 phase_start = 0u;
+    const dom_sched_graph *compiled;
+    u32 *indegree = 0;
+    u32 *level = 0;
+    u32 *ready = 0;
+    dom_par_job *jobs = 0;
+    dom_task_node *phase_commits = 0;
+    dom_audit_event *events = 0;
+
+    if (!m_pool || m_pool->worker_count == 0u ||
+        sink.allows_concurrent_tasks() == D_FALSE) {
+        m_reference.schedule(graph, ctx, sink);
+        return;
+    }
+    if (!graph.tasks || graph.task_count == 0u) {
+        return;
+    }
+    if (!dom_task_graph_is_sorted(graph.tasks, graph.task_count)) {
+        return;
+    }
+    if (!ctx.lookup_access_set) {
+        return;
+    }
+    compiled = dom_sched_graph_acquire(&m_graph, graph);
+    if (!compiled) {
+        return;
+    }
+    indegree = new u32[graph.task_count];
+    level = new u32[graph.task_count];
+    ready = new u32[graph.task_count];
+    jobs = new dom_par_job[graph.task_count];
+    phase_commits = new dom_task_node[graph.task_count];
+    /* At most TRANSFORMED + ADMITTED + EXECUTED per task. */
+    events = new dom_audit_event[graph.task_count * 3u];
+    for (i = 0u; i < graph.task_count; ++i) {
+        indegree[i] = compiled->indegree[i];
+        level[i] = 0u;
+    }
+
+    while (phase_start < graph.task_count) {
+        u32 phase_id = graph.tasks[phase_start].phase_id;
+        u32 phase_end = phase_start;
+        u32 ready_count = 0u;
+        u32 job_count = 0u;
+        u32 event_count = 0u;
+        u32 level_count = 0u;
+
+        while (phase_end < graph.task_count &&
+               graph.tasks[phase_end].phase_id == phase_id) {
+            phase_end += 1u;
+        }
+        DSYS_TRACE_BEGIN("sched.phase", phase_id);
+        for (i = phase_start; i < phase_end; ++i) {
+            if (indegree[i] == 0u) {
+                dom_sched_ready_push(ready, &ready_count, i);
+            }
+        }
+        dom_access_conflict_index_clear(&m_conflicts);
+
+        /* Admission pass: mirrors EXEC2 pick order and decisions exactly. */
+        while (ready_count > 0u) {
+            u32 global_index = dom_sched_ready_pop(ready, &ready_count);
+            const dom_task_node *orig = &graph.tasks[global_index];
+            dom_task_node working;
+            dom_law_decision decision;
+            const dom_access_set *access = 0;
+            u32 e;
+
+            working = *orig;
+            decision = dom_execution_context_evaluate_law(&ctx, &working);
+            if (decision.kind == DOM_LAW_TRANSFORM) {
+                push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_TRANSFORMED,
+                           orig->task_id, decision.kind, decision.refusal_code);
+                if (decision.transformed_fidelity_tier <= DOM_FID_FOCUS) {
+                    working.fidelity_tier = decision.transformed_fidelity_tier;
+                }
+                if (decision.transformed_next_due_tick != DOM_EXEC_TICK_INVALID) {
+                    working.next_due_tick = decision.transformed_next_due_tick;
+                }
+                decision = dom_execution_context_evaluate_law(&ctx, &working);
+            }
+
+            if (decision.kind == DOM_LAW_REFUSE) {
+                push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_REFUSED,
+                           orig->task_id, decision.kind,
+                           decision.refusal_code ? decision.refusal_code : DOM_EXEC_REFUSE_LAW);
+            } else if (decision.kind == DOM_LAW_TRANSFORM) {
+                push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_REFUSED,
+                           orig->task_id, decision.kind, DOM_EXEC_REFUSE_LAW);
+            } else {
+                access = dom_execution_context_lookup_access_set(&ctx, working.access_set_id);
+                if (!access) {
+                    push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_REFUSED,
+                               orig->task_id, DOM_LAW_REFUSE, DOM_EXEC_REFUSE_ACCESS_SET);
+                } else if (dom_verify_reduction_rules(access) == D_FALSE) {
+                    push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_REFUSED,
+                               orig->task_id, DOM_LAW_REFUSE, DOM_EXEC_REFUSE_REDUCTION);
+                } else if (dom_access_conflict_index_conflicts(&m_conflicts, access) == D_TRUE) {
+                    push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_REFUSED,
+                               orig->task_id, DOM_LAW_REFUSE, DOM_EXEC_REFUSE_CONFLICT);
+                } else {
+                    push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_ADMITTED,
+                               orig->task_id, decision.kind, 0u);
+                    push_event(events, &event_count, DOM_EXEC_AUDIT_TASK_EXECUTED,
+                               orig->task_id, decision.kind, 0u);
+                    jobs[job_count].sink = &sink;
+                    jobs[job_count].node = working;
+                    jobs[job_count].decision = decision;
+                    jobs[job_count].level = level[global_index];
+                    if (level[global_index] + 1u > level_count) {
+                        level_count = level[global_index] + 1u;
+                    }
+                    dom_access_conflict_index_add(&m_conflicts, access);
+                    phase_commits[job_count] = working;
+                    job_count += 1u;
+                }
+            }
+
+            for (e = compiled->succ_start[global_index]; e < compiled->succ_start[global_index + 1u]; ++e) {
+                u32 to_index = compiled->succ[e];
+                if (indegree[to_index] > 0u) {
+                    indegree[to_index] -= 1u;
+                    if (indegree[to_index] == 0u) {
+                        dom_sched_ready_push(ready, &ready_count, to_index);
+                    }
+                }
+                if (level[to_index] < level[global_index] + 1u) {
+                    level[to_index] = level[global_index] + 1u;
+                }
+            }
+        }
+
+        run_waves(m_pool, jobs, job_count, level_count);
+
+        DSYS_TRACE_BEGIN("sched.commit", job_count);
+        for (i = 0u; i < event_count; ++i) {
+            dom_execution_context_record_audit(&ctx, &events[i]);
+        }
+        if (job_count > 1u) {
+            dom_stable_task_sort(phase_commits, job_count);
+        }
+        for (i = 0u; i < job_count; ++i) {
+            dom_audit_event event;
+            event.event_id = DOM_EXEC_AUDIT_TASK_COMMITTED;
+            event.task_id = phase_commits[i].task_id;
+            event.decision_kind = DOM_LAW_ACCEPT;
+            event.refusal_code = 0u;
+            dom_execution_context_record_audit(&ctx, &event);
+            sink.on_commit(phase_commits[i]);
+        }
+        DSYS_TRACE_END("sched.commit");
+        DSYS_TRACE_END("sched.phase");
+        phase_start = phase_end;
+    }
+
+    delete[] indegree;
+    delete[] level;
+    delete[] ready;
+    delete[] jobs;
+    delete[] phase_commits;
+    delete[] events;
 }
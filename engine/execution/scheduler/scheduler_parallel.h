@@ -1,20 +1,50 @@
 /*
 FILE: source/domino/execution/scheduler/scheduler_parallel.h
 MODULE: Domino
-RESPONSIBILITY: Deterministic parallel scheduler shim (delegates to EXEC2 reference).
+RESPONSIBILITY: Deterministic parallel scheduler (EXEC3) over a work-stealing thread pool.
 */
 #ifndef DG_SCHEDULER_PARALLEL_H
 #define DG_SCHEDULER_PARALLEL_H
 
+#include "domino/execution/access_set.h"
 #include "domino/execution/scheduler_iface.h"
+#include "scheduler_graph.h"
+#include "scheduler_single_thread.h"
 
 #ifdef __cplusplus
 
+struct dom_thread_pool;
+
+/* Admission (law, access sets, conflicts) runs serially in the same order as
+ * the EXEC2 reference. Admitted tasks of a phase never conflict, so their
+ * on_task calls are dispatched concurrently in dependency waves; audit events
+ * and commits are then emitted in reference/commit_key order.
+ *
+ * Falls back to the EXEC2 reference when no pool is bound or when the sink
+ * does not allow concurrent tasks. Law evaluation must not depend on on_task
+ * side effects within the same phase. */
 class dom_scheduler_parallel : public IScheduler {
 public:
+    dom_scheduler_parallel();
+    explicit dom_scheduler_parallel(dom_thread_pool *pool);
+    virtual ~dom_scheduler_parallel();
+
+    /* Pool is borrowed; the caller owns its lifetime. NULL disables workers. */
+    void set_thread_pool(dom_thread_pool *pool);
+    dom_thread_pool *thread_pool() const;
+
     virtual void schedule(const dom_task_graph &graph,
                           dom_execution_context &ctx,
                           IScheduleSink &sink);
+
+private:
+    dom_scheduler_parallel(const dom_scheduler_parallel &);
+    dom_scheduler_parallel &operator=(const dom_scheduler_parallel &);
+
+    dom_thread_pool *m_pool;
+    dom_scheduler_single_thread m_reference; /* fallback, keeps its own cache */
+    dom_sched_graph m_graph;
+    dom_access_conflict_index m_conflicts;
 };
 
 #endif /* __cplusplus */
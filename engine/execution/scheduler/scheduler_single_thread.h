@@ -6,7 +6,9 @@ RESPONSIBILITY: Reference single-thread deterministic scheduler (EXEC2).
 #ifndef DG_SCHEDULER_SINGLE_THREAD_H
 #define DG_SCHEDULER_SINGLE_THREAD_H
 
+#include "domino/execution/access_set.h"
 #include "domino/execution/scheduler_iface.h"
+#include "scheduler_graph.h"
 
 #ifdef __cplusplus
 
@@ -26,11 +28,23 @@ enum dom_exec_audit_event_id {
     DOM_EXEC_AUDIT_TASK_COMMITTED  = 5
 };
 
+/* Keeps the compiled form of the last graph it scheduled and reuses it
+ * while the graph fingerprint is unchanged. */
 class dom_scheduler_single_thread : public IScheduler {
 public:
+    dom_scheduler_single_thread();
+    virtual ~dom_scheduler_single_thread();
+
     virtual void schedule(const dom_task_graph &graph,
                           dom_execution_context &ctx,
                           IScheduleSink &sink);
+
+private:
+    dom_scheduler_single_thread(const dom_scheduler_single_thread &);
+    dom_scheduler_single_thread &operator=(const dom_scheduler_single_thread &);
+
+    dom_sched_graph m_graph;
+    dom_access_conflict_index m_conflicts;
 };
 
 #endif /* __cplusplus */
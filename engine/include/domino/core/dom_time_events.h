@@ -20,10 +20,52 @@ typedef struct dom_time_event {
     u64 payload_id;
 } dom_time_event;
 
+/* Hierarchical timing wheel queue state.
+ *
+ * A wheel queue pops in exactly the heap order, (trigger_time, order_key,
+ * event_id), but files events by trigger_time into DOM_TIME_WHEEL_LEVELS levels
+ * of DOM_TIME_WHEEL_SLOTS slots. Events due at or before the wheel cursor sit
+ * in a small "ready" heap that orders them by the full key; events beyond the
+ * wheel horizon (2^30 ticks past the cursor) sit in an overflow heap. Schedule
+ * and cancel of future events inside the horizon are O(1); cancel by handle
+ * also skips the id lookup. The caller provides the wheel and node storage; nodes also
+ * carry the id hash buckets and both heap arrays, so capacity nodes is the only
+ * per-event storage needed.
+ */
+#define DOM_TIME_WHEEL_BITS 6u
+#define DOM_TIME_WHEEL_SLOTS 64u
+#define DOM_TIME_WHEEL_LEVELS 5u
+#define DOM_TIME_EVENT_HANDLE_NONE 0xFFFFFFFFu
+
+typedef struct dom_time_wheel_node {
+    dom_time_event ev;
+    u32 next;        /* slot list or free list */
+    u32 prev;
+    u32 where;       /* slot index, ready/overflow marker or free marker */
+    u32 heap_pos;    /* position in the ready or overflow heap */
+    u32 id_next;     /* chain of live nodes whose event_id hashes alike */
+    u32 id_prev;
+    u32 id_head;     /* id hash bucket headed at this node index */
+    u32 ready_item;  /* ready heap array slot */
+    u32 overflow_item; /* overflow heap array slot */
+} dom_time_wheel_node;
+
+typedef struct dom_time_wheel {
+    dom_time_wheel_node *nodes;
+    u32 capacity;
+    u32 free_head;
+    u32 ready_count;
+    u32 overflow_count;
+    u64 cursor;      /* biased trigger_time of the current slot */
+    u64 occupied[DOM_TIME_WHEEL_LEVELS];
+    u32 heads[DOM_TIME_WHEEL_LEVELS * DOM_TIME_WHEEL_SLOTS];
+} dom_time_wheel;
+
 typedef struct dom_time_event_queue {
     dom_time_event *items;
     u32 capacity;
     u32 count;
+    dom_time_wheel *wheel; /* non-null selects the timing wheel; items unused */
 } dom_time_event_queue;
 
 typedef struct dom_time_event_id_gen {
@@ -33,11 +75,25 @@ typedef struct dom_time_event_id_gen {
 typedef int (*dom_time_event_cb)(void *user, const dom_time_event *ev);
 
 int dom_time_event_queue_init(dom_time_event_queue *q, dom_time_event *storage, u32 capacity);
+/* Timing wheel queue; nodes holds capacity events. start_time seeds the cursor
+ * and only affects speed: events before it still pop first. */
+int dom_time_event_queue_init_wheel(dom_time_event_queue *q,
+                                    dom_time_wheel *wheel,
+                                    dom_time_wheel_node *nodes,
+                                    u32 capacity,
+                                    dom_act_time_t start_time);
 int dom_time_event_queue_size(const dom_time_event_queue *q, u32 *out_count);
 
 int dom_time_event_schedule(dom_time_event_queue *q, const dom_time_event *ev);
 int dom_time_event_cancel(dom_time_event_queue *q, dom_time_event_id event_id);
 
+/* Handle variants. A wheel queue returns the node index as the handle and
+ * cancels it without an id lookup; the handle is checked against event_id so a
+ * stale handle never cancels a different event. Heap queues return
+ * DOM_TIME_EVENT_HANDLE_NONE and cancel by id. */
+int dom_time_event_schedule_handle(dom_time_event_queue *q, const dom_time_event *ev, u32 *out_handle);
+int dom_time_event_cancel_handle(dom_time_event_queue *q, u32 handle, dom_time_event_id event_id);
+
 int dom_time_event_peek(const dom_time_event_queue *q, dom_time_event *out_ev);
 int dom_time_event_pop(dom_time_event_queue *q, dom_time_event *out_ev);
 int dom_time_event_next_time(const dom_time_event_queue *q, dom_act_time_t *out_time);
@@ -19,6 +19,29 @@ VERSIONING / ABI / DATA FORMAT NOTES: Public header; see `docs/reference/specs/S
 extern "C" {
 #endif
 
+/*
+Wire format (little-endian):
+  u64 view_id, u64 baseline_id, u32 entity_count, u32 stride
+  [u32 flags, u32 baseline_count]   only when DOM_DELTA_STRIDE_EXTENDED is set
+  bitmask                           one bit per common row, LSB first
+  changed rows                      in row order
+  appended rows                     rows baseline_count..entity_count-1
+Without the extended header both views have entity_count rows and changed
+rows are raw. Rows past entity_count in the baseline are removed.
+*/
+#define DOM_DELTA_HEADER_BYTES 24u
+#define DOM_DELTA_HEADER_EXT_BYTES 8u
+#define DOM_DELTA_STRIDE_EXTENDED 0x80000000u
+
+enum {
+    DOM_DELTA_BUILD_NONE = 0u,
+    /* Rows carry each field XORed with its baseline value as a LEB128
+     * varint; appended rows carry the plain value. Needs view fields. */
+    DOM_DELTA_BUILD_XOR_VARINT = 1u << 0,
+    /* Allows baseline and current entity counts to differ. */
+    DOM_DELTA_BUILD_RESIZE = 1u << 1
+};
+
 typedef struct dom_packed_delta_info {
     u64 view_id;
     u64 baseline_id;
@@ -28,13 +51,38 @@ typedef struct dom_packed_delta_info {
     u32 bitmask_bytes;
     u32 payload_bytes;
     u32 total_bytes;
+    u32 flags;          /* DOM_DELTA_BUILD_XOR_VARINT when rows are varints */
+    u32 baseline_count;
+    u32 appended_count;
+    u32 removed_count;
 } dom_packed_delta_info;
 
+/* Same as dom_delta_build_ex with DOM_DELTA_BUILD_NONE. */
 int dom_delta_build(const dom_packed_view* baseline,
                     const dom_packed_view* current,
                     unsigned char* out_bytes,
                     u32 out_capacity,
                     dom_packed_delta_info* out_info);
+/* Returns 0, or -1 null args, -2 view mismatch, -3 shape mismatch, -4 missing
+ * bytes, -5 bad stride or field layout, -6 out_capacity too small. The short
+ * header is used whenever flags allow it, so equal-count raw deltas stay
+ * byte-identical to dom_delta_build. */
+int dom_delta_build_ex(const dom_packed_view* baseline,
+                       const dom_packed_view* current,
+                       u32 flags,
+                       unsigned char* out_bytes,
+                       u32 out_capacity,
+                       dom_packed_delta_info* out_info);
+/* Rebuilds the current view into target from baseline plus a delta. target
+ * needs baseline's stride and room for the new rows; it may be baseline
+ * itself. Returns 0, or -1 null args, -2 view mismatch, -3 baseline id, count
+ * or stride mismatch, -4 missing bytes, -5 target too small, -6 malformed
+ * delta. target is left stale on -6. */
+int dom_delta_apply(const dom_packed_view* baseline,
+                    const unsigned char* bytes,
+                    u32 byte_count,
+                    dom_packed_view* target,
+                    dom_packed_delta_info* out_info);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -75,6 +75,36 @@ d_bool dom_detect_access_conflicts(const dom_access_set *a, const dom_access_set
 /* Verify deterministic reduction rules for a single AccessSet. */
 d_bool dom_verify_reduction_rules(const dom_access_set *set);
 
+/* Conflict index over a growing group of AccessSets.
+ *
+ * dom_access_conflict_index_conflicts(idx, a) answers exactly what
+ * dom_detect_access_conflicts(a, s) ORed over every added set s would, but
+ * ranges are bucketed by (component_id, field_id) and each bucket keeps its
+ * index ranges sorted by start, so a query is a binary search per range.
+ */
+typedef struct dom_access_conflict_bucket dom_access_conflict_bucket;
+
+#define DOM_ACCESS_CONFLICT_OP_SLOTS 16u
+
+typedef struct dom_access_conflict_index {
+    dom_access_conflict_bucket *buckets;  /* open addressing, power of two */
+    u32 bucket_capacity;
+    u32 bucket_count;
+    u32 set_count;
+    u32 reducer_count;                    /* sets with reduce ranges */
+    u32 malformed_count;                  /* sets with NULL range arrays */
+    u32 sets_by_op[DOM_ACCESS_CONFLICT_OP_SLOTS];
+    u32 reducers_by_op[DOM_ACCESS_CONFLICT_OP_SLOTS];
+} dom_access_conflict_index;
+
+void dom_access_conflict_index_init(dom_access_conflict_index *idx);
+void dom_access_conflict_index_free(dom_access_conflict_index *idx);
+/* Forgets every added set; keeps storage. */
+void dom_access_conflict_index_clear(dom_access_conflict_index *idx);
+void dom_access_conflict_index_add(dom_access_conflict_index *idx, const dom_access_set *set);
+d_bool dom_access_conflict_index_conflicts(const dom_access_conflict_index *idx,
+                                           const dom_access_set *set);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -24,6 +24,13 @@ public:
     virtual ~IScheduleSink();
     virtual void on_task(const dom_task_node &node,
                          const dom_law_decision &decision) = 0;
+    /* Called once per committed task, in commit_key order, after every
+     * on_task of the phase has returned. Default: no-op. */
+    virtual void on_commit(const dom_task_node &node);
+    /* Return D_TRUE if on_task may run concurrently for admitted tasks of the
+     * same phase (EXEC3). Such sinks must confine on_task side effects to
+     * per-task state and publish them from on_commit. Default: D_FALSE. */
+    virtual d_bool allows_concurrent_tasks() const;
 };
 
 class IScheduler {
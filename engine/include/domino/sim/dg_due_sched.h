@@ -34,6 +34,7 @@ typedef struct dg_due_entry {
     void*             user;
     u64               stable_key;
     dom_time_event_id event_id;
+    u32               event_handle; /* queue handle of event_id */
     dom_act_time_t    next_due;
     dg_due_vtable     vtable;
     int               in_use;
@@ -55,6 +56,16 @@ int dg_due_scheduler_init(dg_due_scheduler* sched,
                           u32 entry_capacity,
                           dom_act_time_t start_tick);
 
+/* Same scheduler on a timing wheel queue (see dom_time_event_queue_init_wheel);
+ * refresh and unregister then cancel in O(1). Processing order is unchanged. */
+int dg_due_scheduler_init_wheel(dg_due_scheduler* sched,
+                                dom_time_wheel* wheel,
+                                dom_time_wheel_node* event_nodes,
+                                u32 event_capacity,
+                                dg_due_entry* entry_storage,
+                                u32 entry_capacity,
+                                dom_act_time_t start_tick);
+
 int dg_due_scheduler_register(dg_due_scheduler* sched,
                               const dg_due_vtable* vtable,
                               void* user,
@@ -59,6 +59,14 @@ d_bool   d_world_save_tlv(const d_world* world, const char* path);
 d_world* d_world_load_tlv(const char* path);
 /* Purpose: Deterministically clone a world without file IO. */
 d_world* d_world_clone(const d_world* world);
+/* Purpose: Serialize a world into an in-memory image without file IO.
+ * Returns: 0 on success; `*out_bytes` is heap-allocated and released with free().
+ */
+int      d_world_save_image(const d_world* world, unsigned char** out_bytes, u32* out_len);
+/* Purpose: Rebuild a world from an image produced by `d_world_save_image`.
+ * Returns: Non-NULL on success; NULL on malformed input.
+ */
+d_world* d_world_load_image(const unsigned char* bytes, u32 len);
 
 #ifdef __cplusplus
 } /* extern "C" */
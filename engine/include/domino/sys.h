@@ -562,6 +562,17 @@ long   dsys_file_tell(void* fh);
  */
 int    dsys_file_close(void* fh);
 
+/* Purpose: Map a whole file read-only into memory (POSIX mmap).
+ * Parameters: `out_data`/`out_size` receive the mapped bytes; both non-NULL.
+ * Returns: Opaque map handle, or NULL when mapping is unsupported on this
+ * platform, the path is blocked by the IO guard, the file is empty, or on
+ * failure. Callers fall back to `dsys_file_open`/`dsys_file_read`.
+ * The bytes stay valid until `dsys_file_unmap`.
+ */
+void*  dsys_file_map(const char* path, const void** out_data, size_t* out_size);
+/* Purpose: Release a mapping returned by `dsys_file_map` (NULL is a no-op). */
+void   dsys_file_unmap(void* map);
+
 /* dsys_dir_entry: Public type used by `sys`. */
 typedef struct dsys_dir_entry {
     char name[260];
@@ -5,7 +5,7 @@ LAYER / SUBSYSTEM: Domino API / system/dsys_perf
 RESPONSIBILITY: Defines public contract for profiling counters, timers, and telemetry output; does NOT provide implementation.
 ALLOWED DEPENDENCIES: `include/domino/**` plus C89/C++98 standard headers as needed.
 FORBIDDEN DEPENDENCIES: `source/**` private headers; keep contracts freestanding and layer-respecting.
-THREADING MODEL: No internal synchronization; callers must serialize access unless stated otherwise.
+THREADING MODEL: Metric and timer recording is lock-free from any thread (per-thread counter blocks, released by dsys_perf_thread_release); tick, reset, registration, sink and flush calls must come from one thread while no other thread records.
 ERROR MODEL: Return codes/NULL pointers; no exceptions.
 DETERMINISM: Profiling is non-authoritative and MUST NOT influence simulation results.
 VERSIONING / ABI / DATA FORMAT NOTES: Public header; see `docs/reference/specs/SPEC_ABI_TEMPLATES.md` where ABI stability matters.
@@ -43,11 +43,23 @@ typedef enum dsys_perf_metric {
     DSYS_PERF_METRIC_NET_MSG_RECV,
     DSYS_PERF_METRIC_NET_BYTES_SENT,
     DSYS_PERF_METRIC_NET_BYTES_RECV,
+    DSYS_PERF_METRIC_DOMAIN_CACHE_HITS,
+    DSYS_PERF_METRIC_DOMAIN_CACHE_MISSES,
+    DSYS_PERF_METRIC_DOMAIN_CACHE_EVICTIONS,
     DSYS_PERF_METRIC_COUNT
 } dsys_perf_metric;
 
+/* Builtin metrics plus dynamically registered ones. */
+#define DSYS_PERF_METRIC_CAPACITY 64u
+
+/* dsys_perf_metric_register flags. */
+#define DSYS_PERF_METRIC_FLAG_TIMER 1u /* keep a latency histogram per lane */
+
 typedef u64 (*dsys_perf_clock_fn)(void* user);
 
+/* Receives one telemetry JSONL line (with trailing newline) per lane per tick. */
+typedef void (*dsys_perf_sink_fn)(void* user, const char* line, u32 length);
+
 typedef struct dsys_perf_timer {
     dsys_perf_lane   lane;
     dsys_perf_metric metric;
@@ -78,10 +90,16 @@ void dsys_perf_set_run_root(const char* path);
 /* Reset counters, samples, and summaries. */
 void dsys_perf_reset(void);
 
-/* Tick lifecycle (ACT time + tick index). */
+/* Tick lifecycle (ACT time + tick index). tick_end merges every thread's
+ * counters and histograms, so worker recording must finish before it. */
 void dsys_perf_tick_begin(dom_act_time_t act, u64 tick_index);
 void dsys_perf_tick_end(void);
 
+/* Registers a named metric (or returns the id already registered under that
+ * name). Returns 0, -1 for a bad name, -2 when the table is full. */
+int dsys_perf_metric_register(const char* name, u32 flags, dsys_perf_metric* out_metric);
+u32 dsys_perf_metric_total(void);
+
 /* Metric recording. */
 void dsys_perf_metric_set(dsys_perf_lane lane, dsys_perf_metric metric, u64 value);
 void dsys_perf_metric_add(dsys_perf_lane lane, dsys_perf_metric metric, u64 value);
@@ -90,14 +108,40 @@ void dsys_perf_metric_max(dsys_perf_lane lane, dsys_perf_metric metric, u64 valu
 u64 dsys_perf_metric_last(dsys_perf_lane lane, dsys_perf_metric metric);
 u64 dsys_perf_metric_max_seen(dsys_perf_lane lane, dsys_perf_metric metric);
 
-/* Timer helpers. */
+/* Timer helpers. Timer metrics also feed a log-bucket histogram (1/8
+ * relative bucket width) that accumulates until reset. */
 void dsys_perf_timer_begin(dsys_perf_timer* timer, dsys_perf_lane lane, dsys_perf_metric metric);
 void dsys_perf_timer_end(dsys_perf_timer* timer);
+void dsys_perf_timer_record(dsys_perf_lane lane, dsys_perf_metric metric, u64 elapsed_us);
+
+/* Upper bound of the bucket holding the given quantile, in parts per million
+ * (p50 = 500000, p99 = 990000, p999 = 999000); 0 without samples. */
+u64 dsys_perf_timer_percentile(dsys_perf_lane lane, dsys_perf_metric metric, u32 ppm);
+u64 dsys_perf_timer_count(dsys_perf_lane lane, dsys_perf_metric metric);
 
 const char* dsys_perf_metric_name(dsys_perf_metric metric);
 const char* dsys_perf_lane_name(dsys_perf_lane lane);
 
-/* Flush buffered telemetry and/or budget reports. */
+/* Streams telemetry as ticks end, in batches from the sample ring; NULL stops
+ * streaming. Without a sink the ring keeps the most recent samples for flush
+ * and counts the overwritten ones as overflow. */
+void dsys_perf_set_sink(dsys_perf_sink_fn fn, void* user, const char* fixture, const char* tier);
+void dsys_perf_sink_drain(void);
+u64  dsys_perf_samples_dropped(void);
+
+/* Each recording thread claims one of a fixed number of counter blocks on
+ * first use. A thread that stops recording (e.g. a worker about to exit)
+ * releases its block for reuse; its pending counts still merge at the next
+ * tick_end. Threads that found every block taken record nothing until one
+ * is released; dsys_perf_threads_denied counts them since startup. */
+void dsys_perf_thread_release(void);
+u32  dsys_perf_threads_denied(void);
+
+/* Flush buffered telemetry and/or budget reports. The budget report's
+ * "samples" is the number of ticks recorded since reset (including ticks
+ * whose telemetry was dropped), "overflow" the number of those samples
+ * overwritten in the ring before reaching a sink or flush, and
+ * "threads_unrecorded" the dsys_perf_threads_denied count. */
 int dsys_perf_flush(const dsys_perf_flush_desc* desc);
 
 #ifdef __cplusplus
@@ -0,0 +1,73 @@
+/*
+FILE: include/domino/system/dsys_trace.h
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino API / system/dsys_trace
+RESPONSIBILITY: Defines public contract for the span tracer (begin/end records, Chrome trace export); does NOT provide implementation.
+ALLOWED DEPENDENCIES: `include/domino/**` plus C89/C++98 standard headers as needed.
+FORBIDDEN DEPENDENCIES: `source/**` private headers; keep contracts freestanding and layer-respecting.
+THREADING MODEL: Span recording is lock-free from any thread (one ring per thread); configuration, reset, tick and dump calls must come from one thread while no other thread records.
+ERROR MODEL: Return codes; rings overwrite their oldest records when full.
+DETERMINISM: Tracing is non-authoritative and MUST NOT influence simulation results.
+VERSIONING / ABI / DATA FORMAT NOTES: Dumps are Chrome Trace Event JSON (loads in chrome://tracing and Perfetto).
+EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/SPEC_*.md` without cross-layer coupling.
+*/
+#ifndef DOMINO_SYSTEM_DSYS_TRACE_H
+#define DOMINO_SYSTEM_DSYS_TRACE_H
+
+#include "domino/core/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSYS_TRACE_DEFAULT_RECORDS 16384u
+
+/* Nanoseconds; any monotonic origin. */
+typedef u64 (*dsys_trace_clock_fn)(void* user);
+typedef void (*dsys_trace_write_fn)(void* user, const char* data, u32 length);
+
+/* Read by the DSYS_TRACE_* macros; change it through dsys_trace_set_enabled. */
+extern volatile int g_dsys_trace_enabled;
+
+/* Span names must be string literals (or otherwise outlive the dump). When
+ * tracing is off these cost one predictable branch. */
+#define DSYS_TRACE_BEGIN(name, arg) \
+    do { if (g_dsys_trace_enabled) { dsys_trace_begin((name), (u64)(arg)); } } while (0)
+#define DSYS_TRACE_END(name) \
+    do { if (g_dsys_trace_enabled) { dsys_trace_end(name); } } while (0)
+
+/* Disabled by default. */
+void dsys_trace_set_enabled(int enabled);
+int  dsys_trace_is_enabled(void);
+
+/* Records kept per thread (rounded up to a power of two). Only takes effect
+ * for threads that have not traced yet; returns -1 while tracing is enabled. */
+int  dsys_trace_configure(u32 records_per_thread);
+
+/* NULL restores the default monotonic clock. */
+void dsys_trace_set_clock(dsys_trace_clock_fn fn, void* user);
+
+void dsys_trace_begin(const char* name, u64 arg);
+void dsys_trace_end(const char* name);
+
+/* Drops every recorded span. */
+void dsys_trace_reset(void);
+/* Records overwritten before a dump since the last reset. */
+u64  dsys_trace_dropped(void);
+
+/* Chrome Trace Event JSON of everything still in the rings. */
+int  dsys_trace_write_chrome(dsys_trace_write_fn fn, void* user);
+int  dsys_trace_dump_chrome(const char* path);
+
+/* Tick span. When the outermost tick runs longer than budget_us, the rings
+ * are dumped to "<path_prefix>_<tick>.json", at most max_dumps times.
+ * tick_end returns 1 when it wrote a dump. budget_us 0 disables. */
+void dsys_trace_set_overrun_dump(u64 budget_us, const char* path_prefix, u32 max_dumps);
+void dsys_trace_tick_begin(u64 tick_index);
+int  dsys_trace_tick_end(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* DOMINO_SYSTEM_DSYS_TRACE_H */
@@ -40,6 +40,9 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include <stdio.h>
 
 
+#include <string.h>
+
+
 
 
 
@@ -49,6 +52,90 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 
 
+static u32 d_registry_slot_home(const d_registry *reg, u32 id) {
+
+
+    u32 h = id * 0x9E3779B1u;
+
+
+    h ^= h >> 16;
+
+
+    return h & (reg->slot_capacity - 1u);
+
+
+}
+
+
+
+
+
+/* Slot holding `id`, or the empty slot where it would be inserted. */
+
+
+static u32 d_registry_slot_find(const d_registry *reg, u32 id) {
+
+
+    u32 mask = reg->slot_capacity - 1u;
+
+
+    u32 s = d_registry_slot_home(reg, id);
+
+
+    while (reg->slots[s] != 0u && reg->entries[reg->slots[s] - 1u].id != id) {
+
+
+        s = (s + 1u) & mask;
+
+
+    }
+
+
+    return s;
+
+
+}
+
+
+
+
+
+/* First entry with a given id wins, matching the linear scan. */
+
+
+static void d_registry_index_entry(d_registry *reg, u32 index) {
+
+
+    u32 s;
+
+
+    if (!reg->slots) {
+
+
+        return;
+
+
+    }
+
+
+    s = d_registry_slot_find(reg, reg->entries[index].id);
+
+
+    if (reg->slots[s] == 0u) {
+
+
+        reg->slots[s] = index + 1u;
+
+
+    }
+
+
+}
+
+
+
+
+
 void d_registry_init(
 
 
@@ -88,6 +175,12 @@ void d_registry_init(
     reg->next_id = first_id ? first_id : 1u;
 
 
+    reg->slots = (u32 *)0;
+
+
+    reg->slot_capacity = 0u;
+
+
     if (reg->next_id == 0u) {
 
 
@@ -163,7 +256,7 @@ u32 d_registry_add(d_registry *reg, void *ptr) {
     reg->next_id += 1u;
 
 
-    /* TODO_FUTURE(REGISTRY-OPENADDR-001): docs/architecture/FUTURE_PROOFING.md - upgrade to open-addressing or sorted lookup if hot. */
+    d_registry_index_entry(reg, reg->count - 1u);
 
 
     return entry->id;
@@ -175,6 +268,57 @@ u32 d_registry_add(d_registry *reg, void *ptr) {
 
 
 
+int d_registry_attach_index(d_registry *reg, u32 *slots, u32 slot_capacity) {
+
+
+    u32 i;
+
+
+    if (!reg || !reg->entries || !slots) {
+
+
+        return -1;
+
+
+    }
+
+
+    if (slot_capacity <= reg->capacity || (slot_capacity & (slot_capacity - 1u)) != 0u) {
+
+
+        return -1;
+
+
+    }
+
+
+    memset(slots, 0, sizeof(u32) * (size_t)slot_capacity);
+
+
+    reg->slots = slots;
+
+
+    reg->slot_capacity = slot_capacity;
+
+
+    for (i = 0u; i < reg->count; ++i) {
+
+
+        d_registry_index_entry(reg, i);
+
+
+    }
+
+
+    return 0;
+
+
+}
+
+
+
+
+
 u32 d_registry_add_with_id(d_registry *reg, u32 id, void *ptr) {
 
 
@@ -220,10 +364,10 @@ u32 d_registry_add_with_id(d_registry *reg, u32 id, void *ptr) {
     }
 
 
-    for (i = 0u; i < reg->count; ++i) {
+    if (reg->slots) {
 
 
-        if (reg->entries[i].id == id) {
+        if (reg->slots[d_registry_slot_find(reg, id)] != 0u) {
 
 
             fprintf(stderr, "d_registry_add_with_id: duplicate id %u\n", (unsigned int)id);
@@ -235,6 +379,27 @@ u32 d_registry_add_with_id(d_registry *reg, u32 id, void *ptr) {
         }
 
 
+    } else {
+
+
+        for (i = 0u; i < reg->count; ++i) {
+
+
+            if (reg->entries[i].id == id) {
+
+
+                fprintf(stderr, "d_registry_add_with_id: duplicate id %u\n", (unsigned int)id);
+
+
+                return 0u;
+
+
+            }
+
+
+        }
+
+
     }
 
 
@@ -262,6 +427,9 @@ u32 d_registry_add_with_id(d_registry *reg, u32 id, void *ptr) {
     }
 
 
+    d_registry_index_entry(reg, reg->count - 1u);
+
+
     return entry->id;
 
 
@@ -286,6 +454,18 @@ void *d_registry_get(const d_registry *reg, u32 id) {
     }
 
 
+    if (reg->slots) {
+
+
+        u32 slot = reg->slots[d_registry_slot_find(reg, id)];
+
+
+        return slot ? reg->entries[slot - 1u].ptr : (void *)0;
+
+
+    }
+
+
     for (i = 0u; i < reg->count; ++i) {
 
 
@@ -31,6 +31,8 @@ typedef struct d_registry {
     u32               capacity;
     u32               count;
     u32               next_id;   /* next ID to assign; must never be 0 */
+    u32              *slots;     /* optional id index: entry index + 1, 0 = empty */
+    u32               slot_capacity; /* power of two; 0 = linear scan */
 } d_registry;
 
 /* Initialize an empty registry with external storage. */
@@ -41,6 +43,12 @@ void d_registry_init(
     u32                first_id
 );
 
+/* Optional: attach an open-addressed id index with external storage.
+ * slot_capacity must be a power of two larger than the registry capacity.
+ * Existing entries are indexed; get/add_with_id then skip the entry scan.
+ * Returns 0 on success; on failure the registry keeps scanning linearly. */
+int d_registry_attach_index(d_registry *reg, u32 *slots, u32 slot_capacity);
+
 /* Add an entry; returns assigned ID or 0 on failure. */
 u32 d_registry_add(d_registry *reg, void *ptr);
 
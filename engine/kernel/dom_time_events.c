@@ -59,6 +59,295 @@ static void dom_time_heapify_down(dom_time_event_queue *q, u32 idx) {
     }
 }
 
+/* Timing wheel. Times are biased to u64 so unsigned digit arithmetic keeps the
+ * signed order. Invariant: a node in level L sits in the slot of its digit L,
+ * its trigger_time is after the cursor, and L is the highest digit where the
+ * two differ; so every slot at or below the cursor digit of its level is empty.
+ */
+#define DTW_NONE 0xFFFFFFFFu
+#define DTW_WHERE_FREE 0xFFFFFFFFu
+#define DTW_WHERE_READY 0xFFFFFFFEu
+#define DTW_WHERE_OVERFLOW 0xFFFFFFFDu
+#define DTW_SLOT_MASK (DOM_TIME_WHEEL_SLOTS - 1u)
+#define DTW_HORIZON_BITS (DOM_TIME_WHEEL_BITS * DOM_TIME_WHEEL_LEVELS)
+#define DTW_HEAP_READY 0
+#define DTW_HEAP_OVERFLOW 1
+
+static u64 dtw_bias(dom_act_time_t t) {
+    return ((u64)t) ^ ((u64)1u << 63);
+}
+
+static u32 dtw_ctz64(u64 m) {
+    u32 n = 0u;
+    if ((m & 0xFFFFFFFFu) == 0u) { n += 32u; m >>= 32; }
+    if ((m & 0xFFFFu) == 0u) { n += 16u; m >>= 16; }
+    if ((m & 0xFFu) == 0u) { n += 8u; m >>= 8; }
+    if ((m & 0xFu) == 0u) { n += 4u; m >>= 4; }
+    if ((m & 0x3u) == 0u) { n += 2u; m >>= 2; }
+    if ((m & 0x1u) == 0u) { n += 1u; }
+    return n;
+}
+
+static u32 dtw_id_bucket(const dom_time_wheel *w, dom_time_event_id event_id) {
+    return (u32)(event_id % (u64)w->capacity);
+}
+
+static u32 *dtw_heap_item(dom_time_wheel *w, int which, u32 pos) {
+    return (which == DTW_HEAP_READY) ? &w->nodes[pos].ready_item : &w->nodes[pos].overflow_item;
+}
+
+static u32 *dtw_heap_count(dom_time_wheel *w, int which) {
+    return (which == DTW_HEAP_READY) ? &w->ready_count : &w->overflow_count;
+}
+
+static int dtw_heap_less(const dom_time_wheel *w, u32 a, u32 b) {
+    return dom_time_event_less(&w->nodes[a].ev, &w->nodes[b].ev);
+}
+
+static void dtw_heap_set(dom_time_wheel *w, int which, u32 pos, u32 n) {
+    *dtw_heap_item(w, which, pos) = n;
+    w->nodes[n].heap_pos = pos;
+}
+
+static void dtw_heap_up(dom_time_wheel *w, int which, u32 pos) {
+    u32 n = *dtw_heap_item(w, which, pos);
+    while (pos > 0u) {
+        u32 parent = (pos - 1u) / 2u;
+        u32 p = *dtw_heap_item(w, which, parent);
+        if (!dtw_heap_less(w, n, p)) {
+            break;
+        }
+        dtw_heap_set(w, which, pos, p);
+        pos = parent;
+    }
+    dtw_heap_set(w, which, pos, n);
+}
+
+static void dtw_heap_down(dom_time_wheel *w, int which, u32 pos) {
+    u32 count = *dtw_heap_count(w, which);
+    u32 n = *dtw_heap_item(w, which, pos);
+    while (1) {
+        u32 child = (pos * 2u) + 1u;
+        u32 c;
+        if (child >= count) {
+            break;
+        }
+        c = *dtw_heap_item(w, which, child);
+        if (child + 1u < count) {
+            u32 r = *dtw_heap_item(w, which, child + 1u);
+            if (dtw_heap_less(w, r, c)) {
+                child += 1u;
+                c = r;
+            }
+        }
+        if (!dtw_heap_less(w, c, n)) {
+            break;
+        }
+        dtw_heap_set(w, which, pos, c);
+        pos = child;
+    }
+    dtw_heap_set(w, which, pos, n);
+}
+
+static void dtw_heap_push(dom_time_wheel *w, int which, u32 n) {
+    u32 *count = dtw_heap_count(w, which);
+    u32 pos = *count;
+    *count += 1u;
+    dtw_heap_set(w, which, pos, n);
+    dtw_heap_up(w, which, pos);
+    w->nodes[n].where = (which == DTW_HEAP_READY) ? DTW_WHERE_READY : DTW_WHERE_OVERFLOW;
+}
+
+static void dtw_heap_remove(dom_time_wheel *w, int which, u32 pos) {
+    u32 *count = dtw_heap_count(w, which);
+    u32 last;
+    *count -= 1u;
+    last = *count;
+    if (pos == last) {
+        return;
+    }
+    dtw_heap_set(w, which, pos, *dtw_heap_item(w, which, last));
+    if (pos > 0u && dtw_heap_less(w, *dtw_heap_item(w, which, pos),
+                                  *dtw_heap_item(w, which, (pos - 1u) / 2u))) {
+        dtw_heap_up(w, which, pos);
+    } else {
+        dtw_heap_down(w, which, pos);
+    }
+}
+
+static void dtw_slot_link(dom_time_wheel *w, u32 slot, u32 n) {
+    dom_time_wheel_node *node = &w->nodes[n];
+    node->where = slot;
+    node->prev = DTW_NONE;
+    node->next = w->heads[slot];
+    if (node->next != DTW_NONE) {
+        w->nodes[node->next].prev = n;
+    }
+    w->heads[slot] = n;
+    w->occupied[slot / DOM_TIME_WHEEL_SLOTS] |= (u64)1u << (slot & DTW_SLOT_MASK);
+}
+
+static void dtw_slot_unlink(dom_time_wheel *w, u32 n) {
+    dom_time_wheel_node *node = &w->nodes[n];
+    u32 slot = node->where;
+    if (node->prev != DTW_NONE) {
+        w->nodes[node->prev].next = node->next;
+    } else {
+        w->heads[slot] = node->next;
+    }
+    if (node->next != DTW_NONE) {
+        w->nodes[node->next].prev = node->prev;
+    }
+    if (w->heads[slot] == DTW_NONE) {
+        w->occupied[slot / DOM_TIME_WHEEL_SLOTS] &= ~((u64)1u << (slot & DTW_SLOT_MASK));
+    }
+}
+
+/* Files a node relative to the cursor: ready heap, wheel slot or overflow. */
+static void dtw_file(dom_time_wheel *w, u32 n) {
+    u64 bt = dtw_bias(w->nodes[n].ev.trigger_time);
+    u64 diff;
+    u32 level;
+    if (bt <= w->cursor) {
+        dtw_heap_push(w, DTW_HEAP_READY, n);
+        return;
+    }
+    diff = bt ^ w->cursor;
+    for (level = 0u; level < DOM_TIME_WHEEL_LEVELS; ++level) {
+        u32 shift = DOM_TIME_WHEEL_BITS * level;
+        if ((diff >> (shift + DOM_TIME_WHEEL_BITS)) == 0u) {
+            dtw_slot_link(w, (level * DOM_TIME_WHEEL_SLOTS) + (u32)((bt >> shift) & DTW_SLOT_MASK), n);
+            return;
+        }
+    }
+    dtw_heap_push(w, DTW_HEAP_OVERFLOW, n);
+}
+
+/* Advances the cursor until the ready heap holds the earliest event, cascading
+ * the first occupied slot of the lowest level that has one; refills from the
+ * overflow heap once the wheel is empty. */
+static void dtw_settle(dom_time_wheel *w) {
+    while (w->ready_count == 0u) {
+        u32 level;
+        int moved = 0;
+        for (level = 0u; level < DOM_TIME_WHEEL_LEVELS && !moved; ++level) {
+            u32 shift = DOM_TIME_WHEEL_BITS * level;
+            u32 digit = (u32)((w->cursor >> shift) & DTW_SLOT_MASK);
+            u64 above;
+            u32 slot;
+            u32 n;
+            if (digit == DTW_SLOT_MASK) {
+                continue;
+            }
+            above = w->occupied[level] & ~(((u64)2u << digit) - 1u);
+            if (above == 0u) {
+                continue;
+            }
+            slot = dtw_ctz64(above);
+            w->cursor = (w->cursor & ~((((u64)1u) << (shift + DOM_TIME_WHEEL_BITS)) - 1u)) |
+                        ((u64)slot << shift);
+            slot += level * DOM_TIME_WHEEL_SLOTS;
+            n = w->heads[slot];
+            w->heads[slot] = DTW_NONE;
+            w->occupied[level] &= ~((u64)1u << (slot & DTW_SLOT_MASK));
+            while (n != DTW_NONE) {
+                u32 next = w->nodes[n].next;
+                dtw_file(w, n);
+                n = next;
+            }
+            moved = 1;
+        }
+        if (moved) {
+            continue;
+        }
+        if (w->overflow_count == 0u) {
+            return;
+        }
+        w->cursor = dtw_bias(w->nodes[w->nodes[0u].overflow_item].ev.trigger_time);
+        while (w->overflow_count > 0u) {
+            u32 n = w->nodes[0u].overflow_item;
+            if (((dtw_bias(w->nodes[n].ev.trigger_time) ^ w->cursor) >> DTW_HORIZON_BITS) != 0u) {
+                break;
+            }
+            dtw_heap_remove(w, DTW_HEAP_OVERFLOW, 0u);
+            dtw_file(w, n);
+        }
+    }
+}
+
+static int dtw_schedule(dom_time_event_queue *q, const dom_time_event *ev, u32 *out_handle) {
+    dom_time_wheel *w = q->wheel;
+    dom_time_wheel_node *node;
+    u32 n = w->free_head;
+    u32 bucket;
+    if (n == DTW_NONE) {
+        return DOM_TIME_FULL;
+    }
+    node = &w->nodes[n];
+    w->free_head = node->next;
+    node->ev = *ev;
+    bucket = dtw_id_bucket(w, ev->event_id);
+    node->id_prev = DTW_NONE;
+    node->id_next = w->nodes[bucket].id_head;
+    if (node->id_next != DTW_NONE) {
+        w->nodes[node->id_next].id_prev = n;
+    }
+    w->nodes[bucket].id_head = n;
+    dtw_file(w, n);
+    q->count += 1u;
+    if (out_handle) {
+        *out_handle = n;
+    }
+    return DOM_TIME_OK;
+}
+
+static void dtw_release(dom_time_event_queue *q, u32 n) {
+    dom_time_wheel *w = q->wheel;
+    dom_time_wheel_node *node = &w->nodes[n];
+    if (node->where == DTW_WHERE_READY) {
+        dtw_heap_remove(w, DTW_HEAP_READY, node->heap_pos);
+    } else if (node->where == DTW_WHERE_OVERFLOW) {
+        dtw_heap_remove(w, DTW_HEAP_OVERFLOW, node->heap_pos);
+    } else {
+        dtw_slot_unlink(w, n);
+    }
+    if (node->id_prev != DTW_NONE) {
+        w->nodes[node->id_prev].id_next = node->id_next;
+    } else {
+        w->nodes[dtw_id_bucket(w, node->ev.event_id)].id_head = node->id_next;
+    }
+    if (node->id_next != DTW_NONE) {
+        w->nodes[node->id_next].id_prev = node->id_prev;
+    }
+    node->where = DTW_WHERE_FREE;
+    node->next = w->free_head;
+    w->free_head = n;
+    q->count -= 1u;
+}
+
+static int dtw_cancel(dom_time_event_queue *q, dom_time_event_id event_id) {
+    dom_time_wheel *w = q->wheel;
+    u32 n = w->nodes[dtw_id_bucket(w, event_id)].id_head;
+    while (n != DTW_NONE) {
+        if (w->nodes[n].ev.event_id == event_id) {
+            dtw_release(q, n);
+            return DOM_TIME_OK;
+        }
+        n = w->nodes[n].id_next;
+    }
+    return DOM_TIME_NOT_FOUND;
+}
+
+/* Earliest node, or DTW_NONE when empty. */
+static u32 dtw_front(const dom_time_event_queue *q) {
+    dom_time_wheel *w = q->wheel;
+    if (q->count == 0u) {
+        return DTW_NONE;
+    }
+    dtw_settle(w);
+    return w->nodes[0u].ready_item;
+}
+
 int dom_time_event_queue_init(dom_time_event_queue *q, dom_time_event *storage, u32 capacity) {
     if (!q || !storage || capacity == 0u) {
         return DOM_TIME_INVALID;
@@ -66,6 +355,43 @@ int dom_time_event_queue_init(dom_time_event_queue *q, dom_time_event *storage,
     q->items = storage;
     q->capacity = capacity;
     q->count = 0u;
+    q->wheel = (dom_time_wheel *)0;
+    return DOM_TIME_OK;
+}
+
+int dom_time_event_queue_init_wheel(dom_time_event_queue *q,
+                                    dom_time_wheel *wheel,
+                                    dom_time_wheel_node *nodes,
+                                    u32 capacity,
+                                    dom_act_time_t start_time) {
+    u32 i;
+    if (!q || !wheel || !nodes || capacity == 0u || capacity == DTW_NONE) {
+        return DOM_TIME_INVALID;
+    }
+    wheel->nodes = nodes;
+    wheel->capacity = capacity;
+    wheel->free_head = 0u;
+    wheel->ready_count = 0u;
+    wheel->overflow_count = 0u;
+    wheel->cursor = dtw_bias(start_time);
+    for (i = 0u; i < DOM_TIME_WHEEL_LEVELS; ++i) {
+        wheel->occupied[i] = 0u;
+    }
+    for (i = 0u; i < DOM_TIME_WHEEL_LEVELS * DOM_TIME_WHEEL_SLOTS; ++i) {
+        wheel->heads[i] = DTW_NONE;
+    }
+    for (i = 0u; i < capacity; ++i) {
+        nodes[i].next = (i + 1u < capacity) ? (i + 1u) : DTW_NONE;
+        nodes[i].prev = DTW_NONE;
+        nodes[i].where = DTW_WHERE_FREE;
+        nodes[i].id_head = DTW_NONE;
+        nodes[i].id_next = DTW_NONE;
+        nodes[i].id_prev = DTW_NONE;
+    }
+    q->items = (dom_time_event *)0;
+    q->capacity = capacity;
+    q->count = 0u;
+    q->wheel = wheel;
     return DOM_TIME_OK;
 }
 
@@ -81,6 +407,9 @@ int dom_time_event_schedule(dom_time_event_queue *q, const dom_time_event *ev) {
     if (!q || !ev) {
         return DOM_TIME_INVALID;
     }
+    if (q->wheel) {
+        return dtw_schedule(q, ev, (u32 *)0);
+    }
     if (q->count >= q->capacity) {
         return DOM_TIME_FULL;
     }
@@ -95,6 +424,9 @@ int dom_time_event_cancel(dom_time_event_queue *q, dom_time_event_id event_id) {
     if (!q) {
         return DOM_TIME_INVALID;
     }
+    if (q->wheel) {
+        return dtw_cancel(q, event_id);
+    }
     for (i = 0u; i < q->count; ++i) {
         if (q->items[i].event_id == event_id) {
             q->count -= 1u;
@@ -112,6 +444,30 @@ int dom_time_event_cancel(dom_time_event_queue *q, dom_time_event_id event_id) {
     return DOM_TIME_NOT_FOUND;
 }
 
+int dom_time_event_schedule_handle(dom_time_event_queue *q, const dom_time_event *ev, u32 *out_handle) {
+    if (!q || !ev || !out_handle) {
+        return DOM_TIME_INVALID;
+    }
+    *out_handle = DOM_TIME_EVENT_HANDLE_NONE;
+    if (q->wheel) {
+        return dtw_schedule(q, ev, out_handle);
+    }
+    return dom_time_event_schedule(q, ev);
+}
+
+int dom_time_event_cancel_handle(dom_time_event_queue *q, u32 handle, dom_time_event_id event_id) {
+    if (!q) {
+        return DOM_TIME_INVALID;
+    }
+    if (q->wheel && handle < q->wheel->capacity &&
+        q->wheel->nodes[handle].where != DTW_WHERE_FREE &&
+        q->wheel->nodes[handle].ev.event_id == event_id) {
+        dtw_release(q, handle);
+        return DOM_TIME_OK;
+    }
+    return dom_time_event_cancel(q, event_id);
+}
+
 int dom_time_event_peek(const dom_time_event_queue *q, dom_time_event *out_ev) {
     if (!q || !out_ev) {
         return DOM_TIME_INVALID;
@@ -119,6 +475,10 @@ int dom_time_event_peek(const dom_time_event_queue *q, dom_time_event *out_ev) {
     if (q->count == 0u) {
         return DOM_TIME_EMPTY;
     }
+    if (q->wheel) {
+        *out_ev = q->wheel->nodes[dtw_front(q)].ev;
+        return DOM_TIME_OK;
+    }
     *out_ev = q->items[0u];
     return DOM_TIME_OK;
 }
@@ -130,6 +490,12 @@ int dom_time_event_pop(dom_time_event_queue *q, dom_time_event *out_ev) {
     if (q->count == 0u) {
         return DOM_TIME_EMPTY;
     }
+    if (q->wheel) {
+        u32 n = dtw_front(q);
+        *out_ev = q->wheel->nodes[n].ev;
+        dtw_release(q, n);
+        return DOM_TIME_OK;
+    }
     *out_ev = q->items[0u];
     q->count -= 1u;
     if (q->count > 0u) {
@@ -146,6 +512,10 @@ int dom_time_event_next_time(const dom_time_event_queue *q, dom_act_time_t *out_
     if (q->count == 0u) {
         return DOM_TIME_EMPTY;
     }
+    if (q->wheel) {
+        *out_time = q->wheel->nodes[dtw_front(q)].ev.trigger_time;
+        return DOM_TIME_OK;
+    }
     *out_time = q->items[0u].trigger_time;
     return DOM_TIME_OK;
 }
@@ -11,6 +11,14 @@ DETERMINISM: See `docs/reference/specs/SPEC_DETERMINISM.md` for deterministic su
 VERSIONING / ABI / DATA FORMAT NOTES: N/A (implementation file).
 EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/SPEC_*.md` without cross-layer coupling.
 */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,85 +27,90 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include "d_subsystem.h"
 #include "d_world.h"
 
-#define D_REPLAY_TAG_FRAME 1u
+#define D_REPLAY_TAG_FRAME    1u
+#define D_REPLAY_TAG_KEYFRAME 2u
+#define D_REPLAY_TAG_INDEX    3u
 
-static int g_replay_registered = 0;
+#define D_REPLAY_STREAM_HEADER_SIZE  16u
+#define D_REPLAY_STREAM_TRAILER_SIZE 16u
+#define D_REPLAY_INDEX_ENTRY_SIZE    16u
 
-typedef struct dreplay_builder {
-    unsigned char *data;
-    u32            length;
-    u32            capacity;
-} dreplay_builder;
+static const unsigned char g_replay_stream_magic[4] = { 'D', 'R', 'P', 'L' };
+static const unsigned char g_replay_index_magic[4] = { 'D', 'R', 'P', 'I' };
 
-static void d_replay_builder_init(dreplay_builder *b) {
-    if (!b) {
-        return;
-    }
-    b->data = (unsigned char *)0;
-    b->length = 0u;
-    b->capacity = 0u;
-}
+static int g_replay_registered = 0;
 
-static void d_replay_builder_reset(dreplay_builder *b) {
-    if (!b) {
-        return;
+/* Encoded size of a D_REPLAY_TAG_FRAME payload. */
+static int d_replay_payload_size(const d_net_input_frame *inputs, u32 input_count, u32 *out_len) {
+    u32 len = 8u; /* tick_index + input_count */
+    u32 j;
+    if (input_count > 0u && !inputs) {
+        return -1;
     }
-    if (b->data) {
-        free(b->data);
+    for (j = 0u; j < input_count; ++j) {
+        if (inputs[j].payload_size > 0xFFFFFFFFu - (len + 12u)) {
+            return -1;
+        }
+        if (inputs[j].payload_size > 0u && !inputs[j].payload) {
+            return -1;
+        }
+        len += 12u + inputs[j].payload_size;
     }
-    b->data = (unsigned char *)0;
-    b->length = 0u;
-    b->capacity = 0u;
+    *out_len = len;
+    return 0;
 }
 
-static int d_replay_builder_reserve(dreplay_builder *b, u32 extra) {
-    u32 needed;
-    u32 new_cap;
-    unsigned char *new_data;
-    if (!b) {
-        return -1;
-    }
-    if (extra > 0xFFFFFFFFu - b->length) {
-        return -1;
-    }
-    needed = b->length + extra;
-    if (needed <= b->capacity) {
-        return 0;
-    }
-    new_cap = b->capacity ? b->capacity : 256u;
-    while (new_cap < needed) {
-        if (new_cap > 0x7FFFFFFFu) {
-            new_cap = needed;
-            break;
+static u32 d_replay_encode_payload(
+    unsigned char           *dst,
+    u32                      tick_index,
+    const d_net_input_frame *inputs,
+    u32                      input_count
+) {
+    u32 offset = 0u;
+    u32 j;
+    memcpy(dst + offset, &tick_index, sizeof(u32));
+    offset += 4u;
+    memcpy(dst + offset, &input_count, sizeof(u32));
+    offset += 4u;
+    for (j = 0u; j < input_count; ++j) {
+        memcpy(dst + offset, &inputs[j].tick_index, sizeof(u32));
+        offset += 4u;
+        memcpy(dst + offset, &inputs[j].player_id, sizeof(u32));
+        offset += 4u;
+        memcpy(dst + offset, &inputs[j].payload_size, sizeof(u32));
+        offset += 4u;
+        if (inputs[j].payload_size > 0u) {
+            memcpy(dst + offset, inputs[j].payload, inputs[j].payload_size);
+            offset += inputs[j].payload_size;
         }
-        new_cap *= 2u;
     }
-    new_data = (unsigned char *)realloc(b->data, new_cap);
-    if (!new_data) {
-        return -1;
-    }
-    b->data = new_data;
-    b->capacity = new_cap;
-    return 0;
+    return offset;
 }
 
-static int d_replay_builder_append(dreplay_builder *b, u32 tag, const unsigned char *payload, u32 payload_len) {
-    int rc;
-    rc = d_replay_builder_reserve(b, 8u + payload_len);
-    if (rc != 0) {
-        return rc;
+/* Lower bound over frames sorted by tick; returns 1 when `tick_index` is present. */
+static int d_replay_find_frame(const dreplay_frame *frames, u32 count, u32 tick_index, u32 *out_pos) {
+    u32 lo = 0u;
+    u32 hi = count;
+    while (lo < hi) {
+        u32 mid = lo + ((hi - lo) >> 1u);
+        if (frames[mid].tick_index < tick_index) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
     }
-    memcpy(b->data + b->length, &tag, sizeof(u32));
-    b->length += 4u;
-    memcpy(b->data + b->length, &payload_len, sizeof(u32));
-    b->length += 4u;
-    if (payload_len > 0u && payload) {
-        memcpy(b->data + b->length, payload, payload_len);
-        b->length += payload_len;
-    } else if (payload_len > 0u && !payload) {
-        return -1;
+    *out_pos = lo;
+    return (lo < count && frames[lo].tick_index == tick_index) ? 1 : 0;
+}
+
+static u32 d_replay_frames_sorted(const dreplay_frame *frames, u32 count) {
+    u32 i;
+    for (i = 1u; i < count; ++i) {
+        if (frames[i - 1u].tick_index >= frames[i].tick_index) {
+            return 0u;
+        }
     }
-    return 0;
+    return 1u;
 }
 
 static void d_replay_free_inputs(d_net_input_frame *inputs, u32 count) {
@@ -215,6 +228,7 @@ int d_replay_init_record(d_replay_context *ctx, u32 initial_capacity) {
     ctx->frame_count = 0u;
     ctx->frame_capacity = 0u;
     ctx->cursor = 0u;
+    ctx->frames_sorted = 1u;
 
     if (initial_capacity > 0u) {
         if (d_replay_ensure_capacity(ctx, initial_capacity) != 0) {
@@ -241,6 +255,7 @@ int d_replay_init_playback(d_replay_context *ctx, dreplay_frame *frames, u32 fra
     if (frame_count > 0u && !frames) {
         return -1;
     }
+    ctx->frames_sorted = d_replay_frames_sorted(frames, frame_count);
     return 0;
 }
 
@@ -255,6 +270,7 @@ void d_replay_shutdown(d_replay_context *ctx) {
     ctx->frame_count = 0u;
     ctx->frame_capacity = 0u;
     ctx->cursor = 0u;
+    ctx->frames_sorted = 1u;
     ctx->mode = DREPLAY_MODE_OFF;
     ctx->determinism_mode = 0u;
     ctx->last_hash = 0u;
@@ -266,8 +282,8 @@ int d_replay_record_frame(
     const d_net_input_frame *inputs,
     u32                      input_count
 ) {
-    u32 i;
     dreplay_frame *frame = (dreplay_frame *)0;
+    u32 pos;
     if (!ctx || ctx->mode != DREPLAY_MODE_RECORD) {
         return -1;
     }
@@ -275,10 +291,11 @@ int d_replay_record_frame(
         return -1;
     }
 
-    for (i = 0u; i < ctx->frame_count; ++i) {
-        if (ctx->frames[i].tick_index == tick_index) {
-            frame = &ctx->frames[i];
-            break;
+    /* Frames stay sorted by tick; the common case appends past the last. */
+    pos = ctx->frame_count;
+    if (ctx->frame_count > 0u && ctx->frames[ctx->frame_count - 1u].tick_index >= tick_index) {
+        if (d_replay_find_frame(ctx->frames, ctx->frame_count, tick_index, &pos)) {
+            frame = &ctx->frames[pos];
         }
     }
 
@@ -286,7 +303,11 @@ int d_replay_record_frame(
         if (d_replay_ensure_capacity(ctx, ctx->frame_count + 1u) != 0) {
             return -1;
         }
-        frame = &ctx->frames[ctx->frame_count];
+        if (pos < ctx->frame_count) {
+            memmove(&ctx->frames[pos + 1u], &ctx->frames[pos],
+                    sizeof(dreplay_frame) * (ctx->frame_count - pos));
+        }
+        frame = &ctx->frames[pos];
         ctx->frame_count += 1u;
     } else {
         d_replay_free_inputs(frame->inputs, frame->input_count);
@@ -325,11 +346,18 @@ int d_replay_get_frame(
         }
     }
     if (!frame) {
-        for (i = 0u; i < ctx->frame_count; ++i) {
-            if (ctx->frames[i].tick_index == tick_index) {
+        if (ctx->frames_sorted) {
+            if (d_replay_find_frame(ctx->frames, ctx->frame_count, tick_index, &i)) {
                 frame = &ctx->frames[i];
                 ctx->cursor = i;
-                break;
+            }
+        } else {
+            for (i = 0u; i < ctx->frame_count; ++i) {
+                if (ctx->frames[i].tick_index == tick_index) {
+                    frame = &ctx->frames[i];
+                    ctx->cursor = i;
+                    break;
+                }
             }
         }
     }
@@ -357,7 +385,9 @@ int d_replay_serialize(
     const d_replay_context *ctx,
     d_tlv_blob             *out
 ) {
-    dreplay_builder builder;
+    unsigned char *data;
+    u32 total = 0u;
+    u32 offset;
     u32 i;
     if (!ctx || !out) {
         return -1;
@@ -366,57 +396,45 @@ int d_replay_serialize(
         return -1;
     }
 
-    d_replay_builder_init(&builder);
+    /* Size everything first so the blob is a single exact allocation. */
     for (i = 0u; i < ctx->frame_count; ++i) {
         const dreplay_frame *frame = &ctx->frames[i];
-        unsigned char *payload;
         u32 payload_len;
-        u32 offset;
-        u32 j;
-
-        payload_len = 8u; /* tick_index + input_count */
-        for (j = 0u; j < frame->input_count; ++j) {
-            if (frame->inputs[j].payload_size > 0xFFFFFFFFu - (payload_len + 12u)) {
-                d_replay_builder_reset(&builder);
-                return -1;
-            }
-            payload_len += 12u + frame->inputs[j].payload_size;
+        if (d_replay_payload_size(frame->inputs, frame->input_count, &payload_len) != 0) {
+            return -1;
         }
-
-        payload = (unsigned char *)malloc(payload_len);
-        if (!payload && payload_len != 0u) {
-            d_replay_builder_reset(&builder);
+        if (payload_len > 0xFFFFFFFFu - 8u - total) {
             return -1;
         }
-        offset = 0u;
-        memcpy(payload + offset, &frame->tick_index, sizeof(u32));
-        offset += 4u;
-        memcpy(payload + offset, &frame->input_count, sizeof(u32));
-        offset += 4u;
+        total += 8u + payload_len;
+    }
 
-        for (j = 0u; j < frame->input_count; ++j) {
-            memcpy(payload + offset, &frame->inputs[j].tick_index, sizeof(u32));
-            offset += 4u;
-            memcpy(payload + offset, &frame->inputs[j].player_id, sizeof(u32));
-            offset += 4u;
-            memcpy(payload + offset, &frame->inputs[j].payload_size, sizeof(u32));
-            offset += 4u;
-            if (frame->inputs[j].payload_size > 0u) {
-                memcpy(payload + offset, frame->inputs[j].payload, frame->inputs[j].payload_size);
-                offset += frame->inputs[j].payload_size;
-            }
-        }
+    out->ptr = (unsigned char *)0;
+    out->len = 0u;
+    if (total == 0u) {
+        return 0;
+    }
+    data = (unsigned char *)malloc(total);
+    if (!data) {
+        return -1;
+    }
 
-        if (d_replay_builder_append(&builder, D_REPLAY_TAG_FRAME, payload, payload_len) != 0) {
-            free(payload);
-            d_replay_builder_reset(&builder);
-            return -1;
-        }
-        free(payload);
+    offset = 0u;
+    for (i = 0u; i < ctx->frame_count; ++i) {
+        const dreplay_frame *frame = &ctx->frames[i];
+        const u32 tag = D_REPLAY_TAG_FRAME;
+        u32 payload_len;
+        u32 len_offset = offset + 4u;
+        memcpy(data + offset, &tag, sizeof(u32));
+        offset += 8u;
+        payload_len = d_replay_encode_payload(data + offset, frame->tick_index,
+                                              frame->inputs, frame->input_count);
+        memcpy(data + len_offset, &payload_len, sizeof(u32));
+        offset += payload_len;
     }
 
-    out->ptr = builder.data;
-    out->len = builder.length;
+    out->ptr = data;
+    out->len = total;
     return 0;
 }
 
@@ -537,6 +555,694 @@ int d_replay_deserialize(
     out_ctx->frame_count = frame_count;
     out_ctx->frame_capacity = frame_cap;
     out_ctx->cursor = 0u;
+    out_ctx->frames_sorted = d_replay_frames_sorted(frames, frame_count);
+    return 0;
+}
+
+/*------------------------------------------------------------
+ * Streaming replay files
+ *------------------------------------------------------------*/
+static int d_replay_index_push(
+    d_replay_index_entry **index,
+    u32                   *count,
+    u32                   *capacity,
+    u32                    tick_index,
+    u32                    kind,
+    u64                    offset
+) {
+    if (*count >= *capacity) {
+        u32 new_cap = *capacity ? *capacity * 2u : 64u;
+        d_replay_index_entry *grown;
+        if (new_cap <= *count) {
+            return -1;
+        }
+        grown = (d_replay_index_entry *)realloc(*index, sizeof(d_replay_index_entry) * new_cap);
+        if (!grown) {
+            return -1;
+        }
+        *index = grown;
+        *capacity = new_cap;
+    }
+    (*index)[*count].tick_index = tick_index;
+    (*index)[*count].kind = kind;
+    (*index)[*count].offset = offset;
+    *count += 1u;
+    return 0;
+}
+
+/* Last index entry with tick <= `tick_index`; returns 0 when there is none. */
+static int d_replay_index_floor(const d_replay_index_entry *index, u32 count, u32 tick_index, u32 *out_pos) {
+    u32 lo = 0u;
+    u32 hi = count;
+    while (lo < hi) {
+        u32 mid = lo + ((hi - lo) >> 1u);
+        if (index[mid].tick_index <= tick_index) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0u) {
+        return 0;
+    }
+    *out_pos = lo - 1u;
+    return 1;
+}
+
+static int d_replay_grow_scratch(unsigned char **scratch, u32 *capacity, u32 needed) {
+    unsigned char *grown;
+    u32 new_cap;
+    if (needed <= *capacity) {
+        return 0;
+    }
+    new_cap = *capacity ? *capacity : 256u;
+    while (new_cap < needed) {
+        if (new_cap > 0x7FFFFFFFu) {
+            new_cap = needed;
+            break;
+        }
+        new_cap *= 2u;
+    }
+    grown = (unsigned char *)realloc(*scratch, new_cap);
+    if (!grown) {
+        return -1;
+    }
+    *scratch = grown;
+    *capacity = new_cap;
+    return 0;
+}
+
+static int d_replay_writer_put(d_replay_writer *w, const void *data, u32 len) {
+    if (len == 0u) {
+        return 0;
+    }
+    if (fwrite(data, 1u, len, w->file) != len) {
+        return -1;
+    }
+    w->offset += len;
+    return 0;
+}
+
+/* Chunk header plus up to two payload parts, so large keyframe images are
+ * written straight from the save buffer. */
+static int d_replay_writer_chunk(
+    d_replay_writer     *w,
+    u32                  tag,
+    const unsigned char *a,
+    u32                  a_len,
+    const unsigned char *b,
+    u32                  b_len
+) {
+    unsigned char head[8];
+    u32 len;
+    if (a_len > 0xFFFFFFFFu - b_len) {
+        return -1;
+    }
+    len = a_len + b_len;
+    memcpy(head, &tag, sizeof(u32));
+    memcpy(head + 4u, &len, sizeof(u32));
+    if (d_replay_writer_put(w, head, 8u) != 0 ||
+        d_replay_writer_put(w, a, a_len) != 0 ||
+        d_replay_writer_put(w, b, b_len) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int d_replay_writer_open(d_replay_writer *w, const char *path, u32 keyframe_interval) {
+    unsigned char header[D_REPLAY_STREAM_HEADER_SIZE];
+    const u32 version = D_REPLAY_STREAM_VERSION;
+    const u32 stride = D_REPLAY_STREAM_DEFAULT_STRIDE;
+    if (!w || !path) {
+        return -1;
+    }
+    memset(w, 0, sizeof(*w));
+    w->file = fopen(path, "wb");
+    if (!w->file) {
+        return -1;
+    }
+    w->keyframe_interval = keyframe_interval;
+    w->index_stride = stride;
+
+    memcpy(header, g_replay_stream_magic, 4u);
+    memcpy(header + 4u, &version, sizeof(u32));
+    memcpy(header + 8u, &keyframe_interval, sizeof(u32));
+    memcpy(header + 12u, &stride, sizeof(u32));
+    if (d_replay_writer_put(w, header, D_REPLAY_STREAM_HEADER_SIZE) != 0) {
+        fclose(w->file);
+        w->file = (FILE *)0;
+        return -1;
+    }
+    return 0;
+}
+
+int d_replay_writer_keyframe(d_replay_writer *w, u32 tick_index, const d_world *world) {
+    unsigned char head[4];
+    unsigned char *image = (unsigned char *)0;
+    u32 image_len = 0u;
+    u64 chunk_offset;
+    int rc;
+    if (!w || !w->file || !world) {
+        return -1;
+    }
+    /* A keyframe is the state before its tick's inputs, so it cannot follow
+     * a frame recorded for the same or a later tick. */
+    if ((w->has_frame && tick_index <= w->last_tick) ||
+        (w->has_keyframe && tick_index < w->last_keyframe_tick)) {
+        return -1;
+    }
+    if (w->has_keyframe && tick_index == w->last_keyframe_tick) {
+        return 0;
+    }
+    if (d_world_save_image(world, &image, &image_len) != 0) {
+        return -1;
+    }
+
+    chunk_offset = w->offset;
+    memcpy(head, &tick_index, sizeof(u32));
+    rc = d_replay_writer_chunk(w, D_REPLAY_TAG_KEYFRAME, head, 4u, image, image_len);
+    if (image) {
+        free(image);
+    }
+    if (rc != 0) {
+        return -1;
+    }
+    if (d_replay_index_push(&w->index, &w->index_count, &w->index_capacity,
+                            tick_index, D_REPLAY_INDEX_KEYFRAME, chunk_offset) != 0) {
+        return -1;
+    }
+    w->has_keyframe = 1;
+    w->last_keyframe_tick = tick_index;
+    w->keyframe_count += 1u;
+    return 0;
+}
+
+int d_replay_writer_record(
+    d_replay_writer         *w,
+    u32                      tick_index,
+    const d_net_input_frame *inputs,
+    u32                      input_count,
+    const d_world           *world
+) {
+    u32 payload_len;
+    u64 chunk_offset;
+    if (!w || !w->file) {
+        return -1;
+    }
+    if (w->has_frame && tick_index <= w->last_tick) {
+        return -1;
+    }
+    if (d_replay_payload_size(inputs, input_count, &payload_len) != 0) {
+        return -1;
+    }
+    if (world && w->keyframe_interval > 0u &&
+        (!w->has_keyframe || tick_index - w->last_keyframe_tick >= w->keyframe_interval)) {
+        if (d_replay_writer_keyframe(w, tick_index, world) != 0) {
+            return -1;
+        }
+    }
+
+    if (d_replay_grow_scratch(&w->scratch, &w->scratch_capacity, payload_len) != 0) {
+        return -1;
+    }
+    (void)d_replay_encode_payload(w->scratch, tick_index, inputs, input_count);
+
+    chunk_offset = w->offset;
+    if (d_replay_writer_chunk(w, D_REPLAY_TAG_FRAME, w->scratch, payload_len,
+                              (const unsigned char *)0, 0u) != 0) {
+        return -1;
+    }
+    if (w->frames_since_index == 0u) {
+        if (d_replay_index_push(&w->index, &w->index_count, &w->index_capacity,
+                                tick_index, D_REPLAY_INDEX_FRAME, chunk_offset) != 0) {
+            return -1;
+        }
+    }
+    w->frames_since_index += 1u;
+    if (w->frames_since_index >= w->index_stride) {
+        w->frames_since_index = 0u;
+    }
+    w->has_frame = 1;
+    w->last_tick = tick_index;
+    w->frame_count += 1u;
+    return 0;
+}
+
+int d_replay_writer_close(d_replay_writer *w) {
+    unsigned char buf[D_REPLAY_INDEX_ENTRY_SIZE];
+    const u32 tag = D_REPLAY_TAG_INDEX;
+    const u32 reserved = 0u;
+    u64 index_offset;
+    u32 len;
+    u32 i;
+    int rc = 0;
+    if (!w) {
+        return -1;
+    }
+    if (!w->file) {
+        rc = -1;
+    } else if (w->index_count > (0xFFFFFFFFu - 16u) / D_REPLAY_INDEX_ENTRY_SIZE) {
+        rc = -1;
+    } else {
+        index_offset = w->offset;
+        len = 16u + w->index_count * D_REPLAY_INDEX_ENTRY_SIZE;
+        memcpy(buf, &tag, sizeof(u32));
+        memcpy(buf + 4u, &len, sizeof(u32));
+        memcpy(buf + 8u, &w->frame_count, sizeof(u32));
+        memcpy(buf + 12u, &w->keyframe_count, sizeof(u32));
+        rc = d_replay_writer_put(w, buf, 16u);
+        memcpy(buf, &w->index_count, sizeof(u32));
+        memcpy(buf + 4u, &reserved, sizeof(u32));
+        if (rc == 0) {
+            rc = d_replay_writer_put(w, buf, 8u);
+        }
+        for (i = 0u; rc == 0 && i < w->index_count; ++i) {
+            memcpy(buf, &w->index[i].tick_index, sizeof(u32));
+            memcpy(buf + 4u, &w->index[i].kind, sizeof(u32));
+            memcpy(buf + 8u, &w->index[i].offset, sizeof(u64));
+            rc = d_replay_writer_put(w, buf, D_REPLAY_INDEX_ENTRY_SIZE);
+        }
+        if (rc == 0) {
+            memcpy(buf, &index_offset, sizeof(u64));
+            memcpy(buf + 8u, g_replay_index_magic, 4u);
+            memcpy(buf + 12u, &reserved, sizeof(u32));
+            rc = d_replay_writer_put(w, buf, D_REPLAY_STREAM_TRAILER_SIZE);
+        }
+        if (fclose(w->file) != 0) {
+            rc = -1;
+        }
+    }
+    if (w->index) {
+        free(w->index);
+    }
+    if (w->scratch) {
+        free(w->scratch);
+    }
+    memset(w, 0, sizeof(*w));
+    return rc;
+}
+
+/* Stream offsets are u64; `long` is 32 bits on LLP64 targets, so the plain
+ * fseek/ftell pair would cap streams at 2 GiB. Offsets the host cannot
+ * represent are refused rather than truncated. */
+static int d_replay_file_seek(FILE *f, u64 offset, int whence) {
+#if defined(_WIN32)
+    if (offset > (u64)0x7FFFFFFFFFFFFFFFLL) {
+        return -1;
+    }
+    return _fseeki64(f, (__int64)offset, whence) == 0 ? 0 : -1;
+#elif defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 200112L)
+    off_t pos = (off_t)offset;
+    if (pos < 0 || (u64)pos != offset) {
+        return -1;
+    }
+    return fseeko(f, pos, whence) == 0 ? 0 : -1;
+#else
+    if (offset > (u64)LONG_MAX) {
+        return -1;
+    }
+    return fseek(f, (long)offset, whence) == 0 ? 0 : -1;
+#endif
+}
+
+static int d_replay_file_size(FILE *f, u64 *out_size) {
+#if defined(_WIN32)
+    __int64 pos;
+#elif defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 200112L)
+    off_t pos;
+#else
+    long pos;
+#endif
+    if (d_replay_file_seek(f, 0u, SEEK_END) != 0) {
+        return -1;
+    }
+#if defined(_WIN32)
+    pos = _ftelli64(f);
+#elif defined(_POSIX_C_SOURCE) && (_POSIX_C_SOURCE >= 200112L)
+    pos = ftello(f);
+#else
+    pos = ftell(f);
+#endif
+    if (pos < 0) {
+        return -1;
+    }
+    *out_size = (u64)pos;
+    return 0;
+}
+
+static int d_replay_reader_read_at(d_replay_reader *r, u64 offset, void *dst, u32 len) {
+    if (d_replay_file_seek(r->file, offset, SEEK_SET) != 0) {
+        return -1;
+    }
+    if (len > 0u && fread(dst, 1u, len, r->file) != len) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Reads a chunk header and, for frame/keyframe chunks, the leading tick. */
+static int d_replay_reader_chunk_at(d_replay_reader *r, u64 offset, u64 end, u32 *out_tag, u32 *out_len, u32 *out_tick) {
+    unsigned char head[12];
+    u32 head_len = 8u;
+    if (offset + 8u > end) {
+        return -1;
+    }
+    if (offset + 12u <= end) {
+        head_len = 12u;
+    }
+    if (d_replay_reader_read_at(r, offset, head, head_len) != 0) {
+        return -1;
+    }
+    memcpy(out_tag, head, sizeof(u32));
+    memcpy(out_len, head + 4u, sizeof(u32));
+    if ((u64)*out_len > end - offset - 8u) {
+        return -1;
+    }
+    *out_tick = 0u;
+    if (*out_tag == D_REPLAY_TAG_FRAME || *out_tag == D_REPLAY_TAG_KEYFRAME) {
+        if (*out_len < 4u) {
+            return -1;
+        }
+        memcpy(out_tick, head + 8u, sizeof(u32));
+    }
+    return 0;
+}
+
+static int d_replay_reader_load_payload(d_replay_reader *r, u64 offset, u32 len) {
+    if (d_replay_grow_scratch(&r->scratch, &r->scratch_capacity, len) != 0) {
+        return -1;
+    }
+    return d_replay_reader_read_at(r, offset + 8u, r->scratch, len);
+}
+
+/* Decodes the frame payload in `scratch`; inputs borrow the scratch bytes. */
+static int d_replay_reader_decode_frame(d_replay_reader *r, u32 len) {
+    const unsigned char *p = r->scratch;
+    u32 remaining = len;
+    u32 tick_index;
+    u32 input_count;
+    u32 j;
+    if (remaining < 8u) {
+        return -1;
+    }
+    memcpy(&tick_index, p, sizeof(u32));
+    memcpy(&input_count, p + 4u, sizeof(u32));
+    p += 8u;
+    remaining -= 8u;
+    if (input_count > remaining / 12u) {
+        return -1;
+    }
+    if (input_count > r->inputs_capacity) {
+        d_net_input_frame *grown = (d_net_input_frame *)realloc(r->inputs, sizeof(d_net_input_frame) * input_count);
+        if (!grown) {
+            return -1;
+        }
+        r->inputs = grown;
+        r->inputs_capacity = input_count;
+    }
+    for (j = 0u; j < input_count; ++j) {
+        d_net_input_frame *in = &r->inputs[j];
+        if (remaining < 12u) {
+            return -1;
+        }
+        memcpy(&in->tick_index, p, sizeof(u32));
+        memcpy(&in->player_id, p + 4u, sizeof(u32));
+        memcpy(&in->payload_size, p + 8u, sizeof(u32));
+        p += 12u;
+        remaining -= 12u;
+        if (in->payload_size > remaining) {
+            return -1;
+        }
+        in->payload = in->payload_size > 0u ? (u8 *)p : (u8 *)0;
+        p += in->payload_size;
+        remaining -= in->payload_size;
+    }
+    r->frame.tick_index = tick_index;
+    r->frame.input_count = input_count;
+    r->frame.inputs = input_count > 0u ? r->inputs : (d_net_input_frame *)0;
+    return 0;
+}
+
+static int d_replay_reader_load_index(d_replay_reader *r, u64 file_size) {
+    unsigned char buf[D_REPLAY_INDEX_ENTRY_SIZE];
+    u64 index_offset;
+    u32 tag;
+    u32 len;
+    u32 count;
+    u32 i;
+
+    if (file_size < D_REPLAY_STREAM_HEADER_SIZE + D_REPLAY_STREAM_TRAILER_SIZE + 24u) {
+        return -1;
+    }
+    if (d_replay_reader_read_at(r, file_size - D_REPLAY_STREAM_TRAILER_SIZE, buf, D_REPLAY_STREAM_TRAILER_SIZE) != 0 ||
+        memcmp(buf + 8u, g_replay_index_magic, 4u) != 0) {
+        return -1;
+    }
+    memcpy(&index_offset, buf, sizeof(u64));
+    if (index_offset < D_REPLAY_STREAM_HEADER_SIZE ||
+        index_offset + 24u > file_size - D_REPLAY_STREAM_TRAILER_SIZE) {
+        return -1;
+    }
+    if (d_replay_reader_read_at(r, index_offset, buf, 16u) != 0) {
+        return -1;
+    }
+    memcpy(&tag, buf, sizeof(u32));
+    memcpy(&len, buf + 4u, sizeof(u32));
+    if (tag != D_REPLAY_TAG_INDEX || (u64)len + 8u != file_size - D_REPLAY_STREAM_TRAILER_SIZE - index_offset) {
+        return -1;
+    }
+    memcpy(&r->frame_count, buf + 8u, sizeof(u32));
+    memcpy(&r->keyframe_count, buf + 12u, sizeof(u32));
+    if (fread(buf, 1u, 8u, r->file) != 8u) {
+        return -1;
+    }
+    memcpy(&count, buf, sizeof(u32));
+    if (len < 16u || count != (len - 16u) / D_REPLAY_INDEX_ENTRY_SIZE) {
+        return -1;
+    }
+    if (count > 0u) {
+        r->index = (d_replay_index_entry *)malloc(sizeof(d_replay_index_entry) * count);
+        if (!r->index) {
+            return -1;
+        }
+    }
+    for (i = 0u; i < count; ++i) {
+        if (fread(buf, 1u, D_REPLAY_INDEX_ENTRY_SIZE, r->file) != D_REPLAY_INDEX_ENTRY_SIZE) {
+            return -1;
+        }
+        memcpy(&r->index[i].tick_index, buf, sizeof(u32));
+        memcpy(&r->index[i].kind, buf + 4u, sizeof(u32));
+        memcpy(&r->index[i].offset, buf + 8u, sizeof(u64));
+        if (r->index[i].offset < D_REPLAY_STREAM_HEADER_SIZE || r->index[i].offset >= index_offset) {
+            return -1;
+        }
+    }
+    r->index_count = count;
+    r->data_end = index_offset;
+    return 0;
+}
+
+/* No usable trailer: rebuild the index from the chunks, stopping at the
+ * first truncated one. */
+static int d_replay_reader_scan_index(d_replay_reader *r, u64 file_size, u32 stride) {
+    u32 capacity = 0u;
+    u32 since_index = 0u;
+    u64 offset = D_REPLAY_STREAM_HEADER_SIZE;
+    u32 tag;
+    u32 len;
+    u32 tick;
+
+    if (r->index) {
+        free(r->index);
+        r->index = (d_replay_index_entry *)0;
+    }
+    r->index_count = 0u;
+    r->frame_count = 0u;
+    r->keyframe_count = 0u;
+    if (stride == 0u) {
+        stride = D_REPLAY_STREAM_DEFAULT_STRIDE;
+    }
+    while (d_replay_reader_chunk_at(r, offset, file_size, &tag, &len, &tick) == 0) {
+        if (tag == D_REPLAY_TAG_INDEX) {
+            break;
+        }
+        if (tag == D_REPLAY_TAG_KEYFRAME) {
+            if (d_replay_index_push(&r->index, &r->index_count, &capacity,
+                                    tick, D_REPLAY_INDEX_KEYFRAME, offset) != 0) {
+                return -1;
+            }
+            r->keyframe_count += 1u;
+        } else if (tag == D_REPLAY_TAG_FRAME) {
+            if (since_index == 0u &&
+                d_replay_index_push(&r->index, &r->index_count, &capacity,
+                                    tick, D_REPLAY_INDEX_FRAME, offset) != 0) {
+                return -1;
+            }
+            since_index = (since_index + 1u >= stride) ? 0u : since_index + 1u;
+            r->frame_count += 1u;
+        }
+        offset += 8u + len;
+    }
+    r->data_end = offset;
+    return 0;
+}
+
+int d_replay_reader_open(d_replay_reader *r, const char *path) {
+    unsigned char header[D_REPLAY_STREAM_HEADER_SIZE];
+    u32 version;
+    u32 stride;
+    u64 size;
+    if (!r || !path) {
+        return -1;
+    }
+    memset(r, 0, sizeof(*r));
+    r->file = fopen(path, "rb");
+    if (!r->file) {
+        return -1;
+    }
+    if (fread(header, 1u, D_REPLAY_STREAM_HEADER_SIZE, r->file) != D_REPLAY_STREAM_HEADER_SIZE ||
+        memcmp(header, g_replay_stream_magic, 4u) != 0) {
+        d_replay_reader_close(r);
+        return -1;
+    }
+    memcpy(&version, header + 4u, sizeof(u32));
+    memcpy(&stride, header + 12u, sizeof(u32));
+    if (version != D_REPLAY_STREAM_VERSION ||
+        d_replay_file_size(r->file, &size) != 0 ||
+        size < D_REPLAY_STREAM_HEADER_SIZE) {
+        d_replay_reader_close(r);
+        return -1;
+    }
+    if (d_replay_reader_load_index(r, size) != 0 &&
+        d_replay_reader_scan_index(r, size, stride) != 0) {
+        d_replay_reader_close(r);
+        return -1;
+    }
+    return 0;
+}
+
+void d_replay_reader_close(d_replay_reader *r) {
+    if (!r) {
+        return;
+    }
+    if (r->file) {
+        fclose(r->file);
+    }
+    if (r->index) {
+        free(r->index);
+    }
+    if (r->inputs) {
+        free(r->inputs);
+    }
+    if (r->scratch) {
+        free(r->scratch);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+int d_replay_reader_frame(d_replay_reader *r, u32 tick_index, const dreplay_frame **out_frame) {
+    u64 offset;
+    u32 pos;
+    u32 tag;
+    u32 len;
+    u32 tick;
+    if (!r || !r->file || !out_frame) {
+        return -1;
+    }
+    *out_frame = (const dreplay_frame *)0;
+    if (!d_replay_index_floor(r->index, r->index_count, tick_index, &pos)) {
+        return -2;
+    }
+    /* At most one index stride of chunk headers is walked from here. */
+    offset = r->index[pos].offset;
+    while (offset < r->data_end) {
+        if (d_replay_reader_chunk_at(r, offset, r->data_end, &tag, &len, &tick) != 0) {
+            return -1;
+        }
+        if (tag == D_REPLAY_TAG_FRAME) {
+            if (tick > tick_index) {
+                return -2;
+            }
+            if (tick == tick_index) {
+                if (d_replay_reader_load_payload(r, offset, len) != 0 ||
+                    d_replay_reader_decode_frame(r, len) != 0) {
+                    return -1;
+                }
+                *out_frame = &r->frame;
+                return 0;
+            }
+        }
+        offset += 8u + len;
+    }
+    return -2;
+}
+
+int d_replay_reader_seek(
+    d_replay_reader  *r,
+    u32               tick_index,
+    d_replay_step_fn  step,
+    void             *user,
+    d_world         **out_world,
+    u32              *out_keyframe_tick
+) {
+    const d_replay_index_entry *key;
+    d_world *world;
+    u64 offset;
+    u32 pos;
+    u32 tag;
+    u32 len;
+    u32 tick;
+    if (!r || !r->file || !out_world) {
+        return -1;
+    }
+    *out_world = (d_world *)0;
+    if (!d_replay_index_floor(r->index, r->index_count, tick_index, &pos)) {
+        return -2;
+    }
+    while (r->index[pos].kind != D_REPLAY_INDEX_KEYFRAME) {
+        if (pos == 0u) {
+            return -2;
+        }
+        pos -= 1u;
+    }
+    key = &r->index[pos];
+
+    if (d_replay_reader_chunk_at(r, key->offset, r->data_end, &tag, &len, &tick) != 0 ||
+        tag != D_REPLAY_TAG_KEYFRAME ||
+        d_replay_reader_load_payload(r, key->offset, len) != 0) {
+        return -1;
+    }
+    world = d_world_load_image(r->scratch + 4u, len - 4u);
+    if (!world) {
+        return -1;
+    }
+
+    offset = key->offset + 8u + len;
+    while (offset < r->data_end) {
+        if (d_replay_reader_chunk_at(r, offset, r->data_end, &tag, &len, &tick) != 0) {
+            d_world_destroy_instance(world);
+            return -1;
+        }
+        if (tag == D_REPLAY_TAG_FRAME) {
+            if (tick >= tick_index) {
+                break;
+            }
+            if (step) {
+                if (d_replay_reader_load_payload(r, offset, len) != 0 ||
+                    d_replay_reader_decode_frame(r, len) != 0 ||
+                    step(user, world, &r->frame) != 0) {
+                    d_world_destroy_instance(world);
+                    return -1;
+                }
+            }
+        }
+        offset += 8u + len;
+    }
+
+    *out_world = world;
+    if (out_keyframe_tick) {
+        *out_keyframe_tick = key->tick_index;
+    }
     return 0;
 }
 
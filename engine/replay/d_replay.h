@@ -15,8 +15,11 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #ifndef D_REPLAY_H
 #define D_REPLAY_H
 
+#include <stdio.h>
+
 #include "domino/core/types.h"
 #include "domino/core/d_tlv.h"
+#include "domino/sim/sim.h"
 #include "d_net.h"
 #include "d_sim_hash.h"
 
@@ -50,6 +53,7 @@ typedef struct d_replay_context {
     u32            frame_capacity;
 
     u32            cursor;       /* current frame index for playback */
+    u32            frames_sorted; /* 1 when frames are strictly ordered by tick_index */
 } d_replay_context;
 
 /* Initialize a replay context in RECORD or PLAYBACK mode. */
@@ -84,6 +88,116 @@ int d_replay_deserialize(
     d_replay_context *out_ctx
 );
 
+/*
+ * Streaming replay files.
+ *
+ * Layout: a 16-byte header, then append-only chunks (tag u32, len u32,
+ * payload), then an index chunk and a 16-byte trailer pointing at it.
+ * Frame chunks reuse the D_REPLAY_TAG_FRAME payload of d_replay_serialize;
+ * keyframe chunks hold (tick_index, world image) where the image comes from
+ * the subsystems' save_instance hooks via d_world_save_image and captures
+ * the world before that tick's inputs are applied.
+ *
+ * The index holds every keyframe plus one frame entry per `index_stride`
+ * frames, so recording memory stays bounded by the stride rather than the
+ * session length. A file without a trailer (recording interrupted) is
+ * re-indexed by scanning the chunks on open.
+ */
+#define D_REPLAY_STREAM_VERSION          1u
+#define D_REPLAY_STREAM_DEFAULT_STRIDE   64u
+
+enum {
+    D_REPLAY_INDEX_FRAME = 1u,
+    D_REPLAY_INDEX_KEYFRAME = 2u
+};
+
+typedef struct d_replay_index_entry {
+    u32 tick_index;
+    u32 kind;        /* D_REPLAY_INDEX_* */
+    u64 offset;      /* file offset of the chunk header */
+} d_replay_index_entry;
+
+typedef struct d_replay_writer {
+    FILE                 *file;
+    u64                   offset;
+    u32                   keyframe_interval; /* 0 = keyframes only on request */
+    u32                   index_stride;
+    u32                   frames_since_index;
+    u32                   frame_count;
+    u32                   keyframe_count;
+    u32                   last_tick;
+    u32                   last_keyframe_tick;
+    int                   has_frame;
+    int                   has_keyframe;
+
+    d_replay_index_entry *index;
+    u32                   index_count;
+    u32                   index_capacity;
+
+    unsigned char        *scratch;   /* reused frame encode buffer */
+    u32                   scratch_capacity;
+} d_replay_writer;
+
+typedef struct d_replay_reader {
+    FILE                 *file;
+    u64                   data_end;  /* first byte past the last chunk */
+    u32                   frame_count;
+    u32                   keyframe_count;
+
+    d_replay_index_entry *index;
+    u32                   index_count;
+
+    /* Frame returned by d_replay_reader_frame; borrows `scratch`. */
+    dreplay_frame         frame;
+    d_net_input_frame    *inputs;
+    u32                   inputs_capacity;
+    unsigned char        *scratch;
+    u32                   scratch_capacity;
+} d_replay_reader;
+
+/* Applies one recorded frame to `w` while seeking. Non-zero aborts the seek. */
+typedef int (*d_replay_step_fn)(void *user, d_world *w, const dreplay_frame *frame);
+
+/* Create/truncate `path` and write the header. */
+int d_replay_writer_open(d_replay_writer *w, const char *path, u32 keyframe_interval);
+
+/* Append inputs for a tick. Ticks must be strictly increasing. When `world`
+ * is non-NULL and a keyframe is due, one is written before the frame. */
+int d_replay_writer_record(
+    d_replay_writer         *w,
+    u32                      tick_index,
+    const d_net_input_frame *inputs,
+    u32                      input_count,
+    const d_world           *world
+);
+
+/* Append a keyframe of `world` at `tick_index` (>= last recorded tick). */
+int d_replay_writer_keyframe(d_replay_writer *w, u32 tick_index, const d_world *world);
+
+/* Write the index and trailer and close the file. */
+int d_replay_writer_close(d_replay_writer *w);
+
+int  d_replay_reader_open(d_replay_reader *r, const char *path);
+void d_replay_reader_close(d_replay_reader *r);
+
+/* Look up the frame recorded for `tick_index`.
+ * Returns 0 and sets `*out_frame` (valid until the next reader call),
+ * -2 when no frame was recorded for that tick, -1 on I/O or format errors. */
+int d_replay_reader_frame(d_replay_reader *r, u32 tick_index, const dreplay_frame **out_frame);
+
+/* Restore the nearest keyframe at or before `tick_index` and call `step` for
+ * every recorded frame from the keyframe tick up to (excluding) `tick_index`.
+ * On success `*out_world` is a new world the caller destroys.
+ * Returns -2 when no keyframe precedes `tick_index`. */
+int d_replay_reader_seek(
+    d_replay_reader  *r,
+    u32               tick_index,
+    d_replay_step_fn  step,
+    void             *user,
+    d_world         **out_world,
+    u32              *out_keyframe_tick
+);
+
 /* Subsystem registration hook. */
 void d_replay_register_subsystem(void);
 
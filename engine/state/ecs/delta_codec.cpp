@@ -3,14 +3,25 @@ FILE: engine/state/ecs/delta_codec.cpp
 MODULE: Domino
 LAYER / SUBSYSTEM: Domino / ecs
 RESPONSIBILITY: Deterministic delta codec for packed views.
-ALLOWED DEPENDENCIES: engine/include public headers and C++98 headers only.
+ALLOWED DEPENDENCIES: engine/include public headers, C++98 headers, and compiler intrinsics headers.
 FORBIDDEN DEPENDENCIES: engine internal headers outside ecs.
 DETERMINISM: Stable ordering and explicit byte layout only.
+NOTES: Row comparison scans both views as flat byte ranges (16 bytes per
+       step with SSE2, 8 otherwise) and only divides by the stride when a
+       difference is found, then resumes at the next row. Output is identical
+       on every path.
 */
 #include "domino/ecs/ecs_delta_codec.h"
 
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DOM_DELTA_SSE2 1
+#include <emmintrin.h>
+#else
+#define DOM_DELTA_SSE2 0
+#endif
+
 static void dom_delta_write_u32(unsigned char* dst, u32 value)
 {
     dst[0] = (unsigned char)(value & 0xFFu);
@@ -21,10 +32,292 @@ static void dom_delta_write_u32(unsigned char* dst, u32 value)
 
 static void dom_delta_write_u64(unsigned char* dst, u64 value)
 {
+    dom_delta_write_u32(dst, (u32)(value & 0xFFFFFFFFu));
+    dom_delta_write_u32(dst + 4u, (u32)(value >> 32u));
+}
+
+static u32 dom_delta_read_u32(const unsigned char* src)
+{
+    return (u32)src[0] |
+           ((u32)src[1] << 8u) |
+           ((u32)src[2] << 16u) |
+           ((u32)src[3] << 24u);
+}
+
+static u64 dom_delta_read_u64(const unsigned char* src)
+{
+    return (u64)dom_delta_read_u32(src) | ((u64)dom_delta_read_u32(src + 4u) << 32u);
+}
+
+static u32 dom_delta_ctz32(u32 value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_ctz(value);
+#else
+    u32 n = 0u;
+    while ((value & 1u) == 0u) {
+        value >>= 1u;
+        n += 1u;
+    }
+    return n;
+#endif
+}
+
+static u32 dom_delta_ctz64(u64 value)
+{
+    const u32 low = (u32)(value & 0xFFFFFFFFu);
+    return (low != 0u) ? dom_delta_ctz32(low) : 32u + dom_delta_ctz32((u32)(value >> 32u));
+}
+
+static u32 dom_delta_popcount64(u64 value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (u32)__builtin_popcountll(value);
+#else
+    value = value - ((value >> 1u) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2u) & 0x3333333333333333ULL);
+    value = (value + (value >> 4u)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (u32)((value * 0x0101010101010101ULL) >> 56u);
+#endif
+}
+
+/* Packed fields are little-endian and 1, 2, 4 or 8 bytes wide. */
+static u64 dom_delta_load(const unsigned char* src, u32 size)
+{
+    switch (size) {
+    case 1u:
+        return (u64)src[0];
+    case 2u:
+        return (u64)src[0] | ((u64)src[1] << 8u);
+    case 4u:
+        return (u64)dom_delta_read_u32(src);
+    default:
+        return dom_delta_read_u64(src);
+    }
+}
+
+static void dom_delta_store(unsigned char* dst, u32 size, u64 value)
+{
+    switch (size) {
+    case 1u:
+        dst[0] = (unsigned char)(value & 0xFFu);
+        break;
+    case 2u:
+        dst[0] = (unsigned char)(value & 0xFFu);
+        dst[1] = (unsigned char)((value >> 8u) & 0xFFu);
+        break;
+    case 4u:
+        dom_delta_write_u32(dst, (u32)(value & 0xFFFFFFFFu));
+        break;
+    default:
+        dom_delta_write_u64(dst, value);
+        break;
+    }
+}
+
+/* First offset in [pos, end) where a and b differ, or end. */
+static size_t dom_delta_find_diff(const unsigned char* a,
+                                  const unsigned char* b,
+                                  size_t pos,
+                                  size_t end)
+{
+#if DOM_DELTA_SSE2
+    while (pos + 64u <= end) {
+        const __m128i e0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos)),
+                                          _mm_loadu_si128((const __m128i*)(b + pos)));
+        const __m128i e1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos + 16u)),
+                                          _mm_loadu_si128((const __m128i*)(b + pos + 16u)));
+        const __m128i e2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos + 32u)),
+                                          _mm_loadu_si128((const __m128i*)(b + pos + 32u)));
+        const __m128i e3 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos + 48u)),
+                                          _mm_loadu_si128((const __m128i*)(b + pos + 48u)));
+        const __m128i all = _mm_and_si128(_mm_and_si128(e0, e1), _mm_and_si128(e2, e3));
+        if (_mm_movemask_epi8(all) != 0xFFFF) {
+            break;
+        }
+        pos += 64u;
+    }
+    while (pos + 16u <= end) {
+        const u32 differ = (u32)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + pos)),
+                           _mm_loadu_si128((const __m128i*)(b + pos)))) ^ 0xFFFFu;
+        if (differ != 0u) {
+            return pos + dom_delta_ctz32(differ);
+        }
+        pos += 16u;
+    }
+#endif
+    while (pos + 8u <= end) {
+        u64 wa;
+        u64 wb;
+        memcpy(&wa, a + pos, sizeof(wa));
+        memcpy(&wb, b + pos, sizeof(wb));
+        if (wa != wb) {
+            break;
+        }
+        pos += 8u;
+    }
+    while (pos < end && a[pos] == b[pos]) {
+        pos += 1u;
+    }
+    return pos;
+}
+
+/* Sets a bit in the zeroed bitmask for every row that differs. */
+static u32 dom_delta_mark_rows(const unsigned char* base,
+                               const unsigned char* cur,
+                               u32 stride,
+                               u32 rows,
+                               unsigned char* bitmask)
+{
+    /* Views hold at most 4 GiB, so offsets divide in 32 bits. */
+    const size_t end = (size_t)rows * stride;
+    size_t pos = 0u;
+    u32 changed = 0u;
+    while (pos < end) {
+        u32 row;
+        pos = dom_delta_find_diff(base, cur, pos, end);
+        if (pos >= end) {
+            break;
+        }
+        row = (u32)pos / stride;
+        bitmask[row >> 3u] |= (unsigned char)(1u << (row & 7u));
+        changed += 1u;
+        pos = (size_t)(row + 1u) * stride;
+    }
+    return changed;
+}
+
+static u64 dom_delta_mask_word(const unsigned char* bitmask, u32 bitmask_bytes, u32 word)
+{
+    const u32 first = word * 8u;
+    u32 n = bitmask_bytes - first;
+    u64 value = 0u;
     u32 i;
-    for (i = 0u; i < 8u; ++i) {
-        dst[i] = (unsigned char)((value >> (i * 8u)) & 0xFFu);
+    if (n >= 8u) {
+        return dom_delta_read_u64(bitmask + first);
+    }
+    for (i = 0u; i < n; ++i) {
+        value |= (u64)bitmask[first + i] << (i * 8u);
     }
+    return value;
+}
+
+/* Walks runs of consecutive set bits, 64 rows per bitmask word. */
+typedef struct dom_delta_run_iter {
+    const unsigned char* bitmask;
+    u32 bitmask_bytes;
+    u32 word;
+    u32 word_count;
+    u64 bits;
+} dom_delta_run_iter;
+
+static void dom_delta_run_iter_init(dom_delta_run_iter* it, const unsigned char* bitmask, u32 bitmask_bytes)
+{
+    it->bitmask = bitmask;
+    it->bitmask_bytes = bitmask_bytes;
+    it->word = 0u;
+    it->word_count = (bitmask_bytes + 7u) / 8u;
+    it->bits = 0u;
+}
+
+static d_bool dom_delta_next_run(dom_delta_run_iter* it, u32* out_row, u32* out_run)
+{
+    u32 first;
+    u32 run;
+    u64 rest;
+    while (it->bits == 0u) {
+        if (it->word >= it->word_count) {
+            return D_FALSE;
+        }
+        it->bits = dom_delta_mask_word(it->bitmask, it->bitmask_bytes, it->word);
+        it->word += 1u;
+    }
+    first = dom_delta_ctz64(it->bits);
+    rest = it->bits >> first;
+    run = (~rest == 0u) ? 64u - first : dom_delta_ctz64(~rest);
+    *out_row = (it->word - 1u) * 64u + first;
+    *out_run = run;
+    it->bits = (first + run >= 64u) ? 0u : (it->bits & (~(u64)0u << (first + run)));
+    return D_TRUE;
+}
+
+static unsigned char* dom_delta_put_varint(unsigned char* dst, const unsigned char* end, u64 value)
+{
+    while (value >= 0x80u) {
+        if (dst >= end) {
+            return 0;
+        }
+        *dst++ = (unsigned char)((value & 0x7Fu) | 0x80u);
+        value >>= 7u;
+    }
+    if (dst >= end) {
+        return 0;
+    }
+    *dst++ = (unsigned char)value;
+    return dst;
+}
+
+static const unsigned char* dom_delta_get_varint(const unsigned char* src, const unsigned char* end, u64* out_value)
+{
+    u64 value = 0u;
+    u32 shift = 0u;
+    while (src < end) {
+        const u32 byte = *src++;
+        if (shift < 64u) {
+            value |= (u64)(byte & 0x7Fu) << shift;
+        }
+        if ((byte & 0x80u) == 0u) {
+            *out_value = value;
+            return src;
+        }
+        shift += 7u;
+    }
+    return 0;
+}
+
+/* Encodes one row field by field; base may be null for appended rows. */
+static unsigned char* dom_delta_put_row(const dom_packed_field_desc* fields,
+                                        u32 field_count,
+                                        const unsigned char* base,
+                                        const unsigned char* cur,
+                                        unsigned char* dst,
+                                        const unsigned char* end)
+{
+    u32 offset = 0u;
+    u32 i;
+    for (i = 0u; i < field_count && dst; ++i) {
+        const u32 size = fields[i].element_size;
+        u64 value = dom_delta_load(cur + offset, size);
+        if (base) {
+            value ^= dom_delta_load(base + offset, size);
+        }
+        dst = dom_delta_put_varint(dst, end, value);
+        offset += size;
+    }
+    return dst;
+}
+
+static const unsigned char* dom_delta_get_row(const dom_packed_field_desc* fields,
+                                              u32 field_count,
+                                              const unsigned char* src,
+                                              const unsigned char* end,
+                                              unsigned char* row,
+                                              d_bool xor_row)
+{
+    u32 offset = 0u;
+    u32 i;
+    for (i = 0u; i < field_count && src; ++i) {
+        const u32 size = fields[i].element_size;
+        u64 value = 0u;
+        src = dom_delta_get_varint(src, end, &value);
+        if (xor_row) {
+            value ^= dom_delta_load(row + offset, size);
+        }
+        dom_delta_store(row + offset, size, value);
+        offset += size;
+    }
+    return src;
 }
 
 int dom_delta_build(const dom_packed_view* baseline,
@@ -33,16 +326,34 @@ int dom_delta_build(const dom_packed_view* baseline,
                     u32 out_capacity,
                     dom_packed_delta_info* out_info)
 {
-    u32 i;
+    return dom_delta_build_ex(baseline, current, DOM_DELTA_BUILD_NONE,
+                              out_bytes, out_capacity, out_info);
+}
+
+int dom_delta_build_ex(const dom_packed_view* baseline,
+                       const dom_packed_view* current,
+                       u32 flags,
+                       unsigned char* out_bytes,
+                       u32 out_capacity,
+                       dom_packed_delta_info* out_info)
+{
     u32 stride;
     u32 entity_count;
+    u32 baseline_count;
+    u32 common_count;
+    u32 appended_count;
     u32 bitmask_bytes;
-    u32 header_bytes = 8u + 8u + 4u + 4u;
-    u32 changed_count = 0u;
+    u32 header_bytes = DOM_DELTA_HEADER_BYTES;
+    u32 wire_flags = 0u;
+    u32 changed_count;
     u32 payload_bytes;
     u32 total_bytes;
+    d_bool xor_rows;
     unsigned char* bitmask;
     unsigned char* payload;
+    dom_delta_run_iter it;
+    u32 row;
+    u32 run;
 
     if (!baseline || !current || !out_bytes || !out_info) {
         return -1;
@@ -50,8 +361,9 @@ int dom_delta_build(const dom_packed_view* baseline,
     if (baseline->view_id != current->view_id) {
         return -2;
     }
-    if (baseline->entity_count != current->entity_count ||
-        baseline->stride != current->stride) {
+    if (baseline->stride != current->stride ||
+        (baseline->entity_count != current->entity_count &&
+         (flags & DOM_DELTA_BUILD_RESIZE) == 0u)) {
         return -3;
     }
     if (!baseline->bytes || !current->bytes) {
@@ -59,45 +371,84 @@ int dom_delta_build(const dom_packed_view* baseline,
     }
     stride = current->stride;
     entity_count = current->entity_count;
-    if (stride == 0u && entity_count > 0u) {
+    baseline_count = baseline->entity_count;
+    if ((stride == 0u && (entity_count > 0u || baseline_count > 0u)) ||
+        (stride & DOM_DELTA_STRIDE_EXTENDED) != 0u) {
         return -5;
     }
-    bitmask_bytes = (entity_count + 7u) / 8u;
-
-    for (i = 0u; i < entity_count; ++i) {
-        const unsigned char* base_ptr = baseline->bytes + (size_t)i * stride;
-        const unsigned char* cur_ptr = current->bytes + (size_t)i * stride;
-        if (memcmp(base_ptr, cur_ptr, stride) != 0) {
-            changed_count += 1u;
-        }
+    xor_rows = ((flags & DOM_DELTA_BUILD_XOR_VARINT) != 0u) ? D_TRUE : D_FALSE;
+    if (xor_rows &&
+        dom_packed_view_calc_stride(current->fields, current->field_count) != stride) {
+        return -5;
     }
-
-    payload_bytes = changed_count * stride;
-    total_bytes = header_bytes + bitmask_bytes + payload_bytes;
-    if (total_bytes > out_capacity) {
+    if (xor_rows) {
+        wire_flags |= DOM_DELTA_BUILD_XOR_VARINT;
+    }
+    if (entity_count != baseline_count) {
+        wire_flags |= DOM_DELTA_BUILD_RESIZE;
+    }
+    if (wire_flags != 0u) {
+        header_bytes += DOM_DELTA_HEADER_EXT_BYTES;
+    }
+    common_count = (entity_count < baseline_count) ? entity_count : baseline_count;
+    appended_count = entity_count - common_count;
+    bitmask_bytes = (common_count + 7u) / 8u;
+    if ((u64)header_bytes + bitmask_bytes > (u64)out_capacity) {
         return -6;
     }
 
-    dom_delta_write_u64(out_bytes, current->view_id);
-    dom_delta_write_u64(out_bytes + 8u, baseline->baseline_id);
-    dom_delta_write_u32(out_bytes + 16u, entity_count);
-    dom_delta_write_u32(out_bytes + 20u, stride);
-
     bitmask = out_bytes + header_bytes;
     payload = bitmask + bitmask_bytes;
     memset(bitmask, 0, bitmask_bytes);
+    changed_count = dom_delta_mark_rows(baseline->bytes, current->bytes, stride,
+                                        common_count, bitmask);
 
-    for (i = 0u; i < entity_count; ++i) {
-        const unsigned char* base_ptr = baseline->bytes + (size_t)i * stride;
-        const unsigned char* cur_ptr = current->bytes + (size_t)i * stride;
-        if (memcmp(base_ptr, cur_ptr, stride) != 0) {
-            u32 byte_index = i / 8u;
-            u32 bit_index = i % 8u;
-            bitmask[byte_index] |= (unsigned char)(1u << bit_index);
-            memcpy(payload, cur_ptr, stride);
-            payload += stride;
+    dom_delta_run_iter_init(&it, bitmask, bitmask_bytes);
+    if (!xor_rows) {
+        const u64 raw_bytes = (u64)(changed_count + appended_count) * stride;
+        if ((u64)header_bytes + bitmask_bytes + raw_bytes > (u64)out_capacity) {
+            return -6;
+        }
+        while (dom_delta_next_run(&it, &row, &run)) {
+            memcpy(payload, current->bytes + (size_t)row * stride, (size_t)run * stride);
+            payload += (size_t)run * stride;
+        }
+        if (appended_count > 0u) {
+            memcpy(payload, current->bytes + (size_t)common_count * stride,
+                   (size_t)appended_count * stride);
+            payload += (size_t)appended_count * stride;
+        }
+    } else {
+        const unsigned char* end = out_bytes + out_capacity;
+        while (payload && dom_delta_next_run(&it, &row, &run)) {
+            u32 i;
+            for (i = 0u; i < run && payload; ++i) {
+                const size_t offset = (size_t)(row + i) * stride;
+                payload = dom_delta_put_row(current->fields, current->field_count,
+                                            baseline->bytes + offset,
+                                            current->bytes + offset, payload, end);
+            }
+        }
+        for (row = common_count; row < entity_count && payload; ++row) {
+            payload = dom_delta_put_row(current->fields, current->field_count, 0,
+                                        current->bytes + (size_t)row * stride, payload, end);
+        }
+        if (!payload) {
+            return -6;
         }
     }
+    payload_bytes = (u32)(payload - (bitmask + bitmask_bytes));
+    total_bytes = header_bytes + bitmask_bytes + payload_bytes;
+
+    dom_delta_write_u64(out_bytes, current->view_id);
+    dom_delta_write_u64(out_bytes + 8u, baseline->baseline_id);
+    dom_delta_write_u32(out_bytes + 16u, entity_count);
+    dom_delta_write_u32(out_bytes + 20u,
+                        (wire_flags != 0u) ? (stride | DOM_DELTA_STRIDE_EXTENDED) : stride);
+    if (wire_flags != 0u) {
+        dom_delta_write_u32(out_bytes + DOM_DELTA_HEADER_BYTES, wire_flags);
+        dom_delta_write_u32(out_bytes + DOM_DELTA_HEADER_BYTES + 4u, baseline_count);
+    }
 
     out_info->view_id = current->view_id;
     out_info->baseline_id = baseline->baseline_id;
@@ -107,5 +458,171 @@ int dom_delta_build(const dom_packed_view* baseline,
     out_info->bitmask_bytes = bitmask_bytes;
     out_info->payload_bytes = payload_bytes;
     out_info->total_bytes = total_bytes;
+    out_info->flags = wire_flags & DOM_DELTA_BUILD_XOR_VARINT;
+    out_info->baseline_count = baseline_count;
+    out_info->appended_count = appended_count;
+    out_info->removed_count = baseline_count - common_count;
+    return 0;
+}
+
+/* Decodes varint rows into target; returns 0 when the payload is consumed exactly. */
+static int dom_delta_apply_varint(const dom_packed_view* baseline,
+                                  const unsigned char* bitmask,
+                                  u32 bitmask_bytes,
+                                  const unsigned char* src,
+                                  const unsigned char* end,
+                                  u32 common_count,
+                                  u32 entity_count,
+                                  dom_packed_view* target)
+{
+    const u32 stride = target->stride;
+    dom_delta_run_iter it;
+    u32 row;
+    u32 run;
+
+    dom_delta_run_iter_init(&it, bitmask, bitmask_bytes);
+    while (src && dom_delta_next_run(&it, &row, &run)) {
+        u32 i;
+        for (i = 0u; i < run && src; ++i) {
+            src = dom_delta_get_row(baseline->fields, baseline->field_count, src, end,
+                                    target->bytes + (size_t)(row + i) * stride, D_TRUE);
+        }
+    }
+    for (row = common_count; row < entity_count && src; ++row) {
+        src = dom_delta_get_row(baseline->fields, baseline->field_count, src, end,
+                                target->bytes + (size_t)row * stride, D_FALSE);
+    }
+    return (src == end) ? 0 : -1;
+}
+
+int dom_delta_apply(const dom_packed_view* baseline,
+                    const unsigned char* bytes,
+                    u32 byte_count,
+                    dom_packed_view* target,
+                    dom_packed_delta_info* out_info)
+{
+    u64 view_id;
+    u64 baseline_id;
+    u32 entity_count;
+    u32 stride_word;
+    u32 stride;
+    u32 baseline_count;
+    u32 wire_flags = 0u;
+    u32 header_bytes = DOM_DELTA_HEADER_BYTES;
+    u32 common_count;
+    u32 appended_count;
+    u32 bitmask_bytes;
+    u32 changed_count = 0u;
+    u32 i;
+    const unsigned char* bitmask;
+    const unsigned char* payload;
+    const unsigned char* end;
+
+    if (!baseline || !bytes || !target || !out_info) {
+        return -1;
+    }
+    if (byte_count < DOM_DELTA_HEADER_BYTES) {
+        return -6;
+    }
+    view_id = dom_delta_read_u64(bytes);
+    baseline_id = dom_delta_read_u64(bytes + 8u);
+    entity_count = dom_delta_read_u32(bytes + 16u);
+    stride_word = dom_delta_read_u32(bytes + 20u);
+    stride = stride_word & ~DOM_DELTA_STRIDE_EXTENDED;
+    baseline_count = entity_count;
+    if ((stride_word & DOM_DELTA_STRIDE_EXTENDED) != 0u) {
+        if (byte_count < DOM_DELTA_HEADER_BYTES + DOM_DELTA_HEADER_EXT_BYTES) {
+            return -6;
+        }
+        wire_flags = dom_delta_read_u32(bytes + DOM_DELTA_HEADER_BYTES);
+        baseline_count = dom_delta_read_u32(bytes + DOM_DELTA_HEADER_BYTES + 4u);
+        header_bytes += DOM_DELTA_HEADER_EXT_BYTES;
+        if ((wire_flags & ~(u32)(DOM_DELTA_BUILD_XOR_VARINT | DOM_DELTA_BUILD_RESIZE)) != 0u) {
+            return -6;
+        }
+    }
+    if (view_id != baseline->view_id || view_id != target->view_id) {
+        return -2;
+    }
+    if (baseline_id != baseline->baseline_id ||
+        baseline_count != baseline->entity_count ||
+        stride != baseline->stride || stride != target->stride) {
+        return -3;
+    }
+    if ((wire_flags & DOM_DELTA_BUILD_XOR_VARINT) != 0u &&
+        dom_packed_view_calc_stride(baseline->fields, baseline->field_count) != stride) {
+        return -3;
+    }
+    if ((baseline_count > 0u && !baseline->bytes) || (entity_count > 0u && !target->bytes)) {
+        return -4;
+    }
+    if ((u64)entity_count * stride > (u64)target->bytes_capacity) {
+        return -5;
+    }
+    if (stride == 0u && (entity_count > 0u || baseline_count > 0u)) {
+        return -6;
+    }
+    common_count = (entity_count < baseline_count) ? entity_count : baseline_count;
+    appended_count = entity_count - common_count;
+    bitmask_bytes = (common_count + 7u) / 8u;
+    if ((u64)header_bytes + bitmask_bytes > (u64)byte_count) {
+        return -6;
+    }
+    bitmask = bytes + header_bytes;
+    payload = bitmask + bitmask_bytes;
+    end = bytes + byte_count;
+    if ((common_count & 7u) != 0u &&
+        (bitmask[bitmask_bytes - 1u] >> (common_count & 7u)) != 0u) {
+        return -6;
+    }
+    for (i = 0u; i < (bitmask_bytes + 7u) / 8u; ++i) {
+        changed_count += dom_delta_popcount64(dom_delta_mask_word(bitmask, bitmask_bytes, i));
+    }
+    if ((wire_flags & DOM_DELTA_BUILD_XOR_VARINT) == 0u &&
+        (u64)(changed_count + appended_count) * stride != (u64)(end - payload)) {
+        return -6;
+    }
+
+    if (common_count > 0u && target->bytes != baseline->bytes) {
+        memmove(target->bytes, baseline->bytes, (size_t)common_count * stride);
+    }
+    if ((wire_flags & DOM_DELTA_BUILD_XOR_VARINT) == 0u) {
+        const unsigned char* src = payload;
+        dom_delta_run_iter it;
+        u32 row;
+        u32 run;
+        dom_delta_run_iter_init(&it, bitmask, bitmask_bytes);
+        while (dom_delta_next_run(&it, &row, &run)) {
+            memcpy(target->bytes + (size_t)row * stride, src, (size_t)run * stride);
+            src += (size_t)run * stride;
+        }
+        if (appended_count > 0u) {
+            memcpy(target->bytes + (size_t)common_count * stride, src,
+                   (size_t)appended_count * stride);
+        }
+    } else if (dom_delta_apply_varint(baseline, bitmask, bitmask_bytes, payload, end,
+                                      common_count, entity_count, target) != 0) {
+        dom_packed_view_reset_progress(target);
+        return -6;
+    }
+
+    target->entity_count = entity_count;
+    target->byte_count = entity_count * stride;
+    target->next_index = entity_count;
+    target->view_flags |= DOM_PACKED_VIEW_VALID;
+    target->view_flags &= ~DOM_PACKED_VIEW_STALE;
+
+    out_info->view_id = view_id;
+    out_info->baseline_id = baseline_id;
+    out_info->entity_count = entity_count;
+    out_info->stride = stride;
+    out_info->changed_count = changed_count;
+    out_info->bitmask_bytes = bitmask_bytes;
+    out_info->payload_bytes = (u32)(end - payload);
+    out_info->total_bytes = byte_count;
+    out_info->flags = wire_flags & DOM_DELTA_BUILD_XOR_VARINT;
+    out_info->baseline_count = baseline_count;
+    out_info->appended_count = appended_count;
+    out_info->removed_count = baseline_count - common_count;
     return 0;
 }
@@ -8,9 +8,13 @@ FORBIDDEN DEPENDENCIES: engine internal headers outside ecs.
 DETERMINISM: Stable ordering and deterministic commits only.
 */
 #include "soa_archetype_storage.h"
+#include "thread_pool.h"
 
 #include <string.h>
 
+/* Below this many writes a commit stays on the calling thread. */
+#define DOM_SOA_PARALLEL_MIN_OPS 1024u
+
 static u64 dom_soa_hash_init(void)
 {
     return 1469598103934665603ULL;
@@ -26,6 +30,473 @@ static u64 dom_soa_hash_u64(u64 hash, u64 v)
     return hash;
 }
 
+static u32 dom_soa_bucket_u64(u64 v)
+{
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return (u32)v;
+}
+
+static u32 dom_soa_column_bucket(dom_component_id component_id, dom_field_id field_id)
+{
+    return dom_soa_bucket_u64(component_id ^ (field_id * 0x9E3779B97F4A7C15ULL));
+}
+
+static u64 dom_soa_align_up(u64 v)
+{
+    return (v + (DOM_SOA_CHUNK_ALIGN - 1u)) & ~(u64)(DOM_SOA_CHUNK_ALIGN - 1u);
+}
+
+static void dom_soa_chunk_release(dom_soa_chunk_pool* pool, unsigned char* chunk)
+{
+    memcpy(chunk, &pool->free_head, sizeof(unsigned char*));
+    pool->free_head = chunk;
+    pool->free_count += 1u;
+}
+
+static unsigned char* dom_soa_chunk_alloc(dom_soa_chunk_pool* pool)
+{
+    unsigned char* chunk;
+    if (!pool->free_head) {
+        unsigned char* raw;
+        unsigned char* base;
+        u32 i;
+        if (pool->slab_count >= pool->slab_capacity) {
+            const u32 new_capacity = pool->slab_capacity ? pool->slab_capacity * 2u : 8u;
+            unsigned char** next = new unsigned char*[new_capacity];
+            if (pool->slabs && pool->slab_count > 0u) {
+                memcpy(next, pool->slabs, sizeof(unsigned char*) * pool->slab_count);
+            }
+            delete[] pool->slabs;
+            pool->slabs = next;
+            pool->slab_capacity = new_capacity;
+        }
+        raw = new unsigned char[(size_t)DOM_SOA_CHUNK_BYTES * DOM_SOA_CHUNKS_PER_SLAB + DOM_SOA_CHUNK_ALIGN];
+        pool->slabs[pool->slab_count++] = raw;
+        base = raw + ((DOM_SOA_CHUNK_ALIGN - ((size_t)raw & (DOM_SOA_CHUNK_ALIGN - 1u))) &
+                      (DOM_SOA_CHUNK_ALIGN - 1u));
+        for (i = DOM_SOA_CHUNKS_PER_SLAB; i > 0u; --i) {
+            dom_soa_chunk_release(pool, base + (size_t)(i - 1u) * DOM_SOA_CHUNK_BYTES);
+        }
+        pool->chunk_total += DOM_SOA_CHUNKS_PER_SLAB;
+    }
+    chunk = pool->free_head;
+    memcpy(&pool->free_head, chunk, sizeof(unsigned char*));
+    pool->free_count -= 1u;
+    return chunk;
+}
+
+/* Picks the largest power-of-two row count whose aligned column runs fit in
+ * one chunk and assigns each column its offset. Returns the row shift, or
+ * DOM_SOA_INDEX_NONE when a single row does not fit. */
+static u32 dom_soa_chunk_layout(dom_soa_column* columns, u32 column_count)
+{
+    u32 shift = 14u;
+    for (;;) {
+        u64 offset = 0u;
+        u32 c;
+        for (c = 0u; c < column_count; ++c) {
+            offset = dom_soa_align_up(offset);
+            columns[c].chunk_offset = (u32)offset;
+            offset += ((u64)1u << shift) * columns[c].element_size;
+        }
+        if (offset <= DOM_SOA_CHUNK_BYTES) {
+            return shift;
+        }
+        if (shift == 0u) {
+            return DOM_SOA_INDEX_NONE;
+        }
+        shift -= 1u;
+    }
+}
+
+static unsigned char* dom_soa_cell(const dom_soa_archetype* arch, const dom_soa_column* col, u32 row)
+{
+    return arch->chunks[row >> arch->chunk_shift] + col->chunk_offset +
+           (size_t)(row & ((1u << arch->chunk_shift) - 1u)) * col->element_size;
+}
+
+/* Rows from `row` to the end of its chunk, capped at `count`. */
+static u32 dom_soa_chunk_run(const dom_soa_archetype* arch, u32 row, u32 count)
+{
+    const u32 left = (1u << arch->chunk_shift) - (row & ((1u << arch->chunk_shift) - 1u));
+    return (left < count) ? left : count;
+}
+
+/* Moves `count` rows of every column from src_row down to dst_row < src_row. */
+static void dom_soa_move_rows_down(const dom_soa_archetype* arch, u32 dst_row, u32 src_row, u32 count)
+{
+    while (count > 0u) {
+        const u32 run = dom_soa_chunk_run(arch, dst_row, dom_soa_chunk_run(arch, src_row, count));
+        u32 c;
+        for (c = 0u; c < arch->column_count; ++c) {
+            const dom_soa_column* col = &arch->columns[c];
+            memmove(dom_soa_cell(arch, col, dst_row), dom_soa_cell(arch, col, src_row),
+                    (size_t)run * col->element_size);
+        }
+        dst_row += run;
+        src_row += run;
+        count -= run;
+    }
+}
+
+static u32 dom_soa_edge_bucket(u32 from_index, u32 kind, dom_component_id component_id)
+{
+    return dom_soa_bucket_u64((((u64)from_index << 32) | kind) ^ (component_id * 0x9E3779B97F4A7C15ULL));
+}
+
+/* Power-of-two bucket count with at most one entry per bucket on average. */
+static u32 dom_soa_bucket_count(u32 entries)
+{
+    u32 count = 8u;
+    while (count < entries) {
+        count <<= 1u;
+    }
+    return count;
+}
+
+/* One entity's net structural change within a batch. */
+typedef struct dom_soa_migration {
+    dom_entity_id entity;
+    u32           location;
+    u32           src_index;
+    u32           src_row;
+    u32           dst_index;
+} dom_soa_migration;
+
+typedef int (*dom_soa_less_fn)(const void* ctx, u32 a, u32 b);
+
+/* Bottom-up merge sort of index lists; stable, so equal keys keep push order. */
+static void dom_soa_merge_sort(u32* items, u32* scratch, u32 count,
+                               dom_soa_less_fn less, const void* ctx)
+{
+    u32* from = items;
+    u32* to = scratch;
+    u32 width;
+    for (width = 1u; width < count; width *= 2u) {
+        u32 lo;
+        for (lo = 0u; lo < count; lo += width * 2u) {
+            const u32 mid = (lo + width < count) ? lo + width : count;
+            const u32 hi = (mid + width < count) ? mid + width : count;
+            u32 a = lo;
+            u32 b = mid;
+            u32 k = lo;
+            while (a < mid && b < hi) {
+                to[k++] = less(ctx, from[b], from[a]) ? from[b++] : from[a++];
+            }
+            while (a < mid) {
+                to[k++] = from[a++];
+            }
+            while (b < hi) {
+                to[k++] = from[b++];
+            }
+        }
+        {
+            u32* tmp = from;
+            from = to;
+            to = tmp;
+        }
+    }
+    if (from != items) {
+        memcpy(items, from, sizeof(u32) * count);
+    }
+}
+
+static int dom_soa_struct_op_less(const void* ctx, u32 a, u32 b)
+{
+    const dom_soa_struct_op* ops = (const dom_soa_struct_op*)ctx;
+    return dom_commit_key_compare(&ops[a].commit_key, &ops[b].commit_key) < 0;
+}
+
+static int dom_soa_migration_dst_less(const void* ctx, u32 a, u32 b)
+{
+    const dom_soa_migration* recs = (const dom_soa_migration*)ctx;
+    if (recs[a].dst_index != recs[b].dst_index) {
+        return recs[a].dst_index < recs[b].dst_index;
+    }
+    return recs[a].src_index < recs[b].src_index;
+}
+
+/* Swap-mode hole filling must visit each archetype's holes last row first. */
+static int dom_soa_migration_hole_less(const void* ctx, u32 a, u32 b)
+{
+    const dom_soa_migration* recs = (const dom_soa_migration*)ctx;
+    if (recs[a].src_index != recs[b].src_index) {
+        return recs[a].src_index < recs[b].src_index;
+    }
+    return recs[a].src_row > recs[b].src_row;
+}
+
+static void dom_soa_reduce_element(u32 element_type,
+                                   u32 reduction_op,
+                                   unsigned char* cur_bytes,
+                                   const unsigned char* incoming_bytes)
+{
+    if (element_type == DOM_ECS_ELEM_U64) {
+        u64 cur;
+        u64 incoming;
+        memcpy(&cur, cur_bytes, sizeof(u64));
+        memcpy(&incoming, incoming_bytes, sizeof(u64));
+        if (reduction_op == DOM_REDUCE_INT_SUM) {
+            cur += incoming;
+        } else if (reduction_op == DOM_REDUCE_INT_MIN) {
+            cur = (incoming < cur) ? incoming : cur;
+        } else if (reduction_op == DOM_REDUCE_INT_MAX) {
+            cur = (incoming > cur) ? incoming : cur;
+        }
+        memcpy(cur_bytes, &cur, sizeof(u64));
+    } else if (element_type == DOM_ECS_ELEM_U32) {
+        u32 cur32;
+        u32 incoming32;
+        memcpy(&cur32, cur_bytes, sizeof(u32));
+        memcpy(&incoming32, incoming_bytes, sizeof(u32));
+        if (reduction_op == DOM_REDUCE_INT_SUM) {
+            cur32 += incoming32;
+        } else if (reduction_op == DOM_REDUCE_INT_MIN) {
+            cur32 = (incoming32 < cur32) ? incoming32 : cur32;
+        } else if (reduction_op == DOM_REDUCE_INT_MAX) {
+            cur32 = (incoming32 > cur32) ? incoming32 : cur32;
+        }
+        memcpy(cur_bytes, &cur32, sizeof(u32));
+    } else if (element_type == DOM_ECS_ELEM_I64) {
+        i64 cur64;
+        i64 incoming64;
+        memcpy(&cur64, cur_bytes, sizeof(i64));
+        memcpy(&incoming64, incoming_bytes, sizeof(i64));
+        if (reduction_op == DOM_REDUCE_INT_SUM) {
+            cur64 += incoming64;
+        } else if (reduction_op == DOM_REDUCE_INT_MIN) {
+            cur64 = (incoming64 < cur64) ? incoming64 : cur64;
+        } else if (reduction_op == DOM_REDUCE_INT_MAX) {
+            cur64 = (incoming64 > cur64) ? incoming64 : cur64;
+        }
+        memcpy(cur_bytes, &cur64, sizeof(i64));
+    } else if (element_type == DOM_ECS_ELEM_I32) {
+        i32 cur32;
+        i32 incoming32;
+        memcpy(&cur32, cur_bytes, sizeof(i32));
+        memcpy(&incoming32, incoming_bytes, sizeof(i32));
+        if (reduction_op == DOM_REDUCE_INT_SUM) {
+            cur32 += incoming32;
+        } else if (reduction_op == DOM_REDUCE_INT_MIN) {
+            cur32 = (incoming32 < cur32) ? incoming32 : cur32;
+        } else if (reduction_op == DOM_REDUCE_INT_MAX) {
+            cur32 = (incoming32 > cur32) ? incoming32 : cur32;
+        }
+        memcpy(cur_bytes, &cur32, sizeof(i32));
+    }
+}
+
+static void dom_soa_write_column(const dom_soa_archetype* arch,
+                                 const dom_soa_column* col,
+                                 const dom_ecs_write_op& op)
+{
+    const unsigned char* src = (const unsigned char*)op.data;
+    const u32 elem = col->element_size;
+    u32 row = op.range.begin_index;
+    u32 count = dom_entity_range_count(&op.range);
+    while (count > 0u) {
+        const u32 run = dom_soa_chunk_run(arch, row, count);
+        unsigned char* dst = dom_soa_cell(arch, col, row);
+        u32 i;
+        if (op.stride == elem) {
+            memcpy(dst, src, (size_t)run * elem);
+        } else {
+            for (i = 0u; i < run; ++i) {
+                memcpy(dst + (size_t)i * elem, src + (size_t)i * op.stride, elem);
+            }
+        }
+        src += (size_t)run * op.stride;
+        row += run;
+        count -= run;
+    }
+}
+
+static void dom_soa_reduce_column(const dom_soa_archetype* arch,
+                                  const dom_soa_column* col,
+                                  u32 reduction_op,
+                                  u32 begin_index,
+                                  u32 count,
+                                  const unsigned char* data,
+                                  u32 stride)
+{
+    u32 row = begin_index;
+    while (count > 0u) {
+        const u32 run = dom_soa_chunk_run(arch, row, count);
+        unsigned char* dst = dom_soa_cell(arch, col, row);
+        u32 i;
+        for (i = 0u; i < run; ++i) {
+            dom_soa_reduce_element(col->element_type, reduction_op,
+                                   dst + (size_t)i * col->element_size,
+                                   data + (size_t)i * stride);
+        }
+        data += (size_t)run * stride;
+        row += run;
+        count -= run;
+    }
+}
+
+/* Folds a run of same-op reductions over one range pairwise, in binary
+ * counter order, then touches the column once. Integer sum/min/max make the
+ * result equal to applying the run op by op. */
+static void dom_soa_reduce_run(const dom_soa_archetype* arch,
+                               const dom_soa_column* col,
+                               const dom_ecs_write_op* ops,
+                               const u32* order,
+                               u32 run)
+{
+    const dom_ecs_write_op& first = ops[order[0]];
+    const u32 count = dom_entity_range_count(&first.range);
+    const u32 elem = col->element_size;
+    const size_t row_bytes = (size_t)count * elem;
+    unsigned char* slots;
+    u32 levels[34];
+    u32 slot_count = 2u;
+    u32 depth = 0u;
+    u32 n;
+    u32 k;
+    u32 i;
+
+    if (count == 0u) {
+        return;
+    }
+    for (n = run; n > 1u; n >>= 1u) {
+        slot_count += 1u;
+    }
+    slots = new unsigned char[row_bytes * slot_count];
+    for (k = 0u; k < run; ++k) {
+        const dom_ecs_write_op& op = ops[order[k]];
+        unsigned char* top = slots + (size_t)depth * row_bytes;
+        u32 level = 0u;
+        for (i = 0u; i < count; ++i) {
+            memcpy(top + (size_t)i * elem, (const unsigned char*)op.data + (size_t)i * op.stride, elem);
+        }
+        while (depth > 0u && levels[depth - 1u] == level) {
+            unsigned char* left = top - row_bytes;
+            for (i = 0u; i < count; ++i) {
+                dom_soa_reduce_element(col->element_type, first.reduction_op,
+                                       left + (size_t)i * elem, top + (size_t)i * elem);
+            }
+            top = left;
+            depth -= 1u;
+            level += 1u;
+        }
+        levels[depth++] = level;
+    }
+    while (depth > 1u) {
+        unsigned char* left = slots + (size_t)(depth - 2u) * row_bytes;
+        unsigned char* right = left + row_bytes;
+        for (i = 0u; i < count; ++i) {
+            dom_soa_reduce_element(col->element_type, first.reduction_op,
+                                   left + (size_t)i * elem, right + (size_t)i * elem);
+        }
+        depth -= 1u;
+    }
+    dom_soa_reduce_column(arch, col, first.reduction_op, first.range.begin_index, count, slots, elem);
+    delete[] slots;
+}
+
+/* Stable LSD radix sort, one byte per pass over the 128-bit packed key. */
+static void dom_soa_radix_sort_commit(dom_soa_commit_item* items,
+                                      dom_soa_commit_item* scratch,
+                                      u32 count)
+{
+    u32 counts[16][256];
+    dom_soa_commit_item* from = items;
+    dom_soa_commit_item* to = scratch;
+    u32 pass;
+    u32 i;
+
+    memset(counts, 0, sizeof(counts));
+    for (i = 0u; i < count; ++i) {
+        for (pass = 0u; pass < 8u; ++pass) {
+            counts[pass][(u32)(items[i].lo >> (pass * 8u)) & 0xFFu] += 1u;
+            counts[pass + 8u][(u32)(items[i].hi >> (pass * 8u)) & 0xFFu] += 1u;
+        }
+    }
+    for (pass = 0u; pass < 16u; ++pass) {
+        const u32 shift = (pass & 7u) * 8u;
+        u32* bucket = counts[pass];
+        u32 offset = 0u;
+        u32 d;
+        /* Bytes every key shares (high task/phase bits, mostly) cost nothing. */
+        if (bucket[(u32)(((pass < 8u) ? from[0].lo : from[0].hi) >> shift) & 0xFFu] == count) {
+            continue;
+        }
+        for (d = 0u; d < 256u; ++d) {
+            const u32 n = bucket[d];
+            bucket[d] = offset;
+            offset += n;
+        }
+        for (i = 0u; i < count; ++i) {
+            const u64 key = (pass < 8u) ? from[i].lo : from[i].hi;
+            to[bucket[(u32)(key >> shift) & 0xFFu]++] = from[i];
+        }
+        {
+            dom_soa_commit_item* tmp = from;
+            from = to;
+            to = tmp;
+        }
+    }
+    if (from != items) {
+        memcpy(items, from, sizeof(dom_soa_commit_item) * count);
+    }
+}
+
+/* A contiguous range of (archetype, column) groups; groups never share
+ * column memory, so jobs run concurrently. */
+typedef struct dom_soa_commit_job {
+    const dom_ecs_write_op* ops;
+    const u32*              order;
+    const u32*              group_start;
+    dom_soa_archetype* const* group_archetypes;
+    dom_soa_column* const*  group_columns;
+    u32                     group_begin;
+    u32                     group_end;
+} dom_soa_commit_job;
+
+static d_bool dom_soa_same_reduce(const dom_ecs_write_op& a, const dom_ecs_write_op& b)
+{
+    return (b.reduction_op == a.reduction_op &&
+            b.range.begin_index == a.range.begin_index &&
+            b.range.end_index == a.range.end_index) ? D_TRUE : D_FALSE;
+}
+
+static void dom_soa_commit_job_run(void* user_data)
+{
+    const dom_soa_commit_job* job = (const dom_soa_commit_job*)user_data;
+    u32 g;
+    for (g = job->group_begin; g < job->group_end; ++g) {
+        const dom_soa_archetype* arch = job->group_archetypes[g];
+        const dom_soa_column* col = job->group_columns[g];
+        const u32 end = job->group_start[g + 1u];
+        u32 i = job->group_start[g];
+        while (i < end) {
+            const dom_ecs_write_op& op = job->ops[job->order[i]];
+            u32 run = 1u;
+            if (op.reduction_op == DOM_REDUCE_NONE) {
+                dom_soa_write_column(arch, col, op);
+                i += 1u;
+                continue;
+            }
+            while (i + run < end && dom_soa_same_reduce(op, job->ops[job->order[i + run]])) {
+                run += 1u;
+            }
+            if (run == 1u) {
+                dom_soa_reduce_column(arch, col, op.reduction_op, op.range.begin_index,
+                                      dom_entity_range_count(&op.range),
+                                      (const unsigned char*)op.data, op.stride);
+            } else {
+                dom_soa_reduce_run(arch, col, job->ops, job->order + i, run);
+            }
+            i += run;
+        }
+    }
+}
+
 extern "C" {
 
 void dom_soa_sort_component_ids(dom_component_id* ids, u32 count)
@@ -95,9 +566,28 @@ dom_soa_archetype_storage::dom_soa_archetype_storage()
     : archetypes_(0),
       archetype_count_(0u),
       archetype_capacity_(0u),
+      archetype_buckets_(0),
+      archetype_bucket_mask_(0u),
+      locations_(0),
+      location_count_(0u),
+      location_capacity_(0u),
+      location_buckets_(0),
+      location_bucket_mask_(0u),
+      remove_mode_(DOM_SOA_REMOVE_STABLE),
+      in_phase_(D_FALSE),
+      edges_(0),
+      edge_count_(0u),
+      edge_capacity_(0u),
+      edge_buckets_(0),
+      edge_bucket_mask_(0u),
+      pool_(0),
+      commit_items_(0),
+      commit_scratch_(0),
+      op_columns_(0),
       sort_indices_(0),
       sort_capacity_(0u)
 {
+    memset(&chunk_pool_, 0, sizeof(chunk_pool_));
 }
 
 dom_soa_archetype_storage::~dom_soa_archetype_storage()
@@ -106,17 +596,28 @@ dom_soa_archetype_storage::~dom_soa_archetype_storage()
     if (archetypes_) {
         for (i = 0u; i < archetype_count_; ++i) {
             dom_soa_archetype* arch = &archetypes_[i];
-            u32 c;
-            for (c = 0u; c < arch->column_count; ++c) {
-                delete[] arch->columns[c].data;
-            }
+            delete[] arch->chunks;
             delete[] arch->columns;
+            delete[] arch->column_buckets;
             delete[] arch->component_set;
             delete[] arch->entities;
+            delete[] arch->row_locations;
             delete[] arch->access_rules;
         }
         delete[] archetypes_;
     }
+    for (i = 0u; i < chunk_pool_.slab_count; ++i) {
+        delete[] chunk_pool_.slabs[i];
+    }
+    delete[] chunk_pool_.slabs;
+    delete[] archetype_buckets_;
+    delete[] locations_;
+    delete[] location_buckets_;
+    delete[] edges_;
+    delete[] edge_buckets_;
+    delete[] commit_items_;
+    delete[] commit_scratch_;
+    delete[] op_columns_;
     delete[] sort_indices_;
 }
 
@@ -133,6 +634,19 @@ int dom_soa_archetype_storage::add_archetype(const dom_soa_component_def* compon
         return -1;
     }
 
+    {
+        /* Every archetype must fit at least one row per chunk. */
+        u64 row_bytes = 0u;
+        for (i = 0u; i < component_count; ++i) {
+            u32 f;
+            for (f = 0u; f < components[i].field_count; ++f) {
+                row_bytes = dom_soa_align_up(row_bytes) + components[i].fields[f].element_size;
+            }
+        }
+        if (row_bytes > DOM_SOA_CHUNK_BYTES) {
+            return -3;
+        }
+    }
     sorted_components = new dom_soa_component_def[component_count];
     for (i = 0u; i < component_count; ++i) {
         sorted_components[i] = components[i];
@@ -147,6 +661,19 @@ int dom_soa_archetype_storage::add_archetype(const dom_soa_component_def* compon
         }
         sorted_components[j] = key;
     }
+    {
+        dom_component_id* ids = new dom_component_id[component_count];
+        dom_archetype_id id;
+        for (i = 0u; i < component_count; ++i) {
+            ids[i] = sorted_components[i].component_id;
+        }
+        id = dom_soa_archetype_id_from_components(ids, component_count);
+        delete[] ids;
+        if (find_archetype(id)) {
+            delete[] sorted_components;
+            return -2;
+        }
+    }
 
     if (!archetypes_) {
         archetype_capacity_ = 4u;
@@ -203,11 +730,28 @@ int dom_soa_archetype_storage::add_archetype(const dom_soa_component_def* compon
                 col->stride = sorted_fields[f].element_size;
                 col->capacity = 0u;
                 col->size = 0u;
-                col->data = 0;
+                col->chunk_offset = 0u;
             }
             delete[] sorted_fields;
         }
     }
+    arch->chunk_shift = dom_soa_chunk_layout(columns, total_fields);
+    {
+        const u32 bucket_count = dom_soa_bucket_count(total_fields);
+        arch->column_buckets = new u32[bucket_count];
+        arch->column_bucket_mask = bucket_count - 1u;
+        for (i = 0u; i < bucket_count; ++i) {
+            arch->column_buckets[i] = DOM_SOA_INDEX_NONE;
+        }
+        for (i = 0u; i < total_fields; ++i) {
+            u32* head = &arch->column_buckets[dom_soa_column_bucket(columns[i].component_id,
+                                                                    columns[i].field_id) &
+                                              arch->column_bucket_mask];
+            columns[i].hash_next = *head;
+            *head = i;
+        }
+    }
+    link_archetypes();
 
     delete[] sorted_components;
     return reserve_entities(arch->archetype_id, initial_capacity);
@@ -224,20 +768,22 @@ int dom_soa_archetype_storage::reserve_entities(dom_archetype_id archetype, u32
 
 int dom_soa_archetype_storage::insert_entity(dom_archetype_id archetype, dom_entity_id entity)
 {
-    u32 i;
     dom_soa_archetype* arch = find_archetype(archetype);
     if (!arch) {
         return -1;
     }
-    for (i = 0u; i < arch->entity_count; ++i) {
-        if (arch->entities[i] == entity) {
-            return -2;
-        }
+    /* An entity lives in at most one archetype. */
+    if (entity == DOM_SOA_ENTITY_TOMBSTONE || location_find(entity) != DOM_SOA_INDEX_NONE) {
+        return -2;
     }
     if (ensure_capacity(arch, arch->entity_count + 1u) != 0) {
         return -3;
     }
+    if (location_insert(entity, (u32)(arch - archetypes_), arch->entity_count) != 0) {
+        return -3;
+    }
     arch->entities[arch->entity_count] = entity;
+    arch->row_locations[arch->entity_count] = location_count_ - 1u;
     zero_new_rows(arch, arch->entity_count, arch->entity_count + 1u);
     arch->entity_count += 1u;
     return 0;
@@ -245,37 +791,267 @@ int dom_soa_archetype_storage::insert_entity(dom_archetype_id archetype, dom_ent
 
 int dom_soa_archetype_storage::remove_entity(dom_archetype_id archetype, dom_entity_id entity)
 {
-    u32 i;
+    u32 loc;
+    u32 row;
     dom_soa_archetype* arch = find_archetype(archetype);
     if (!arch) {
         return -1;
     }
-    for (i = 0u; i < arch->entity_count; ++i) {
-        if (arch->entities[i] == entity) {
-            u32 remaining = arch->entity_count - i - 1u;
-            if (remaining > 0u) {
-                memmove(&arch->entities[i], &arch->entities[i + 1u],
-                        sizeof(dom_entity_id) * remaining);
-            }
-            if (arch->entity_count > 0u) {
-                u32 c;
-                for (c = 0u; c < arch->column_count; ++c) {
-                    dom_soa_column* col = &arch->columns[c];
-                    size_t row_bytes = (size_t)col->stride;
-                    unsigned char* base = col->data;
-                    if (remaining > 0u) {
-                        memmove(base + (size_t)i * row_bytes,
-                                base + (size_t)(i + 1u) * row_bytes,
-                                row_bytes * remaining);
+    loc = location_find(entity);
+    if (loc == DOM_SOA_INDEX_NONE || locations_[loc].archetype_index != (u32)(arch - archetypes_)) {
+        return -2;
+    }
+    row = locations_[loc].row;
+    location_erase(loc);
+    if (remove_mode_ == DOM_SOA_REMOVE_SWAP) {
+        remove_row_swap(arch, row);
+        return 0;
+    }
+    arch->entities[row] = DOM_SOA_ENTITY_TOMBSTONE;
+    arch->tombstone_count += 1u;
+    if (!in_phase_) {
+        compact_rows(arch, row);
+    }
+    return 0;
+}
+
+void dom_soa_archetype_storage::set_remove_mode(u32 mode)
+{
+    if (mode == DOM_SOA_REMOVE_STABLE || mode == DOM_SOA_REMOVE_SWAP) {
+        remove_mode_ = mode;
+    }
+}
+
+u32 dom_soa_archetype_storage::remove_mode() const
+{
+    return remove_mode_;
+}
+
+void dom_soa_archetype_storage::begin_phase()
+{
+    in_phase_ = D_TRUE;
+}
+
+void dom_soa_archetype_storage::end_phase()
+{
+    u32 i;
+    in_phase_ = D_FALSE;
+    for (i = 0u; i < archetype_count_; ++i) {
+        if (archetypes_[i].tombstone_count > 0u) {
+            compact_rows(&archetypes_[i], 0u);
+        }
+    }
+}
+
+int dom_soa_archetype_storage::locate(dom_entity_id entity,
+                                      dom_archetype_id* out_archetype,
+                                      u32* out_row) const
+{
+    const u32 loc = location_find(entity);
+    if (loc == DOM_SOA_INDEX_NONE) {
+        return -1;
+    }
+    if (out_archetype) {
+        *out_archetype = archetypes_[locations_[loc].archetype_index].archetype_id;
+    }
+    if (out_row) {
+        *out_row = locations_[loc].row;
+    }
+    return 0;
+}
+
+int dom_soa_archetype_storage::prepare_transition(dom_archetype_id from,
+                                                  u32 kind,
+                                                  dom_component_id component_id,
+                                                  dom_archetype_id* out_to)
+{
+    const dom_soa_archetype* arch = find_archetype(from);
+    u32 to;
+    if (!arch || (kind != DOM_SOA_STRUCT_ADD_COMPONENT && kind != DOM_SOA_STRUCT_REMOVE_COMPONENT)) {
+        return -1;
+    }
+    to = transition((u32)(arch - archetypes_), kind, component_id);
+    if (to == DOM_SOA_INDEX_NONE) {
+        return -2;
+    }
+    if (out_to) {
+        *out_to = archetypes_[to].archetype_id;
+    }
+    return 0;
+}
+
+void dom_soa_archetype_storage::apply_structural(const dom_soa_struct_buffer& changes,
+                                                 dom_ecs_commit_context& ctx)
+{
+    u32* order;
+    u32* scratch;
+    u32* record_of_location;
+    dom_soa_migration* records;
+    u32 record_count = 0u;
+    u32 moved_count = 0u;
+    u32* first_row;
+    u32 i;
+
+    if (!changes.ops || changes.count == 0u) {
+        ctx.status = 0;
+        return;
+    }
+    order = new u32[changes.count];
+    scratch = new u32[changes.count];
+    records = new dom_soa_migration[changes.count];
+    record_of_location = new u32[location_count_ ? location_count_ : 1u];
+    for (i = 0u; i < changes.count; ++i) {
+        order[i] = i;
+    }
+    for (i = 0u; i < location_count_; ++i) {
+        record_of_location[i] = DOM_SOA_INDEX_NONE;
+    }
+    dom_soa_merge_sort(order, scratch, changes.count, dom_soa_struct_op_less, changes.ops);
+
+    /* Fold each entity's ops into a single source -> destination edge walk;
+     * nothing is moved until every op has resolved. */
+    for (i = 0u; i < changes.count; ++i) {
+        const dom_soa_struct_op& op = changes.ops[order[i]];
+        const u32 loc = location_find(op.entity);
+        dom_soa_migration* rec;
+        if (loc == DOM_SOA_INDEX_NONE) {
+            break;
+        }
+        if (record_of_location[loc] == DOM_SOA_INDEX_NONE) {
+            rec = &records[record_count];
+            rec->entity = op.entity;
+            rec->location = loc;
+            rec->src_index = locations_[loc].archetype_index;
+            rec->src_row = locations_[loc].row;
+            rec->dst_index = rec->src_index;
+            record_of_location[loc] = record_count++;
+        }
+        rec = &records[record_of_location[loc]];
+        if (op.kind == DOM_SOA_STRUCT_MOVE) {
+            const dom_soa_archetype* target = find_archetype(op.target);
+            rec->dst_index = target ? (u32)(target - archetypes_) : DOM_SOA_INDEX_NONE;
+        } else if (op.kind == DOM_SOA_STRUCT_ADD_COMPONENT ||
+                   op.kind == DOM_SOA_STRUCT_REMOVE_COMPONENT) {
+            rec->dst_index = transition(rec->dst_index, op.kind, op.component_id);
+        } else {
+            rec->dst_index = DOM_SOA_INDEX_NONE;
+        }
+        if (rec->dst_index == DOM_SOA_INDEX_NONE) {
+            break;
+        }
+    }
+    delete[] record_of_location;
+    if (i != changes.count) {
+        delete[] order;
+        delete[] scratch;
+        delete[] records;
+        ctx.status = -1;
+        return;
+    }
+
+    for (i = 0u; i < record_count; ++i) {
+        if (records[i].dst_index != records[i].src_index) {
+            order[moved_count++] = i;
+        }
+    }
+    dom_soa_merge_sort(order, scratch, moved_count, dom_soa_migration_dst_less, records);
+
+    /* Grow every destination before touching rows so a batch never stops halfway. */
+    i = 0u;
+    while (i < moved_count) {
+        dom_soa_archetype* dst = &archetypes_[records[order[i]].dst_index];
+        u32 end = i;
+        while (end < moved_count && records[order[end]].dst_index == records[order[i]].dst_index) {
+            ++end;
+        }
+        if (ensure_capacity(dst, dst->entity_count + (end - i)) != 0) {
+            delete[] order;
+            delete[] scratch;
+            delete[] records;
+            ctx.status = -1;
+            return;
+        }
+        i = end;
+    }
+
+    first_row = new u32[archetype_count_];
+    for (i = 0u; i < archetype_count_; ++i) {
+        first_row[i] = DOM_SOA_INDEX_NONE;
+    }
+    i = 0u;
+    while (i < moved_count) {
+        const u32 dst_index = records[order[i]].dst_index;
+        dom_soa_archetype* dst = &archetypes_[dst_index];
+        const u32 base = dst->entity_count;
+        u32 end = i;
+        u32 c;
+        u32 k;
+        while (end < moved_count && records[order[end]].dst_index == dst_index) {
+            ++end;
+        }
+        /* Column-major copy; each source run resolves its column once. */
+        for (c = 0u; c < dst->column_count; ++c) {
+            dom_soa_column* dcol = &dst->columns[c];
+            k = i;
+            while (k < end) {
+                const u32 src_index = records[order[k]].src_index;
+                const dom_soa_column* scol = find_column(&archetypes_[src_index],
+                                                         dcol->component_id,
+                                                         dcol->field_id);
+                if (scol && scol->element_size != dcol->element_size) {
+                    scol = 0;
+                }
+                for (; k < end && records[order[k]].src_index == src_index; ++k) {
+                    unsigned char* out = dom_soa_cell(dst, dcol, base + (k - i));
+                    if (scol) {
+                        memcpy(out, dom_soa_cell(&archetypes_[src_index], scol, records[order[k]].src_row),
+                               dcol->element_size);
+                    } else {
+                        memset(out, 0, dcol->element_size);
                     }
-                    col->size = arch->entity_count - 1u;
                 }
             }
-            arch->entity_count -= 1u;
-            return 0;
+            dcol->size = base + (end - i);
+        }
+        for (k = i; k < end; ++k) {
+            const dom_soa_migration* rec = &records[order[k]];
+            dom_soa_archetype* src = &archetypes_[rec->src_index];
+            const u32 row = base + (k - i);
+            dst->entities[row] = rec->entity;
+            dst->row_locations[row] = rec->location;
+            locations_[rec->location].archetype_index = dst_index;
+            locations_[rec->location].row = row;
+            src->entities[rec->src_row] = DOM_SOA_ENTITY_TOMBSTONE;
+            src->row_locations[rec->src_row] = DOM_SOA_INDEX_NONE;
+            src->tombstone_count += 1u;
+            if (rec->src_row < first_row[rec->src_index]) {
+                first_row[rec->src_index] = rec->src_row;
+            }
+        }
+        dst->entity_count = base + (end - i);
+        i = end;
+    }
+
+    /* Vacated source rows follow the same rules as remove_entity. */
+    if (remove_mode_ == DOM_SOA_REMOVE_SWAP) {
+        dom_soa_merge_sort(order, scratch, moved_count, dom_soa_migration_hole_less, records);
+        for (i = 0u; i < moved_count; ++i) {
+            dom_soa_archetype* src = &archetypes_[records[order[i]].src_index];
+            remove_row_swap(src, records[order[i]].src_row);
+            src->tombstone_count -= 1u;
+        }
+    } else if (!in_phase_) {
+        for (i = 0u; i < archetype_count_; ++i) {
+            if (first_row[i] != DOM_SOA_INDEX_NONE) {
+                compact_rows(&archetypes_[i], first_row[i]);
+            }
         }
     }
-    return -2;
+    delete[] first_row;
+    delete[] order;
+    delete[] scratch;
+    delete[] records;
+    ctx.status = 0;
 }
 
 int dom_soa_archetype_storage::set_access_rule(dom_archetype_id archetype,
@@ -324,23 +1100,17 @@ u64 dom_soa_archetype_storage::read_u64(dom_archetype_id archetype,
     if (!col || index >= arch->entity_count || col->element_size != sizeof(u64)) {
         return 0u;
     }
-    memcpy(&value, col->data + (size_t)index * col->stride, sizeof(u64));
+    memcpy(&value, dom_soa_cell(arch, col, index), sizeof(u64));
     return value;
 }
 
 dom_archetype_id dom_soa_archetype_storage::get_archetype(dom_entity_id entity) const
 {
-    u32 i;
-    for (i = 0u; i < archetype_count_; ++i) {
-        u32 j;
-        const dom_soa_archetype* arch = &archetypes_[i];
-        for (j = 0u; j < arch->entity_count; ++j) {
-            if (arch->entities[j] == entity) {
-                return arch->archetype_id;
-            }
-        }
+    const u32 loc = location_find(entity);
+    if (loc == DOM_SOA_INDEX_NONE) {
+        return dom_archetype_id_make(0u);
     }
-    return dom_archetype_id_make(0u);
+    return archetypes_[locations_[loc].archetype_index].archetype_id;
 }
 
 dom_entity_range dom_soa_archetype_storage::query_archetype(dom_archetype_id archetype) const
@@ -385,66 +1155,236 @@ dom_component_view dom_soa_archetype_storage::get_view(dom_archetype_id archetyp
     return view;
 }
 
+u32 dom_soa_archetype_storage::chunk_rows(dom_archetype_id archetype) const
+{
+    const dom_soa_archetype* arch = find_archetype(archetype);
+    return arch ? (1u << arch->chunk_shift) : 0u;
+}
+
+u32 dom_soa_archetype_storage::chunk_count(dom_archetype_id archetype) const
+{
+    const dom_soa_archetype* arch = find_archetype(archetype);
+    if (!arch || arch->column_count == 0u) {
+        return 0u;
+    }
+    return (u32)(((u64)arch->entity_count + (1u << arch->chunk_shift) - 1u) >> arch->chunk_shift);
+}
+
+dom_component_view dom_soa_archetype_storage::get_chunk_view(dom_archetype_id archetype,
+                                                             dom_component_id component,
+                                                             dom_field_id field,
+                                                             u32 chunk_index)
+{
+    dom_component_view view = get_view(archetype, component, field);
+    const dom_soa_archetype* arch;
+    const dom_soa_column* col;
+    u32 begin;
+    if (!dom_component_view_is_valid(&view) || chunk_index >= chunk_count(archetype)) {
+        return dom_component_view_invalid();
+    }
+    arch = find_archetype(archetype);
+    col = find_column(arch, component, field);
+    begin = chunk_index << arch->chunk_shift;
+    view.count = arch->entity_count - begin;
+    if (view.count > (1u << arch->chunk_shift)) {
+        view.count = 1u << arch->chunk_shift;
+    }
+    view.backend_token = (u64)(size_t)(arch->chunks[chunk_index] + col->chunk_offset);
+    return view;
+}
+
+void dom_soa_archetype_storage::chunk_pool_stats(u32* out_chunks, u32* out_free) const
+{
+    if (out_chunks) {
+        *out_chunks = chunk_pool_.chunk_total;
+    }
+    if (out_free) {
+        *out_free = chunk_pool_.free_count;
+    }
+}
+
+void dom_soa_archetype_storage::set_thread_pool(dom_thread_pool* pool)
+{
+    pool_ = pool;
+}
+
+dom_thread_pool* dom_soa_archetype_storage::thread_pool() const
+{
+    return pool_;
+}
+
+/* Commit pipeline: validate and resolve each op's column once, radix sort by
+ * commit key, bucket by (archetype, column) keeping commit order, then apply
+ * the groups, in parallel when a pool is bound. Per-column op order matches
+ * a serial commit-key-ordered apply, so the final state does too. */
 void dom_soa_archetype_storage::apply_writes(const dom_ecs_write_buffer& writes,
                                              dom_ecs_commit_context& ctx)
 {
+    u32* column_base;
+    u32* group_start;
+    dom_soa_archetype** group_archetypes;
+    dom_soa_column** group_columns;
+    dom_soa_commit_job* jobs;
+    u32 column_total = 0u;
+    u32 group_count = 0u;
+    u32 job_count = 1u;
     u32 i;
+
     if (!writes.ops || writes.count == 0u) {
         ctx.status = 0;
         return;
     }
-    if (writes.count > sort_capacity_) {
-        delete[] sort_indices_;
-        sort_capacity_ = writes.count;
-        sort_indices_ = new u32[sort_capacity_];
+    if (reserve_commit(writes.count) != 0) {
+        ctx.status = -1;
+        return;
+    }
+    column_base = new u32[archetype_count_ + 1u];
+    for (i = 0u; i < archetype_count_; ++i) {
+        column_base[i] = column_total;
+        column_total += archetypes_[i].column_count;
     }
+    column_base[archetype_count_] = column_total;
     for (i = 0u; i < writes.count; ++i) {
-        if (!validate_write(writes.ops[i])) {
+        const dom_ecs_write_op& op = writes.ops[i];
+        u32 arch_index;
+        u32 column_index;
+        if (!validate_write(op, &arch_index, &column_index)) {
+            delete[] column_base;
             ctx.status = -1;
             return;
         }
-        sort_indices_[i] = i;
+        op_columns_[i] = column_base[arch_index] + column_index;
+        commit_items_[i].hi = ((u64)op.commit_key.phase_id << 32) | (op.commit_key.task_id >> 32);
+        commit_items_[i].lo = (op.commit_key.task_id << 32) | (u64)op.commit_key.sub_index;
+        commit_items_[i].index = i;
     }
-    for (i = 1u; i < writes.count; ++i) {
-        u32 key = sort_indices_[i];
-        u32 j = i;
-        while (j > 0u &&
-               dom_commit_key_compare(&writes.ops[sort_indices_[j - 1u]].commit_key,
-                                      &writes.ops[key].commit_key) > 0) {
-            sort_indices_[j] = sort_indices_[j - 1u];
-            --j;
-        }
-        sort_indices_[j] = key;
+    dom_soa_radix_sort_commit(commit_items_, commit_scratch_, writes.count);
+
+    /* Counting sort by column is stable, so groups keep commit order. */
+    group_start = new u32[column_total + 1u];
+    for (i = 0u; i <= column_total; ++i) {
+        group_start[i] = 0u;
     }
     for (i = 0u; i < writes.count; ++i) {
-        const dom_ecs_write_op& op = writes.ops[sort_indices_[i]];
-        if (op.reduction_op != DOM_REDUCE_NONE) {
-            apply_reduce(op);
-        } else {
-            apply_write(op);
+        group_start[op_columns_[i] + 1u] += 1u;
+    }
+    for (i = 1u; i <= column_total; ++i) {
+        group_start[i] += group_start[i - 1u];
+    }
+    for (i = 0u; i < writes.count; ++i) {
+        const u32 index = commit_items_[i].index;
+        sort_indices_[group_start[op_columns_[index]]++] = index;
+    }
+    /* group_start[c] now holds the end of column c; drop empty columns. */
+    group_archetypes = new dom_soa_archetype*[column_total ? column_total : 1u];
+    group_columns = new dom_soa_column*[column_total ? column_total : 1u];
+    {
+        u32 begin = 0u;
+        u32 a;
+        for (a = 0u; a < archetype_count_; ++a) {
+            u32 c;
+            for (c = 0u; c < archetypes_[a].column_count; ++c) {
+                const u32 end = group_start[column_base[a] + c];
+                if (end > begin) {
+                    group_archetypes[group_count] = &archetypes_[a];
+                    group_columns[group_count] = &archetypes_[a].columns[c];
+                    group_start[group_count++] = begin;
+                }
+                begin = end;
+            }
+        }
+        group_start[group_count] = writes.count;
+    }
+    delete[] column_base;
+
+    /* On one of the pool's own workers the wait below would count this
+     * task and never return, so apply serially there. */
+    if (pool_ && pool_->worker_count > 0u && group_count > 1u &&
+        writes.count >= DOM_SOA_PARALLEL_MIN_OPS &&
+        dom_thread_pool_on_worker(pool_) == D_FALSE) {
+        job_count = pool_->worker_count * 4u;
+        if (job_count > group_count) {
+            job_count = group_count;
+        }
+    }
+    jobs = new dom_soa_commit_job[job_count];
+    {
+        /* Contiguous group ranges holding roughly equal op counts. */
+        u32 g = 0u;
+        u32 j;
+        for (j = 0u; j < job_count; ++j) {
+            const u64 target = ((u64)writes.count * (u64)(j + 1u)) / (u64)job_count;
+            jobs[j].ops = writes.ops;
+            jobs[j].order = sort_indices_;
+            jobs[j].group_start = group_start;
+            jobs[j].group_archetypes = group_archetypes;
+            jobs[j].group_columns = group_columns;
+            jobs[j].group_begin = g;
+            while (g < group_count && (g == jobs[j].group_begin || (u64)group_start[g + 1u] <= target)) {
+                g += 1u;
+            }
+            if (j + 1u == job_count) {
+                g = group_count;
+            }
+            jobs[j].group_end = g;
         }
     }
+    if (job_count == 1u) {
+        dom_soa_commit_job_run(&jobs[0]);
+    } else {
+        for (i = 0u; i < job_count; ++i) {
+            dom_thread_pool_task task;
+            task.task_id = (u64)i;
+            task.fn = dom_soa_commit_job_run;
+            task.user_data = &jobs[i];
+            if (dom_thread_pool_submit(pool_, &task) == D_FALSE) {
+                dom_soa_commit_job_run(&jobs[i]);
+            }
+        }
+        dom_thread_pool_wait(pool_);
+    }
+    delete[] jobs;
+    delete[] group_archetypes;
+    delete[] group_columns;
+    delete[] group_start;
     ctx.status = 0;
 }
 
-dom_soa_archetype* dom_soa_archetype_storage::find_archetype(dom_archetype_id archetype)
+int dom_soa_archetype_storage::reserve_commit(u32 count)
 {
-    u32 i;
-    for (i = 0u; i < archetype_count_; ++i) {
-        if (dom_archetype_id_equal(archetypes_[i].archetype_id, archetype)) {
-            return &archetypes_[i];
-        }
+    if (count <= sort_capacity_) {
+        return 0;
     }
+    delete[] commit_items_;
+    delete[] commit_scratch_;
+    delete[] op_columns_;
+    delete[] sort_indices_;
+    sort_capacity_ = count;
+    commit_items_ = new dom_soa_commit_item[count];
+    commit_scratch_ = new dom_soa_commit_item[count];
+    op_columns_ = new u32[count];
+    sort_indices_ = new u32[count];
     return 0;
 }
 
+dom_soa_archetype* dom_soa_archetype_storage::find_archetype(dom_archetype_id archetype)
+{
+    const dom_soa_archetype_storage* self = this;
+    return const_cast<dom_soa_archetype*>(self->find_archetype(archetype));
+}
+
 const dom_soa_archetype* dom_soa_archetype_storage::find_archetype(dom_archetype_id archetype) const
 {
     u32 i;
-    for (i = 0u; i < archetype_count_; ++i) {
+    if (!archetype_buckets_) {
+        return 0;
+    }
+    i = archetype_buckets_[dom_soa_bucket_u64(archetype.value) & archetype_bucket_mask_];
+    while (i != DOM_SOA_INDEX_NONE) {
         if (dom_archetype_id_equal(archetypes_[i].archetype_id, archetype)) {
             return &archetypes_[i];
         }
+        i = archetypes_[i].hash_next;
     }
     return 0;
 }
@@ -453,17 +1393,8 @@ dom_soa_column* dom_soa_archetype_storage::find_column(dom_soa_archetype* arch,
                                                        dom_component_id component_id,
                                                        dom_field_id field_id)
 {
-    u32 i;
-    if (!arch) {
-        return 0;
-    }
-    for (i = 0u; i < arch->column_count; ++i) {
-        if (arch->columns[i].component_id == component_id &&
-            arch->columns[i].field_id == field_id) {
-            return &arch->columns[i];
-        }
-    }
-    return 0;
+    const dom_soa_archetype_storage* self = this;
+    return const_cast<dom_soa_column*>(self->find_column(arch, component_id, field_id));
 }
 
 const dom_soa_column* dom_soa_archetype_storage::find_column(const dom_soa_archetype* arch,
@@ -471,14 +1402,16 @@ const dom_soa_column* dom_soa_archetype_storage::find_column(const dom_soa_arche
                                                              dom_field_id field_id) const
 {
     u32 i;
-    if (!arch) {
+    if (!arch || !arch->column_buckets) {
         return 0;
     }
-    for (i = 0u; i < arch->column_count; ++i) {
+    i = arch->column_buckets[dom_soa_column_bucket(component_id, field_id) & arch->column_bucket_mask];
+    while (i != DOM_SOA_INDEX_NONE) {
         if (arch->columns[i].component_id == component_id &&
             arch->columns[i].field_id == field_id) {
             return &arch->columns[i];
         }
+        i = arch->columns[i].hash_next;
     }
     return 0;
 }
@@ -519,14 +1452,12 @@ const dom_soa_access_rule* dom_soa_archetype_storage::find_access_rule(const dom
 
 int dom_soa_archetype_storage::ensure_capacity(dom_soa_archetype* arch, u32 capacity)
 {
+    u32 needed;
     u32 i;
     if (!arch) {
         return -1;
     }
-    if (capacity <= arch->entity_capacity) {
-        return 0;
-    }
-    {
+    if (capacity > arch->entity_capacity) {
         u32 new_capacity = arch->entity_capacity ? arch->entity_capacity : 1u;
         while (new_capacity < capacity) {
             new_capacity *= 2u;
@@ -537,17 +1468,40 @@ int dom_soa_archetype_storage::ensure_capacity(dom_soa_archetype* arch, u32 capa
         }
         delete[] arch->entities;
         arch->entities = next_entities;
-        arch->entity_capacity = new_capacity;
-        for (i = 0u; i < arch->column_count; ++i) {
-            dom_soa_column* col = &arch->columns[i];
-            unsigned char* next = new unsigned char[(size_t)new_capacity * col->stride];
-            if (col->data && col->size > 0u) {
-                memcpy(next, col->data, (size_t)col->size * col->stride);
+        {
+            u32* next_rows = new u32[new_capacity];
+            if (arch->row_locations && arch->entity_count > 0u) {
+                memcpy(next_rows, arch->row_locations, sizeof(u32) * arch->entity_count);
             }
-            delete[] col->data;
-            col->data = next;
-            col->capacity = new_capacity;
+            delete[] arch->row_locations;
+            arch->row_locations = next_rows;
         }
+        arch->entity_capacity = new_capacity;
+    }
+    /* Column rows never move on growth: only the chunk table is copied. */
+    needed = (u32)(((u64)capacity + (1u << arch->chunk_shift) - 1u) >> arch->chunk_shift);
+    if (arch->column_count == 0u || needed <= arch->chunk_count) {
+        return 0;
+    }
+    if (needed > arch->chunk_capacity) {
+        u32 new_capacity = arch->chunk_capacity ? arch->chunk_capacity : 1u;
+        unsigned char** next;
+        while (new_capacity < needed) {
+            new_capacity *= 2u;
+        }
+        next = new unsigned char*[new_capacity];
+        if (arch->chunks && arch->chunk_count > 0u) {
+            memcpy(next, arch->chunks, sizeof(unsigned char*) * arch->chunk_count);
+        }
+        delete[] arch->chunks;
+        arch->chunks = next;
+        arch->chunk_capacity = new_capacity;
+    }
+    while (arch->chunk_count < needed) {
+        arch->chunks[arch->chunk_count++] = dom_soa_chunk_alloc(&chunk_pool_);
+    }
+    for (i = 0u; i < arch->column_count; ++i) {
+        arch->columns[i].capacity = arch->chunk_count << arch->chunk_shift;
     }
     return 0;
 }
@@ -560,19 +1514,387 @@ void dom_soa_archetype_storage::zero_new_rows(dom_soa_archetype* arch, u32 from_
     }
     for (i = 0u; i < arch->column_count; ++i) {
         dom_soa_column* col = &arch->columns[i];
-        if (!col->data || col->stride == 0u) {
+        u32 row = from_index;
+        while (row < to_index) {
+            const u32 run = dom_soa_chunk_run(arch, row, to_index - row);
+            memset(dom_soa_cell(arch, col, row), 0, (size_t)run * col->element_size);
+            row += run;
+        }
+        col->size = arch->entity_count + (to_index - from_index);
+    }
+}
+
+void dom_soa_archetype_storage::link_archetypes()
+{
+    const u32 bucket_count = dom_soa_bucket_count(archetype_count_);
+    u32 i;
+    if (archetype_bucket_mask_ + 1u != bucket_count || !archetype_buckets_) {
+        delete[] archetype_buckets_;
+        archetype_buckets_ = new u32[bucket_count];
+        archetype_bucket_mask_ = bucket_count - 1u;
+    }
+    for (i = 0u; i < bucket_count; ++i) {
+        archetype_buckets_[i] = DOM_SOA_INDEX_NONE;
+    }
+    for (i = 0u; i < archetype_count_; ++i) {
+        u32* head = &archetype_buckets_[dom_soa_bucket_u64(archetypes_[i].archetype_id.value) &
+                                        archetype_bucket_mask_];
+        archetypes_[i].hash_next = *head;
+        *head = i;
+    }
+}
+
+u32 dom_soa_archetype_storage::location_find(dom_entity_id entity) const
+{
+    u32 i;
+    if (!location_buckets_) {
+        return DOM_SOA_INDEX_NONE;
+    }
+    i = location_buckets_[dom_soa_bucket_u64(entity) & location_bucket_mask_];
+    while (i != DOM_SOA_INDEX_NONE) {
+        if (locations_[i].entity == entity) {
+            return i;
+        }
+        i = locations_[i].hash_next;
+    }
+    return DOM_SOA_INDEX_NONE;
+}
+
+int dom_soa_archetype_storage::location_insert(dom_entity_id entity, u32 archetype_index, u32 row)
+{
+    dom_soa_entity_location* loc;
+    u32* head;
+    if (location_count_ >= location_capacity_) {
+        /* Buckets track capacity, so a rehash happens only on growth. */
+        const u32 new_capacity = dom_soa_bucket_count(location_capacity_ ? location_capacity_ * 2u : 64u);
+        dom_soa_entity_location* next = new dom_soa_entity_location[new_capacity];
+        u32 i;
+        if (locations_ && location_count_ > 0u) {
+            memcpy(next, locations_, sizeof(dom_soa_entity_location) * location_count_);
+        }
+        delete[] locations_;
+        delete[] location_buckets_;
+        locations_ = next;
+        location_capacity_ = new_capacity;
+        location_buckets_ = new u32[new_capacity];
+        location_bucket_mask_ = new_capacity - 1u;
+        for (i = 0u; i < new_capacity; ++i) {
+            location_buckets_[i] = DOM_SOA_INDEX_NONE;
+        }
+        for (i = 0u; i < location_count_; ++i) {
+            head = &location_buckets_[dom_soa_bucket_u64(locations_[i].entity) & location_bucket_mask_];
+            locations_[i].hash_next = *head;
+            *head = i;
+        }
+    }
+    loc = &locations_[location_count_];
+    loc->entity = entity;
+    loc->archetype_index = archetype_index;
+    loc->row = row;
+    head = &location_buckets_[dom_soa_bucket_u64(entity) & location_bucket_mask_];
+    loc->hash_next = *head;
+    *head = location_count_;
+    location_count_ += 1u;
+    return 0;
+}
+
+void dom_soa_archetype_storage::location_erase(u32 index)
+{
+    const u32 last = location_count_ - 1u;
+    u32* link = &location_buckets_[dom_soa_bucket_u64(locations_[index].entity) & location_bucket_mask_];
+    while (*link != index) {
+        link = &locations_[*link].hash_next;
+    }
+    *link = locations_[index].hash_next;
+    archetypes_[locations_[index].archetype_index].row_locations[locations_[index].row] = DOM_SOA_INDEX_NONE;
+    if (index != last) {
+        /* Keep the table dense: the last entry takes the hole. */
+        link = &location_buckets_[dom_soa_bucket_u64(locations_[last].entity) & location_bucket_mask_];
+        while (*link != last) {
+            link = &locations_[*link].hash_next;
+        }
+        *link = index;
+        locations_[index] = locations_[last];
+        archetypes_[locations_[index].archetype_index].row_locations[locations_[index].row] = index;
+    }
+    location_count_ = last;
+}
+
+void dom_soa_archetype_storage::move_row_location(dom_soa_archetype* arch, u32 from_row, u32 to_row)
+{
+    const u32 loc = arch->row_locations[from_row];
+    arch->row_locations[to_row] = loc;
+    if (loc != DOM_SOA_INDEX_NONE) {
+        locations_[loc].row = to_row;
+    }
+}
+
+void dom_soa_archetype_storage::remove_row_swap(dom_soa_archetype* arch, u32 row)
+{
+    const u32 last = arch->entity_count - 1u;
+    u32 c;
+    if (row != last) {
+        arch->entities[row] = arch->entities[last];
+        move_row_location(arch, last, row);
+        for (c = 0u; c < arch->column_count; ++c) {
+            const dom_soa_column* col = &arch->columns[c];
+            memcpy(dom_soa_cell(arch, col, row), dom_soa_cell(arch, col, last), col->element_size);
+        }
+    }
+    arch->entity_count = last;
+    for (c = 0u; c < arch->column_count; ++c) {
+        arch->columns[c].size = last;
+    }
+    trim_chunks(arch);
+}
+
+/* Drops tombstoned rows at or after from_row, moving each run of live rows
+ * down in one memmove per column so relative order is kept. */
+void dom_soa_archetype_storage::compact_rows(dom_soa_archetype* arch, u32 from_row)
+{
+    u32 read = from_row;
+    u32 write = from_row;
+    u32 c;
+    if (arch->tombstone_count == 0u) {
+        return;
+    }
+    while (read < arch->entity_count) {
+        u32 run_start;
+        u32 run;
+        u32 r;
+        while (read < arch->entity_count && arch->entities[read] == DOM_SOA_ENTITY_TOMBSTONE) {
+            ++read;
+        }
+        run_start = read;
+        while (read < arch->entity_count && arch->entities[read] != DOM_SOA_ENTITY_TOMBSTONE) {
+            ++read;
+        }
+        run = read - run_start;
+        if (run > 0u && run_start != write) {
+            memmove(&arch->entities[write], &arch->entities[run_start], sizeof(dom_entity_id) * run);
+            dom_soa_move_rows_down(arch, write, run_start, run);
+            for (r = 0u; r < run; ++r) {
+                move_row_location(arch, run_start + r, write + r);
+            }
+        }
+        write += run;
+    }
+    arch->entity_count = write;
+    arch->tombstone_count = 0u;
+    for (c = 0u; c < arch->column_count; ++c) {
+        arch->columns[c].size = write;
+    }
+    trim_chunks(arch);
+}
+
+/* Keeps at most one empty chunk past the last row so churn around a chunk
+ * boundary does not bounce chunks through the pool. */
+void dom_soa_archetype_storage::trim_chunks(dom_soa_archetype* arch)
+{
+    const u32 used = (u32)(((u64)arch->entity_count + (1u << arch->chunk_shift) - 1u) >> arch->chunk_shift);
+    u32 c;
+    if (arch->chunk_count <= used + 1u) {
+        return;
+    }
+    while (arch->chunk_count > used + 1u) {
+        arch->chunk_count -= 1u;
+        dom_soa_chunk_release(&chunk_pool_, arch->chunks[arch->chunk_count]);
+    }
+    for (c = 0u; c < arch->column_count; ++c) {
+        arch->columns[c].capacity = arch->chunk_count << arch->chunk_shift;
+    }
+}
+
+/* Cold path: any archetype carrying the component donates its field layout. */
+u32 dom_soa_archetype_storage::find_component_owner(dom_component_id component_id) const
+{
+    u32 i;
+    for (i = 0u; i < archetype_count_; ++i) {
+        const dom_soa_archetype* arch = &archetypes_[i];
+        u32 c;
+        for (c = 0u; c < arch->component_count; ++c) {
+            if (arch->component_set[c] == component_id) {
+                return i;
+            }
+        }
+    }
+    return DOM_SOA_INDEX_NONE;
+}
+
+u32 dom_soa_archetype_storage::create_archetype_for(const dom_component_id* ids, u32 count)
+{
+    dom_soa_component_def* defs = new dom_soa_component_def[count];
+    u32* owners = new u32[count];
+    dom_soa_field_def* fields;
+    u32 field_total = 0u;
+    u32 field_index = 0u;
+    u32 result = DOM_SOA_INDEX_NONE;
+    u32 i;
+
+    for (i = 0u; i < count; ++i) {
+        const dom_soa_archetype* owner;
+        u32 c;
+        owners[i] = find_component_owner(ids[i]);
+        if (owners[i] == DOM_SOA_INDEX_NONE) {
+            delete[] defs;
+            delete[] owners;
+            return DOM_SOA_INDEX_NONE;
+        }
+        owner = &archetypes_[owners[i]];
+        for (c = 0u; c < owner->column_count; ++c) {
+            if (owner->columns[c].component_id == ids[i]) {
+                field_total += 1u;
+            }
+        }
+    }
+    fields = new dom_soa_field_def[field_total ? field_total : 1u];
+    for (i = 0u; i < count; ++i) {
+        const dom_soa_archetype* owner = &archetypes_[owners[i]];
+        u32 c;
+        defs[i].component_id = ids[i];
+        defs[i].fields = fields + field_index;
+        defs[i].field_count = 0u;
+        for (c = 0u; c < owner->column_count; ++c) {
+            if (owner->columns[c].component_id == ids[i]) {
+                fields[field_index].field_id = owner->columns[c].field_id;
+                fields[field_index].element_type = owner->columns[c].element_type;
+                fields[field_index].element_size = owner->columns[c].element_size;
+                field_index += 1u;
+                defs[i].field_count += 1u;
+            }
+        }
+    }
+    if (add_archetype(defs, count, 0u) == 0) {
+        const dom_archetype_id id = archetypes_[archetype_count_ - 1u].archetype_id;
+        result = archetype_count_ - 1u;
+        /* Inherit access rules so views on the new archetype behave alike. */
+        for (i = 0u; i < count; ++i) {
+            const dom_soa_archetype* owner = &archetypes_[owners[i]];
+            u32 r;
+            for (r = 0u; r < owner->access_count; ++r) {
+                const dom_soa_access_rule rule = owner->access_rules[r];
+                if (rule.component_id == ids[i]) {
+                    set_access_rule(id, rule.component_id, rule.field_id, rule.access_mode);
+                }
+            }
+        }
+    }
+    delete[] fields;
+    delete[] defs;
+    delete[] owners;
+    return result;
+}
+
+u32 dom_soa_archetype_storage::transition(u32 from_index, u32 kind, dom_component_id component_id)
+{
+    dom_component_id* ids;
+    u32 count = 0u;
+    u32 to_index;
+    u32 i;
+    d_bool present = D_FALSE;
+    const dom_soa_archetype* from;
+
+    if (edge_buckets_) {
+        i = edge_buckets_[dom_soa_edge_bucket(from_index, kind, component_id) & edge_bucket_mask_];
+        while (i != DOM_SOA_INDEX_NONE) {
+            const dom_soa_archetype_edge* edge = &edges_[i];
+            if (edge->from_index == from_index && edge->kind == kind &&
+                edge->component_id == component_id) {
+                return edge->to_index;
+            }
+            i = edge->hash_next;
+        }
+    }
+
+    from = &archetypes_[from_index];
+    for (i = 0u; i < from->component_count; ++i) {
+        if (from->component_set[i] == component_id) {
+            present = D_TRUE;
+        }
+    }
+    if ((kind == DOM_SOA_STRUCT_ADD_COMPONENT) == (present == D_TRUE)) {
+        /* Adding a present component or removing an absent one is a no-op. */
+        edge_insert(from_index, kind, component_id, from_index);
+        return from_index;
+    }
+    if (kind == DOM_SOA_STRUCT_REMOVE_COMPONENT && from->component_count == 1u) {
+        return DOM_SOA_INDEX_NONE;
+    }
+
+    /* component_set is sorted, so the neighbour's set stays sorted. */
+    ids = new dom_component_id[from->component_count + 1u];
+    for (i = 0u; i < from->component_count; ++i) {
+        const dom_component_id id = from->component_set[i];
+        if (kind == DOM_SOA_STRUCT_ADD_COMPONENT && present == D_FALSE && id > component_id) {
+            ids[count++] = component_id;
+            present = D_TRUE;
+        }
+        if (kind == DOM_SOA_STRUCT_REMOVE_COMPONENT && id == component_id) {
             continue;
         }
-        if (to_index > from_index) {
-            size_t offset = (size_t)from_index * col->stride;
-            size_t bytes = (size_t)(to_index - from_index) * col->stride;
-            memset(col->data + offset, 0, bytes);
+        ids[count++] = id;
+    }
+    if (kind == DOM_SOA_STRUCT_ADD_COMPONENT && present == D_FALSE) {
+        ids[count++] = component_id;
+    }
+    {
+        const dom_soa_archetype* existing = find_archetype(dom_soa_archetype_id_from_components(ids, count));
+        to_index = existing ? (u32)(existing - archetypes_) : create_archetype_for(ids, count);
+    }
+    delete[] ids;
+    if (to_index == DOM_SOA_INDEX_NONE) {
+        return DOM_SOA_INDEX_NONE;
+    }
+    edge_insert(from_index, kind, component_id, to_index);
+    edge_insert(to_index,
+                (kind == DOM_SOA_STRUCT_ADD_COMPONENT) ? (u32)DOM_SOA_STRUCT_REMOVE_COMPONENT
+                                                       : (u32)DOM_SOA_STRUCT_ADD_COMPONENT,
+                component_id, from_index);
+    return to_index;
+}
+
+void dom_soa_archetype_storage::edge_insert(u32 from_index, u32 kind,
+                                            dom_component_id component_id, u32 to_index)
+{
+    dom_soa_archetype_edge* edge;
+    u32* head;
+    if (edge_count_ >= edge_capacity_) {
+        const u32 new_capacity = dom_soa_bucket_count(edge_capacity_ ? edge_capacity_ * 2u : 16u);
+        dom_soa_archetype_edge* next = new dom_soa_archetype_edge[new_capacity];
+        u32 i;
+        if (edges_ && edge_count_ > 0u) {
+            memcpy(next, edges_, sizeof(dom_soa_archetype_edge) * edge_count_);
+        }
+        delete[] edges_;
+        delete[] edge_buckets_;
+        edges_ = next;
+        edge_capacity_ = new_capacity;
+        edge_buckets_ = new u32[new_capacity];
+        edge_bucket_mask_ = new_capacity - 1u;
+        for (i = 0u; i < new_capacity; ++i) {
+            edge_buckets_[i] = DOM_SOA_INDEX_NONE;
+        }
+        for (i = 0u; i < edge_count_; ++i) {
+            head = &edge_buckets_[dom_soa_edge_bucket(edges_[i].from_index, edges_[i].kind,
+                                                      edges_[i].component_id) & edge_bucket_mask_];
+            edges_[i].hash_next = *head;
+            *head = i;
         }
-        col->size = arch->entity_count + (to_index - from_index);
     }
+    edge = &edges_[edge_count_];
+    edge->from_index = from_index;
+    edge->kind = kind;
+    edge->component_id = component_id;
+    edge->to_index = to_index;
+    head = &edge_buckets_[dom_soa_edge_bucket(from_index, kind, component_id) & edge_bucket_mask_];
+    edge->hash_next = *head;
+    *head = edge_count_;
+    edge_count_ += 1u;
 }
 
-int dom_soa_archetype_storage::validate_write(const dom_ecs_write_op& op) const
+int dom_soa_archetype_storage::validate_write(const dom_ecs_write_op& op,
+                                              u32* out_arch,
+                                              u32* out_column) const
 {
     const dom_soa_archetype* arch = find_archetype(op.archetype_id);
     const dom_soa_column* col;
@@ -629,99 +1951,7 @@ int dom_soa_archetype_storage::validate_write(const dom_ecs_write_op& op) const
             return 0;
         }
     }
+    *out_arch = (u32)(arch - archetypes_);
+    *out_column = (u32)(col - arch->columns);
     return 1;
 }
-
-void dom_soa_archetype_storage::apply_write(const dom_ecs_write_op& op)
-{
-    dom_soa_archetype* arch = find_archetype(op.archetype_id);
-    dom_soa_column* col = 0;
-    u32 count;
-    u32 i;
-    if (!arch) {
-        return;
-    }
-    col = find_column(arch, op.component_id, op.field_id);
-    if (!col || !op.data) {
-        return;
-    }
-    count = dom_entity_range_count(&op.range);
-    for (i = 0u; i < count; ++i) {
-        size_t src_offset = (size_t)i * op.stride;
-        size_t dst_offset = (size_t)(op.range.begin_index + i) * col->stride;
-        memcpy(col->data + dst_offset, (const unsigned char*)op.data + src_offset, col->element_size);
-    }
-}
-
-void dom_soa_archetype_storage::apply_reduce(const dom_ecs_write_op& op)
-{
-    dom_soa_archetype* arch = find_archetype(op.archetype_id);
-    dom_soa_column* col = 0;
-    u32 count;
-    u32 i;
-    if (!arch) {
-        return;
-    }
-    col = find_column(arch, op.component_id, op.field_id);
-    if (!col || !op.data) {
-        return;
-    }
-    count = dom_entity_range_count(&op.range);
-    for (i = 0u; i < count; ++i) {
-        size_t src_offset = (size_t)i * op.stride;
-        size_t dst_offset = (size_t)(op.range.begin_index + i) * col->stride;
-        if (col->element_type == DOM_ECS_ELEM_U64) {
-            u64 cur;
-            u64 incoming;
-            memcpy(&cur, col->data + dst_offset, sizeof(u64));
-            memcpy(&incoming, (const unsigned char*)op.data + src_offset, sizeof(u64));
-            if (op.reduction_op == DOM_REDUCE_INT_SUM) {
-                cur += incoming;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MIN) {
-                cur = (incoming < cur) ? incoming : cur;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MAX) {
-                cur = (incoming > cur) ? incoming : cur;
-            }
-            memcpy(col->data + dst_offset, &cur, sizeof(u64));
-        } else if (col->element_type == DOM_ECS_ELEM_U32) {
-            u32 cur32;
-            u32 incoming32;
-            memcpy(&cur32, col->data + dst_offset, sizeof(u32));
-            memcpy(&incoming32, (const unsigned char*)op.data + src_offset, sizeof(u32));
-            if (op.reduction_op == DOM_REDUCE_INT_SUM) {
-                cur32 += incoming32;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MIN) {
-                cur32 = (incoming32 < cur32) ? incoming32 : cur32;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MAX) {
-                cur32 = (incoming32 > cur32) ? incoming32 : cur32;
-            }
-            memcpy(col->data + dst_offset, &cur32, sizeof(u32));
-        } else if (col->element_type == DOM_ECS_ELEM_I64) {
-            i64 cur64;
-            i64 incoming64;
-            memcpy(&cur64, col->data + dst_offset, sizeof(i64));
-            memcpy(&incoming64, (const unsigned char*)op.data + src_offset, sizeof(i64));
-            if (op.reduction_op == DOM_REDUCE_INT_SUM) {
-                cur64 += incoming64;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MIN) {
-                cur64 = (incoming64 < cur64) ? incoming64 : cur64;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MAX) {
-                cur64 = (incoming64 > cur64) ? incoming64 : cur64;
-            }
-            memcpy(col->data + dst_offset, &cur64, sizeof(i64));
-        } else if (col->element_type == DOM_ECS_ELEM_I32) {
-            i32 cur32;
-            i32 incoming32;
-            memcpy(&cur32, col->data + dst_offset, sizeof(i32));
-            memcpy(&incoming32, (const unsigned char*)op.data + src_offset, sizeof(i32));
-            if (op.reduction_op == DOM_REDUCE_INT_SUM) {
-                cur32 += incoming32;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MIN) {
-                cur32 = (incoming32 < cur32) ? incoming32 : cur32;
-            } else if (op.reduction_op == DOM_REDUCE_INT_MAX) {
-                cur32 = (incoming32 > cur32) ? incoming32 : cur32;
-            }
-            memcpy(col->data + dst_offset, &cur32, sizeof(i32));
-        }
-    }
-}
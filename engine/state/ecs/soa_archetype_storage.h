@@ -12,6 +12,26 @@ DETERMINISM: Stable ordering and commit semantics only.
 
 #include "domino/ecs/ecs_storage_iface.h"
 #include "soa_archetype_layout.h"
+#include "soa_struct_buffer.h"
+
+#define DOM_SOA_INDEX_NONE 0xFFFFFFFFu
+/* Entity id reserved for rows removed inside a phase; never insertable. */
+#define DOM_SOA_ENTITY_TOMBSTONE ((dom_entity_id)0xFFFFFFFFFFFFFFFFULL)
+
+/* Column data lives in fixed-size chunks, each holding every column of an
+ * archetype for a power-of-two row range. Every column run inside a chunk
+ * starts on a DOM_SOA_CHUNK_ALIGN boundary and is densely packed. */
+#define DOM_SOA_CHUNK_BYTES 16384u
+#define DOM_SOA_CHUNK_ALIGN 64u
+#define DOM_SOA_CHUNKS_PER_SLAB 16u
+
+enum dom_soa_remove_mode {
+    /* Keeps row order. Inside a phase rows are tombstoned and compacted by
+     * end_phase; outside one they are compacted immediately. */
+    DOM_SOA_REMOVE_STABLE = 0u,
+    /* Moves the archetype's last row into the hole. */
+    DOM_SOA_REMOVE_SWAP = 1u
+};
 
 typedef struct dom_soa_access_rule {
     dom_archetype_id archetype_id;
@@ -25,10 +45,11 @@ typedef struct dom_soa_column {
     dom_field_id     field_id;
     u32              element_type;
     u32              element_size;
-    u32              stride;
+    u32              stride;       /* == element_size */
     u32              capacity;
     u32              size;
-    unsigned char*   data;
+    u32              chunk_offset; /* byte offset of this column's run in a chunk */
+    u32              hash_next;
 } dom_soa_column;
 
 typedef struct dom_soa_archetype {
@@ -37,14 +58,61 @@ typedef struct dom_soa_archetype {
     u32                component_count;
     dom_soa_column*    columns;
     u32                column_count;
+    u32*               column_buckets;
+    u32                column_bucket_mask;
+    unsigned char**    chunks;
+    u32                chunk_count;
+    u32                chunk_capacity;
+    u32                chunk_shift;  /* rows per chunk == 1 << chunk_shift */
     dom_entity_id*     entities;
+    u32*               row_locations; /* row -> location index; NONE if tombstoned */
     u32                entity_count;
     u32                entity_capacity;
+    u32                tombstone_count;
     dom_soa_access_rule* access_rules;
     u32                access_count;
     u32                access_capacity;
+    u32                hash_next;
 } dom_soa_archetype;
 
+/* Chunks are carved from slabs and recycled through an intrusive free list;
+ * slabs are only returned when the storage is destroyed. */
+typedef struct dom_soa_chunk_pool {
+    unsigned char** slabs;
+    u32             slab_count;
+    u32             slab_capacity;
+    unsigned char*  free_head;
+    u32             free_count;
+    u32             chunk_total;
+} dom_soa_chunk_pool;
+
+/* Cached archetype graph edge: from + add/remove component -> to. */
+typedef struct dom_soa_archetype_edge {
+    u32              from_index;
+    u32              kind; /* DOM_SOA_STRUCT_ADD_COMPONENT or _REMOVE_COMPONENT */
+    dom_component_id component_id;
+    u32              to_index;
+    u32              hash_next;
+} dom_soa_archetype_edge;
+
+/* Where a live entity's row is; entries stay dense, erased by swap. */
+typedef struct dom_soa_entity_location {
+    dom_entity_id entity;
+    u32           archetype_index;
+    u32           row;
+    u32           hash_next;
+} dom_soa_entity_location;
+
+/* Commit key packed for radix sorting: hi = phase:task[63..32],
+ * lo = task[31..0]:sub_index. */
+typedef struct dom_soa_commit_item {
+    u64 hi;
+    u64 lo;
+    u32 index;
+} dom_soa_commit_item;
+
+struct dom_thread_pool;
+
 class dom_soa_archetype_storage : public IEcsStorageBackend {
 public:
     dom_soa_archetype_storage();
@@ -61,6 +129,32 @@ public:
                         dom_field_id field_id,
                         u32 access_mode);
 
+    void set_remove_mode(u32 mode);
+    u32  remove_mode() const;
+    /* Stable removals between begin_phase and end_phase leave tombstoned
+     * rows in place, so row indices handed out this phase stay valid. */
+    void begin_phase();
+    void end_phase();
+    int  locate(dom_entity_id entity, dom_archetype_id* out_archetype, u32* out_row) const;
+    /* Resolves (and caches) the archetype reached by adding or removing one
+     * component, creating it from known field layouts when missing. */
+    int  prepare_transition(dom_archetype_id from,
+                            u32 kind,
+                            dom_component_id component_id,
+                            dom_archetype_id* out_to);
+    /* Applies add/remove/move ops in commit key order as one batch. Either
+     * every op applies (status 0) or no entity moves (status -1). */
+    void apply_structural(const dom_soa_struct_buffer& changes,
+                          dom_ecs_commit_context& ctx);
+
+    /* Pool is borrowed; the caller owns its lifetime. NULL (the default)
+     * applies writes on the calling thread. Results do not depend on it.
+     * apply_writes waits for the whole pool, so it should not share a pool
+     * the caller itself runs on; when called from one of its workers it
+     * falls back to applying serially. */
+    void set_thread_pool(dom_thread_pool* pool);
+    dom_thread_pool* thread_pool() const;
+
     u64 read_u64(dom_archetype_id archetype,
                  dom_component_id component_id,
                  dom_field_id field_id,
@@ -71,6 +165,17 @@ public:
     virtual dom_component_view get_view(dom_archetype_id archetype,
                                         dom_component_id component,
                                         dom_field_id field);
+
+    /* Chunked access for kernels: a chunk view covers rows
+     * [chunk_index * chunk_rows, +count), with backend_token pointing at the
+     * chunk's aligned, contiguous run for the field. */
+    u32 chunk_rows(dom_archetype_id archetype) const;
+    u32 chunk_count(dom_archetype_id archetype) const;
+    dom_component_view get_chunk_view(dom_archetype_id archetype,
+                                      dom_component_id component,
+                                      dom_field_id field,
+                                      u32 chunk_index);
+    void chunk_pool_stats(u32* out_chunks, u32* out_free) const;
     virtual void apply_writes(const dom_ecs_write_buffer& writes,
                               dom_ecs_commit_context& ctx);
 
@@ -91,13 +196,44 @@ private:
                                                 dom_field_id field_id) const;
     int ensure_capacity(dom_soa_archetype* arch, u32 capacity);
     void zero_new_rows(dom_soa_archetype* arch, u32 from_index, u32 to_index);
-    int validate_write(const dom_ecs_write_op& op) const;
-    void apply_write(const dom_ecs_write_op& op);
-    void apply_reduce(const dom_ecs_write_op& op);
+    int validate_write(const dom_ecs_write_op& op, u32* out_arch, u32* out_column) const;
+    int reserve_commit(u32 count);
+
+    void link_archetypes();
+    u32 location_find(dom_entity_id entity) const;
+    int location_insert(dom_entity_id entity, u32 archetype_index, u32 row);
+    void location_erase(u32 index);
+    void move_row_location(dom_soa_archetype* arch, u32 from_row, u32 to_row);
+    void remove_row_swap(dom_soa_archetype* arch, u32 row);
+    void compact_rows(dom_soa_archetype* arch, u32 from_row);
+    void trim_chunks(dom_soa_archetype* arch);
+    u32 find_component_owner(dom_component_id component_id) const;
+    u32 create_archetype_for(const dom_component_id* ids, u32 count);
+    u32 transition(u32 from_index, u32 kind, dom_component_id component_id);
+    void edge_insert(u32 from_index, u32 kind, dom_component_id component_id, u32 to_index);
 
     dom_soa_archetype* archetypes_;
     u32                archetype_count_;
     u32                archetype_capacity_;
+    u32*               archetype_buckets_;
+    u32                archetype_bucket_mask_;
+    dom_soa_entity_location* locations_;
+    u32                location_count_;
+    u32                location_capacity_;
+    u32*               location_buckets_;
+    u32                location_bucket_mask_;
+    dom_soa_chunk_pool chunk_pool_;
+    u32                remove_mode_;
+    d_bool             in_phase_;
+    dom_soa_archetype_edge* edges_;
+    u32                edge_count_;
+    u32                edge_capacity_;
+    u32*               edge_buckets_;
+    u32                edge_bucket_mask_;
+    dom_thread_pool*   pool_;
+    dom_soa_commit_item* commit_items_;
+    dom_soa_commit_item* commit_scratch_;
+    u32*               op_columns_;
     u32*               sort_indices_;
     u32                sort_capacity_;
 };
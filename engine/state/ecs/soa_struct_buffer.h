@@ -0,0 +1,127 @@
+/*
+FILE: engine/state/ecs/soa_struct_buffer.h
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino / ecs
+RESPONSIBILITY: Structural change command buffer for the SoA backend.
+ALLOWED DEPENDENCIES: engine/include public headers and C89/C++98 headers only.
+FORBIDDEN DEPENDENCIES: engine internal headers outside ecs.
+DETERMINISM: Applied in commit key order, ties in push order.
+*/
+#ifndef DOMINO_ECS_SOA_STRUCT_BUFFER_H
+#define DOMINO_ECS_SOA_STRUCT_BUFFER_H
+
+#include "domino/ecs/ecs_storage_iface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum dom_soa_struct_op_kind {
+    DOM_SOA_STRUCT_ADD_COMPONENT = 1u,
+    DOM_SOA_STRUCT_REMOVE_COMPONENT = 2u,
+    DOM_SOA_STRUCT_MOVE = 3u
+};
+
+typedef struct dom_soa_struct_op {
+    dom_commit_key   commit_key;
+    u32              kind;         /* dom_soa_struct_op_kind */
+    dom_entity_id    entity;
+    dom_component_id component_id; /* add/remove */
+    dom_archetype_id target;       /* move */
+} dom_soa_struct_op;
+
+typedef struct dom_soa_struct_buffer {
+    dom_soa_struct_op* ops;
+    u32                count;
+    u32                capacity;
+} dom_soa_struct_buffer;
+
+static inline void dom_soa_struct_buffer_init(dom_soa_struct_buffer* buffer,
+                                              dom_soa_struct_op* storage,
+                                              u32 capacity)
+{
+    if (!buffer) {
+        return;
+    }
+    buffer->ops = storage;
+    buffer->count = 0u;
+    buffer->capacity = capacity;
+}
+
+static inline void dom_soa_struct_buffer_clear(dom_soa_struct_buffer* buffer)
+{
+    if (!buffer) {
+        return;
+    }
+    buffer->count = 0u;
+}
+
+static inline int dom_soa_struct_buffer_push(dom_soa_struct_buffer* buffer,
+                                             const dom_soa_struct_op* op)
+{
+    if (!buffer || !op || !buffer->ops) {
+        return -1;
+    }
+    if (buffer->count >= buffer->capacity) {
+        return -2;
+    }
+    buffer->ops[buffer->count++] = *op;
+    return 0;
+}
+
+static inline int dom_soa_struct_buffer_add_component(dom_soa_struct_buffer* buffer,
+                                                      const dom_commit_key* key,
+                                                      dom_entity_id entity,
+                                                      dom_component_id component_id)
+{
+    dom_soa_struct_op op;
+    if (!key) {
+        return -1;
+    }
+    op.commit_key = *key;
+    op.kind = DOM_SOA_STRUCT_ADD_COMPONENT;
+    op.entity = entity;
+    op.component_id = component_id;
+    op.target.value = 0u;
+    return dom_soa_struct_buffer_push(buffer, &op);
+}
+
+static inline int dom_soa_struct_buffer_remove_component(dom_soa_struct_buffer* buffer,
+                                                         const dom_commit_key* key,
+                                                         dom_entity_id entity,
+                                                         dom_component_id component_id)
+{
+    dom_soa_struct_op op;
+    if (!key) {
+        return -1;
+    }
+    op.commit_key = *key;
+    op.kind = DOM_SOA_STRUCT_REMOVE_COMPONENT;
+    op.entity = entity;
+    op.component_id = component_id;
+    op.target.value = 0u;
+    return dom_soa_struct_buffer_push(buffer, &op);
+}
+
+static inline int dom_soa_struct_buffer_move(dom_soa_struct_buffer* buffer,
+                                             const dom_commit_key* key,
+                                             dom_entity_id entity,
+                                             dom_archetype_id target)
+{
+    dom_soa_struct_op op;
+    if (!key) {
+        return -1;
+    }
+    op.commit_key = *key;
+    op.kind = DOM_SOA_STRUCT_MOVE;
+    op.entity = entity;
+    op.component_id = 0u;
+    op.target = target;
+    return dom_soa_struct_buffer_push(buffer, &op);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* DOMINO_ECS_SOA_STRUCT_BUFFER_H */
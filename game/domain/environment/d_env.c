@@ -30,7 +30,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 typedef struct denv_chunk_entry {
     d_world         *world;
-    d_chunk         *chunk;
+    u32              chunk_index;
     denv_zone_state *zones;
     u32              zone_count;
     denv_portal     *portals;
@@ -400,13 +400,30 @@ static const d_env_model_vtable g_atmo_vt = {
     denv_atmo_tick
 };
 
+static d_chunk *denv_entry_chunk(const denv_chunk_entry *entry) {
+    return d_world_chunk_at(entry->world, entry->chunk_index);
+}
+
+/* The chunk's slot is a hint; entries compacted by another world's reset
+ * are found by a scan and the slot repaired. */
 static denv_chunk_entry *denv_find_entry(d_world *w, d_chunk *chunk) {
+    u32 chunk_index;
     u32 i;
     if (!w || !chunk) {
         return (denv_chunk_entry *)0;
     }
+    chunk_index = d_world_chunk_index(w, chunk);
+    if (chunk_index == D_CHUNK_INDEX_NONE) {
+        return (denv_chunk_entry *)0;
+    }
+    i = chunk->subsys_entry[D_CHUNK_SLOT_ENV];
+    if (i < g_env_chunk_count && g_env_chunks[i].world == w &&
+        g_env_chunks[i].chunk_index == chunk_index) {
+        return &g_env_chunks[i];
+    }
     for (i = 0u; i < g_env_chunk_count; ++i) {
-        if (g_env_chunks[i].world == w && g_env_chunks[i].chunk == chunk) {
+        if (g_env_chunks[i].world == w && g_env_chunks[i].chunk_index == chunk_index) {
+            chunk->subsys_entry[D_CHUNK_SLOT_ENV] = i;
             return &g_env_chunks[i];
         }
     }
@@ -424,7 +441,11 @@ static denv_chunk_entry *denv_ensure_entry(d_world *w, d_chunk *chunk) {
     entry = &g_env_chunks[g_env_chunk_count];
     memset(entry, 0, sizeof(*entry));
     entry->world = w;
-    entry->chunk = chunk;
+    entry->chunk_index = d_world_chunk_index(w, chunk);
+    if (entry->chunk_index == D_CHUNK_INDEX_NONE) {
+        return (denv_chunk_entry *)0;
+    }
+    chunk->subsys_entry[D_CHUNK_SLOT_ENV] = g_env_chunk_count;
     g_env_chunk_count += 1u;
     return entry;
 }
@@ -486,6 +507,7 @@ static void denv_apply_atmo_diffusion(d_world *w, u32 ticks) {
     q16_16 old_t[DENV_MAX_CHUNK_ENTRIES];
     i64 delta_p[DENV_MAX_CHUNK_ENTRIES];
     i64 delta_t[DENV_MAX_CHUNK_ENTRIES];
+    u32 list_pos[DENV_MAX_CHUNK_ENTRIES]; /* entry index -> list slot */
     u32 count = 0u;
     u32 i;
 
@@ -495,6 +517,7 @@ static void denv_apply_atmo_diffusion(d_world *w, u32 ticks) {
 
     for (i = 0u; i < g_env_chunk_count; ++i) {
         denv_chunk_entry *entry = &g_env_chunks[i];
+        list_pos[i] = DENV_MAX_CHUNK_ENTRIES;
         if (entry->world != w) {
             continue;
         }
@@ -502,6 +525,7 @@ static void denv_apply_atmo_diffusion(d_world *w, u32 ticks) {
             continue;
         }
         if (count < DENV_MAX_CHUNK_ENTRIES) {
+            list_pos[i] = count;
             list[count] = entry;
             old_p[count] = 0;
             old_t[count] = 0;
@@ -523,54 +547,41 @@ static void denv_apply_atmo_diffusion(d_world *w, u32 ticks) {
 
     for (i = 0u; i < count; ++i) {
         denv_chunk_entry *entry = list[i];
-        d_chunk *nbr_chunk;
-        denv_chunk_entry *nbr_entry;
-        u32 j;
+        d_chunk *chunk = denv_entry_chunk(entry);
+        u32 nbr_dirs[2];
+        u32 d;
 
-        if (!entry || !entry->chunk) {
+        if (!chunk) {
             continue;
         }
 
-        /* +X neighbor */
-        nbr_chunk = d_world_find_chunk(w, entry->chunk->cx + 1, entry->chunk->cy);
-        if (nbr_chunk) {
-            nbr_entry = denv_find_entry(w, nbr_chunk);
-            if (nbr_entry) {
-                for (j = 0u; j < count; ++j) {
-                    if (list[j] == nbr_entry) {
-                        i64 diff_p = (i64)old_p[i] - (i64)old_p[j];
-                        i64 diff_t = (i64)old_t[i] - (i64)old_t[j];
-                        q16_16 transfer_p = (q16_16)(diff_p >> 3);
-                        q16_16 transfer_t = (q16_16)(diff_t >> 3);
-                        i64 tp = (i64)transfer_p * (i64)ticks;
-                        i64 tt = (i64)transfer_t * (i64)ticks;
-                        delta_p[i] -= tp; delta_p[j] += tp;
-                        delta_t[i] -= tt; delta_t[j] += tt;
-                        break;
-                    }
-                }
+        /* +X and +Y neighbors; each edge is visited once. */
+        nbr_dirs[0] = D_CHUNK_NBR_EAST;
+        nbr_dirs[1] = D_CHUNK_NBR_NORTH;
+        for (d = 0u; d < 2u; ++d) {
+            denv_chunk_entry *nbr_entry = denv_find_entry(w, d_world_chunk_neighbor(w, chunk, nbr_dirs[d]));
+            u32 j;
+            i64 diff_p;
+            i64 diff_t;
+            q16_16 transfer_p;
+            q16_16 transfer_t;
+            i64 tp;
+            i64 tt;
+            if (!nbr_entry) {
+                continue;
             }
-        }
-
-        /* +Y neighbor */
-        nbr_chunk = d_world_find_chunk(w, entry->chunk->cx, entry->chunk->cy + 1);
-        if (nbr_chunk) {
-            nbr_entry = denv_find_entry(w, nbr_chunk);
-            if (nbr_entry) {
-                for (j = 0u; j < count; ++j) {
-                    if (list[j] == nbr_entry) {
-                        i64 diff_p = (i64)old_p[i] - (i64)old_p[j];
-                        i64 diff_t = (i64)old_t[i] - (i64)old_t[j];
-                        q16_16 transfer_p = (q16_16)(diff_p >> 3);
-                        q16_16 transfer_t = (q16_16)(diff_t >> 3);
-                        i64 tp = (i64)transfer_p * (i64)ticks;
-                        i64 tt = (i64)transfer_t * (i64)ticks;
-                        delta_p[i] -= tp; delta_p[j] += tp;
-                        delta_t[i] -= tt; delta_t[j] += tt;
-                        break;
-                    }
-                }
+            j = list_pos[nbr_entry - g_env_chunks];
+            if (j >= count) {
+                continue;
             }
+            diff_p = (i64)old_p[i] - (i64)old_p[j];
+            diff_t = (i64)old_t[i] - (i64)old_t[j];
+            transfer_p = (q16_16)(diff_p >> 3);
+            transfer_t = (q16_16)(diff_t >> 3);
+            tp = (i64)transfer_p * (i64)ticks;
+            tt = (i64)transfer_t * (i64)ticks;
+            delta_p[i] -= tp; delta_p[j] += tp;
+            delta_t[i] -= tt; delta_t[j] += tt;
         }
     }
 
@@ -594,6 +605,7 @@ void d_env_tick(d_world *w, u32 ticks) {
 
     for (i = 0u; i < g_env_chunk_count; ++i) {
         denv_chunk_entry *entry = &g_env_chunks[i];
+        d_chunk *chunk;
         u32 f;
         if (entry->world != w) {
             continue;
@@ -601,11 +613,12 @@ void d_env_tick(d_world *w, u32 ticks) {
         if (!entry->fields || entry->field_count == 0u) {
             continue;
         }
+        chunk = denv_entry_chunk(entry);
         for (f = 0u; f < entry->field_count; ++f) {
             d_env_field_cell *cell = &entry->fields[f];
             const d_env_model_vtable *vt = denv_model_lookup(cell->desc.model_id);
             if (vt && vt->tick) {
-                vt->tick(w, entry->chunk, cell, ticks);
+                vt->tick(w, chunk, cell, ticks);
             }
         }
     }
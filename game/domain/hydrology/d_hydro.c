@@ -20,15 +20,22 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include "d_worldgen.h"
 #include "d_hydro.h"
 #include "d_res.h"
+#include "thread_pool.h"
 
 #define DHYDRO_MAX_MODELS         8u
 #define DHYDRO_MAX_CHUNK_ENTRIES 256u
 #define DHYDRO_GRID_RES          16u
 #define DHYDRO_GRID_CELLS        (DHYDRO_GRID_RES * DHYDRO_GRID_RES)
+#define DHYDRO_SLEEP_DELTA       ((q16_16)64) /* max |depth change| per cell */
 
 typedef struct dhydro_chunk_entry_s {
     d_world     *world;
-    d_chunk     *chunk;
+    u32          chunk_index;
+    u32          awake;
+    u32          nbr_entry[D_CHUNK_NBR4_COUNT]; /* by D_CHUNK_NBR_*, resolved per tick */
+    i64          surface_total;
+    q16_16       snap[DHYDRO_GRID_CELLS];       /* depth at tick start, >= 0 */
+    q16_16       halo[D_CHUNK_NBR4_COUNT][DHYDRO_GRID_RES];
     d_hydro_cell cells[DHYDRO_GRID_CELLS];
 } dhydro_chunk_entry;
 
@@ -81,19 +88,52 @@ int d_hydro_register_model(const d_hydro_model_vtable *vt) {
     return 0;
 }
 
+static d_chunk *dhydro_entry_chunk(const dhydro_chunk_entry *entry) {
+    return d_world_chunk_at(entry->world, entry->chunk_index);
+}
+
+/* The chunk's slot is a hint; entries compacted by another world's reset
+ * are found by a scan and the slot repaired. */
 static dhydro_chunk_entry *dhydro_find_entry(d_world *w, d_chunk *chunk) {
+    u32 chunk_index;
     u32 i;
     if (!w || !chunk) {
         return (dhydro_chunk_entry *)0;
     }
+    chunk_index = d_world_chunk_index(w, chunk);
+    if (chunk_index == D_CHUNK_INDEX_NONE) {
+        return (dhydro_chunk_entry *)0;
+    }
+    i = chunk->subsys_entry[D_CHUNK_SLOT_HYDRO];
+    if (i < g_hydro_chunk_count && g_hydro_chunks[i].world == w &&
+        g_hydro_chunks[i].chunk_index == chunk_index) {
+        return &g_hydro_chunks[i];
+    }
     for (i = 0u; i < g_hydro_chunk_count; ++i) {
-        if (g_hydro_chunks[i].world == w && g_hydro_chunks[i].chunk == chunk) {
+        if (g_hydro_chunks[i].world == w && g_hydro_chunks[i].chunk_index == chunk_index) {
+            chunk->subsys_entry[D_CHUNK_SLOT_HYDRO] = i;
             return &g_hydro_chunks[i];
         }
     }
     return (dhydro_chunk_entry *)0;
 }
 
+/* Re-reads the cells after a change from outside the solver; wakes the
+ * chunk when some cell moved by more than DHYDRO_SLEEP_DELTA. */
+static void dhydro_entry_touch(dhydro_chunk_entry *entry, i64 max_change) {
+    i64 total = 0;
+    u32 k;
+    for (k = 0u; k < DHYDRO_GRID_CELLS; ++k) {
+        q16_16 d = entry->cells[k].depth;
+        total += (i64)d;
+        entry->snap[k] = (d < 0) ? 0 : d;
+    }
+    entry->surface_total = total;
+    if (max_change > (i64)DHYDRO_SLEEP_DELTA) {
+        entry->awake = 1u;
+    }
+}
+
 static dhydro_chunk_entry *dhydro_ensure_entry(d_world *w, d_chunk *chunk) {
     dhydro_chunk_entry *entry;
     if (!w || !chunk) {
@@ -109,7 +149,12 @@ static dhydro_chunk_entry *dhydro_ensure_entry(d_world *w, d_chunk *chunk) {
     entry = &g_hydro_chunks[g_hydro_chunk_count];
     memset(entry, 0, sizeof(*entry));
     entry->world = w;
-    entry->chunk = chunk;
+    entry->chunk_index = d_world_chunk_index(w, chunk);
+    if (entry->chunk_index == D_CHUNK_INDEX_NONE) {
+        return (dhydro_chunk_entry *)0;
+    }
+    entry->awake = 1u;
+    chunk->subsys_entry[D_CHUNK_SLOT_HYDRO] = g_hydro_chunk_count;
     g_hydro_chunk_count += 1u;
     return entry;
 }
@@ -129,79 +174,46 @@ static void dhydro_init_chunk_default(d_world *w, d_chunk *chunk, d_tlv_blob *pa
         entry->cells[i].velocity_y = 0;
         entry->cells[i].flags = 0;
     }
+    entry->awake = 1u;
+    dhydro_entry_touch(entry, 0);
 }
 
 static q16_16 dhydro_q16_from_i64_clamp(i64 v) {
     if (v > (i64)0x7FFFFFFF) {
         return (q16_16)0x7FFFFFFF;
     }
-    if (v < (i64)0x80000000) {
+    if (v < -(i64)0x80000000) {
         return (q16_16)0x80000000;
     }
     return (q16_16)v;
 }
 
-static q16_16 g_surface_snap[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
-static i64   g_surface_delta[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
-static i64   g_surface_velx[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
-static i64   g_surface_vely[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
+/* Chunks at rest sleep: their interior edges are skipped and their cells are
+ * left alone. An edge on a chunk boundary runs when either side is awake, and
+ * then both sides apply the same transfer. */
+#define DHYDRO_PARALLEL_MIN_CHUNKS 8u
 
-static void dhydro_surface_water_reset_buffers(d_world *w) {
-    u32 i;
-    if (!w) {
-        return;
-    }
-    for (i = 0u; i < g_hydro_chunk_count; ++i) {
-        dhydro_chunk_entry *entry = &g_hydro_chunks[i];
-        u32 base;
-        u32 k;
-        if (entry->world != w) {
-            continue;
-        }
-        base = i * DHYDRO_GRID_CELLS;
-        for (k = 0u; k < DHYDRO_GRID_CELLS; ++k) {
-            q16_16 d = entry->cells[k].depth;
-            if (d < 0) {
-                d = 0;
-            }
-            g_surface_snap[base + k] = d;
-            g_surface_delta[base + k] = 0;
-            g_surface_velx[base + k] = 0;
-            g_surface_vely[base + k] = 0;
-        }
-    }
-}
+static i64 g_surface_delta[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
+static i64 g_surface_velx[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
+static i64 g_surface_vely[DHYDRO_MAX_CHUNK_ENTRIES * DHYDRO_GRID_CELLS];
+static u32 g_surface_run[DHYDRO_MAX_CHUNK_ENTRIES];
 
-static void dhydro_surface_water_apply_edge(
-    u32 a_entry_index,
-    u32 a_cell_index,
-    u32 b_entry_index,
-    u32 b_cell_index,
-    int axis /* 0 = Y, 1 = X */
-) {
-    u32 a_off;
-    u32 b_off;
-    q16_16 ha;
-    q16_16 hb;
-    i64 diff;
-    i64 transfer_i64;
-    q16_16 transfer;
-
-    if (a_entry_index >= DHYDRO_MAX_CHUNK_ENTRIES || b_entry_index >= DHYDRO_MAX_CHUNK_ENTRIES) {
-        return;
-    }
-    if (a_cell_index >= DHYDRO_GRID_CELLS || b_cell_index >= DHYDRO_GRID_CELLS) {
-        return;
-    }
+static dom_thread_pool *g_hydro_pool = (dom_thread_pool *)0;
 
-    a_off = a_entry_index * DHYDRO_GRID_CELLS + a_cell_index;
-    b_off = b_entry_index * DHYDRO_GRID_CELLS + b_cell_index;
+typedef struct dhydro_job_s {
+    const u32 *list;
+    u32        begin;
+    u32        end;
+    void     (*fn)(u32 entry_index);
+} dhydro_job;
 
-    ha = g_surface_snap[a_off];
-    hb = g_surface_snap[b_off];
-    diff = (i64)ha - (i64)hb;
-    transfer_i64 = diff >> 3; /* stable, limited per tick */
-    transfer = dhydro_q16_from_i64_clamp(transfer_i64);
+void d_hydro_set_thread_pool(struct dom_thread_pool *pool) {
+    g_hydro_pool = pool;
+}
+
+/* Transfer from a to b across one edge, from the tick-start depths. */
+static q16_16 dhydro_surface_water_edge(q16_16 ha, q16_16 hb) {
+    q16_16 transfer = dhydro_q16_from_i64_clamp(((i64)ha - (i64)hb) >> 3); /* stable, limited per tick */
 
     /* Clamp by available water at the source. */
     if (transfer > 0) {
@@ -213,99 +225,203 @@ static void dhydro_surface_water_apply_edge(
         if (need > hb) {
             transfer = (q16_16)(-hb);
         }
-    } else {
-        return;
     }
+    return transfer;
+}
 
-    if (transfer == 0) {
-        return;
+/* Copies the facing row or column of each exchanging neighbor into the halo.
+ * Returns a bit per D_CHUNK_NBR_* direction whose edge runs this tick. */
+static u32 dhydro_surface_water_fill_halo(dhydro_chunk_entry *entry) {
+    u32 mask = 0u;
+    u32 d;
+    for (d = 0u; d < D_CHUNK_NBR4_COUNT; ++d) {
+        const dhydro_chunk_entry *nbr;
+        u32 k;
+        if (entry->nbr_entry[d] == D_CHUNK_INDEX_NONE) {
+            continue;
+        }
+        nbr = &g_hydro_chunks[entry->nbr_entry[d]];
+        if (!entry->awake && !nbr->awake) {
+            continue;
+        }
+        for (k = 0u; k < DHYDRO_GRID_RES; ++k) {
+            u32 cell;
+            switch (d) {
+            case D_CHUNK_NBR_EAST:  cell = k * DHYDRO_GRID_RES; break;
+            case D_CHUNK_NBR_WEST:  cell = k * DHYDRO_GRID_RES + (DHYDRO_GRID_RES - 1u); break;
+            case D_CHUNK_NBR_NORTH: cell = k; break;
+            default:                cell = (DHYDRO_GRID_RES - 1u) * DHYDRO_GRID_RES + k; break;
+            }
+            entry->halo[d][k] = nbr->snap[cell];
+        }
+        mask |= 1u << d;
     }
+    return mask;
+}
 
-    g_surface_delta[a_off] -= (i64)transfer;
-    g_surface_delta[b_off] += (i64)transfer;
-
-    if (axis == 1) {
-        g_surface_velx[a_off] += (i64)transfer;
-        g_surface_velx[b_off] += (i64)transfer;
-    } else {
-        g_surface_vely[a_off] += (i64)transfer;
-        g_surface_vely[b_off] += (i64)transfer;
+/* Gathers every edge touching the chunk's cells into its own delta range, in
+ * a fixed west, east, south, north order per cell. Reads neighbors only
+ * through the halo, so chunks can run concurrently. */
+static void dhydro_surface_water_compute_chunk(u32 entry_index) {
+    dhydro_chunk_entry *entry = &g_hydro_chunks[entry_index];
+    const q16_16 *snap = entry->snap;
+    const u32 base = entry_index * DHYDRO_GRID_CELLS;
+    const u32 halo = dhydro_surface_water_fill_halo(entry);
+    const int interior = entry->awake ? 1 : 0;
+    u32 x;
+    u32 y;
+
+    for (y = 0u; y < DHYDRO_GRID_RES; ++y) {
+        for (x = 0u; x < DHYDRO_GRID_RES; ++x) {
+            const u32 c = y * DHYDRO_GRID_RES + x;
+            const q16_16 h = snap[c];
+            i64 delta = 0;
+            i64 velx = 0;
+            i64 vely = 0;
+            q16_16 t;
+
+            if (x > 0u ? interior : (halo & (1u << D_CHUNK_NBR_WEST)) != 0u) {
+                t = dhydro_surface_water_edge(x > 0u ? snap[c - 1u] : entry->halo[D_CHUNK_NBR_WEST][y], h);
+                delta += (i64)t;
+                velx += (i64)t;
+            }
+            if (x + 1u < DHYDRO_GRID_RES ? interior : (halo & (1u << D_CHUNK_NBR_EAST)) != 0u) {
+                t = dhydro_surface_water_edge(h, x + 1u < DHYDRO_GRID_RES ? snap[c + 1u] : entry->halo[D_CHUNK_NBR_EAST][y]);
+                delta -= (i64)t;
+                velx += (i64)t;
+            }
+            if (y > 0u ? interior : (halo & (1u << D_CHUNK_NBR_SOUTH)) != 0u) {
+                t = dhydro_surface_water_edge(y > 0u ? snap[c - DHYDRO_GRID_RES] : entry->halo[D_CHUNK_NBR_SOUTH][x], h);
+                delta += (i64)t;
+                vely += (i64)t;
+            }
+            if (y + 1u < DHYDRO_GRID_RES ? interior : (halo & (1u << D_CHUNK_NBR_NORTH)) != 0u) {
+                t = dhydro_surface_water_edge(h, y + 1u < DHYDRO_GRID_RES ? snap[c + DHYDRO_GRID_RES] : entry->halo[D_CHUNK_NBR_NORTH][x]);
+                delta -= (i64)t;
+                vely += (i64)t;
+            }
+            g_surface_delta[base + c] = delta;
+            g_surface_velx[base + c] = velx;
+            g_surface_vely[base + c] = vely;
+        }
     }
 }
 
-static void dhydro_surface_water_compute_flows(d_world *w) {
+/* Writes the chunk's new state and decides whether it sleeps next tick. */
+static void dhydro_surface_water_apply_chunk(u32 entry_index) {
+    dhydro_chunk_entry *entry = &g_hydro_chunks[entry_index];
+    const u32 base = entry_index * DHYDRO_GRID_CELLS;
+    i64 max_change = 0;
+    i64 total = 0;
+    u32 k;
+    for (k = 0u; k < DHYDRO_GRID_CELLS; ++k) {
+        i64 delta = g_surface_delta[base + k];
+        i64 depth_i64 = (i64)entry->snap[k] + delta;
+        q16_16 depth;
+        if (depth_i64 < 0) {
+            depth_i64 = 0;
+        }
+        if (delta < 0) {
+            delta = -delta;
+        }
+        if (delta > max_change) {
+            max_change = delta;
+        }
+        depth = dhydro_q16_from_i64_clamp(depth_i64);
+        entry->cells[k].depth = depth;
+        entry->cells[k].surface_height = depth;
+        entry->cells[k].velocity_x = dhydro_q16_from_i64_clamp(g_surface_velx[base + k]);
+        entry->cells[k].velocity_y = dhydro_q16_from_i64_clamp(g_surface_vely[base + k]);
+        entry->snap[k] = depth;
+        total += (i64)depth;
+    }
+    entry->surface_total = total;
+    entry->awake = (max_change > (i64)DHYDRO_SLEEP_DELTA) ? 1u : 0u;
+}
+
+static void dhydro_job_run(void *user_data) {
+    const dhydro_job *job = (const dhydro_job *)user_data;
     u32 i;
-    if (!w) {
+    for (i = job->begin; i < job->end; ++i) {
+        job->fn(job->list[i]);
+    }
+}
+
+/* Runs fn over the list, split into contiguous jobs on the pool when one is
+ * set. Each call touches only its own entry, so the split does not change
+ * results. */
+static void dhydro_run_chunks(const u32 *list, u32 count, void (*fn)(u32)) {
+    dhydro_job jobs[DHYDRO_MAX_CHUNK_ENTRIES];
+    u32 job_count = 1u;
+    u32 j;
+    if (count == 0u) {
         return;
     }
-    for (i = 0u; i < g_hydro_chunk_count; ++i) {
-        dhydro_chunk_entry *entry = &g_hydro_chunks[i];
-        u32 x, y;
-        if (entry->world != w || !entry->chunk) {
-            continue;
+    /* On one of the pool's own workers the wait below would count this
+     * task and never return, so run serially there. */
+    if (g_hydro_pool && g_hydro_pool->worker_count > 0u && count >= DHYDRO_PARALLEL_MIN_CHUNKS &&
+        dom_thread_pool_on_worker(g_hydro_pool) == D_FALSE) {
+        job_count = g_hydro_pool->worker_count * 4u;
+        if (job_count > count) {
+            job_count = count;
         }
-        for (y = 0u; y < DHYDRO_GRID_RES; ++y) {
-            for (x = 0u; x < DHYDRO_GRID_RES; ++x) {
-                u32 a_cell = y * DHYDRO_GRID_RES + x;
-
-                /* East edge (+X chunk if boundary). */
-                if (x + 1u < DHYDRO_GRID_RES) {
-                    u32 b_cell = y * DHYDRO_GRID_RES + (x + 1u);
-                    dhydro_surface_water_apply_edge(i, a_cell, i, b_cell, 1);
-                } else {
-                    d_chunk *nbr_chunk = d_world_find_chunk(w, entry->chunk->cx + 1, entry->chunk->cy);
-                    dhydro_chunk_entry *nbr = nbr_chunk ? dhydro_find_entry(w, nbr_chunk) : (dhydro_chunk_entry *)0;
-                    if (nbr) {
-                        u32 j = (u32)(nbr - g_hydro_chunks);
-                        u32 b_cell = y * DHYDRO_GRID_RES + 0u;
-                        dhydro_surface_water_apply_edge(i, a_cell, j, b_cell, 1);
-                    }
-                }
-
-                /* North edge (+Y chunk if boundary). */
-                if (y + 1u < DHYDRO_GRID_RES) {
-                    u32 b_cell = (y + 1u) * DHYDRO_GRID_RES + x;
-                    dhydro_surface_water_apply_edge(i, a_cell, i, b_cell, 0);
-                } else {
-                    d_chunk *nbr_chunk = d_world_find_chunk(w, entry->chunk->cx, entry->chunk->cy + 1);
-                    dhydro_chunk_entry *nbr = nbr_chunk ? dhydro_find_entry(w, nbr_chunk) : (dhydro_chunk_entry *)0;
-                    if (nbr) {
-                        u32 j = (u32)(nbr - g_hydro_chunks);
-                        u32 b_cell = 0u * DHYDRO_GRID_RES + x;
-                        dhydro_surface_water_apply_edge(i, a_cell, j, b_cell, 0);
-                    }
-                }
-            }
+    }
+    for (j = 0u; j < job_count; ++j) {
+        jobs[j].list = list;
+        jobs[j].begin = (u32)(((u64)count * j) / job_count);
+        jobs[j].end = (u32)(((u64)count * (j + 1u)) / job_count);
+        jobs[j].fn = fn;
+    }
+    if (job_count == 1u) {
+        dhydro_job_run(&jobs[0]);
+        return;
+    }
+    for (j = 0u; j < job_count; ++j) {
+        dom_thread_pool_task task;
+        task.task_id = (u64)j;
+        task.fn = dhydro_job_run;
+        task.user_data = &jobs[j];
+        if (dom_thread_pool_submit(g_hydro_pool, &task) == D_FALSE) {
+            dhydro_job_run(&jobs[j]);
         }
     }
+    dom_thread_pool_wait(g_hydro_pool);
 }
 
-static void dhydro_surface_water_apply_state(d_world *w) {
+/* Resolves neighbor entries and collects the chunks that have an edge to run:
+ * awake chunks and sleeping chunks that border one. */
+static u32 dhydro_surface_water_collect(d_world *w) {
+    u32 count = 0u;
     u32 i;
-    if (!w) {
-        return;
-    }
     for (i = 0u; i < g_hydro_chunk_count; ++i) {
         dhydro_chunk_entry *entry = &g_hydro_chunks[i];
-        u32 base;
-        u32 k;
+        d_chunk *chunk;
+        u32 d;
         if (entry->world != w) {
             continue;
         }
-        base = i * DHYDRO_GRID_CELLS;
-        for (k = 0u; k < DHYDRO_GRID_CELLS; ++k) {
-            i64 depth_i64 = (i64)g_surface_snap[base + k] + g_surface_delta[base + k];
-            q16_16 depth;
-            if (depth_i64 < 0) {
-                depth_i64 = 0;
-            }
-            depth = dhydro_q16_from_i64_clamp(depth_i64);
-            entry->cells[k].depth = depth;
-            entry->cells[k].surface_height = depth;
-            entry->cells[k].velocity_x = dhydro_q16_from_i64_clamp(g_surface_velx[base + k]);
-            entry->cells[k].velocity_y = dhydro_q16_from_i64_clamp(g_surface_vely[base + k]);
+        chunk = dhydro_entry_chunk(entry);
+        for (d = 0u; d < D_CHUNK_NBR4_COUNT; ++d) {
+            dhydro_chunk_entry *nbr = chunk ? dhydro_find_entry(w, d_world_chunk_neighbor(w, chunk, d)) : 0;
+            entry->nbr_entry[d] = nbr ? (u32)(nbr - g_hydro_chunks) : D_CHUNK_INDEX_NONE;
+        }
+    }
+    for (i = 0u; i < g_hydro_chunk_count; ++i) {
+        const dhydro_chunk_entry *entry = &g_hydro_chunks[i];
+        u32 run;
+        u32 d;
+        if (entry->world != w) {
+            continue;
+        }
+        run = entry->awake;
+        for (d = 0u; d < D_CHUNK_NBR4_COUNT && !run; ++d) {
+            run = (entry->nbr_entry[d] != D_CHUNK_INDEX_NONE) && g_hydro_chunks[entry->nbr_entry[d]].awake;
+        }
+        if (run) {
+            g_surface_run[count++] = i;
         }
     }
+    return count;
 }
 
 static void dhydro_surface_water_exchange_res(d_world *w, u32 tick_seed) {
@@ -316,19 +432,24 @@ static void dhydro_surface_water_exchange_res(d_world *w, u32 tick_seed) {
     for (i = 0u; i < g_hydro_chunk_count; ++i) {
         dhydro_chunk_entry *entry = &g_hydro_chunks[i];
         dres_sample samples[4];
+        d_chunk *chunk;
         u16 count;
         q32_32 sx;
         q32_32 sy;
         q32_32 sz;
         u16 si;
 
-        if (entry->world != w || !entry->chunk) {
+        if (entry->world != w) {
+            continue;
+        }
+        chunk = dhydro_entry_chunk(entry);
+        if (!chunk) {
             continue;
         }
 
         count = 4u;
-        sx = ((q32_32)entry->chunk->cx) << Q32_32_FRAC_BITS;
-        sy = ((q32_32)entry->chunk->cy) << Q32_32_FRAC_BITS;
+        sx = ((q32_32)chunk->cx) << Q32_32_FRAC_BITS;
+        sy = ((q32_32)chunk->cy) << Q32_32_FRAC_BITS;
         sz = 0;
 
         if (dres_sample_at(w, sx, sy, sz, 0u, samples, &count) != 0) {
@@ -340,7 +461,7 @@ static void dhydro_surface_water_exchange_res(d_world *w, u32 tick_seed) {
 
         for (si = 0u; si < count; ++si) {
             if ((samples[si].tags & D_TAG_MATERIAL_FLUID) != 0u) {
-                i64 surface_total = 0;
+                i64 surface_total = entry->surface_total;
                 i64 reservoir_total;
                 i64 diff;
                 q16_16 delta[DRES_VALUE_MAX];
@@ -348,11 +469,9 @@ static void dhydro_surface_water_exchange_res(d_world *w, u32 tick_seed) {
                 u32 cell_idx;
                 q16_16 target;
                 q16_16 remaining;
+                q16_16 max_step = 0;
                 i32 cells_left;
 
-                for (cell_idx = 0u; cell_idx < DHYDRO_GRID_CELLS; ++cell_idx) {
-                    surface_total += (i64)entry->cells[cell_idx].depth;
-                }
                 reservoir_total = (i64)samples[si].value[0];
                 diff = reservoir_total - surface_total;
 
@@ -384,12 +503,16 @@ static void dhydro_surface_water_exchange_res(d_world *w, u32 tick_seed) {
                         }
                         per = d_q16_16_div(remaining, d_q16_16_from_int(cells_left));
                         add = per;
+                        if (add > max_step) {
+                            max_step = add;
+                        }
                         entry->cells[cell_idx].depth = d_q16_16_add(entry->cells[cell_idx].depth, add);
                         entry->cells[cell_idx].surface_height = entry->cells[cell_idx].depth;
                         remaining = d_q16_16_sub(remaining, add);
                         cells_left -= 1;
                     }
                     delta[0] = (q16_16)(-(target - remaining));
+                    dhydro_entry_touch(entry, (i64)max_step);
                     if (delta[0] != 0) {
                         (void)dres_apply_delta(w, &samples[si], delta, tick_seed);
                     }
@@ -417,12 +540,16 @@ static void dhydro_surface_water_exchange_res(d_world *w, u32 tick_seed) {
                         if (take > d) {
                             take = d;
                         }
+                        if (take > max_step) {
+                            max_step = take;
+                        }
                         entry->cells[cell_idx].depth = d_q16_16_sub(d, take);
                         entry->cells[cell_idx].surface_height = entry->cells[cell_idx].depth;
                         remaining = d_q16_16_sub(remaining, take);
                         cells_left -= 1;
                     }
                     delta[0] = (q16_16)(target - remaining);
+                    dhydro_entry_touch(entry, (i64)max_step);
                     if (delta[0] != 0) {
                         (void)dres_apply_delta(w, &samples[si], delta, tick_seed);
                     }
@@ -441,9 +568,9 @@ static void dhydro_tick_surface_water_world(d_world *w, u32 ticks) {
     }
     for (t = 0u; t < ticks; ++t) {
         u32 tick_seed = (u32)(w->tick_count + t);
-        dhydro_surface_water_reset_buffers(w);
-        dhydro_surface_water_compute_flows(w);
-        dhydro_surface_water_apply_state(w);
+        u32 count = dhydro_surface_water_collect(w);
+        dhydro_run_chunks(g_surface_run, count, dhydro_surface_water_compute_chunk);
+        dhydro_run_chunks(g_surface_run, count, dhydro_surface_water_apply_chunk);
         dhydro_surface_water_exchange_res(w, tick_seed);
     }
 }
@@ -455,6 +582,13 @@ static void dhydro_tick_surface_water(d_world *w, d_chunk *chunk, u32 ticks) {
     /* Handled by the subsystem-level deterministic world tick. */
 }
 
+/* Cell under (x, y) from the top bits of the in-chunk fraction. */
+static u32 dhydro_cell_index(q32_32 x, q32_32 y) {
+    u32 lx = ((u32)x >> 28) & 0xFu;
+    u32 ly = ((u32)y >> 28) & 0xFu;
+    return ly * DHYDRO_GRID_RES + lx;
+}
+
 static void dhydro_sample_surface_water(
     const d_world *w,
     const d_chunk *chunk,
@@ -464,11 +598,6 @@ static void dhydro_sample_surface_water(
     d_hydro_cell  *out_cell
 ) {
     dhydro_chunk_entry *entry;
-    u32 fx;
-    u32 fy;
-    u32 lx;
-    u32 ly;
-    u32 idx;
     (void)z;
 
     if (!w || !chunk || !out_cell) {
@@ -480,15 +609,7 @@ static void dhydro_sample_surface_water(
         return;
     }
 
-    fx = (u32)x;
-    fy = (u32)y;
-    lx = (fx >> 28) & 0xFu;
-    ly = (fy >> 28) & 0xFu;
-    idx = ly * DHYDRO_GRID_RES + lx;
-    if (idx >= DHYDRO_GRID_CELLS) {
-        idx = 0u;
-    }
-    *out_cell = entry->cells[idx];
+    *out_cell = entry->cells[dhydro_cell_index(x, y)];
 }
 
 static const d_hydro_model_vtable g_surface_water_vt = {
@@ -519,27 +640,19 @@ void d_hydro_tick(d_world *w, u32 ticks) {
     dhydro_tick_surface_water_world(w, ticks);
 }
 
-int d_hydro_sample_at(
-    d_world      *w,
-    q32_32        x,
-    q32_32        y,
-    q32_32        z,
-    d_hydro_cell *out_cell
-) {
+/* Finds or creates the chunk holding (x, y) and makes sure it has hydro
+ * state. */
+static d_chunk *dhydro_chunk_for_pos(d_world *w, q32_32 x, q32_32 y) {
     d_chunk *chunk;
-    const d_hydro_model_vtable *vt;
-    if (!w || !out_cell) {
-        return -1;
-    }
     chunk = d_world_find_chunk(w, (i32)(x >> Q32_32_FRAC_BITS), (i32)(y >> Q32_32_FRAC_BITS));
     if (!chunk) {
         chunk = d_world_get_or_create_chunk(w, (i32)(x >> Q32_32_FRAC_BITS), (i32)(y >> Q32_32_FRAC_BITS));
     }
     if (!chunk) {
-        memset(out_cell, 0, sizeof(*out_cell));
-        return 0;
+        return (d_chunk *)0;
     }
     if (!dhydro_find_entry(w, chunk)) {
+        const d_hydro_model_vtable *vt;
         d_tlv_blob params;
         params.ptr = (unsigned char *)0;
         params.len = 0u;
@@ -548,6 +661,26 @@ int d_hydro_sample_at(
             vt->init_chunk(w, chunk, &params);
         }
     }
+    return chunk;
+}
+
+int d_hydro_sample_at(
+    d_world      *w,
+    q32_32        x,
+    q32_32        y,
+    q32_32        z,
+    d_hydro_cell *out_cell
+) {
+    d_chunk *chunk;
+    const d_hydro_model_vtable *vt;
+    if (!w || !out_cell) {
+        return -1;
+    }
+    chunk = dhydro_chunk_for_pos(w, x, y);
+    if (!chunk) {
+        memset(out_cell, 0, sizeof(*out_cell));
+        return 0;
+    }
     vt = dhydro_model_lookup(D_HYDRO_MODEL_SURFACE_WATER);
     if (vt && vt->sample) {
         vt->sample((const d_world *)w, (const d_chunk *)chunk, x, y, z, out_cell);
@@ -557,6 +690,46 @@ int d_hydro_sample_at(
     return 0;
 }
 
+int d_hydro_add_water(
+    d_world *w,
+    q32_32   x,
+    q32_32   y,
+    q16_16   amount
+) {
+    dhydro_chunk_entry *entry;
+    d_chunk *chunk;
+    d_hydro_cell *cell;
+    i64 depth;
+    if (!w) {
+        return -1;
+    }
+    chunk = dhydro_chunk_for_pos(w, x, y);
+    entry = chunk ? dhydro_find_entry(w, chunk) : (dhydro_chunk_entry *)0;
+    if (!entry) {
+        return -1;
+    }
+    cell = &entry->cells[dhydro_cell_index(x, y)];
+    depth = (i64)cell->depth + (i64)amount;
+    if (depth < 0) {
+        depth = 0;
+    }
+    cell->depth = dhydro_q16_from_i64_clamp(depth);
+    cell->surface_height = cell->depth;
+    dhydro_entry_touch(entry, (i64)amount < 0 ? -(i64)amount : (i64)amount);
+    return 0;
+}
+
+u32 d_hydro_awake_chunk_count(const d_world *w) {
+    u32 count = 0u;
+    u32 i;
+    for (i = 0u; i < g_hydro_chunk_count; ++i) {
+        if (g_hydro_chunks[i].world == w && g_hydro_chunks[i].awake) {
+            count += 1u;
+        }
+    }
+    return count;
+}
+
 static int dhydro_save_chunk(
     d_world    *w,
     d_chunk    *chunk,
@@ -579,7 +752,7 @@ static int dhydro_save_chunk(
         return 0;
     }
 
-    total = 4u + (DHYDRO_GRID_CELLS * (sizeof(q16_16) * 5u));
+    total = 4u + (DHYDRO_GRID_CELLS * (sizeof(q16_16) * 5u)) + 4u;
     buf = (unsigned char *)malloc(total);
     if (!buf) {
         return -1;
@@ -599,6 +772,9 @@ static int dhydro_save_chunk(
         memcpy(dst, &entry->cells[i].velocity_y, sizeof(q16_16)); dst += sizeof(q16_16);
         memcpy(dst, &entry->cells[i].flags, sizeof(q16_16)); dst += sizeof(q16_16);
     }
+    /* Sleep state; older blobs end after the cells and load awake. */
+    memcpy(dst, &entry->awake, sizeof(u32));
+    dst += 4u;
 
     out->ptr = buf;
     out->len = (u32)(dst - buf);
@@ -650,6 +826,14 @@ static int dhydro_load_chunk(
         memcpy(&entry->cells[i].velocity_y, ptr, sizeof(q16_16)); ptr += sizeof(q16_16);
         memcpy(&entry->cells[i].flags, ptr, sizeof(q16_16)); ptr += sizeof(q16_16);
     }
+    remaining -= DHYDRO_GRID_CELLS * (sizeof(q16_16) * 5u);
+    entry->awake = 1u;
+    dhydro_entry_touch(entry, 0);
+    if (remaining >= 4u) {
+        u32 awake;
+        memcpy(&awake, ptr, sizeof(u32));
+        entry->awake = awake ? 1u : 0u;
+    }
     return 0;
 }
 
@@ -62,6 +62,20 @@ typedef struct d_hydro_model_vtable_s {
 int d_hydro_register_model(const d_hydro_model_vtable *vt);
 void d_hydro_tick(d_world *w, u32 ticks);
 
+/* Borrowed pool for the surface-water solver; null runs on the caller.
+ * Results do not depend on the pool or its size. d_hydro_tick waits for the
+ * whole pool, so it should not share a pool the caller itself runs on; a
+ * tick from one of its workers runs serially. */
+struct dom_thread_pool;
+void d_hydro_set_thread_pool(struct dom_thread_pool *pool);
+
+/* External source or sink: adds amount (may be negative) to the depth of the
+ * cell under (x, y) and wakes its chunk. */
+int d_hydro_add_water(d_world *w, q32_32 x, q32_32 y, q16_16 amount);
+
+/* Chunks whose water moved enough last tick to keep simulating. */
+u32 d_hydro_awake_chunk_count(const d_world *w);
+
 /* Convenience sampling API for the active model. */
 int d_hydro_sample_at(
     d_world      *w,
@@ -30,7 +30,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 typedef struct dres_chunk_entry {
     d_world           *world;
-    d_chunk           *chunk;
+    u32                chunk_index;
     dres_channel_cell *cells;
     u32                cell_count;
     u32                cell_capacity;
@@ -141,13 +141,30 @@ int dres_register_model(const dres_model_vtable *vt) {
     return 0;
 }
 
-static dres_chunk_entry *dres_find_entry(d_world *w, d_chunk *chunk) {
+static d_chunk *dres_entry_chunk(const dres_chunk_entry *entry) {
+    return d_world_chunk_at(entry->world, entry->chunk_index);
+}
+
+/* The chunk's slot is a hint; entries compacted by another world's reset
+ * are found by a scan and the slot repaired. */
+static dres_chunk_entry *dres_find_entry(d_world *w, const d_chunk *chunk) {
+    u32 chunk_index;
     u32 i;
     if (!w || !chunk) {
         return (dres_chunk_entry *)0;
     }
+    chunk_index = d_world_chunk_index(w, chunk);
+    if (chunk_index == D_CHUNK_INDEX_NONE) {
+        return (dres_chunk_entry *)0;
+    }
+    i = chunk->subsys_entry[D_CHUNK_SLOT_RES];
+    if (i < g_res_chunk_count && g_res_chunks[i].world == w &&
+        g_res_chunks[i].chunk_index == chunk_index) {
+        return &g_res_chunks[i];
+    }
     for (i = 0u; i < g_res_chunk_count; ++i) {
-        if (g_res_chunks[i].world == w && g_res_chunks[i].chunk == chunk) {
+        if (g_res_chunks[i].world == w && g_res_chunks[i].chunk_index == chunk_index) {
+            w->chunks[chunk_index].subsys_entry[D_CHUNK_SLOT_RES] = i;
             return &g_res_chunks[i];
         }
     }
@@ -169,7 +186,11 @@ static dres_chunk_entry *dres_ensure_entry(d_world *w, d_chunk *chunk) {
     entry = &g_res_chunks[g_res_chunk_count];
     memset(entry, 0, sizeof(*entry));
     entry->world = w;
-    entry->chunk = chunk;
+    entry->chunk_index = d_world_chunk_index(w, chunk);
+    if (entry->chunk_index == D_CHUNK_INDEX_NONE) {
+        return (dres_chunk_entry *)0;
+    }
+    chunk->subsys_entry[D_CHUNK_SLOT_RES] = g_res_chunk_count;
     g_res_chunk_count += 1u;
     return entry;
 }
@@ -274,18 +295,25 @@ int dres_apply_delta(
     u32                 seed_context
 ) {
     u32 i;
+    u32 begin = 0u;
+    u32 end = g_res_chunk_count;
     if (!w || !sample || !delta_values) {
         return -1;
     }
-    for (i = 0u; i < g_res_chunk_count; ++i) {
+    if (sample->chunk) {
+        dres_chunk_entry *only = dres_find_entry(w, sample->chunk);
+        if (!only) {
+            return -1;
+        }
+        begin = (u32)(only - g_res_chunks);
+        end = begin + 1u;
+    }
+    for (i = begin; i < end; ++i) {
         dres_chunk_entry *entry = &g_res_chunks[i];
         u32 c;
         if (entry->world != w || entry->cell_count == 0u || !entry->cells) {
             continue;
         }
-        if (sample->chunk && entry->chunk != sample->chunk) {
-            continue;
-        }
         for (c = 0u; c < entry->cell_count; ++c) {
             dres_channel_cell *cell = &entry->cells[c];
             const dres_model_vtable *vt;
@@ -295,7 +323,7 @@ int dres_apply_delta(
             }
             vt = dres_model_lookup(cell->desc.model_id);
             if (vt && vt->apply_delta) {
-                vt->apply_delta(w, entry->chunk, cell, delta_values, seed_context);
+                vt->apply_delta(w, dres_entry_chunk(entry), cell, delta_values, seed_context);
                 return 0;
             }
             for (j = 0u; j < DRES_VALUE_MAX; ++j) {
@@ -516,14 +544,16 @@ static void dres_tick(d_world *w, u32 ticks) {
     u32 i;
     for (i = 0u; i < g_res_chunk_count; ++i) {
         dres_chunk_entry *entry = &g_res_chunks[i];
+        d_chunk *chunk;
         u32 c;
         if (entry->world != w || entry->cell_count == 0u || !entry->cells) {
             continue;
         }
+        chunk = dres_entry_chunk(entry);
         for (c = 0u; c < entry->cell_count; ++c) {
             const dres_model_vtable *vt = dres_model_lookup(entry->cells[c].desc.model_id);
             if (vt && vt->tick) {
-                vt->tick(w, entry->chunk, &entry->cells[c], ticks);
+                vt->tick(w, chunk, &entry->cells[c], ticks);
             }
         }
     }
@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include "d_subsystem.h"
 #include "d_net_apply.h"
 #include "domino/system/dsys_perf.h"
+#include "domino/system/dsys_trace.h"
 
 #define DSIM_MAX_SYSTEMS 64u
 
@@ -83,6 +84,7 @@ int d_sim_step(d_sim_context *ctx, u32 ticks) {
 
         dsys_perf_tick_begin((dom_act_time_t)ctx->tick_index, (u64)ctx->tick_index);
         dsys_perf_timer_begin(&sim_timer, DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_SIM_TICK_US);
+        dsys_trace_tick_begin((u64)ctx->tick_index);
 
         /* 0) Deterministic network command application for this tick. */
         (void)d_net_apply_for_tick(ctx->world, ctx->tick_index);
@@ -92,17 +94,24 @@ int d_sim_step(d_sim_context *ctx, u32 ticks) {
         for (i = 0u; i < subsystem_count; ++i) {
             const d_subsystem_desc *desc = d_subsystem_get_by_index(i);
             if (desc && desc->tick) {
+                const char *span = desc->name ? desc->name : "subsystem";
+                DSYS_TRACE_BEGIN(span, desc->subsystem_id);
                 desc->tick(ctx->world, 1u);
+                DSYS_TRACE_END(span);
             }
         }
 
         /* 2) Local dsim systems. */
         for (i = 0u; i < g_dsim_system_count; ++i) {
             if (g_dsim_systems[i].tick) {
+                const char *span = g_dsim_systems[i].name ? g_dsim_systems[i].name : "dsim_system";
+                DSYS_TRACE_BEGIN(span, g_dsim_systems[i].system_id);
                 g_dsim_systems[i].tick(ctx, 1u);
+                DSYS_TRACE_END(span);
             }
         }
 
+        (void)dsys_trace_tick_end();
         dsys_perf_timer_end(&sim_timer);
         dsys_perf_tick_end();
     }
@@ -11,6 +11,7 @@ DETERMINISM: Stable ordering by (due_tick, stable_key, event_id).
 */
 #include "domino/sim/dg_due_sched.h"
 #include "domino/system/dsys_perf.h"
+#include "domino/system/dsys_trace.h"
 
 #include <string.h>
 
@@ -29,6 +30,7 @@ static int dg_due_schedule_event(dg_due_scheduler* sched, u32 handle, dom_act_ti
 {
     dom_time_event ev;
     dom_time_event_id id;
+    u32 event_handle;
     int rc;
     dg_due_entry* entry;
 
@@ -47,15 +49,42 @@ static int dg_due_schedule_event(dg_due_scheduler* sched, u32 handle, dom_act_ti
     ev.trigger_time = due;
     ev.order_key = entry->stable_key;
     ev.payload_id = (u64)handle;
-    rc = dom_time_event_schedule(&sched->queue, &ev);
+    rc = dom_time_event_schedule_handle(&sched->queue, &ev, &event_handle);
     if (rc != DOM_TIME_OK) {
         return DG_DUE_FULL;
     }
     entry->event_id = id;
+    entry->event_handle = event_handle;
     entry->next_due = due;
     return DG_DUE_OK;
 }
 
+static void dg_due_cancel_event(dg_due_scheduler* sched, dg_due_entry* entry)
+{
+    if (entry->event_id != 0u) {
+        (void)dom_time_event_cancel_handle(&sched->queue, entry->event_handle, entry->event_id);
+    }
+    entry->event_id = 0u;
+    entry->event_handle = DOM_TIME_EVENT_HANDLE_NONE;
+}
+
+static int dg_due_scheduler_init_common(dg_due_scheduler* sched,
+                                        dg_due_entry* entry_storage,
+                                        u32 entry_capacity,
+                                        dom_act_time_t start_tick)
+{
+    int rc = dom_time_event_id_init(&sched->id_gen, 1u);
+    if (rc != DOM_TIME_OK) {
+        return DG_DUE_ERR;
+    }
+    sched->current_tick = start_tick;
+    sched->entries = entry_storage;
+    sched->entry_capacity = entry_capacity;
+    sched->entry_count = 0u;
+    memset(entry_storage, 0, sizeof(dg_due_entry) * entry_capacity);
+    return DG_DUE_OK;
+}
+
 int dg_due_scheduler_init(dg_due_scheduler* sched,
                           dom_time_event* event_storage,
                           u32 event_capacity,
@@ -71,16 +100,26 @@ int dg_due_scheduler_init(dg_due_scheduler* sched,
     if (rc != DOM_TIME_OK) {
         return DG_DUE_ERR;
     }
-    rc = dom_time_event_id_init(&sched->id_gen, 1u);
+    return dg_due_scheduler_init_common(sched, entry_storage, entry_capacity, start_tick);
+}
+
+int dg_due_scheduler_init_wheel(dg_due_scheduler* sched,
+                                dom_time_wheel* wheel,
+                                dom_time_wheel_node* event_nodes,
+                                u32 event_capacity,
+                                dg_due_entry* entry_storage,
+                                u32 entry_capacity,
+                                dom_act_time_t start_tick)
+{
+    int rc;
+    if (!sched || !wheel || !event_nodes || !entry_storage || event_capacity == 0u || entry_capacity == 0u) {
+        return DG_DUE_INVALID;
+    }
+    rc = dom_time_event_queue_init_wheel(&sched->queue, wheel, event_nodes, event_capacity, start_tick);
     if (rc != DOM_TIME_OK) {
         return DG_DUE_ERR;
     }
-    sched->current_tick = start_tick;
-    sched->entries = entry_storage;
-    sched->entry_capacity = entry_capacity;
-    sched->entry_count = 0u;
-    memset(entry_storage, 0, sizeof(dg_due_entry) * entry_capacity);
-    return DG_DUE_OK;
+    return dg_due_scheduler_init_common(sched, entry_storage, entry_capacity, start_tick);
 }
 
 int dg_due_scheduler_register(dg_due_scheduler* sched,
@@ -108,6 +147,7 @@ int dg_due_scheduler_register(dg_due_scheduler* sched,
             entry->vtable = *vtable;
             entry->next_due = DG_DUE_TICK_NONE;
             entry->event_id = 0u;
+            entry->event_handle = DOM_TIME_EVENT_HANDLE_NONE;
             entry->in_use = 1;
             sched->entry_count += 1u;
             if (out_handle) {
@@ -129,9 +169,7 @@ int dg_due_scheduler_unregister(dg_due_scheduler* sched, u32 handle)
     if (!entry->in_use) {
         return DG_DUE_NOT_FOUND;
     }
-    if (entry->event_id != 0u) {
-        (void)dom_time_event_cancel(&sched->queue, entry->event_id);
-    }
+    dg_due_cancel_event(sched, entry);
     memset(entry, 0, sizeof(*entry));
     if (sched->entry_count > 0u) {
         sched->entry_count -= 1u;
@@ -153,10 +191,7 @@ int dg_due_scheduler_refresh(dg_due_scheduler* sched, u32 handle)
     }
     due = entry->vtable.get_next_due_tick(entry->user, sched->current_tick);
     if (due == DG_DUE_TICK_NONE) {
-        if (entry->event_id != 0u) {
-            (void)dom_time_event_cancel(&sched->queue, entry->event_id);
-        }
-        entry->event_id = 0u;
+        dg_due_cancel_event(sched, entry);
         entry->next_due = DG_DUE_TICK_NONE;
         return DG_DUE_OK;
     }
@@ -164,30 +199,19 @@ int dg_due_scheduler_refresh(dg_due_scheduler* sched, u32 handle)
         due = sched->current_tick;
         rc = DG_DUE_BACKWARDS;
     }
-    if (entry->event_id != 0u) {
-        (void)dom_time_event_cancel(&sched->queue, entry->event_id);
-        entry->event_id = 0u;
-    }
+    dg_due_cancel_event(sched, entry);
     if (dg_due_schedule_event(sched, handle, due) != DG_DUE_OK) {
         return DG_DUE_FULL;
     }
     return rc;
 }
 
-int dg_due_scheduler_advance(dg_due_scheduler* sched, dom_act_time_t target_tick)
+static int dg_due_scheduler_process_due(dg_due_scheduler* sched,
+                                        dom_act_time_t target_tick,
+                                        u32* out_processed)
 {
     dom_time_event ev;
     int rc;
-    u32 processed = 0u;
-    u32 pending = 0u;
-    dsys_perf_timer sched_timer;
-    if (!sched) {
-        return DG_DUE_INVALID;
-    }
-    if (target_tick < sched->current_tick) {
-        return DG_DUE_BACKWARDS;
-    }
-    dsys_perf_timer_begin(&sched_timer, DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_MACRO_SCHED_US);
     while (dom_time_event_peek(&sched->queue, &ev) == DOM_TIME_OK) {
         u32 handle;
         dg_due_entry* entry;
@@ -207,14 +231,17 @@ int dg_due_scheduler_advance(dg_due_scheduler* sched, dom_act_time_t target_tick
             continue;
         }
         entry->event_id = 0u;
+        entry->event_handle = DOM_TIME_EVENT_HANDLE_NONE;
         if (!dg_due_entry_is_valid(entry)) {
             return DG_DUE_INVALID;
         }
+        DSYS_TRACE_BEGIN("due.process", entry->stable_key);
         rc = entry->vtable.process_until(entry->user, target_tick);
+        DSYS_TRACE_END("due.process");
         if (rc != 0) {
             return DG_DUE_ERR;
         }
-        processed += 1u;
+        *out_processed += 1u;
         rc = dg_due_scheduler_refresh(sched, handle);
         if (rc == DG_DUE_BACKWARDS) {
             return rc;
@@ -223,6 +250,28 @@ int dg_due_scheduler_advance(dg_due_scheduler* sched, dom_act_time_t target_tick
             return rc;
         }
     }
+    return DG_DUE_OK;
+}
+
+int dg_due_scheduler_advance(dg_due_scheduler* sched, dom_act_time_t target_tick)
+{
+    int rc;
+    u32 processed = 0u;
+    u32 pending = 0u;
+    dsys_perf_timer sched_timer;
+    if (!sched) {
+        return DG_DUE_INVALID;
+    }
+    if (target_tick < sched->current_tick) {
+        return DG_DUE_BACKWARDS;
+    }
+    dsys_perf_timer_begin(&sched_timer, DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_MACRO_SCHED_US);
+    DSYS_TRACE_BEGIN("due.advance", target_tick);
+    rc = dg_due_scheduler_process_due(sched, target_tick, &processed);
+    DSYS_TRACE_END("due.advance");
+    if (rc != DG_DUE_OK) {
+        return rc;
+    }
     dsys_perf_timer_end(&sched_timer);
     if (processed > 0u) {
         dsys_perf_metric_add(DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_MACRO_EVENTS, processed);
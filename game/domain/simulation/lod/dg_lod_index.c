@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include "dg_lod_index.h"
 
 #include "det_invariants.h"
+#include "dg_det_hash.h"
 
 /* Quantize stored positions to deterministic quanta (q16_16).
  * 1/16m resolution by default (power-of-two shift).
@@ -36,65 +37,65 @@ static dg_lod_obj_pos dg_lod_quantize_pos(dg_lod_obj_pos p) {
     return p;
 }
 
+#define DG_LOD_CHUNK_MIN_CAPACITY 8u
+#define DG_LOD_SLOT_MIN_CAPACITY 16u
+
 static int dg_lod_cmp_u64(u64 a, u64 b) {
     if (a < b) return -1;
     if (a > b) return 1;
     return 0;
 }
 
+/* Order within a chunk: (class_id, domain_id, entity_id, sub_id). */
 static int dg_lod_entry_cmp_fields(
-    dg_chunk_id chunk_id,
     dg_lod_class_id class_id,
-    dg_domain_id domain_id,
-    dg_entity_id entity_id,
-    u64 sub_id,
+    const dg_lod_obj_key *key,
     const dg_lod_index_entry *e
 ) {
     int c;
-    if (!e) return 1;
-    c = dg_lod_cmp_u64((u64)chunk_id, (u64)e->chunk_id);
-    if (c) return c;
     c = dg_lod_cmp_u64((u64)class_id, (u64)e->class_id);
     if (c) return c;
-    c = dg_lod_cmp_u64((u64)domain_id, (u64)e->key.domain_id);
+    c = dg_lod_cmp_u64((u64)key->domain_id, (u64)e->key.domain_id);
+    if (c) return c;
+    c = dg_lod_cmp_u64((u64)key->entity_id, (u64)e->key.entity_id);
     if (c) return c;
-    c = dg_lod_cmp_u64((u64)entity_id, (u64)e->key.entity_id);
+    return dg_lod_cmp_u64(key->sub_id, e->key.sub_id);
+}
+
+static int dg_lod_op_cmp(const dg_lod_index_op *a, const dg_lod_index_op *b) {
+    int c = dg_lod_cmp_u64((u64)a->chunk_id, (u64)b->chunk_id);
     if (c) return c;
-    c = dg_lod_cmp_u64(sub_id, e->key.sub_id);
+    c = dg_lod_cmp_u64((u64)a->class_id, (u64)b->class_id);
     if (c) return c;
-    return 0;
+    c = dg_lod_cmp_u64((u64)a->key.domain_id, (u64)b->key.domain_id);
+    if (c) return c;
+    c = dg_lod_cmp_u64((u64)a->key.entity_id, (u64)b->key.entity_id);
+    if (c) return c;
+    return dg_lod_cmp_u64(a->key.sub_id, b->key.sub_id);
 }
 
-static u32 dg_lod_lower_bound(const dg_lod_index *idx, dg_chunk_id chunk_id, dg_lod_class_id class_id, const dg_lod_obj_key *key) {
+static u32 dg_lod_lower_bound(const dg_lod_index_chunk *ch, dg_lod_class_id class_id, const dg_lod_obj_key *key) {
     u32 lo = 0u;
-    u32 hi;
+    u32 hi = ch->count;
     u32 mid;
-    if (!idx) return 0u;
-    hi = idx->count;
     while (lo < hi) {
         mid = lo + ((hi - lo) / 2u);
-        {
-            const dg_lod_index_entry *e = &idx->entries[mid];
-            int c = dg_lod_entry_cmp_fields(chunk_id, class_id, key ? key->domain_id : 0u, key ? key->entity_id : 0u, key ? key->sub_id : 0u, e);
-            if (c <= 0) {
-                hi = mid;
-            } else {
-                lo = mid + 1u;
-            }
+        if (dg_lod_entry_cmp_fields(class_id, key, &ch->entries[mid]) <= 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1u;
         }
     }
     return lo;
 }
 
-static u32 dg_lod_lower_bound_chunk(const dg_lod_index *idx, dg_chunk_id chunk_id) {
+static u32 dg_lod_lower_bound_class(const dg_lod_index_chunk *ch, dg_lod_class_id class_id) {
     u32 lo = 0u;
-    u32 hi;
+    u32 hi = ch->count;
     u32 mid;
-    if (!idx) return 0u;
-    hi = idx->count;
     while (lo < hi) {
         mid = lo + ((hi - lo) / 2u);
-        if (idx->entries[mid].chunk_id >= chunk_id) {
+        if (ch->entries[mid].class_id >= class_id) {
             hi = mid;
         } else {
             lo = mid + 1u;
@@ -103,30 +104,196 @@ static u32 dg_lod_lower_bound_chunk(const dg_lod_index *idx, dg_chunk_id chunk_i
     return lo;
 }
 
-static u32 dg_lod_lower_bound_chunk_class(const dg_lod_index *idx, dg_chunk_id chunk_id, dg_lod_class_id class_id) {
+static u32 dg_lod_slot_home(const dg_lod_index *idx, dg_chunk_id chunk_id) {
+    return (u32)dg_det_hash_u64((u64)chunk_id) & (idx->slot_capacity - 1u);
+}
+
+/* Returns the slot holding chunk_id, or the empty slot where it would go. */
+static u32 dg_lod_slot_find(const dg_lod_index *idx, dg_chunk_id chunk_id) {
+    u32 mask = idx->slot_capacity - 1u;
+    u32 s = dg_lod_slot_home(idx, chunk_id);
+    while (idx->chunk_slots[s] != 0u &&
+           idx->chunks[idx->chunk_slots[s] - 1u].chunk_id != chunk_id) {
+        s = (s + 1u) & mask;
+    }
+    return s;
+}
+
+static dg_lod_index_chunk *dg_lod_chunk_find(const dg_lod_index *idx, dg_chunk_id chunk_id) {
+    u32 s;
+    if (idx->chunk_count == 0u) {
+        return (dg_lod_index_chunk *)0;
+    }
+    s = dg_lod_slot_find(idx, chunk_id);
+    if (idx->chunk_slots[s] == 0u) {
+        return (dg_lod_index_chunk *)0;
+    }
+    return &idx->chunks[idx->chunk_slots[s] - 1u];
+}
+
+static int dg_lod_slots_rebuild(dg_lod_index *idx, u32 slot_capacity) {
+    u32 *slots;
+    u32 i;
+    slots = (u32 *)malloc(sizeof(u32) * (size_t)slot_capacity);
+    if (!slots) {
+        return -1;
+    }
+    memset(slots, 0, sizeof(u32) * (size_t)slot_capacity);
+    if (idx->chunk_slots) {
+        free(idx->chunk_slots);
+    }
+    idx->chunk_slots = slots;
+    idx->slot_capacity = slot_capacity;
+    for (i = 0u; i < idx->chunk_count; ++i) {
+        idx->chunk_slots[dg_lod_slot_find(idx, idx->chunks[i].chunk_id)] = i + 1u;
+    }
+    return 0;
+}
+
+/* Creates an empty chunk bucket; the caller fills it before returning. */
+static dg_lod_index_chunk *dg_lod_chunk_create(dg_lod_index *idx, dg_chunk_id chunk_id) {
+    dg_lod_index_chunk *ch;
     u32 lo = 0u;
     u32 hi;
-    u32 mid;
-    if (!idx) return 0u;
-    hi = idx->count;
+    if (idx->chunk_count >= idx->chunk_capacity) {
+        u32 cap = idx->chunk_capacity ? (idx->chunk_capacity * 2u) : DG_LOD_CHUNK_MIN_CAPACITY;
+        dg_lod_index_chunk *chunks;
+        dg_chunk_id *order;
+        chunks = (dg_lod_index_chunk *)realloc(idx->chunks, sizeof(dg_lod_index_chunk) * (size_t)cap);
+        if (!chunks) {
+            return (dg_lod_index_chunk *)0;
+        }
+        idx->chunks = chunks;
+        order = (dg_chunk_id *)realloc(idx->chunk_order, sizeof(dg_chunk_id) * (size_t)cap);
+        if (!order) {
+            return (dg_lod_index_chunk *)0;
+        }
+        idx->chunk_order = order;
+        idx->chunk_capacity = cap;
+    }
+    if ((idx->chunk_count + 1u) * 2u > idx->slot_capacity) {
+        u32 cap = idx->slot_capacity ? (idx->slot_capacity * 2u) : DG_LOD_SLOT_MIN_CAPACITY;
+        if (dg_lod_slots_rebuild(idx, cap) != 0) {
+            return (dg_lod_index_chunk *)0;
+        }
+    }
+
+    ch = &idx->chunks[idx->chunk_count];
+    memset(ch, 0, sizeof(*ch));
+    ch->chunk_id = chunk_id;
+    idx->chunk_slots[dg_lod_slot_find(idx, chunk_id)] = idx->chunk_count + 1u;
+
+    hi = idx->chunk_count;
     while (lo < hi) {
-        mid = lo + ((hi - lo) / 2u);
-        {
-            const dg_lod_index_entry *e = &idx->entries[mid];
-            if (e->chunk_id > chunk_id) {
-                hi = mid;
-            } else if (e->chunk_id < chunk_id) {
-                lo = mid + 1u;
-            } else {
-                if (e->class_id >= class_id) {
-                    hi = mid;
-                } else {
-                    lo = mid + 1u;
-                }
-            }
+        u32 mid = lo + ((hi - lo) / 2u);
+        if (idx->chunk_order[mid] < chunk_id) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
         }
     }
-    return lo;
+    if (lo < idx->chunk_count) {
+        memmove(&idx->chunk_order[lo + 1u], &idx->chunk_order[lo],
+                sizeof(dg_chunk_id) * (size_t)(idx->chunk_count - lo));
+    }
+    idx->chunk_order[lo] = chunk_id;
+    idx->chunk_count += 1u;
+    return ch;
+}
+
+/* Drops an empty chunk bucket: backward-shift delete from the hash, then
+ * move the last bucket into its place.
+ */
+static void dg_lod_chunk_destroy(dg_lod_index *idx, dg_lod_index_chunk *ch) {
+    u32 mask = idx->slot_capacity - 1u;
+    u32 pos = (u32)(ch - idx->chunks);
+    u32 last = idx->chunk_count - 1u;
+    dg_chunk_id chunk_id = ch->chunk_id;
+    u32 hole = dg_lod_slot_find(idx, chunk_id);
+    u32 s = (hole + 1u) & mask;
+    u32 lo = 0u;
+    u32 hi = idx->chunk_count;
+
+    idx->chunk_slots[hole] = 0u;
+    while (idx->chunk_slots[s] != 0u) {
+        u32 home = dg_lod_slot_home(idx, idx->chunks[idx->chunk_slots[s] - 1u].chunk_id);
+        /* Move the entry back if the hole lies on its probe path. */
+        if (((s - home) & mask) >= ((s - hole) & mask)) {
+            idx->chunk_slots[hole] = idx->chunk_slots[s];
+            idx->chunk_slots[s] = 0u;
+            hole = s;
+        }
+        s = (s + 1u) & mask;
+    }
+
+    if (ch->entries) {
+        free(ch->entries);
+    }
+    if (pos != last) {
+        idx->chunks[pos] = idx->chunks[last];
+        idx->chunk_slots[dg_lod_slot_find(idx, idx->chunks[pos].chunk_id)] = pos + 1u;
+    }
+
+    while (lo < hi) {
+        u32 mid = lo + ((hi - lo) / 2u);
+        if (idx->chunk_order[mid] < chunk_id) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo + 1u < idx->chunk_count) {
+        memmove(&idx->chunk_order[lo], &idx->chunk_order[lo + 1u],
+                sizeof(dg_chunk_id) * (size_t)(idx->chunk_count - (lo + 1u)));
+    }
+    idx->chunk_count -= 1u;
+}
+
+static int dg_lod_chunk_grow(dg_lod_index_chunk *ch, u32 min_capacity) {
+    dg_lod_index_entry *e;
+    u32 cap = ch->capacity ? ch->capacity : DG_LOD_CHUNK_MIN_CAPACITY;
+    if (ch->capacity >= min_capacity) {
+        return 0;
+    }
+    while (cap < min_capacity) {
+        cap *= 2u;
+    }
+    e = (dg_lod_index_entry *)realloc(ch->entries, sizeof(dg_lod_index_entry) * (size_t)cap);
+    if (!e) {
+        return -1;
+    }
+    ch->entries = e;
+    ch->capacity = cap;
+    return 0;
+}
+
+static void dg_lod_entry_fill(
+    dg_lod_index_entry   *e,
+    dg_chunk_id           chunk_id,
+    const dg_lod_obj_key *obj_key,
+    dg_lod_obj_pos        qp,
+    dg_lod_class_id       class_id
+) {
+    memset(e, 0, sizeof(*e));
+    e->chunk_id = chunk_id;
+    e->class_id = class_id;
+    e->key = *obj_key;
+    e->key.chunk_id = chunk_id;
+    e->pos = qp;
+}
+
+static void dg_lod_index_release(dg_lod_index *idx) {
+    u32 i;
+    for (i = 0u; i < idx->chunk_count; ++i) {
+        if (idx->chunks[i].entries) {
+            free(idx->chunks[i].entries);
+        }
+    }
+    idx->chunk_count = 0u;
+    if (idx->chunk_slots) {
+        memset(idx->chunk_slots, 0, sizeof(u32) * (size_t)idx->slot_capacity);
+    }
+    idx->count = 0u;
 }
 
 void dg_lod_index_init(dg_lod_index *idx) {
@@ -140,30 +307,29 @@ void dg_lod_index_free(dg_lod_index *idx) {
     if (!idx) {
         return;
     }
-    if (idx->owns_storage && idx->entries) {
-        free(idx->entries);
+    dg_lod_index_release(idx);
+    if (idx->chunks) {
+        free(idx->chunks);
+    }
+    if (idx->chunk_order) {
+        free(idx->chunk_order);
+    }
+    if (idx->chunk_slots) {
+        free(idx->chunk_slots);
+    }
+    if (idx->scratch) {
+        free(idx->scratch);
     }
     dg_lod_index_init(idx);
 }
 
+/* Chunk runs grow on demand; capacity only bounds the total entry count. */
 int dg_lod_index_reserve(dg_lod_index *idx, u32 capacity) {
-    dg_lod_index_entry *e;
     if (!idx) {
         return -1;
     }
     dg_lod_index_free(idx);
-    if (capacity == 0u) {
-        return 0;
-    }
-    e = (dg_lod_index_entry *)malloc(sizeof(dg_lod_index_entry) * (size_t)capacity);
-    if (!e) {
-        return -2;
-    }
-    memset(e, 0, sizeof(dg_lod_index_entry) * (size_t)capacity);
-    idx->entries = e;
     idx->capacity = capacity;
-    idx->count = 0u;
-    idx->owns_storage = D_TRUE;
     idx->probe_refused = 0u;
     return 0;
 }
@@ -172,7 +338,7 @@ void dg_lod_index_clear(dg_lod_index *idx) {
     if (!idx) {
         return;
     }
-    idx->count = 0u;
+    dg_lod_index_release(idx);
 }
 
 u32 dg_lod_index_count(const dg_lod_index *idx) {
@@ -195,10 +361,10 @@ int dg_lod_index_add(
     dg_lod_class_id       class_id
 ) {
     u32 pos;
-    dg_lod_index_entry *e;
+    dg_lod_index_chunk *ch;
     dg_lod_obj_pos qp;
 
-    if (!idx || !idx->entries || idx->capacity == 0u) {
+    if (!idx || idx->capacity == 0u) {
         return -1;
     }
     if (!obj_key || !obj_pos) {
@@ -214,12 +380,14 @@ int dg_lod_index_add(
     qp = *obj_pos;
     qp = dg_lod_quantize_pos(qp);
 
-    pos = dg_lod_lower_bound(idx, chunk_id, class_id, obj_key);
-    if (pos < idx->count) {
-        e = &idx->entries[pos];
-        if (dg_lod_entry_cmp_fields(chunk_id, class_id, obj_key->domain_id, obj_key->entity_id, obj_key->sub_id, e) == 0) {
+    ch = dg_lod_chunk_find(idx, chunk_id);
+    pos = 0u;
+    if (ch) {
+        pos = dg_lod_lower_bound(ch, class_id, obj_key);
+        if (pos < ch->count &&
+            dg_lod_entry_cmp_fields(class_id, obj_key, &ch->entries[pos]) == 0) {
             /* Update in place. */
-            e->pos = qp;
+            ch->entries[pos].pos = qp;
             return 1;
         }
     }
@@ -229,18 +397,24 @@ int dg_lod_index_add(
         return -5;
     }
 
-    if (pos < idx->count) {
-        memmove(&idx->entries[pos + 1u], &idx->entries[pos],
-                sizeof(dg_lod_index_entry) * (size_t)(idx->count - pos));
+    if (!ch) {
+        ch = dg_lod_chunk_create(idx, chunk_id);
+        if (!ch) {
+            return -6;
+        }
     }
-
-    e = &idx->entries[pos];
-    memset(e, 0, sizeof(*e));
-    e->chunk_id = chunk_id;
-    e->class_id = class_id;
-    e->key = *obj_key;
-    e->key.chunk_id = chunk_id;
-    e->pos = qp;
+    if (dg_lod_chunk_grow(ch, ch->count + 1u) != 0) {
+        if (ch->count == 0u) {
+            dg_lod_chunk_destroy(idx, ch);
+        }
+        return -6;
+    }
+    if (pos < ch->count) {
+        memmove(&ch->entries[pos + 1u], &ch->entries[pos],
+                sizeof(dg_lod_index_entry) * (size_t)(ch->count - pos));
+    }
+    dg_lod_entry_fill(&ch->entries[pos], chunk_id, obj_key, qp, class_id);
+    ch->count += 1u;
     idx->count += 1u;
     return 0;
 }
@@ -252,8 +426,9 @@ int dg_lod_index_remove(
     dg_lod_class_id       class_id
 ) {
     u32 pos;
+    dg_lod_index_chunk *ch;
 
-    if (!idx || !idx->entries) {
+    if (!idx || idx->capacity == 0u) {
         return -1;
     }
     if (!obj_key) {
@@ -263,22 +438,182 @@ int dg_lod_index_remove(
         return -3;
     }
 
-    pos = dg_lod_lower_bound(idx, chunk_id, class_id, obj_key);
-    if (pos >= idx->count) {
+    ch = dg_lod_chunk_find(idx, chunk_id);
+    if (!ch) {
         return 1;
     }
-    if (dg_lod_entry_cmp_fields(chunk_id, class_id, obj_key->domain_id, obj_key->entity_id, obj_key->sub_id, &idx->entries[pos]) != 0) {
+    pos = dg_lod_lower_bound(ch, class_id, obj_key);
+    if (pos >= ch->count) {
+        return 1;
+    }
+    if (dg_lod_entry_cmp_fields(class_id, obj_key, &ch->entries[pos]) != 0) {
         return 1;
     }
 
-    if (pos + 1u < idx->count) {
-        memmove(&idx->entries[pos], &idx->entries[pos + 1u],
-                sizeof(dg_lod_index_entry) * (size_t)(idx->count - (pos + 1u)));
+    if (pos + 1u < ch->count) {
+        memmove(&ch->entries[pos], &ch->entries[pos + 1u],
+                sizeof(dg_lod_index_entry) * (size_t)(ch->count - (pos + 1u)));
     }
+    ch->count -= 1u;
     idx->count -= 1u;
+    if (ch->count == 0u) {
+        dg_lod_chunk_destroy(idx, ch);
+    }
     return 0;
 }
 
+/* Merge one chunk's ops[0..op_count) (same chunk_id) into its run, writing
+ * into idx->scratch and swapping the buffers. Returns adds refused, or <0.
+ */
+static int dg_lod_index_merge_chunk(dg_lod_index *idx, const dg_lod_index_op *ops, u32 op_count) {
+    dg_chunk_id chunk_id = ops[0].chunk_id;
+    dg_lod_index_chunk *ch = dg_lod_chunk_find(idx, chunk_id);
+    const dg_lod_index_entry *src = ch ? ch->entries : (const dg_lod_index_entry *)0;
+    u32 src_count = ch ? ch->count : 0u;
+    u32 si = 0u;
+    u32 out = 0u;
+    u32 adds = 0u;
+    u32 i;
+    int refused = 0;
+    dg_lod_index_entry *dst;
+
+    for (i = 0u; i < op_count; ++i) {
+        if (ops[i].kind == (u32)DG_LOD_INDEX_OP_ADD) {
+            adds += 1u;
+        }
+    }
+    if (adds == 0u && !ch) {
+        return 0;
+    }
+    if (idx->scratch_capacity < src_count + adds) {
+        u32 cap = idx->scratch_capacity ? idx->scratch_capacity : DG_LOD_CHUNK_MIN_CAPACITY;
+        dg_lod_index_entry *e;
+        while (cap < src_count + adds) {
+            cap *= 2u;
+        }
+        e = (dg_lod_index_entry *)realloc(idx->scratch, sizeof(dg_lod_index_entry) * (size_t)cap);
+        if (!e) {
+            return -6;
+        }
+        idx->scratch = e;
+        idx->scratch_capacity = cap;
+    }
+    dst = idx->scratch;
+
+    i = 0u;
+    while (i < op_count) {
+        const dg_lod_index_op *op = &ops[i];
+        dg_lod_index_entry cur;
+        d_bool have = D_FALSE;
+
+        while (si < src_count && dg_lod_entry_cmp_fields(op->class_id, &op->key, &src[si]) > 0) {
+            dst[out++] = src[si++];
+        }
+        if (si < src_count && dg_lod_entry_cmp_fields(op->class_id, &op->key, &src[si]) == 0) {
+            cur = src[si++];
+            have = D_TRUE;
+        }
+        /* Every op on this object, in list order. */
+        do {
+            if (ops[i].kind == (u32)DG_LOD_INDEX_OP_ADD) {
+                dg_lod_obj_pos qp = dg_lod_quantize_pos(ops[i].pos);
+                if (have) {
+                    cur.pos = qp;
+                } else if (idx->count >= idx->capacity) {
+                    idx->probe_refused += 1u;
+                    refused += 1;
+                } else {
+                    dg_lod_entry_fill(&cur, chunk_id, &ops[i].key, qp, ops[i].class_id);
+                    have = D_TRUE;
+                    idx->count += 1u;
+                }
+            } else if (have) {
+                have = D_FALSE;
+                idx->count -= 1u;
+            }
+            i += 1u;
+        } while (i < op_count && dg_lod_op_cmp(&ops[i], op) == 0);
+        if (have) {
+            dst[out++] = cur;
+        }
+    }
+    while (si < src_count) {
+        dst[out++] = src[si++];
+    }
+
+    if (out == 0u) {
+        if (ch) {
+            dg_lod_chunk_destroy(idx, ch);
+        }
+        return refused;
+    }
+    if (!ch) {
+        ch = dg_lod_chunk_create(idx, chunk_id);
+        if (!ch) {
+            /* Undo the count for entries that could not be stored. */
+            idx->count -= out;
+            return -6;
+        }
+    }
+    {
+        dg_lod_index_entry *old_entries = ch->entries;
+        u32 old_capacity = ch->capacity;
+        ch->entries = dst;
+        ch->capacity = idx->scratch_capacity;
+        ch->count = out;
+        idx->scratch = old_entries;
+        idx->scratch_capacity = old_capacity;
+    }
+    return refused;
+}
+
+int dg_lod_index_apply_batch(dg_lod_index *idx, const dg_lod_index_op *ops, u32 op_count) {
+    u32 i;
+    u32 start;
+    int refused = 0;
+
+    if (!idx || idx->capacity == 0u) {
+        return -1;
+    }
+    if (op_count == 0u) {
+        return 0;
+    }
+    if (!ops) {
+        return -2;
+    }
+    for (i = 0u; i < op_count; ++i) {
+        const dg_lod_index_op *op = &ops[i];
+        if (op->chunk_id == 0u) {
+            return -3;
+        }
+        if (op->key.chunk_id != 0u && op->key.chunk_id != op->chunk_id) {
+            return -4;
+        }
+        if (op->kind != (u32)DG_LOD_INDEX_OP_ADD && op->kind != (u32)DG_LOD_INDEX_OP_REMOVE) {
+            return -2;
+        }
+        if (i > 0u && dg_lod_op_cmp(&ops[i - 1u], op) > 0) {
+            return -7;
+        }
+    }
+
+    start = 0u;
+    while (start < op_count) {
+        u32 end = start + 1u;
+        int rc;
+        while (end < op_count && ops[end].chunk_id == ops[start].chunk_id) {
+            end += 1u;
+        }
+        rc = dg_lod_index_merge_chunk(idx, &ops[start], end - start);
+        if (rc < 0) {
+            return rc;
+        }
+        refused += rc;
+        start = end;
+    }
+    return refused;
+}
+
 u32 dg_lod_index_query(
     const dg_lod_index *idx,
     dg_chunk_id         chunk_id,
@@ -288,47 +623,31 @@ u32 dg_lod_index_query(
 ) {
     u32 written = 0u;
     u32 i;
-    u32 start;
+    const dg_lod_index_chunk *ch;
 
-    if (!idx || !idx->entries || max_out == 0u || !out_candidates) {
+    if (!idx || max_out == 0u || !out_candidates) {
         return 0u;
     }
     if (chunk_id == 0u) {
         return 0u;
     }
+    ch = dg_lod_chunk_find(idx, chunk_id);
+    if (!ch) {
+        return 0u;
+    }
 
-    if (class_id == 0u) {
-        start = dg_lod_lower_bound_chunk(idx, chunk_id);
-        for (i = start; i < idx->count; ++i) {
-            const dg_lod_index_entry *e = &idx->entries[i];
-            if (e->chunk_id != chunk_id) {
-                break;
-            }
-            out_candidates[written].key = e->key;
-            out_candidates[written].pos = e->pos;
-            out_candidates[written].class_id = e->class_id;
-            written += 1u;
-            if (written >= max_out) {
-                break;
-            }
+    i = (class_id == 0u) ? 0u : dg_lod_lower_bound_class(ch, class_id);
+    for (; i < ch->count; ++i) {
+        const dg_lod_index_entry *e = &ch->entries[i];
+        if (class_id != 0u && e->class_id != class_id) {
+            break;
         }
-    } else {
-        start = dg_lod_lower_bound_chunk_class(idx, chunk_id, class_id);
-        for (i = start; i < idx->count; ++i) {
-            const dg_lod_index_entry *e = &idx->entries[i];
-            if (e->chunk_id != chunk_id) {
-                break;
-            }
-            if (e->class_id != class_id) {
-                break;
-            }
-            out_candidates[written].key = e->key;
-            out_candidates[written].pos = e->pos;
-            out_candidates[written].class_id = e->class_id;
-            written += 1u;
-            if (written >= max_out) {
-                break;
-            }
+        out_candidates[written].key = e->key;
+        out_candidates[written].pos = e->pos;
+        out_candidates[written].class_id = e->class_id;
+        written += 1u;
+        if (written >= max_out) {
+            break;
         }
     }
 
@@ -336,24 +655,14 @@ u32 dg_lod_index_query(
 }
 
 u32 dg_lod_index_collect_chunks(const dg_lod_index *idx, dg_chunk_id *out_chunks, u32 max_out) {
-    u32 written = 0u;
-    u32 i;
-    dg_chunk_id last = 0u;
+    u32 written;
 
-    if (!idx || !idx->entries || !out_chunks || max_out == 0u) {
+    if (!idx || !out_chunks || max_out == 0u) {
         return 0u;
     }
-
-    for (i = 0u; i < idx->count; ++i) {
-        dg_chunk_id cid = idx->entries[i].chunk_id;
-        if (i == 0u || cid != last) {
-            out_chunks[written++] = cid;
-            last = cid;
-            if (written >= max_out) {
-                break;
-            }
-        }
+    written = (idx->chunk_count < max_out) ? idx->chunk_count : max_out;
+    if (written > 0u) {
+        memcpy(out_chunks, idx->chunk_order, sizeof(dg_chunk_id) * (size_t)written);
     }
     return written;
 }
-
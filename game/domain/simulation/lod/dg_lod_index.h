@@ -57,14 +57,46 @@ typedef struct dg_lod_index_entry {
     dg_lod_obj_pos  pos;
 } dg_lod_index_entry;
 
-typedef struct dg_lod_index {
+/* One chunk's candidates, sorted by (class_id, key). */
+typedef struct dg_lod_index_chunk {
+    dg_chunk_id         chunk_id;
     dg_lod_index_entry *entries;
     u32                 count;
     u32                 capacity;
-    d_bool              owns_storage;
-    u32                 probe_refused; /* insert refusals due to capacity */
+} dg_lod_index_chunk;
+
+/* Two-level index: chunk buckets found through an open-addressed hash, each
+ * holding its own sorted run. Changes only move entries within one chunk.
+ * `capacity` bounds the total entry count across all chunks.
+ */
+typedef struct dg_lod_index {
+    dg_lod_index_chunk *chunks;          /* dense, unordered */
+    u32                 chunk_count;
+    u32                 chunk_capacity;
+    dg_chunk_id        *chunk_order;     /* live chunk ids, ascending */
+    u32                *chunk_slots;     /* chunks[] index + 1; 0 = empty */
+    u32                 slot_capacity;   /* power of two */
+    dg_lod_index_entry *scratch;         /* batch merge target, swapped into chunks */
+    u32                 scratch_capacity;
+    u32                 count;
+    u32                 capacity;
+    u32                 probe_refused;   /* insert refusals due to capacity */
 } dg_lod_index;
 
+typedef enum dg_lod_index_op_kind {
+    DG_LOD_INDEX_OP_ADD = 0,
+    DG_LOD_INDEX_OP_REMOVE = 1
+} dg_lod_index_op_kind;
+
+/* One entry of an apply_batch list (pos is ignored for removes). */
+typedef struct dg_lod_index_op {
+    u32             kind; /* dg_lod_index_op_kind */
+    dg_chunk_id     chunk_id;
+    dg_lod_class_id class_id;
+    dg_lod_obj_key  key;
+    dg_lod_obj_pos  pos;
+} dg_lod_index_op;
+
 void dg_lod_index_init(dg_lod_index *idx);
 void dg_lod_index_free(dg_lod_index *idx);
 
@@ -77,6 +109,7 @@ u32 dg_lod_index_probe_refused(const dg_lod_index *idx);
 
 /* Add/update an object entry (deterministic).
  * Returns 0 on success, <0 on error, >0 if updated-in-place.
+ * -5 is a capacity refusal (counted in probe_refused), -6 out of memory.
  */
 int dg_lod_index_add(
     dg_lod_index        *idx,
@@ -94,6 +127,15 @@ int dg_lod_index_remove(
     dg_lod_class_id      class_id
 );
 
+/* Apply adds/removes sorted by (chunk_id, class_id, key); ops on the same
+ * object keep their list order. Each touched chunk is rebuilt with one merge.
+ * The result equals calling add/remove for each op in list order.
+ * Returns 0 if every op applied, >0 = number of adds refused for capacity,
+ * <0 on error (bad arguments, unsorted list, invalid op, out of memory); on
+ * argument or ordering errors nothing is applied.
+ */
+int dg_lod_index_apply_batch(dg_lod_index *idx, const dg_lod_index_op *ops, u32 op_count);
+
 /* Query candidates in a chunk, optionally filtered by class_id.
  * If class_id == 0, returns all classes in the chunk.
  * Returns number written to out_candidates (<= max_out).
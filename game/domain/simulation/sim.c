@@ -453,19 +453,17 @@ static int d_world_extract_config(const d_tlv_blob *payload, d_world_config *out
     return -1;
 }
 
-d_world* d_world_clone(const d_world* world) {
+int d_world_save_image(const d_world* world, unsigned char** out_bytes, u32* out_len) {
     d_tlv_blob container;
-    d_tlv_blob world_payload;
-    d_world_config cfg;
-    u32 loaded_tick = 0u;
-    struct d_world* cloned = 0;
     int rc;
 
-    if (!world) {
-        return (d_world*)0;
+    if (!world || !out_bytes || !out_len) {
+        return -1;
     }
+    *out_bytes = (unsigned char*)0;
+    *out_len = 0u;
     if (!d_world_register_subsystem()) {
-        return (d_world*)0;
+        return -1;
     }
 
     container.ptr = (unsigned char*)0;
@@ -476,34 +474,60 @@ d_world* d_world_clone(const d_world* world) {
         if (container.ptr) {
             free(container.ptr);
         }
+        return -1;
+    }
+    *out_bytes = container.ptr;
+    *out_len = container.len;
+    return 0;
+}
+
+d_world* d_world_load_image(const unsigned char* bytes, u32 len) {
+    d_tlv_blob container;
+    d_tlv_blob world_payload;
+    d_world_config cfg;
+    u32 loaded_tick = 0u;
+    struct d_world* loaded = 0;
+
+    if (!bytes && len > 0u) {
+        return (d_world*)0;
+    }
+    if (!d_world_register_subsystem()) {
         return (d_world*)0;
     }
 
+    container.ptr = (unsigned char*)bytes;
+    container.len = len;
     if (d_world_find_payload(&container, &world_payload) != 0 ||
         d_world_extract_config(&world_payload, &cfg, &loaded_tick) != 0) {
-        if (container.ptr) {
-            free(container.ptr);
-        }
         return (d_world*)0;
     }
 
-    cloned = (struct d_world*)d_world_create_from_config(&cfg);
-    if (!cloned) {
-        if (container.ptr) {
-            free(container.ptr);
-        }
+    loaded = (struct d_world*)d_world_create_from_config(&cfg);
+    if (!loaded) {
         return (d_world*)0;
     }
-    cloned->tick_count = loaded_tick;
+    loaded->tick_count = loaded_tick;
+
+    if (d_serialize_load_instance_all(loaded, &container) != 0) {
+        d_world_destroy((d_world*)loaded);
+        loaded = 0;
+    }
+    return (d_world*)loaded;
+}
+
+d_world* d_world_clone(const d_world* world) {
+    unsigned char* bytes = (unsigned char*)0;
+    u32 len = 0u;
+    d_world* cloned;
 
-    if (d_serialize_load_instance_all(cloned, &container) != 0) {
-        d_world_destroy((d_world*)cloned);
-        cloned = 0;
+    if (d_world_save_image(world, &bytes, &len) != 0) {
+        return (d_world*)0;
     }
-    if (container.ptr) {
-        free(container.ptr);
+    cloned = d_world_load_image(bytes, len);
+    if (bytes) {
+        free(bytes);
     }
-    return (d_world*)cloned;
+    return cloned;
 }
 
 static d_world* d_world_load_v1(FILE *f) {
@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
 #include "domino/core/types.h"
 #include "domino/core/fixed.h"
 #include "domino/world/domain_query.h"
+#include "domino/world/domain_capsule_index.h"
 #include "domino/world/terrain_surface.h"
 #include "domino/world/geology_fields.h"
 
@@ -25,7 +26,7 @@ extern "C" {
 #endif
 
 #define DOM_CLIMATE_HIST_BINS 4u
-#define DOM_CLIMATE_MAX_CAPSULES 128u
+#define DOM_CLIMATE_MAX_CAPSULES 128u /* default capsule limit */
 #define DOM_CLIMATE_MAX_BIOMES 16u
 
 #define DOM_CLIMATE_UNKNOWN_Q16 ((q16_16)0x80000000)
@@ -155,25 +156,6 @@ typedef struct dom_climate_tile {
     u32 *wind_prevailing;
 } dom_climate_tile;
 
-typedef struct dom_climate_cache_entry {
-    dom_domain_id domain_id;
-    u64 tile_id;
-    u32 resolution;
-    u32 authoring_version;
-    u64 last_used;
-    u64 insert_order;
-    d_bool valid;
-    dom_climate_tile tile;
-} dom_climate_cache_entry;
-
-typedef struct dom_climate_cache {
-    dom_climate_cache_entry *entries;
-    u32 capacity;
-    u32 count;
-    u64 use_counter;
-    u64 next_insert_order;
-} dom_climate_cache;
-
 typedef struct dom_climate_macro_capsule {
     u64 capsule_id;
     u64 tile_id;
@@ -192,9 +174,11 @@ typedef struct dom_climate_domain {
     u32 existence_state;
     u32 archival_state;
     u32 authoring_version;
-    dom_climate_cache cache;
-    dom_climate_macro_capsule capsules[DOM_CLIMATE_MAX_CAPSULES];
+    dom_domain_cache cache;
+    dom_climate_macro_capsule* capsules;
     u32 capsule_count;
+    u32 capsule_capacity;
+    dom_domain_capsule_index capsule_index; /* limit starts at DOM_CLIMATE_MAX_CAPSULES */
 } dom_climate_domain;
 
 enum dom_climate_biome_rule_mask {
@@ -271,6 +255,12 @@ int dom_climate_sample_query(const dom_climate_domain* domain,
                              const dom_domain_point* point,
                              dom_domain_budget* budget,
                              dom_climate_sample* out_sample);
+/* Samples points->count points into out_samples. Results and budget use match
+ * calling dom_climate_sample_query for each point in order. */
+int dom_climate_sample_query_batch(const dom_climate_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   dom_domain_budget* budget,
+                                   dom_climate_sample* out_samples);
 
 int dom_climate_domain_collapse_tile(dom_climate_domain* domain,
                                      const dom_domain_tile_desc* desc);
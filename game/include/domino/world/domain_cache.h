@@ -64,7 +64,46 @@ extern "C" {
 
 
 
-typedef struct dom_domain_cache_entry {
+/* Shared tile cache for world field domains.
+
+
+ *
+
+
+ * Entries are keyed by (domain_id, tile_id, resolution, authoring_version)
+
+
+ * plus an optional time window for time-varying fields, looked up through a
+
+
+ * chained hash table and ordered by an intrusive LRU list. Tile payloads are
+
+
+ * stored by value in a slab sized by `tile_ops->tile_size`, so each field
+
+
+ * module keeps its own tile type; the default ops hold `dom_domain_tile`.
+
+
+ * Eviction picks the least recently used entry when the cache is full or the
+
+
+ * optional byte budget would be exceeded. Hits, misses and evictions are also
+
+
+ * reported through dsys_perf.
+
+
+ */
+
+
+#define DOM_DOMAIN_CACHE_NONE 0xFFFFFFFFu
+
+
+
+
+
+typedef struct dom_domain_cache_key {
 
 
     dom_domain_id  domain_id;
@@ -79,16 +118,61 @@ typedef struct dom_domain_cache_entry {
     u32            authoring_version;
 
 
-    u64            last_used;
+    u64            window_start;      /* time-windowed fields only; else 0 */
 
 
-    u64            insert_order;
+    u64            window_ticks;
 
 
-    d_bool         valid;
+} dom_domain_cache_key;
+
+
+
+
+
+typedef struct dom_domain_cache_tile_ops {
+
 
+    u32   tile_size;
 
-    dom_domain_tile tile;
+
+    void (*init)(void* tile);               /* NULL: zero-fill */
+
+
+    void (*release)(void* tile);            /* NULL: tile owns no heap storage */
+
+
+    u32  (*heap_bytes)(const void* tile);   /* NULL: only tile_size is charged */
+
+
+} dom_domain_cache_tile_ops;
+
+
+
+
+
+typedef struct dom_domain_cache_entry {
+
+
+    dom_domain_cache_key key;
+
+
+    u32            hash;
+
+
+    u32            hash_next;
+
+
+    u32            lru_prev;          /* towards most recently used */
+
+
+    u32            lru_next;          /* towards least recently used */
+
+
+    u32            charge;            /* bytes counted against the budget */
+
+
+    d_bool         valid;
 
 
 } dom_domain_cache_entry;
@@ -97,22 +181,67 @@ typedef struct dom_domain_cache_entry {
 
 
 
+typedef struct dom_domain_cache_stats {
+
+
+    u64            hits;
+
+
+    u64            misses;
+
+
+    u64            evictions;
+
+
+    u64            inserts;
+
+
+} dom_domain_cache_stats;
+
+
+
+
+
 typedef struct dom_domain_cache {
 
 
     dom_domain_cache_entry *entries;
 
 
+    unsigned char          *tiles;    /* capacity * tile_ops->tile_size */
+
+
+    u32                    *buckets;
+
+
+    u32                    bucket_mask;
+
+
     u32                    capacity;
 
 
     u32                    count;
 
 
-    u64                    use_counter;
+    u32                    lru_head;
+
+
+    u32                    lru_tail;
+
 
+    u32                    free_head; /* chained through hash_next */
 
-    u64                    next_insert_order;
+
+    u64                    memory_budget; /* bytes; 0 = entry capacity only */
+
+
+    u64                    memory_used;
+
+
+    const dom_domain_cache_tile_ops *tile_ops;
+
+
+    dom_domain_cache_stats stats;
 
 
 } dom_domain_cache;
@@ -124,13 +253,73 @@ typedef struct dom_domain_cache {
 void dom_domain_cache_init(dom_domain_cache* cache);
 
 
+void dom_domain_cache_init_typed(dom_domain_cache* cache, const dom_domain_cache_tile_ops* ops);
+
+
 void dom_domain_cache_free(dom_domain_cache* cache);
 
 
 int  dom_domain_cache_reserve(dom_domain_cache* cache, u32 capacity);
 
 
+void dom_domain_cache_set_budget(dom_domain_cache* cache, u64 memory_budget);
+
+
+
+
+
+void dom_domain_cache_key_init(dom_domain_cache_key* key,
+
+
+                               dom_domain_id domain_id,
+
 
+                               u64 tile_id,
+
+
+                               u32 resolution,
+
+
+                               u32 authoring_version);
+
+
+
+
+
+/* Typed access. `peek` does not touch LRU order or counters. `put` moves the
+
+
+ * tile bytes into the cache (replacing any entry with the same key) and
+
+
+ * re-initialises `tile`; it returns NULL only when the cache has no slots. */
+
+
+const void* dom_domain_cache_peek_tile(const dom_domain_cache* cache,
+
+
+                                       const dom_domain_cache_key* key);
+
+
+void* dom_domain_cache_get_tile(dom_domain_cache* cache,
+
+
+                                const dom_domain_cache_key* key);
+
+
+void* dom_domain_cache_put_tile(dom_domain_cache* cache,
+
+
+                                const dom_domain_cache_key* key,
+
+
+                                void* tile);
+
+
+
+
+
+/* dom_domain_tile wrappers for caches using the default ops. */
 
 
 const dom_domain_tile* dom_domain_cache_peek(const dom_domain_cache* cache,
@@ -184,6 +373,9 @@ dom_domain_tile* dom_domain_cache_put(dom_domain_cache* cache,
 void dom_domain_cache_invalidate_domain(dom_domain_cache* cache, dom_domain_id domain_id);
 
 
+void dom_domain_cache_invalidate_tile(dom_domain_cache* cache, dom_domain_id domain_id, u64 tile_id);
+
+
 void dom_domain_cache_invalidate_version(dom_domain_cache* cache, u32 authoring_version);
 
 
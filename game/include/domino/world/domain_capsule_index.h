@@ -0,0 +1,71 @@
+/*
+FILE: include/domino/world/domain_capsule_index.h
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino API / world/domain_capsule_index
+RESPONSIBILITY: Defines the spatial index over collapsed macro capsule bounds.
+ALLOWED DEPENDENCIES: `include/domino/**` plus C89/C++98 standard headers as needed.
+FORBIDDEN DEPENDENCIES: `source/**` private headers; keep contracts freestanding and layer-respecting.
+THREADING MODEL: No internal synchronization; callers must serialize access unless stated otherwise.
+ERROR MODEL: Return codes/NULL pointers; no exceptions.
+DETERMINISM: Fixed-point grid keys; lookups return the lowest matching slot.
+VERSIONING / ABI / DATA FORMAT NOTES: Versioned by DOMAIN1 specs.
+EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
+*/
+#ifndef DOMINO_WORLD_DOMAIN_CAPSULE_INDEX_H
+#define DOMINO_WORLD_DOMAIN_CAPSULE_INDEX_H
+
+#include "domino/world/domain_tile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DOM_DOMAIN_CAPSULE_NONE 0xFFFFFFFFu
+/* Capsules touching more grid cells than this are scanned linearly. */
+#define DOM_DOMAIN_CAPSULE_CELL_SPAN_MAX 64u
+
+typedef struct dom_domain_capsule_cell {
+    u64 code; /* Morton code of the grid cell */
+    u32 slot;
+} dom_domain_capsule_cell;
+
+/* Capsule bounds by slot plus a sorted Morton-code grid over them. Slots
+ * mirror the owning domain's capsule array: inserts append, removals swap the
+ * last slot into the hole. */
+typedef struct dom_domain_capsule_index {
+    q16_16 cell_size;                 /* <= 0 scans every capsule */
+    u32 limit;                        /* max capsules; 0 = unbounded */
+    dom_domain_aabb* bounds;          /* per slot */
+    dom_domain_capsule_cell* cells;   /* sorted by code, then slot */
+    u32* wide;                        /* ascending slots over the span limit */
+    u32 count;
+    u32 capacity;
+    u32 cell_count;
+    u32 cell_capacity;
+    u32 wide_count;
+} dom_domain_capsule_index;
+
+void dom_domain_capsule_index_init(dom_domain_capsule_index* index, q16_16 cell_size, u32 limit);
+void dom_domain_capsule_index_free(dom_domain_capsule_index* index);
+void dom_domain_capsule_index_clear(dom_domain_capsule_index* index);
+/* Re-keys every capsule; no-op when the size is unchanged. */
+int  dom_domain_capsule_index_set_cell_size(dom_domain_capsule_index* index, q16_16 cell_size);
+/* Existing capsules above a lowered limit stay; further inserts are refused. */
+void dom_domain_capsule_index_set_limit(dom_domain_capsule_index* index, u32 limit);
+
+/* Appends slot `count`. Returns 0, -1 on allocation failure or -2 at the limit. */
+int  dom_domain_capsule_index_insert(dom_domain_capsule_index* index, const dom_domain_aabb* bounds);
+/* Drops `slot` and moves the last slot into it, like the domain arrays do. */
+int  dom_domain_capsule_index_remove(dom_domain_capsule_index* index, u32 slot);
+/* Lowest slot whose bounds contain the point, or DOM_DOMAIN_CAPSULE_NONE. */
+u32  dom_domain_capsule_index_find(const dom_domain_capsule_index* index, const dom_domain_point* point);
+
+/* Grows a domain's typed capsule array alongside its index. Returns the
+ * (possibly moved) array, or NULL with the old array untouched. */
+void* dom_domain_capsule_array_reserve(void* items, u32 item_size, u32* capacity, u32 needed);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* DOMINO_WORLD_DOMAIN_CAPSULE_INDEX_H */
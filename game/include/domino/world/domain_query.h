@@ -244,6 +244,87 @@ typedef struct dom_domain_ray_hit_result {
 
 
 
+/* Points of a batched sample query as parallel coordinate arrays. */
+
+
+typedef struct dom_domain_point_batch {
+
+
+    const q16_16* x;
+
+
+    const q16_16* y;
+
+
+    const q16_16* z;
+
+
+    u32 count;
+
+
+} dom_domain_point_batch;
+
+
+
+
+
+/* Deferred tile reads of a batched sample query. Field modules walk the batch
+
+
+ * in order (budget and cache effects stay sequential), record which cached
+
+
+ * tile each point reads, and drain the bins grouped by tile so per-tile
+
+
+ * sampling constants are derived once. Tile pointers are only valid until the
+
+
+ * next cache insert, so modules drain before building a tile. */
+
+
+#define DOM_DOMAIN_SAMPLE_BIN_POINTS 256u
+
+
+#define DOM_DOMAIN_SAMPLE_BIN_TILES 32u
+
+
+
+
+
+typedef struct dom_domain_sample_bins {
+
+
+    const void* tiles[DOM_DOMAIN_SAMPLE_BIN_TILES];
+
+
+    u32 tile_count;
+
+
+    u32 point_count;
+
+
+    u32 last_slot;
+
+
+    u32 point_index[DOM_DOMAIN_SAMPLE_BIN_POINTS];
+
+
+    u32 point_slot[DOM_DOMAIN_SAMPLE_BIN_POINTS];
+
+
+    u32 order[DOM_DOMAIN_SAMPLE_BIN_POINTS];         /* point indices grouped by tile */
+
+
+    u32 offsets[DOM_DOMAIN_SAMPLE_BIN_TILES + 1u];   /* group bounds within order */
+
+
+} dom_domain_sample_bins;
+
+
+
+
+
 void dom_domain_budget_init(dom_domain_budget* budget, u32 max_units);
 
 
@@ -253,6 +334,27 @@ d_bool dom_domain_budget_consume(dom_domain_budget* budget, u32 cost_units);
 
 
 
+void dom_domain_sample_bins_reset(dom_domain_sample_bins* bins);
+
+
+/* Returns -1 when the bins are full; drain and retry. */
+
+
+int  dom_domain_sample_bins_add(dom_domain_sample_bins* bins, const void* tile, u32 point_index);
+
+
+/* Fills `order`/`offsets`: group g covers order[offsets[g]..offsets[g+1]) and
+
+
+ * reads tiles[g]; points keep their batch order within a group. */
+
+
+void dom_domain_sample_bins_group(dom_domain_sample_bins* bins);
+
+
+
+
+
 d_bool dom_domain_contains(const dom_domain_volume* volume,
 
 
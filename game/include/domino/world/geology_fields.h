@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
 #include "domino/core/types.h"
 #include "domino/core/fixed.h"
 #include "domino/world/domain_query.h"
+#include "domino/world/domain_capsule_index.h"
 #include "domino/world/terrain_surface.h"
 
 #ifdef __cplusplus
@@ -25,7 +26,7 @@ extern "C" {
 
 #define DOM_GEOLOGY_MAX_LAYERS 16u
 #define DOM_GEOLOGY_MAX_RESOURCES 8u
-#define DOM_GEOLOGY_MAX_CAPSULES 128u
+#define DOM_GEOLOGY_MAX_CAPSULES 128u /* default capsule limit */
 #define DOM_GEOLOGY_HIST_BINS 4u
 
 #define DOM_GEOLOGY_UNKNOWN_Q16 ((q16_16)0x80000000)
@@ -111,25 +112,6 @@ typedef struct dom_geology_tile {
     u32 *strata_ids;
 } dom_geology_tile;
 
-typedef struct dom_geology_cache_entry {
-    dom_domain_id domain_id;
-    u64 tile_id;
-    u32 resolution;
-    u32 authoring_version;
-    u64 last_used;
-    u64 insert_order;
-    d_bool valid;
-    dom_geology_tile tile;
-} dom_geology_cache_entry;
-
-typedef struct dom_geology_cache {
-    dom_geology_cache_entry *entries;
-    u32 capacity;
-    u32 count;
-    u64 use_counter;
-    u64 next_insert_order;
-} dom_geology_cache;
-
 typedef struct dom_geology_macro_capsule {
     u64 capsule_id;
     u64 tile_id;
@@ -149,9 +131,11 @@ typedef struct dom_geology_domain {
     u32 existence_state;
     u32 archival_state;
     u32 authoring_version;
-    dom_geology_cache cache;
-    dom_geology_macro_capsule capsules[DOM_GEOLOGY_MAX_CAPSULES];
+    dom_domain_cache cache;
+    dom_geology_macro_capsule* capsules;
     u32 capsule_count;
+    u32 capsule_capacity;
+    dom_domain_capsule_index capsule_index; /* limit starts at DOM_GEOLOGY_MAX_CAPSULES */
 } dom_geology_domain;
 
 void dom_geology_surface_desc_init(dom_geology_surface_desc* desc);
@@ -171,6 +155,12 @@ int dom_geology_sample_query(const dom_geology_domain* domain,
                              const dom_domain_point* point,
                              dom_domain_budget* budget,
                              dom_geology_sample* out_sample);
+/* Samples points->count points into out_samples. Results and budget use match
+ * calling dom_geology_sample_query for each point in order. */
+int dom_geology_sample_query_batch(const dom_geology_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   dom_domain_budget* budget,
+                                   dom_geology_sample* out_samples);
 
 int dom_geology_domain_collapse_tile(dom_geology_domain* domain,
                                      const dom_domain_tile_desc* desc);
@@ -190,6 +190,12 @@ int dom_mining_sample_query(const dom_mining_domain* domain,
                             const dom_domain_point* point,
                             dom_domain_budget* budget,
                             dom_mining_sample* out_sample);
+/* Samples points->count points into out_samples. Results and budget use match
+ * calling dom_mining_sample_query for each point in order. */
+int dom_mining_sample_query_batch(const dom_mining_domain* domain,
+                                  const dom_domain_point_batch* points,
+                                  dom_domain_budget* budget,
+                                  dom_mining_sample* out_samples);
 
 int dom_mining_cut(dom_mining_domain* domain,
                    const dom_domain_point* center,
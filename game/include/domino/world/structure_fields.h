@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
 #include "domino/core/types.h"
 #include "domino/core/fixed.h"
 #include "domino/world/domain_query.h"
+#include "domino/world/domain_capsule_index.h"
 #include "domino/world/terrain_surface.h"
 #include "domino/world/geology_fields.h"
 
@@ -27,7 +28,7 @@ extern "C" {
 #define DOM_STRUCTURE_MAX_SPECS 16u
 #define DOM_STRUCTURE_MAX_ANCHORS 8u
 #define DOM_STRUCTURE_MAX_INSTANCES 256u
-#define DOM_STRUCTURE_MAX_CAPSULES 128u
+#define DOM_STRUCTURE_MAX_CAPSULES 128u /* default capsule limit */
 #define DOM_STRUCTURE_HIST_BINS 4u
 
 #define DOM_STRUCTURE_UNKNOWN_Q16 ((q16_16)0x80000000)
@@ -124,25 +125,6 @@ typedef struct dom_structure_tile {
     u32* flags;
 } dom_structure_tile;
 
-typedef struct dom_structure_cache_entry {
-    dom_domain_id domain_id;
-    u64 tile_id;
-    u32 resolution;
-    u32 authoring_version;
-    u64 last_used;
-    u64 insert_order;
-    d_bool valid;
-    dom_structure_tile tile;
-} dom_structure_cache_entry;
-
-typedef struct dom_structure_cache {
-    dom_structure_cache_entry* entries;
-    u32 capacity;
-    u32 count;
-    u64 use_counter;
-    u64 next_insert_order;
-} dom_structure_cache;
-
 typedef struct dom_structure_process_result {
     u32 ok;
     u32 refusal_reason; /* dom_domain_refusal_reason */
@@ -201,9 +183,11 @@ typedef struct dom_structure_domain {
     u32 archival_state;
     u32 authoring_version;
     dom_structure_surface_desc surface;
-    dom_structure_cache cache;
-    dom_structure_macro_capsule capsules[DOM_STRUCTURE_MAX_CAPSULES];
+    dom_domain_cache cache;
+    dom_structure_macro_capsule* capsules;
     u32 capsule_count;
+    u32 capsule_capacity;
+    dom_domain_capsule_index capsule_index; /* limit starts at DOM_STRUCTURE_MAX_CAPSULES */
     dom_structure_instance instances[DOM_STRUCTURE_MAX_INSTANCES];
     u32 instance_count;
 } dom_structure_domain;
@@ -223,6 +207,13 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
                                u64 tick,
                                dom_domain_budget* budget,
                                dom_structure_sample* out_sample);
+/* Samples points->count points at `tick` into out_samples. Results and budget
+ * use match calling dom_structure_sample_query for each point in order. */
+int dom_structure_sample_query_batch(const dom_structure_domain* domain,
+                                     const dom_domain_point_batch* points,
+                                     u64 tick,
+                                     dom_domain_budget* budget,
+                                     dom_structure_sample* out_samples);
 
 int dom_structure_place(dom_structure_domain* domain,
                         const dom_structure_instance* instance,
@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
 #include "domino/core/types.h"
 #include "domino/core/fixed.h"
 #include "domino/world/domain_query.h"
+#include "domino/world/domain_capsule_index.h"
 #include "domino/world/domain_cache.h"
 
 #ifdef __cplusplus
@@ -121,14 +122,16 @@ typedef struct dom_terrain_macro_capsule {
     u32 material_primary;
 } dom_terrain_macro_capsule;
 
-#define DOM_TERRAIN_MAX_CAPSULES 128u
+#define DOM_TERRAIN_MAX_CAPSULES 128u /* default capsule limit */
 
 typedef struct dom_terrain_domain {
     dom_terrain_surface surface;
     dom_domain_volume volume;
     dom_domain_cache cache;
-    dom_terrain_macro_capsule capsules[DOM_TERRAIN_MAX_CAPSULES];
+    dom_terrain_macro_capsule* capsules;
     u32 capsule_count;
+    u32 capsule_capacity;
+    dom_domain_capsule_index capsule_index; /* limit starts at DOM_TERRAIN_MAX_CAPSULES */
 } dom_terrain_domain;
 
 void dom_terrain_surface_desc_init(dom_terrain_surface_desc* desc);
@@ -149,6 +152,12 @@ int dom_terrain_sample_query(const dom_terrain_domain* domain,
                              const dom_domain_point* point,
                              dom_domain_budget* budget,
                              dom_terrain_sample* out_sample);
+/* Samples points->count points into out_samples. Results and budget use match
+ * calling dom_terrain_sample_query for each point in order. */
+int dom_terrain_sample_query_batch(const dom_terrain_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   dom_domain_budget* budget,
+                                   dom_terrain_sample* out_samples);
 
 d_bool dom_terrain_collision(const dom_terrain_domain* domain,
                              const dom_domain_point* point,
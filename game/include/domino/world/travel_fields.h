@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
 #include "domino/core/types.h"
 #include "domino/core/fixed.h"
 #include "domino/world/domain_query.h"
+#include "domino/world/domain_capsule_index.h"
 #include "domino/world/terrain_surface.h"
 #include "domino/world/weather_fields.h"
 #include "domino/world/structure_fields.h"
@@ -29,7 +30,7 @@ extern "C" {
 #define DOM_TRAVEL_MAX_ROADS 16u
 #define DOM_TRAVEL_MAX_BRIDGES 16u
 #define DOM_TRAVEL_MAX_OBSTACLES 16u
-#define DOM_TRAVEL_MAX_CAPSULES 128u
+#define DOM_TRAVEL_MAX_CAPSULES 128u /* default capsule limit */
 #define DOM_TRAVEL_HIST_BINS 4u
 #define DOM_TRAVEL_MAX_PATH_POINTS 64u
 #define DOM_TRAVEL_MAX_PATH_CACHE 8u
@@ -171,8 +172,10 @@ typedef struct dom_travel_domain {
     u32 authoring_version;
     dom_travel_surface_desc surface;
     dom_travel_path_cache path_cache;
-    dom_travel_macro_capsule capsules[DOM_TRAVEL_MAX_CAPSULES];
+    dom_travel_macro_capsule* capsules;
     u32 capsule_count;
+    u32 capsule_capacity;
+    dom_domain_capsule_index capsule_index; /* limit starts at DOM_TRAVEL_MAX_CAPSULES */
 } dom_travel_domain;
 
 void dom_travel_surface_desc_init(dom_travel_surface_desc* desc);
@@ -191,6 +194,15 @@ int dom_travel_sample_query(const dom_travel_domain* domain,
                             u32 mode_id,
                             dom_domain_budget* budget,
                             dom_travel_sample* out_sample);
+/* Samples points->count points for one mode at `tick` into out_samples.
+ * Results and budget use match calling dom_travel_sample_query for each point
+ * in order. */
+int dom_travel_sample_query_batch(const dom_travel_domain* domain,
+                                  const dom_domain_point_batch* points,
+                                  u64 tick,
+                                  u32 mode_id,
+                                  dom_domain_budget* budget,
+                                  dom_travel_sample* out_samples);
 
 int dom_travel_pathfind(dom_travel_domain* domain,
                         const dom_domain_point* origin,
@@ -17,6 +17,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/architecture/**`.
 #include "domino/core/types.h"
 #include "domino/core/fixed.h"
 #include "domino/world/domain_query.h"
+#include "domino/world/domain_capsule_index.h"
 #include "domino/world/terrain_surface.h"
 #include "domino/world/climate_fields.h"
 #include "domino/world/weather_fields.h"
@@ -28,7 +29,7 @@ extern "C" {
 
 #define DOM_VEG_MAX_SPECIES 16u
 #define DOM_VEG_MAX_BIOMES 8u
-#define DOM_VEG_MAX_CAPSULES 128u
+#define DOM_VEG_MAX_CAPSULES 128u /* default capsule limit */
 #define DOM_VEG_HIST_BINS 4u
 
 #define DOM_VEG_UNKNOWN_Q16 ((q16_16)0x80000000)
@@ -130,27 +131,6 @@ typedef struct dom_vegetation_tile {
     u32* flags;
 } dom_vegetation_tile;
 
-typedef struct dom_vegetation_cache_entry {
-    dom_domain_id domain_id;
-    u64 tile_id;
-    u32 resolution;
-    u32 authoring_version;
-    u64 window_start;
-    u64 window_ticks;
-    u64 last_used;
-    u64 insert_order;
-    d_bool valid;
-    dom_vegetation_tile tile;
-} dom_vegetation_cache_entry;
-
-typedef struct dom_vegetation_cache {
-    dom_vegetation_cache_entry* entries;
-    u32 capacity;
-    u32 count;
-    u64 use_counter;
-    u64 next_insert_order;
-} dom_vegetation_cache;
-
 typedef struct dom_vegetation_macro_capsule {
     u64 capsule_id;
     u64 tile_id;
@@ -174,9 +154,11 @@ typedef struct dom_vegetation_domain {
     u32 archival_state;
     u32 authoring_version;
     dom_vegetation_surface_desc surface;
-    dom_vegetation_cache cache;
-    dom_vegetation_macro_capsule capsules[DOM_VEG_MAX_CAPSULES];
+    dom_domain_cache cache;
+    dom_vegetation_macro_capsule* capsules;
     u32 capsule_count;
+    u32 capsule_capacity;
+    dom_domain_capsule_index capsule_index; /* limit starts at DOM_VEG_MAX_CAPSULES */
 } dom_vegetation_domain;
 
 void dom_vegetation_surface_desc_init(dom_vegetation_surface_desc* desc);
@@ -194,6 +176,13 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
                                 u64 tick,
                                 dom_domain_budget* budget,
                                 dom_vegetation_sample* out_sample);
+/* Samples points->count points at `tick` into out_samples. Results and budget
+ * use match calling dom_vegetation_sample_query for each point in order. */
+int dom_vegetation_sample_query_batch(const dom_vegetation_domain* domain,
+                                      const dom_domain_point_batch* points,
+                                      u64 tick,
+                                      dom_domain_budget* budget,
+                                      dom_vegetation_sample* out_samples);
 
 int dom_vegetation_domain_collapse_tile(dom_vegetation_domain* domain,
                                         const dom_domain_tile_desc* desc,
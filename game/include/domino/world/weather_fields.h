@@ -108,26 +108,6 @@ typedef struct dom_weather_sample {
     dom_domain_query_meta meta;
 } dom_weather_sample;
 
-typedef struct dom_weather_cache_entry {
-    dom_domain_id domain_id;
-    u64 window_id;
-    u64 start_tick;
-    u64 window_ticks;
-    u32 authoring_version;
-    u64 last_used;
-    u64 insert_order;
-    d_bool valid;
-    dom_weather_event_list events;
-} dom_weather_cache_entry;
-
-typedef struct dom_weather_cache {
-    dom_weather_cache_entry* entries;
-    u32 capacity;
-    u32 count;
-    u64 use_counter;
-    u64 next_insert_order;
-} dom_weather_cache;
-
 typedef struct dom_weather_macro_capsule {
     u64 capsule_id;
     u64 window_id;
@@ -147,7 +127,7 @@ typedef struct dom_weather_domain {
     u32 archival_state;
     u32 authoring_version;
     dom_weather_schedule_desc schedule;
-    dom_weather_cache cache;
+    dom_domain_cache cache;
     dom_weather_macro_capsule capsules[DOM_WEATHER_MAX_CAPSULES];
     u32 capsule_count;
 } dom_weather_domain;
@@ -168,6 +148,13 @@ int dom_weather_sample_query(const dom_weather_domain* domain,
                              u64 tick,
                              dom_domain_budget* budget,
                              dom_weather_sample* out_sample);
+/* Samples points->count points at `tick` into out_samples. Results and budget
+ * use match calling dom_weather_sample_query for each point in order. */
+int dom_weather_sample_query_batch(const dom_weather_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   u64 tick,
+                                   dom_domain_budget* budget,
+                                   dom_weather_sample* out_samples);
 
 int dom_weather_events_at(const dom_weather_domain* domain,
                           const dom_domain_point* point,
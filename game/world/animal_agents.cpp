@@ -161,14 +161,6 @@ static dom_domain_point dom_animal_cell_center(q16_16 cell_size, i32 cx, i32 cy,
     return center;
 }
 
-static void dom_animal_cache_init(dom_animal_cache* cache)
-{
-    if (!cache) {
-        return;
-    }
-    memset(cache, 0, sizeof(*cache));
-}
-
 static void dom_animal_tile_init(dom_animal_tile* tile)
 {
     if (!tile) {
@@ -215,79 +207,30 @@ static void dom_animal_tile_free(dom_animal_tile* tile)
     tile->authoring_version = 0u;
 }
 
-static void dom_animal_cache_free(dom_animal_cache* cache)
+static void dom_animal_cache_tile_init(void* tile)
 {
-    if (!cache) {
-        return;
-    }
-    if (cache->entries) {
-        for (u32 i = 0u; i < cache->capacity; ++i) {
-            dom_animal_tile_free(&cache->entries[i].tile);
-        }
-        free(cache->entries);
-        cache->entries = (dom_animal_cache_entry*)0;
-    }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
+    dom_animal_tile_init((dom_animal_tile*)tile);
 }
 
-static int dom_animal_cache_reserve(dom_animal_cache* cache, u32 capacity)
+static void dom_animal_cache_tile_release(void* tile)
 {
-    dom_animal_cache_entry* new_entries;
-    u32 old_cap;
-    if (!cache) {
-        return -1;
-    }
-    if (capacity <= cache->capacity) {
-        return 0;
-    }
-    new_entries = (dom_animal_cache_entry*)realloc(cache->entries,
-                                                   capacity * sizeof(dom_animal_cache_entry));
-    if (!new_entries) {
-        return -1;
-    }
-    old_cap = cache->capacity;
-    cache->entries = new_entries;
-    cache->capacity = capacity;
-    for (u32 i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_animal_cache_entry));
-        dom_animal_tile_init(&cache->entries[i].tile);
-        cache->entries[i].valid = D_FALSE;
-    }
-    return 0;
+    dom_animal_tile_free((dom_animal_tile*)tile);
 }
 
-static dom_animal_cache_entry* dom_animal_cache_find_entry(dom_animal_cache* cache,
-                                                           dom_domain_id domain_id,
-                                                           u64 tile_id,
-                                                           u32 resolution,
-                                                           u32 authoring_version,
-                                                           u64 window_start,
-                                                           u64 window_ticks)
+static u32 dom_animal_cache_tile_bytes(const void* tile)
 {
-    if (!cache || !cache->entries) {
-        return (dom_animal_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_animal_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version &&
-            entry->window_start == window_start &&
-            entry->window_ticks == window_ticks) {
-            return entry;
-        }
-    }
-    return (dom_animal_cache_entry*)0;
+    const dom_animal_tile* t = (const dom_animal_tile*)tile;
+    return t->sample_count * (u32)(5u * sizeof(q16_16) + 6u * sizeof(u32) + sizeof(u64));
 }
 
-static const dom_animal_tile* dom_animal_cache_peek(const dom_animal_cache* cache,
+static const dom_domain_cache_tile_ops g_dom_animal_tile_ops = {
+    (u32)sizeof(dom_animal_tile),
+    dom_animal_cache_tile_init,
+    dom_animal_cache_tile_release,
+    dom_animal_cache_tile_bytes
+};
+
+static const dom_animal_tile* dom_animal_cache_peek(const dom_domain_cache* cache,
                                                     dom_domain_id domain_id,
                                                     u64 tile_id,
                                                     u32 resolution,
@@ -295,27 +238,14 @@ static const dom_animal_tile* dom_animal_cache_peek(const dom_animal_cache* cach
                                                     u64 window_start,
                                                     u64 window_ticks)
 {
-    if (!cache || !cache->entries) {
-        return (const dom_animal_tile*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        const dom_animal_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version &&
-            entry->window_start == window_start &&
-            entry->window_ticks == window_ticks) {
-            return &entry->tile;
-        }
-    }
-    return (const dom_animal_tile*)0;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    key.window_start = window_start;
+    key.window_ticks = window_ticks;
+    return (const dom_animal_tile*)dom_domain_cache_peek_tile(cache, &key);
 }
 
-static const dom_animal_tile* dom_animal_cache_get(dom_animal_cache* cache,
+static const dom_animal_tile* dom_animal_cache_get(dom_domain_cache* cache,
                                                    dom_domain_id domain_id,
                                                    u64 tile_id,
                                                    u32 resolution,
@@ -323,103 +253,26 @@ static const dom_animal_tile* dom_animal_cache_get(dom_animal_cache* cache,
                                                    u64 window_start,
                                                    u64 window_ticks)
 {
-    dom_animal_cache_entry* entry;
-    if (!cache) {
-        return (const dom_animal_tile*)0;
-    }
-    entry = dom_animal_cache_find_entry(cache, domain_id, tile_id, resolution,
-                                        authoring_version, window_start, window_ticks);
-    if (!entry) {
-        return (const dom_animal_tile*)0;
-    }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->tile;
-}
-
-static dom_animal_cache_entry* dom_animal_cache_select_slot(dom_animal_cache* cache)
-{
-    dom_animal_cache_entry* best = (dom_animal_cache_entry*)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_animal_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_animal_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
-    }
-    return best;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    key.window_start = window_start;
+    key.window_ticks = window_ticks;
+    return (const dom_animal_tile*)dom_domain_cache_get_tile(cache, &key);
 }
 
-static dom_animal_tile* dom_animal_cache_put(dom_animal_cache* cache,
+static dom_animal_tile* dom_animal_cache_put(dom_domain_cache* cache,
                                              dom_domain_id domain_id,
                                              dom_animal_tile* tile)
 {
-    dom_animal_cache_entry* entry;
-    if (!cache || !tile) {
-        return (dom_animal_tile*)0;
-    }
-    if (!cache->entries || cache->capacity == 0u) {
-        return (dom_animal_tile*)0;
-    }
-    entry = dom_animal_cache_find_entry(cache, domain_id, tile->tile_id,
-                                        tile->resolution, tile->authoring_version,
-                                        tile->window_start, tile->window_ticks);
-    if (!entry) {
-        entry = dom_animal_cache_select_slot(cache);
-    }
-    if (!entry) {
+    dom_domain_cache_key key;
+    if (!tile) {
         return (dom_animal_tile*)0;
     }
-    if (entry->valid) {
-        dom_animal_tile_free(&entry->tile);
-    } else {
-        cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
-    }
-
-    entry->domain_id = domain_id;
-    entry->tile_id = tile->tile_id;
-    entry->resolution = tile->resolution;
-    entry->authoring_version = tile->authoring_version;
-    entry->window_start = tile->window_start;
-    entry->window_ticks = tile->window_ticks;
-    entry->tile = *tile;
-    entry->valid = D_TRUE;
-
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-
-    dom_animal_tile_init(tile);
-    return &entry->tile;
-}
-
-static void dom_animal_cache_invalidate_domain(dom_animal_cache* cache, dom_domain_id domain_id)
-{
-    if (!cache || !cache->entries) {
-        return;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_animal_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            dom_animal_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
-        }
-    }
+    dom_domain_cache_key_init(&key, domain_id, tile->tile_id,
+                              tile->resolution, tile->authoring_version);
+    key.window_start = tile->window_start;
+    key.window_ticks = tile->window_ticks;
+    return (dom_animal_tile*)dom_domain_cache_put_tile(cache, &key, tile);
 }
 
 static q16_16 dom_animal_step_from_extent(q16_16 extent, u32 sample_dim)
@@ -1504,11 +1357,12 @@ void dom_animal_domain_init(dom_animal_domain* domain,
     domain->existence_state = DOM_DOMAIN_EXISTENCE_REALIZED;
     domain->archival_state = DOM_DOMAIN_ARCHIVAL_LIVE;
     domain->authoring_version = 1u;
-    dom_animal_cache_init(&domain->cache);
+    dom_domain_cache_init_typed(&domain->cache, &g_dom_animal_tile_ops);
     if (cache_capacity > 0u) {
-        dom_animal_cache_reserve(&domain->cache, cache_capacity);
+        dom_domain_cache_reserve(&domain->cache, cache_capacity);
     }
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->policy.tile_size, DOM_ANIMAL_MAX_CAPSULES);
 }
 
 void dom_animal_domain_free(dom_animal_domain* domain)
@@ -1516,9 +1370,13 @@ void dom_animal_domain_free(dom_animal_domain* domain)
     if (!domain) {
         return;
     }
-    dom_animal_cache_free(&domain->cache);
+    dom_domain_cache_free(&domain->cache);
     dom_vegetation_domain_free(&domain->vegetation_domain);
     domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_animal_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
 }
 
 void dom_animal_domain_set_state(dom_animal_domain* domain,
@@ -1532,7 +1390,7 @@ void dom_animal_domain_set_state(dom_animal_domain* domain,
         domain->existence_state = existence_state;
         domain->archival_state = archival_state;
         dom_vegetation_domain_set_state(&domain->vegetation_domain, existence_state, archival_state);
-        dom_animal_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+        dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
     }
 }
 
@@ -1543,69 +1401,69 @@ void dom_animal_domain_set_policy(dom_animal_domain* domain,
         return;
     }
     domain->policy = *policy;
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->policy.tile_size);
     dom_vegetation_domain_set_policy(&domain->vegetation_domain, policy);
-    dom_animal_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+    dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
 }
 
-int dom_animal_sample_query(const dom_animal_domain* domain,
-                            const dom_domain_point* point,
-                            u64 tick,
-                            dom_domain_budget* budget,
-                            dom_animal_sample* out_sample)
+/* Point-independent refusals; a batch checks them once. */
+static u32 dom_animal_sample_refusal(const dom_animal_domain* domain,
+                                     const dom_domain_sdf_source** out_source)
 {
-    dom_domain_tile_desc desc;
     const dom_domain_sdf_source* source;
+    *out_source = (const dom_domain_sdf_source*)0;
+    if (!dom_animal_domain_is_active(domain)) {
+        return DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE;
+    }
+    source = dom_terrain_surface_sdf(&domain->vegetation_domain.terrain_domain.surface);
+    if (!source || !source->eval) {
+        return DOM_DOMAIN_REFUSE_NO_SOURCE;
+    }
+    *out_source = source;
+    return DOM_DOMAIN_REFUSE_NONE;
+}
+
+/* Tiles and fields are evaluated at the start of the window holding `tick`. */
+static void dom_animal_sample_window(const dom_animal_domain* domain, u64 tick,
+                                     u64* out_window_start, u64* out_window_ticks)
+{
+    *out_window_ticks = domain->surface.decision_period_ticks;
+    if (*out_window_ticks == 0u) {
+        *out_window_ticks = 1u;
+    }
+    *out_window_start = dom_animal_window_start(tick, *out_window_ticks);
+}
+
+static void dom_animal_sample_resolve(const dom_animal_domain* domain,
+                                      const dom_domain_sdf_source* source,
+                                      const dom_domain_point* point,
+                                      u64 window_start,
+                                      u64 window_ticks,
+                                      dom_domain_budget* budget,
+                                      dom_animal_sample* out_sample)
+{
+    dom_domain_tile_desc desc;
+    const u64 eval_tick = window_start;
     u32 budget_before = 0u;
     u32 cost_units = 0u;
     d_bool collapsed = D_FALSE;
-    u64 window_ticks;
-    u64 window_start;
-    u64 eval_tick;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
-    dom_animal_sample_init(out_sample);
     if (budget) {
         budget_before = budget->used_units;
     }
-    if (!dom_animal_domain_is_active(domain)) {
-        dom_animal_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
-    source = dom_terrain_surface_sdf(&domain->vegetation_domain.terrain_domain.surface);
-    if (!source || !source->eval) {
-        dom_animal_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_NO_SOURCE, budget);
-        out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
     if (!dom_domain_aabb_contains(&source->bounds, point)) {
         dom_animal_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                  DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, 0u, budget);
         out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
-    if (domain->capsule_count > 0u) {
-        for (u32 i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
+        return;
     }
+    collapsed = (dom_domain_capsule_index_find(&domain->capsule_index, point) != DOM_DOMAIN_CAPSULE_NONE)
+        ? D_TRUE : D_FALSE;
     if (collapsed) {
         dom_animal_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                  DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
         out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN | DOM_ANIMAL_SAMPLE_COLLAPSED;
-        return 0;
-    }
-
-    window_ticks = domain->surface.decision_period_ticks;
-    if (window_ticks == 0u) {
-        window_ticks = 1u;
+        return;
     }
-    window_start = dom_animal_window_start(tick, window_ticks);
-    eval_tick = window_start;
 
     if (dom_animal_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_FULL)) {
         if (dom_domain_budget_consume(budget, domain->policy.cost_full)) {
@@ -1615,7 +1473,7 @@ int dom_animal_sample_query(const dom_animal_domain* domain,
             }
             dom_animal_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_FULL,
                                      DOM_DOMAIN_CONFIDENCE_EXACT, cost_units, budget);
-            return 0;
+            return;
         }
     }
 
@@ -1634,7 +1492,7 @@ int dom_animal_sample_query(const dom_animal_domain* domain,
                 if (!tile) {
                     dom_animal_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
                     out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
-                    return 0;
+                    return;
                 }
                 dom_animal_sample_from_tile(domain, tile, point, out_sample);
                 if (budget) {
@@ -1642,7 +1500,7 @@ int dom_animal_sample_query(const dom_animal_domain* domain,
                 }
                 dom_animal_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_MEDIUM,
                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost_units, budget);
-                return 0;
+                return;
             }
         }
     }
@@ -1662,7 +1520,7 @@ int dom_animal_sample_query(const dom_animal_domain* domain,
                 if (!tile) {
                     dom_animal_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
                     out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
-                    return 0;
+                    return;
                 }
                 dom_animal_sample_from_tile(domain, tile, point, out_sample);
                 if (budget) {
@@ -1670,7 +1528,7 @@ int dom_animal_sample_query(const dom_animal_domain* domain,
                 }
                 dom_animal_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost_units, budget);
-                return 0;
+                return;
             }
         }
     }
@@ -1683,12 +1541,93 @@ int dom_animal_sample_query(const dom_animal_domain* domain,
             }
             dom_animal_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                      DOM_DOMAIN_CONFIDENCE_EXACT, cost_units, budget);
-            return 0;
+            return;
         }
     }
 
     dom_animal_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_BUDGET, budget);
     out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
+}
+
+int dom_animal_sample_query(const dom_animal_domain* domain,
+                            const dom_domain_point* point,
+                            u64 tick,
+                            dom_domain_budget* budget,
+                            dom_animal_sample* out_sample)
+{
+    const dom_domain_sdf_source* source;
+    u64 window_start;
+    u64 window_ticks;
+    u32 refusal;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_animal_sample_init(out_sample);
+    refusal = dom_animal_sample_refusal(domain, &source);
+    if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+        dom_animal_query_meta_refused(&out_sample->meta, refusal, budget);
+        out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
+        return 0;
+    }
+    dom_animal_sample_window(domain, tick, &window_start, &window_ticks);
+    dom_animal_sample_resolve(domain, source, point, window_start, window_ticks, budget, out_sample);
+    return 0;
+}
+
+int dom_animal_sample_query_batch(const dom_animal_domain* domain,
+                                  const dom_domain_point_batch* points,
+                                  u64 tick,
+                                  dom_domain_budget* budget,
+                                  dom_animal_sample* out_samples)
+{
+    const dom_domain_sdf_source* source;
+    u64 window_start = 0u;
+    u64 window_ticks = 0u;
+    u32 refusal;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    refusal = dom_animal_sample_refusal(domain, &source);
+    if (refusal == DOM_DOMAIN_REFUSE_NONE) {
+        dom_animal_sample_window(domain, tick, &window_start, &window_ticks);
+    }
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_animal_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_animal_sample_init(out_sample);
+        if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+            dom_animal_query_meta_refused(&out_sample->meta, refusal, budget);
+            out_sample->flags |= DOM_ANIMAL_SAMPLE_FIELDS_UNKNOWN;
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_animal_sample_resolve(domain, source, &point, window_start, window_ticks, budget, out_sample);
+    }
+    return 0;
+}
+
+static int dom_animal_capsule_append(dom_animal_domain* domain,
+                                     const dom_animal_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_animal_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
     return 0;
 }
 
@@ -1706,7 +1645,7 @@ static int dom_animal_capsule_store(dom_animal_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_ANIMAL_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
     memset(energy_bins, 0, sizeof(energy_bins));
@@ -1757,8 +1696,7 @@ static int dom_animal_capsule_store(dom_animal_domain* domain,
     }
 
     dom_animal_tile_free(&tile);
-    domain->capsules[domain->capsule_count++] = capsule;
-    return 0;
+    return dom_animal_capsule_append(domain, &capsule);
 }
 
 int dom_animal_domain_collapse_tile(dom_animal_domain* domain,
@@ -1768,22 +1706,7 @@ int dom_animal_domain_collapse_tile(dom_animal_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->cache.entries) {
-        for (u32 i = 0u; i < domain->cache.capacity; ++i) {
-            dom_animal_cache_entry* entry = &domain->cache.entries[i];
-            if (!entry->valid) {
-                continue;
-            }
-            if (entry->domain_id == domain->surface.domain_id &&
-                entry->tile_id == desc->tile_id) {
-                dom_animal_tile_free(&entry->tile);
-                entry->valid = D_FALSE;
-                if (domain->cache.count > 0u) {
-                    domain->cache.count -= 1u;
-                }
-            }
-        }
-    }
+    dom_domain_cache_invalidate_tile(&domain->cache, domain->surface.domain_id, desc->tile_id);
     return dom_animal_capsule_store(domain, desc, dom_animal_window_start(tick, domain->surface.decision_period_ticks),
                                     domain->surface.decision_period_ticks);
 }
@@ -1797,6 +1720,7 @@ int dom_animal_domain_expand_tile(dom_animal_domain* domain, u64 tile_id)
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
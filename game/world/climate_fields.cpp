@@ -113,14 +113,6 @@ static q16_16 dom_climate_noise_ratio(u64 seed,
     return d_fixed_div_q16_16(d_q16_16_add(sample, d_q16_16_from_int(1)), d_q16_16_from_int(2));
 }
 
-static void dom_climate_cache_init(dom_climate_cache* cache)
-{
-    if (!cache) {
-        return;
-    }
-    memset(cache, 0, sizeof(*cache));
-}
-
 static void dom_climate_tile_init(dom_climate_tile* tile)
 {
     if (!tile) {
@@ -155,204 +147,62 @@ static void dom_climate_tile_free(dom_climate_tile* tile)
     tile->authoring_version = 0u;
 }
 
-static void dom_climate_cache_free(dom_climate_cache* cache)
+static void dom_climate_cache_tile_init(void* tile)
 {
-    u32 i;
-    if (!cache) {
-        return;
-    }
-    if (cache->entries) {
-        for (i = 0u; i < cache->capacity; ++i) {
-            dom_climate_tile_free(&cache->entries[i].tile);
-        }
-        free(cache->entries);
-        cache->entries = (dom_climate_cache_entry*)0;
-    }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
+    dom_climate_tile_init((dom_climate_tile*)tile);
 }
 
-static int dom_climate_cache_reserve(dom_climate_cache* cache, u32 capacity)
+static void dom_climate_cache_tile_release(void* tile)
 {
-    dom_climate_cache_entry* new_entries;
-    u32 old_cap;
-    u32 i;
-    if (!cache) {
-        return -1;
-    }
-    if (capacity <= cache->capacity) {
-        return 0;
-    }
-    new_entries = (dom_climate_cache_entry*)realloc(cache->entries,
-                                                   capacity * sizeof(dom_climate_cache_entry));
-    if (!new_entries) {
-        return -1;
-    }
-    old_cap = cache->capacity;
-    cache->entries = new_entries;
-    cache->capacity = capacity;
-    for (i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_climate_cache_entry));
-        dom_climate_tile_init(&cache->entries[i].tile);
-        cache->entries[i].valid = D_FALSE;
-    }
-    return 0;
+    dom_climate_tile_free((dom_climate_tile*)tile);
 }
 
-static dom_climate_cache_entry* dom_climate_cache_find_entry(dom_climate_cache* cache,
-                                                             dom_domain_id domain_id,
-                                                             u64 tile_id,
-                                                             u32 resolution,
-                                                             u32 authoring_version)
+static u32 dom_climate_cache_tile_bytes(const void* tile)
 {
-    u32 i;
-    if (!cache || !cache->entries) {
-        return (dom_climate_cache_entry*)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_climate_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return entry;
-        }
-    }
-    return (dom_climate_cache_entry*)0;
+    const dom_climate_tile* t = (const dom_climate_tile*)tile;
+    return t->sample_count * (u32)(5u * sizeof(q16_16) + sizeof(u32));
 }
 
-static const dom_climate_tile* dom_climate_cache_peek(const dom_climate_cache* cache,
+static const dom_domain_cache_tile_ops g_dom_climate_tile_ops = {
+    (u32)sizeof(dom_climate_tile),
+    dom_climate_cache_tile_init,
+    dom_climate_cache_tile_release,
+    dom_climate_cache_tile_bytes
+};
+
+static const dom_climate_tile* dom_climate_cache_peek(const dom_domain_cache* cache,
                                                       dom_domain_id domain_id,
                                                       u64 tile_id,
                                                       u32 resolution,
                                                       u32 authoring_version)
 {
-    u32 i;
-    if (!cache || !cache->entries) {
-        return (const dom_climate_tile*)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        const dom_climate_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return &entry->tile;
-        }
-    }
-    return (const dom_climate_tile*)0;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_climate_tile*)dom_domain_cache_peek_tile(cache, &key);
 }
 
-static const dom_climate_tile* dom_climate_cache_get(dom_climate_cache* cache,
+static const dom_climate_tile* dom_climate_cache_get(dom_domain_cache* cache,
                                                      dom_domain_id domain_id,
                                                      u64 tile_id,
                                                      u32 resolution,
                                                      u32 authoring_version)
 {
-    dom_climate_cache_entry* entry;
-    if (!cache) {
-        return (const dom_climate_tile*)0;
-    }
-    entry = dom_climate_cache_find_entry(cache, domain_id, tile_id, resolution, authoring_version);
-    if (!entry) {
-        return (const dom_climate_tile*)0;
-    }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->tile;
-}
-
-static dom_climate_cache_entry* dom_climate_cache_select_slot(dom_climate_cache* cache)
-{
-    u32 i;
-    dom_climate_cache_entry* best = (dom_climate_cache_entry*)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_climate_cache_entry*)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_climate_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
-    }
-    return best;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_climate_tile*)dom_domain_cache_get_tile(cache, &key);
 }
 
-static dom_climate_tile* dom_climate_cache_put(dom_climate_cache* cache,
+static dom_climate_tile* dom_climate_cache_put(dom_domain_cache* cache,
                                                dom_domain_id domain_id,
                                                dom_climate_tile* tile)
 {
-    dom_climate_cache_entry* entry;
-    if (!cache || !tile) {
-        return (dom_climate_tile*)0;
-    }
-    if (!cache->entries || cache->capacity == 0u) {
-        return (dom_climate_tile*)0;
-    }
-
-    entry = dom_climate_cache_find_entry(cache, domain_id, tile->tile_id,
-                                         tile->resolution, tile->authoring_version);
-    if (!entry) {
-        entry = dom_climate_cache_select_slot(cache);
-    }
-    if (!entry) {
+    dom_domain_cache_key key;
+    if (!tile) {
         return (dom_climate_tile*)0;
     }
-    if (entry->valid) {
-        dom_climate_tile_free(&entry->tile);
-    } else {
-        cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
-    }
-
-    entry->domain_id = domain_id;
-    entry->tile_id = tile->tile_id;
-    entry->resolution = tile->resolution;
-    entry->authoring_version = tile->authoring_version;
-    entry->tile = *tile;
-    entry->valid = D_TRUE;
-
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-
-    dom_climate_tile_init(tile);
-    return &entry->tile;
-}
-
-static void dom_climate_cache_invalidate_domain(dom_climate_cache* cache, dom_domain_id domain_id)
-{
-    u32 i;
-    if (!cache || !cache->entries) {
-        return;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_climate_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            dom_climate_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
-        }
-    }
+    dom_domain_cache_key_init(&key, domain_id, tile->tile_id,
+                              tile->resolution, tile->authoring_version);
+    return (dom_climate_tile*)dom_domain_cache_put_tile(cache, &key, tile);
 }
 
 static q16_16 dom_climate_step_from_extent(q16_16 extent, u32 sample_dim)
@@ -717,73 +567,83 @@ static void dom_climate_eval_fields(const dom_climate_domain* domain,
     }
 }
 
-static q16_16 dom_climate_tile_sample_scalar(const dom_climate_tile* tile,
-                                             const dom_domain_point* point,
-                                             const q16_16* values)
-{
-    q16_16 px;
-    q16_16 py;
-    q16_16 pz;
+#define DOM_CLIMATE_SAMPLE_INDEX_NONE 0xFFFFFFFFu
+
+/* Nearest-sample lookup constants for one tile, derived once per tile. */
+typedef struct dom_climate_tile_sampler {
+    const dom_climate_tile* tile;
     q16_16 step_x;
     q16_16 step_y;
     q16_16 step_z;
-    u32 ix;
-    u32 iy;
-    u32 iz;
-    u32 idx;
-    if (!tile || !point || !values || tile->sample_dim == 0u) {
-        return DOM_CLIMATE_UNKNOWN_Q16;
-    }
-    px = dom_climate_clamp_q16_16(point->x, tile->bounds.min.x, tile->bounds.max.x);
-    py = dom_climate_clamp_q16_16(point->y, tile->bounds.min.y, tile->bounds.max.y);
-    pz = dom_climate_clamp_q16_16(point->z, tile->bounds.min.z, tile->bounds.max.z);
-
-    step_x = dom_climate_step_from_extent((q16_16)(tile->bounds.max.x - tile->bounds.min.x), tile->sample_dim);
-    step_y = dom_climate_step_from_extent((q16_16)(tile->bounds.max.y - tile->bounds.min.y), tile->sample_dim);
-    step_z = dom_climate_step_from_extent((q16_16)(tile->bounds.max.z - tile->bounds.min.z), tile->sample_dim);
+} dom_climate_tile_sampler;
 
-    ix = dom_climate_sample_index_from_coord(px, tile->bounds.min.x, tile->bounds.max.x, step_x, tile->sample_dim);
-    iy = dom_climate_sample_index_from_coord(py, tile->bounds.min.y, tile->bounds.max.y, step_y, tile->sample_dim);
-    iz = dom_climate_sample_index_from_coord(pz, tile->bounds.min.z, tile->bounds.max.z, step_z, tile->sample_dim);
-    idx = ix + tile->sample_dim * (iy + tile->sample_dim * iz);
-    if (idx >= tile->sample_count) {
-        return DOM_CLIMATE_UNKNOWN_Q16;
-    }
-    return values[idx];
+static void dom_climate_tile_sampler_init(dom_climate_tile_sampler* sampler,
+                                          const dom_climate_tile* tile)
+{
+    sampler->tile = tile;
+    sampler->step_x = dom_climate_step_from_extent((q16_16)(tile->bounds.max.x - tile->bounds.min.x), tile->sample_dim);
+    sampler->step_y = dom_climate_step_from_extent((q16_16)(tile->bounds.max.y - tile->bounds.min.y), tile->sample_dim);
+    sampler->step_z = dom_climate_step_from_extent((q16_16)(tile->bounds.max.z - tile->bounds.min.z), tile->sample_dim);
 }
 
-static u32 dom_climate_tile_sample_wind(const dom_climate_tile* tile,
-                                        const dom_domain_point* point)
+static u32 dom_climate_tile_sampler_index(const dom_climate_tile_sampler* sampler,
+                                          q16_16 x,
+                                          q16_16 y,
+                                          q16_16 z)
 {
-    q16_16 px;
-    q16_16 py;
-    q16_16 pz;
-    q16_16 step_x;
-    q16_16 step_y;
-    q16_16 step_z;
+    const dom_climate_tile* tile = sampler->tile;
     u32 ix;
     u32 iy;
     u32 iz;
     u32 idx;
-    if (!tile || !point || !tile->wind_prevailing || tile->sample_dim == 0u) {
-        return DOM_CLIMATE_WIND_UNKNOWN;
-    }
-    px = dom_climate_clamp_q16_16(point->x, tile->bounds.min.x, tile->bounds.max.x);
-    py = dom_climate_clamp_q16_16(point->y, tile->bounds.min.y, tile->bounds.max.y);
-    pz = dom_climate_clamp_q16_16(point->z, tile->bounds.min.z, tile->bounds.max.z);
-
-    step_x = dom_climate_step_from_extent((q16_16)(tile->bounds.max.x - tile->bounds.min.x), tile->sample_dim);
-    step_y = dom_climate_step_from_extent((q16_16)(tile->bounds.max.y - tile->bounds.min.y), tile->sample_dim);
-    step_z = dom_climate_step_from_extent((q16_16)(tile->bounds.max.z - tile->bounds.min.z), tile->sample_dim);
-
-    ix = dom_climate_sample_index_from_coord(px, tile->bounds.min.x, tile->bounds.max.x, step_x, tile->sample_dim);
-    iy = dom_climate_sample_index_from_coord(py, tile->bounds.min.y, tile->bounds.max.y, step_y, tile->sample_dim);
-    iz = dom_climate_sample_index_from_coord(pz, tile->bounds.min.z, tile->bounds.max.z, step_z, tile->sample_dim);
+    if (tile->sample_dim == 0u) {
+        return DOM_CLIMATE_SAMPLE_INDEX_NONE;
+    }
+    x = dom_climate_clamp_q16_16(x, tile->bounds.min.x, tile->bounds.max.x);
+    y = dom_climate_clamp_q16_16(y, tile->bounds.min.y, tile->bounds.max.y);
+    z = dom_climate_clamp_q16_16(z, tile->bounds.min.z, tile->bounds.max.z);
+    ix = dom_climate_sample_index_from_coord(x, tile->bounds.min.x, tile->bounds.max.x, sampler->step_x, tile->sample_dim);
+    iy = dom_climate_sample_index_from_coord(y, tile->bounds.min.y, tile->bounds.max.y, sampler->step_y, tile->sample_dim);
+    iz = dom_climate_sample_index_from_coord(z, tile->bounds.min.z, tile->bounds.max.z, sampler->step_z, tile->sample_dim);
     idx = ix + tile->sample_dim * (iy + tile->sample_dim * iz);
-    if (idx >= tile->sample_count) {
-        return DOM_CLIMATE_WIND_UNKNOWN;
+    return (idx < tile->sample_count) ? idx : DOM_CLIMATE_SAMPLE_INDEX_NONE;
+}
+
+/* Reads the tile fields for `count` points; points[i] indexes both the
+ * coordinate arrays and out_samples. Meta is left untouched. */
+static void dom_climate_tile_gather(const dom_climate_tile* tile,
+                                    const q16_16* xs,
+                                    const q16_16* ys,
+                                    const q16_16* zs,
+                                    const u32* points,
+                                    u32 count,
+                                    dom_climate_sample* out_samples)
+{
+    dom_climate_tile_sampler sampler;
+    u32 idx[DOM_DOMAIN_SAMPLE_BIN_POINTS];
+    u32 i;
+    dom_climate_tile_sampler_init(&sampler, tile);
+    for (i = 0u; i < count; ++i) {
+        const u32 p = points[i];
+        idx[i] = dom_climate_tile_sampler_index(&sampler, xs[p], ys[p], zs[p]);
+    }
+    for (i = 0u; i < count; ++i) {
+        dom_climate_sample* sample = &out_samples[points[i]];
+        const u32 k = idx[i];
+        if (k != DOM_CLIMATE_SAMPLE_INDEX_NONE && tile->data) {
+            sample->temperature_mean = tile->temperature_mean[k];
+            sample->temperature_range = tile->temperature_range[k];
+            sample->precipitation_mean = tile->precipitation_mean[k];
+            sample->precipitation_range = tile->precipitation_range[k];
+            sample->seasonality = tile->seasonality[k];
+        }
+        if (k != DOM_CLIMATE_SAMPLE_INDEX_NONE && tile->wind_prevailing) {
+            sample->wind_prevailing = tile->wind_prevailing[k];
+        }
+        if (sample->wind_prevailing == DOM_CLIMATE_WIND_UNKNOWN) {
+            sample->flags |= DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
+        }
     }
-    return tile->wind_prevailing[idx];
 }
 
 static int dom_climate_tile_build(dom_climate_tile* tile,
@@ -862,19 +722,12 @@ static void dom_climate_sample_from_tile(const dom_climate_tile* tile,
                                          const dom_domain_point* point,
                                          dom_climate_sample* out_sample)
 {
+    const u32 first = 0u;
     if (!tile || !point || !out_sample) {
         return;
     }
     dom_climate_sample_init(out_sample);
-    out_sample->temperature_mean = dom_climate_tile_sample_scalar(tile, point, tile->temperature_mean);
-    out_sample->temperature_range = dom_climate_tile_sample_scalar(tile, point, tile->temperature_range);
-    out_sample->precipitation_mean = dom_climate_tile_sample_scalar(tile, point, tile->precipitation_mean);
-    out_sample->precipitation_range = dom_climate_tile_sample_scalar(tile, point, tile->precipitation_range);
-    out_sample->seasonality = dom_climate_tile_sample_scalar(tile, point, tile->seasonality);
-    out_sample->wind_prevailing = dom_climate_tile_sample_wind(tile, point);
-    if (out_sample->wind_prevailing == DOM_CLIMATE_WIND_UNKNOWN) {
-        out_sample->flags |= DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
-    }
+    dom_climate_tile_gather(tile, &point->x, &point->y, &point->z, &first, 1u, out_sample);
 }
 
 static int dom_climate_build_tile_desc(const dom_climate_domain* domain,
@@ -1083,11 +936,12 @@ void dom_climate_domain_init(dom_climate_domain* domain,
     domain->existence_state = DOM_DOMAIN_EXISTENCE_REALIZED;
     domain->archival_state = DOM_DOMAIN_ARCHIVAL_LIVE;
     domain->authoring_version = 1u;
-    dom_climate_cache_init(&domain->cache);
+    dom_domain_cache_init_typed(&domain->cache, &g_dom_climate_tile_ops);
     if (cache_capacity > 0u) {
-        dom_climate_cache_reserve(&domain->cache, cache_capacity);
+        dom_domain_cache_reserve(&domain->cache, cache_capacity);
     }
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->policy.tile_size, DOM_CLIMATE_MAX_CAPSULES);
 }
 
 void dom_climate_domain_free(dom_climate_domain* domain)
@@ -1095,8 +949,12 @@ void dom_climate_domain_free(dom_climate_domain* domain)
     if (!domain) {
         return;
     }
-    dom_climate_cache_free(&domain->cache);
+    dom_domain_cache_free(&domain->cache);
     domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_climate_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
 }
 
 void dom_climate_domain_set_state(dom_climate_domain* domain,
@@ -1109,7 +967,7 @@ void dom_climate_domain_set_state(dom_climate_domain* domain,
     if (domain->existence_state != existence_state || domain->archival_state != archival_state) {
         domain->existence_state = existence_state;
         domain->archival_state = archival_state;
-        dom_climate_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+        dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
     }
 }
 
@@ -1120,58 +978,110 @@ void dom_climate_domain_set_policy(dom_climate_domain* domain,
         return;
     }
     domain->policy = *policy;
-    dom_climate_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->policy.tile_size);
+    dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
 }
 
-int dom_climate_sample_query(const dom_climate_domain* domain,
-                             const dom_domain_point* point,
-                             dom_domain_budget* budget,
-                             dom_climate_sample* out_sample)
+/* Tile reads deferred by a batched query; NULL for single-point queries. */
+typedef struct dom_climate_sample_batch {
+    const dom_domain_point_batch* points;
+    dom_climate_sample* out_samples;
+    dom_domain_sample_bins bins;
+} dom_climate_sample_batch;
+
+static void dom_climate_sample_batch_drain(dom_climate_sample_batch* batch)
 {
-    dom_domain_tile_desc desc;
-    const dom_domain_sdf_source* source;
-    u32 cost;
-    d_bool collapsed = D_FALSE;
-    if (!domain || !point || !out_sample) {
-        return -1;
+    dom_domain_sample_bins* bins = &batch->bins;
+    u32 g;
+    if (bins->point_count == 0u) {
+        return;
     }
-    dom_climate_sample_init(out_sample);
+    dom_domain_sample_bins_group(bins);
+    for (g = 0u; g < bins->tile_count; ++g) {
+        dom_climate_tile_gather((const dom_climate_tile*)bins->tiles[g],
+                                batch->points->x,
+                                batch->points->y,
+                                batch->points->z,
+                                &bins->order[bins->offsets[g]],
+                                bins->offsets[g + 1u] - bins->offsets[g],
+                                batch->out_samples);
+    }
+    dom_domain_sample_bins_reset(bins);
+}
 
-    if (!dom_climate_domain_is_active(domain)) {
-        dom_climate_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
-        return 0;
+static d_bool dom_climate_sample_tiled(const dom_climate_domain* domain,
+                                       const dom_domain_point* point,
+                                       u32 point_index,
+                                       u32 resolution,
+                                       u32 cost,
+                                       u32 build_cost,
+                                       dom_domain_budget* budget,
+                                       dom_climate_sample_batch* batch,
+                                       dom_climate_sample* out_sample)
+{
+    dom_domain_tile_desc desc;
+    const dom_climate_tile* tile;
+    d_bool cached;
+    if (dom_climate_build_tile_desc(domain, point, resolution, &desc) != 0) {
+        return D_FALSE;
     }
-
-    source = dom_terrain_surface_sdf(&domain->surface.terrain_surface);
-    if (!source || !source->eval) {
-        dom_climate_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_NO_SOURCE, budget);
+    cached = dom_climate_tile_cached(domain, &desc);
+    if (!cached) {
+        cost += build_cost;
+    }
+    if (!dom_domain_budget_consume(budget, cost)) {
+        return D_FALSE;
+    }
+    if (batch && !cached) {
+        /* Building may evict a tile that deferred points still read. */
+        dom_climate_sample_batch_drain(batch);
+    }
+    tile = dom_climate_tile_get((dom_climate_domain*)domain, &desc, D_TRUE);
+    if (!tile) {
+        dom_climate_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
         out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
-        return 0;
+        return D_TRUE;
+    }
+    if (!batch) {
+        dom_climate_sample_from_tile(tile, point, out_sample);
+    } else if (dom_domain_sample_bins_add(&batch->bins, tile, point_index) != 0) {
+        dom_climate_sample_batch_drain(batch);
+        (void)dom_domain_sample_bins_add(&batch->bins, tile, point_index);
     }
+    dom_climate_query_meta_ok(&out_sample->meta, resolution,
+                              DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost, budget);
+    return D_TRUE;
+}
+
+/* Resolution ladder shared by single and batched queries. The caller has
+ * initialised out_sample and checked that the domain is active with a source. */
+static void dom_climate_sample_resolve(const dom_climate_domain* domain,
+                                       const dom_domain_sdf_source* source,
+                                       const dom_domain_point* point,
+                                       u32 point_index,
+                                       dom_domain_budget* budget,
+                                       dom_climate_sample_batch* batch,
+                                       dom_climate_sample* out_sample)
+{
+    u32 cost;
+    d_bool collapsed = D_FALSE;
 
     if (!dom_domain_aabb_contains(&source->bounds, point)) {
         dom_climate_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                   DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, 0u, budget);
         out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
-        return 0;
+        return;
     }
 
-    if (domain->capsule_count > 0u) {
-        for (u32 i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
-    }
+    collapsed = (dom_domain_capsule_index_find(&domain->capsule_index, point) != DOM_DOMAIN_CAPSULE_NONE)
+        ? D_TRUE : D_FALSE;
     if (collapsed) {
         dom_climate_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                   DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
         out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN |
                              DOM_CLIMATE_SAMPLE_WIND_UNKNOWN |
                              DOM_CLIMATE_SAMPLE_COLLAPSED;
-        return 0;
+        return;
     }
 
     if (dom_climate_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_FULL)) {
@@ -1180,50 +1090,24 @@ int dom_climate_sample_query(const dom_climate_domain* domain,
             dom_climate_eval_fields(domain, point, out_sample);
             dom_climate_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_FULL,
                                       DOM_DOMAIN_CONFIDENCE_EXACT, cost, budget);
-            return 0;
+            return;
         }
     }
 
-    if (dom_climate_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_MEDIUM)) {
-        cost = domain->policy.cost_medium;
-        if (dom_climate_build_tile_desc(domain, point, DOM_DOMAIN_RES_MEDIUM, &desc) == 0) {
-            if (!dom_climate_tile_cached(domain, &desc)) {
-                cost += domain->policy.tile_build_cost_medium;
-            }
-            if (dom_domain_budget_consume(budget, cost)) {
-                const dom_climate_tile* tile = dom_climate_tile_get((dom_climate_domain*)domain, &desc, D_TRUE);
-                if (!tile) {
-                    dom_climate_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
-                    out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
-                    return 0;
-                }
-                dom_climate_sample_from_tile(tile, point, out_sample);
-                dom_climate_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_MEDIUM,
-                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost, budget);
-                return 0;
-            }
-        }
+    if (dom_climate_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_MEDIUM) &&
+        dom_climate_sample_tiled(domain, point, point_index, DOM_DOMAIN_RES_MEDIUM,
+                                 domain->policy.cost_medium,
+                                 domain->policy.tile_build_cost_medium,
+                                 budget, batch, out_sample)) {
+        return;
     }
 
-    if (dom_climate_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_COARSE)) {
-        cost = domain->policy.cost_coarse;
-        if (dom_climate_build_tile_desc(domain, point, DOM_DOMAIN_RES_COARSE, &desc) == 0) {
-            if (!dom_climate_tile_cached(domain, &desc)) {
-                cost += domain->policy.tile_build_cost_coarse;
-            }
-            if (dom_domain_budget_consume(budget, cost)) {
-                const dom_climate_tile* tile = dom_climate_tile_get((dom_climate_domain*)domain, &desc, D_TRUE);
-                if (!tile) {
-                    dom_climate_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
-                    out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
-                    return 0;
-                }
-                dom_climate_sample_from_tile(tile, point, out_sample);
-                dom_climate_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
-                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost, budget);
-                return 0;
-            }
-        }
+    if (dom_climate_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_COARSE) &&
+        dom_climate_sample_tiled(domain, point, point_index, DOM_DOMAIN_RES_COARSE,
+                                 domain->policy.cost_coarse,
+                                 domain->policy.tile_build_cost_coarse,
+                                 budget, batch, out_sample)) {
+        return;
     }
 
     if (dom_climate_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_ANALYTIC)) {
@@ -1232,12 +1116,86 @@ int dom_climate_sample_query(const dom_climate_domain* domain,
             dom_climate_eval_fields(domain, point, out_sample);
             dom_climate_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                       DOM_DOMAIN_CONFIDENCE_EXACT, cost, budget);
-            return 0;
+            return;
         }
     }
 
     dom_climate_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_BUDGET, budget);
     out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
+}
+
+static u32 dom_climate_sample_refusal(const dom_climate_domain* domain,
+                                      const dom_domain_sdf_source** out_source)
+{
+    const dom_domain_sdf_source* source;
+    *out_source = (const dom_domain_sdf_source*)0;
+    if (!dom_climate_domain_is_active(domain)) {
+        return DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE;
+    }
+    source = dom_terrain_surface_sdf(&domain->surface.terrain_surface);
+    if (!source || !source->eval) {
+        return DOM_DOMAIN_REFUSE_NO_SOURCE;
+    }
+    *out_source = source;
+    return DOM_DOMAIN_REFUSE_NONE;
+}
+
+int dom_climate_sample_query(const dom_climate_domain* domain,
+                             const dom_domain_point* point,
+                             dom_domain_budget* budget,
+                             dom_climate_sample* out_sample)
+{
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_climate_sample_init(out_sample);
+
+    refusal = dom_climate_sample_refusal(domain, &source);
+    if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+        dom_climate_query_meta_refused(&out_sample->meta, refusal, budget);
+        out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
+        return 0;
+    }
+    dom_climate_sample_resolve(domain, source, point, 0u, budget,
+                               (dom_climate_sample_batch*)0, out_sample);
+    return 0;
+}
+
+int dom_climate_sample_query_batch(const dom_climate_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   dom_domain_budget* budget,
+                                   dom_climate_sample* out_samples)
+{
+    dom_climate_sample_batch batch;
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    refusal = dom_climate_sample_refusal(domain, &source);
+    batch.points = points;
+    batch.out_samples = out_samples;
+    dom_domain_sample_bins_reset(&batch.bins);
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_climate_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_climate_sample_init(out_sample);
+        if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+            dom_climate_query_meta_refused(&out_sample->meta, refusal, budget);
+            out_sample->flags |= DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN | DOM_CLIMATE_SAMPLE_WIND_UNKNOWN;
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_climate_sample_resolve(domain, source, &point, i, budget, &batch, out_sample);
+    }
+    dom_climate_sample_batch_drain(&batch);
     return 0;
 }
 
@@ -1259,6 +1217,26 @@ static u32 dom_climate_hist_bin(q16_16 value)
     return scaled;
 }
 
+static int dom_climate_capsule_append(dom_climate_domain* domain,
+                                      const dom_climate_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_climate_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
+    return 0;
+}
+
 static int dom_climate_capsule_store(dom_climate_domain* domain,
                                      const dom_domain_tile_desc* desc)
 {
@@ -1273,7 +1251,7 @@ static int dom_climate_capsule_store(dom_climate_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_CLIMATE_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
 
@@ -1315,33 +1293,16 @@ static int dom_climate_capsule_store(dom_climate_domain* domain,
     }
 
     dom_climate_tile_free(&tile);
-    domain->capsules[domain->capsule_count++] = capsule;
-    return 0;
+    return dom_climate_capsule_append(domain, &capsule);
 }
 
 int dom_climate_domain_collapse_tile(dom_climate_domain* domain,
                                      const dom_domain_tile_desc* desc)
 {
-    u32 i;
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->cache.entries) {
-        for (i = 0u; i < domain->cache.capacity; ++i) {
-            dom_climate_cache_entry* entry = &domain->cache.entries[i];
-            if (!entry->valid) {
-                continue;
-            }
-            if (entry->domain_id == domain->surface.domain_id &&
-                entry->tile_id == desc->tile_id) {
-                dom_climate_tile_free(&entry->tile);
-                entry->valid = D_FALSE;
-                if (domain->cache.count > 0u) {
-                    domain->cache.count -= 1u;
-                }
-            }
-        }
-    }
+    dom_domain_cache_invalidate_tile(&domain->cache, domain->surface.domain_id, desc->tile_id);
     return dom_climate_capsule_store(domain, desc);
 }
 
@@ -1355,6 +1316,7 @@ int dom_climate_domain_expand_tile(dom_climate_domain* domain, u64 tile_id)
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
@@ -39,6 +39,54 @@ static void d_world_rng_seed_named(d_rng_state* rng, u32 seed)
                              D_RNG_MIX_STREAM);
 }
 
+/* Chunk offsets by D_CHUNK_NBR_*. */
+static const i32 g_chunk_nbr_dx[D_CHUNK_NBR_COUNT] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+static const i32 g_chunk_nbr_dy[D_CHUNK_NBR_COUNT] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+static u32 d_world_chunk_hash(i32 cx, i32 cy) {
+    u32 h = ((u32)cx * 0x9E3779B1u) ^ ((u32)cy * 0x85EBCA77u);
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 13;
+    return h;
+}
+
+static void d_world_chunk_hash_insert(d_world *w, u32 index) {
+    d_chunk *chunk = &w->chunks[index];
+    u32 *bucket = &w->chunk_buckets[d_world_chunk_hash(chunk->cx, chunk->cy) & w->chunk_bucket_mask];
+    chunk->hash_next = *bucket;
+    *bucket = index;
+}
+
+/* Keeps at least two buckets per chunk slot; rebuilt in index order. */
+static int d_world_reserve_buckets(d_world *w, u32 capacity) {
+    u32 bucket_count = 16u;
+    u32 *buckets;
+    u32 i;
+    while (bucket_count < capacity * 2u && bucket_count < 0x80000000u) {
+        bucket_count <<= 1u;
+    }
+    if (w->chunk_buckets && bucket_count <= w->chunk_bucket_mask + 1u) {
+        return 0;
+    }
+    buckets = (u32 *)malloc(bucket_count * sizeof(u32));
+    if (!buckets) {
+        return -1;
+    }
+    for (i = 0u; i < bucket_count; ++i) {
+        buckets[i] = D_CHUNK_INDEX_NONE;
+    }
+    if (w->chunk_buckets) {
+        free(w->chunk_buckets);
+    }
+    w->chunk_buckets = buckets;
+    w->chunk_bucket_mask = bucket_count - 1u;
+    for (i = 0u; i < w->chunk_count; ++i) {
+        d_world_chunk_hash_insert(w, i);
+    }
+    return 0;
+}
+
 static int d_world_reserve_chunks(d_world *w, u32 capacity) {
     d_chunk *new_chunks;
     u32 old_cap;
@@ -48,6 +96,9 @@ static int d_world_reserve_chunks(d_world *w, u32 capacity) {
     if (capacity <= w->chunk_capacity) {
         return 0;
     }
+    if (d_world_reserve_buckets(w, capacity) != 0) {
+        return -1;
+    }
     new_chunks = (d_chunk *)realloc(w->chunks, capacity * sizeof(d_chunk));
     if (!new_chunks) {
         return -1;
@@ -64,6 +115,34 @@ static int d_world_reserve_chunks(d_world *w, u32 capacity) {
     return 0;
 }
 
+/* Hashes a new chunk and links it with the neighbors that already exist. */
+static void d_world_chunk_link(d_world *w, u32 index) {
+    d_chunk *chunk = &w->chunks[index];
+    u32 dir;
+    d_world_chunk_hash_insert(w, index);
+    for (dir = 0u; dir < D_CHUNK_NBR_COUNT; ++dir) {
+        d_chunk *nbr = d_world_find_chunk(w, chunk->cx + g_chunk_nbr_dx[dir],
+                                          chunk->cy + g_chunk_nbr_dy[dir]);
+        if (nbr) {
+            chunk->neighbors[dir] = (u32)(nbr - w->chunks);
+            nbr->neighbors[dir ^ 2u] = index;
+        }
+    }
+}
+
+/* Undoes d_world_chunk_link for the most recently added chunk. */
+static void d_world_chunk_unlink_last(d_world *w) {
+    const u32 index = w->chunk_count - 1u;
+    d_chunk *chunk = &w->chunks[index];
+    u32 dir;
+    w->chunk_buckets[d_world_chunk_hash(chunk->cx, chunk->cy) & w->chunk_bucket_mask] = chunk->hash_next;
+    for (dir = 0u; dir < D_CHUNK_NBR_COUNT; ++dir) {
+        if (chunk->neighbors[dir] != D_CHUNK_INDEX_NONE) {
+            w->chunks[chunk->neighbors[dir]].neighbors[dir ^ 2u] = D_CHUNK_INDEX_NONE;
+        }
+    }
+}
+
 static void d_world_call_init_instance(d_world *w) {
     u32 i;
     u32 count;
@@ -98,6 +177,8 @@ d_world *d_world_create(const d_world_meta *meta) {
     w->chunks = (d_chunk *)0;
     w->chunk_count = 0u;
     w->chunk_capacity = 0u;
+    w->chunk_buckets = (u32 *)0;
+    w->chunk_bucket_mask = 0u;
     w->width = 0u;
     w->height = 0u;
     w->tick_count = 0u;
@@ -116,6 +197,9 @@ d_world *d_world_create(const d_world_meta *meta) {
     d_world_rng_seed_named(&w->rng, w->worldgen_seed);
 
     if (d_world_reserve_chunks(w, 8u) != 0) {
+        if (w->chunk_buckets) {
+            free(w->chunk_buckets);
+        }
         free(w);
         return (d_world *)0;
     }
@@ -144,26 +228,55 @@ void d_world_destroy(d_world *w) {
         free(w->chunks);
         w->chunks = (d_chunk *)0;
     }
+    if (w->chunk_buckets) {
+        free(w->chunk_buckets);
+        w->chunk_buckets = (u32 *)0;
+    }
     free(w);
 }
 
 d_chunk *d_world_find_chunk(d_world *w, i32 cx, i32 cy) {
     u32 i;
-    if (!w || !w->chunks) {
+    if (!w || !w->chunks || !w->chunk_buckets) {
         return (d_chunk *)0;
     }
-    for (i = 0u; i < w->chunk_count; ++i) {
+    i = w->chunk_buckets[d_world_chunk_hash(cx, cy) & w->chunk_bucket_mask];
+    while (i != D_CHUNK_INDEX_NONE) {
         if (w->chunks[i].cx == cx && w->chunks[i].cy == cy) {
             return &w->chunks[i];
         }
+        i = w->chunks[i].hash_next;
     }
     return (d_chunk *)0;
 }
 
+u32 d_world_chunk_index(const d_world *w, const d_chunk *chunk) {
+    if (!w || !chunk || chunk < w->chunks || chunk >= w->chunks + w->chunk_count) {
+        return D_CHUNK_INDEX_NONE;
+    }
+    return (u32)(chunk - w->chunks);
+}
+
+d_chunk *d_world_chunk_at(d_world *w, u32 index) {
+    if (!w || index >= w->chunk_count) {
+        return (d_chunk *)0;
+    }
+    return &w->chunks[index];
+}
+
+d_chunk *d_world_chunk_neighbor(d_world *w, const d_chunk *chunk, u32 dir) {
+    if (!w || !chunk || dir >= D_CHUNK_NBR_COUNT) {
+        return (d_chunk *)0;
+    }
+    return d_world_chunk_at(w, chunk->neighbors[dir]);
+}
+
 d_chunk *d_world_get_or_create_chunk(d_world *w, i32 cx, i32 cy) {
     d_chunk *chunk;
+    u32 index;
     u32 new_id;
     u32 new_cap;
+    u32 i;
     int rc;
     if (!w) {
         return (d_chunk *)0;
@@ -185,19 +298,34 @@ d_chunk *d_world_get_or_create_chunk(d_world *w, i32 cx, i32 cy) {
         }
     }
 
-    chunk = &w->chunks[w->chunk_count];
+    index = w->chunk_count;
+    chunk = &w->chunks[index];
     memset(chunk, 0, sizeof(*chunk));
     new_id = w->chunk_count + 1u;
     chunk->chunk_id = new_id;
     chunk->cx = cx;
     chunk->cy = cy;
     chunk->flags = 0u;
+    chunk->hash_next = D_CHUNK_INDEX_NONE;
+    for (i = 0u; i < D_CHUNK_NBR_COUNT; ++i) {
+        chunk->neighbors[i] = D_CHUNK_INDEX_NONE;
+    }
+    for (i = 0u; i < D_CHUNK_SLOT_COUNT; ++i) {
+        chunk->subsys_entry[i] = D_CHUNK_INDEX_NONE;
+    }
     w->chunk_count += 1u;
+    d_world_chunk_link(w, index);
 
+    /* Generators may create further chunks and move the table. */
     rc = d_world_generate_chunk(w, chunk);
+    chunk = &w->chunks[index];
     if (rc != 0) {
-        w->chunk_count -= 1u;
-        memset(chunk, 0, sizeof(*chunk));
+        /* Only the newest chunk can be rolled back; otherwise it stays. */
+        if (index + 1u == w->chunk_count) {
+            d_world_chunk_unlink_last(w);
+            w->chunk_count -= 1u;
+            memset(chunk, 0, sizeof(*chunk));
+        }
         return (d_chunk *)0;
     }
 
@@ -36,12 +36,41 @@ typedef struct d_world_meta {
     d_tlv_blob extra;        /* future metadata */
 } d_world_meta;
 
+#define D_CHUNK_INDEX_NONE 0xFFFFFFFFu
+
+/* Neighbor directions; the 4-neighborhood comes first and dir ^ 2 is the
+ * opposite direction. */
+enum {
+    D_CHUNK_NBR_EAST = 0,  /* +X */
+    D_CHUNK_NBR_NORTH,     /* +Y */
+    D_CHUNK_NBR_WEST,      /* -X */
+    D_CHUNK_NBR_SOUTH,     /* -Y */
+    D_CHUNK_NBR_NORTHEAST,
+    D_CHUNK_NBR_NORTHWEST,
+    D_CHUNK_NBR_SOUTHWEST,
+    D_CHUNK_NBR_SOUTHEAST,
+    D_CHUNK_NBR_COUNT
+};
+#define D_CHUNK_NBR4_COUNT 4u
+
+/* Per-chunk entry slots for subsystems that keep chunk-keyed tables. */
+enum {
+    D_CHUNK_SLOT_RES = 0,
+    D_CHUNK_SLOT_ENV,
+    D_CHUNK_SLOT_HYDRO,
+    D_CHUNK_SLOT_COUNT
+};
+
 typedef struct d_chunk {
     u32  chunk_id;
     i32  cx;
     i32  cy;
     u16  flags;
-    /* Subsystems can attach their own per-chunk indices via their internal tables. */
+    /* Maintained by d_world; chunk indices, D_CHUNK_INDEX_NONE when absent. */
+    u32  hash_next;
+    u32  neighbors[D_CHUNK_NBR_COUNT];
+    /* Subsystems attach their per-chunk entry index here, by D_CHUNK_SLOT_*. */
+    u32  subsys_entry[D_CHUNK_SLOT_COUNT];
 } d_chunk;
 
 typedef struct d_macro_capsule_entry {
@@ -85,10 +114,13 @@ typedef struct d_macro_event_entry {
 typedef struct d_world {
     d_world_meta meta;
 
-    /* Chunk table / map – simple growable array for now. */
+    /* Chunk table; chunks are never removed, so indices stay stable while
+     * pointers move when the table grows. Hashed on (cx, cy). */
     d_chunk *chunks;
     u32      chunk_count;
     u32      chunk_capacity;
+    u32     *chunk_buckets;
+    u32      chunk_bucket_mask;
 
     /* Internal: seed used for worldgen providers etc. */
     u64      worldgen_seed;
@@ -116,8 +148,6 @@ typedef struct d_world {
     u32 macro_event_count;
     u32 macro_event_capacity;
     u64 macro_event_sequence;
-
-    /* TODO: add spatial indexing, chunk lookup tables, etc. */
 } d_world;
 
 /* World lifecycle APIs */
@@ -127,6 +157,10 @@ void     d_world_destroy(d_world *w);
 /* Chunk management APIs */
 d_chunk *d_world_get_or_create_chunk(d_world *w, i32 cx, i32 cy);
 d_chunk *d_world_find_chunk(d_world *w, i32 cx, i32 cy);
+u32      d_world_chunk_index(const d_world *w, const d_chunk *chunk);
+d_chunk *d_world_chunk_at(d_world *w, u32 index);
+/* Cached link by D_CHUNK_NBR_*; null when that neighbor does not exist. */
+d_chunk *d_world_chunk_neighbor(d_world *w, const d_chunk *chunk, u32 dir);
 
 /* Called when a chunk is first created/generator invoked */
 int      d_world_generate_chunk(d_world *w, d_chunk *chunk);
@@ -7,43 +7,266 @@ ALLOWED DEPENDENCIES: `include/domino/**` and C89/C++98 headers only.
 FORBIDDEN DEPENDENCIES: Engine private headers outside world.
 THREADING MODEL: No internal synchronization; callers must serialize access unless stated otherwise.
 ERROR MODEL: Return codes/NULL pointers; no exceptions.
-DETERMINISM: LRU with stable insert-order tie-break.
+DETERMINISM: Exact LRU order via an intrusive list; slot reuse order is fixed by the free list.
 */
 #include "domino/world/domain_cache.h"
+#include "domino/system/dsys_perf.h"
 
 #include <stdlib.h>
 #include <string.h>
 
+static void dom_domain_cache_default_init(void* tile)
+{
+    dom_domain_tile_init((dom_domain_tile *)tile);
+}
+
+static void dom_domain_cache_default_release(void* tile)
+{
+    dom_domain_tile_free((dom_domain_tile *)tile);
+}
+
+static u32 dom_domain_cache_default_heap_bytes(const void* tile)
+{
+    return ((const dom_domain_tile *)tile)->sample_count * (u32)sizeof(q16_16);
+}
+
+static const dom_domain_cache_tile_ops g_dom_domain_cache_default_ops = {
+    (u32)sizeof(dom_domain_tile),
+    dom_domain_cache_default_init,
+    dom_domain_cache_default_release,
+    dom_domain_cache_default_heap_bytes
+};
+
+static const dom_domain_cache_tile_ops* dom_domain_cache_ops(const dom_domain_cache* cache)
+{
+    return cache->tile_ops ? cache->tile_ops : &g_dom_domain_cache_default_ops;
+}
+
+static void* dom_domain_cache_tile_at(const dom_domain_cache* cache, u32 index)
+{
+    return cache->tiles + (size_t)index * dom_domain_cache_ops(cache)->tile_size;
+}
+
+static void dom_domain_cache_tile_reset(const dom_domain_cache* cache, void* tile)
+{
+    const dom_domain_cache_tile_ops* ops = dom_domain_cache_ops(cache);
+    if (ops->init) {
+        ops->init(tile);
+    } else {
+        memset(tile, 0, ops->tile_size);
+    }
+}
+
+static u32 dom_domain_cache_hash_u64(u32 h, u64 v)
+{
+    h = (h ^ (u32)v) * 16777619u;
+    h = (h ^ (u32)(v >> 32u)) * 16777619u;
+    return h;
+}
+
+static u32 dom_domain_cache_hash_key(const dom_domain_cache_key* key)
+{
+    u32 h = 2166136261u;
+    h = dom_domain_cache_hash_u64(h, (u64)key->domain_id);
+    h = dom_domain_cache_hash_u64(h, key->tile_id);
+    h = (h ^ key->resolution) * 16777619u;
+    h = (h ^ key->authoring_version) * 16777619u;
+    h = dom_domain_cache_hash_u64(h, key->window_start);
+    h = dom_domain_cache_hash_u64(h, key->window_ticks);
+    return h ^ (h >> 15u);
+}
+
+static d_bool dom_domain_cache_key_equal(const dom_domain_cache_key* a, const dom_domain_cache_key* b)
+{
+    return (a->domain_id == b->domain_id &&
+            a->tile_id == b->tile_id &&
+            a->resolution == b->resolution &&
+            a->authoring_version == b->authoring_version &&
+            a->window_start == b->window_start &&
+            a->window_ticks == b->window_ticks) ? D_TRUE : D_FALSE;
+}
+
+static u32 dom_domain_cache_find(const dom_domain_cache* cache,
+                                 const dom_domain_cache_key* key,
+                                 u32 hash)
+{
+    u32 index;
+    if (!cache->entries || !cache->buckets) {
+        return DOM_DOMAIN_CACHE_NONE;
+    }
+    index = cache->buckets[hash & cache->bucket_mask];
+    while (index != DOM_DOMAIN_CACHE_NONE) {
+        const dom_domain_cache_entry* entry = &cache->entries[index];
+        if (entry->hash == hash && dom_domain_cache_key_equal(&entry->key, key)) {
+            return index;
+        }
+        index = entry->hash_next;
+    }
+    return DOM_DOMAIN_CACHE_NONE;
+}
+
+static void dom_domain_cache_lru_unlink(dom_domain_cache* cache, u32 index)
+{
+    dom_domain_cache_entry* entry = &cache->entries[index];
+    if (entry->lru_prev != DOM_DOMAIN_CACHE_NONE) {
+        cache->entries[entry->lru_prev].lru_next = entry->lru_next;
+    } else {
+        cache->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != DOM_DOMAIN_CACHE_NONE) {
+        cache->entries[entry->lru_next].lru_prev = entry->lru_prev;
+    } else {
+        cache->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = DOM_DOMAIN_CACHE_NONE;
+    entry->lru_next = DOM_DOMAIN_CACHE_NONE;
+}
+
+static void dom_domain_cache_lru_push_front(dom_domain_cache* cache, u32 index)
+{
+    dom_domain_cache_entry* entry = &cache->entries[index];
+    entry->lru_prev = DOM_DOMAIN_CACHE_NONE;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != DOM_DOMAIN_CACHE_NONE) {
+        cache->entries[cache->lru_head].lru_prev = index;
+    } else {
+        cache->lru_tail = index;
+    }
+    cache->lru_head = index;
+}
+
+static void dom_domain_cache_touch(dom_domain_cache* cache, u32 index)
+{
+    if (cache->lru_head == index) {
+        return;
+    }
+    dom_domain_cache_lru_unlink(cache, index);
+    dom_domain_cache_lru_push_front(cache, index);
+}
+
+static void dom_domain_cache_hash_unlink(dom_domain_cache* cache, u32 index)
+{
+    dom_domain_cache_entry* entry = &cache->entries[index];
+    u32* link = &cache->buckets[entry->hash & cache->bucket_mask];
+    while (*link != DOM_DOMAIN_CACHE_NONE) {
+        if (*link == index) {
+            *link = entry->hash_next;
+            break;
+        }
+        link = &cache->entries[*link].hash_next;
+    }
+    entry->hash_next = DOM_DOMAIN_CACHE_NONE;
+}
+
+static void dom_domain_cache_remove(dom_domain_cache* cache, u32 index)
+{
+    dom_domain_cache_entry* entry = &cache->entries[index];
+    const dom_domain_cache_tile_ops* ops = dom_domain_cache_ops(cache);
+    void* tile = dom_domain_cache_tile_at(cache, index);
+
+    dom_domain_cache_hash_unlink(cache, index);
+    dom_domain_cache_lru_unlink(cache, index);
+    if (ops->release) {
+        ops->release(tile);
+    }
+    dom_domain_cache_tile_reset(cache, tile);
+    cache->memory_used -= entry->charge;
+    entry->charge = 0u;
+    entry->valid = D_FALSE;
+    if (cache->count > 0u) {
+        cache->count -= 1u;
+    }
+    entry->hash_next = cache->free_head;
+    cache->free_head = index;
+}
+
+static void dom_domain_cache_evict_tail(dom_domain_cache* cache)
+{
+    dom_domain_cache_remove(cache, cache->lru_tail);
+    cache->stats.evictions += 1u;
+    dsys_perf_metric_add(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_EVICTIONS, 1u);
+}
+
+static int dom_domain_cache_rebuild_buckets(dom_domain_cache* cache)
+{
+    u32 bucket_count = 16u;
+    u32* buckets;
+    u32 i;
+    while (bucket_count < cache->capacity * 2u && bucket_count < 0x80000000u) {
+        bucket_count <<= 1u;
+    }
+    buckets = (u32 *)malloc(sizeof(u32) * bucket_count);
+    if (!buckets) {
+        return -1;
+    }
+    for (i = 0u; i < bucket_count; ++i) {
+        buckets[i] = DOM_DOMAIN_CACHE_NONE;
+    }
+    if (cache->buckets) {
+        free(cache->buckets);
+    }
+    cache->buckets = buckets;
+    cache->bucket_mask = bucket_count - 1u;
+    for (i = 0u; i < cache->capacity; ++i) {
+        dom_domain_cache_entry* entry = &cache->entries[i];
+        if (!entry->valid) {
+            continue;
+        }
+        entry->hash_next = buckets[entry->hash & cache->bucket_mask];
+        buckets[entry->hash & cache->bucket_mask] = i;
+    }
+    return 0;
+}
+
 void dom_domain_cache_init(dom_domain_cache* cache)
+{
+    dom_domain_cache_init_typed(cache, (const dom_domain_cache_tile_ops *)0);
+}
+
+void dom_domain_cache_init_typed(dom_domain_cache* cache, const dom_domain_cache_tile_ops* ops)
 {
     if (!cache) {
         return;
     }
     memset(cache, 0, sizeof(*cache));
+    cache->tile_ops = ops ? ops : &g_dom_domain_cache_default_ops;
+    cache->lru_head = DOM_DOMAIN_CACHE_NONE;
+    cache->lru_tail = DOM_DOMAIN_CACHE_NONE;
+    cache->free_head = DOM_DOMAIN_CACHE_NONE;
 }
 
 void dom_domain_cache_free(dom_domain_cache* cache)
 {
+    const dom_domain_cache_tile_ops* ops;
     u32 i;
     if (!cache) {
         return;
     }
-    if (cache->entries) {
+    ops = dom_domain_cache_ops(cache);
+    if (cache->entries && cache->tiles && ops->release) {
         for (i = 0u; i < cache->capacity; ++i) {
-            dom_domain_tile_free(&cache->entries[i].tile);
+            if (cache->entries[i].valid) {
+                ops->release(dom_domain_cache_tile_at(cache, i));
+            }
         }
+    }
+    if (cache->entries) {
         free(cache->entries);
-        cache->entries = (dom_domain_cache_entry *)0;
     }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
+    if (cache->tiles) {
+        free(cache->tiles);
+    }
+    if (cache->buckets) {
+        free(cache->buckets);
+    }
+    dom_domain_cache_init_typed(cache, ops);
 }
 
 int dom_domain_cache_reserve(dom_domain_cache* cache, u32 capacity)
 {
+    const dom_domain_cache_tile_ops* ops;
     dom_domain_cache_entry* new_entries;
+    unsigned char* new_tiles;
     u32 old_cap;
     u32 i;
     if (!cache) {
@@ -52,156 +275,207 @@ int dom_domain_cache_reserve(dom_domain_cache* cache, u32 capacity)
     if (capacity <= cache->capacity) {
         return 0;
     }
+    if (cache->capacity == 0u) {
+        /* Zero-filled caches never went through init. */
+        cache->lru_head = DOM_DOMAIN_CACHE_NONE;
+        cache->lru_tail = DOM_DOMAIN_CACHE_NONE;
+        cache->free_head = DOM_DOMAIN_CACHE_NONE;
+    }
+    ops = dom_domain_cache_ops(cache);
+    if (capacity > 0x7FFFFFFFu / (ops->tile_size ? ops->tile_size : 1u)) {
+        return -1;
+    }
     new_entries = (dom_domain_cache_entry *)realloc(cache->entries,
                                                     capacity * sizeof(dom_domain_cache_entry));
     if (!new_entries) {
         return -1;
     }
-    old_cap = cache->capacity;
     cache->entries = new_entries;
+    new_tiles = (unsigned char *)realloc(cache->tiles, (size_t)capacity * ops->tile_size);
+    if (!new_tiles) {
+        return -1;
+    }
+    cache->tiles = new_tiles;
+    old_cap = cache->capacity;
     cache->capacity = capacity;
-    for (i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_domain_cache_entry));
-        dom_domain_tile_init(&cache->entries[i].tile);
-        cache->entries[i].valid = D_FALSE;
+    /* Lowest new index ends up at the head of the free list. */
+    for (i = cache->capacity; i > old_cap; --i) {
+        dom_domain_cache_entry* entry = &cache->entries[i - 1u];
+        memset(entry, 0, sizeof(*entry));
+        entry->valid = D_FALSE;
+        entry->lru_prev = DOM_DOMAIN_CACHE_NONE;
+        entry->lru_next = DOM_DOMAIN_CACHE_NONE;
+        entry->hash_next = cache->free_head;
+        cache->free_head = i - 1u;
+        dom_domain_cache_tile_reset(cache, dom_domain_cache_tile_at(cache, i - 1u));
+    }
+    if (dom_domain_cache_rebuild_buckets(cache) != 0) {
+        return -1;
     }
     return 0;
 }
 
-static dom_domain_cache_entry* dom_domain_cache_find_entry(dom_domain_cache* cache,
-                                                           dom_domain_id domain_id,
-                                                           u64 tile_id,
-                                                           u32 resolution,
-                                                           u32 authoring_version)
+void dom_domain_cache_set_budget(dom_domain_cache* cache, u64 memory_budget)
 {
-    u32 i;
-    if (!cache || !cache->entries) {
-        return (dom_domain_cache_entry *)0;
+    if (!cache) {
+        return;
     }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_domain_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return entry;
-        }
+    cache->memory_budget = memory_budget;
+    while (cache->memory_budget != 0u &&
+           cache->memory_used > cache->memory_budget &&
+           cache->lru_tail != DOM_DOMAIN_CACHE_NONE) {
+        dom_domain_cache_evict_tail(cache);
     }
-    return (dom_domain_cache_entry *)0;
 }
 
-const dom_domain_tile* dom_domain_cache_peek(const dom_domain_cache* cache,
-                                             dom_domain_id domain_id,
-                                             u64 tile_id,
-                                             u32 resolution,
-                                             u32 authoring_version)
+void dom_domain_cache_key_init(dom_domain_cache_key* key,
+                               dom_domain_id domain_id,
+                               u64 tile_id,
+                               u32 resolution,
+                               u32 authoring_version)
 {
-    u32 i;
-    if (!cache || !cache->entries) {
-        return (const dom_domain_tile *)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        const dom_domain_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return &entry->tile;
-        }
+    if (!key) {
+        return;
     }
-    return (const dom_domain_tile *)0;
+    key->domain_id = domain_id;
+    key->tile_id = tile_id;
+    key->resolution = resolution;
+    key->authoring_version = authoring_version;
+    key->window_start = 0u;
+    key->window_ticks = 0u;
 }
 
-const dom_domain_tile* dom_domain_cache_get(dom_domain_cache* cache,
-                                            dom_domain_id domain_id,
-                                            u64 tile_id,
-                                            u32 resolution,
-                                            u32 authoring_version)
+const void* dom_domain_cache_peek_tile(const dom_domain_cache* cache,
+                                       const dom_domain_cache_key* key)
 {
-    dom_domain_cache_entry* entry;
-    if (!cache) {
-        return (const dom_domain_tile *)0;
+    u32 index;
+    if (!cache || !key) {
+        return (const void *)0;
     }
-    entry = dom_domain_cache_find_entry(cache, domain_id, tile_id, resolution, authoring_version);
-    if (!entry) {
-        return (const dom_domain_tile *)0;
+    index = dom_domain_cache_find(cache, key, dom_domain_cache_hash_key(key));
+    if (index == DOM_DOMAIN_CACHE_NONE) {
+        return (const void *)0;
     }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->tile;
+    return dom_domain_cache_tile_at(cache, index);
 }
 
-static dom_domain_cache_entry* dom_domain_cache_select_slot(dom_domain_cache* cache)
+void* dom_domain_cache_get_tile(dom_domain_cache* cache,
+                                const dom_domain_cache_key* key)
 {
-    u32 i;
-    dom_domain_cache_entry* best = (dom_domain_cache_entry *)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_domain_cache_entry *)0;
+    u32 index;
+    if (!cache || !key) {
+        return (void *)0;
     }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_domain_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
+    index = dom_domain_cache_find(cache, key, dom_domain_cache_hash_key(key));
+    if (index == DOM_DOMAIN_CACHE_NONE) {
+        cache->stats.misses += 1u;
+        dsys_perf_metric_add(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_MISSES, 1u);
+        return (void *)0;
     }
-    return best;
+    dom_domain_cache_touch(cache, index);
+    cache->stats.hits += 1u;
+    dsys_perf_metric_add(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_HITS, 1u);
+    return dom_domain_cache_tile_at(cache, index);
 }
 
-dom_domain_tile* dom_domain_cache_put(dom_domain_cache* cache,
-                                      dom_domain_id domain_id,
-                                      dom_domain_tile* tile)
+void* dom_domain_cache_put_tile(dom_domain_cache* cache,
+                                const dom_domain_cache_key* key,
+                                void* tile)
 {
+    const dom_domain_cache_tile_ops* ops;
     dom_domain_cache_entry* entry;
-    if (!cache || !tile) {
-        return (dom_domain_tile *)0;
+    void* slot;
+    u32 hash;
+    u32 index;
+    u32 charge;
+    if (!cache || !key || !tile) {
+        return (void *)0;
     }
     if (!cache->entries || cache->capacity == 0u) {
-        return (dom_domain_tile *)0;
-    }
-
-    entry = dom_domain_cache_find_entry(cache, domain_id, tile->tile_id,
-                                        tile->resolution, tile->authoring_version);
-    if (!entry) {
-        entry = dom_domain_cache_select_slot(cache);
+        return (void *)0;
     }
-    if (!entry) {
-        return (dom_domain_tile *)0;
+    ops = dom_domain_cache_ops(cache);
+    charge = ops->tile_size;
+    if (ops->heap_bytes) {
+        u32 heap = ops->heap_bytes(tile);
+        charge = (heap > 0xFFFFFFFFu - charge) ? 0xFFFFFFFFu : charge + heap;
     }
-    if (entry->valid) {
-        dom_domain_tile_free(&entry->tile);
+
+    hash = dom_domain_cache_hash_key(key);
+    index = dom_domain_cache_find(cache, key, hash);
+    if (index != DOM_DOMAIN_CACHE_NONE) {
+        entry = &cache->entries[index];
+        slot = dom_domain_cache_tile_at(cache, index);
+        if (ops->release) {
+            ops->release(slot);
+        }
+        cache->memory_used -= entry->charge;
+        dom_domain_cache_touch(cache, index);
     } else {
+        if (cache->free_head == DOM_DOMAIN_CACHE_NONE) {
+            dom_domain_cache_evict_tail(cache);
+        }
+        index = cache->free_head;
+        entry = &cache->entries[index];
+        cache->free_head = entry->hash_next;
+        entry->key = *key;
+        entry->hash = hash;
+        entry->hash_next = cache->buckets[hash & cache->bucket_mask];
+        cache->buckets[hash & cache->bucket_mask] = index;
+        entry->valid = D_TRUE;
+        dom_domain_cache_lru_push_front(cache, index);
         cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
+        cache->stats.inserts += 1u;
+        slot = dom_domain_cache_tile_at(cache, index);
+    }
+
+    memcpy(slot, tile, ops->tile_size);
+    dom_domain_cache_tile_reset(cache, tile);
+    entry->charge = charge;
+    cache->memory_used += charge;
+
+    /* The new entry is most recent, so the budget trims only older tiles. */
+    while (cache->memory_budget != 0u &&
+           cache->memory_used > cache->memory_budget &&
+           cache->lru_tail != index) {
+        dom_domain_cache_evict_tail(cache);
     }
+    return slot;
+}
 
-    entry->domain_id = domain_id;
-    entry->tile_id = tile->tile_id;
-    entry->resolution = tile->resolution;
-    entry->authoring_version = tile->authoring_version;
-    entry->tile = *tile;
-    entry->valid = D_TRUE;
+const dom_domain_tile* dom_domain_cache_peek(const dom_domain_cache* cache,
+                                             dom_domain_id domain_id,
+                                             u64 tile_id,
+                                             u32 resolution,
+                                             u32 authoring_version)
+{
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_domain_tile *)dom_domain_cache_peek_tile(cache, &key);
+}
 
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
+const dom_domain_tile* dom_domain_cache_get(dom_domain_cache* cache,
+                                            dom_domain_id domain_id,
+                                            u64 tile_id,
+                                            u32 resolution,
+                                            u32 authoring_version)
+{
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_domain_tile *)dom_domain_cache_get_tile(cache, &key);
+}
 
-    dom_domain_tile_init(tile);
-    return &entry->tile;
+dom_domain_tile* dom_domain_cache_put(dom_domain_cache* cache,
+                                      dom_domain_id domain_id,
+                                      dom_domain_tile* tile)
+{
+    dom_domain_cache_key key;
+    if (!tile) {
+        return (dom_domain_tile *)0;
+    }
+    dom_domain_cache_key_init(&key, domain_id, tile->tile_id,
+                              tile->resolution, tile->authoring_version);
+    return (dom_domain_tile *)dom_domain_cache_put_tile(cache, &key, tile);
 }
 
 void dom_domain_cache_invalidate_domain(dom_domain_cache* cache, dom_domain_id domain_id)
@@ -211,13 +485,22 @@ void dom_domain_cache_invalidate_domain(dom_domain_cache* cache, dom_domain_id d
         return;
     }
     for (i = 0u; i < cache->capacity; ++i) {
-        dom_domain_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            dom_domain_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
+        if (cache->entries[i].valid && cache->entries[i].key.domain_id == domain_id) {
+            dom_domain_cache_remove(cache, i);
+        }
+    }
+}
+
+void dom_domain_cache_invalidate_tile(dom_domain_cache* cache, dom_domain_id domain_id, u64 tile_id)
+{
+    u32 i;
+    if (!cache || !cache->entries) {
+        return;
+    }
+    for (i = 0u; i < cache->capacity; ++i) {
+        const dom_domain_cache_entry* entry = &cache->entries[i];
+        if (entry->valid && entry->key.domain_id == domain_id && entry->key.tile_id == tile_id) {
+            dom_domain_cache_remove(cache, i);
         }
     }
 }
@@ -229,13 +512,8 @@ void dom_domain_cache_invalidate_version(dom_domain_cache* cache, u32 authoring_
         return;
     }
     for (i = 0u; i < cache->capacity; ++i) {
-        dom_domain_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->authoring_version == authoring_version) {
-            dom_domain_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
+        if (cache->entries[i].valid && cache->entries[i].key.authoring_version == authoring_version) {
+            dom_domain_cache_remove(cache, i);
         }
     }
 }
@@ -247,11 +525,8 @@ void dom_domain_cache_invalidate_all(dom_domain_cache* cache)
         return;
     }
     for (i = 0u; i < cache->capacity; ++i) {
-        dom_domain_cache_entry* entry = &cache->entries[i];
-        if (entry->valid) {
-            dom_domain_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
+        if (cache->entries[i].valid) {
+            dom_domain_cache_remove(cache, i);
         }
     }
-    cache->count = 0u;
 }
@@ -0,0 +1,412 @@
+/*
+FILE: source/domino/world/domain_capsule_index.cpp
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino impl / world/domain_capsule_index
+RESPONSIBILITY: Implements the sorted Morton-grid index over macro capsule bounds.
+ALLOWED DEPENDENCIES: `include/domino/**` and C89/C++98 headers only.
+FORBIDDEN DEPENDENCIES: Engine private headers outside world.
+THREADING MODEL: No internal synchronization; callers must serialize access unless stated otherwise.
+ERROR MODEL: Return codes/NULL pointers; no exceptions.
+DETERMINISM: Cell keys use integer floor division; ties resolve to the lowest slot.
+*/
+#include "domino/world/domain_capsule_index.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DOM_DOMAIN_CAPSULE_CELL_BIAS ((i64)1 << 20)
+#define DOM_DOMAIN_CAPSULE_CELL_MAX (((i64)1 << 21) - 1)
+
+static i64 dom_domain_capsule_cell_coord(q16_16 value, q16_16 cell_size)
+{
+    i64 v = (i64)value;
+    i64 c = (i64)cell_size;
+    i64 q = v / c;
+    if ((v % c) != 0 && v < 0) {
+        q -= 1;
+    }
+    q += DOM_DOMAIN_CAPSULE_CELL_BIAS;
+    if (q < 0) {
+        return 0;
+    }
+    if (q > DOM_DOMAIN_CAPSULE_CELL_MAX) {
+        return DOM_DOMAIN_CAPSULE_CELL_MAX;
+    }
+    return q;
+}
+
+static u64 dom_domain_capsule_spread(u64 v)
+{
+    v &= 0x1FFFFFu;
+    v = (v | (v << 32)) & 0x1F00000000FFFFULL;
+    v = (v | (v << 16)) & 0x1F0000FF0000FFULL;
+    v = (v | (v << 8)) & 0x100F00F00F00F00FULL;
+    v = (v | (v << 4)) & 0x10C30C30C30C30C3ULL;
+    v = (v | (v << 2)) & 0x1249249249249249ULL;
+    return v;
+}
+
+static u64 dom_domain_capsule_code(i64 cx, i64 cy, i64 cz)
+{
+    return dom_domain_capsule_spread((u64)cx) |
+           (dom_domain_capsule_spread((u64)cy) << 1) |
+           (dom_domain_capsule_spread((u64)cz) << 2);
+}
+
+void* dom_domain_capsule_array_reserve(void* items, u32 item_size, u32* capacity, u32 needed)
+{
+    u32 next;
+    void* grown;
+    if (!capacity || item_size == 0u) {
+        return (void*)0;
+    }
+    if (needed <= *capacity) {
+        return items;
+    }
+    next = (*capacity > 0u) ? *capacity : 8u;
+    while (next < needed) {
+        if (next > 0x7FFFFFFFu) {
+            next = needed;
+            break;
+        }
+        next *= 2u;
+    }
+    grown = realloc(items, (size_t)next * (size_t)item_size);
+    if (!grown) {
+        return (void*)0;
+    }
+    *capacity = next;
+    return grown;
+}
+
+static int dom_domain_capsule_cells_reserve(dom_domain_capsule_index* index, u32 needed)
+{
+    void* grown = dom_domain_capsule_array_reserve(index->cells,
+                                                   (u32)sizeof(dom_domain_capsule_cell),
+                                                   &index->cell_capacity,
+                                                   needed);
+    if (!grown) {
+        return -1;
+    }
+    index->cells = (dom_domain_capsule_cell*)grown;
+    return 0;
+}
+
+/* Cell range covered by a capsule; returns D_FALSE when it must be scanned. */
+static d_bool dom_domain_capsule_span(const dom_domain_capsule_index* index,
+                                      const dom_domain_aabb* bounds,
+                                      i64 lo[3],
+                                      i64 hi[3])
+{
+    const q16_16 mins[3] = { bounds->min.x, bounds->min.y, bounds->min.z };
+    const q16_16 maxs[3] = { bounds->max.x, bounds->max.y, bounds->max.z };
+    i64 cells = 1;
+    u32 a;
+    if (index->cell_size <= 0) {
+        return D_FALSE;
+    }
+    for (a = 0u; a < 3u; ++a) {
+        if (maxs[a] < mins[a]) {
+            return D_FALSE;
+        }
+        lo[a] = dom_domain_capsule_cell_coord(mins[a], index->cell_size);
+        hi[a] = dom_domain_capsule_cell_coord(maxs[a], index->cell_size);
+        cells *= (hi[a] - lo[a] + 1);
+        if (cells > (i64)DOM_DOMAIN_CAPSULE_CELL_SPAN_MAX) {
+            return D_FALSE;
+        }
+    }
+    return D_TRUE;
+}
+
+static u32 dom_domain_capsule_lower_bound(const dom_domain_capsule_index* index, u64 code)
+{
+    u32 lo = 0u;
+    u32 hi = index->cell_count;
+    while (lo < hi) {
+        const u32 mid = lo + ((hi - lo) >> 1);
+        if (index->cells[mid].code < code) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int dom_domain_capsule_cell_cmp(const void* a, const void* b)
+{
+    const dom_domain_capsule_cell* ca = (const dom_domain_capsule_cell*)a;
+    const dom_domain_capsule_cell* cb = (const dom_domain_capsule_cell*)b;
+    if (ca->code != cb->code) {
+        return (ca->code < cb->code) ? -1 : 1;
+    }
+    if (ca->slot != cb->slot) {
+        return (ca->slot < cb->slot) ? -1 : 1;
+    }
+    return 0;
+}
+
+static u32 dom_domain_capsule_span_cells(const i64 lo[3], const i64 hi[3])
+{
+    return (u32)((hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1));
+}
+
+/* Writes the cells covered by `slot` to `out`, in scan (not code) order. */
+static void dom_domain_capsule_fill(const i64 lo[3], const i64 hi[3], u32 slot,
+                                    dom_domain_capsule_cell* out)
+{
+    i64 cx;
+    i64 cy;
+    i64 cz;
+    for (cz = lo[2]; cz <= hi[2]; ++cz) {
+        for (cy = lo[1]; cy <= hi[1]; ++cy) {
+            for (cx = lo[0]; cx <= hi[0]; ++cx) {
+                out->code = dom_domain_capsule_code(cx, cy, cz);
+                out->slot = slot;
+                ++out;
+            }
+        }
+    }
+}
+
+/* Keys `slot` into the grid. It must be the highest slot keyed so far, so
+ * placing it after equal codes keeps the (code, slot) order. The new cells
+ * are sorted past the end of the array, then merged back to front, so an
+ * insert costs O(cells + span log span) rather than a memmove per cell. */
+static int dom_domain_capsule_key(dom_domain_capsule_index* index, u32 slot)
+{
+    i64 lo[3];
+    i64 hi[3];
+    dom_domain_capsule_cell* run;
+    u32 span;
+    u32 i;
+    u32 j;
+    u32 k;
+    if (!dom_domain_capsule_span(index, &index->bounds[slot], lo, hi)) {
+        index->wide[index->wide_count++] = slot;
+        return 0;
+    }
+    span = dom_domain_capsule_span_cells(lo, hi);
+    if (dom_domain_capsule_cells_reserve(index, index->cell_count + 2u * span) != 0) {
+        return -1;
+    }
+    run = &index->cells[index->cell_count + span];
+    dom_domain_capsule_fill(lo, hi, slot, run);
+    if (span > 1u) {
+        qsort(run, span, sizeof(dom_domain_capsule_cell), dom_domain_capsule_cell_cmp);
+    }
+    i = index->cell_count;
+    j = span;
+    k = index->cell_count + span;
+    while (j > 0u) {
+        if (i > 0u && index->cells[i - 1u].code > run[j - 1u].code) {
+            index->cells[--k] = index->cells[--i];
+        } else {
+            index->cells[--k] = run[--j];
+        }
+    }
+    index->cell_count += span;
+    return 0;
+}
+
+/* Appends every slot's cells unsorted and sorts once. */
+static int dom_domain_capsule_rekey(dom_domain_capsule_index* index)
+{
+    i64 lo[3];
+    i64 hi[3];
+    u32 slot;
+    u32 span;
+    index->cell_count = 0u;
+    index->wide_count = 0u;
+    for (slot = 0u; slot < index->count; ++slot) {
+        if (!dom_domain_capsule_span(index, &index->bounds[slot], lo, hi)) {
+            index->wide[index->wide_count++] = slot;
+            continue;
+        }
+        span = dom_domain_capsule_span_cells(lo, hi);
+        if (dom_domain_capsule_cells_reserve(index, index->cell_count + span) != 0) {
+            return -1;
+        }
+        dom_domain_capsule_fill(lo, hi, slot, &index->cells[index->cell_count]);
+        index->cell_count += span;
+    }
+    if (index->cell_count > 1u) {
+        qsort(index->cells, index->cell_count, sizeof(dom_domain_capsule_cell),
+              dom_domain_capsule_cell_cmp);
+    }
+    return 0;
+}
+
+void dom_domain_capsule_index_init(dom_domain_capsule_index* index, q16_16 cell_size, u32 limit)
+{
+    if (!index) {
+        return;
+    }
+    memset(index, 0, sizeof(*index));
+    index->cell_size = cell_size;
+    index->limit = limit;
+}
+
+void dom_domain_capsule_index_free(dom_domain_capsule_index* index)
+{
+    if (!index) {
+        return;
+    }
+    free(index->bounds);
+    free(index->cells);
+    free(index->wide);
+    index->bounds = (dom_domain_aabb*)0;
+    index->cells = (dom_domain_capsule_cell*)0;
+    index->wide = (u32*)0;
+    index->count = 0u;
+    index->capacity = 0u;
+    index->cell_count = 0u;
+    index->cell_capacity = 0u;
+    index->wide_count = 0u;
+}
+
+void dom_domain_capsule_index_clear(dom_domain_capsule_index* index)
+{
+    if (!index) {
+        return;
+    }
+    index->count = 0u;
+    index->cell_count = 0u;
+    index->wide_count = 0u;
+}
+
+int dom_domain_capsule_index_set_cell_size(dom_domain_capsule_index* index, q16_16 cell_size)
+{
+    if (!index) {
+        return -1;
+    }
+    if (index->cell_size == cell_size) {
+        return 0;
+    }
+    index->cell_size = cell_size;
+    return dom_domain_capsule_rekey(index);
+}
+
+void dom_domain_capsule_index_set_limit(dom_domain_capsule_index* index, u32 limit)
+{
+    if (!index) {
+        return;
+    }
+    index->limit = limit;
+}
+
+int dom_domain_capsule_index_insert(dom_domain_capsule_index* index, const dom_domain_aabb* bounds)
+{
+    void* grown;
+    u32 capacity;
+    if (!index || !bounds) {
+        return -1;
+    }
+    if (index->limit != 0u && index->count >= index->limit) {
+        return -2;
+    }
+    if (index->count >= index->capacity) {
+        capacity = index->capacity;
+        grown = dom_domain_capsule_array_reserve(index->wide, (u32)sizeof(u32),
+                                                 &capacity, index->count + 1u);
+        if (!grown) {
+            return -1;
+        }
+        index->wide = (u32*)grown;
+        grown = dom_domain_capsule_array_reserve(index->bounds, (u32)sizeof(dom_domain_aabb),
+                                                 &index->capacity, index->count + 1u);
+        if (!grown) {
+            return -1;
+        }
+        index->bounds = (dom_domain_aabb*)grown;
+    }
+    index->bounds[index->count] = *bounds;
+    if (dom_domain_capsule_key(index, index->count) != 0) {
+        return -1;
+    }
+    index->count += 1u;
+    return 0;
+}
+
+int dom_domain_capsule_index_remove(dom_domain_capsule_index* index, u32 slot)
+{
+    u32 last;
+    u32 r;
+    u32 w;
+    u32 at;
+    if (!index || slot >= index->count) {
+        return -1;
+    }
+    last = index->count - 1u;
+    index->bounds[slot] = index->bounds[last];
+    index->count -= 1u;
+    /* One compaction pass drops `slot` and renames `last` to it. A renamed
+     * entry moves back past equal codes with higher slots, which keeps the
+     * (code, slot) order without re-sorting. */
+    w = 0u;
+    for (r = 0u; r < index->cell_count; ++r) {
+        dom_domain_capsule_cell cell = index->cells[r];
+        if (cell.slot == slot) {
+            continue;
+        }
+        at = w++;
+        if (cell.slot == last) {
+            cell.slot = slot;
+            while (at > 0u && index->cells[at - 1u].code == cell.code &&
+                   index->cells[at - 1u].slot > slot) {
+                index->cells[at] = index->cells[at - 1u];
+                --at;
+            }
+        }
+        index->cells[at] = cell;
+    }
+    index->cell_count = w;
+    w = 0u;
+    for (r = 0u; r < index->wide_count; ++r) {
+        u32 wide = index->wide[r];
+        if (wide == slot) {
+            continue;
+        }
+        at = w++;
+        if (wide == last) {
+            wide = slot;
+            while (at > 0u && index->wide[at - 1u] > slot) {
+                index->wide[at] = index->wide[at - 1u];
+                --at;
+            }
+        }
+        index->wide[at] = wide;
+    }
+    index->wide_count = w;
+    return 0;
+}
+
+u32 dom_domain_capsule_index_find(const dom_domain_capsule_index* index, const dom_domain_point* point)
+{
+    u32 best = DOM_DOMAIN_CAPSULE_NONE;
+    u32 i;
+    if (!index || !point || index->count == 0u) {
+        return DOM_DOMAIN_CAPSULE_NONE;
+    }
+    if (index->cell_count > 0u) {
+        const u64 code = dom_domain_capsule_code(dom_domain_capsule_cell_coord(point->x, index->cell_size),
+                                                 dom_domain_capsule_cell_coord(point->y, index->cell_size),
+                                                 dom_domain_capsule_cell_coord(point->z, index->cell_size));
+        for (i = dom_domain_capsule_lower_bound(index, code);
+             i < index->cell_count && index->cells[i].code == code;
+             ++i) {
+            if (dom_domain_aabb_contains(&index->bounds[index->cells[i].slot], point)) {
+                best = index->cells[i].slot;
+                break;
+            }
+        }
+    }
+    for (i = 0u; i < index->wide_count && index->wide[i] < best; ++i) {
+        if (dom_domain_aabb_contains(&index->bounds[index->wide[i]], point)) {
+            best = index->wide[i];
+            break;
+        }
+    }
+    return best;
+}
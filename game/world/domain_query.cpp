@@ -52,6 +52,75 @@ d_bool dom_domain_budget_consume(dom_domain_budget* budget, u32 cost_units)
     return D_TRUE;
 }
 
+void dom_domain_sample_bins_reset(dom_domain_sample_bins* bins)
+{
+    if (!bins) {
+        return;
+    }
+    bins->tile_count = 0u;
+    bins->point_count = 0u;
+    bins->last_slot = 0u;
+}
+
+int dom_domain_sample_bins_add(dom_domain_sample_bins* bins, const void* tile, u32 point_index)
+{
+    u32 slot;
+    if (!bins || !tile) {
+        return -1;
+    }
+    if (bins->point_count >= DOM_DOMAIN_SAMPLE_BIN_POINTS) {
+        return -1;
+    }
+    /* Neighbouring points usually share a tile; try the last one first. */
+    slot = bins->last_slot;
+    if (slot >= bins->tile_count || bins->tiles[slot] != tile) {
+        for (slot = 0u; slot < bins->tile_count; ++slot) {
+            if (bins->tiles[slot] == tile) {
+                break;
+            }
+        }
+        if (slot == bins->tile_count) {
+            if (bins->tile_count >= DOM_DOMAIN_SAMPLE_BIN_TILES) {
+                return -1;
+            }
+            bins->tiles[slot] = tile;
+            bins->tile_count += 1u;
+        }
+        bins->last_slot = slot;
+    }
+    bins->point_index[bins->point_count] = point_index;
+    bins->point_slot[bins->point_count] = slot;
+    bins->point_count += 1u;
+    return 0;
+}
+
+void dom_domain_sample_bins_group(dom_domain_sample_bins* bins)
+{
+    u32 i;
+    if (!bins) {
+        return;
+    }
+    /* Counting sort by slot; stable, so batch order holds within a tile. */
+    for (i = 0u; i <= bins->tile_count; ++i) {
+        bins->offsets[i] = 0u;
+    }
+    for (i = 0u; i < bins->point_count; ++i) {
+        bins->offsets[bins->point_slot[i] + 1u] += 1u;
+    }
+    for (i = 0u; i < bins->tile_count; ++i) {
+        bins->offsets[i + 1u] += bins->offsets[i];
+    }
+    for (i = 0u; i < bins->point_count; ++i) {
+        u32 slot = bins->point_slot[i];
+        bins->order[bins->offsets[slot]++] = bins->point_index[i];
+    }
+    /* Scattering advanced each start to the next group's start; shift back. */
+    for (i = bins->tile_count; i > 0u; --i) {
+        bins->offsets[i] = bins->offsets[i - 1u];
+    }
+    bins->offsets[0] = 0u;
+}
+
 static void dom_domain_query_meta_refused(dom_domain_query_meta* meta,
                                           u32 reason,
                                           const dom_domain_budget* budget)
@@ -106,14 +106,6 @@ static q16_16 dom_geology_noise_ratio(u64 seed,
     return d_fixed_div_q16_16(d_q16_16_add(sample, d_q16_16_from_int(1)), d_q16_16_from_int(2));
 }
 
-static void dom_geology_cache_init(dom_geology_cache* cache)
-{
-    if (!cache) {
-        return;
-    }
-    memset(cache, 0, sizeof(*cache));
-}
-
 static void dom_geology_tile_init(dom_geology_tile* tile)
 {
     if (!tile) {
@@ -146,204 +138,62 @@ static void dom_geology_tile_free(dom_geology_tile* tile)
     tile->authoring_version = 0u;
 }
 
-static void dom_geology_cache_free(dom_geology_cache* cache)
+static void dom_geology_cache_tile_init(void* tile)
 {
-    u32 i;
-    if (!cache) {
-        return;
-    }
-    if (cache->entries) {
-        for (i = 0u; i < cache->capacity; ++i) {
-            dom_geology_tile_free(&cache->entries[i].tile);
-        }
-        free(cache->entries);
-        cache->entries = (dom_geology_cache_entry *)0;
-    }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
+    dom_geology_tile_init((dom_geology_tile*)tile);
 }
 
-static int dom_geology_cache_reserve(dom_geology_cache* cache, u32 capacity)
+static void dom_geology_cache_tile_release(void* tile)
 {
-    dom_geology_cache_entry* new_entries;
-    u32 old_cap;
-    u32 i;
-    if (!cache) {
-        return -1;
-    }
-    if (capacity <= cache->capacity) {
-        return 0;
-    }
-    new_entries = (dom_geology_cache_entry *)realloc(cache->entries,
-                                                     capacity * sizeof(dom_geology_cache_entry));
-    if (!new_entries) {
-        return -1;
-    }
-    old_cap = cache->capacity;
-    cache->entries = new_entries;
-    cache->capacity = capacity;
-    for (i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_geology_cache_entry));
-        dom_geology_tile_init(&cache->entries[i].tile);
-        cache->entries[i].valid = D_FALSE;
-    }
-    return 0;
+    dom_geology_tile_free((dom_geology_tile*)tile);
 }
 
-static dom_geology_cache_entry* dom_geology_cache_find_entry(dom_geology_cache* cache,
-                                                             dom_domain_id domain_id,
-                                                             u64 tile_id,
-                                                             u32 resolution,
-                                                             u32 authoring_version)
+static u32 dom_geology_cache_tile_bytes(const void* tile)
 {
-    u32 i;
-    if (!cache || !cache->entries) {
-        return (dom_geology_cache_entry *)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_geology_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return entry;
-        }
-    }
-    return (dom_geology_cache_entry *)0;
+    const dom_geology_tile* t = (const dom_geology_tile*)tile;
+    return t->sample_count * (u32)((2u + t->resource_count) * sizeof(q16_16) + sizeof(u32));
 }
 
-static const dom_geology_tile* dom_geology_cache_peek(const dom_geology_cache* cache,
+static const dom_domain_cache_tile_ops g_dom_geology_tile_ops = {
+    (u32)sizeof(dom_geology_tile),
+    dom_geology_cache_tile_init,
+    dom_geology_cache_tile_release,
+    dom_geology_cache_tile_bytes
+};
+
+static const dom_geology_tile* dom_geology_cache_peek(const dom_domain_cache* cache,
                                                       dom_domain_id domain_id,
                                                       u64 tile_id,
                                                       u32 resolution,
                                                       u32 authoring_version)
 {
-    u32 i;
-    if (!cache || !cache->entries) {
-        return (const dom_geology_tile *)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        const dom_geology_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return &entry->tile;
-        }
-    }
-    return (const dom_geology_tile *)0;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_geology_tile*)dom_domain_cache_peek_tile(cache, &key);
 }
 
-static const dom_geology_tile* dom_geology_cache_get(dom_geology_cache* cache,
+static const dom_geology_tile* dom_geology_cache_get(dom_domain_cache* cache,
                                                      dom_domain_id domain_id,
                                                      u64 tile_id,
                                                      u32 resolution,
                                                      u32 authoring_version)
 {
-    dom_geology_cache_entry* entry;
-    if (!cache) {
-        return (const dom_geology_tile *)0;
-    }
-    entry = dom_geology_cache_find_entry(cache, domain_id, tile_id, resolution, authoring_version);
-    if (!entry) {
-        return (const dom_geology_tile *)0;
-    }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->tile;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_geology_tile*)dom_domain_cache_get_tile(cache, &key);
 }
 
-static dom_geology_cache_entry* dom_geology_cache_select_slot(dom_geology_cache* cache)
-{
-    u32 i;
-    dom_geology_cache_entry* best = (dom_geology_cache_entry *)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_geology_cache_entry *)0;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_geology_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
-    }
-    return best;
-}
-
-static dom_geology_tile* dom_geology_cache_put(dom_geology_cache* cache,
+static dom_geology_tile* dom_geology_cache_put(dom_domain_cache* cache,
                                                dom_domain_id domain_id,
                                                dom_geology_tile* tile)
 {
-    dom_geology_cache_entry* entry;
-    if (!cache || !tile) {
-        return (dom_geology_tile *)0;
-    }
-    if (!cache->entries || cache->capacity == 0u) {
-        return (dom_geology_tile *)0;
-    }
-
-    entry = dom_geology_cache_find_entry(cache, domain_id, tile->tile_id,
-                                         tile->resolution, tile->authoring_version);
-    if (!entry) {
-        entry = dom_geology_cache_select_slot(cache);
-    }
-    if (!entry) {
-        return (dom_geology_tile *)0;
-    }
-    if (entry->valid) {
-        dom_geology_tile_free(&entry->tile);
-    } else {
-        cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
-    }
-
-    entry->domain_id = domain_id;
-    entry->tile_id = tile->tile_id;
-    entry->resolution = tile->resolution;
-    entry->authoring_version = tile->authoring_version;
-    entry->tile = *tile;
-    entry->valid = D_TRUE;
-
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-
-    dom_geology_tile_init(tile);
-    return &entry->tile;
-}
-
-static void dom_geology_cache_invalidate_domain(dom_geology_cache* cache, dom_domain_id domain_id)
-{
-    u32 i;
-    if (!cache || !cache->entries) {
-        return;
-    }
-    for (i = 0u; i < cache->capacity; ++i) {
-        dom_geology_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            dom_geology_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
-        }
+    dom_domain_cache_key key;
+    if (!tile) {
+        return (dom_geology_tile*)0;
     }
+    dom_domain_cache_key_init(&key, domain_id, tile->tile_id,
+                              tile->resolution, tile->authoring_version);
+    return (dom_geology_tile*)dom_domain_cache_put_tile(cache, &key, tile);
 }
 
 static q16_16 dom_geology_step_from_extent(q16_16 extent, u32 sample_dim)
@@ -631,65 +481,87 @@ static void dom_geology_eval_fields(const dom_geology_domain* domain,
     }
 }
 
-static q16_16 dom_geology_tile_sample_scalar(const dom_geology_tile* tile,
-                                             const dom_domain_point* point,
-                                             q16_16* array)
-{
-    u32 ix;
-    u32 iy;
-    u32 iz;
+#define DOM_GEOLOGY_SAMPLE_INDEX_NONE 0xFFFFFFFFu
+
+/* Nearest-sample lookup constants for one tile, derived once per tile. */
+typedef struct dom_geology_tile_sampler {
+    const dom_geology_tile* tile;
     q16_16 step_x;
     q16_16 step_y;
     q16_16 step_z;
-    q16_16 px;
-    q16_16 py;
-    q16_16 pz;
-    if (!tile || !array || tile->sample_dim == 0u) {
-        return 0;
-    }
-    px = dom_geology_clamp_q16_16(point->x, tile->bounds.min.x, tile->bounds.max.x);
-    py = dom_geology_clamp_q16_16(point->y, tile->bounds.min.y, tile->bounds.max.y);
-    pz = dom_geology_clamp_q16_16(point->z, tile->bounds.min.z, tile->bounds.max.z);
-
-    step_x = dom_geology_step_from_extent((q16_16)(tile->bounds.max.x - tile->bounds.min.x), tile->sample_dim);
-    step_y = dom_geology_step_from_extent((q16_16)(tile->bounds.max.y - tile->bounds.min.y), tile->sample_dim);
-    step_z = dom_geology_step_from_extent((q16_16)(tile->bounds.max.z - tile->bounds.min.z), tile->sample_dim);
+} dom_geology_tile_sampler;
 
-    ix = dom_geology_sample_index_from_coord(px, tile->bounds.min.x, tile->bounds.max.x, step_x, tile->sample_dim);
-    iy = dom_geology_sample_index_from_coord(py, tile->bounds.min.y, tile->bounds.max.y, step_y, tile->sample_dim);
-    iz = dom_geology_sample_index_from_coord(pz, tile->bounds.min.z, tile->bounds.max.z, step_z, tile->sample_dim);
-
-    return array[(iz * tile->sample_dim * tile->sample_dim) + (iy * tile->sample_dim) + ix];
+static void dom_geology_tile_sampler_init(dom_geology_tile_sampler* sampler,
+                                          const dom_geology_tile* tile)
+{
+    sampler->tile = tile;
+    sampler->step_x = dom_geology_step_from_extent((q16_16)(tile->bounds.max.x - tile->bounds.min.x), tile->sample_dim);
+    sampler->step_y = dom_geology_step_from_extent((q16_16)(tile->bounds.max.y - tile->bounds.min.y), tile->sample_dim);
+    sampler->step_z = dom_geology_step_from_extent((q16_16)(tile->bounds.max.z - tile->bounds.min.z), tile->sample_dim);
 }
 
-static u32 dom_geology_tile_sample_strata(const dom_geology_tile* tile,
-                                          const dom_domain_point* point)
+static u32 dom_geology_tile_sampler_index(const dom_geology_tile_sampler* sampler,
+                                          q16_16 x,
+                                          q16_16 y,
+                                          q16_16 z)
 {
+    const dom_geology_tile* tile = sampler->tile;
     u32 ix;
     u32 iy;
     u32 iz;
-    q16_16 step_x;
-    q16_16 step_y;
-    q16_16 step_z;
-    q16_16 px;
-    q16_16 py;
-    q16_16 pz;
-    if (!tile || !tile->strata_ids || tile->sample_dim == 0u) {
-        return 0u;
-    }
-    px = dom_geology_clamp_q16_16(point->x, tile->bounds.min.x, tile->bounds.max.x);
-    py = dom_geology_clamp_q16_16(point->y, tile->bounds.min.y, tile->bounds.max.y);
-    pz = dom_geology_clamp_q16_16(point->z, tile->bounds.min.z, tile->bounds.max.z);
-
-    step_x = dom_geology_step_from_extent((q16_16)(tile->bounds.max.x - tile->bounds.min.x), tile->sample_dim);
-    step_y = dom_geology_step_from_extent((q16_16)(tile->bounds.max.y - tile->bounds.min.y), tile->sample_dim);
-    step_z = dom_geology_step_from_extent((q16_16)(tile->bounds.max.z - tile->bounds.min.z), tile->sample_dim);
+    if (tile->sample_dim == 0u) {
+        return DOM_GEOLOGY_SAMPLE_INDEX_NONE;
+    }
+    x = dom_geology_clamp_q16_16(x, tile->bounds.min.x, tile->bounds.max.x);
+    y = dom_geology_clamp_q16_16(y, tile->bounds.min.y, tile->bounds.max.y);
+    z = dom_geology_clamp_q16_16(z, tile->bounds.min.z, tile->bounds.max.z);
+    ix = dom_geology_sample_index_from_coord(x, tile->bounds.min.x, tile->bounds.max.x, sampler->step_x, tile->sample_dim);
+    iy = dom_geology_sample_index_from_coord(y, tile->bounds.min.y, tile->bounds.max.y, sampler->step_y, tile->sample_dim);
+    iz = dom_geology_sample_index_from_coord(z, tile->bounds.min.z, tile->bounds.max.z, sampler->step_z, tile->sample_dim);
+    return (iz * tile->sample_dim * tile->sample_dim) + (iy * tile->sample_dim) + ix;
+}
 
-    ix = dom_geology_sample_index_from_coord(px, tile->bounds.min.x, tile->bounds.max.x, step_x, tile->sample_dim);
-    iy = dom_geology_sample_index_from_coord(py, tile->bounds.min.y, tile->bounds.max.y, step_y, tile->sample_dim);
-    iz = dom_geology_sample_index_from_coord(pz, tile->bounds.min.z, tile->bounds.max.z, step_z, tile->sample_dim);
+static q16_16 dom_geology_tile_value(const q16_16* array, u32 idx)
+{
+    return (array && idx != DOM_GEOLOGY_SAMPLE_INDEX_NONE) ? array[idx] : 0;
+}
 
-    return tile->strata_ids[(iz * tile->sample_dim * tile->sample_dim) + (iy * tile->sample_dim) + ix];
+/* Reads the tile fields for `count` points; points[i] indexes both the
+ * coordinate arrays and out_samples. Samples must already be initialised for
+ * tile->resource_count resources; meta is left untouched. */
+static void dom_geology_tile_gather(const dom_geology_tile* tile,
+                                    const q16_16* xs,
+                                    const q16_16* ys,
+                                    const q16_16* zs,
+                                    const u32* points,
+                                    u32 count,
+                                    dom_geology_sample* out_samples)
+{
+    dom_geology_tile_sampler sampler;
+    u32 idx[DOM_DOMAIN_SAMPLE_BIN_POINTS];
+    u32 i;
+    dom_geology_tile_sampler_init(&sampler, tile);
+    for (i = 0u; i < count; ++i) {
+        const u32 p = points[i];
+        idx[i] = dom_geology_tile_sampler_index(&sampler, xs[p], ys[p], zs[p]);
+    }
+    for (i = 0u; i < count; ++i) {
+        dom_geology_sample* sample = &out_samples[points[i]];
+        const u32 k = idx[i];
+        sample->strata_layer_id = (tile->strata_ids && k != DOM_GEOLOGY_SAMPLE_INDEX_NONE)
+            ? tile->strata_ids[k]
+            : 0u;
+        sample->hardness = dom_geology_tile_value(tile->hardness, k);
+        sample->fracture_risk = dom_geology_tile_value(tile->fracture_risk, k);
+    }
+    for (u32 r = 0u; r < tile->resource_count; ++r) {
+        const q16_16* column = tile->resource_density
+            ? tile->resource_density + (r * tile->sample_count)
+            : (const q16_16*)0;
+        for (i = 0u; i < count; ++i) {
+            out_samples[points[i]].resource_density[r] = dom_geology_tile_value(column, idx[i]);
+        }
+    }
 }
 
 static int dom_geology_tile_build(dom_geology_tile* tile,
@@ -781,19 +653,12 @@ static void dom_geology_sample_from_tile(const dom_geology_tile* tile,
                                          const dom_domain_point* point,
                                          dom_geology_sample* out_sample)
 {
-    u32 resource_count;
+    const u32 first = 0u;
     if (!tile || !point || !out_sample) {
         return;
     }
-    resource_count = tile->resource_count;
-    dom_geology_sample_init(out_sample, resource_count);
-    out_sample->strata_layer_id = dom_geology_tile_sample_strata(tile, point);
-    out_sample->hardness = dom_geology_tile_sample_scalar(tile, point, tile->hardness);
-    out_sample->fracture_risk = dom_geology_tile_sample_scalar(tile, point, tile->fracture_risk);
-    for (u32 r = 0u; r < resource_count; ++r) {
-        out_sample->resource_density[r] = dom_geology_tile_sample_scalar(tile, point,
-                                                                         tile->resource_density + (r * tile->sample_count));
-    }
+    dom_geology_sample_init(out_sample, tile->resource_count);
+    dom_geology_tile_gather(tile, &point->x, &point->y, &point->z, &first, 1u, out_sample);
 }
 
 static q16_16 dom_geology_hist_bin_ratio(u32 count, u32 total)
@@ -1009,11 +874,12 @@ void dom_geology_domain_init(dom_geology_domain* domain,
     domain->existence_state = DOM_DOMAIN_EXISTENCE_REALIZED;
     domain->archival_state = DOM_DOMAIN_ARCHIVAL_LIVE;
     domain->authoring_version = 1u;
-    dom_geology_cache_init(&domain->cache);
+    dom_domain_cache_init_typed(&domain->cache, &g_dom_geology_tile_ops);
     if (cache_capacity > 0u) {
-        dom_geology_cache_reserve(&domain->cache, cache_capacity);
+        dom_domain_cache_reserve(&domain->cache, cache_capacity);
     }
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->policy.tile_size, DOM_GEOLOGY_MAX_CAPSULES);
 }
 
 void dom_geology_domain_free(dom_geology_domain* domain)
@@ -1021,8 +887,12 @@ void dom_geology_domain_free(dom_geology_domain* domain)
     if (!domain) {
         return;
     }
-    dom_geology_cache_free(&domain->cache);
+    dom_domain_cache_free(&domain->cache);
     domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_geology_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
 }
 
 void dom_geology_domain_set_state(dom_geology_domain* domain,
@@ -1035,7 +905,7 @@ void dom_geology_domain_set_state(dom_geology_domain* domain,
     if (domain->existence_state != existence_state || domain->archival_state != archival_state) {
         domain->existence_state = existence_state;
         domain->archival_state = archival_state;
-        dom_geology_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+        dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
     }
 }
 
@@ -1046,41 +916,98 @@ void dom_geology_domain_set_policy(dom_geology_domain* domain,
         return;
     }
     domain->policy = *policy;
-    dom_geology_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->policy.tile_size);
+    dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
 }
 
-int dom_geology_sample_query(const dom_geology_domain* domain,
-                             const dom_domain_point* point,
-                             dom_domain_budget* budget,
-                             dom_geology_sample* out_sample)
+/* Tile reads deferred by a batched query; NULL for single-point queries. */
+typedef struct dom_geology_sample_batch {
+    const dom_domain_point_batch* points;
+    dom_geology_sample* out_samples;
+    dom_domain_sample_bins bins;
+} dom_geology_sample_batch;
+
+static void dom_geology_sample_batch_drain(dom_geology_sample_batch* batch)
 {
-    dom_domain_tile_desc desc;
-    const dom_domain_sdf_source* source;
-    u32 cost;
-    d_bool collapsed = D_FALSE;
-    u32 resource_count;
-    if (!domain || !point || !out_sample) {
-        return -1;
+    dom_domain_sample_bins* bins = &batch->bins;
+    u32 g;
+    if (bins->point_count == 0u) {
+        return;
     }
-    resource_count = domain->surface.resource_count;
-    dom_geology_sample_init(out_sample, resource_count);
+    dom_domain_sample_bins_group(bins);
+    for (g = 0u; g < bins->tile_count; ++g) {
+        dom_geology_tile_gather((const dom_geology_tile*)bins->tiles[g],
+                                batch->points->x,
+                                batch->points->y,
+                                batch->points->z,
+                                &bins->order[bins->offsets[g]],
+                                bins->offsets[g + 1u] - bins->offsets[g],
+                                batch->out_samples);
+    }
+    dom_domain_sample_bins_reset(bins);
+}
 
-    if (!dom_geology_domain_is_active(domain)) {
-        dom_geology_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
-                             DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
-                             DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
-        return 0;
+static d_bool dom_geology_sample_tiled(const dom_geology_domain* domain,
+                                       const dom_domain_point* point,
+                                       u32 point_index,
+                                       u32 resolution,
+                                       u32 cost,
+                                       u32 build_cost,
+                                       dom_domain_budget* budget,
+                                       dom_geology_sample_batch* batch,
+                                       dom_geology_sample* out_sample)
+{
+    dom_domain_tile_desc desc;
+    const dom_geology_tile* tile;
+    d_bool cached;
+    if (dom_geology_build_tile_desc(domain, point, resolution, &desc) != 0) {
+        return D_FALSE;
     }
-
-    source = dom_terrain_surface_sdf(&domain->surface.terrain_surface);
-    if (!source || !source->eval) {
-        dom_geology_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_NO_SOURCE, budget);
+    cached = dom_geology_tile_cached(domain, &desc);
+    if (!cached) {
+        cost += build_cost;
+    }
+    if (!dom_domain_budget_consume(budget, cost)) {
+        return D_FALSE;
+    }
+    if (batch && !cached) {
+        /* Building may evict a tile that deferred points still read. */
+        dom_geology_sample_batch_drain(batch);
+    }
+    tile = dom_geology_tile_get((dom_geology_domain*)domain, &desc, D_TRUE);
+    if (!tile) {
+        dom_geology_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
         out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
                              DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
                              DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
-        return 0;
+        return D_TRUE;
+    }
+    if (!batch) {
+        dom_geology_sample_from_tile(tile, point, out_sample);
+    } else {
+        dom_geology_sample_init(out_sample, tile->resource_count);
+        if (dom_domain_sample_bins_add(&batch->bins, tile, point_index) != 0) {
+            dom_geology_sample_batch_drain(batch);
+            (void)dom_domain_sample_bins_add(&batch->bins, tile, point_index);
+        }
     }
+    dom_geology_query_meta_ok(&out_sample->meta, resolution,
+                              DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost, budget);
+    return D_TRUE;
+}
+
+/* Resolution ladder shared by single and batched queries. The caller has
+ * initialised out_sample and checked that the domain is active with a source. */
+static void dom_geology_sample_resolve(const dom_geology_domain* domain,
+                                       const dom_domain_sdf_source* source,
+                                       const dom_domain_point* point,
+                                       u32 point_index,
+                                       dom_domain_budget* budget,
+                                       dom_geology_sample_batch* batch,
+                                       dom_geology_sample* out_sample)
+{
+    u32 cost;
+    d_bool collapsed = D_FALSE;
 
     if (!dom_domain_aabb_contains(&source->bounds, point)) {
         dom_geology_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
@@ -1088,17 +1015,11 @@ int dom_geology_sample_query(const dom_geology_domain* domain,
         out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
                              DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
                              DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
-        return 0;
+        return;
     }
 
-    if (domain->capsule_count > 0u) {
-        for (u32 i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
-    }
+    collapsed = (dom_domain_capsule_index_find(&domain->capsule_index, point) != DOM_DOMAIN_CAPSULE_NONE)
+        ? D_TRUE : D_FALSE;
     if (collapsed) {
         dom_geology_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                   DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
@@ -1106,7 +1027,7 @@ int dom_geology_sample_query(const dom_geology_domain* domain,
                              DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
                              DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN |
                              DOM_GEOLOGY_SAMPLE_COLLAPSED;
-        return 0;
+        return;
     }
 
     if (dom_geology_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_FULL)) {
@@ -1115,54 +1036,24 @@ int dom_geology_sample_query(const dom_geology_domain* domain,
             dom_geology_eval_fields(domain, point, out_sample);
             dom_geology_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_FULL,
                                       DOM_DOMAIN_CONFIDENCE_EXACT, cost, budget);
-            return 0;
+            return;
         }
     }
 
-    if (dom_geology_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_MEDIUM)) {
-        cost = domain->policy.cost_medium;
-        if (dom_geology_build_tile_desc(domain, point, DOM_DOMAIN_RES_MEDIUM, &desc) == 0) {
-            if (!dom_geology_tile_cached(domain, &desc)) {
-                cost += domain->policy.tile_build_cost_medium;
-            }
-            if (dom_domain_budget_consume(budget, cost)) {
-                const dom_geology_tile* tile = dom_geology_tile_get((dom_geology_domain*)domain, &desc, D_TRUE);
-                if (!tile) {
-                    dom_geology_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
-                    out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
-                                         DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
-                                         DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
-                    return 0;
-                }
-                dom_geology_sample_from_tile(tile, point, out_sample);
-                dom_geology_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_MEDIUM,
-                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost, budget);
-                return 0;
-            }
-        }
+    if (dom_geology_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_MEDIUM) &&
+        dom_geology_sample_tiled(domain, point, point_index, DOM_DOMAIN_RES_MEDIUM,
+                                 domain->policy.cost_medium,
+                                 domain->policy.tile_build_cost_medium,
+                                 budget, batch, out_sample)) {
+        return;
     }
 
-    if (dom_geology_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_COARSE)) {
-        cost = domain->policy.cost_coarse;
-        if (dom_geology_build_tile_desc(domain, point, DOM_DOMAIN_RES_COARSE, &desc) == 0) {
-            if (!dom_geology_tile_cached(domain, &desc)) {
-                cost += domain->policy.tile_build_cost_coarse;
-            }
-            if (dom_domain_budget_consume(budget, cost)) {
-                const dom_geology_tile* tile = dom_geology_tile_get((dom_geology_domain*)domain, &desc, D_TRUE);
-                if (!tile) {
-                    dom_geology_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
-                    out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
-                                         DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
-                                         DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
-                    return 0;
-                }
-                dom_geology_sample_from_tile(tile, point, out_sample);
-                dom_geology_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
-                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost, budget);
-                return 0;
-            }
-        }
+    if (dom_geology_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_COARSE) &&
+        dom_geology_sample_tiled(domain, point, point_index, DOM_DOMAIN_RES_COARSE,
+                                 domain->policy.cost_coarse,
+                                 domain->policy.tile_build_cost_coarse,
+                                 budget, batch, out_sample)) {
+        return;
     }
 
     if (dom_geology_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_ANALYTIC)) {
@@ -1171,7 +1062,7 @@ int dom_geology_sample_query(const dom_geology_domain* domain,
             dom_geology_eval_fields(domain, point, out_sample);
             dom_geology_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                       DOM_DOMAIN_CONFIDENCE_EXACT, cost, budget);
-            return 0;
+            return;
         }
     }
 
@@ -1179,6 +1070,104 @@ int dom_geology_sample_query(const dom_geology_domain* domain,
     out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
                          DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
                          DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
+}
+
+static u32 dom_geology_sample_refusal(const dom_geology_domain* domain,
+                                      const dom_domain_sdf_source** out_source)
+{
+    const dom_domain_sdf_source* source;
+    *out_source = (const dom_domain_sdf_source*)0;
+    if (!dom_geology_domain_is_active(domain)) {
+        return DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE;
+    }
+    source = dom_terrain_surface_sdf(&domain->surface.terrain_surface);
+    if (!source || !source->eval) {
+        return DOM_DOMAIN_REFUSE_NO_SOURCE;
+    }
+    *out_source = source;
+    return DOM_DOMAIN_REFUSE_NONE;
+}
+
+int dom_geology_sample_query(const dom_geology_domain* domain,
+                             const dom_domain_point* point,
+                             dom_domain_budget* budget,
+                             dom_geology_sample* out_sample)
+{
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_geology_sample_init(out_sample, domain->surface.resource_count);
+
+    refusal = dom_geology_sample_refusal(domain, &source);
+    if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+        dom_geology_query_meta_refused(&out_sample->meta, refusal, budget);
+        out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
+                             DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
+                             DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
+        return 0;
+    }
+    dom_geology_sample_resolve(domain, source, point, 0u, budget,
+                               (dom_geology_sample_batch*)0, out_sample);
+    return 0;
+}
+
+int dom_geology_sample_query_batch(const dom_geology_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   dom_domain_budget* budget,
+                                   dom_geology_sample* out_samples)
+{
+    dom_geology_sample_batch batch;
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    refusal = dom_geology_sample_refusal(domain, &source);
+    batch.points = points;
+    batch.out_samples = out_samples;
+    dom_domain_sample_bins_reset(&batch.bins);
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_geology_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_geology_sample_init(out_sample, domain->surface.resource_count);
+        if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+            dom_geology_query_meta_refused(&out_sample->meta, refusal, budget);
+            out_sample->flags |= DOM_GEOLOGY_SAMPLE_STRATA_UNKNOWN |
+                                 DOM_GEOLOGY_SAMPLE_FIELDS_UNKNOWN |
+                                 DOM_GEOLOGY_SAMPLE_RESOURCES_UNKNOWN;
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_geology_sample_resolve(domain, source, &point, i, budget, &batch, out_sample);
+    }
+    dom_geology_sample_batch_drain(&batch);
+    return 0;
+}
+
+static int dom_geology_capsule_append(dom_geology_domain* domain,
+                                      const dom_geology_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_geology_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
     return 0;
 }
 
@@ -1196,7 +1185,7 @@ static int dom_geology_capsule_store(dom_geology_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_GEOLOGY_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
 
@@ -1253,33 +1242,16 @@ static int dom_geology_capsule_store(dom_geology_domain* domain,
     }
 
     dom_geology_tile_free(&tile);
-    domain->capsules[domain->capsule_count++] = capsule;
-    return 0;
+    return dom_geology_capsule_append(domain, &capsule);
 }
 
 int dom_geology_domain_collapse_tile(dom_geology_domain* domain,
                                      const dom_domain_tile_desc* desc)
 {
-    u32 i;
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->cache.entries) {
-        for (i = 0u; i < domain->cache.capacity; ++i) {
-            dom_geology_cache_entry* entry = &domain->cache.entries[i];
-            if (!entry->valid) {
-                continue;
-            }
-            if (entry->domain_id == domain->surface.domain_id &&
-                entry->tile_id == desc->tile_id) {
-                dom_geology_tile_free(&entry->tile);
-                entry->valid = D_FALSE;
-                if (domain->cache.count > 0u) {
-                    domain->cache.count -= 1u;
-                }
-            }
-        }
-    }
+    dom_domain_cache_invalidate_tile(&domain->cache, domain->surface.domain_id, desc->tile_id);
     return dom_geology_capsule_store(domain, desc);
 }
 
@@ -1293,6 +1265,7 @@ int dom_geology_domain_expand_tile(dom_geology_domain* domain, u64 tile_id)
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
@@ -413,20 +413,8 @@ void dom_mining_domain_set_policy(dom_mining_domain* domain,
     dom_geology_domain_set_policy(&domain->geology_domain, policy);
 }
 
-int dom_mining_sample_query(const dom_mining_domain* domain,
-                            const dom_domain_point* point,
-                            dom_domain_budget* budget,
-                            dom_mining_sample* out_sample)
+static void dom_mining_sample_reset(const dom_mining_domain* domain, dom_mining_sample* out_sample)
 {
-    dom_terrain_sample terrain;
-    dom_geology_sample geology;
-    const dom_domain_sdf_source* source;
-    u32 budget_before = 0u;
-    u32 cost_units = 0u;
-    u32 confidence = DOM_DOMAIN_CONFIDENCE_EXACT;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
     memset(out_sample, 0, sizeof(*out_sample));
     out_sample->phi = DOM_MINING_UNKNOWN_Q16;
     out_sample->support_capacity = DOM_MINING_UNKNOWN_Q16;
@@ -439,45 +427,64 @@ int dom_mining_sample_query(const dom_mining_domain* domain,
     for (u32 i = 0u; i < out_sample->resource_count; ++i) {
         out_sample->resource_density[i] = DOM_MINING_UNKNOWN_Q16;
     }
-    if (budget) {
-        budget_before = budget->used_units;
-    }
+}
+
+/* Point-independent refusals; a batch checks them once. */
+static u32 dom_mining_sample_refusal(const dom_mining_domain* domain,
+                                     const dom_domain_sdf_source** out_source)
+{
+    const dom_domain_sdf_source* source;
+    *out_source = (const dom_domain_sdf_source*)0;
     if (!dom_mining_domain_is_active(domain)) {
-        dom_mining_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE;
     }
     source = dom_terrain_surface_sdf(&domain->terrain_domain.surface);
     if (!source || !source->eval) {
-        dom_mining_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_NO_SOURCE, budget);
-        out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return DOM_DOMAIN_REFUSE_NO_SOURCE;
+    }
+    *out_source = source;
+    return DOM_DOMAIN_REFUSE_NONE;
+}
+
+static void dom_mining_sample_resolve(const dom_mining_domain* domain,
+                                      const dom_domain_sdf_source* source,
+                                      const dom_domain_point* point,
+                                      dom_domain_budget* budget,
+                                      dom_mining_sample* out_sample)
+{
+    dom_terrain_sample terrain;
+    dom_geology_sample geology;
+    u32 budget_before = 0u;
+    u32 cost_units = 0u;
+    u32 confidence = DOM_DOMAIN_CONFIDENCE_EXACT;
+    if (budget) {
+        budget_before = budget->used_units;
     }
     if (!dom_domain_aabb_contains(&source->bounds, point)) {
         dom_mining_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                  DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, 0u, budget);
         out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
     if (dom_terrain_sample_query(&domain->terrain_domain, point, budget, &terrain) != 0) {
         dom_mining_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
         out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
     if (terrain.meta.status != DOM_DOMAIN_QUERY_OK) {
         dom_mining_query_meta_refused(&out_sample->meta, terrain.meta.refusal_reason, budget);
         out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
     if (dom_geology_sample_query(&domain->geology_domain, point, budget, &geology) != 0) {
         dom_mining_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
         out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
     if (geology.meta.status != DOM_DOMAIN_QUERY_OK) {
         dom_mining_query_meta_refused(&out_sample->meta, geology.meta.refusal_reason, budget);
         out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
     if (terrain.flags & (DOM_TERRAIN_SAMPLE_FIELDS_UNKNOWN | DOM_TERRAIN_SAMPLE_PHI_UNKNOWN)) {
         out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
@@ -509,6 +516,57 @@ int dom_mining_sample_query(const dom_mining_domain* domain,
                              confidence,
                              cost_units,
                              budget);
+}
+
+int dom_mining_sample_query(const dom_mining_domain* domain,
+                            const dom_domain_point* point,
+                            dom_domain_budget* budget,
+                            dom_mining_sample* out_sample)
+{
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_mining_sample_reset(domain, out_sample);
+    refusal = dom_mining_sample_refusal(domain, &source);
+    if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+        dom_mining_query_meta_refused(&out_sample->meta, refusal, budget);
+        out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
+        return 0;
+    }
+    dom_mining_sample_resolve(domain, source, point, budget, out_sample);
+    return 0;
+}
+
+int dom_mining_sample_query_batch(const dom_mining_domain* domain,
+                                  const dom_domain_point_batch* points,
+                                  dom_domain_budget* budget,
+                                  dom_mining_sample* out_samples)
+{
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    refusal = dom_mining_sample_refusal(domain, &source);
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_mining_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_mining_sample_reset(domain, out_sample);
+        if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+            dom_mining_query_meta_refused(&out_sample->meta, refusal, budget);
+            out_sample->flags |= DOM_MINING_SAMPLE_FIELDS_UNKNOWN;
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_mining_sample_resolve(domain, source, &point, budget, out_sample);
+    }
     return 0;
 }
 
@@ -154,14 +154,6 @@ static dom_domain_point dom_struct_cell_center(q16_16 cell_size, i32 cx, i32 cy,
     return center;
 }
 
-static void dom_structure_cache_init(dom_structure_cache* cache)
-{
-    if (!cache) {
-        return;
-    }
-    memset(cache, 0, sizeof(*cache));
-}
-
 static void dom_structure_tile_init(dom_structure_tile* tile)
 {
     if (!tile) {
@@ -198,197 +190,62 @@ static void dom_structure_tile_free(dom_structure_tile* tile)
     tile->authoring_version = 0u;
 }
 
-static void dom_structure_cache_free(dom_structure_cache* cache)
+static void dom_structure_cache_tile_init(void* tile)
 {
-    if (!cache) {
-        return;
-    }
-    if (cache->entries) {
-        for (u32 i = 0u; i < cache->capacity; ++i) {
-            dom_structure_tile_free(&cache->entries[i].tile);
-        }
-        free(cache->entries);
-        cache->entries = (dom_structure_cache_entry*)0;
-    }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
+    dom_structure_tile_init((dom_structure_tile*)tile);
 }
 
-static int dom_structure_cache_reserve(dom_structure_cache* cache, u32 capacity)
+static void dom_structure_cache_tile_release(void* tile)
 {
-    dom_structure_cache_entry* new_entries;
-    u32 old_cap;
-    if (!cache) {
-        return -1;
-    }
-    if (capacity <= cache->capacity) {
-        return 0;
-    }
-    new_entries = (dom_structure_cache_entry*)realloc(cache->entries,
-                                                      capacity * sizeof(dom_structure_cache_entry));
-    if (!new_entries) {
-        return -1;
-    }
-    old_cap = cache->capacity;
-    cache->entries = new_entries;
-    cache->capacity = capacity;
-    for (u32 i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_structure_cache_entry));
-        dom_structure_tile_init(&cache->entries[i].tile);
-        cache->entries[i].valid = D_FALSE;
-    }
-    return 0;
+    dom_structure_tile_free((dom_structure_tile*)tile);
 }
 
-static dom_structure_cache_entry* dom_structure_cache_find_entry(dom_structure_cache* cache,
-                                                                 dom_domain_id domain_id,
-                                                                 u64 tile_id,
-                                                                 u32 resolution,
-                                                                 u32 authoring_version)
+static u32 dom_structure_cache_tile_bytes(const void* tile)
 {
-    if (!cache || !cache->entries) {
-        return (dom_structure_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_structure_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return entry;
-        }
-    }
-    return (dom_structure_cache_entry*)0;
+    const dom_structure_tile* t = (const dom_structure_tile*)tile;
+    return t->sample_count * (u32)(4u * sizeof(q16_16) + 3u * sizeof(u32));
 }
 
-static const dom_structure_tile* dom_structure_cache_peek(const dom_structure_cache* cache,
+static const dom_domain_cache_tile_ops g_dom_structure_tile_ops = {
+    (u32)sizeof(dom_structure_tile),
+    dom_structure_cache_tile_init,
+    dom_structure_cache_tile_release,
+    dom_structure_cache_tile_bytes
+};
+
+static const dom_structure_tile* dom_structure_cache_peek(const dom_domain_cache* cache,
                                                           dom_domain_id domain_id,
                                                           u64 tile_id,
                                                           u32 resolution,
                                                           u32 authoring_version)
 {
-    if (!cache || !cache->entries) {
-        return (const dom_structure_tile*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        const dom_structure_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version) {
-            return &entry->tile;
-        }
-    }
-    return (const dom_structure_tile*)0;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_structure_tile*)dom_domain_cache_peek_tile(cache, &key);
 }
 
-static const dom_structure_tile* dom_structure_cache_get(dom_structure_cache* cache,
+static const dom_structure_tile* dom_structure_cache_get(dom_domain_cache* cache,
                                                          dom_domain_id domain_id,
                                                          u64 tile_id,
                                                          u32 resolution,
                                                          u32 authoring_version)
 {
-    dom_structure_cache_entry* entry;
-    if (!cache) {
-        return (const dom_structure_tile*)0;
-    }
-    entry = dom_structure_cache_find_entry(cache, domain_id, tile_id, resolution, authoring_version);
-    if (!entry) {
-        return (const dom_structure_tile*)0;
-    }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->tile;
-}
-
-static dom_structure_cache_entry* dom_structure_cache_select_slot(dom_structure_cache* cache)
-{
-    dom_structure_cache_entry* best = (dom_structure_cache_entry*)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_structure_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_structure_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
-    }
-    return best;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    return (const dom_structure_tile*)dom_domain_cache_get_tile(cache, &key);
 }
 
-static dom_structure_tile* dom_structure_cache_put(dom_structure_cache* cache,
+static dom_structure_tile* dom_structure_cache_put(dom_domain_cache* cache,
                                                    dom_domain_id domain_id,
                                                    dom_structure_tile* tile)
 {
-    dom_structure_cache_entry* entry;
-    if (!cache || !tile) {
-        return (dom_structure_tile*)0;
-    }
-    if (!cache->entries || cache->capacity == 0u) {
-        return (dom_structure_tile*)0;
-    }
-    entry = dom_structure_cache_find_entry(cache, domain_id, tile->tile_id,
-                                           tile->resolution, tile->authoring_version);
-    if (!entry) {
-        entry = dom_structure_cache_select_slot(cache);
-    }
-    if (!entry) {
+    dom_domain_cache_key key;
+    if (!tile) {
         return (dom_structure_tile*)0;
     }
-    if (entry->valid) {
-        dom_structure_tile_free(&entry->tile);
-    } else {
-        cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
-    }
-
-    entry->domain_id = domain_id;
-    entry->tile_id = tile->tile_id;
-    entry->resolution = tile->resolution;
-    entry->authoring_version = tile->authoring_version;
-    entry->tile = *tile;
-    entry->valid = D_TRUE;
-
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-
-    dom_structure_tile_init(tile);
-    return &entry->tile;
-}
-
-static void dom_structure_cache_invalidate_domain(dom_structure_cache* cache, dom_domain_id domain_id)
-{
-    if (!cache || !cache->entries) {
-        return;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_structure_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            dom_structure_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
-        }
-    }
+    dom_domain_cache_key_init(&key, domain_id, tile->tile_id,
+                              tile->resolution, tile->authoring_version);
+    return (dom_structure_tile*)dom_domain_cache_put_tile(cache, &key, tile);
 }
 
 static q16_16 dom_struct_step_from_extent(q16_16 extent, u32 sample_dim)
@@ -1149,11 +1006,12 @@ void dom_structure_domain_init(dom_structure_domain* domain,
     domain->existence_state = DOM_DOMAIN_EXISTENCE_REALIZED;
     domain->archival_state = DOM_DOMAIN_ARCHIVAL_LIVE;
     domain->authoring_version = 1u;
-    dom_structure_cache_init(&domain->cache);
+    dom_domain_cache_init_typed(&domain->cache, &g_dom_structure_tile_ops);
     if (cache_capacity > 0u) {
-        dom_structure_cache_reserve(&domain->cache, cache_capacity);
+        dom_domain_cache_reserve(&domain->cache, cache_capacity);
     }
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->policy.tile_size, DOM_STRUCTURE_MAX_CAPSULES);
     dom_struct_seed_instances(domain);
 }
 
@@ -1162,10 +1020,14 @@ void dom_structure_domain_free(dom_structure_domain* domain)
     if (!domain) {
         return;
     }
-    dom_structure_cache_free(&domain->cache);
+    dom_domain_cache_free(&domain->cache);
     dom_terrain_domain_free(&domain->terrain_domain);
     dom_geology_domain_free(&domain->geology_domain);
     domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_structure_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
     domain->instance_count = 0u;
 }
 
@@ -1181,7 +1043,7 @@ void dom_structure_domain_set_state(dom_structure_domain* domain,
         domain->archival_state = archival_state;
         dom_terrain_domain_set_state(&domain->terrain_domain, existence_state, archival_state);
         dom_geology_domain_set_state(&domain->geology_domain, existence_state, archival_state);
-        dom_structure_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+        dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
     }
 }
 
@@ -1192,9 +1054,10 @@ void dom_structure_domain_set_policy(dom_structure_domain* domain,
         return;
     }
     domain->policy = *policy;
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->policy.tile_size);
     dom_terrain_domain_set_policy(&domain->terrain_domain, policy);
     dom_geology_domain_set_policy(&domain->geology_domain, policy);
-    dom_structure_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+    dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
 }
 
 static int dom_struct_build_tile_desc(const dom_structure_domain* domain,
@@ -1263,54 +1126,50 @@ static int dom_struct_build_tile_desc(const dom_structure_domain* domain,
     return 1;
 }
 
-int dom_structure_sample_query(const dom_structure_domain* domain,
-                               const dom_domain_point* point,
-                               u64 tick,
-                               dom_domain_budget* budget,
-                               dom_structure_sample* out_sample)
+/* Point-independent refusals; a batch checks them once. */
+static u32 dom_struct_sample_refusal(const dom_structure_domain* domain,
+                                     const dom_domain_sdf_source** out_source)
 {
-    dom_domain_tile_desc desc;
     const dom_domain_sdf_source* source;
+    *out_source = (const dom_domain_sdf_source*)0;
+    if (!dom_struct_domain_is_active(domain)) {
+        return DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE;
+    }
+    source = dom_terrain_surface_sdf(&domain->terrain_domain.surface);
+    if (!source || !source->eval) {
+        return DOM_DOMAIN_REFUSE_NO_SOURCE;
+    }
+    *out_source = source;
+    return DOM_DOMAIN_REFUSE_NONE;
+}
+
+static void dom_struct_sample_resolve(const dom_structure_domain* domain,
+                                      const dom_domain_sdf_source* source,
+                                      const dom_domain_point* point,
+                                      u64 tick,
+                                      dom_domain_budget* budget,
+                                      dom_structure_sample* out_sample)
+{
+    dom_domain_tile_desc desc;
     u32 budget_before = 0u;
     u32 cost_units = 0u;
     d_bool collapsed = D_FALSE;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
-    dom_struct_sample_init(out_sample);
     if (budget) {
         budget_before = budget->used_units;
     }
-    if (!dom_struct_domain_is_active(domain)) {
-        dom_struct_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
-    source = dom_terrain_surface_sdf(&domain->terrain_domain.surface);
-    if (!source || !source->eval) {
-        dom_struct_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_NO_SOURCE, budget);
-        out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
     if (!dom_domain_aabb_contains(&source->bounds, point)) {
         dom_struct_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                  DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, 0u, budget);
         out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
-    if (domain->capsule_count > 0u) {
-        for (u32 i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
+        return;
     }
+    collapsed = (dom_domain_capsule_index_find(&domain->capsule_index, point) != DOM_DOMAIN_CAPSULE_NONE)
+        ? D_TRUE : D_FALSE;
     if (collapsed) {
         dom_struct_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                  DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
         out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN | DOM_STRUCTURE_SAMPLE_COLLAPSED;
-        return 0;
+        return;
     }
 
     if (dom_struct_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_FULL)) {
@@ -1321,7 +1180,7 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
             }
             dom_struct_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_FULL,
                                      DOM_DOMAIN_CONFIDENCE_EXACT, cost_units, budget);
-            return 0;
+            return;
         }
     }
 
@@ -1336,7 +1195,7 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
                 if (!tile) {
                     dom_struct_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
                     out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
-                    return 0;
+                    return;
                 }
                 dom_struct_sample_from_tile(domain, tile, point, out_sample);
                 if (budget) {
@@ -1344,7 +1203,7 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
                 }
                 dom_struct_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_MEDIUM,
                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost_units, budget);
-                return 0;
+                return;
             }
         }
     }
@@ -1360,7 +1219,7 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
                 if (!tile) {
                     dom_struct_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
                     out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
-                    return 0;
+                    return;
                 }
                 dom_struct_sample_from_tile(domain, tile, point, out_sample);
                 if (budget) {
@@ -1368,7 +1227,7 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
                 }
                 dom_struct_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                          DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost_units, budget);
-                return 0;
+                return;
             }
         }
     }
@@ -1381,12 +1240,65 @@ int dom_structure_sample_query(const dom_structure_domain* domain,
             }
             dom_struct_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                      DOM_DOMAIN_CONFIDENCE_EXACT, cost_units, budget);
-            return 0;
+            return;
         }
     }
 
     dom_struct_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_BUDGET, budget);
     out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
+}
+
+int dom_structure_sample_query(const dom_structure_domain* domain,
+                               const dom_domain_point* point,
+                               u64 tick,
+                               dom_domain_budget* budget,
+                               dom_structure_sample* out_sample)
+{
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_struct_sample_init(out_sample);
+    refusal = dom_struct_sample_refusal(domain, &source);
+    if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+        dom_struct_query_meta_refused(&out_sample->meta, refusal, budget);
+        out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
+        return 0;
+    }
+    dom_struct_sample_resolve(domain, source, point, tick, budget, out_sample);
+    return 0;
+}
+
+int dom_structure_sample_query_batch(const dom_structure_domain* domain,
+                                     const dom_domain_point_batch* points,
+                                     u64 tick,
+                                     dom_domain_budget* budget,
+                                     dom_structure_sample* out_samples)
+{
+    const dom_domain_sdf_source* source;
+    u32 refusal;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    refusal = dom_struct_sample_refusal(domain, &source);
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_structure_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_struct_sample_init(out_sample);
+        if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+            dom_struct_query_meta_refused(&out_sample->meta, refusal, budget);
+            out_sample->flags |= DOM_STRUCTURE_SAMPLE_FIELDS_UNKNOWN;
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_struct_sample_resolve(domain, source, &point, tick, budget, out_sample);
+    }
     return 0;
 }
 
@@ -1428,6 +1340,26 @@ static u32 dom_struct_rng_cursor(const dom_structure_surface_desc* surface,
     return rng.state;
 }
 
+static int dom_struct_capsule_append(dom_structure_domain* domain,
+                                     const dom_structure_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_structure_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
+    return 0;
+}
+
 static int dom_struct_capsule_store(dom_structure_domain* domain,
                                     const dom_domain_tile_desc* desc,
                                     u64 tick)
@@ -1441,7 +1373,7 @@ static int dom_struct_capsule_store(dom_structure_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_STRUCTURE_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
     memset(integrity_bins, 0, sizeof(integrity_bins));
@@ -1493,8 +1425,7 @@ static int dom_struct_capsule_store(dom_structure_domain* domain,
     capsule.mass_total = mass_total;
 
     dom_structure_tile_free(&tile);
-    domain->capsules[domain->capsule_count++] = capsule;
-    return 0;
+    return dom_struct_capsule_append(domain, &capsule);
 }
 
 int dom_structure_domain_collapse_tile(dom_structure_domain* domain,
@@ -1504,22 +1435,7 @@ int dom_structure_domain_collapse_tile(dom_structure_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->cache.entries) {
-        for (u32 i = 0u; i < domain->cache.capacity; ++i) {
-            dom_structure_cache_entry* entry = &domain->cache.entries[i];
-            if (!entry->valid) {
-                continue;
-            }
-            if (entry->domain_id == domain->surface.domain_id &&
-                entry->tile_id == desc->tile_id) {
-                dom_structure_tile_free(&entry->tile);
-                entry->valid = D_FALSE;
-                if (domain->cache.count > 0u) {
-                    domain->cache.count -= 1u;
-                }
-            }
-        }
-    }
+    dom_domain_cache_invalidate_tile(&domain->cache, domain->surface.domain_id, desc->tile_id);
     return dom_struct_capsule_store(domain, desc, tick);
 }
 
@@ -1532,6 +1448,7 @@ int dom_structure_domain_expand_tile(dom_structure_domain* domain, u64 tile_id)
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
@@ -15,6 +15,7 @@ DETERMINISM: Fixed-point only; deterministic ordering and math.
 #include "domino/core/fixed_math.h"
 #include "domino/core/rng_model.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 static q16_16 dom_terrain_abs_q16_16(q16_16 v)
@@ -314,6 +315,7 @@ void dom_terrain_domain_init(dom_terrain_domain* domain,
     dom_domain_volume_set_cache(&domain->volume, &domain->cache);
     dom_domain_volume_set_source(&domain->volume, dom_terrain_surface_sdf(&domain->surface));
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->volume.policy.tile_size, DOM_TERRAIN_MAX_CAPSULES);
 }
 
 void dom_terrain_domain_free(dom_terrain_domain* domain)
@@ -324,6 +326,10 @@ void dom_terrain_domain_free(dom_terrain_domain* domain)
     dom_domain_volume_free(&domain->volume);
     dom_domain_cache_free(&domain->cache);
     domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_terrain_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
 }
 
 void dom_terrain_domain_set_state(dom_terrain_domain* domain,
@@ -343,6 +349,7 @@ void dom_terrain_domain_set_policy(dom_terrain_domain* domain,
         return;
     }
     dom_domain_volume_set_policy(&domain->volume, policy);
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->volume.policy.tile_size);
 }
 
 int dom_terrain_gradient(const dom_terrain_surface* surface,
@@ -414,37 +421,23 @@ static q16_16 dom_terrain_roughness_from_noise(const dom_terrain_surface* surfac
                                     0, d_q16_16_from_int(1));
 }
 
-int dom_terrain_sample_query(const dom_terrain_domain* domain,
-                             const dom_domain_point* point,
-                             dom_domain_budget* budget,
-                             dom_terrain_sample* out_sample)
+static d_bool dom_terrain_point_collapsed(const dom_terrain_domain* domain,
+                                          const dom_domain_point* point)
 {
-    dom_domain_distance_result dist;
+    return (dom_domain_capsule_index_find(&domain->capsule_index, point) != DOM_DOMAIN_CAPSULE_NONE)
+        ? D_TRUE : D_FALSE;
+}
+
+static void dom_terrain_sample_fields(const dom_terrain_domain* domain,
+                                      const dom_domain_point* point,
+                                      d_bool collapsed,
+                                      const dom_domain_distance_result* result,
+                                      dom_terrain_sample* out_sample)
+{
+    dom_domain_distance_result dist = *result;
     dom_domain_point grad;
     dom_domain_point normal;
     q16_16 len;
-    d_bool collapsed;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
-    memset(out_sample, 0, sizeof(*out_sample));
-    collapsed = D_FALSE;
-    if (domain->capsule_count > 0u) {
-        u32 i;
-        for (i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
-    }
-    if (collapsed) {
-        dom_domain_volume temp = domain->volume;
-        temp.policy.max_resolution = DOM_DOMAIN_RES_ANALYTIC;
-        dist = dom_domain_distance(&temp, point, budget);
-    } else {
-        dist = dom_domain_distance(&domain->volume, point, budget);
-    }
     out_sample->phi = dist.distance;
     out_sample->meta = dist.meta;
 
@@ -455,7 +448,7 @@ int dom_terrain_sample_query(const dom_terrain_domain* domain,
         out_sample->slope = DOM_TERRAIN_UNKNOWN_Q16;
         out_sample->travel_cost = DOM_TERRAIN_UNKNOWN_Q16;
         out_sample->flags |= DOM_TERRAIN_SAMPLE_PHI_UNKNOWN | DOM_TERRAIN_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
 
     if (collapsed) {
@@ -464,7 +457,7 @@ int dom_terrain_sample_query(const dom_terrain_domain* domain,
         out_sample->slope = DOM_TERRAIN_UNKNOWN_Q16;
         out_sample->travel_cost = DOM_TERRAIN_UNKNOWN_Q16;
         out_sample->flags |= DOM_TERRAIN_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
+        return;
     }
 
     if (dom_terrain_gradient(&domain->surface, point, &grad) != 0) {
@@ -472,7 +465,7 @@ int dom_terrain_sample_query(const dom_terrain_domain* domain,
         out_sample->roughness = DOM_TERRAIN_UNKNOWN_Q16;
         out_sample->slope = DOM_TERRAIN_UNKNOWN_Q16;
         out_sample->travel_cost = DOM_TERRAIN_UNKNOWN_Q16;
-        return 0;
+        return;
     }
 
     len = d_fixed_sqrt_q16_16(d_q16_16_add(
@@ -498,6 +491,60 @@ int dom_terrain_sample_query(const dom_terrain_domain* domain,
     out_sample->travel_cost = d_q16_16_add(out_sample->travel_cost,
                                            d_q16_16_mul(out_sample->roughness,
                                                         domain->surface.travel_cost_roughness_scale));
+}
+
+int dom_terrain_sample_query(const dom_terrain_domain* domain,
+                             const dom_domain_point* point,
+                             dom_domain_budget* budget,
+                             dom_terrain_sample* out_sample)
+{
+    dom_domain_distance_result dist;
+    d_bool collapsed;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    memset(out_sample, 0, sizeof(*out_sample));
+    collapsed = dom_terrain_point_collapsed(domain, point);
+    if (collapsed) {
+        dom_domain_volume temp = domain->volume;
+        temp.policy.max_resolution = DOM_DOMAIN_RES_ANALYTIC;
+        dist = dom_domain_distance(&temp, point, budget);
+    } else {
+        dist = dom_domain_distance(&domain->volume, point, budget);
+    }
+    dom_terrain_sample_fields(domain, point, collapsed, &dist, out_sample);
+    return 0;
+}
+
+int dom_terrain_sample_query_batch(const dom_terrain_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   dom_domain_budget* budget,
+                                   dom_terrain_sample* out_samples)
+{
+    dom_domain_volume analytic;
+    u32 i;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    /* Collapsed points fall back to the analytic volume; copy it once. */
+    analytic = domain->volume;
+    analytic.policy.max_resolution = DOM_DOMAIN_RES_ANALYTIC;
+    for (i = 0u; i < points->count; ++i) {
+        dom_terrain_sample* out_sample = &out_samples[i];
+        dom_domain_distance_result dist;
+        dom_domain_point point;
+        d_bool collapsed;
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        memset(out_sample, 0, sizeof(*out_sample));
+        collapsed = dom_terrain_point_collapsed(domain, &point);
+        dist = dom_domain_distance(collapsed ? &analytic : &domain->volume, &point, budget);
+        dom_terrain_sample_fields(domain, &point, collapsed, &dist, out_sample);
+    }
     return 0;
 }
 
@@ -512,16 +559,7 @@ d_bool dom_terrain_collision(const dom_terrain_domain* domain,
     if (!domain || !point) {
         return D_FALSE;
     }
-    collapsed = D_FALSE;
-    if (domain->capsule_count > 0u) {
-        u32 i;
-        for (i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
-    }
+    collapsed = dom_terrain_point_collapsed(domain, point);
     if (collapsed) {
         dom_domain_volume temp = domain->volume;
         temp.policy.max_resolution = DOM_DOMAIN_RES_ANALYTIC;
@@ -747,6 +785,26 @@ dom_terrain_latlon dom_terrain_local_to_latlon(const dom_terrain_shape_desc* sha
     return out;
 }
 
+static int dom_terrain_capsule_append(dom_terrain_domain* domain,
+                                      const dom_terrain_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_terrain_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
+    return 0;
+}
+
 static int dom_terrain_capsule_store(dom_terrain_domain* domain,
                                      const dom_domain_tile_desc* desc)
 {
@@ -760,7 +818,7 @@ static int dom_terrain_capsule_store(dom_terrain_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_TERRAIN_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
     corners[0] = desc->bounds.min;
@@ -791,33 +849,16 @@ static int dom_terrain_capsule_store(dom_terrain_domain* domain,
     capsule.roughness_max = rough_max;
     capsule.material_primary = domain->surface.material_primary;
 
-    domain->capsules[domain->capsule_count++] = capsule;
-    return 0;
+    return dom_terrain_capsule_append(domain, &capsule);
 }
 
 int dom_terrain_domain_collapse_tile(dom_terrain_domain* domain,
                                      const dom_domain_tile_desc* desc)
 {
-    u32 i;
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->cache.entries) {
-        for (i = 0u; i < domain->cache.capacity; ++i) {
-            dom_domain_cache_entry* entry = &domain->cache.entries[i];
-            if (!entry->valid) {
-                continue;
-            }
-            if (entry->domain_id == domain->surface.domain_id &&
-                entry->tile_id == desc->tile_id) {
-                dom_domain_tile_free(&entry->tile);
-                entry->valid = D_FALSE;
-                if (domain->cache.count > 0u) {
-                    domain->cache.count -= 1u;
-                }
-            }
-        }
-    }
+    dom_domain_cache_invalidate_tile(&domain->cache, domain->surface.domain_id, desc->tile_id);
     return dom_terrain_capsule_store(domain, desc);
 }
 
@@ -831,6 +872,7 @@ int dom_terrain_domain_expand_tile(dom_terrain_domain* domain, u64 tile_id)
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
@@ -456,6 +456,26 @@ static q16_16 dom_travel_hist_bin_ratio(u32 count, u32 total)
     return (q16_16)(((u64)count << 16) / total);
 }
 
+static int dom_travel_capsule_append(dom_travel_domain* domain,
+                                     const dom_travel_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_travel_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
+    return 0;
+}
+
 static int dom_travel_capsule_store(dom_travel_domain* domain,
                                     const dom_domain_tile_desc* desc,
                                     u64 tick)
@@ -469,7 +489,7 @@ static int dom_travel_capsule_store(dom_travel_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_TRAVEL_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
     memset(hist_bins, 0, sizeof(hist_bins));
@@ -508,9 +528,7 @@ static int dom_travel_capsule_store(dom_travel_domain* domain,
     }
 
     dom_travel_tile_free(&tile);
-    domain->capsule_count += 1u;
-    domain->capsules[domain->capsule_count - 1u] = capsule;
-    return 0;
+    return dom_travel_capsule_append(domain, &capsule);
 }
 
 static d_bool dom_travel_points_equal(const dom_domain_point* a,
@@ -1015,6 +1033,7 @@ void dom_travel_domain_init(dom_travel_domain* domain,
         dom_travel_path_cache_reserve(&domain->path_cache, desc->cache_capacity);
     }
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->policy.tile_size, DOM_TRAVEL_MAX_CAPSULES);
 }
 
 void dom_travel_domain_free(dom_travel_domain* domain)
@@ -1026,6 +1045,11 @@ void dom_travel_domain_free(dom_travel_domain* domain)
     dom_weather_domain_free(&domain->weather_domain);
     dom_structure_domain_free(&domain->structure_domain);
     dom_travel_path_cache_free(&domain->path_cache);
+    domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_travel_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
 }
 
 void dom_travel_domain_set_state(dom_travel_domain* domain,
@@ -1049,23 +1073,22 @@ void dom_travel_domain_set_policy(dom_travel_domain* domain,
         return;
     }
     domain->policy = *policy;
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->policy.tile_size);
     dom_terrain_domain_set_policy(&domain->terrain_domain, policy);
     dom_weather_domain_set_policy(&domain->weather_domain, policy);
     dom_structure_domain_set_policy(&domain->structure_domain, policy);
 }
 
-int dom_travel_sample_query(const dom_travel_domain* domain,
-                            const dom_domain_point* point,
-                            u64 tick,
-                            u32 mode_id,
-                            dom_domain_budget* budget,
-                            dom_travel_sample* out_sample)
+static void dom_travel_sample_resolve(const dom_travel_domain* domain,
+                                      const dom_domain_point* point,
+                                      u64 tick,
+                                      const dom_travel_mode_desc* mode,
+                                      dom_domain_budget* budget,
+                                      dom_travel_sample* out_sample)
 {
     dom_terrain_sample terrain;
     dom_weather_sample weather;
     dom_structure_sample structure;
-    const dom_travel_mode_desc* mode;
-    u32 mode_index = 0u;
     u32 flags = 0u;
     q16_16 base_cost = DOM_TRAVEL_UNKNOWN_Q16;
     q16_16 weather_mod = DOM_TRAVEL_UNKNOWN_Q16;
@@ -1074,24 +1097,12 @@ int dom_travel_sample_query(const dom_travel_domain* domain,
     u32 budget_before = 0u;
     d_bool collapsed = D_FALSE;
     const dom_travel_macro_capsule* capsule = 0;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
-    dom_travel_sample_init(out_sample);
-
-    if (!dom_travel_domain_is_active(domain)) {
-        out_sample->flags |= DOM_TRAVEL_SAMPLE_FIELDS_UNKNOWN;
-        dom_travel_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        return 0;
-    }
 
-    if (domain->capsule_count > 0u) {
-        for (u32 i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                capsule = &domain->capsules[i];
-                break;
-            }
+    {
+        const u32 slot = dom_domain_capsule_index_find(&domain->capsule_index, point);
+        if (slot != DOM_DOMAIN_CAPSULE_NONE) {
+            collapsed = D_TRUE;
+            capsule = &domain->capsules[slot];
         }
     }
     if (collapsed) {
@@ -1101,7 +1112,7 @@ int dom_travel_sample_query(const dom_travel_domain* domain,
         }
         dom_travel_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                  DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
-        return 0;
+        return;
     }
 
     if (budget) {
@@ -1110,7 +1121,7 @@ int dom_travel_sample_query(const dom_travel_domain* domain,
     if (!dom_domain_budget_consume(budget, domain->policy.cost_analytic)) {
         out_sample->flags |= DOM_TRAVEL_SAMPLE_FIELDS_UNKNOWN;
         dom_travel_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_BUDGET, budget);
-        return 0;
+        return;
     }
 
     if (dom_terrain_sample_query(&domain->terrain_domain, point, budget, &terrain) != 0) {
@@ -1123,7 +1134,6 @@ int dom_travel_sample_query(const dom_travel_domain* domain,
         flags |= DOM_TRAVEL_SAMPLE_FIELDS_UNKNOWN;
     }
 
-    mode = dom_travel_mode_lookup(&domain->surface, mode_id, &mode_index);
     if (!mode) {
         flags |= DOM_TRAVEL_SAMPLE_MODE_UNKNOWN;
     }
@@ -1185,6 +1195,64 @@ int dom_travel_sample_query(const dom_travel_domain* domain,
                                  : DOM_DOMAIN_CONFIDENCE_EXACT,
                                  0u, budget);
     }
+}
+
+int dom_travel_sample_query(const dom_travel_domain* domain,
+                            const dom_domain_point* point,
+                            u64 tick,
+                            u32 mode_id,
+                            dom_domain_budget* budget,
+                            dom_travel_sample* out_sample)
+{
+    const dom_travel_mode_desc* mode;
+    u32 mode_index = 0u;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_travel_sample_init(out_sample);
+
+    if (!dom_travel_domain_is_active(domain)) {
+        out_sample->flags |= DOM_TRAVEL_SAMPLE_FIELDS_UNKNOWN;
+        dom_travel_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
+        return 0;
+    }
+    mode = dom_travel_mode_lookup(&domain->surface, mode_id, &mode_index);
+    dom_travel_sample_resolve(domain, point, tick, mode, budget, out_sample);
+    return 0;
+}
+
+int dom_travel_sample_query_batch(const dom_travel_domain* domain,
+                                  const dom_domain_point_batch* points,
+                                  u64 tick,
+                                  u32 mode_id,
+                                  dom_domain_budget* budget,
+                                  dom_travel_sample* out_samples)
+{
+    const dom_travel_mode_desc* mode;
+    u32 mode_index = 0u;
+    d_bool active;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    active = dom_travel_domain_is_active(domain);
+    mode = dom_travel_mode_lookup(&domain->surface, mode_id, &mode_index);
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_travel_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_travel_sample_init(out_sample);
+        if (!active) {
+            out_sample->flags |= DOM_TRAVEL_SAMPLE_FIELDS_UNKNOWN;
+            dom_travel_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_travel_sample_resolve(domain, &point, tick, mode, budget, out_sample);
+    }
     return 0;
 }
 
@@ -1299,6 +1367,7 @@ int dom_travel_domain_expand_tile(dom_travel_domain* domain, u64 tile_id)
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
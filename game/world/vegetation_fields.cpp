@@ -161,14 +161,6 @@ static dom_domain_point dom_veg_cell_center(q16_16 cell_size, i32 cx, i32 cy, i3
     return center;
 }
 
-static void dom_vegetation_cache_init(dom_vegetation_cache* cache)
-{
-    if (!cache) {
-        return;
-    }
-    memset(cache, 0, sizeof(*cache));
-}
-
 static void dom_vegetation_tile_init(dom_vegetation_tile* tile)
 {
     if (!tile) {
@@ -211,79 +203,30 @@ static void dom_vegetation_tile_free(dom_vegetation_tile* tile)
     tile->authoring_version = 0u;
 }
 
-static void dom_vegetation_cache_free(dom_vegetation_cache* cache)
+static void dom_vegetation_cache_tile_init(void* tile)
 {
-    if (!cache) {
-        return;
-    }
-    if (cache->entries) {
-        for (u32 i = 0u; i < cache->capacity; ++i) {
-            dom_vegetation_tile_free(&cache->entries[i].tile);
-        }
-        free(cache->entries);
-        cache->entries = (dom_vegetation_cache_entry*)0;
-    }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
+    dom_vegetation_tile_init((dom_vegetation_tile*)tile);
 }
 
-static int dom_vegetation_cache_reserve(dom_vegetation_cache* cache, u32 capacity)
+static void dom_vegetation_cache_tile_release(void* tile)
 {
-    dom_vegetation_cache_entry* new_entries;
-    u32 old_cap;
-    if (!cache) {
-        return -1;
-    }
-    if (capacity <= cache->capacity) {
-        return 0;
-    }
-    new_entries = (dom_vegetation_cache_entry*)realloc(cache->entries,
-                                                       capacity * sizeof(dom_vegetation_cache_entry));
-    if (!new_entries) {
-        return -1;
-    }
-    old_cap = cache->capacity;
-    cache->entries = new_entries;
-    cache->capacity = capacity;
-    for (u32 i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_vegetation_cache_entry));
-        dom_vegetation_tile_init(&cache->entries[i].tile);
-        cache->entries[i].valid = D_FALSE;
-    }
-    return 0;
+    dom_vegetation_tile_free((dom_vegetation_tile*)tile);
 }
 
-static dom_vegetation_cache_entry* dom_vegetation_cache_find_entry(dom_vegetation_cache* cache,
-                                                                   dom_domain_id domain_id,
-                                                                   u64 tile_id,
-                                                                   u32 resolution,
-                                                                   u32 authoring_version,
-                                                                   u64 window_start,
-                                                                   u64 window_ticks)
+static u32 dom_vegetation_cache_tile_bytes(const void* tile)
 {
-    if (!cache || !cache->entries) {
-        return (dom_vegetation_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_vegetation_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version &&
-            entry->window_start == window_start &&
-            entry->window_ticks == window_ticks) {
-            return entry;
-        }
-    }
-    return (dom_vegetation_cache_entry*)0;
+    const dom_vegetation_tile* t = (const dom_vegetation_tile*)tile;
+    return t->sample_count * (u32)(4u * sizeof(q16_16) + 3u * sizeof(u32) + sizeof(u64));
 }
 
-static const dom_vegetation_tile* dom_vegetation_cache_peek(const dom_vegetation_cache* cache,
+static const dom_domain_cache_tile_ops g_dom_vegetation_tile_ops = {
+    (u32)sizeof(dom_vegetation_tile),
+    dom_vegetation_cache_tile_init,
+    dom_vegetation_cache_tile_release,
+    dom_vegetation_cache_tile_bytes
+};
+
+static const dom_vegetation_tile* dom_vegetation_cache_peek(const dom_domain_cache* cache,
                                                             dom_domain_id domain_id,
                                                             u64 tile_id,
                                                             u32 resolution,
@@ -291,27 +234,14 @@ static const dom_vegetation_tile* dom_vegetation_cache_peek(const dom_vegetation
                                                             u64 window_start,
                                                             u64 window_ticks)
 {
-    if (!cache || !cache->entries) {
-        return (const dom_vegetation_tile*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        const dom_vegetation_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->tile_id == tile_id &&
-            entry->resolution == resolution &&
-            entry->authoring_version == authoring_version &&
-            entry->window_start == window_start &&
-            entry->window_ticks == window_ticks) {
-            return &entry->tile;
-        }
-    }
-    return (const dom_vegetation_tile*)0;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    key.window_start = window_start;
+    key.window_ticks = window_ticks;
+    return (const dom_vegetation_tile*)dom_domain_cache_peek_tile(cache, &key);
 }
 
-static const dom_vegetation_tile* dom_vegetation_cache_get(dom_vegetation_cache* cache,
+static const dom_vegetation_tile* dom_vegetation_cache_get(dom_domain_cache* cache,
                                                            dom_domain_id domain_id,
                                                            u64 tile_id,
                                                            u32 resolution,
@@ -319,103 +249,26 @@ static const dom_vegetation_tile* dom_vegetation_cache_get(dom_vegetation_cache*
                                                            u64 window_start,
                                                            u64 window_ticks)
 {
-    dom_vegetation_cache_entry* entry;
-    if (!cache) {
-        return (const dom_vegetation_tile*)0;
-    }
-    entry = dom_vegetation_cache_find_entry(cache, domain_id, tile_id, resolution,
-                                            authoring_version, window_start, window_ticks);
-    if (!entry) {
-        return (const dom_vegetation_tile*)0;
-    }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->tile;
+    dom_domain_cache_key key;
+    dom_domain_cache_key_init(&key, domain_id, tile_id, resolution, authoring_version);
+    key.window_start = window_start;
+    key.window_ticks = window_ticks;
+    return (const dom_vegetation_tile*)dom_domain_cache_get_tile(cache, &key);
 }
 
-static dom_vegetation_cache_entry* dom_vegetation_cache_select_slot(dom_vegetation_cache* cache)
-{
-    dom_vegetation_cache_entry* best = (dom_vegetation_cache_entry*)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_vegetation_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_vegetation_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
-    }
-    return best;
-}
-
-static dom_vegetation_tile* dom_vegetation_cache_put(dom_vegetation_cache* cache,
+static dom_vegetation_tile* dom_vegetation_cache_put(dom_domain_cache* cache,
                                                      dom_domain_id domain_id,
                                                      dom_vegetation_tile* tile)
 {
-    dom_vegetation_cache_entry* entry;
-    if (!cache || !tile) {
-        return (dom_vegetation_tile*)0;
-    }
-    if (!cache->entries || cache->capacity == 0u) {
-        return (dom_vegetation_tile*)0;
-    }
-    entry = dom_vegetation_cache_find_entry(cache, domain_id, tile->tile_id,
-                                            tile->resolution, tile->authoring_version,
-                                            tile->window_start, tile->window_ticks);
-    if (!entry) {
-        entry = dom_vegetation_cache_select_slot(cache);
-    }
-    if (!entry) {
+    dom_domain_cache_key key;
+    if (!tile) {
         return (dom_vegetation_tile*)0;
     }
-    if (entry->valid) {
-        dom_vegetation_tile_free(&entry->tile);
-    } else {
-        cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
-    }
-
-    entry->domain_id = domain_id;
-    entry->tile_id = tile->tile_id;
-    entry->resolution = tile->resolution;
-    entry->authoring_version = tile->authoring_version;
-    entry->window_start = tile->window_start;
-    entry->window_ticks = tile->window_ticks;
-    entry->tile = *tile;
-    entry->valid = D_TRUE;
-
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-
-    dom_vegetation_tile_init(tile);
-    return &entry->tile;
-}
-
-static void dom_vegetation_cache_invalidate_domain(dom_vegetation_cache* cache, dom_domain_id domain_id)
-{
-    if (!cache || !cache->entries) {
-        return;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_vegetation_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            dom_vegetation_tile_free(&entry->tile);
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
-        }
-    }
+    dom_domain_cache_key_init(&key, domain_id, tile->tile_id,
+                              tile->resolution, tile->authoring_version);
+    key.window_start = tile->window_start;
+    key.window_ticks = tile->window_ticks;
+    return (dom_vegetation_tile*)dom_domain_cache_put_tile(cache, &key, tile);
 }
 
 static q16_16 dom_veg_step_from_extent(q16_16 extent, u32 sample_dim)
@@ -1392,11 +1245,12 @@ void dom_vegetation_domain_init(dom_vegetation_domain* domain,
     domain->existence_state = DOM_DOMAIN_EXISTENCE_REALIZED;
     domain->archival_state = DOM_DOMAIN_ARCHIVAL_LIVE;
     domain->authoring_version = 1u;
-    dom_vegetation_cache_init(&domain->cache);
+    dom_domain_cache_init_typed(&domain->cache, &g_dom_vegetation_tile_ops);
     if (cache_capacity > 0u) {
-        dom_vegetation_cache_reserve(&domain->cache, cache_capacity);
+        dom_domain_cache_reserve(&domain->cache, cache_capacity);
     }
     domain->capsule_count = 0u;
+    dom_domain_capsule_index_init(&domain->capsule_index, domain->policy.tile_size, DOM_VEG_MAX_CAPSULES);
 }
 
 void dom_vegetation_domain_free(dom_vegetation_domain* domain)
@@ -1404,12 +1258,16 @@ void dom_vegetation_domain_free(dom_vegetation_domain* domain)
     if (!domain) {
         return;
     }
-    dom_vegetation_cache_free(&domain->cache);
+    dom_domain_cache_free(&domain->cache);
     dom_terrain_domain_free(&domain->terrain_domain);
     dom_climate_domain_free(&domain->climate_domain);
     dom_weather_domain_free(&domain->weather_domain);
     dom_geology_domain_free(&domain->geology_domain);
     domain->capsule_count = 0u;
+    free(domain->capsules);
+    domain->capsules = (dom_vegetation_macro_capsule*)0;
+    domain->capsule_capacity = 0u;
+    dom_domain_capsule_index_free(&domain->capsule_index);
 }
 
 void dom_vegetation_domain_set_state(dom_vegetation_domain* domain,
@@ -1426,7 +1284,7 @@ void dom_vegetation_domain_set_state(dom_vegetation_domain* domain,
         dom_climate_domain_set_state(&domain->climate_domain, existence_state, archival_state);
         dom_weather_domain_set_state(&domain->weather_domain, existence_state, archival_state);
         dom_geology_domain_set_state(&domain->geology_domain, existence_state, archival_state);
-        dom_vegetation_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+        dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
     }
 }
 
@@ -1437,70 +1295,70 @@ void dom_vegetation_domain_set_policy(dom_vegetation_domain* domain,
         return;
     }
     domain->policy = *policy;
+    (void)dom_domain_capsule_index_set_cell_size(&domain->capsule_index, domain->policy.tile_size);
     dom_terrain_domain_set_policy(&domain->terrain_domain, policy);
     dom_climate_domain_set_policy(&domain->climate_domain, policy);
     dom_weather_domain_set_policy(&domain->weather_domain, policy);
     dom_geology_domain_set_policy(&domain->geology_domain, policy);
-    dom_vegetation_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
+    dom_domain_cache_invalidate_domain(&domain->cache, domain->surface.domain_id);
 }
 
-int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
-                                const dom_domain_point* point,
-                                u64 tick,
-                                dom_domain_budget* budget,
-                                dom_vegetation_sample* out_sample)
+/* Point-independent refusals; a batch checks them once. */
+static u32 dom_veg_sample_refusal(const dom_vegetation_domain* domain,
+                                  const dom_domain_sdf_source** out_source)
 {
-    dom_domain_tile_desc desc;
     const dom_domain_sdf_source* source;
+    *out_source = (const dom_domain_sdf_source*)0;
+    if (!dom_veg_domain_is_active(domain)) {
+        return DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE;
+    }
+    source = dom_terrain_surface_sdf(&domain->terrain_domain.surface);
+    if (!source || !source->eval) {
+        return DOM_DOMAIN_REFUSE_NO_SOURCE;
+    }
+    *out_source = source;
+    return DOM_DOMAIN_REFUSE_NONE;
+}
+
+/* Tiles and fields are evaluated at the start of the window holding `tick`. */
+static void dom_veg_sample_window(const dom_vegetation_domain* domain, u64 tick,
+                                  u64* out_window_start, u64* out_window_ticks)
+{
+    *out_window_ticks = domain->surface.weather_window_ticks;
+    *out_window_start = dom_veg_window_start(tick, *out_window_ticks);
+}
+
+static void dom_veg_sample_resolve(const dom_vegetation_domain* domain,
+                                   const dom_domain_sdf_source* source,
+                                   const dom_domain_point* point,
+                                   u64 window_start,
+                                   u64 window_ticks,
+                                   dom_domain_budget* budget,
+                                   dom_vegetation_sample* out_sample)
+{
+    dom_domain_tile_desc desc;
+    const u64 eval_tick = window_start;
     u32 budget_before = 0u;
     u32 cost_units = 0u;
     d_bool collapsed = D_FALSE;
-    u64 window_ticks;
-    u64 window_start;
-    u64 eval_tick;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
-    dom_vegetation_sample_init(out_sample);
     if (budget) {
         budget_before = budget->used_units;
     }
-    if (!dom_veg_domain_is_active(domain)) {
-        dom_veg_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
-        out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
-    source = dom_terrain_surface_sdf(&domain->terrain_domain.surface);
-    if (!source || !source->eval) {
-        dom_veg_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_NO_SOURCE, budget);
-        out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
     if (!dom_domain_aabb_contains(&source->bounds, point)) {
         dom_veg_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                               DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, 0u, budget);
         out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
-        return 0;
-    }
-    if (domain->capsule_count > 0u) {
-        for (u32 i = 0u; i < domain->capsule_count; ++i) {
-            if (dom_domain_aabb_contains(&domain->capsules[i].bounds, point)) {
-                collapsed = D_TRUE;
-                break;
-            }
-        }
+        return;
     }
+    collapsed = (dom_domain_capsule_index_find(&domain->capsule_index, point) != DOM_DOMAIN_CAPSULE_NONE)
+        ? D_TRUE : D_FALSE;
     if (collapsed) {
         dom_veg_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                               DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
         out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN | DOM_VEG_SAMPLE_COLLAPSED;
-        return 0;
+        return;
     }
 
-    window_ticks = domain->surface.weather_window_ticks;
-    window_start = dom_veg_window_start(tick, window_ticks);
-    eval_tick = window_start;
-
     if (dom_veg_resolution_allowed(domain->policy.max_resolution, DOM_DOMAIN_RES_FULL)) {
         if (dom_domain_budget_consume(budget, domain->policy.cost_full)) {
             dom_veg_eval_fields(domain, point, eval_tick, budget, out_sample);
@@ -1509,7 +1367,7 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
             }
             dom_veg_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_FULL,
                                   DOM_DOMAIN_CONFIDENCE_EXACT, cost_units, budget);
-            return 0;
+            return;
         }
     }
 
@@ -1526,7 +1384,7 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
                 if (!tile) {
                     dom_veg_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
                     out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
-                    return 0;
+                    return;
                 }
                 dom_vegetation_sample_from_tile(domain, tile, point, out_sample);
                 if (budget) {
@@ -1534,7 +1392,7 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
                 }
                 dom_veg_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_MEDIUM,
                                       DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost_units, budget);
-                return 0;
+                return;
             }
         }
     }
@@ -1552,7 +1410,7 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
                 if (!tile) {
                     dom_veg_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_INTERNAL, budget);
                     out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
-                    return 0;
+                    return;
                 }
                 dom_vegetation_sample_from_tile(domain, tile, point, out_sample);
                 if (budget) {
@@ -1560,7 +1418,7 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
                 }
                 dom_veg_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_COARSE,
                                       DOM_DOMAIN_CONFIDENCE_LOWER_BOUND, cost_units, budget);
-                return 0;
+                return;
             }
         }
     }
@@ -1573,12 +1431,73 @@ int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
             }
             dom_veg_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                   DOM_DOMAIN_CONFIDENCE_EXACT, cost_units, budget);
-            return 0;
+            return;
         }
     }
 
     dom_veg_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_BUDGET, budget);
     out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
+}
+
+int dom_vegetation_sample_query(const dom_vegetation_domain* domain,
+                                const dom_domain_point* point,
+                                u64 tick,
+                                dom_domain_budget* budget,
+                                dom_vegetation_sample* out_sample)
+{
+    const dom_domain_sdf_source* source;
+    u64 window_start;
+    u64 window_ticks;
+    u32 refusal;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_vegetation_sample_init(out_sample);
+    refusal = dom_veg_sample_refusal(domain, &source);
+    if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+        dom_veg_query_meta_refused(&out_sample->meta, refusal, budget);
+        out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
+        return 0;
+    }
+    dom_veg_sample_window(domain, tick, &window_start, &window_ticks);
+    dom_veg_sample_resolve(domain, source, point, window_start, window_ticks, budget, out_sample);
+    return 0;
+}
+
+int dom_vegetation_sample_query_batch(const dom_vegetation_domain* domain,
+                                      const dom_domain_point_batch* points,
+                                      u64 tick,
+                                      dom_domain_budget* budget,
+                                      dom_vegetation_sample* out_samples)
+{
+    const dom_domain_sdf_source* source;
+    u64 window_start = 0u;
+    u64 window_ticks = 0u;
+    u32 refusal;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    refusal = dom_veg_sample_refusal(domain, &source);
+    if (refusal == DOM_DOMAIN_REFUSE_NONE) {
+        dom_veg_sample_window(domain, tick, &window_start, &window_ticks);
+    }
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_vegetation_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_vegetation_sample_init(out_sample);
+        if (refusal != DOM_DOMAIN_REFUSE_NONE) {
+            dom_veg_query_meta_refused(&out_sample->meta, refusal, budget);
+            out_sample->flags |= DOM_VEG_SAMPLE_FIELDS_UNKNOWN;
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_veg_sample_resolve(domain, source, &point, window_start, window_ticks, budget, out_sample);
+    }
     return 0;
 }
 
@@ -1633,6 +1552,26 @@ static u32 dom_veg_rng_cursor(const dom_vegetation_surface_desc* surface,
     return rng.state;
 }
 
+static int dom_veg_capsule_append(dom_vegetation_domain* domain,
+                                  const dom_vegetation_macro_capsule* capsule)
+{
+    void* grown = dom_domain_capsule_array_reserve(domain->capsules,
+                                                   (u32)sizeof(*capsule),
+                                                   &domain->capsule_capacity,
+                                                   domain->capsule_count + 1u);
+    int rc;
+    if (!grown) {
+        return -1;
+    }
+    domain->capsules = (dom_vegetation_macro_capsule*)grown;
+    rc = dom_domain_capsule_index_insert(&domain->capsule_index, &capsule->bounds);
+    if (rc != 0) {
+        return rc;
+    }
+    domain->capsules[domain->capsule_count++] = *capsule;
+    return 0;
+}
+
 static int dom_veg_capsule_store(dom_vegetation_domain* domain,
                                  const dom_domain_tile_desc* desc,
                                  u64 tick,
@@ -1647,7 +1586,7 @@ static int dom_veg_capsule_store(dom_vegetation_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->capsule_count >= DOM_VEG_MAX_CAPSULES) {
+    if (domain->capsule_index.limit != 0u && domain->capsule_count >= domain->capsule_index.limit) {
         return -2;
     }
     memset(size_bins, 0, sizeof(size_bins));
@@ -1698,8 +1637,7 @@ static int dom_veg_capsule_store(dom_vegetation_domain* domain,
     }
 
     dom_vegetation_tile_free(&tile);
-    domain->capsules[domain->capsule_count++] = capsule;
-    return 0;
+    return dom_veg_capsule_append(domain, &capsule);
 }
 
 int dom_vegetation_domain_collapse_tile(dom_vegetation_domain* domain,
@@ -1709,22 +1647,7 @@ int dom_vegetation_domain_collapse_tile(dom_vegetation_domain* domain,
     if (!domain || !desc) {
         return -1;
     }
-    if (domain->cache.entries) {
-        for (u32 i = 0u; i < domain->cache.capacity; ++i) {
-            dom_vegetation_cache_entry* entry = &domain->cache.entries[i];
-            if (!entry->valid) {
-                continue;
-            }
-            if (entry->domain_id == domain->surface.domain_id &&
-                entry->tile_id == desc->tile_id) {
-                dom_vegetation_tile_free(&entry->tile);
-                entry->valid = D_FALSE;
-                if (domain->cache.count > 0u) {
-                    domain->cache.count -= 1u;
-                }
-            }
-        }
-    }
+    dom_domain_cache_invalidate_tile(&domain->cache, domain->surface.domain_id, desc->tile_id);
     return dom_veg_capsule_store(domain, desc, dom_veg_window_start(tick, domain->surface.weather_window_ticks),
                                  domain->surface.weather_window_ticks);
 }
@@ -1738,6 +1661,7 @@ int dom_vegetation_domain_expand_tile(dom_vegetation_domain* domain, u64 tile_id
         if (domain->capsules[i].tile_id == tile_id) {
             domain->capsules[i] = domain->capsules[domain->capsule_count - 1u];
             domain->capsule_count -= 1u;
+            (void)dom_domain_capsule_index_remove(&domain->capsule_index, i);
             return 0;
         }
     }
@@ -408,167 +408,56 @@ static d_bool dom_weather_domain_is_active(const dom_weather_domain* domain)
     return D_TRUE;
 }
 
-static void dom_weather_cache_init(dom_weather_cache* cache)
+/* Event lists are plain arrays, so the default zero-fill init and no release
+ * hooks suffice. Windows are keyed by id plus their exact start and length. */
+static const dom_domain_cache_tile_ops g_dom_weather_cache_ops = {
+    (u32)sizeof(dom_weather_event_list),
+    0,
+    0,
+    0
+};
+
+static void dom_weather_cache_key(dom_domain_cache_key* key,
+                                  dom_domain_id domain_id,
+                                  u64 window_id,
+                                  u64 start_tick,
+                                  u64 window_ticks,
+                                  u32 authoring_version)
 {
-    if (!cache) {
-        return;
-    }
-    memset(cache, 0, sizeof(*cache));
-}
-
-static void dom_weather_cache_free(dom_weather_cache* cache)
-{
-    if (!cache) {
-        return;
-    }
-    if (cache->entries) {
-        free(cache->entries);
-        cache->entries = (dom_weather_cache_entry*)0;
-    }
-    cache->capacity = 0u;
-    cache->count = 0u;
-    cache->use_counter = 0u;
-    cache->next_insert_order = 0u;
-}
-
-static int dom_weather_cache_reserve(dom_weather_cache* cache, u32 capacity)
-{
-    dom_weather_cache_entry* new_entries;
-    u32 old_cap;
-    if (!cache) {
-        return -1;
-    }
-    if (capacity <= cache->capacity) {
-        return 0;
-    }
-    new_entries = (dom_weather_cache_entry*)realloc(cache->entries,
-                                                   capacity * sizeof(dom_weather_cache_entry));
-    if (!new_entries) {
-        return -1;
-    }
-    old_cap = cache->capacity;
-    cache->entries = new_entries;
-    cache->capacity = capacity;
-    for (u32 i = old_cap; i < cache->capacity; ++i) {
-        memset(&cache->entries[i], 0, sizeof(dom_weather_cache_entry));
-        cache->entries[i].valid = D_FALSE;
-    }
-    return 0;
-}
-
-static dom_weather_cache_entry* dom_weather_cache_find_entry(dom_weather_cache* cache,
-                                                             dom_domain_id domain_id,
-                                                             u64 window_id,
-                                                             u32 authoring_version)
-{
-    if (!cache || !cache->entries) {
-        return (dom_weather_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_weather_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            continue;
-        }
-        if (entry->domain_id == domain_id &&
-            entry->window_id == window_id &&
-            entry->authoring_version == authoring_version) {
-            return entry;
-        }
-    }
-    return (dom_weather_cache_entry*)0;
+    dom_domain_cache_key_init(key, domain_id, window_id, 0u, authoring_version);
+    key->window_start = start_tick;
+    key->window_ticks = window_ticks;
 }
 
-static const dom_weather_event_list* dom_weather_cache_get(dom_weather_cache* cache,
+static const dom_weather_event_list* dom_weather_cache_get(dom_domain_cache* cache,
                                                            dom_domain_id domain_id,
                                                            u64 window_id,
+                                                           u64 start_tick,
+                                                           u64 window_ticks,
                                                            u32 authoring_version)
 {
-    dom_weather_cache_entry* entry;
-    if (!cache) {
-        return (const dom_weather_event_list*)0;
-    }
-    entry = dom_weather_cache_find_entry(cache, domain_id, window_id, authoring_version);
-    if (!entry) {
-        return (const dom_weather_event_list*)0;
-    }
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->events;
+    dom_domain_cache_key key;
+    dom_weather_cache_key(&key, domain_id, window_id, start_tick, window_ticks, authoring_version);
+    return (const dom_weather_event_list*)dom_domain_cache_get_tile(cache, &key);
 }
 
-static dom_weather_cache_entry* dom_weather_cache_select_slot(dom_weather_cache* cache)
-{
-    dom_weather_cache_entry* best = (dom_weather_cache_entry*)0;
-    if (!cache || !cache->entries || cache->capacity == 0u) {
-        return (dom_weather_cache_entry*)0;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_weather_cache_entry* entry = &cache->entries[i];
-        if (!entry->valid) {
-            return entry;
-        }
-        if (!best) {
-            best = entry;
-            continue;
-        }
-        if (entry->last_used < best->last_used) {
-            best = entry;
-        } else if (entry->last_used == best->last_used &&
-                   entry->insert_order < best->insert_order) {
-            best = entry;
-        }
-    }
-    return best;
-}
-
-static dom_weather_event_list* dom_weather_cache_put(dom_weather_cache* cache,
+static dom_weather_event_list* dom_weather_cache_put(dom_domain_cache* cache,
                                                      dom_domain_id domain_id,
                                                      u64 window_id,
+                                                     u64 start_tick,
+                                                     u64 window_ticks,
                                                      u32 authoring_version,
                                                      const dom_weather_event_list* events)
 {
-    dom_weather_cache_entry* entry;
-    if (!cache || !events) {
-        return (dom_weather_event_list*)0;
-    }
-    if (!cache->entries || cache->capacity == 0u) {
-        return (dom_weather_event_list*)0;
-    }
-    entry = dom_weather_cache_find_entry(cache, domain_id, window_id, authoring_version);
-    if (!entry) {
-        entry = dom_weather_cache_select_slot(cache);
-    }
-    if (!entry) {
+    dom_domain_cache_key key;
+    dom_weather_event_list copy;
+    if (!events) {
         return (dom_weather_event_list*)0;
     }
-    if (!entry->valid) {
-        cache->count += 1u;
-        entry->insert_order = cache->next_insert_order++;
-    }
-    entry->domain_id = domain_id;
-    entry->window_id = window_id;
-    entry->authoring_version = authoring_version;
-    entry->events = *events;
-    entry->valid = D_TRUE;
-    cache->use_counter += 1u;
-    entry->last_used = cache->use_counter;
-    return &entry->events;
-}
-
-static void dom_weather_cache_invalidate_domain(dom_weather_cache* cache, dom_domain_id domain_id)
-{
-    if (!cache || !cache->entries) {
-        return;
-    }
-    for (u32 i = 0u; i < cache->capacity; ++i) {
-        dom_weather_cache_entry* entry = &cache->entries[i];
-        if (entry->valid && entry->domain_id == domain_id) {
-            entry->valid = D_FALSE;
-            if (cache->count > 0u) {
-                cache->count -= 1u;
-            }
-        }
-    }
+    /* put_tile moves out of its argument; the caller keeps its list. */
+    copy = *events;
+    dom_weather_cache_key(&key, domain_id, window_id, start_tick, window_ticks, authoring_version);
+    return (dom_weather_event_list*)dom_domain_cache_put_tile(cache, &key, &copy);
 }
 
 static u64 dom_weather_window_id(u64 start_tick, u64 window_ticks)
@@ -752,9 +641,9 @@ void dom_weather_domain_init(dom_weather_domain* domain,
     domain->archival_state = DOM_DOMAIN_ARCHIVAL_LIVE;
     domain->authoring_version = 1u;
     domain->schedule = desc->schedule;
-    dom_weather_cache_init(&domain->cache);
+    dom_domain_cache_init_typed(&domain->cache, &g_dom_weather_cache_ops);
     if (cache_capacity > 0u) {
-        dom_weather_cache_reserve(&domain->cache, cache_capacity);
+        dom_domain_cache_reserve(&domain->cache, cache_capacity);
     }
     domain->capsule_count = 0u;
 }
@@ -764,7 +653,7 @@ void dom_weather_domain_free(dom_weather_domain* domain)
     if (!domain) {
         return;
     }
-    dom_weather_cache_free(&domain->cache);
+    dom_domain_cache_free(&domain->cache);
     dom_climate_domain_free(&domain->climate_domain);
     domain->capsule_count = 0u;
 }
@@ -780,7 +669,7 @@ void dom_weather_domain_set_state(dom_weather_domain* domain,
         domain->existence_state = existence_state;
         domain->archival_state = archival_state;
         dom_climate_domain_set_state(&domain->climate_domain, existence_state, archival_state);
-        dom_weather_cache_invalidate_domain(&domain->cache, domain->climate_domain.surface.domain_id);
+        dom_domain_cache_invalidate_domain(&domain->cache, domain->climate_domain.surface.domain_id);
     }
 }
 
@@ -792,42 +681,47 @@ void dom_weather_domain_set_policy(dom_weather_domain* domain,
     }
     domain->policy = *policy;
     dom_climate_domain_set_policy(&domain->climate_domain, policy);
-    dom_weather_cache_invalidate_domain(&domain->cache, domain->climate_domain.surface.domain_id);
+    dom_domain_cache_invalidate_domain(&domain->cache, domain->climate_domain.surface.domain_id);
 }
 
-int dom_weather_sample_query(const dom_weather_domain* domain,
-                             const dom_domain_point* point,
-                             u64 tick,
-                             dom_domain_budget* budget,
-                             dom_weather_sample* out_sample)
+/* Outcomes that hold for every point at `tick`; a batch decides them once.
+ * Returns D_TRUE when the sample was filled without sampling the point. */
+static d_bool dom_weather_sample_skip(d_bool active,
+                                      d_bool collapsed,
+                                      dom_domain_budget* budget,
+                                      dom_weather_sample* out_sample)
 {
-    dom_climate_sample climate;
-    u32 budget_before = 0u;
-    u32 cost_units = 0u;
-    if (!domain || !point || !out_sample) {
-        return -1;
-    }
-    dom_weather_sample_init(out_sample);
-    if (budget) {
-        budget_before = budget->used_units;
-    }
-    if (!dom_weather_domain_is_active(domain)) {
+    if (!active) {
         dom_weather_query_meta_refused(&out_sample->meta, DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE, budget);
         out_sample->flags |= DOM_WEATHER_SAMPLE_FIELDS_UNKNOWN |
                              DOM_WEATHER_SAMPLE_WIND_UNKNOWN |
                              DOM_WEATHER_SAMPLE_EVENTS_UNKNOWN;
-        return 0;
+        return D_TRUE;
     }
-    if (dom_weather_domain_collapsed(domain, tick)) {
+    if (collapsed) {
         dom_weather_query_meta_ok(&out_sample->meta, DOM_DOMAIN_RES_ANALYTIC,
                                   DOM_DOMAIN_CONFIDENCE_UNKNOWN, 0u, budget);
         out_sample->flags |= DOM_WEATHER_SAMPLE_FIELDS_UNKNOWN |
                              DOM_WEATHER_SAMPLE_WIND_UNKNOWN |
                              DOM_WEATHER_SAMPLE_EVENTS_UNKNOWN |
                              DOM_WEATHER_SAMPLE_COLLAPSED;
-        return 0;
+        return D_TRUE;
     }
+    return D_FALSE;
+}
 
+static void dom_weather_sample_resolve(const dom_weather_domain* domain,
+                                       const dom_domain_point* point,
+                                       u64 tick,
+                                       dom_domain_budget* budget,
+                                       dom_weather_sample* out_sample)
+{
+    dom_climate_sample climate;
+    u32 budget_before = 0u;
+    u32 cost_units = 0u;
+    if (budget) {
+        budget_before = budget->used_units;
+    }
     dom_climate_sample_query(&domain->climate_domain, point, budget, &climate);
     if (climate.meta.status == DOM_DOMAIN_QUERY_REFUSED ||
         (climate.flags & DOM_CLIMATE_SAMPLE_FIELDS_UNKNOWN)) {
@@ -837,7 +731,7 @@ int dom_weather_sample_query(const dom_weather_domain* domain,
             out_sample->flags |= DOM_WEATHER_SAMPLE_WIND_UNKNOWN;
         }
         out_sample->meta = climate.meta;
-        return 0;
+        return;
     }
 
     if (!dom_domain_budget_consume(budget, domain->policy.cost_analytic)) {
@@ -845,7 +739,7 @@ int dom_weather_sample_query(const dom_weather_domain* domain,
         out_sample->flags |= DOM_WEATHER_SAMPLE_FIELDS_UNKNOWN |
                              DOM_WEATHER_SAMPLE_WIND_UNKNOWN |
                              DOM_WEATHER_SAMPLE_EVENTS_UNKNOWN;
-        return 0;
+        return;
     }
 
     out_sample->temperature_current = climate.temperature_mean;
@@ -901,6 +795,57 @@ int dom_weather_sample_query(const dom_weather_domain* domain,
                               climate.meta.confidence,
                               cost_units,
                               budget);
+}
+
+int dom_weather_sample_query(const dom_weather_domain* domain,
+                             const dom_domain_point* point,
+                             u64 tick,
+                             dom_domain_budget* budget,
+                             dom_weather_sample* out_sample)
+{
+    d_bool active;
+    d_bool collapsed;
+    if (!domain || !point || !out_sample) {
+        return -1;
+    }
+    dom_weather_sample_init(out_sample);
+    active = dom_weather_domain_is_active(domain);
+    collapsed = (active && dom_weather_domain_collapsed(domain, tick)) ? D_TRUE : D_FALSE;
+    if (dom_weather_sample_skip(active, collapsed, budget, out_sample)) {
+        return 0;
+    }
+    dom_weather_sample_resolve(domain, point, tick, budget, out_sample);
+    return 0;
+}
+
+int dom_weather_sample_query_batch(const dom_weather_domain* domain,
+                                   const dom_domain_point_batch* points,
+                                   u64 tick,
+                                   dom_domain_budget* budget,
+                                   dom_weather_sample* out_samples)
+{
+    d_bool active;
+    d_bool collapsed;
+    if (!domain || !points || (points->count > 0u && !out_samples)) {
+        return -1;
+    }
+    if (points->count > 0u && (!points->x || !points->y || !points->z)) {
+        return -1;
+    }
+    active = dom_weather_domain_is_active(domain);
+    collapsed = (active && dom_weather_domain_collapsed(domain, tick)) ? D_TRUE : D_FALSE;
+    for (u32 i = 0u; i < points->count; ++i) {
+        dom_weather_sample* out_sample = &out_samples[i];
+        dom_domain_point point;
+        dom_weather_sample_init(out_sample);
+        if (dom_weather_sample_skip(active, collapsed, budget, out_sample)) {
+            continue;
+        }
+        point.x = points->x[i];
+        point.y = points->y[i];
+        point.z = points->z[i];
+        dom_weather_sample_resolve(domain, &point, tick, budget, out_sample);
+    }
     return 0;
 }
 
@@ -943,9 +888,11 @@ int dom_weather_events_in_window(const dom_weather_domain* domain,
         return 0;
     }
     window_id = dom_weather_window_id(start_tick, window_ticks);
-    cached = dom_weather_cache_get((dom_weather_cache*)&domain->cache,
+    cached = dom_weather_cache_get((dom_domain_cache*)&domain->cache,
                                    domain->climate_domain.surface.domain_id,
                                    window_id,
+                                   start_tick,
+                                   window_ticks,
                                    domain->authoring_version);
     if (cached) {
         *out_list = *cached;
@@ -991,9 +938,11 @@ int dom_weather_events_in_window(const dom_weather_domain* domain,
         }
     }
 
-    dom_weather_cache_put((dom_weather_cache*)&domain->cache,
+    dom_weather_cache_put((dom_domain_cache*)&domain->cache,
                           domain->climate_domain.surface.domain_id,
                           window_id,
+                          start_tick,
+                          window_ticks,
                           domain->authoring_version,
                           out_list);
     return 0;
@@ -21,7 +21,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
  *
  * Notes:
  * - All on-disk values are little-endian; parsing is explicit.
- * - Reader supports memory-backed and file-backed containers.
+ * - Reader supports memory-backed, file-backed and memory-mapped containers.
  * - Writer supports memory-backed and file-backed containers.
  */
 
@@ -171,10 +171,11 @@ typedef struct dtlv_dir_entry {
  *------------------------------------------------------------*/
 
 /* dtlv_reader
- * Purpose: Reader state for a DTLV container (memory-backed or file-backed).
+ * Purpose: Reader state for a DTLV container (memory-backed, file-backed or mapped).
  * Ownership:
- * - `entries` is allocated/owned by the reader and released by `dtlv_reader_dispose`.
+ * - `entries` and `type_slots` are allocated/owned by the reader and released by `dtlv_reader_dispose`.
  * - File-backed mode uses a `dsys_file_*` handle (see `include/domino/sys.h`).
+ * - Mapped mode owns a `dsys_file_map` handle and serves `mem` from it.
  * Thread-safety:
  * - No internal synchronization; each reader instance must be externally serialized.
  */
@@ -192,8 +193,18 @@ typedef struct dtlv_reader {
     u64 dir_offset;
     u32 chunk_count;
 
+    /* mapped (dsys_file_map handle; `mem` points into the mapping) */
+    void* map;
+
     /* parsed directory */
     dtlv_dir_entry* entries;
+
+    /* type_id lookup built at open: open-addressed slots hold the index + 1
+     * of the first entry of each type; `type_next` chains later entries of
+     * the same type in directory order. NULL falls back to a linear scan. */
+    u32* type_slots;
+    u32* type_next;
+    u32  type_slot_capacity;
 } dtlv_reader;
 
 /* dtlv_reader_init
@@ -238,6 +249,20 @@ int dtlv_reader_init_file(dtlv_reader* r, void* fh); /* does not take ownership
  */
 int dtlv_reader_init_mem(dtlv_reader* r, const void* data, u64 size);
 
+/* dtlv_reader_open_mapped
+ * Purpose: Map a DTLV container file read-only and parse it in place.
+ * Parameters:
+ *   r (inout): Reader to populate (non-NULL).
+ *   path (in): File path (non-NULL, NUL-terminated).
+ * Return values / errors:
+ *   0 on success; non-zero when mapping is unavailable or the container is malformed.
+ *   Callers may fall back to `dtlv_reader_open_file` on failure.
+ * Notes:
+ *   Chunk payloads are then available through `dtlv_reader_chunk_memview`
+ *   without copying; pages are loaded on first touch.
+ */
+int dtlv_reader_open_mapped(dtlv_reader* r, const char* path);
+
 /* dtlv_reader_chunk_count
  * Purpose: Return the number of directory entries in the opened container.
  * Parameters:
@@ -258,6 +283,7 @@ const dtlv_dir_entry* dtlv_reader_chunk_at(const dtlv_reader* r, u32 index);
 
 /* dtlv_reader_find_first
  * Purpose: Find the first directory entry matching `type_id` and (optionally) `version`.
+ *   Uses the hashed type index; cost is proportional to the entries of that type.
  * Parameters:
  *   r (in): Reader (non-NULL).
  *   type_id (in): Chunk type id to match.
@@ -306,14 +332,14 @@ int dtlv_reader_read_chunk_alloc(
 );
 
 /* dtlv_reader_chunk_memview
- * Purpose: For memory-backed readers, return a pointer to the chunk payload bytes.
+ * Purpose: For memory-backed or mapped readers, return a pointer to the chunk payload bytes.
  * Parameters:
  *   r (in): Reader (non-NULL).
  *   e (in): Directory entry (non-NULL).
  *   out_ptr (out): Receives pointer into the container memory on success (non-NULL).
  *   out_size (out): Receives payload size in bytes on success (non-NULL).
  * Return values / errors:
- *   0 on success; non-zero when not memory-backed or on invalid parameters.
+ *   0 on success; non-zero when not memory-backed/mapped or on invalid parameters.
  * Ownership:
  *   The returned pointer is borrowed and becomes invalid when the reader is disposed.
  */
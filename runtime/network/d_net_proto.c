@@ -26,70 +26,123 @@ enum {
     D_NET_FRAME_HEADER_SIZE = 12u
 };
 
-static int d_net_write_tlv_entry(
-    unsigned char *dst,
-    u32            dst_size,
-    u32           *in_out_offset,
-    u32            tag,
-    const void    *payload,
-    u32            payload_len
-) {
+static void d_net_frame_begin(d_net_frame *f, d_net_msg_type type) {
+    unsigned char *p = f->head;
+    p[0] = (unsigned char)D_NET_FRAME_MAGIC0;
+    p[1] = (unsigned char)D_NET_FRAME_MAGIC1;
+    p[2] = (unsigned char)D_NET_FRAME_MAGIC2;
+    p[3] = (unsigned char)D_NET_FRAME_VERSION;
+    p[4] = (unsigned char)type;
+    p[5] = 0u;
+    p[6] = 0u;
+    p[7] = 0u;
+    memset(p + 8u, 0, 4u);
+    f->parts[0].ptr = f->head;
+    f->parts[0].len = D_NET_FRAME_HEADER_SIZE;
+    f->parts[1].ptr = (const unsigned char *)0;
+    f->parts[1].len = 0u;
+    f->part_count = 1u;
+    f->size = D_NET_FRAME_HEADER_SIZE;
+}
+
+/* Writes a TLV tag/length pair into the head; the value follows separately. */
+static int d_net_frame_put_key(d_net_frame *f, u32 tag, u32 len) {
+    u32 off = f->parts[0].len;
+    if (f->part_count != 1u || D_NET_FRAME_HEAD_CAP - off < 8u) {
+        return -1;
+    }
+    memcpy(f->head + off, &tag, sizeof(u32));
+    memcpy(f->head + off + 4u, &len, sizeof(u32));
+    f->parts[0].len = off + 8u;
+    f->size += 8u;
+    return 0;
+}
+
+/* Small fixed field, copied into the head. */
+static int d_net_frame_put(d_net_frame *f, u32 tag, const void *value, u32 len) {
     u32 off;
-    if (!dst || !in_out_offset) {
+    if (d_net_frame_put_key(f, tag, len) != 0) {
         return -1;
     }
-    off = *in_out_offset;
-    if (payload_len > 0u && !payload) {
+    off = f->parts[0].len;
+    if (D_NET_FRAME_HEAD_CAP - off < len) {
         return -1;
     }
-    if (dst_size - off < 8u + payload_len) {
+    memcpy(f->head + off, value, len);
+    f->parts[0].len = off + len;
+    f->size += len;
+    return 0;
+}
+
+/* Bulk bytes, borrowed as the trailing part. Must be the last field. */
+static int d_net_frame_attach(d_net_frame *f, const void *bytes, u32 len) {
+    if (f->part_count != 1u) {
         return -1;
     }
-    memcpy(dst + off, &tag, sizeof(u32));
-    memcpy(dst + off + 4u, &payload_len, sizeof(u32));
-    off += 8u;
-    if (payload_len > 0u) {
-        memcpy(dst + off, payload, payload_len);
-        off += payload_len;
+    if (len == 0u) {
+        return 0;
     }
-    *in_out_offset = off;
+    if (!bytes || len > 0xFFFFFFFFu - f->size) {
+        return -1;
+    }
+    f->parts[1].ptr = (const unsigned char *)bytes;
+    f->parts[1].len = len;
+    f->part_count = 2u;
+    f->size += len;
     return 0;
 }
 
-static int d_net_encode_frame(
-    d_net_msg_type  type,
-    const void     *payload,
-    u32             payload_len,
-    void           *buf,
-    u32             buf_size,
-    u32            *out_size
-) {
-    unsigned char *p;
-    u32 total;
-    if (!buf || !out_size) {
+static int d_net_frame_put_borrowed(d_net_frame *f, u32 tag, const void *bytes, u32 len) {
+    if (d_net_frame_put_key(f, tag, len) != 0) {
         return -1;
     }
-    if (payload_len > 0u && !payload) {
+    return d_net_frame_attach(f, bytes, len);
+}
+
+static int d_net_frame_end(d_net_frame *f, int rc) {
+    u32 payload_len;
+    if (rc != 0) {
         return -1;
     }
-    total = D_NET_FRAME_HEADER_SIZE + payload_len;
-    if (buf_size < total) {
+    payload_len = f->size - D_NET_FRAME_HEADER_SIZE;
+    memcpy(f->head + 8u, &payload_len, sizeof(u32));
+    return 0;
+}
+
+int d_net_frame_flatten(const d_net_frame *frame, void *buf, u32 buf_size) {
+    unsigned char *dst;
+    u32 i;
+    if (!frame || !buf) {
+        return -1;
+    }
+    if (buf_size < frame->size) {
         return -2;
     }
-    p = (unsigned char *)buf;
-    p[0] = (unsigned char)D_NET_FRAME_MAGIC0;
-    p[1] = (unsigned char)D_NET_FRAME_MAGIC1;
-    p[2] = (unsigned char)D_NET_FRAME_MAGIC2;
-    p[3] = (unsigned char)D_NET_FRAME_VERSION;
-    p[4] = (unsigned char)type;
-    p[5] = 0u;
-    p[6] = 0u;
-    p[7] = 0u;
-    memcpy(p + 8u, &payload_len, sizeof(u32));
-    if (payload_len > 0u) {
-        memcpy(p + D_NET_FRAME_HEADER_SIZE, payload, payload_len);
+    dst = (unsigned char *)buf;
+    for (i = 0u; i < frame->part_count; ++i) {
+        if (frame->parts[i].len > 0u) {
+            memcpy(dst, frame->parts[i].ptr, frame->parts[i].len);
+            dst += frame->parts[i].len;
+        }
+    }
+    return 0;
+}
+
+static int d_net_encode_from_frame(
+    const d_net_frame *frame,
+    void              *buf,
+    u32                buf_size,
+    u32               *out_size
+) {
+    int rc = d_net_frame_flatten(frame, buf, buf_size);
+    if (rc == -2) {
+        *out_size = frame->size;
+        return -2;
+    }
+    if (rc != 0) {
+        return rc;
     }
-    *out_size = total;
+    *out_size = frame->size;
     return 0;
 }
 
@@ -129,11 +182,10 @@ int d_net_decode_frame(
     return 0;
 }
 
-int d_net_encode_cmd(const d_net_cmd *cmd, void *buf, u32 buf_size, u32 *out_size) {
-    u32 tlv_len;
-    u32 off;
-    unsigned char *tmp;
-    if (!cmd || !buf || !out_size) {
+int d_net_frame_cmd(const d_net_cmd *cmd, d_net_frame *out_frame) {
+    u16 ver;
+    int rc = 0;
+    if (!cmd || !out_frame) {
         return -1;
     }
     if (cmd->schema_id == 0u || cmd->schema_ver == 0u) {
@@ -142,44 +194,31 @@ int d_net_encode_cmd(const d_net_cmd *cmd, void *buf, u32 buf_size, u32 *out_siz
     if (cmd->payload.len > 0u && !cmd->payload.ptr) {
         return -1;
     }
+    ver = cmd->schema_ver;
+    d_net_frame_begin(out_frame, D_NET_MSG_CMD);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_CMD_ID, &cmd->id, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_CMD_SOURCE, &cmd->source_peer, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_CMD_TICK, &cmd->tick, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_CMD_SCHEMA_ID, &cmd->schema_id, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_CMD_SCHEMA_VER, &ver, 2u);
+    rc |= d_net_frame_put_borrowed(out_frame, D_NET_TLV_CMD_PAYLOAD, cmd->payload.ptr, cmd->payload.len);
+    return d_net_frame_end(out_frame, rc);
+}
 
-    tlv_len =
-        (8u + 4u) + /* id */
-        (8u + 4u) + /* source */
-        (8u + 4u) + /* tick */
-        (8u + 4u) + /* schema_id */
-        (8u + 2u) + /* schema_ver */
-        (8u + cmd->payload.len); /* payload */
-
-    tmp = (unsigned char *)malloc(tlv_len);
-    if (!tmp) {
-        return -2;
-    }
-
-    off = 0u;
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_CMD_ID, &cmd->id, 4u);
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_CMD_SOURCE, &cmd->source_peer, 4u);
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_CMD_TICK, &cmd->tick, 4u);
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_CMD_SCHEMA_ID, &cmd->schema_id, 4u);
-    {
-        u16 ver = cmd->schema_ver;
-        (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_CMD_SCHEMA_VER, &ver, 2u);
-    }
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_CMD_PAYLOAD, cmd->payload.ptr, cmd->payload.len);
-
-    if (off != tlv_len) {
-        free(tmp);
-        return -3;
+int d_net_encode_cmd(const d_net_cmd *cmd, void *buf, u32 buf_size, u32 *out_size) {
+    d_net_frame frame;
+    int rc;
+    if (!cmd || !buf || !out_size) {
+        return -1;
     }
-
-    {
-        int rc = d_net_encode_frame(D_NET_MSG_CMD, tmp, tlv_len, buf, buf_size, out_size);
-        free(tmp);
+    rc = d_net_frame_cmd(cmd, &frame);
+    if (rc != 0) {
         return rc;
     }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
-int d_net_decode_cmd(const void *buf, u32 size, d_net_cmd *out_cmd) {
+int d_net_decode_cmd_view(const void *buf, u32 size, d_net_cmd *out_cmd) {
     d_net_msg_type type;
     d_tlv_blob payload;
     u32 off;
@@ -240,12 +279,7 @@ int d_net_decode_cmd(const void *buf, u32 size, d_net_cmd *out_cmd) {
             }
         } else if (tag == D_NET_TLV_CMD_PAYLOAD) {
             if (pl.len > 0u && pl.ptr) {
-                out_cmd->payload.ptr = (unsigned char *)malloc(pl.len);
-                if (!out_cmd->payload.ptr) {
-                    return -3;
-                }
-                memcpy(out_cmd->payload.ptr, pl.ptr, pl.len);
-                out_cmd->payload.len = pl.len;
+                out_cmd->payload = pl;
             } else {
                 out_cmd->payload.ptr = (unsigned char *)0;
                 out_cmd->payload.len = 0u;
@@ -255,27 +289,65 @@ int d_net_decode_cmd(const void *buf, u32 size, d_net_cmd *out_cmd) {
     }
 
     if (!have_id || !have_source || !have_tick || !have_schema_id || !have_schema_ver || !have_payload) {
-        if (out_cmd->payload.ptr) {
-            free(out_cmd->payload.ptr);
-        }
         memset(out_cmd, 0, sizeof(*out_cmd));
         return -4;
     }
     return 0;
 }
 
+static int d_net_blob_own(d_tlv_blob *blob) {
+    unsigned char *copy;
+    if (blob->len == 0u || !blob->ptr) {
+        blob->ptr = (unsigned char *)0;
+        blob->len = 0u;
+        return 0;
+    }
+    copy = (unsigned char *)malloc(blob->len);
+    if (!copy) {
+        blob->ptr = (unsigned char *)0;
+        blob->len = 0u;
+        return -3;
+    }
+    memcpy(copy, blob->ptr, blob->len);
+    blob->ptr = copy;
+    return 0;
+}
+
+int d_net_decode_cmd(const void *buf, u32 size, d_net_cmd *out_cmd) {
+    int rc = d_net_decode_cmd_view(buf, size, out_cmd);
+    if (rc != 0) {
+        return rc;
+    }
+    if (d_net_blob_own(&out_cmd->payload) != 0) {
+        memset(out_cmd, 0, sizeof(*out_cmd));
+        return -3;
+    }
+    return 0;
+}
+
+int d_net_frame_handshake(const d_net_handshake *hs, d_net_frame *out_frame) {
+    int rc = 0;
+    if (!hs || !out_frame) {
+        return -1;
+    }
+    d_net_frame_begin(out_frame, D_NET_MSG_HANDSHAKE);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_SUITE_VERSION, &hs->suite_version, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_CORE_VERSION, &hs->core_version, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_NET_PROTO_VER, &hs->net_proto_version, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_COMPAT_PROFILE, &hs->compat_profile, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_ROLE, &hs->role, 4u);
+    return d_net_frame_end(out_frame, rc);
+}
+
 int d_net_encode_handshake(const d_net_handshake *hs, void *buf, u32 buf_size, u32 *out_size) {
-    unsigned char tmp[128];
-    u32 off = 0u;
+    d_net_frame frame;
     if (!hs || !buf || !out_size) {
         return -1;
     }
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_SUITE_VERSION, &hs->suite_version, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_CORE_VERSION, &hs->core_version, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_NET_PROTO_VER, &hs->net_proto_version, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_COMPAT_PROFILE, &hs->compat_profile, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_ROLE, &hs->role, 4u);
-    return d_net_encode_frame(D_NET_MSG_HANDSHAKE, tmp, off, buf, buf_size, out_size);
+    if (d_net_frame_handshake(hs, &frame) != 0) {
+        return -1;
+    }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
 int d_net_decode_handshake(const void *buf, u32 size, d_net_handshake *out_hs) {
@@ -313,19 +385,30 @@ int d_net_decode_handshake(const void *buf, u32 size, d_net_handshake *out_hs) {
     return 0;
 }
 
+int d_net_frame_handshake_reply(const d_net_handshake_reply *r, d_net_frame *out_frame) {
+    int rc = 0;
+    if (!r || !out_frame) {
+        return -1;
+    }
+    d_net_frame_begin(out_frame, D_NET_MSG_HANDSHAKE_REPLY);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_REPLY_RESULT, &r->result, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_REPLY_REASON_CODE, &r->reason_code, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_REPLY_ASSIGNED_PEER, &r->assigned_peer, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_REPLY_SESSION_ID, &r->session_id, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_REPLY_TICK_RATE, &r->tick_rate, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HANDSHAKE_REPLY_TICK, &r->tick, 4u);
+    return d_net_frame_end(out_frame, rc);
+}
+
 int d_net_encode_handshake_reply(const d_net_handshake_reply *r, void *buf, u32 buf_size, u32 *out_size) {
-    unsigned char tmp[128];
-    u32 off = 0u;
+    d_net_frame frame;
     if (!r || !buf || !out_size) {
         return -1;
     }
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_REPLY_RESULT, &r->result, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_REPLY_REASON_CODE, &r->reason_code, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_REPLY_ASSIGNED_PEER, &r->assigned_peer, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_REPLY_SESSION_ID, &r->session_id, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_REPLY_TICK_RATE, &r->tick_rate, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HANDSHAKE_REPLY_TICK, &r->tick, 4u);
-    return d_net_encode_frame(D_NET_MSG_HANDSHAKE_REPLY, tmp, off, buf, buf_size, out_size);
+    if (d_net_frame_handshake_reply(r, &frame) != 0) {
+        return -1;
+    }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
 int d_net_decode_handshake_reply(const void *buf, u32 size, d_net_handshake_reply *out_r) {
@@ -371,36 +454,34 @@ int d_net_decode_handshake_reply(const void *buf, u32 size, d_net_handshake_repl
     return 0;
 }
 
-int d_net_encode_snapshot(const d_net_snapshot *snap, void *buf, u32 buf_size, u32 *out_size) {
-    u32 tlv_len;
-    u32 off;
-    unsigned char *tmp;
-    if (!snap || !buf || !out_size) {
+int d_net_frame_snapshot(const d_net_snapshot *snap, d_net_frame *out_frame) {
+    int rc = 0;
+    if (!snap || !out_frame) {
         return -1;
     }
     if (snap->data.len > 0u && !snap->data.ptr) {
         return -1;
     }
-    tlv_len = (8u + 4u) + (8u + snap->data.len);
-    tmp = (unsigned char *)malloc(tlv_len);
-    if (!tmp) {
-        return -2;
-    }
-    off = 0u;
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_SNAPSHOT_TICK, &snap->tick, 4u);
-    (void)d_net_write_tlv_entry(tmp, tlv_len, &off, D_NET_TLV_SNAPSHOT_DATA, snap->data.ptr, snap->data.len);
-    if (off != tlv_len) {
-        free(tmp);
-        return -3;
+    d_net_frame_begin(out_frame, D_NET_MSG_SNAPSHOT);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_SNAPSHOT_TICK, &snap->tick, 4u);
+    rc |= d_net_frame_put_borrowed(out_frame, D_NET_TLV_SNAPSHOT_DATA, snap->data.ptr, snap->data.len);
+    return d_net_frame_end(out_frame, rc);
+}
+
+int d_net_encode_snapshot(const d_net_snapshot *snap, void *buf, u32 buf_size, u32 *out_size) {
+    d_net_frame frame;
+    int rc;
+    if (!snap || !buf || !out_size) {
+        return -1;
     }
-    {
-        int rc = d_net_encode_frame(D_NET_MSG_SNAPSHOT, tmp, tlv_len, buf, buf_size, out_size);
-        free(tmp);
+    rc = d_net_frame_snapshot(snap, &frame);
+    if (rc != 0) {
         return rc;
     }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
-int d_net_decode_snapshot(const void *buf, u32 size, d_net_snapshot *out_snap) {
+int d_net_decode_snapshot_view(const void *buf, u32 size, d_net_snapshot *out_snap) {
     d_net_msg_type type;
     d_tlv_blob payload;
     u32 off;
@@ -424,27 +505,44 @@ int d_net_decode_snapshot(const void *buf, u32 size, d_net_snapshot *out_snap) {
             (void)d_tlv_kv_read_u32(&pl, &out_snap->tick);
         } else if (tag == D_NET_TLV_SNAPSHOT_DATA) {
             if (pl.len > 0u && pl.ptr) {
-                out_snap->data.ptr = (unsigned char *)malloc(pl.len);
-                if (!out_snap->data.ptr) {
-                    d_net_snapshot_free(out_snap);
-                    return -3;
-                }
-                memcpy(out_snap->data.ptr, pl.ptr, pl.len);
-                out_snap->data.len = pl.len;
+                out_snap->data = pl;
             }
         }
     }
     return 0;
 }
 
+int d_net_decode_snapshot(const void *buf, u32 size, d_net_snapshot *out_snap) {
+    int rc = d_net_decode_snapshot_view(buf, size, out_snap);
+    if (rc != 0) {
+        return rc;
+    }
+    if (d_net_blob_own(&out_snap->data) != 0) {
+        d_net_snapshot_free(out_snap);
+        return -3;
+    }
+    return 0;
+}
+
+int d_net_frame_tick(const d_net_tick *t, d_net_frame *out_frame) {
+    int rc = 0;
+    if (!t || !out_frame) {
+        return -1;
+    }
+    d_net_frame_begin(out_frame, D_NET_MSG_TICK);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_TICK_TICK, &t->tick, 4u);
+    return d_net_frame_end(out_frame, rc);
+}
+
 int d_net_encode_tick(const d_net_tick *t, void *buf, u32 buf_size, u32 *out_size) {
-    unsigned char tmp[32];
-    u32 off = 0u;
+    d_net_frame frame;
     if (!t || !buf || !out_size) {
         return -1;
     }
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_TICK_TICK, &t->tick, 4u);
-    return d_net_encode_frame(D_NET_MSG_TICK, tmp, off, buf, buf_size, out_size);
+    if (d_net_frame_tick(t, &frame) != 0) {
+        return -1;
+    }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
 int d_net_decode_tick(const void *buf, u32 size, d_net_tick *out_t) {
@@ -474,15 +572,26 @@ int d_net_decode_tick(const void *buf, u32 size, d_net_tick *out_t) {
     return 0;
 }
 
+int d_net_frame_hash(const d_net_hash *h, d_net_frame *out_frame) {
+    int rc = 0;
+    if (!h || !out_frame) {
+        return -1;
+    }
+    d_net_frame_begin(out_frame, D_NET_MSG_HASH);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HASH_TICK, &h->tick, 4u);
+    rc |= d_net_frame_put(out_frame, D_NET_TLV_HASH_WORLD, &h->world_hash, 8u);
+    return d_net_frame_end(out_frame, rc);
+}
+
 int d_net_encode_hash(const d_net_hash *h, void *buf, u32 buf_size, u32 *out_size) {
-    unsigned char tmp[64];
-    u32 off = 0u;
+    d_net_frame frame;
     if (!h || !buf || !out_size) {
         return -1;
     }
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HASH_TICK, &h->tick, 4u);
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, D_NET_TLV_HASH_WORLD, &h->world_hash, 8u);
-    return d_net_encode_frame(D_NET_MSG_HASH, tmp, off, buf, buf_size, out_size);
+    if (d_net_frame_hash(h, &frame) != 0) {
+        return -1;
+    }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
 int d_net_decode_hash(const void *buf, u32 size, d_net_hash *out_h) {
@@ -516,14 +625,25 @@ int d_net_decode_hash(const void *buf, u32 size, d_net_hash *out_h) {
     return 0;
 }
 
+int d_net_frame_error(const d_net_error *e, d_net_frame *out_frame) {
+    int rc = 0;
+    if (!e || !out_frame) {
+        return -1;
+    }
+    d_net_frame_begin(out_frame, D_NET_MSG_ERROR);
+    rc |= d_net_frame_put(out_frame, 0x01u, &e->code, 4u);
+    return d_net_frame_end(out_frame, rc);
+}
+
 int d_net_encode_error(const d_net_error *e, void *buf, u32 buf_size, u32 *out_size) {
-    unsigned char tmp[32];
-    u32 off = 0u;
+    d_net_frame frame;
     if (!e || !buf || !out_size) {
         return -1;
     }
-    (void)d_net_write_tlv_entry(tmp, sizeof(tmp), &off, 0x01u, &e->code, 4u);
-    return d_net_encode_frame(D_NET_MSG_ERROR, tmp, off, buf, buf_size, out_size);
+    if (d_net_frame_error(e, &frame) != 0) {
+        return -1;
+    }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
 }
 
 int d_net_decode_error(const void *buf, u32 size, d_net_error *out_e) {
@@ -553,17 +673,31 @@ int d_net_decode_error(const void *buf, u32 size, d_net_error *out_e) {
     return 0;
 }
 
-int d_net_encode_qos(const d_net_qos *q, void *buf, u32 buf_size, u32 *out_size) {
-    if (!q || !buf || !out_size) {
+int d_net_frame_qos(const d_net_qos *q, d_net_frame *out_frame) {
+    if (!q || !out_frame) {
         return -1;
     }
     if (q->data.len > 0u && !q->data.ptr) {
         return -1;
     }
-    return d_net_encode_frame(D_NET_MSG_QOS, q->data.ptr, q->data.len, buf, buf_size, out_size);
+    d_net_frame_begin(out_frame, D_NET_MSG_QOS);
+    return d_net_frame_end(out_frame, d_net_frame_attach(out_frame, q->data.ptr, q->data.len));
 }
 
-int d_net_decode_qos(const void *buf, u32 size, d_net_qos *out_q) {
+int d_net_encode_qos(const d_net_qos *q, void *buf, u32 buf_size, u32 *out_size) {
+    d_net_frame frame;
+    int rc;
+    if (!q || !buf || !out_size) {
+        return -1;
+    }
+    rc = d_net_frame_qos(q, &frame);
+    if (rc != 0) {
+        return rc;
+    }
+    return d_net_encode_from_frame(&frame, buf, buf_size, out_size);
+}
+
+int d_net_decode_qos_view(const void *buf, u32 size, d_net_qos *out_q) {
     d_net_msg_type type;
     d_tlv_blob payload;
     int rc;
@@ -579,16 +713,19 @@ int d_net_decode_qos(const void *buf, u32 size, d_net_qos *out_q) {
         return -2;
     }
     if (payload.len > 0u && payload.ptr) {
-        out_q->data.ptr = (unsigned char *)malloc(payload.len);
-        if (!out_q->data.ptr) {
-            return -3;
-        }
-        memcpy(out_q->data.ptr, payload.ptr, payload.len);
-        out_q->data.len = payload.len;
+        out_q->data = payload;
     }
     return 0;
 }
 
+int d_net_decode_qos(const void *buf, u32 size, d_net_qos *out_q) {
+    int rc = d_net_decode_qos_view(buf, size, out_q);
+    if (rc != 0) {
+        return rc;
+    }
+    return d_net_blob_own(&out_q->data);
+}
+
 void d_net_snapshot_free(d_net_snapshot *snap) {
     if (!snap) {
         return;
@@ -75,6 +75,42 @@ typedef struct d_net_qos_s {
     d_tlv_blob data;     /* bytes; QoS TLV payload */
 } d_net_qos;
 
+/* Scatter/gather frame.
+ * The frame header and the small fixed TLV fields are written into `head`.
+ * The bulk payload (command payload, snapshot bytes, QoS TLV) is borrowed
+ * from the source object and appended as a second part, so its size is
+ * known up front and it is never copied while encoding. parts[0] points into
+ * the frame itself: build frames in place and do not copy them.
+ */
+enum {
+    D_NET_FRAME_HEAD_CAP = 128u,
+    D_NET_FRAME_MAX_PARTS = 2u
+};
+
+typedef struct d_net_frame_part_s {
+    const unsigned char *ptr;
+    u32                  len;
+} d_net_frame_part;
+
+typedef struct d_net_frame_s {
+    unsigned char    head[D_NET_FRAME_HEAD_CAP];
+    d_net_frame_part parts[D_NET_FRAME_MAX_PARTS];
+    u32              part_count;
+    u32              size;      /* total encoded bytes across all parts */
+} d_net_frame;
+
+int d_net_frame_cmd(const d_net_cmd *cmd, d_net_frame *out_frame);
+int d_net_frame_handshake(const d_net_handshake *hs, d_net_frame *out_frame);
+int d_net_frame_handshake_reply(const d_net_handshake_reply *r, d_net_frame *out_frame);
+int d_net_frame_snapshot(const d_net_snapshot *snap, d_net_frame *out_frame);
+int d_net_frame_tick(const d_net_tick *t, d_net_frame *out_frame);
+int d_net_frame_hash(const d_net_hash *h, d_net_frame *out_frame);
+int d_net_frame_error(const d_net_error *e, d_net_frame *out_frame);
+int d_net_frame_qos(const d_net_qos *q, d_net_frame *out_frame);
+
+/* Copies all parts into buf. Returns -2 when buf_size < frame->size. */
+int d_net_frame_flatten(const d_net_frame *frame, void *buf, u32 buf_size);
+
 /* Parse just the frame header and return a payload view. */
 int d_net_decode_frame(
     const void     *buf,
@@ -83,9 +119,15 @@ int d_net_decode_frame(
     d_tlv_blob     *out_payload
 );
 
-/* Encode/decode command packets. */
+/* Encode/decode into caller buffers.
+ * encode_* writes the frame in one pass; when buf_size is too small it
+ * returns -2 and sets *out_size to the required size.
+ * decode_*_view variants borrow payload bytes from buf (nothing to free; valid
+ * while buf is). The plain decoders return heap-owned copies.
+ */
 int d_net_encode_cmd(const d_net_cmd *cmd, void *buf, u32 buf_size, u32 *out_size);
 int d_net_decode_cmd(const void *buf, u32 size, d_net_cmd *out_cmd);
+int d_net_decode_cmd_view(const void *buf, u32 size, d_net_cmd *out_cmd);
 
 int d_net_encode_handshake(const d_net_handshake *hs, void *buf, u32 buf_size, u32 *out_size);
 int d_net_decode_handshake(const void *buf, u32 size, d_net_handshake *out_hs);
@@ -95,6 +137,7 @@ int d_net_decode_handshake_reply(const void *buf, u32 size, d_net_handshake_repl
 
 int d_net_encode_snapshot(const d_net_snapshot *snap, void *buf, u32 buf_size, u32 *out_size);
 int d_net_decode_snapshot(const void *buf, u32 size, d_net_snapshot *out_snap);
+int d_net_decode_snapshot_view(const void *buf, u32 size, d_net_snapshot *out_snap);
 
 int d_net_encode_tick(const d_net_tick *t, void *buf, u32 buf_size, u32 *out_size);
 int d_net_decode_tick(const void *buf, u32 size, d_net_tick *out_t);
@@ -107,6 +150,7 @@ int d_net_decode_error(const void *buf, u32 size, d_net_error *out_e);
 
 int d_net_encode_qos(const d_net_qos *q, void *buf, u32 buf_size, u32 *out_size);
 int d_net_decode_qos(const void *buf, u32 size, d_net_qos *out_q);
+int d_net_decode_qos_view(const void *buf, u32 size, d_net_qos *out_q);
 
 /* Free heap-owned buffers returned by decode_snapshot. */
 void d_net_snapshot_free(d_net_snapshot *snap);
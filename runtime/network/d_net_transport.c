@@ -19,12 +19,16 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 enum {
     D_NET_EVENT_QUEUE_CAP = 64u,
-    D_NET_SEND_TMP_STACK = 2048u
+    D_NET_SEND_POOL_MIN = 4096u
 };
 
 static d_net_transport g_transport;
 static int g_transport_set = 0;
 
+/* Flatten buffer for transports without gather hooks; grows, never shrinks. */
+static unsigned char *g_send_pool = (unsigned char *)0;
+static u32 g_send_pool_cap = 0u;
+
 static d_net_event g_events[D_NET_EVENT_QUEUE_CAP];
 static u32 g_ev_head = 0u;
 static u32 g_ev_tail = 0u;
@@ -78,6 +82,9 @@ int d_net_set_transport(const d_net_transport *t) {
     if (!t || !t->send_to_peer || !t->broadcast) {
         memset(&g_transport, 0, sizeof(g_transport));
         g_transport_set = 0;
+        free(g_send_pool);
+        g_send_pool = (unsigned char *)0;
+        g_send_pool_cap = 0u;
         return -1;
     }
     g_transport = *t;
@@ -92,20 +99,6 @@ const d_net_transport *d_net_get_transport(void) {
     return &g_transport;
 }
 
-static int d_net_send_raw_to_peer(d_peer_id peer, const void *data, u32 size) {
-    if (!g_transport_set || !g_transport.send_to_peer) {
-        return -1;
-    }
-    return g_transport.send_to_peer(g_transport.user_ctx, peer, data, size);
-}
-
-static int d_net_broadcast_raw(const void *data, u32 size) {
-    if (!g_transport_set || !g_transport.broadcast) {
-        return -1;
-    }
-    return g_transport.broadcast(g_transport.user_ctx, data, size);
-}
-
 int d_net_receive_packet(
     d_session_id session,
     d_peer_id    source,
@@ -127,15 +120,14 @@ int d_net_receive_packet(
     if (type == D_NET_MSG_CMD) {
         d_net_cmd cmd;
         memset(&cmd, 0, sizeof(cmd));
-        rc = d_net_decode_cmd(data, size, &cmd);
+        /* The queue copies the payload, so borrow it from the packet. */
+        rc = d_net_decode_cmd_view(data, size, &cmd);
         if (rc != 0) {
             return rc;
         }
         /* Trust the source_peer embedded in cmd; transport source is advisory. */
         (void)source;
-        rc = d_net_cmd_enqueue(&cmd);
-        d_net_cmd_free(&cmd);
-        return rc;
+        return d_net_cmd_enqueue(&cmd);
     }
 
     /* Control/event messages: decode and push onto event queue. */
@@ -184,170 +176,161 @@ int d_net_receive_packet(
     }
 }
 
-static int d_net_send_with_encoder(
-    d_peer_id peer,
-    int (*encode_fn)(const void *, void *, u32, u32 *),
-    const void *obj
-) {
-    unsigned char stack_buf[D_NET_SEND_TMP_STACK];
-    unsigned char *dyn_buf;
-    u32 out_size = 0u;
-    int rc;
-    size_t cap;
-    u32 attempt;
-
-    if (!encode_fn) {
-        return -1;
-    }
-
-    dyn_buf = (unsigned char *)0;
-    rc = encode_fn(obj, stack_buf, (u32)sizeof(stack_buf), &out_size);
-    if (rc == 0) {
-        return d_net_send_raw_to_peer(peer, stack_buf, out_size);
-    }
-    if (rc != -2) {
-        return rc;
+static const unsigned char *d_net_flatten_pooled(const d_net_frame *frame) {
+    if (frame->part_count == 1u) {
+        return frame->parts[0].ptr;
     }
-
-    /* Too small; retry with an expanding heap buffer. */
-    cap = (size_t)(sizeof(stack_buf) * 8u);
-    for (attempt = 0u; attempt < 8u; ++attempt) {
-        dyn_buf = (unsigned char *)malloc(cap);
-        if (!dyn_buf) {
-            return -1;
-        }
-        rc = encode_fn(obj, dyn_buf, (u32)cap, &out_size);
-        if (rc == 0) {
-            rc = d_net_send_raw_to_peer(peer, dyn_buf, out_size);
-            free(dyn_buf);
-            return rc;
+    if (frame->size > g_send_pool_cap) {
+        u32 cap = g_send_pool_cap ? g_send_pool_cap : D_NET_SEND_POOL_MIN;
+        unsigned char *grown;
+        while (cap < frame->size && cap < 0x80000000u) {
+            cap *= 2u;
         }
-        free(dyn_buf);
-        dyn_buf = (unsigned char *)0;
-        if (rc != -2) {
-            return rc;
+        if (cap < frame->size) {
+            cap = frame->size;
         }
-        cap *= 2u;
-        if (cap > (size_t)(16u * 1024u * 1024u)) {
-            break;
+        grown = (unsigned char *)malloc(cap);
+        if (!grown) {
+            return (const unsigned char *)0;
         }
+        free(g_send_pool);
+        g_send_pool = grown;
+        g_send_pool_cap = cap;
     }
-    return -2;
+    if (d_net_frame_flatten(frame, g_send_pool, g_send_pool_cap) != 0) {
+        return (const unsigned char *)0;
+    }
+    return g_send_pool;
 }
 
-static int d_net_broadcast_with_encoder(
-    int (*encode_fn)(const void *, void *, u32, u32 *),
-    const void *obj
-) {
-    unsigned char stack_buf[D_NET_SEND_TMP_STACK];
-    unsigned char *dyn_buf;
-    u32 out_size = 0u;
-    int rc;
-    size_t cap;
-    u32 attempt;
-
-    if (!encode_fn) {
+int d_net_send_frame_to_peers(const d_peer_id *peers, u32 peer_count, const d_net_frame *frame) {
+    const unsigned char *flat = (const unsigned char *)0;
+    int first_rc = 0;
+    u32 i;
+    if (!frame || (peer_count > 0u && !peers)) {
         return -1;
     }
-
-    dyn_buf = (unsigned char *)0;
-    rc = encode_fn(obj, stack_buf, (u32)sizeof(stack_buf), &out_size);
-    if (rc == 0) {
-        return d_net_broadcast_raw(stack_buf, out_size);
-    }
-    if (rc != -2) {
-        return rc;
+    if (!g_transport_set || !g_transport.send_to_peer) {
+        return -1;
     }
-
-    cap = (size_t)(sizeof(stack_buf) * 8u);
-    for (attempt = 0u; attempt < 8u; ++attempt) {
-        dyn_buf = (unsigned char *)malloc(cap);
-        if (!dyn_buf) {
-            return -1;
-        }
-        rc = encode_fn(obj, dyn_buf, (u32)cap, &out_size);
-        if (rc == 0) {
-            rc = d_net_broadcast_raw(dyn_buf, out_size);
-            free(dyn_buf);
-            return rc;
+    if (!g_transport.send_parts_to_peer) {
+        flat = d_net_flatten_pooled(frame);
+        if (!flat) {
+            return -2;
         }
-        free(dyn_buf);
-        dyn_buf = (unsigned char *)0;
-        if (rc != -2) {
-            return rc;
+    }
+    for (i = 0u; i < peer_count; ++i) {
+        int rc;
+        if (flat) {
+            rc = g_transport.send_to_peer(g_transport.user_ctx, peers[i], flat, frame->size);
+        } else {
+            rc = g_transport.send_parts_to_peer(g_transport.user_ctx, peers[i],
+                                                frame->parts, frame->part_count, frame->size);
         }
-        cap *= 2u;
-        if (cap > (size_t)(16u * 1024u * 1024u)) {
-            break;
+        if (rc != 0 && first_rc == 0) {
+            first_rc = rc;
         }
     }
-    return -2;
-}
-
-static int d_net_encode_handshake_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_handshake((const d_net_handshake *)obj, buf, buf_size, out_size);
-}
-
-static int d_net_encode_handshake_reply_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_handshake_reply((const d_net_handshake_reply *)obj, buf, buf_size, out_size);
-}
-
-static int d_net_encode_snapshot_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_snapshot((const d_net_snapshot *)obj, buf, buf_size, out_size);
+    return first_rc;
 }
 
-static int d_net_encode_tick_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_tick((const d_net_tick *)obj, buf, buf_size, out_size);
+int d_net_send_frame(d_peer_id peer, const d_net_frame *frame) {
+    return d_net_send_frame_to_peers(&peer, 1u, frame);
 }
 
-static int d_net_encode_cmd_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_cmd((const d_net_cmd *)obj, buf, buf_size, out_size);
+int d_net_broadcast_frame(const d_net_frame *frame) {
+    const unsigned char *flat;
+    if (!frame) {
+        return -1;
+    }
+    if (!g_transport_set || !g_transport.broadcast) {
+        return -1;
+    }
+    if (g_transport.broadcast_parts) {
+        return g_transport.broadcast_parts(g_transport.user_ctx,
+                                           frame->parts, frame->part_count, frame->size);
+    }
+    flat = d_net_flatten_pooled(frame);
+    if (!flat) {
+        return -2;
+    }
+    return g_transport.broadcast(g_transport.user_ctx, flat, frame->size);
 }
 
-static int d_net_encode_hash_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_hash((const d_net_hash *)obj, buf, buf_size, out_size);
+int d_net_send_handshake(d_peer_id peer, const d_net_handshake *hs) {
+    d_net_frame frame;
+    int rc = d_net_frame_handshake(hs, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
 
-static int d_net_encode_error_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_error((const d_net_error *)obj, buf, buf_size, out_size);
+int d_net_send_handshake_reply(d_peer_id peer, const d_net_handshake_reply *r) {
+    d_net_frame frame;
+    int rc = d_net_frame_handshake_reply(r, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
 
-static int d_net_encode_qos_adapter(const void *obj, void *buf, u32 buf_size, u32 *out_size) {
-    return d_net_encode_qos((const d_net_qos *)obj, buf, buf_size, out_size);
+int d_net_send_snapshot(d_peer_id peer, const d_net_snapshot *snap) {
+    d_net_frame frame;
+    int rc = d_net_frame_snapshot(snap, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
 
-int d_net_send_handshake(d_peer_id peer, const d_net_handshake *hs) {
-    return d_net_send_with_encoder(peer, d_net_encode_handshake_adapter, hs);
+int d_net_send_snapshot_to_peers(const d_peer_id *peers, u32 peer_count, const d_net_snapshot *snap) {
+    d_net_frame frame;
+    int rc = d_net_frame_snapshot(snap, &frame);
+    return (rc != 0) ? rc : d_net_send_frame_to_peers(peers, peer_count, &frame);
 }
 
-int d_net_send_handshake_reply(d_peer_id peer, const d_net_handshake_reply *r) {
-    return d_net_send_with_encoder(peer, d_net_encode_handshake_reply_adapter, r);
+int d_net_broadcast_snapshot(const d_net_snapshot *snap) {
+    d_net_frame frame;
+    int rc = d_net_frame_snapshot(snap, &frame);
+    return (rc != 0) ? rc : d_net_broadcast_frame(&frame);
 }
 
-int d_net_send_snapshot(d_peer_id peer, const d_net_snapshot *snap) {
-    return d_net_send_with_encoder(peer, d_net_encode_snapshot_adapter, snap);
+int d_net_send_tick(d_peer_id peer, const d_net_tick *t) {
+    d_net_frame frame;
+    int rc = d_net_frame_tick(t, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
 
-int d_net_send_tick(d_peer_id peer, const d_net_tick *t) {
-    return d_net_send_with_encoder(peer, d_net_encode_tick_adapter, t);
+int d_net_broadcast_tick(const d_net_tick *t) {
+    d_net_frame frame;
+    int rc = d_net_frame_tick(t, &frame);
+    return (rc != 0) ? rc : d_net_broadcast_frame(&frame);
 }
 
 int d_net_send_cmd(d_peer_id peer, const d_net_cmd *cmd) {
-    return d_net_send_with_encoder(peer, d_net_encode_cmd_adapter, cmd);
+    d_net_frame frame;
+    int rc = d_net_frame_cmd(cmd, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
 
 int d_net_broadcast_cmd(const d_net_cmd *cmd) {
-    return d_net_broadcast_with_encoder(d_net_encode_cmd_adapter, cmd);
+    d_net_frame frame;
+    int rc = d_net_frame_cmd(cmd, &frame);
+    return (rc != 0) ? rc : d_net_broadcast_frame(&frame);
 }
 
 int d_net_send_hash(d_peer_id peer, const d_net_hash *h) {
-    return d_net_send_with_encoder(peer, d_net_encode_hash_adapter, h);
+    d_net_frame frame;
+    int rc = d_net_frame_hash(h, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
+}
+
+int d_net_broadcast_hash(const d_net_hash *h) {
+    d_net_frame frame;
+    int rc = d_net_frame_hash(h, &frame);
+    return (rc != 0) ? rc : d_net_broadcast_frame(&frame);
 }
 
 int d_net_send_error(d_peer_id peer, const d_net_error *e) {
-    return d_net_send_with_encoder(peer, d_net_encode_error_adapter, e);
+    d_net_frame frame;
+    int rc = d_net_frame_error(e, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
 
 int d_net_send_qos(d_peer_id peer, const d_net_qos *q) {
-    return d_net_send_with_encoder(peer, d_net_encode_qos_adapter, q);
+    d_net_frame frame;
+    int rc = d_net_frame_qos(q, &frame);
+    return (rc != 0) ? rc : d_net_send_frame(peer, &frame);
 }
@@ -36,10 +36,29 @@ typedef int (*d_net_broadcast_fn)(
     u32         size
 );
 
+/* Optional gather hooks: receive the frame as parts (see d_net_frame) so large
+ * payloads reach the socket layer without an intermediate copy. */
+typedef int (*d_net_send_parts_fn)(
+    void                   *user,
+    d_peer_id               peer,
+    const d_net_frame_part *parts,
+    u32                     part_count,
+    u32                     total_size
+);
+
+typedef int (*d_net_broadcast_parts_fn)(
+    void                   *user,
+    const d_net_frame_part *parts,
+    u32                     part_count,
+    u32                     total_size
+);
+
 typedef struct d_net_transport_s {
-    void               *user_ctx;
-    d_net_send_fn       send_to_peer;
-    d_net_broadcast_fn  broadcast;
+    void                     *user_ctx;
+    d_net_send_fn             send_to_peer;
+    d_net_broadcast_fn        broadcast;
+    d_net_send_parts_fn       send_parts_to_peer;  /* optional */
+    d_net_broadcast_parts_fn  broadcast_parts;     /* optional */
 } d_net_transport;
 
 int d_net_set_transport(const d_net_transport *t);
@@ -84,14 +103,25 @@ int d_net_receive_packet(
 int d_net_poll_event(d_net_event *out_ev);
 void d_net_event_free(d_net_event *ev);
 
-/* Convenience: encode+send helpers that invoke the registered transport. */
+/* Send a prebuilt frame. Without gather hooks the frame is flattened once into
+ * a pooled buffer owned by the transport layer. */
+int d_net_send_frame(d_peer_id peer, const d_net_frame *frame);
+int d_net_send_frame_to_peers(const d_peer_id *peers, u32 peer_count, const d_net_frame *frame);
+int d_net_broadcast_frame(const d_net_frame *frame);
+
+/* Convenience: encode+send helpers that invoke the registered transport.
+ * Each message is encoded once, including for broadcast and multi-peer sends. */
 int d_net_send_handshake(d_peer_id peer, const d_net_handshake *hs);
 int d_net_send_handshake_reply(d_peer_id peer, const d_net_handshake_reply *r);
 int d_net_send_snapshot(d_peer_id peer, const d_net_snapshot *snap);
+int d_net_send_snapshot_to_peers(const d_peer_id *peers, u32 peer_count, const d_net_snapshot *snap);
+int d_net_broadcast_snapshot(const d_net_snapshot *snap);
 int d_net_send_tick(d_peer_id peer, const d_net_tick *t);
+int d_net_broadcast_tick(const d_net_tick *t);
 int d_net_send_cmd(d_peer_id peer, const d_net_cmd *cmd);
 int d_net_broadcast_cmd(const d_net_cmd *cmd);
 int d_net_send_hash(d_peer_id peer, const d_net_hash *h);
+int d_net_broadcast_hash(const d_net_hash *h);
 int d_net_send_error(d_peer_id peer, const d_net_error *e);
 int d_net_send_qos(d_peer_id peer, const d_net_qos *q);
 
@@ -9,6 +9,8 @@ RESPONSIBILITY: Deterministic authoritative server runtime for MMO-1.
 #include <stdlib.h>
 #include <string.h>
 
+#include "domino/system/dsys_trace.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -51,6 +53,54 @@ static u64 dom_server_hash_mix(u64 hash, u64 value)
     return hash;
 }
 
+static u32 dom_server_id_index_home(u64 key, u32 mask)
+{
+    key ^= key >> 33u;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33u;
+    return (u32)key & mask;
+}
+
+/* Power-of-two bucket count keeping the load factor at or below one half. */
+static u32 dom_server_id_index_buckets(u32 capacity)
+{
+    u32 buckets = 2u;
+    while (buckets < capacity * 2u && buckets < 0x80000000u) {
+        buckets *= 2u;
+    }
+    return buckets;
+}
+
+static int dom_server_id_index_find(const dom_server_id_index* index, u64 key)
+{
+    u32 pos;
+    if (!index || !index->slots) {
+        return -1;
+    }
+    pos = dom_server_id_index_home(key, index->mask);
+    while (index->slots[pos].index != 0u) {
+        if (index->slots[pos].key == key) {
+            return (int)(index->slots[pos].index - 1u);
+        }
+        pos = (pos + 1u) & index->mask;
+    }
+    return -1;
+}
+
+static void dom_server_id_index_insert(dom_server_id_index* index, u64 key, u32 value)
+{
+    u32 pos;
+    if (!index || !index->slots) {
+        return;
+    }
+    pos = dom_server_id_index_home(key, index->mask);
+    while (index->slots[pos].index != 0u) {
+        pos = (pos + 1u) & index->mask;
+    }
+    index->slots[pos].key = key;
+    index->slots[pos].index = value + 1u;
+}
+
 static d_world* dom_server_make_world(u32 seed)
 {
     d_world_config cfg;
@@ -167,6 +217,9 @@ static int dom_server_owner_index(const dom_server_runtime* runtime, u64 domain_
     if (!runtime) {
         return -1;
     }
+    if (runtime->owner_index.slots) {
+        return dom_server_id_index_find(&runtime->owner_index, domain_id);
+    }
     for (i = 0u; i < runtime->owner_count; ++i) {
         if (runtime->owners[i].domain_id == domain_id) {
             return (int)i;
@@ -197,11 +250,12 @@ static void dom_server_owner_set(dom_server_runtime* runtime,
         runtime->owners[(u32)idx].owner_shard_id = owner_shard_id;
         return;
     }
-    if (runtime->owner_count >= DOM_SERVER_MAX_DOMAIN_OWNERS) {
+    if (runtime->owner_count >= runtime->owner_capacity) {
         return;
     }
     runtime->owners[runtime->owner_count].domain_id = domain_id;
     runtime->owners[runtime->owner_count].owner_shard_id = owner_shard_id;
+    dom_server_id_index_insert(&runtime->owner_index, domain_id, runtime->owner_count);
     runtime->owner_count += 1u;
 }
 
@@ -211,6 +265,10 @@ static dom_server_client* dom_server_find_client(dom_server_runtime* runtime, u6
     if (!runtime) {
         return 0;
     }
+    if (runtime->client_index.slots) {
+        const int idx = dom_server_id_index_find(&runtime->client_index, client_id);
+        return (idx >= 0) ? &runtime->clients[(u32)idx] : 0;
+    }
     for (i = 0u; i < runtime->client_count; ++i) {
         if (runtime->clients[i].client_id == client_id) {
             return &runtime->clients[i];
@@ -225,6 +283,11 @@ static dom_server_shard* dom_server_find_shard(dom_server_runtime* runtime, dom_
     if (!runtime || shard_id == 0u) {
         return 0;
     }
+    /* Shards are created with shard_id == index + 1. */
+    if ((u32)shard_id <= runtime->shard_count &&
+        runtime->shards[(u32)shard_id - 1u].shard_id == shard_id) {
+        return &runtime->shards[(u32)shard_id - 1u];
+    }
     for (i = 0u; i < runtime->shard_count; ++i) {
         if (runtime->shards[i].shard_id == shard_id) {
             return &runtime->shards[i];
@@ -333,7 +396,7 @@ static int dom_server_event_append(dom_server_runtime* runtime,
     if (!runtime || !event) {
         return -1;
     }
-    if (runtime->event_count >= DOM_SERVER_MAX_EVENTS) {
+    if (runtime->event_count >= runtime->event_capacity) {
         runtime->event_overflow += 1u;
         return -2;
     }
@@ -577,10 +640,23 @@ static int dom_server_shard_init(dom_server_shard* shard,
     u64 domain_network = 0u;
     u64 domain_agents = 0u;
     u32 bias = shard_id * 13u;
+    dom_scale_domain_slot* domain_storage;
+    dom_interest_state* interest_storage;
+    u32 domain_capacity;
     if (!shard || !config || shard_id == 0u) {
         return -1;
     }
+    domain_storage = shard->domain_storage;
+    interest_storage = shard->interest_storage;
+    domain_capacity = shard->domain_capacity;
+    if (!domain_storage || !interest_storage ||
+        domain_capacity < DOM_SERVER_MIN_DOMAINS_PER_SHARD) {
+        return -1;
+    }
     memset(shard, 0, sizeof(*shard));
+    shard->domain_storage = domain_storage;
+    shard->interest_storage = interest_storage;
+    shard->domain_capacity = domain_capacity;
     shard->shard_id = shard_id;
     shard->world = dom_server_make_world(123u + shard_id);
     if (!shard->world) {
@@ -594,9 +670,9 @@ static int dom_server_shard_init(dom_server_shard* shard,
     dom_scale_context_init(&shard->scale_ctx,
                            shard->world,
                            shard->domain_storage,
-                           DOM_SERVER_MAX_DOMAINS_PER_SHARD,
+                           shard->domain_capacity,
                            shard->interest_storage,
-                           DOM_SERVER_MAX_DOMAINS_PER_SHARD,
+                           shard->domain_capacity,
                            &shard->scale_event_log,
                            config->start_tick,
                            config->worker_count);
@@ -702,17 +778,10 @@ static int dom_server_queue_deferred(dom_server_runtime* runtime,
                                      const dom_server_intent* intent,
                                      u32 refusal_code)
 {
-    u32 limit = runtime ? runtime->config.deferred_limit : 0u;
     if (!runtime || !intent) {
         return 0;
     }
-    if (limit == 0u) {
-        limit = DOM_SERVER_MAX_DEFERRED;
-    }
-    if (limit > DOM_SERVER_MAX_DEFERRED) {
-        limit = DOM_SERVER_MAX_DEFERRED;
-    }
-    if (runtime->deferred_count >= limit) {
+    if (runtime->deferred_count >= runtime->deferred_capacity) {
         runtime->deferred_overflow += 1u;
         return 0;
     }
@@ -1365,7 +1434,8 @@ static void dom_server_checkpoint_policy_resolve(dom_checkpoint_policy* policy)
     if (policy->interval_ticks == 0u &&
         policy->macro_event_stride == 0u &&
         policy->checkpoint_before_transfer == 0u &&
-        policy->max_records == 0u) {
+        policy->max_records == 0u &&
+        policy->base_interval == 0u) {
         dom_checkpoint_policy_default(policy);
         return;
     }
@@ -1435,7 +1505,111 @@ void dom_server_runtime_config_default(dom_server_runtime_config* config)
     config->shard_capability_mask = config->default_client_policy.capability_mask;
     config->shard_baseline_hash = dom_server_baseline_hash(config->shard_version_id,
                                                             config->shard_capability_mask);
-    config->deferred_limit = DOM_SERVER_MAX_DEFERRED;
+    config->deferred_limit = DOM_SERVER_DEFAULT_DEFERRED;
+    config->max_clients = DOM_SERVER_DEFAULT_CLIENTS;
+    config->max_intents = DOM_SERVER_DEFAULT_INTENTS;
+    config->max_events = DOM_SERVER_DEFAULT_EVENTS;
+    config->max_domain_owners = DOM_SERVER_DEFAULT_DOMAIN_OWNERS;
+    config->max_messages = DOM_SERVER_DEFAULT_MESSAGES;
+    config->max_idempotency = DOM_SERVER_DEFAULT_IDEMPOTENCY;
+    config->domains_per_shard = DOM_SERVER_DEFAULT_DOMAINS_PER_SHARD;
+}
+
+static void dom_server_capacities_resolve(dom_server_runtime_config* config)
+{
+    if (config->deferred_limit == 0u) {
+        config->deferred_limit = DOM_SERVER_DEFAULT_DEFERRED;
+    }
+    if (config->max_clients == 0u) {
+        config->max_clients = DOM_SERVER_DEFAULT_CLIENTS;
+    }
+    if (config->max_intents == 0u) {
+        config->max_intents = DOM_SERVER_DEFAULT_INTENTS;
+    }
+    if (config->max_events == 0u) {
+        config->max_events = DOM_SERVER_DEFAULT_EVENTS;
+    }
+    if (config->max_domain_owners == 0u) {
+        config->max_domain_owners = DOM_SERVER_DEFAULT_DOMAIN_OWNERS;
+    }
+    if (config->max_messages == 0u) {
+        config->max_messages = DOM_SERVER_DEFAULT_MESSAGES;
+    }
+    if (config->max_idempotency == 0u) {
+        config->max_idempotency = DOM_SERVER_DEFAULT_IDEMPOTENCY;
+    }
+    if (config->domains_per_shard == 0u) {
+        config->domains_per_shard = DOM_SERVER_DEFAULT_DOMAINS_PER_SHARD;
+    }
+    if (config->domains_per_shard < DOM_SERVER_MIN_DOMAINS_PER_SHARD) {
+        config->domains_per_shard = DOM_SERVER_MIN_DOMAINS_PER_SHARD;
+    }
+}
+
+typedef struct dom_server_arena {
+    unsigned char* base; /* null while measuring */
+    size_t used;
+} dom_server_arena;
+
+static void* dom_server_arena_take(dom_server_arena* arena, size_t count, size_t size)
+{
+    const size_t offset = (arena->used + 15u) & ~(size_t)15u;
+    arena->used = offset + count * size;
+    return arena->base ? (void*)(arena->base + offset) : (void*)0;
+}
+
+/* Lays out every runtime array; runs once to measure and once to carve. */
+static void dom_server_runtime_carve(dom_server_runtime* runtime, dom_server_arena* arena)
+{
+    const dom_server_runtime_config* config = &runtime->config;
+    const u32 client_buckets = dom_server_id_index_buckets(config->max_clients);
+    const u32 owner_buckets = dom_server_id_index_buckets(config->max_domain_owners);
+    const u32 idempotency_buckets = dom_server_id_index_buckets(config->max_idempotency);
+    u32 i;
+
+    runtime->shards = (dom_server_shard*)dom_server_arena_take(
+        arena, runtime->shard_count, sizeof(dom_server_shard));
+    runtime->clients = (dom_server_client*)dom_server_arena_take(
+        arena, config->max_clients, sizeof(dom_server_client));
+    runtime->client_index.slots = (dom_server_id_slot*)dom_server_arena_take(
+        arena, client_buckets, sizeof(dom_server_id_slot));
+    runtime->client_index.mask = client_buckets - 1u;
+    runtime->checkpoint_records = (dom_checkpoint_record*)dom_server_arena_take(
+        arena, config->checkpoint_policy.max_records, sizeof(dom_checkpoint_record));
+    runtime->intents = (dom_server_intent*)dom_server_arena_take(
+        arena, config->max_intents, sizeof(dom_server_intent));
+    runtime->deferred = (dom_server_deferred_intent*)dom_server_arena_take(
+        arena, config->deferred_limit, sizeof(dom_server_deferred_intent));
+    runtime->owners = (dom_server_domain_owner*)dom_server_arena_take(
+        arena, config->max_domain_owners, sizeof(dom_server_domain_owner));
+    runtime->owner_index.slots = (dom_server_id_slot*)dom_server_arena_take(
+        arena, owner_buckets, sizeof(dom_server_id_slot));
+    runtime->owner_index.mask = owner_buckets - 1u;
+    runtime->events = (dom_server_event*)dom_server_arena_take(
+        arena, config->max_events, sizeof(dom_server_event));
+    runtime->message_storage = (dom_cross_shard_message*)dom_server_arena_take(
+        arena, config->max_messages, sizeof(dom_cross_shard_message));
+    runtime->message_idempotency = (dom_cross_shard_idempotency_entry*)dom_server_arena_take(
+        arena, config->max_idempotency, sizeof(dom_cross_shard_idempotency_entry));
+    runtime->message_idempotency_index = (u32*)dom_server_arena_take(
+        arena, idempotency_buckets, sizeof(u32));
+    runtime->message_idempotency_index_capacity = idempotency_buckets;
+    for (i = 0u; i < runtime->shard_count; ++i) {
+        dom_scale_domain_slot* domains = (dom_scale_domain_slot*)dom_server_arena_take(
+            arena, config->domains_per_shard, sizeof(dom_scale_domain_slot));
+        dom_interest_state* interest = (dom_interest_state*)dom_server_arena_take(
+            arena, config->domains_per_shard, sizeof(dom_interest_state));
+        if (arena->base) {
+            runtime->shards[i].domain_storage = domains;
+            runtime->shards[i].interest_storage = interest;
+            runtime->shards[i].domain_capacity = config->domains_per_shard;
+        }
+    }
+    runtime->client_capacity = config->max_clients;
+    runtime->intent_capacity = config->max_intents;
+    runtime->deferred_capacity = config->deferred_limit;
+    runtime->owner_capacity = config->max_domain_owners;
+    runtime->event_capacity = config->max_events;
 }
 
 int dom_server_runtime_init(dom_server_runtime* runtime,
@@ -1456,6 +1630,7 @@ int dom_server_runtime_init(dom_server_runtime* runtime,
     if (local.shard_count > DOM_SERVER_MAX_SHARDS) {
         local.shard_count = DOM_SERVER_MAX_SHARDS;
     }
+    dom_server_capacities_resolve(&local);
     dom_server_checkpoint_policy_resolve(&local.checkpoint_policy);
     if (local.worlddef_hash == 0u) {
         local.worlddef_hash = 1u;
@@ -1484,6 +1659,23 @@ int dom_server_runtime_init(dom_server_runtime* runtime,
     runtime->last_macro_stride = 0u;
     runtime->checkpoints_taken = 0u;
 
+    {
+        dom_server_arena arena;
+        arena.base = 0;
+        arena.used = 0u;
+        dom_server_runtime_carve(runtime, &arena);
+        runtime->arena_bytes = arena.used;
+        runtime->arena = (unsigned char*)calloc(1u, runtime->arena_bytes);
+        if (!runtime->arena) {
+            runtime->arena_bytes = 0u;
+            runtime->shard_count = 0u;
+            return -3;
+        }
+        arena.base = runtime->arena;
+        arena.used = 0u;
+        dom_server_runtime_carve(runtime, &arena);
+    }
+
     dom_shard_lifecycle_log_init(&runtime->lifecycle_log,
                                  runtime->lifecycle_entries,
                                  (u32)(sizeof(runtime->lifecycle_entries) /
@@ -1494,9 +1686,12 @@ int dom_server_runtime_init(dom_server_runtime* runtime,
 
     dom_cross_shard_log_init(&runtime->message_log,
                              runtime->message_storage,
-                             DOM_SERVER_MAX_MESSAGES,
+                             runtime->config.max_messages,
                              runtime->message_idempotency,
-                             DOM_SERVER_MAX_IDEMPOTENCY);
+                             runtime->config.max_idempotency);
+    (void)dom_cross_shard_log_attach_index(&runtime->message_log,
+                                           runtime->message_idempotency_index,
+                                           runtime->message_idempotency_index_capacity);
 
     for (i = 0u; i < runtime->shard_count; ++i) {
         dom_server_shard* shard = &runtime->shards[i];
@@ -1517,6 +1712,50 @@ int dom_server_runtime_init(dom_server_runtime* runtime,
     return 0;
 }
 
+void dom_server_runtime_dispose(dom_server_runtime* runtime)
+{
+    u32 i;
+    if (!runtime) {
+        return;
+    }
+    if (runtime->checkpoint_records) {
+        for (i = 0u; i < runtime->checkpoint_store.capacity; ++i) {
+            dom_checkpoint_record_dispose(&runtime->checkpoint_records[i]);
+        }
+    }
+    if (runtime->shards) {
+        for (i = 0u; i < runtime->shard_count; ++i) {
+            if (runtime->shards[i].world) {
+                d_world_destroy_instance(runtime->shards[i].world);
+            }
+        }
+    }
+    free(runtime->arena);
+    memset(runtime, 0, sizeof(*runtime));
+}
+
+void dom_server_runtime_reindex(dom_server_runtime* runtime)
+{
+    u32 i;
+    if (!runtime) {
+        return;
+    }
+    if (runtime->client_index.slots) {
+        memset(runtime->client_index.slots, 0,
+               sizeof(dom_server_id_slot) * ((size_t)runtime->client_index.mask + 1u));
+        for (i = 0u; i < runtime->client_count; ++i) {
+            dom_server_id_index_insert(&runtime->client_index, runtime->clients[i].client_id, i);
+        }
+    }
+    if (runtime->owner_index.slots) {
+        memset(runtime->owner_index.slots, 0,
+               sizeof(dom_server_id_slot) * ((size_t)runtime->owner_index.mask + 1u));
+        for (i = 0u; i < runtime->owner_count; ++i) {
+            dom_server_id_index_insert(&runtime->owner_index, runtime->owners[i].domain_id, i);
+        }
+    }
+}
+
 int dom_server_runtime_add_client(dom_server_runtime* runtime,
                                   u64 client_id,
                                   dom_shard_id shard_id,
@@ -1533,9 +1772,10 @@ int dom_server_runtime_add_client(dom_server_runtime* runtime,
     if (client) {
         return -3;
     }
-    if (runtime->client_count >= DOM_SERVER_MAX_CLIENTS) {
+    if (runtime->client_count >= runtime->client_capacity) {
         return -4;
     }
+    dom_server_id_index_insert(&runtime->client_index, client_id, runtime->client_count);
     client = &runtime->clients[runtime->client_count++];
     memset(client, 0, sizeof(*client));
     client->client_id = client_id;
@@ -1556,7 +1796,7 @@ int dom_server_runtime_submit_intent(dom_server_runtime* runtime,
     if (!runtime || !intent) {
         return -1;
     }
-    if (runtime->intent_count >= DOM_SERVER_MAX_INTENTS) {
+    if (runtime->intent_count >= runtime->intent_capacity) {
         runtime->intent_overflow += 1u;
         return -2;
     }
@@ -1590,21 +1830,31 @@ int dom_server_runtime_tick(dom_server_runtime* runtime, dom_act_time_t tick)
     for (t = runtime->now_tick; t <= tick; ++t) {
         u32 i;
         runtime->now_tick = t;
+        dsys_trace_tick_begin((u64)t);
         for (i = 0u; i < runtime->client_count; ++i) {
             dom_server_client_budget_reset(&runtime->clients[i], runtime->now_tick);
         }
         for (i = 0u; i < runtime->shard_count; ++i) {
             dom_server_scale_begin_tick(&runtime->shards[i].scale_ctx, runtime->now_tick);
         }
+        DSYS_TRACE_BEGIN("server.messages", runtime->message_sequence);
         dom_server_process_messages(runtime);
+        DSYS_TRACE_END("server.messages");
+        DSYS_TRACE_BEGIN("server.deferred", runtime->deferred_count);
         dom_server_process_deferred(runtime);
+        DSYS_TRACE_END("server.deferred");
+        DSYS_TRACE_BEGIN("server.intents", runtime->intent_count);
         for (i = 0u; i < runtime->intent_count; ++i) {
             if (runtime->intents[i].intent_tick <= runtime->now_tick) {
                 (void)dom_server_process_intent(runtime, &runtime->intents[i]);
             }
         }
         dom_server_retain_future_intents(runtime);
+        DSYS_TRACE_END("server.intents");
+        DSYS_TRACE_BEGIN("server.checkpoint", t);
         dom_server_checkpoint_schedule(runtime);
+        DSYS_TRACE_END("server.checkpoint");
+        (void)dsys_trace_tick_end();
         if (t == tick) {
             break;
         }
@@ -1857,8 +2107,8 @@ int dom_server_runtime_checkpoint(dom_server_runtime* runtime,
     dom_checkpoint_record* record = 0;
     dom_server_event ev;
     dom_server_shard* event_shard = 0;
-    u32 snapshot_costs[DOM_SERVER_MAX_SHARDS];
-    u32 snapshot_prior[DOM_SERVER_MAX_SHARDS];
+    u32* snapshot_costs = 0;
+    u32* snapshot_prior = 0;
     u32 i;
     u32 refusal = DOM_SERVER_REFUSE_NONE;
     u32 detail = trigger_reason;
@@ -1868,9 +2118,13 @@ int dom_server_runtime_checkpoint(dom_server_runtime* runtime,
         return -1;
     }
     record = (dom_checkpoint_record*)calloc(1u, sizeof(*record));
-    if (!record) {
+    snapshot_costs = (u32*)calloc((size_t)runtime->shard_count + 1u, sizeof(u32) * 2u);
+    if (!record || !snapshot_costs) {
+        free(record);
+        free(snapshot_costs);
         return -2;
     }
+    snapshot_prior = snapshot_costs + runtime->shard_count;
     if (runtime->shard_count > 0u) {
         event_shard = &runtime->shards[0];
     }
@@ -1936,6 +2190,7 @@ int dom_server_runtime_checkpoint(dom_server_runtime* runtime,
     (void)dom_server_event_append(runtime, event_shard, &ev);
     dom_checkpoint_record_dispose(record);
     free(record);
+    free(snapshot_costs);
     return 0;
 
 dom_checkpoint_refuse:
@@ -1957,6 +2212,7 @@ dom_checkpoint_refuse:
     (void)dom_server_event_append(runtime, event_shard, &ev);
     dom_checkpoint_record_dispose(record);
     free(record);
+    free(snapshot_costs);
     return rc;
 }
 
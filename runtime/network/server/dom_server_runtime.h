@@ -8,6 +8,8 @@ DETERMINISM: All ordering, admission, and hashing are stable.
 #ifndef DOMINIUM_SERVER_NET_DOM_SERVER_RUNTIME_H
 #define DOMINIUM_SERVER_NET_DOM_SERVER_RUNTIME_H
 
+#include <stddef.h>
+
 #include "domino/core/types.h"
 #include "domino/core/dom_time_core.h"
 #include "domino/sim/sim.h"
@@ -36,7 +38,7 @@ typedef struct dom_server_client_policy {
 
 typedef struct dom_server_runtime_config {
     dom_act_time_t start_tick;
-    u32 shard_count;
+    u32 shard_count; /* 0 selects 1; clamped to DOM_SERVER_MAX_SHARDS */
     u32 worker_count;
     u64 worlddef_hash;
     u64 capability_lock_hash;
@@ -48,6 +50,16 @@ typedef struct dom_server_runtime_config {
     u64 shard_baseline_hash;
     dom_server_client_policy default_client_policy;
     u32 deferred_limit;
+
+    /* Storage capacities, allocated once at init; 0 selects the
+       DOM_SERVER_DEFAULT_* value. */
+    u32 max_clients;
+    u32 max_intents;
+    u32 max_events;
+    u32 max_domain_owners;
+    u32 max_messages;
+    u32 max_idempotency;
+    u32 domains_per_shard;
 } dom_server_runtime_config;
 
 typedef struct dom_server_client {
@@ -68,8 +80,9 @@ typedef struct dom_server_shard {
     dom_shard_id shard_id;
     d_world* world;
     dom_scale_context scale_ctx;
-    dom_scale_domain_slot domain_storage[DOM_SERVER_MAX_DOMAINS_PER_SHARD];
-    dom_interest_state interest_storage[DOM_SERVER_MAX_DOMAINS_PER_SHARD];
+    dom_scale_domain_slot* domain_storage;
+    dom_interest_state* interest_storage;
+    u32 domain_capacity;
     dom_scale_event_log scale_event_log;
     dom_scale_event scale_events[256];
     dom_scale_macro_policy macro_policy;
@@ -93,43 +106,60 @@ typedef struct dom_server_runtime {
     u64 last_macro_stride;
     u32 checkpoints_taken;
 
-    dom_server_shard shards[DOM_SERVER_MAX_SHARDS];
+    /* Every array below is carved from this block at init. */
+    unsigned char* arena;
+    size_t arena_bytes;
+
+    dom_server_shard* shards;
     u32 shard_count;
 
-    dom_server_client clients[DOM_SERVER_MAX_CLIENTS];
+    dom_server_client* clients;
     u32 client_count;
+    u32 client_capacity;
+    dom_server_id_index client_index;
 
     dom_shard_lifecycle_log lifecycle_log;
     dom_shard_lifecycle_entry lifecycle_entries[256];
 
     dom_checkpoint_store checkpoint_store;
-    dom_checkpoint_record checkpoint_records[DOM_CHECKPOINT_MAX_RECORDS];
+    dom_checkpoint_record* checkpoint_records;
 
-    dom_server_intent intents[DOM_SERVER_MAX_INTENTS];
+    dom_server_intent* intents;
     u32 intent_count;
     u32 intent_overflow;
+    u32 intent_capacity;
 
-    dom_server_deferred_intent deferred[DOM_SERVER_MAX_DEFERRED];
+    dom_server_deferred_intent* deferred;
     u32 deferred_count;
     u32 deferred_overflow;
+    u32 deferred_capacity;
 
-    dom_server_domain_owner owners[DOM_SERVER_MAX_DOMAIN_OWNERS];
+    dom_server_domain_owner* owners;
     u32 owner_count;
+    u32 owner_capacity;
+    dom_server_id_index owner_index;
 
-    dom_server_event events[DOM_SERVER_MAX_EVENTS];
+    dom_server_event* events;
     u32 event_count;
     u32 event_overflow;
+    u32 event_capacity;
 
     dom_cross_shard_log message_log;
-    dom_cross_shard_message message_storage[DOM_SERVER_MAX_MESSAGES];
-    dom_cross_shard_idempotency_entry message_idempotency[DOM_SERVER_MAX_IDEMPOTENCY];
+    dom_cross_shard_message* message_storage;
+    dom_cross_shard_idempotency_entry* message_idempotency;
+    u32* message_idempotency_index;
+    u32 message_idempotency_index_capacity;
     u64 message_sequence;
     u64 message_applied;
 } dom_server_runtime;
 
 void dom_server_runtime_config_default(dom_server_runtime_config* config);
+/* Sizes and allocates all runtime storage from config; pair with _dispose. */
 int dom_server_runtime_init(dom_server_runtime* runtime,
                             const dom_server_runtime_config* config);
+void dom_server_runtime_dispose(dom_server_runtime* runtime);
+/* Rebuilds the client and owner hash indexes after bulk restores. */
+void dom_server_runtime_reindex(dom_server_runtime* runtime);
 
 int dom_server_runtime_add_client(dom_server_runtime* runtime,
                                   u64 client_id,
@@ -16,15 +16,22 @@ RESPONSIBILITY: Shared deterministic server sizing constants and small structs.
 extern "C" {
 #endif
 
-#define DOM_SERVER_MAX_SHARDS 4u
-#define DOM_SERVER_MAX_CLIENTS 16u
-#define DOM_SERVER_MAX_DOMAINS_PER_SHARD 3u
-#define DOM_SERVER_MAX_EVENTS 4096u
-#define DOM_SERVER_MAX_INTENTS 1024u
-#define DOM_SERVER_MAX_DEFERRED 256u
-#define DOM_SERVER_MAX_DOMAIN_OWNERS 64u
-#define DOM_SERVER_MAX_MESSAGES 2048u
-#define DOM_SERVER_MAX_IDEMPOTENCY 2048u
+/* Capacities used when dom_server_runtime_config leaves a limit at 0. */
+#define DOM_SERVER_DEFAULT_CLIENTS 16u
+#define DOM_SERVER_DEFAULT_DOMAINS_PER_SHARD 3u
+#define DOM_SERVER_DEFAULT_EVENTS 4096u
+#define DOM_SERVER_DEFAULT_INTENTS 1024u
+#define DOM_SERVER_DEFAULT_DEFERRED 256u
+#define DOM_SERVER_DEFAULT_DOMAIN_OWNERS 64u
+#define DOM_SERVER_DEFAULT_MESSAGES 2048u
+#define DOM_SERVER_DEFAULT_IDEMPOTENCY 2048u
+
+/* Hard ceilings. DOM_SERVER_MAX_SHARDS only clamps config.shard_count and
+   sizes no array: shards and per-shard scratch are allocated per runtime from
+   the configured count. The bound is the u16 shard_of_origin carried by
+   dom_global_id. Every shard registers its three built-in domains. */
+#define DOM_SERVER_MAX_SHARDS 65535u
+#define DOM_SERVER_MIN_DOMAINS_PER_SHARD 3u
 #define DOM_SERVER_MAX_CLIENT_IDEMPOTENCY 256u
 
 typedef struct dom_server_domain_owner {
@@ -32,6 +39,18 @@ typedef struct dom_server_domain_owner {
     dom_shard_id owner_shard_id;
 } dom_server_domain_owner;
 
+/* Open-addressed id -> array index map; index is stored + 1, 0 = empty. */
+typedef struct dom_server_id_slot {
+    u64 key;
+    u32 index;
+    u32 reserved;
+} dom_server_id_slot;
+
+typedef struct dom_server_id_index {
+    dom_server_id_slot* slots;
+    u32 mask;
+} dom_server_id_index;
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -7,6 +7,7 @@ DETERMINISM: Ordering and idempotency checks are stable across platforms.
 */
 #include "dom_cross_shard_log.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -36,6 +37,7 @@ static u32 dom_cross_shard_idempotency_size(const dom_cross_shard_log* log)
         : log->idempotency_capacity;
 }
 
+/* Total order over every field, so heap order and sorted order agree. */
 static int dom_cross_shard_compare(const dom_cross_shard_message* a,
                                    const dom_cross_shard_message* b)
 {
@@ -66,25 +68,117 @@ static int dom_cross_shard_compare(const dom_cross_shard_message* a,
     if (a->payload_hash != b->payload_hash) {
         return (a->payload_hash < b->payload_hash) ? -1 : 1;
     }
+    if (a->idempotency_key != b->idempotency_key) {
+        return (a->idempotency_key < b->idempotency_key) ? -1 : 1;
+    }
+    if (a->origin_tick != b->origin_tick) {
+        return (a->origin_tick < b->origin_tick) ? -1 : 1;
+    }
+    if (a->message_kind != b->message_kind) {
+        return (a->message_kind < b->message_kind) ? -1 : 1;
+    }
     return 0;
 }
 
-static void dom_cross_shard_sort(dom_cross_shard_log* log)
+/* sign = 1 keeps a min-heap; sign = -1 a max-heap for in-place sorting. */
+static void dom_cross_shard_sift_down(dom_cross_shard_message* heap,
+                                      u32 count,
+                                      u32 index,
+                                      int sign)
 {
-    u32 i;
-    if (!log || !log->messages || log->message_count < 2u) {
-        return;
+    dom_cross_shard_message item = heap[index];
+    for (;;) {
+        u32 child = index * 2u + 1u;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1u < count &&
+            sign * dom_cross_shard_compare(&heap[child + 1u], &heap[child]) < 0) {
+            child += 1u;
+        }
+        if (sign * dom_cross_shard_compare(&heap[child], &item) >= 0) {
+            break;
+        }
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = item;
+}
+
+static void dom_cross_shard_heap_push(dom_cross_shard_log* log,
+                                      const dom_cross_shard_message* message)
+{
+    u32 index = log->message_count++;
+    while (index > 0u) {
+        const u32 parent = (index - 1u) / 2u;
+        if (dom_cross_shard_compare(message, &log->messages[parent]) >= 0) {
+            break;
+        }
+        log->messages[index] = log->messages[parent];
+        index = parent;
+    }
+    log->messages[index] = *message;
+}
+
+static void dom_cross_shard_heap_pop(dom_cross_shard_log* log)
+{
+    log->message_count -= 1u;
+    if (log->message_count > 0u) {
+        log->messages[0] = log->messages[log->message_count];
+        dom_cross_shard_sift_down(log->messages, log->message_count, 0u, 1);
     }
-    /* Insertion sort keeps ordering stable for identical keys. */
-    for (i = 1u; i < log->message_count; ++i) {
-        dom_cross_shard_message key = log->messages[i];
-        u32 j = i;
-        while (j > 0u && dom_cross_shard_compare(&key, &log->messages[j - 1u]) < 0) {
-            log->messages[j] = log->messages[j - 1u];
-            --j;
+}
+
+static u32 dom_cross_shard_index_home(const dom_cross_shard_log* log,
+                                      dom_shard_id dest_shard_id,
+                                      u64 idempotency_key)
+{
+    u64 h = idempotency_key ^ ((u64)dest_shard_id * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 33u;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33u;
+    return (u32)h & log->idempotency_index_mask;
+}
+
+static void dom_cross_shard_index_insert(dom_cross_shard_log* log, u32 slot)
+{
+    const dom_cross_shard_idempotency_entry* entry = &log->idempotency_entries[slot];
+    u32 pos = dom_cross_shard_index_home(log, entry->dest_shard_id, entry->idempotency_key);
+    while (log->idempotency_index[pos] != 0u) {
+        pos = (pos + 1u) & log->idempotency_index_mask;
+    }
+    log->idempotency_index[pos] = slot + 1u;
+}
+
+/* Linear probing with backward-shift deletion; no tombstones. */
+static void dom_cross_shard_index_remove(dom_cross_shard_log* log, u32 slot)
+{
+    const dom_cross_shard_idempotency_entry* entry = &log->idempotency_entries[slot];
+    const u32 mask = log->idempotency_index_mask;
+    u32 hole = dom_cross_shard_index_home(log, entry->dest_shard_id, entry->idempotency_key);
+    u32 next;
+    while (log->idempotency_index[hole] != slot + 1u) {
+        if (log->idempotency_index[hole] == 0u) {
+            return;
         }
-        log->messages[j] = key;
+        hole = (hole + 1u) & mask;
     }
+    next = hole;
+    for (;;) {
+        const dom_cross_shard_idempotency_entry* moved;
+        u32 home;
+        next = (next + 1u) & mask;
+        if (log->idempotency_index[next] == 0u) {
+            break;
+        }
+        moved = &log->idempotency_entries[log->idempotency_index[next] - 1u];
+        home = dom_cross_shard_index_home(log, moved->dest_shard_id, moved->idempotency_key);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            log->idempotency_index[hole] = log->idempotency_index[next];
+            hole = next;
+        }
+    }
+    log->idempotency_index[hole] = 0u;
 }
 
 static int dom_cross_shard_idempotency_seen(const dom_cross_shard_log* log,
@@ -96,6 +190,18 @@ static int dom_cross_shard_idempotency_seen(const dom_cross_shard_log* log,
     if (!log || !log->idempotency_entries || idempotency_key == 0u) {
         return 0;
     }
+    if (log->idempotency_index) {
+        u32 pos = dom_cross_shard_index_home(log, dest_shard_id, idempotency_key);
+        while (log->idempotency_index[pos] != 0u) {
+            const dom_cross_shard_idempotency_entry* entry =
+                &log->idempotency_entries[log->idempotency_index[pos] - 1u];
+            if (entry->dest_shard_id == dest_shard_id && entry->idempotency_key == idempotency_key) {
+                return 1;
+            }
+            pos = (pos + 1u) & log->idempotency_index_mask;
+        }
+        return 0;
+    }
     for (i = 0u; i < size; ++i) {
         const dom_cross_shard_idempotency_entry* entry = &log->idempotency_entries[i];
         if (entry->dest_shard_id == dest_shard_id && entry->idempotency_key == idempotency_key) {
@@ -117,10 +223,16 @@ static void dom_cross_shard_idempotency_record(dom_cross_shard_log* log,
     slot = (log->idempotency_count < log->idempotency_capacity)
         ? log->idempotency_count
         : (log->idempotency_count % log->idempotency_capacity);
+    if (log->idempotency_index && log->idempotency_count >= log->idempotency_capacity) {
+        dom_cross_shard_index_remove(log, slot);
+    }
     entry = &log->idempotency_entries[slot];
     entry->dest_shard_id = dest_shard_id;
     entry->idempotency_key = idempotency_key;
     log->idempotency_count += 1u;
+    if (log->idempotency_index) {
+        dom_cross_shard_index_insert(log, slot);
+    }
 }
 
 void dom_cross_shard_log_init(dom_cross_shard_log* log,
@@ -139,6 +251,10 @@ void dom_cross_shard_log_init(dom_cross_shard_log* log,
     log->idempotency_entries = idempotency_storage;
     log->idempotency_capacity = idempotency_capacity;
     log->idempotency_count = 0u;
+    log->idempotency_index = 0;
+    log->idempotency_index_mask = 0u;
+    log->hash_cache = 0u;
+    log->hash_cache_valid = 0u;
 }
 
 void dom_cross_shard_log_clear(dom_cross_shard_log* log)
@@ -149,6 +265,40 @@ void dom_cross_shard_log_clear(dom_cross_shard_log* log)
     log->message_count = 0u;
     log->message_overflow = 0u;
     log->idempotency_count = 0u;
+    log->hash_cache_valid = 0u;
+    if (log->idempotency_index) {
+        memset(log->idempotency_index,
+               0,
+               sizeof(log->idempotency_index[0]) * ((size_t)log->idempotency_index_mask + 1u));
+    }
+}
+
+int dom_cross_shard_log_attach_index(dom_cross_shard_log* log,
+                                     u32* storage,
+                                     u32 capacity)
+{
+    u32 buckets = 1u;
+    u32 size;
+    u32 i;
+    if (!log || !storage) {
+        return -1;
+    }
+    while (buckets <= capacity / 2u) {
+        buckets *= 2u;
+    }
+    if (buckets > capacity || buckets <= log->idempotency_capacity) {
+        return -2;
+    }
+    log->idempotency_index = storage;
+    log->idempotency_index_mask = buckets - 1u;
+    memset(storage, 0, sizeof(storage[0]) * (size_t)buckets);
+    size = dom_cross_shard_idempotency_size(log);
+    if (log->idempotency_entries) {
+        for (i = 0u; i < size; ++i) {
+            dom_cross_shard_index_insert(log, i);
+        }
+    }
+    return 0;
 }
 
 int dom_cross_shard_log_append(dom_cross_shard_log* log,
@@ -158,6 +308,7 @@ int dom_cross_shard_log_append(dom_cross_shard_log* log,
     if (!log || !message) {
         return -1;
     }
+    log->hash_cache_valid = 0u;
     if (!log->messages || log->message_capacity == 0u) {
         log->message_overflow += 1u;
         return -2;
@@ -170,9 +321,7 @@ int dom_cross_shard_log_append(dom_cross_shard_log* log,
     if (local.order_key == 0u) {
         local.order_key = local.message_id;
     }
-    log->messages[log->message_count] = local;
-    log->message_count += 1u;
-    dom_cross_shard_sort(log);
+    dom_cross_shard_heap_push(log, &local);
     return 0;
 }
 
@@ -181,38 +330,25 @@ int dom_cross_shard_log_pop_next_ready(dom_cross_shard_log* log,
                                        dom_cross_shard_message* out_message,
                                        u32* out_skipped_idempotent)
 {
-    u32 i;
     u32 skipped = 0u;
     if (!log || !out_message) {
         return 0;
     }
-    dom_cross_shard_sort(log);
-    for (i = 0u; i < log->message_count; ++i) {
-        dom_cross_shard_message msg = log->messages[i];
+    while (log->messages && log->message_count > 0u) {
+        dom_cross_shard_message msg = log->messages[0];
         if (msg.delivery_tick > up_to_tick) {
             break;
         }
+        log->hash_cache_valid = 0u;
+        dom_cross_shard_heap_pop(log);
         if (msg.idempotency_key != 0u &&
             dom_cross_shard_idempotency_seen(log, msg.dest_shard_id, msg.idempotency_key)) {
-            if (i + 1u < log->message_count) {
-                memmove(&log->messages[i],
-                        &log->messages[i + 1u],
-                        (size_t)(log->message_count - (i + 1u)) * sizeof(log->messages[0]));
-            }
-            log->message_count -= 1u;
             skipped += 1u;
-            i -= 1u;
             continue;
         }
         if (msg.idempotency_key != 0u) {
             dom_cross_shard_idempotency_record(log, msg.dest_shard_id, msg.idempotency_key);
         }
-        if (i + 1u < log->message_count) {
-            memmove(&log->messages[i],
-                    &log->messages[i + 1u],
-                    (size_t)(log->message_count - (i + 1u)) * sizeof(log->messages[0]));
-        }
-        log->message_count -= 1u;
         *out_message = msg;
         if (out_skipped_idempotent) {
             *out_skipped_idempotent = skipped;
@@ -225,6 +361,83 @@ int dom_cross_shard_log_pop_next_ready(dom_cross_shard_log* log,
     return 0;
 }
 
+static u64 dom_cross_shard_hash_message(u64 hash, const dom_cross_shard_message* msg)
+{
+    hash = dom_cross_shard_hash_mix(hash, msg->message_id);
+    hash = dom_cross_shard_hash_mix(hash, msg->idempotency_key);
+    hash = dom_cross_shard_hash_mix(hash, msg->origin_shard_id);
+    hash = dom_cross_shard_hash_mix(hash, msg->dest_shard_id);
+    hash = dom_cross_shard_hash_mix(hash, msg->domain_id);
+    hash = dom_cross_shard_hash_mix(hash, (u64)msg->origin_tick);
+    hash = dom_cross_shard_hash_mix(hash, (u64)msg->delivery_tick);
+    hash = dom_cross_shard_hash_mix(hash, msg->causal_key);
+    hash = dom_cross_shard_hash_mix(hash, msg->order_key);
+    hash = dom_cross_shard_hash_mix(hash, msg->message_kind);
+    hash = dom_cross_shard_hash_mix(hash, msg->sequence);
+    hash = dom_cross_shard_hash_mix(hash, msg->payload_hash);
+    return hash;
+}
+
+/* Hashes the heap in delivery order without mutating it. */
+static u64 dom_cross_shard_hash_messages(u64 hash, const dom_cross_shard_log* log)
+{
+    dom_cross_shard_message* sorted;
+    u32 count = log->message_count;
+    u32 i;
+    if (count == 0u) {
+        return hash;
+    }
+    sorted = (dom_cross_shard_message*)malloc(sizeof(sorted[0]) * (size_t)count);
+    if (sorted) {
+        memcpy(sorted, log->messages, sizeof(sorted[0]) * (size_t)count);
+        for (i = count / 2u; i > 0u; --i) {
+            dom_cross_shard_sift_down(sorted, count, i - 1u, -1);
+        }
+        for (i = count - 1u; i > 0u; --i) {
+            dom_cross_shard_message top = sorted[0];
+            sorted[0] = sorted[i];
+            sorted[i] = top;
+            dom_cross_shard_sift_down(sorted, i, 0u, -1);
+        }
+        for (i = 0u; i < count; ++i) {
+            hash = dom_cross_shard_hash_message(hash, &sorted[i]);
+        }
+        free(sorted);
+        return hash;
+    }
+    {
+        /* No scratch memory: select each next-smallest run in place. */
+        const dom_cross_shard_message* prev = 0;
+        u32 emitted = 0u;
+        while (emitted < count) {
+            const dom_cross_shard_message* best = 0;
+            u32 copies = 0u;
+            for (i = 0u; i < count; ++i) {
+                const dom_cross_shard_message* msg = &log->messages[i];
+                int order;
+                if (prev && dom_cross_shard_compare(msg, prev) <= 0) {
+                    continue;
+                }
+                order = best ? dom_cross_shard_compare(msg, best) : -1;
+                if (order < 0) {
+                    best = msg;
+                    copies = 1u;
+                } else if (order == 0) {
+                    copies += 1u;
+                }
+            }
+            for (i = 0u; i < copies; ++i) {
+                hash = dom_cross_shard_hash_message(hash, best);
+            }
+            emitted += copies;
+            prev = best;
+        }
+    }
+    return hash;
+}
+
+/* Called with every runtime hash; the sorted walk only reruns after the log
+ * changed. The cache is not part of the logical state, hence the cast. */
 u64 dom_cross_shard_log_hash(const dom_cross_shard_log* log)
 {
     u64 hash = 1469598103934665603ULL;
@@ -233,27 +446,16 @@ u64 dom_cross_shard_log_hash(const dom_cross_shard_log* log)
     if (!log) {
         return hash;
     }
+    if (log->hash_cache_valid) {
+        return log->hash_cache;
+    }
     hash = dom_cross_shard_hash_mix(hash, log->message_count);
     hash = dom_cross_shard_hash_mix(hash, log->message_capacity);
     hash = dom_cross_shard_hash_mix(hash, log->message_overflow);
     hash = dom_cross_shard_hash_mix(hash, log->idempotency_count);
     hash = dom_cross_shard_hash_mix(hash, log->idempotency_capacity);
     if (log->messages) {
-        for (i = 0u; i < log->message_count; ++i) {
-            const dom_cross_shard_message* msg = &log->messages[i];
-            hash = dom_cross_shard_hash_mix(hash, msg->message_id);
-            hash = dom_cross_shard_hash_mix(hash, msg->idempotency_key);
-            hash = dom_cross_shard_hash_mix(hash, msg->origin_shard_id);
-            hash = dom_cross_shard_hash_mix(hash, msg->dest_shard_id);
-            hash = dom_cross_shard_hash_mix(hash, msg->domain_id);
-            hash = dom_cross_shard_hash_mix(hash, (u64)msg->origin_tick);
-            hash = dom_cross_shard_hash_mix(hash, (u64)msg->delivery_tick);
-            hash = dom_cross_shard_hash_mix(hash, msg->causal_key);
-            hash = dom_cross_shard_hash_mix(hash, msg->order_key);
-            hash = dom_cross_shard_hash_mix(hash, msg->message_kind);
-            hash = dom_cross_shard_hash_mix(hash, msg->sequence);
-            hash = dom_cross_shard_hash_mix(hash, msg->payload_hash);
-        }
+        hash = dom_cross_shard_hash_messages(hash, log);
     }
     if (log->idempotency_entries) {
         for (i = 0u; i < id_size; ++i) {
@@ -262,6 +464,8 @@ u64 dom_cross_shard_log_hash(const dom_cross_shard_log* log)
             hash = dom_cross_shard_hash_mix(hash, entry->idempotency_key);
         }
     }
+    ((dom_cross_shard_log*)log)->hash_cache = hash;
+    ((dom_cross_shard_log*)log)->hash_cache_valid = 1u;
     return hash;
 }
 
@@ -38,6 +38,13 @@ typedef struct dom_cross_shard_idempotency_entry {
     u64 idempotency_key;
 } dom_cross_shard_idempotency_entry;
 
+/*
+messages[0..message_count) is a binary min-heap in delivery order, so
+messages[0] is always the next message to deliver. idempotency_entries is a
+ring; the optional index maps (dest, key) to its ring slot. The log hash is
+cached until the next append, pop or clear; code that writes the arrays
+directly must re-init the log first (checkpoint recovery does).
+*/
 typedef struct dom_cross_shard_log {
     dom_cross_shard_message* messages;
     u32 message_count;
@@ -47,6 +54,12 @@ typedef struct dom_cross_shard_log {
     dom_cross_shard_idempotency_entry* idempotency_entries;
     u32 idempotency_count;
     u32 idempotency_capacity;
+
+    u32* idempotency_index; /* ring slot + 1 per bucket, 0 = empty */
+    u32 idempotency_index_mask;
+
+    u64 hash_cache;
+    u32 hash_cache_valid;
 } dom_cross_shard_log;
 
 void dom_cross_shard_log_init(dom_cross_shard_log* log,
@@ -55,6 +68,12 @@ void dom_cross_shard_log_init(dom_cross_shard_log* log,
                               dom_cross_shard_idempotency_entry* idempotency_storage,
                               u32 idempotency_capacity);
 void dom_cross_shard_log_clear(dom_cross_shard_log* log);
+/* Attaches hashed idempotency lookup and indexes the current ring contents.
+   Uses the largest power of two <= capacity, which must exceed the ring
+   capacity; without an index lookups scan the ring. */
+int dom_cross_shard_log_attach_index(dom_cross_shard_log* log,
+                                     u32* storage,
+                                     u32 capacity);
 
 int dom_cross_shard_log_append(dom_cross_shard_log* log,
                                const dom_cross_shard_message* message);
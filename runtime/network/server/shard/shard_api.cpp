@@ -145,6 +145,7 @@ void dom_shard_message_queue_init(dom_shard_message_queue* queue,
     queue->messages = storage;
     queue->count = 0u;
     queue->capacity = capacity;
+    queue->next_order = 0u;
     if (storage && capacity > 0u) {
         memset(storage, 0, sizeof(dom_shard_message) * (size_t)capacity);
     }
@@ -153,43 +154,86 @@ void dom_shard_message_queue_init(dom_shard_message_queue* queue,
 static int dom_shard_message_before(const dom_shard_message* a,
                                     const dom_shard_message* b)
 {
-    if (a->arrival_tick < b->arrival_tick) {
-        return 1;
+    if (a->arrival_tick != b->arrival_tick) {
+        return (a->arrival_tick < b->arrival_tick) ? 1 : 0;
+    }
+    if (a->message_id != b->message_id) {
+        return (a->message_id < b->message_id) ? 1 : 0;
     }
-    if (a->arrival_tick > b->arrival_tick) {
-        return 0;
+    return (a->queue_order < b->queue_order) ? 1 : 0;
+}
+
+/* max_heap inverts the order so the same sift serves the in-place sort. */
+static void dom_shard_message_sift_down(dom_shard_message* heap,
+                                        u32 count,
+                                        u32 index,
+                                        int max_heap)
+{
+    dom_shard_message item = heap[index];
+    for (;;) {
+        u32 child = index * 2u + 1u;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1u < count) {
+            const int right_first = max_heap
+                ? dom_shard_message_before(&heap[child], &heap[child + 1u])
+                : dom_shard_message_before(&heap[child + 1u], &heap[child]);
+            if (right_first) {
+                child += 1u;
+            }
+        }
+        if (max_heap ? !dom_shard_message_before(&item, &heap[child])
+                     : !dom_shard_message_before(&heap[child], &item)) {
+            break;
+        }
+        heap[index] = heap[child];
+        index = child;
     }
-    return (a->message_id < b->message_id) ? 1 : 0;
+    heap[index] = item;
 }
 
 void dom_shard_message_queue_sort(dom_shard_message_queue* queue)
 {
     u32 i;
+    u32 end;
     if (!queue || !queue->messages || queue->count < 2u) {
         return;
     }
-    for (i = 1u; i < queue->count; ++i) {
-        dom_shard_message key = queue->messages[i];
-        u32 j = i;
-        while (j > 0u && dom_shard_message_before(&key, &queue->messages[j - 1u])) {
-            queue->messages[j] = queue->messages[j - 1u];
-            j -= 1u;
-        }
-        queue->messages[j] = key;
+    for (i = queue->count / 2u; i > 0u; --i) {
+        dom_shard_message_sift_down(queue->messages, queue->count, i - 1u, 1);
+    }
+    for (end = queue->count - 1u; end > 0u; --end) {
+        dom_shard_message top = queue->messages[0];
+        queue->messages[0] = queue->messages[end];
+        queue->messages[end] = top;
+        dom_shard_message_sift_down(queue->messages, end, 0u, 1);
     }
 }
 
 int dom_shard_message_queue_push(dom_shard_message_queue* queue,
                                  const dom_shard_message* message)
 {
+    dom_shard_message item;
+    u32 index;
     if (!queue || !message || !queue->messages) {
         return -1;
     }
     if (queue->count >= queue->capacity) {
         return -2;
     }
-    queue->messages[queue->count++] = *message;
-    dom_shard_message_queue_sort(queue);
+    item = *message;
+    item.queue_order = queue->next_order++;
+    index = queue->count++;
+    while (index > 0u) {
+        const u32 parent = (index - 1u) / 2u;
+        if (!dom_shard_message_before(&item, &queue->messages[parent])) {
+            break;
+        }
+        queue->messages[index] = queue->messages[parent];
+        index = parent;
+    }
+    queue->messages[index] = item;
     return 0;
 }
 
@@ -197,7 +241,6 @@ int dom_shard_message_queue_pop_ready(dom_shard_message_queue* queue,
                                       dom_act_time_t now,
                                       dom_shard_message* out_message)
 {
-    u32 i;
     if (!queue || !queue->messages || queue->count == 0u) {
         return -1;
     }
@@ -207,10 +250,11 @@ int dom_shard_message_queue_pop_ready(dom_shard_message_queue* queue,
     if (out_message) {
         *out_message = queue->messages[0];
     }
-    for (i = 1u; i < queue->count; ++i) {
-        queue->messages[i - 1u] = queue->messages[i];
-    }
     queue->count -= 1u;
+    if (queue->count > 0u) {
+        queue->messages[0] = queue->messages[queue->count];
+        dom_shard_message_sift_down(queue->messages, queue->count, 0u, 0);
+    }
     return 0;
 }
 
@@ -83,12 +83,15 @@ typedef struct dom_shard_message {
     dom_act_time_t arrival_tick;
     const u8* payload;
     u32 payload_size;
+    u64 queue_order; /* stamped on push; equal keys pop in push order */
 } dom_shard_message;
 
+/* Binary min-heap on (arrival_tick, message_id, queue_order). */
 typedef struct dom_shard_message_queue {
     dom_shard_message* messages;
     u32 count;
     u32 capacity;
+    u64 next_order;
 } dom_shard_message_queue;
 
 void dom_shard_message_queue_init(dom_shard_message_queue* queue,
@@ -96,6 +99,7 @@ void dom_shard_message_queue_init(dom_shard_message_queue* queue,
                                   u32 capacity);
 int dom_shard_message_queue_push(dom_shard_message_queue* queue,
                                  const dom_shard_message* message);
+/* Fully sorts the storage; a sorted array is still a valid heap. */
 void dom_shard_message_queue_sort(dom_shard_message_queue* queue);
 int dom_shard_message_queue_pop_ready(dom_shard_message_queue* queue,
                                       dom_act_time_t now,
@@ -8,33 +8,125 @@ RESPONSIBILITY: Executes shard-local TaskGraphs with deterministic admission.
 
 #include "domino/execution/access_set.h"
 
+#include <algorithm>
 #include <string.h>
 
 static int dom_shard_executor_record_accept(dom_shard_executor* executor, u64 task_id);
 
+typedef struct dom_shard_task_slot {
+    u64 task_id;
+    u32 index;
+} dom_shard_task_slot;
+
+static bool dom_shard_task_slot_less(const dom_shard_task_slot& a, const dom_shard_task_slot& b)
+{
+    if (a.task_id != b.task_id) {
+        return a.task_id < b.task_id;
+    }
+    return a.index < b.index;
+}
+
+/* Runs under EXEC3: on_task only marks the task's own slot, and the log is
+ * written from on_commit in commit_key order, identically for every
+ * committing scheduler. Schedulers that never commit get the marked tasks
+ * logged in graph order by finish(). */
 class dom_shard_schedule_sink : public IScheduleSink {
 public:
-    dom_shard_schedule_sink(dom_shard_executor* executor)
-        : executor_(executor) {}
+    dom_shard_schedule_sink(dom_shard_executor* executor, const dom_task_graph* graph)
+        : executor_(executor), graph_(graph), slots_(0), executed_(0), committed_(0u)
+    {
+        u32 i;
+        if (!graph_ || graph_->task_count == 0u) {
+            return;
+        }
+        slots_ = new dom_shard_task_slot[graph_->task_count];
+        executed_ = new unsigned char[graph_->task_count];
+        for (i = 0u; i < graph_->task_count; ++i) {
+            slots_[i].task_id = graph_->tasks[i].task_id;
+            slots_[i].index = i;
+            executed_[i] = 0u;
+        }
+        std::sort(slots_, slots_ + graph_->task_count, dom_shard_task_slot_less);
+    }
+
+    virtual ~dom_shard_schedule_sink()
+    {
+        delete[] slots_;
+        delete[] executed_;
+    }
 
     virtual void on_task(const dom_task_node &node,
                          const dom_law_decision &decision)
     {
-        if (!executor_ || !executor_->log) {
+        u32 index;
+        if (decision.kind != DOM_LAW_REFUSE && find(node.task_id, &index)) {
+            executed_[index] = 1u;
+        }
+    }
+
+    virtual void on_commit(const dom_task_node &node)
+    {
+        u32 index;
+        if (find(node.task_id, &index) && executed_[index]) {
+            committed_ += 1u;
+            record(node.task_id);
+        }
+    }
+
+    virtual d_bool allows_concurrent_tasks() const
+    {
+        return D_TRUE;
+    }
+
+    void finish()
+    {
+        u32 i;
+        if (committed_ > 0u || !graph_) {
             return;
         }
-        if (decision.kind != DOM_LAW_REFUSE) {
-            dom_shard_event_entry entry;
-            entry.event_id = executor_->next_event_id++;
-            entry.task_id = node.task_id;
-            entry.tick = executor_->ctx ? executor_->ctx->act_now : 0u;
-            dom_shard_log_record_event(executor_->log, &entry);
-            dom_shard_executor_record_accept(executor_, node.task_id);
+        for (i = 0u; i < graph_->task_count; ++i) {
+            if (executed_[i]) {
+                record(graph_->tasks[i].task_id);
+            }
         }
     }
 
 private:
+    bool find(u64 task_id, u32* out_index) const
+    {
+        dom_shard_task_slot key;
+        const dom_shard_task_slot* it;
+        if (!slots_) {
+            return false;
+        }
+        key.task_id = task_id;
+        key.index = 0u;
+        it = std::lower_bound(slots_, slots_ + graph_->task_count, key, dom_shard_task_slot_less);
+        if (it == slots_ + graph_->task_count || it->task_id != task_id) {
+            return false;
+        }
+        *out_index = it->index;
+        return true;
+    }
+
+    void record(u64 task_id)
+    {
+        dom_shard_event_entry entry;
+        if (!executor_ || !executor_->log) {
+            return;
+        }
+        entry.event_id = executor_->next_event_id++;
+        entry.task_id = task_id;
+        entry.tick = executor_->ctx ? executor_->ctx->act_now : 0u;
+        dom_shard_log_record_event(executor_->log, &entry);
+        dom_shard_executor_record_accept(executor_, task_id);
+    }
+
     dom_shard_executor* executor_;
+    const dom_task_graph* graph_;
+    dom_shard_task_slot* slots_;
+    unsigned char* executed_;
+    u32 committed_;
 };
 
 static int dom_shard_executor_record_accept(dom_shard_executor* executor, u64 task_id)
@@ -90,33 +182,21 @@ static u64 dom_shard_owner_id_from_access(const dom_execution_context* ctx,
 
 static void dom_shard_sort_u64(u64* values, u32 count)
 {
-    u32 i;
     if (!values || count < 2u) {
         return;
     }
-    for (i = 1u; i < count; ++i) {
-        u64 key = values[i];
-        u32 j = i;
-        while (j > 0u && values[j - 1u] > key) {
-            values[j] = values[j - 1u];
-            j -= 1u;
-        }
-        values[j] = key;
-    }
+    std::sort(values, values + count);
 }
 
+/* accepted_tasks is sorted once schedule() returns. */
 static int dom_shard_has_task(const dom_shard_executor* executor, u64 task_id)
 {
-    u32 i;
     if (!executor || !executor->accepted_tasks) {
         return 0;
     }
-    for (i = 0u; i < executor->accepted_count; ++i) {
-        if (executor->accepted_tasks[i] == task_id) {
-            return 1;
-        }
-    }
-    return 0;
+    return std::binary_search(executor->accepted_tasks,
+                              executor->accepted_tasks + executor->accepted_count,
+                              task_id) ? 1 : 0;
 }
 
 void dom_shard_executor_init(dom_shard_executor* executor,
@@ -152,7 +232,6 @@ int dom_shard_executor_execute(dom_shard_executor* executor,
                                u32 outbound_count)
 {
     u32 i;
-    dom_shard_schedule_sink sink(executor);
     if (!executor || !graph || !registry) {
         return -1;
     }
@@ -174,7 +253,11 @@ int dom_shard_executor_execute(dom_shard_executor* executor,
         }
     }
 
-    executor->scheduler->schedule(*graph, *executor->ctx, sink);
+    {
+        dom_shard_schedule_sink sink(executor, graph);
+        executor->scheduler->schedule(*graph, *executor->ctx, sink);
+        sink.finish();
+    }
     if (executor->accepted_tasks && executor->accepted_count > 1u) {
         dom_shard_sort_u64(executor->accepted_tasks, executor->accepted_count);
     }
@@ -11,7 +11,9 @@ DETERMINISM: See `docs/reference/specs/SPEC_DETERMINISM.md` for deterministic su
 VERSIONING / ABI / DATA FORMAT NOTES: N/A (implementation file).
 EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/SPEC_*.md` without cross-layer coupling.
 */
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "d_content.h"
@@ -19,6 +21,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 #include "d_registry.h"
 #include "d_tlv_schema.h"
+#include "domino/io/container.h"
 
 /* Registry capacities */
 #define D_CONTENT_MAX_MATERIALS       4096u
@@ -40,68 +43,100 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #define D_CONTENT_MAX_PROCESS_RESEARCH_YIELDS 16384u
 #define D_CONTENT_MAX_JOB_RESEARCH_YIELDS     16384u
 
+/* Id and name lookups use open addressing at twice the registry capacity
+ * (all capacities above are powers of two). */
+#define D_CONTENT_SLOTS(cap) ((cap) * 2u)
+
 static const char *D_CONTENT_EMPTY_STRING = "";
 
 /* Registries and storage */
 static d_registry g_material_registry;
 static d_registry_entry g_material_entries[D_CONTENT_MAX_MATERIALS];
 static d_proto_material g_material_storage[D_CONTENT_MAX_MATERIALS];
+static u32 g_material_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_MATERIALS)];
+static u32 g_material_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_MATERIALS)];
 
 static d_registry g_item_registry;
 static d_registry_entry g_item_entries[D_CONTENT_MAX_ITEMS];
 static d_proto_item g_item_storage[D_CONTENT_MAX_ITEMS];
+static u32 g_item_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_ITEMS)];
+static u32 g_item_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_ITEMS)];
 
 static d_registry g_container_registry;
 static d_registry_entry g_container_entries[D_CONTENT_MAX_CONTAINERS];
 static d_proto_container g_container_storage[D_CONTENT_MAX_CONTAINERS];
+static u32 g_container_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_CONTAINERS)];
+static u32 g_container_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_CONTAINERS)];
 
 static d_registry g_process_registry;
 static d_registry_entry g_process_entries[D_CONTENT_MAX_PROCESSES];
 static d_proto_process g_process_storage[D_CONTENT_MAX_PROCESSES];
+static u32 g_process_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_PROCESSES)];
+static u32 g_process_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_PROCESSES)];
 static d_process_io_term g_process_io_terms[D_CONTENT_MAX_PROCESS_IO_TERMS];
 static u32 g_process_io_term_count = 0u;
 
 static d_registry g_deposit_registry;
 static d_registry_entry g_deposit_entries[D_CONTENT_MAX_DEPOSITS];
 static d_proto_deposit g_deposit_storage[D_CONTENT_MAX_DEPOSITS];
+static u32 g_deposit_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_DEPOSITS)];
+static u32 g_deposit_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_DEPOSITS)];
 
 static d_registry g_structure_registry;
 static d_registry_entry g_structure_entries[D_CONTENT_MAX_STRUCTURES];
 static d_proto_structure g_structure_storage[D_CONTENT_MAX_STRUCTURES];
+static u32 g_structure_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_STRUCTURES)];
+static u32 g_structure_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_STRUCTURES)];
 
 static d_registry g_vehicle_registry;
 static d_registry_entry g_vehicle_entries[D_CONTENT_MAX_VEHICLES];
 static d_proto_vehicle g_vehicle_storage[D_CONTENT_MAX_VEHICLES];
+static u32 g_vehicle_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_VEHICLES)];
+static u32 g_vehicle_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_VEHICLES)];
 
 static d_registry g_spline_profile_registry;
 static d_registry_entry g_spline_profile_entries[D_CONTENT_MAX_SPLINE_PROFILES];
 static d_proto_spline_profile g_spline_profile_storage[D_CONTENT_MAX_SPLINE_PROFILES];
+static u32 g_spline_profile_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_SPLINE_PROFILES)];
+static u32 g_spline_profile_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_SPLINE_PROFILES)];
 
 static d_registry g_job_template_registry;
 static d_registry_entry g_job_template_entries[D_CONTENT_MAX_JOB_TEMPLATES];
 static d_proto_job_template g_job_template_storage[D_CONTENT_MAX_JOB_TEMPLATES];
+static u32 g_job_template_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_JOB_TEMPLATES)];
+static u32 g_job_template_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_JOB_TEMPLATES)];
 
 static d_registry g_building_registry;
 static d_registry_entry g_building_entries[D_CONTENT_MAX_BUILDINGS];
 static d_proto_building g_building_storage[D_CONTENT_MAX_BUILDINGS];
+static u32 g_building_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_BUILDINGS)];
+static u32 g_building_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_BUILDINGS)];
 
 static d_registry g_blueprint_registry;
 static d_registry_entry g_blueprint_entries[D_CONTENT_MAX_BLUEPRINTS];
 static d_proto_blueprint g_blueprint_storage[D_CONTENT_MAX_BLUEPRINTS];
+static u32 g_blueprint_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_BLUEPRINTS)];
+static u32 g_blueprint_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_BLUEPRINTS)];
 
 static d_registry g_research_registry;
 static d_registry_entry g_research_entries[D_CONTENT_MAX_RESEARCH];
 static d_proto_research g_research_storage[D_CONTENT_MAX_RESEARCH];
+static u32 g_research_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_RESEARCH)];
+static u32 g_research_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_RESEARCH)];
 static d_research_id g_research_prereqs[D_CONTENT_MAX_RESEARCH_PREREQS];
 static u32 g_research_prereq_count = 0u;
 
 static d_registry g_research_point_source_registry;
 static d_registry_entry g_research_point_source_entries[D_CONTENT_MAX_RESEARCH_POINT_SOURCES];
 static d_proto_research_point_source g_research_point_source_storage[D_CONTENT_MAX_RESEARCH_POINT_SOURCES];
+static u32 g_research_point_source_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_RESEARCH_POINT_SOURCES)];
+static u32 g_research_point_source_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_RESEARCH_POINT_SOURCES)];
 
 static d_registry g_policy_rule_registry;
 static d_registry_entry g_policy_rule_entries[D_CONTENT_MAX_POLICY_RULES];
 static d_proto_policy_rule g_policy_rule_storage[D_CONTENT_MAX_POLICY_RULES];
+static u32 g_policy_rule_id_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_POLICY_RULES)];
+static u32 g_policy_rule_name_slots[D_CONTENT_SLOTS(D_CONTENT_MAX_POLICY_RULES)];
 
 static d_research_point_yield g_process_research_yields[D_CONTENT_MAX_PROCESS_RESEARCH_YIELDS];
 static u32 g_process_research_yield_count = 0u;
@@ -109,6 +144,177 @@ static u32 g_process_research_yield_count = 0u;
 static d_research_point_yield g_job_research_yields[D_CONTENT_MAX_JOB_RESEARCH_YIELDS];
 static u32 g_job_research_yield_count = 0u;
 
+/* Every proto starts with its id and name; lookups read them through this. */
+typedef struct d_content_proto_head {
+    u32         id;
+    const char *name;
+} d_content_proto_head;
+
+/* Pointer members that the binary cache stores as references. */
+enum {
+    D_CONTENT_FIELD_STRING = 1, /* const char *, NUL-terminated */
+    D_CONTENT_FIELD_BLOB   = 2, /* d_tlv_blob */
+    D_CONTENT_FIELD_ARRAY  = 3  /* pointer into a side pool, u16 count member */
+};
+
+typedef struct d_content_field {
+    u32 kind;         /* D_CONTENT_FIELD_* */
+    u32 offset;       /* member offset in the proto */
+    u32 count_offset; /* ARRAY: offset of the u16 element count */
+    u32 pool;         /* ARRAY: D_CONTENT_POOL_* */
+} d_content_field;
+
+/* Side arrays referenced by protos. */
+enum {
+    D_CONTENT_POOL_PROCESS_IO = 0,
+    D_CONTENT_POOL_PROCESS_YIELDS,
+    D_CONTENT_POOL_JOB_YIELDS,
+    D_CONTENT_POOL_RESEARCH_PREREQS,
+    D_CONTENT_POOL_COUNT
+};
+
+typedef struct d_content_pool {
+    void *base;
+    u32   stride;
+    u32   capacity;
+    u32  *count;
+} d_content_pool;
+
+static const d_content_pool g_content_pools[D_CONTENT_POOL_COUNT] = {
+    { g_process_io_terms, sizeof(d_process_io_term), D_CONTENT_MAX_PROCESS_IO_TERMS, &g_process_io_term_count },
+    { g_process_research_yields, sizeof(d_research_point_yield), D_CONTENT_MAX_PROCESS_RESEARCH_YIELDS, &g_process_research_yield_count },
+    { g_job_research_yields, sizeof(d_research_point_yield), D_CONTENT_MAX_JOB_RESEARCH_YIELDS, &g_job_research_yield_count },
+    { g_research_prereqs, sizeof(d_research_id), D_CONTENT_MAX_RESEARCH_PREREQS, &g_research_prereq_count }
+};
+
+#define D_CONTENT_STRING(T, m)   { D_CONTENT_FIELD_STRING, offsetof(T, m), 0u, 0u }
+#define D_CONTENT_BLOB(T, m)     { D_CONTENT_FIELD_BLOB, offsetof(T, m), 0u, 0u }
+#define D_CONTENT_ARRAY(T, m, c, p) { D_CONTENT_FIELD_ARRAY, offsetof(T, m), offsetof(T, c), p }
+
+static const d_content_field g_material_fields[] = {
+    D_CONTENT_STRING(d_proto_material, name)
+};
+static const d_content_field g_item_fields[] = {
+    D_CONTENT_STRING(d_proto_item, name)
+};
+static const d_content_field g_container_fields[] = {
+    D_CONTENT_STRING(d_proto_container, name),
+    D_CONTENT_BLOB(d_proto_container, params)
+};
+static const d_content_field g_process_fields[] = {
+    D_CONTENT_STRING(d_proto_process, name),
+    D_CONTENT_ARRAY(d_proto_process, io_terms, io_count, D_CONTENT_POOL_PROCESS_IO),
+    D_CONTENT_ARRAY(d_proto_process, research_yields, research_yield_count, D_CONTENT_POOL_PROCESS_YIELDS),
+    D_CONTENT_BLOB(d_proto_process, params)
+};
+static const d_content_field g_deposit_fields[] = {
+    D_CONTENT_STRING(d_proto_deposit, name),
+    D_CONTENT_BLOB(d_proto_deposit, model_params)
+};
+static const d_content_field g_structure_fields[] = {
+    D_CONTENT_STRING(d_proto_structure, name),
+    D_CONTENT_BLOB(d_proto_structure, layout),
+    D_CONTENT_BLOB(d_proto_structure, io),
+    D_CONTENT_BLOB(d_proto_structure, processes)
+};
+static const d_content_field g_vehicle_fields[] = {
+    D_CONTENT_STRING(d_proto_vehicle, name),
+    D_CONTENT_BLOB(d_proto_vehicle, params)
+};
+static const d_content_field g_spline_profile_fields[] = {
+    D_CONTENT_STRING(d_proto_spline_profile, name),
+    D_CONTENT_BLOB(d_proto_spline_profile, params)
+};
+static const d_content_field g_job_template_fields[] = {
+    D_CONTENT_STRING(d_proto_job_template, name),
+    D_CONTENT_BLOB(d_proto_job_template, requirements),
+    D_CONTENT_BLOB(d_proto_job_template, rewards),
+    D_CONTENT_ARRAY(d_proto_job_template, research_yields, research_yield_count, D_CONTENT_POOL_JOB_YIELDS)
+};
+static const d_content_field g_building_fields[] = {
+    D_CONTENT_STRING(d_proto_building, name),
+    D_CONTENT_BLOB(d_proto_building, shell),
+    D_CONTENT_BLOB(d_proto_building, params)
+};
+static const d_content_field g_blueprint_fields[] = {
+    D_CONTENT_STRING(d_proto_blueprint, name),
+    D_CONTENT_BLOB(d_proto_blueprint, contents)
+};
+static const d_content_field g_research_fields[] = {
+    D_CONTENT_STRING(d_proto_research, name),
+    D_CONTENT_ARRAY(d_proto_research, prereq_ids, prereq_count, D_CONTENT_POOL_RESEARCH_PREREQS),
+    D_CONTENT_BLOB(d_proto_research, unlocks),
+    D_CONTENT_BLOB(d_proto_research, cost),
+    D_CONTENT_BLOB(d_proto_research, params)
+};
+static const d_content_field g_research_point_source_fields[] = {
+    D_CONTENT_STRING(d_proto_research_point_source, name),
+    D_CONTENT_BLOB(d_proto_research_point_source, params)
+};
+static const d_content_field g_policy_rule_fields[] = {
+    D_CONTENT_STRING(d_proto_policy_rule, name),
+    D_CONTENT_BLOB(d_proto_policy_rule, scope),
+    D_CONTENT_BLOB(d_proto_policy_rule, effect),
+    D_CONTENT_BLOB(d_proto_policy_rule, conditions)
+};
+
+/* One row per registry, in cache order. */
+enum {
+    D_CONTENT_KIND_MATERIAL = 0,
+    D_CONTENT_KIND_ITEM,
+    D_CONTENT_KIND_CONTAINER,
+    D_CONTENT_KIND_PROCESS,
+    D_CONTENT_KIND_DEPOSIT,
+    D_CONTENT_KIND_STRUCTURE,
+    D_CONTENT_KIND_VEHICLE,
+    D_CONTENT_KIND_SPLINE_PROFILE,
+    D_CONTENT_KIND_JOB_TEMPLATE,
+    D_CONTENT_KIND_BUILDING,
+    D_CONTENT_KIND_BLUEPRINT,
+    D_CONTENT_KIND_RESEARCH,
+    D_CONTENT_KIND_RESEARCH_POINT_SOURCE,
+    D_CONTENT_KIND_POLICY_RULE,
+    D_CONTENT_KIND_COUNT
+};
+
+typedef struct d_content_kind {
+    d_registry            *reg;
+    d_registry_entry      *entries;
+    void                  *storage;
+    u32                    stride;
+    u32                    capacity;
+    u32                   *id_slots;
+    u32                   *name_slots;
+    const d_content_field *fields;
+    u32                    field_count;
+} d_content_kind;
+
+#define D_CONTENT_KIND(k, T, cap) \
+    { &g_##k##_registry, g_##k##_entries, g_##k##_storage, sizeof(T), cap, \
+      g_##k##_id_slots, g_##k##_name_slots, g_##k##_fields, \
+      (u32)(sizeof(g_##k##_fields) / sizeof(g_##k##_fields[0])) }
+
+static const d_content_kind g_content_kinds[D_CONTENT_KIND_COUNT] = {
+    D_CONTENT_KIND(material, d_proto_material, D_CONTENT_MAX_MATERIALS),
+    D_CONTENT_KIND(item, d_proto_item, D_CONTENT_MAX_ITEMS),
+    D_CONTENT_KIND(container, d_proto_container, D_CONTENT_MAX_CONTAINERS),
+    D_CONTENT_KIND(process, d_proto_process, D_CONTENT_MAX_PROCESSES),
+    D_CONTENT_KIND(deposit, d_proto_deposit, D_CONTENT_MAX_DEPOSITS),
+    D_CONTENT_KIND(structure, d_proto_structure, D_CONTENT_MAX_STRUCTURES),
+    D_CONTENT_KIND(vehicle, d_proto_vehicle, D_CONTENT_MAX_VEHICLES),
+    D_CONTENT_KIND(spline_profile, d_proto_spline_profile, D_CONTENT_MAX_SPLINE_PROFILES),
+    D_CONTENT_KIND(job_template, d_proto_job_template, D_CONTENT_MAX_JOB_TEMPLATES),
+    D_CONTENT_KIND(building, d_proto_building, D_CONTENT_MAX_BUILDINGS),
+    D_CONTENT_KIND(blueprint, d_proto_blueprint, D_CONTENT_MAX_BLUEPRINTS),
+    D_CONTENT_KIND(research, d_proto_research, D_CONTENT_MAX_RESEARCH),
+    D_CONTENT_KIND(research_point_source, d_proto_research_point_source, D_CONTENT_MAX_RESEARCH_POINT_SOURCES),
+    D_CONTENT_KIND(policy_rule, d_proto_policy_rule, D_CONTENT_MAX_POLICY_RULES)
+};
+
+/* Adopted cache; names and blobs of adopted protos point into its mapping. */
+static dtlv_reader g_content_cache;
+static int g_content_cache_open = 0;
+
 /* Forward declarations */
 static int d_content_load_content_blob(const d_tlv_blob *blob);
 static int d_content_register_material(const d_proto_material *src);
@@ -184,6 +390,7 @@ static void d_content_clear_storage(void)
 
 static void d_content_init_registries(void)
 {
+    u32 k;
     d_registry_init(&g_material_registry,  g_material_entries,  D_CONTENT_MAX_MATERIALS,  1u);
     d_registry_init(&g_item_registry,      g_item_entries,      D_CONTENT_MAX_ITEMS,      1u);
     d_registry_init(&g_container_registry, g_container_entries, D_CONTENT_MAX_CONTAINERS, 1u);
@@ -198,16 +405,32 @@ static void d_content_init_registries(void)
     d_registry_init(&g_research_registry,  g_research_entries,  D_CONTENT_MAX_RESEARCH,   1u);
     d_registry_init(&g_research_point_source_registry, g_research_point_source_entries, D_CONTENT_MAX_RESEARCH_POINT_SOURCES, 1u);
     d_registry_init(&g_policy_rule_registry, g_policy_rule_entries, D_CONTENT_MAX_POLICY_RULES, 1u);
+
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        const d_content_kind *kind = &g_content_kinds[k];
+        (void)d_registry_attach_index(kind->reg, kind->id_slots, D_CONTENT_SLOTS(kind->capacity));
+        memset(kind->name_slots, 0, sizeof(u32) * D_CONTENT_SLOTS(kind->capacity));
+    }
+}
+
+static void d_content_release_cache(void)
+{
+    if (g_content_cache_open) {
+        dtlv_reader_dispose(&g_content_cache);
+        g_content_cache_open = 0;
+    }
 }
 
 void d_content_init(void)
 {
+    d_content_release_cache();
     d_content_clear_storage();
     d_content_init_registries();
 }
 
 void d_content_shutdown(void)
 {
+    d_content_release_cache();
     d_content_clear_storage();
     d_content_init_registries();
 }
@@ -230,6 +453,60 @@ static const char *d_content_safe_name(const char *name)
     return name;
 }
 
+static u32 d_content_hash_name(const char *name)
+{
+    u32 h = 2166136261u;
+    while (*name) {
+        h ^= (u32)(unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static const char *d_content_proto_name(const void *proto)
+{
+    return ((const d_content_proto_head *)proto)->name;
+}
+
+/* Index the name of registry entry `index`; the first entry with a name wins. */
+static void d_content_index_name(u32 kind_id, u32 index)
+{
+    const d_content_kind *kind = &g_content_kinds[kind_id];
+    const char *name = d_content_proto_name(kind->entries[index].ptr);
+    u32 mask = D_CONTENT_SLOTS(kind->capacity) - 1u;
+    u32 s;
+    if (!name || !name[0]) {
+        return;
+    }
+    s = d_content_hash_name(name) & mask;
+    while (kind->name_slots[s] != 0u) {
+        if (strcmp(d_content_proto_name(kind->entries[kind->name_slots[s] - 1u].ptr), name) == 0) {
+            return;
+        }
+        s = (s + 1u) & mask;
+    }
+    kind->name_slots[s] = index + 1u;
+}
+
+static const void *d_content_find_name(u32 kind_id, const char *name)
+{
+    const d_content_kind *kind = &g_content_kinds[kind_id];
+    u32 mask = D_CONTENT_SLOTS(kind->capacity) - 1u;
+    u32 s;
+    if (!name || !name[0]) {
+        return (const void *)0;
+    }
+    s = d_content_hash_name(name) & mask;
+    while (kind->name_slots[s] != 0u) {
+        const void *proto = kind->entries[kind->name_slots[s] - 1u].ptr;
+        if (strcmp(d_content_proto_name(proto), name) == 0) {
+            return proto;
+        }
+        s = (s + 1u) & mask;
+    }
+    return (const void *)0;
+}
+
 static int d_content_register_material(const d_proto_material *src)
 {
     u32 slot;
@@ -246,6 +523,7 @@ static int d_content_register_material(const d_proto_material *src)
         memset(&g_material_storage[slot], 0, sizeof(g_material_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_MATERIAL, slot);
     return 0;
 }
 
@@ -265,6 +543,7 @@ static int d_content_register_item(const d_proto_item *src)
         memset(&g_item_storage[slot], 0, sizeof(g_item_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_ITEM, slot);
     return 0;
 }
 
@@ -284,6 +563,7 @@ static int d_content_register_container(const d_proto_container *src)
         memset(&g_container_storage[slot], 0, sizeof(g_container_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_CONTAINER, slot);
     return 0;
 }
 
@@ -333,6 +613,7 @@ static int d_content_register_process(const d_proto_process *src)
         memset(&g_process_storage[slot], 0, sizeof(g_process_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_PROCESS, slot);
     return 0;
 }
 
@@ -352,6 +633,7 @@ static int d_content_register_deposit(const d_proto_deposit *src)
         memset(&g_deposit_storage[slot], 0, sizeof(g_deposit_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_DEPOSIT, slot);
     return 0;
 }
 
@@ -371,6 +653,7 @@ static int d_content_register_structure(const d_proto_structure *src)
         memset(&g_structure_storage[slot], 0, sizeof(g_structure_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_STRUCTURE, slot);
     return 0;
 }
 
@@ -390,6 +673,7 @@ static int d_content_register_vehicle(const d_proto_vehicle *src)
         memset(&g_vehicle_storage[slot], 0, sizeof(g_vehicle_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_VEHICLE, slot);
     return 0;
 }
 
@@ -409,6 +693,7 @@ static int d_content_register_spline(const d_proto_spline_profile *src)
         memset(&g_spline_profile_storage[slot], 0, sizeof(g_spline_profile_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_SPLINE_PROFILE, slot);
     return 0;
 }
 
@@ -443,6 +728,7 @@ static int d_content_register_job_template(const d_proto_job_template *src)
         memset(&g_job_template_storage[slot], 0, sizeof(g_job_template_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_JOB_TEMPLATE, slot);
     return 0;
 }
 
@@ -462,6 +748,7 @@ static int d_content_register_building(const d_proto_building *src)
         memset(&g_building_storage[slot], 0, sizeof(g_building_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_BUILDING, slot);
     return 0;
 }
 
@@ -481,6 +768,7 @@ static int d_content_register_blueprint(const d_proto_blueprint *src)
         memset(&g_blueprint_storage[slot], 0, sizeof(g_blueprint_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_BLUEPRINT, slot);
     return 0;
 }
 
@@ -515,6 +803,7 @@ static int d_content_register_research(const d_proto_research *src)
         memset(&g_research_storage[slot], 0, sizeof(g_research_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_RESEARCH, slot);
     return 0;
 }
 
@@ -534,6 +823,7 @@ static int d_content_register_research_point_source(const d_proto_research_point
         memset(&g_research_point_source_storage[slot], 0, sizeof(g_research_point_source_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_RESEARCH_POINT_SOURCE, slot);
     return 0;
 }
 
@@ -553,6 +843,7 @@ static int d_content_register_policy_rule(const d_proto_policy_rule *src)
         memset(&g_policy_rule_storage[slot], 0, sizeof(g_policy_rule_storage[slot]));
         return -1;
     }
+    d_content_index_name(D_CONTENT_KIND_POLICY_RULE, slot);
     return 0;
 }
 
@@ -762,6 +1053,592 @@ int d_content_load_mod(const d_proto_mod_manifest *m)
     return 0;
 }
 
+/*------------------------------------------------------------
+ * Binary content cache
+ *
+ * A DTLV container holding the resolved registries:
+ *   CCHD  header: format/ABI checks, content hash, checksum, counts
+ *   CCAR  arena: every name and blob payload, NUL-terminated names
+ *   CCPL  one per side pool (version = pool + 1), raw elements
+ *   CCRC  one per registry (version = kind + 1), raw proto records
+ *   CCRF  one per registry, u32 references for each pointer member
+ * Records are host structs, so the header pins the struct sizes, pointer
+ * width and byte order; a cache built by another binary is simply stale.
+ *------------------------------------------------------------*/
+#define D_CONTENT_CACHE_TAG(a,b,c,d) \
+    ((u32)(a) | ((u32)(b) << 8u) | ((u32)(c) << 16u) | ((u32)(d) << 24u))
+
+#define D_CONTENT_CACHE_CHUNK_HEADER  D_CONTENT_CACHE_TAG('C','C','H','D')
+#define D_CONTENT_CACHE_CHUNK_ARENA   D_CONTENT_CACHE_TAG('C','C','A','R')
+#define D_CONTENT_CACHE_CHUNK_POOL    D_CONTENT_CACHE_TAG('C','C','P','L')
+#define D_CONTENT_CACHE_CHUNK_RECORDS D_CONTENT_CACHE_TAG('C','C','R','C')
+#define D_CONTENT_CACHE_CHUNK_REFS    D_CONTENT_CACHE_TAG('C','C','R','F')
+
+#define D_CONTENT_CACHE_HEADER_SIZE \
+    (40u + 8u * (u32)D_CONTENT_KIND_COUNT + 8u * (u32)D_CONTENT_POOL_COUNT)
+#define D_CONTENT_CACHE_NULL_REF   0xFFFFFFFFu
+#define D_CONTENT_CACHE_ARENA_MAX  0xFFFFFFF0u
+#define D_CONTENT_CACHE_BYTE_ORDER 0x01020304u
+
+#define D_CONTENT_HASH_MUL 0x9E3779B97F4A7C15ULL
+
+typedef union d_content_any_proto {
+    d_proto_material m;
+    d_proto_item it;
+    d_proto_container ct;
+    d_proto_process proc;
+    d_proto_deposit dep;
+    d_proto_structure st;
+    d_proto_vehicle veh;
+    d_proto_spline_profile sp;
+    d_proto_job_template jt;
+    d_proto_building bld;
+    d_proto_blueprint bp;
+    d_proto_research r;
+    d_proto_research_point_source rps;
+    d_proto_policy_rule pr;
+} d_content_any_proto;
+
+static u64 d_content_read_u64_le(const unsigned char *p)
+{
+    return (u64)p[0] | ((u64)p[1] << 8) | ((u64)p[2] << 16) | ((u64)p[3] << 24) |
+           ((u64)p[4] << 32) | ((u64)p[5] << 40) | ((u64)p[6] << 48) | ((u64)p[7] << 56);
+}
+
+/* Multiply-xorshift over little-endian words; byte order independent and
+ * fast enough to run over packs and the cache on every start. */
+static u64 d_content_hash_word(u64 h, const unsigned char *p)
+{
+    h = (h ^ d_content_read_u64_le(p)) * D_CONTENT_HASH_MUL;
+    return h ^ (h >> 32);
+}
+
+static u64 d_content_hash_bytes(u64 h, const void *bytes, u32 len)
+{
+    const unsigned char *p = (const unsigned char *)bytes;
+    u64 tail = (u64)len;
+    u32 i;
+    while (len >= 8u) {
+        h = d_content_hash_word(h, p);
+        p += 8u;
+        len -= 8u;
+    }
+    for (i = 0u; i < len; ++i) {
+        tail = (tail << 8) | (u64)p[i];
+    }
+    h = (h ^ tail) * D_CONTENT_HASH_MUL;
+    return h ^ (h >> 32);
+}
+
+static u64 d_content_hash_u32(u64 h, u32 v)
+{
+    unsigned char b[4];
+    dtlv_le_write_u32(b, v);
+    return d_content_hash_bytes(h, b, 4u);
+}
+
+static u64 d_content_hash_blob(u64 h, const d_tlv_blob *blob)
+{
+    u32 len = (blob->ptr) ? blob->len : 0u;
+    h = d_content_hash_u32(h, len);
+    return d_content_hash_bytes(h, blob->ptr, len);
+}
+
+u64 d_content_hash_pack(u64 hash, const d_proto_pack_manifest *m)
+{
+    if (!m) {
+        return hash;
+    }
+    hash = d_content_hash_u32(hash, 1u);
+    hash = d_content_hash_u32(hash, m->id);
+    hash = d_content_hash_u32(hash, m->version);
+    return d_content_hash_blob(hash, &m->content_tlv);
+}
+
+u64 d_content_hash_mod(u64 hash, const d_proto_mod_manifest *m)
+{
+    if (!m) {
+        return hash;
+    }
+    hash = d_content_hash_u32(hash, 2u);
+    hash = d_content_hash_u32(hash, m->id);
+    hash = d_content_hash_u32(hash, m->version);
+    hash = d_content_hash_blob(hash, &m->deps_tlv);
+    return d_content_hash_blob(hash, &m->content_tlv);
+}
+
+/* Cache checksum over the payload stream; the writer feeds it in pieces,
+ * the reader feeds whole chunks, and both land on the same words. */
+typedef struct d_content_sum {
+    u64           h;
+    unsigned char buf[8];
+    u32           pending;
+} d_content_sum;
+
+static void d_content_sum_init(d_content_sum *s)
+{
+    s->h = D_CONTENT_HASH_SEED;
+    s->pending = 0u;
+}
+
+static void d_content_sum_feed(d_content_sum *s, const void *bytes, u32 len)
+{
+    const unsigned char *p = (const unsigned char *)bytes;
+    if (s->pending > 0u) {
+        while (s->pending < 8u && len > 0u) {
+            s->buf[s->pending++] = *p++;
+            --len;
+        }
+        if (s->pending < 8u) {
+            return;
+        }
+        s->h = d_content_hash_word(s->h, s->buf);
+        s->pending = 0u;
+    }
+    while (len >= 8u) {
+        s->h = d_content_hash_word(s->h, p);
+        p += 8u;
+        len -= 8u;
+    }
+    if (len > 0u) {
+        memcpy(s->buf, p, len);
+    }
+    s->pending = len;
+}
+
+static u64 d_content_sum_finish(const d_content_sum *s)
+{
+    return d_content_hash_bytes(s->h, s->buf, s->pending);
+}
+
+static int d_content_cache_put(dtlv_writer *w, d_content_sum *sum, const void *bytes, u32 len)
+{
+    if (len == 0u) {
+        return 0;
+    }
+    d_content_sum_feed(sum, bytes, len);
+    return dtlv_writer_write(w, bytes, len);
+}
+
+static u32 d_content_cache_ref_total(void)
+{
+    u32 k;
+    u32 total = 0u;
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        total += g_content_kinds[k].reg->count * g_content_kinds[k].field_count;
+    }
+    return total;
+}
+
+/* Streams names and blobs into the arena chunk and records a reference per
+ * pointer member in `refs` (kind order, then entry order, then field order). */
+static int d_content_cache_put_arena(dtlv_writer *w, d_content_sum *sum, u32 *refs)
+{
+    u32 k;
+    u32 i;
+    u32 f;
+    u32 arena = 0u;
+    u32 n = 0u;
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        const d_content_kind *kind = &g_content_kinds[k];
+        for (i = 0u; i < kind->reg->count; ++i) {
+            const unsigned char *proto = (const unsigned char *)kind->entries[i].ptr;
+            for (f = 0u; f < kind->field_count; ++f) {
+                const d_content_field *field = &kind->fields[f];
+                const unsigned char *bytes = (const unsigned char *)0;
+                u32 len = 0u;
+                u32 ref = D_CONTENT_CACHE_NULL_REF;
+                if (field->kind == D_CONTENT_FIELD_STRING) {
+                    const char *s;
+                    memcpy(&s, proto + field->offset, sizeof(s));
+                    s = d_content_safe_name(s);
+                    bytes = (const unsigned char *)s;
+                    len = (u32)strlen(s) + 1u;
+                } else if (field->kind == D_CONTENT_FIELD_BLOB) {
+                    d_tlv_blob blob;
+                    memcpy(&blob, proto + field->offset, sizeof(blob));
+                    if (blob.ptr && blob.len > 0u) {
+                        bytes = blob.ptr;
+                        len = blob.len;
+                    }
+                } else {
+                    const d_content_pool *pool = &g_content_pools[field->pool];
+                    const unsigned char *base = (const unsigned char *)pool->base;
+                    const unsigned char *p;
+                    u16 count;
+                    memcpy(&p, proto + field->offset, sizeof(p));
+                    memcpy(&count, proto + field->count_offset, sizeof(count));
+                    if (p) {
+                        size_t at;
+                        if (p < base || ((size_t)(p - base) % pool->stride) != 0u) {
+                            return -1;
+                        }
+                        at = (size_t)(p - base) / pool->stride;
+                        if (at + count > *pool->count) {
+                            return -1;
+                        }
+                        ref = (u32)at;
+                    }
+                }
+                if (bytes) {
+                    if (len > D_CONTENT_CACHE_ARENA_MAX - arena) {
+                        return -1;
+                    }
+                    if (d_content_cache_put(w, sum, bytes, len) != 0) {
+                        return -1;
+                    }
+                    ref = arena;
+                    arena += len;
+                }
+                refs[n++] = ref;
+            }
+        }
+    }
+    return 0;
+}
+
+static int d_content_cache_put_records(dtlv_writer *w, d_content_sum *sum, const u32 *refs)
+{
+    d_content_any_proto record;
+    u32 k;
+    u32 i;
+    u32 f;
+    u32 n = 0u;
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        const d_content_kind *kind = &g_content_kinds[k];
+        u32 ref_count = kind->reg->count * kind->field_count;
+        if (dtlv_writer_begin_chunk(w, D_CONTENT_CACHE_CHUNK_RECORDS, (u16)(k + 1u), 0u) != 0) {
+            return -1;
+        }
+        for (i = 0u; i < kind->reg->count; ++i) {
+            unsigned char *bytes = (unsigned char *)&record;
+            memcpy(bytes, kind->entries[i].ptr, kind->stride);
+            /* Pointer values are meaningless on reload; keep the file stable. */
+            for (f = 0u; f < kind->field_count; ++f) {
+                u32 at = kind->fields[f].offset;
+                if (kind->fields[f].kind == D_CONTENT_FIELD_BLOB) {
+                    at += (u32)offsetof(d_tlv_blob, ptr);
+                }
+                memset(bytes + at, 0, sizeof(void *));
+            }
+            if (d_content_cache_put(w, sum, bytes, kind->stride) != 0) {
+                return -1;
+            }
+        }
+        if (dtlv_writer_end_chunk(w) != 0) {
+            return -1;
+        }
+        if (dtlv_writer_begin_chunk(w, D_CONTENT_CACHE_CHUNK_REFS, (u16)(k + 1u), 0u) != 0 ||
+            d_content_cache_put(w, sum, refs + n, ref_count * 4u) != 0 ||
+            dtlv_writer_end_chunk(w) != 0) {
+            return -1;
+        }
+        n += ref_count;
+    }
+    return 0;
+}
+
+static int d_content_cache_write(dtlv_writer *w, u64 content_hash, u32 *refs)
+{
+    unsigned char header[D_CONTENT_CACHE_HEADER_SIZE];
+    u32 byte_order = D_CONTENT_CACHE_BYTE_ORDER;
+    d_content_sum sum;
+    u32 at = 40u;
+    u32 k;
+    u32 p;
+
+    d_content_sum_init(&sum);
+    if (dtlv_writer_begin_chunk(w, D_CONTENT_CACHE_CHUNK_ARENA, 1u, 0u) != 0 ||
+        d_content_cache_put_arena(w, &sum, refs) != 0 ||
+        dtlv_writer_end_chunk(w) != 0) {
+        return -1;
+    }
+    for (p = 0u; p < D_CONTENT_POOL_COUNT; ++p) {
+        const d_content_pool *pool = &g_content_pools[p];
+        if (dtlv_writer_begin_chunk(w, D_CONTENT_CACHE_CHUNK_POOL, (u16)(p + 1u), 0u) != 0 ||
+            d_content_cache_put(w, &sum, pool->base, *pool->count * pool->stride) != 0 ||
+            dtlv_writer_end_chunk(w) != 0) {
+            return -1;
+        }
+    }
+    if (d_content_cache_put_records(w, &sum, refs) != 0) {
+        return -1;
+    }
+
+    memset(header, 0, sizeof(header));
+    dtlv_le_write_u32(header + 0u, D_CONTENT_CACHE_VERSION);
+    dtlv_le_write_u32(header + 4u, (u32)sizeof(void *));
+    memcpy(header + 8u, &byte_order, 4u);
+    dtlv_le_write_u32(header + 12u, (u32)D_CONTENT_KIND_COUNT);
+    dtlv_le_write_u32(header + 16u, (u32)D_CONTENT_POOL_COUNT);
+    dtlv_le_write_u64(header + 24u, content_hash);
+    dtlv_le_write_u64(header + 32u, d_content_sum_finish(&sum));
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        dtlv_le_write_u32(header + at, g_content_kinds[k].stride);
+        dtlv_le_write_u32(header + at + 4u, g_content_kinds[k].reg->count);
+        at += 8u;
+    }
+    for (p = 0u; p < D_CONTENT_POOL_COUNT; ++p) {
+        dtlv_le_write_u32(header + at, g_content_pools[p].stride);
+        dtlv_le_write_u32(header + at + 4u, *g_content_pools[p].count);
+        at += 8u;
+    }
+    if (dtlv_writer_begin_chunk(w, D_CONTENT_CACHE_CHUNK_HEADER, 1u, 0u) != 0 ||
+        dtlv_writer_write(w, header, sizeof(header)) != 0 ||
+        dtlv_writer_end_chunk(w) != 0) {
+        return -1;
+    }
+    return dtlv_writer_finalize(w);
+}
+
+int d_content_cache_save(const char *path, u64 content_hash)
+{
+    dtlv_writer w;
+    char *tmp_path;
+    u32 *refs;
+    size_t path_len;
+    int rc;
+
+    if (!path || !path[0]) {
+        return -1;
+    }
+    path_len = strlen(path);
+    tmp_path = (char *)malloc(path_len + 5u);
+    refs = (u32 *)malloc(sizeof(u32) * ((size_t)d_content_cache_ref_total() + 1u));
+    if (!tmp_path || !refs) {
+        free(tmp_path);
+        free(refs);
+        return -1;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5u);
+
+    /* Write beside the target and rename, so readers never see a torn file. */
+    dtlv_writer_init(&w);
+    rc = dtlv_writer_open_file(&w, tmp_path);
+    if (rc == 0) {
+        rc = d_content_cache_write(&w, content_hash, refs);
+    }
+    dtlv_writer_dispose(&w);
+    if (rc == 0) {
+        (void)remove(path);
+        rc = (rename(tmp_path, path) == 0) ? 0 : -1;
+    }
+    if (rc != 0) {
+        (void)remove(tmp_path);
+        rc = -1;
+    }
+    free(tmp_path);
+    free(refs);
+    return rc;
+}
+
+typedef struct d_content_cache_view {
+    const unsigned char *arena;
+    u32                  arena_size;
+    const unsigned char *pools[D_CONTENT_POOL_COUNT];
+    u32                  pool_counts[D_CONTENT_POOL_COUNT];
+    const unsigned char *records[D_CONTENT_KIND_COUNT];
+    const unsigned char *refs[D_CONTENT_KIND_COUNT];
+    u32                  counts[D_CONTENT_KIND_COUNT];
+} d_content_cache_view;
+
+static int d_content_cache_chunk(const dtlv_reader *r, u32 type_id, u32 index,
+                                 const unsigned char **out, u32 *out_size)
+{
+    const dtlv_dir_entry *e = dtlv_reader_find_first(r, type_id, (u16)(index + 1u));
+    if (!e) {
+        return -1;
+    }
+    return dtlv_reader_chunk_memview(r, e, out, out_size);
+}
+
+/* Header, chunk sizes and checksum; fills `v` with views into the mapping. */
+static int d_content_cache_check(const dtlv_reader *r, u64 content_hash, d_content_cache_view *v)
+{
+    const unsigned char *header;
+    const unsigned char *bytes;
+    u32 size;
+    u32 byte_order;
+    u32 at = 40u;
+    u32 k;
+    u32 p;
+    d_content_sum sum;
+
+    d_content_sum_init(&sum);
+    if (d_content_cache_chunk(r, D_CONTENT_CACHE_CHUNK_HEADER, 0u, &header, &size) != 0 ||
+        size != D_CONTENT_CACHE_HEADER_SIZE) {
+        return -1;
+    }
+    memcpy(&byte_order, header + 8u, 4u);
+    if (dtlv_le_read_u32(header + 0u) != D_CONTENT_CACHE_VERSION ||
+        dtlv_le_read_u32(header + 4u) != (u32)sizeof(void *) ||
+        byte_order != D_CONTENT_CACHE_BYTE_ORDER ||
+        dtlv_le_read_u32(header + 12u) != (u32)D_CONTENT_KIND_COUNT ||
+        dtlv_le_read_u32(header + 16u) != (u32)D_CONTENT_POOL_COUNT ||
+        dtlv_le_read_u64(header + 24u) != content_hash) {
+        return -1;
+    }
+
+    if (d_content_cache_chunk(r, D_CONTENT_CACHE_CHUNK_ARENA, 0u, &v->arena, &v->arena_size) != 0) {
+        return -1;
+    }
+    d_content_sum_feed(&sum, v->arena, v->arena_size);
+
+    at += 8u * (u32)D_CONTENT_KIND_COUNT;
+    for (p = 0u; p < D_CONTENT_POOL_COUNT; ++p) {
+        const d_content_pool *pool = &g_content_pools[p];
+        u32 count = dtlv_le_read_u32(header + at + 4u);
+        if (dtlv_le_read_u32(header + at) != pool->stride || count > pool->capacity ||
+            d_content_cache_chunk(r, D_CONTENT_CACHE_CHUNK_POOL, p, &bytes, &size) != 0 ||
+            size != count * pool->stride) {
+            return -1;
+        }
+        v->pools[p] = bytes;
+        v->pool_counts[p] = count;
+        d_content_sum_feed(&sum, bytes, size);
+        at += 8u;
+    }
+
+    at = 40u;
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        const d_content_kind *kind = &g_content_kinds[k];
+        u32 count = dtlv_le_read_u32(header + at + 4u);
+        if (dtlv_le_read_u32(header + at) != kind->stride || count > kind->capacity ||
+            d_content_cache_chunk(r, D_CONTENT_CACHE_CHUNK_RECORDS, k, &bytes, &size) != 0 ||
+            size != count * kind->stride) {
+            return -1;
+        }
+        v->records[k] = bytes;
+        v->counts[k] = count;
+        d_content_sum_feed(&sum, bytes, size);
+        if (d_content_cache_chunk(r, D_CONTENT_CACHE_CHUNK_REFS, k, &bytes, &size) != 0 ||
+            size != count * kind->field_count * 4u) {
+            return -1;
+        }
+        v->refs[k] = bytes;
+        d_content_sum_feed(&sum, bytes, size);
+        at += 8u;
+    }
+    return (dtlv_le_read_u64(header + 32u) == d_content_sum_finish(&sum)) ? 0 : -1;
+}
+
+/* Every reference must land inside the arena or its pool. */
+static int d_content_cache_check_refs(const d_content_cache_view *v)
+{
+    u32 k;
+    u32 i;
+    u32 f;
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        const d_content_kind *kind = &g_content_kinds[k];
+        for (i = 0u; i < v->counts[k]; ++i) {
+            const unsigned char *rec = v->records[k] + (size_t)i * kind->stride;
+            for (f = 0u; f < kind->field_count; ++f) {
+                const d_content_field *field = &kind->fields[f];
+                u32 ref;
+                memcpy(&ref, v->refs[k] + ((size_t)i * kind->field_count + f) * 4u, 4u);
+                if (field->kind == D_CONTENT_FIELD_STRING) {
+                    if (ref >= v->arena_size ||
+                        !memchr(v->arena + ref, 0, (size_t)(v->arena_size - ref))) {
+                        return -1;
+                    }
+                } else if (field->kind == D_CONTENT_FIELD_BLOB) {
+                    d_tlv_blob blob;
+                    memcpy(&blob, rec + field->offset, sizeof(blob));
+                    if (ref != D_CONTENT_CACHE_NULL_REF &&
+                        (ref > v->arena_size || blob.len > v->arena_size - ref)) {
+                        return -1;
+                    }
+                } else {
+                    u16 count;
+                    memcpy(&count, rec + field->count_offset, sizeof(count));
+                    if (ref != D_CONTENT_CACHE_NULL_REF &&
+                        (ref > v->pool_counts[field->pool] ||
+                         count > v->pool_counts[field->pool] - ref)) {
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int d_content_cache_adopt(const d_content_cache_view *v)
+{
+    u32 k;
+    u32 i;
+    u32 f;
+    u32 p;
+    for (p = 0u; p < D_CONTENT_POOL_COUNT; ++p) {
+        const d_content_pool *pool = &g_content_pools[p];
+        if (v->pool_counts[p] > 0u) {
+            memcpy(pool->base, v->pools[p], (size_t)v->pool_counts[p] * pool->stride);
+        }
+        *pool->count = v->pool_counts[p];
+    }
+    for (k = 0u; k < D_CONTENT_KIND_COUNT; ++k) {
+        const d_content_kind *kind = &g_content_kinds[k];
+        for (i = 0u; i < v->counts[k]; ++i) {
+            unsigned char *proto = (unsigned char *)kind->storage + (size_t)i * kind->stride;
+            memcpy(proto, v->records[k] + (size_t)i * kind->stride, kind->stride);
+            for (f = 0u; f < kind->field_count; ++f) {
+                const d_content_field *field = &kind->fields[f];
+                u32 ref;
+                memcpy(&ref, v->refs[k] + ((size_t)i * kind->field_count + f) * 4u, 4u);
+                if (field->kind == D_CONTENT_FIELD_STRING) {
+                    const char *s = (const char *)(v->arena + ref);
+                    memcpy(proto + field->offset, &s, sizeof(s));
+                } else if (field->kind == D_CONTENT_FIELD_BLOB) {
+                    d_tlv_blob blob;
+                    memcpy(&blob, proto + field->offset, sizeof(blob));
+                    blob.ptr = (ref == D_CONTENT_CACHE_NULL_REF) ? (unsigned char *)0 :
+                               (unsigned char *)(v->arena + ref);
+                    memcpy(proto + field->offset, &blob, sizeof(blob));
+                } else {
+                    const d_content_pool *pool = &g_content_pools[field->pool];
+                    void *ptr = (ref == D_CONTENT_CACHE_NULL_REF) ? (void *)0 :
+                                (void *)((unsigned char *)pool->base + (size_t)ref * pool->stride);
+                    memcpy(proto + field->offset, &ptr, sizeof(ptr));
+                }
+            }
+            if (d_registry_add_with_id(kind->reg, ((const d_content_proto_head *)proto)->id, proto) == 0u) {
+                return -1;
+            }
+            d_content_index_name(k, i);
+        }
+    }
+    return 0;
+}
+
+int d_content_cache_load(const char *path, u64 content_hash)
+{
+    dtlv_reader r;
+    d_content_cache_view view;
+
+    if (!path || !path[0]) {
+        return 1;
+    }
+    dtlv_reader_init(&r);
+    memset(&view, 0, sizeof(view));
+    if (dtlv_reader_open_mapped(&r, path) != 0 ||
+        d_content_cache_check(&r, content_hash, &view) != 0 ||
+        d_content_cache_check_refs(&view) != 0) {
+        dtlv_reader_dispose(&r);
+        return 1;
+    }
+
+    /* Views stay valid: the reader only moves into g_content_cache. */
+    d_content_reset();
+    g_content_cache = r;
+    g_content_cache_open = 1;
+    if (d_content_cache_adopt(&view) != 0) {
+        d_content_reset();
+        return 1;
+    }
+    return 0;
+}
+
 /* Registry getters */
 const d_proto_material *d_content_get_material(d_material_id id)
 {
@@ -833,17 +1710,7 @@ const d_proto_blueprint *d_content_get_blueprint(d_blueprint_id id)
 
 const d_proto_blueprint *d_content_get_blueprint_by_name(const char *name)
 {
-    u32 i;
-    if (!name || !name[0]) {
-        return (const d_proto_blueprint *)0;
-    }
-    for (i = 0u; i < g_blueprint_registry.count; ++i) {
-        const d_proto_blueprint *bp = (const d_proto_blueprint *)g_blueprint_registry.entries[i].ptr;
-        if (bp && bp->name && strcmp(bp->name, name) == 0) {
-            return bp;
-        }
-    }
-    return (const d_proto_blueprint *)0;
+    return (const d_proto_blueprint *)d_content_find_name(D_CONTENT_KIND_BLUEPRINT, name);
 }
 
 const d_proto_research *d_content_get_research(d_research_id id)
@@ -939,6 +1806,47 @@ const d_proto_policy_rule *d_content_get_policy_rule_by_index(u32 index) {
     return (const d_proto_policy_rule *)g_policy_rule_registry.entries[index].ptr;
 }
 
+/* Name lookups: first registered proto with the name; NULL for empty names. */
+const d_proto_material *d_content_get_material_by_name(const char *name) {
+    return (const d_proto_material *)d_content_find_name(D_CONTENT_KIND_MATERIAL, name);
+}
+const d_proto_item *d_content_get_item_by_name(const char *name) {
+    return (const d_proto_item *)d_content_find_name(D_CONTENT_KIND_ITEM, name);
+}
+const d_proto_container *d_content_get_container_by_name(const char *name) {
+    return (const d_proto_container *)d_content_find_name(D_CONTENT_KIND_CONTAINER, name);
+}
+const d_proto_process *d_content_get_process_by_name(const char *name) {
+    return (const d_proto_process *)d_content_find_name(D_CONTENT_KIND_PROCESS, name);
+}
+const d_proto_deposit *d_content_get_deposit_by_name(const char *name) {
+    return (const d_proto_deposit *)d_content_find_name(D_CONTENT_KIND_DEPOSIT, name);
+}
+const d_proto_structure *d_content_get_structure_by_name(const char *name) {
+    return (const d_proto_structure *)d_content_find_name(D_CONTENT_KIND_STRUCTURE, name);
+}
+const d_proto_vehicle *d_content_get_vehicle_by_name(const char *name) {
+    return (const d_proto_vehicle *)d_content_find_name(D_CONTENT_KIND_VEHICLE, name);
+}
+const d_proto_spline_profile *d_content_get_spline_profile_by_name(const char *name) {
+    return (const d_proto_spline_profile *)d_content_find_name(D_CONTENT_KIND_SPLINE_PROFILE, name);
+}
+const d_proto_job_template *d_content_get_job_template_by_name(const char *name) {
+    return (const d_proto_job_template *)d_content_find_name(D_CONTENT_KIND_JOB_TEMPLATE, name);
+}
+const d_proto_building *d_content_get_building_by_name(const char *name) {
+    return (const d_proto_building *)d_content_find_name(D_CONTENT_KIND_BUILDING, name);
+}
+const d_proto_research *d_content_get_research_by_name(const char *name) {
+    return (const d_proto_research *)d_content_find_name(D_CONTENT_KIND_RESEARCH, name);
+}
+const d_proto_research_point_source *d_content_get_research_point_source_by_name(const char *name) {
+    return (const d_proto_research_point_source *)d_content_find_name(D_CONTENT_KIND_RESEARCH_POINT_SOURCE, name);
+}
+const d_proto_policy_rule *d_content_get_policy_rule_by_name(const char *name) {
+    return (const d_proto_policy_rule *)d_content_find_name(D_CONTENT_KIND_POLICY_RULE, name);
+}
+
 void d_content_debug_dump(void)
 {
     u32 i;
@@ -367,6 +367,48 @@ const d_proto_research_point_source *d_content_get_research_point_source_by_inde
 u32 d_content_policy_rule_count(void);
 const d_proto_policy_rule *d_content_get_policy_rule_by_index(u32 index);
 
+/* Hashed name lookups: the first registered proto with that name, or NULL
+ * (empty names never match). */
+const d_proto_material    *d_content_get_material_by_name(const char *name);
+const d_proto_item        *d_content_get_item_by_name(const char *name);
+const d_proto_container   *d_content_get_container_by_name(const char *name);
+const d_proto_process     *d_content_get_process_by_name(const char *name);
+const d_proto_deposit     *d_content_get_deposit_by_name(const char *name);
+const d_proto_structure   *d_content_get_structure_by_name(const char *name);
+const d_proto_vehicle     *d_content_get_vehicle_by_name(const char *name);
+const d_proto_spline_profile *d_content_get_spline_profile_by_name(const char *name);
+const d_proto_job_template *d_content_get_job_template_by_name(const char *name);
+const d_proto_building    *d_content_get_building_by_name(const char *name);
+const d_proto_research    *d_content_get_research_by_name(const char *name);
+const d_proto_research_point_source *d_content_get_research_point_source_by_name(const char *name);
+const d_proto_policy_rule *d_content_get_policy_rule_by_name(const char *name);
+
+/* Binary content cache.
+ *
+ * A cache file holds the resolved registries of one pack set and is keyed
+ * by that set's content hash. Startup folds every pack/mod into the hash in
+ * load order (starting from D_CONTENT_HASH_SEED), tries
+ * d_content_cache_load, and on a miss loads the packs as usual and calls
+ * d_content_cache_save. The cache is specific to the binary that wrote it
+ * (struct layout, pointer width, byte order); any mismatch is a miss.
+ */
+#define D_CONTENT_CACHE_VERSION 1u
+#define D_CONTENT_HASH_SEED 14695981039346656037ULL
+
+u64 d_content_hash_pack(u64 hash, const d_proto_pack_manifest *m);
+u64 d_content_hash_mod(u64 hash, const d_proto_mod_manifest *m);
+
+/* Write the current registries to `path` (via `path`.tmp and a rename).
+ * Returns 0 on success. */
+int d_content_cache_save(const char *path, u64 content_hash);
+
+/* Map `path` and adopt it as the registries when its header, checksum and
+ * content hash match. Names and blobs then point into the mapping, which
+ * stays open until the next reset/shutdown. Returns 0 when adopted; 1 when
+ * the cache is missing, stale, unmappable or corrupt (registries untouched
+ * unless adoption itself fails, which leaves them reset). */
+int d_content_cache_load(const char *path, u64 content_hash);
+
 /* Debug helper to print counts and names. */
 void d_content_debug_dump(void);
 
@@ -22,7 +22,7 @@ EXTENSION POINTS: Replace enumeration with platform-native sorted listing if ava
 #include <direct.h>
 #else
 #include <dirent.h>
-#include <stat.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
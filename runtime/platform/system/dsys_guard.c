@@ -25,7 +25,7 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include <windows.h>
 #include <direct.h>
 #else
-#include <stat.h>
+#include <sys/stat.h>
 #include <pthread.h>
 #endif
 
@@ -44,7 +44,7 @@ int  dsys_internal_event_pop(dsys_event* out);
 #include <direct.h>
 #else
 #include <dirent.h>
-#include <stat.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
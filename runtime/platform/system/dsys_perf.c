@@ -5,7 +5,8 @@ LAYER / SUBSYSTEM: Domino impl / system/dsys_perf
 RESPONSIBILITY: Implements profiling counters, timers, and telemetry output.
 ALLOWED DEPENDENCIES: `include/domino/**`, `source/domino/**`, and C89 headers.
 FORBIDDEN DEPENDENCIES: `include/dominium/**`, `source/dominium/**`.
-THREADING MODEL: No internal synchronization; callers must serialize access.
+THREADING MODEL: Recording is lock-free through per-thread blocks merged at tick end;
+                 everything else is single-threaded (see dsys_perf.h).
 ERROR MODEL: Return codes; no exceptions.
 DETERMINISM: Profiling is non-authoritative and must not influence simulation.
 */
@@ -20,19 +21,66 @@ DETERMINISM: Profiling is non-authoritative and must not influence simulation.
 #if defined(_WIN32)
 #include <direct.h>
 #else
-#include <stat.h>
+#include <sys/stat.h>
 #endif
 
-#define DSYS_PERF_MAX_SAMPLES 256u
+#define DSYS_PERF_RING_SAMPLES 256u
+#define DSYS_PERF_SINK_BATCH 64u
 #define DSYS_PERF_MAX_PATH 260u
 #define DSYS_PERF_MAX_NAME 64u
+#define DSYS_PERF_MAX_THREADS 32u
+#define DSYS_PERF_MAX_TIMERS 16u
+#define DSYS_PERF_HIST_COUNT (DSYS_PERF_LANE_COUNT * DSYS_PERF_MAX_TIMERS)
+/* Values below 8 get exact buckets; above, 8 buckets per power of two. */
+#define DSYS_PERF_HIST_SUB_BITS 3u
+#define DSYS_PERF_HIST_BUCKETS 256u
+
+/* Per-thread op recorded against a metric this tick; decides the merge. */
+#define DSYS_PERF_OP_NONE 0u
+#define DSYS_PERF_OP_SET 1u
+#define DSYS_PERF_OP_ADD 2u
+#define DSYS_PERF_OP_MAX 3u
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define DSYS_PERF_TLS __declspec(thread)
+#define DSYS_PERF_ATOMIC_INC(p) ((long)_InterlockedIncrement((volatile long*)(p)))
+#define DSYS_PERF_ATOMIC_CAS(p, from, to) (_InterlockedCompareExchange((volatile long*)(p), (to), (from)) == (from))
+#elif defined(__GNUC__) || defined(__clang__)
+#define DSYS_PERF_TLS __thread
+#define DSYS_PERF_ATOMIC_INC(p) (__sync_add_and_fetch((p), 1L))
+#define DSYS_PERF_ATOMIC_CAS(p, from, to) (__sync_bool_compare_and_swap((p), (from), (to)))
+#else
+/* No TLS: all recording shares block 0 and must be serialized. */
+#define DSYS_PERF_TLS
+#define DSYS_PERF_ATOMIC_INC(p) (++(*(p)))
+#define DSYS_PERF_ATOMIC_CAS(p, from, to) ((*(p)) == (from) ? ((*(p)) = (to), 1) : 0)
+#endif
+
+/* dsys_perf_thread_block.owned; only released blocks are reclaimed, so a
+ * fresh slot cannot be taken between its claim and its first use. */
+#define DSYS_PERF_BLOCK_UNUSED 0L
+#define DSYS_PERF_BLOCK_OWNED 1L
+#define DSYS_PERF_BLOCK_RELEASED 2L
 
 typedef struct dsys_perf_sample {
     dom_act_time_t act;
     u64 tick_index;
-    u64 values[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_COUNT];
+    u64 values[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
 } dsys_perf_sample;
 
+/* Written only by its owning thread; merged and cleared by tick_end while
+ * recording threads are quiescent. A released block keeps its data until
+ * that merge, so the next thread to claim it simply adds to it. */
+typedef struct dsys_perf_thread_block {
+    volatile long owned;
+    u32 dirty;
+    u64 hist_dirty;
+    unsigned char op[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
+    u64 value[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
+    u32 hist[DSYS_PERF_HIST_COUNT][DSYS_PERF_HIST_BUCKETS];
+} dsys_perf_thread_block;
+
 static int g_perf_enabled = 0;
 static dsys_perf_clock_fn g_perf_clock_fn = NULL;
 static void* g_perf_clock_user = NULL;
@@ -44,14 +92,33 @@ static u32 g_perf_report_seq = 0u;
 
 static dom_act_time_t g_perf_current_act = 0;
 static u64 g_perf_current_tick = 0u;
-static u64 g_perf_current[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_COUNT];
-static u64 g_perf_last[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_COUNT];
-static u64 g_perf_max[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_COUNT];
-static u64 g_perf_sum[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_COUNT];
+static u64 g_perf_current[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
+static u64 g_perf_last[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
+static u64 g_perf_max[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
+static u64 g_perf_sum[DSYS_PERF_LANE_COUNT][DSYS_PERF_METRIC_CAPACITY];
+static u64 g_perf_hist[DSYS_PERF_HIST_COUNT][DSYS_PERF_HIST_BUCKETS];
+static u64 g_perf_hist_total[DSYS_PERF_HIST_COUNT];
+
+static dsys_perf_thread_block g_perf_blocks[DSYS_PERF_MAX_THREADS];
+static volatile long g_perf_block_count = 0;
+static volatile long g_perf_block_releases = 0;
+static volatile long g_perf_threads_denied = 0;
+static DSYS_PERF_TLS dsys_perf_thread_block* t_perf_block = NULL;
+/* Release count seen at the last failed claim, plus one; 0 = never denied. */
+static DSYS_PERF_TLS long t_perf_block_denied = 0;
 
-static dsys_perf_sample g_perf_samples[DSYS_PERF_MAX_SAMPLES];
+/* Sample ring: `count` retained samples starting at `head`, the newest
+ * `unsent` of which have not reached the sink yet. */
+static dsys_perf_sample g_perf_samples[DSYS_PERF_RING_SAMPLES];
+static u32 g_perf_sample_head = 0u;
 static u32 g_perf_sample_count = 0u;
-static u32 g_perf_sample_overflow = 0u;
+static u32 g_perf_sample_unsent = 0u;
+static u64 g_perf_sample_total = 0u;
+static u64 g_perf_sample_dropped = 0u;
+static dsys_perf_sink_fn g_perf_sink_fn = NULL;
+static void* g_perf_sink_user = NULL;
+static char g_perf_sink_fixture[DSYS_PERF_MAX_NAME];
+static char g_perf_sink_tier[DSYS_PERF_MAX_NAME];
 
 static const char* g_lane_names[DSYS_PERF_LANE_COUNT] = {
     "local",
@@ -73,9 +140,25 @@ static const char* g_metric_names[DSYS_PERF_METRIC_COUNT] = {
     "net_msg_sent",
     "net_msg_recv",
     "net_bytes_sent",
-    "net_bytes_recv"
+    "net_bytes_recv",
+    "domain_cache_hits",
+    "domain_cache_misses",
+    "domain_cache_evictions"
 };
 
+static char g_perf_dyn_names[DSYS_PERF_METRIC_CAPACITY - DSYS_PERF_METRIC_COUNT][DSYS_PERF_MAX_NAME];
+static u32 g_perf_metric_total = DSYS_PERF_METRIC_COUNT;
+
+/* Histogram slot + 1 per metric; 0 means no histogram. */
+static unsigned char g_perf_timer_slot[DSYS_PERF_METRIC_CAPACITY] = {
+    1u, /* sim_tick_us */
+    2u, /* macro_sched_us */
+    0u, 0u, 0u, 0u,
+    3u, /* derived_job_us */
+    4u  /* render_submit_us */
+};
+static u32 g_perf_timer_count = 4u;
+
 static u64 dsys_perf_clock_now(void)
 {
     if (g_perf_clock_fn) {
@@ -84,6 +167,153 @@ static u64 dsys_perf_clock_now(void)
     return g_perf_manual_time_us;
 }
 
+static u32 dsys_perf_block_count(void)
+{
+    long count = g_perf_block_count;
+    if (count < 0) {
+        return 0u;
+    }
+    return ((u32)count < DSYS_PERF_MAX_THREADS) ? (u32)count : DSYS_PERF_MAX_THREADS;
+}
+
+/* Claims this thread's block on first use, preferring one released by an
+ * exited thread over a fresh slot. While all DSYS_PERF_MAX_THREADS blocks
+ * are owned the thread records nothing; it is counted once and retries only
+ * after another thread releases a block. */
+static dsys_perf_thread_block* dsys_perf_block(void)
+{
+    long releases;
+    long idx;
+    u32 count;
+    u32 i;
+    if (t_perf_block) {
+        return t_perf_block;
+    }
+    releases = g_perf_block_releases;
+    if (t_perf_block_denied != 0 && t_perf_block_denied == releases + 1L) {
+        return NULL;
+    }
+    if (releases != 0) {
+        count = dsys_perf_block_count();
+        for (i = 0u; i < count; ++i) {
+            if (g_perf_blocks[i].owned == DSYS_PERF_BLOCK_RELEASED &&
+                DSYS_PERF_ATOMIC_CAS(&g_perf_blocks[i].owned, DSYS_PERF_BLOCK_RELEASED, DSYS_PERF_BLOCK_OWNED)) {
+                t_perf_block = &g_perf_blocks[i];
+                return t_perf_block;
+            }
+        }
+    }
+    if (g_perf_block_count < (long)DSYS_PERF_MAX_THREADS) {
+        idx = DSYS_PERF_ATOMIC_INC(&g_perf_block_count) - 1L;
+        if (idx >= 0 && (u32)idx < DSYS_PERF_MAX_THREADS) {
+            g_perf_blocks[idx].owned = DSYS_PERF_BLOCK_OWNED;
+            t_perf_block = &g_perf_blocks[idx];
+            return t_perf_block;
+        }
+    }
+    if (t_perf_block_denied == 0) {
+        (void)DSYS_PERF_ATOMIC_INC(&g_perf_threads_denied);
+    }
+    t_perf_block_denied = releases + 1L;
+    return NULL;
+}
+
+static int dsys_perf_valid(dsys_perf_lane lane, dsys_perf_metric metric)
+{
+    return ((u32)lane < DSYS_PERF_LANE_COUNT && (u32)metric < g_perf_metric_total) ? 1 : 0;
+}
+
+static u32 dsys_perf_hist_bucket(u64 value)
+{
+    u32 e = 0u;
+    u32 idx;
+    u64 v = value;
+    if (value < ((u64)1u << DSYS_PERF_HIST_SUB_BITS)) {
+        return (u32)value;
+    }
+    while (v >>= 1) {
+        ++e;
+    }
+    idx = (1u << DSYS_PERF_HIST_SUB_BITS) +
+          ((e - DSYS_PERF_HIST_SUB_BITS) << DSYS_PERF_HIST_SUB_BITS) +
+          (u32)((value >> (e - DSYS_PERF_HIST_SUB_BITS)) & ((1u << DSYS_PERF_HIST_SUB_BITS) - 1u));
+    return (idx < DSYS_PERF_HIST_BUCKETS) ? idx : (DSYS_PERF_HIST_BUCKETS - 1u);
+}
+
+static u64 dsys_perf_hist_upper(u32 idx)
+{
+    u32 sub = 1u << DSYS_PERF_HIST_SUB_BITS;
+    u32 shift;
+    if (idx < sub) {
+        return (u64)idx;
+    }
+    shift = (idx - sub) >> DSYS_PERF_HIST_SUB_BITS;
+    return (((u64)(sub + ((idx - sub) & (sub - 1u))) + 1u) << shift) - 1u;
+}
+
+static void dsys_perf_block_clear(dsys_perf_thread_block* b)
+{
+    u32 h;
+    if (b->dirty) {
+        memset(b->op, 0, sizeof(b->op));
+        memset(b->value, 0, sizeof(b->value));
+        b->dirty = 0u;
+    }
+    for (h = 0u; b->hist_dirty != 0u && h < DSYS_PERF_HIST_COUNT; ++h) {
+        if (b->hist_dirty & ((u64)1u << h)) {
+            memset(b->hist[h], 0, sizeof(b->hist[h]));
+        }
+    }
+    b->hist_dirty = 0u;
+}
+
+/* Folds every thread block into g_perf_current and the run histograms.
+ * Blocks merge in claim order, so a set on a later thread wins. */
+static void dsys_perf_merge_blocks(void)
+{
+    u32 count = dsys_perf_block_count();
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        dsys_perf_thread_block* b = &g_perf_blocks[i];
+        u32 lane;
+        u32 metric;
+        u32 h;
+        if (b->dirty) {
+            for (lane = 0u; lane < DSYS_PERF_LANE_COUNT; ++lane) {
+                for (metric = 0u; metric < g_perf_metric_total; ++metric) {
+                    u64 value = b->value[lane][metric];
+                    switch (b->op[lane][metric]) {
+                    case DSYS_PERF_OP_SET:
+                        g_perf_current[lane][metric] = value;
+                        break;
+                    case DSYS_PERF_OP_ADD:
+                        g_perf_current[lane][metric] += value;
+                        break;
+                    case DSYS_PERF_OP_MAX:
+                        if (value > g_perf_current[lane][metric]) {
+                            g_perf_current[lane][metric] = value;
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        }
+        for (h = 0u; b->hist_dirty != 0u && h < DSYS_PERF_HIST_COUNT; ++h) {
+            u32 bucket;
+            if ((b->hist_dirty & ((u64)1u << h)) == 0u) {
+                continue;
+            }
+            for (bucket = 0u; bucket < DSYS_PERF_HIST_BUCKETS; ++bucket) {
+                g_perf_hist[h][bucket] += b->hist[h][bucket];
+                g_perf_hist_total[h] += b->hist[h][bucket];
+            }
+        }
+        dsys_perf_block_clear(b);
+    }
+}
+
 void dsys_perf_set_enabled(int enabled)
 {
     g_perf_enabled = enabled ? 1 : 0;
@@ -124,29 +354,72 @@ void dsys_perf_set_run_root(const char* path)
 
 void dsys_perf_reset(void)
 {
+    u32 count = dsys_perf_block_count();
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        memset(g_perf_blocks[i].op, 0, sizeof(g_perf_blocks[i].op));
+        memset(g_perf_blocks[i].value, 0, sizeof(g_perf_blocks[i].value));
+        memset(g_perf_blocks[i].hist, 0, sizeof(g_perf_blocks[i].hist));
+        g_perf_blocks[i].dirty = 0u;
+        g_perf_blocks[i].hist_dirty = 0u;
+    }
     memset(g_perf_current, 0, sizeof(g_perf_current));
     memset(g_perf_last, 0, sizeof(g_perf_last));
     memset(g_perf_max, 0, sizeof(g_perf_max));
     memset(g_perf_sum, 0, sizeof(g_perf_sum));
-    memset(g_perf_samples, 0, sizeof(g_perf_samples));
+    memset(g_perf_hist, 0, sizeof(g_perf_hist));
+    memset(g_perf_hist_total, 0, sizeof(g_perf_hist_total));
     g_perf_current_act = 0;
     g_perf_current_tick = 0u;
+    g_perf_sample_head = 0u;
     g_perf_sample_count = 0u;
-    g_perf_sample_overflow = 0u;
+    g_perf_sample_unsent = 0u;
+    g_perf_sample_total = 0u;
+    g_perf_sample_dropped = 0u;
 }
 
 void dsys_perf_tick_begin(dom_act_time_t act, u64 tick_index)
 {
+    u32 count;
+    u32 i;
     if (!g_perf_enabled) {
         return;
     }
     g_perf_current_act = act;
     g_perf_current_tick = tick_index;
     memset(g_perf_current, 0, sizeof(g_perf_current));
+    /* Counters recorded between ticks are discarded; histograms keep them. */
+    count = dsys_perf_block_count();
+    for (i = 0u; i < count; ++i) {
+        dsys_perf_thread_block* b = &g_perf_blocks[i];
+        if (b->dirty) {
+            memset(b->op, 0, sizeof(b->op));
+            memset(b->value, 0, sizeof(b->value));
+            b->dirty = 0u;
+        }
+    }
+}
+
+static void dsys_perf_emit_sample(const dsys_perf_sample* sample, const char* fixture, const char* tier,
+                                  FILE* fp, dsys_perf_sink_fn sink, void* sink_user);
+
+static void dsys_perf_sink_drain_count(u32 count)
+{
+    u32 i;
+    if (!g_perf_sink_fn) {
+        return;
+    }
+    for (i = 0u; i < count && g_perf_sample_unsent > 0u; ++i) {
+        u32 idx = (g_perf_sample_head + g_perf_sample_count - g_perf_sample_unsent) % DSYS_PERF_RING_SAMPLES;
+        dsys_perf_emit_sample(&g_perf_samples[idx], g_perf_sink_fixture, g_perf_sink_tier,
+                              NULL, g_perf_sink_fn, g_perf_sink_user);
+        g_perf_sample_unsent -= 1u;
+    }
 }
 
 void dsys_perf_tick_end(void)
 {
+    dsys_perf_sample* sample;
     u32 lane;
     u32 metric;
 
@@ -154,17 +427,26 @@ void dsys_perf_tick_end(void)
         return;
     }
 
-    if (g_perf_sample_count < DSYS_PERF_MAX_SAMPLES) {
-        dsys_perf_sample* sample = &g_perf_samples[g_perf_sample_count++];
-        sample->act = g_perf_current_act;
-        sample->tick_index = g_perf_current_tick;
-        memcpy(sample->values, g_perf_current, sizeof(g_perf_current));
-    } else {
-        g_perf_sample_overflow = 1u;
+    dsys_perf_merge_blocks();
+
+    if (g_perf_sample_count == DSYS_PERF_RING_SAMPLES) {
+        if (g_perf_sample_unsent == DSYS_PERF_RING_SAMPLES) {
+            g_perf_sample_unsent -= 1u;
+            g_perf_sample_dropped += 1u;
+        }
+        g_perf_sample_head = (g_perf_sample_head + 1u) % DSYS_PERF_RING_SAMPLES;
+        g_perf_sample_count -= 1u;
     }
+    sample = &g_perf_samples[(g_perf_sample_head + g_perf_sample_count) % DSYS_PERF_RING_SAMPLES];
+    g_perf_sample_count += 1u;
+    g_perf_sample_unsent += 1u;
+    g_perf_sample_total += 1u;
+    sample->act = g_perf_current_act;
+    sample->tick_index = g_perf_current_tick;
+    memcpy(sample->values, g_perf_current, sizeof(g_perf_current));
 
     for (lane = 0u; lane < DSYS_PERF_LANE_COUNT; ++lane) {
-        for (metric = 0u; metric < DSYS_PERF_METRIC_COUNT; ++metric) {
+        for (metric = 0u; metric < g_perf_metric_total; ++metric) {
             u64 value = g_perf_current[lane][metric];
             g_perf_last[lane][metric] = value;
             g_perf_sum[lane][metric] += value;
@@ -173,48 +455,102 @@ void dsys_perf_tick_end(void)
             }
         }
     }
+
+    if (g_perf_sink_fn && g_perf_sample_unsent >= DSYS_PERF_SINK_BATCH) {
+        dsys_perf_sink_drain_count(g_perf_sample_unsent);
+    }
 }
 
-void dsys_perf_metric_set(dsys_perf_lane lane, dsys_perf_metric metric, u64 value)
+int dsys_perf_metric_register(const char* name, u32 flags, dsys_perf_metric* out_metric)
 {
-    if (!g_perf_enabled) {
-        return;
+    u32 i;
+    size_t len;
+    if (!name || !name[0] || !out_metric) {
+        return -1;
     }
-    if ((u32)lane >= DSYS_PERF_LANE_COUNT || (u32)metric >= DSYS_PERF_METRIC_COUNT) {
-        return;
+    len = strlen(name);
+    if (len >= DSYS_PERF_MAX_NAME) {
+        return -1;
+    }
+    for (i = 0u; i < g_perf_metric_total; ++i) {
+        if (strcmp(dsys_perf_metric_name((dsys_perf_metric)i), name) == 0) {
+            break;
+        }
     }
-    g_perf_current[lane][metric] = value;
+    if (i == g_perf_metric_total) {
+        if (g_perf_metric_total >= DSYS_PERF_METRIC_CAPACITY) {
+            return -2;
+        }
+        memcpy(g_perf_dyn_names[i - DSYS_PERF_METRIC_COUNT], name, len + 1u);
+        g_perf_metric_total += 1u;
+    }
+    if ((flags & DSYS_PERF_METRIC_FLAG_TIMER) && g_perf_timer_slot[i] == 0u) {
+        if (g_perf_timer_count >= DSYS_PERF_MAX_TIMERS) {
+            return -2;
+        }
+        g_perf_timer_count += 1u;
+        g_perf_timer_slot[i] = (unsigned char)g_perf_timer_count;
+    }
+    *out_metric = (dsys_perf_metric)i;
+    return 0;
 }
 
-void dsys_perf_metric_add(dsys_perf_lane lane, dsys_perf_metric metric, u64 value)
+u32 dsys_perf_metric_total(void)
 {
-    if (!g_perf_enabled) {
-        return;
-    }
-    if ((u32)lane >= DSYS_PERF_LANE_COUNT || (u32)metric >= DSYS_PERF_METRIC_COUNT) {
-        return;
-    }
-    g_perf_current[lane][metric] += value;
+    return g_perf_metric_total;
 }
 
-void dsys_perf_metric_max(dsys_perf_lane lane, dsys_perf_metric metric, u64 value)
+static void dsys_perf_record(dsys_perf_lane lane, dsys_perf_metric metric, u64 value, u32 op)
 {
-    u64 current;
-    if (!g_perf_enabled) {
+    dsys_perf_thread_block* b;
+    unsigned char* slot_op;
+    u64* slot;
+    if (!g_perf_enabled || !dsys_perf_valid(lane, metric)) {
         return;
     }
-    if ((u32)lane >= DSYS_PERF_LANE_COUNT || (u32)metric >= DSYS_PERF_METRIC_COUNT) {
+    b = dsys_perf_block();
+    if (!b) {
         return;
     }
-    current = g_perf_current[lane][metric];
-    if (value > current) {
-        g_perf_current[lane][metric] = value;
+    slot_op = &b->op[lane][metric];
+    slot = &b->value[lane][metric];
+    if (op == DSYS_PERF_OP_SET) {
+        *slot = value;
+        *slot_op = DSYS_PERF_OP_SET;
+    } else if (op == DSYS_PERF_OP_ADD) {
+        *slot += value;
+        if (*slot_op == DSYS_PERF_OP_NONE || *slot_op == DSYS_PERF_OP_MAX) {
+            *slot_op = DSYS_PERF_OP_ADD;
+        }
+    } else {
+        if (value > *slot) {
+            *slot = value;
+        }
+        if (*slot_op == DSYS_PERF_OP_NONE) {
+            *slot_op = DSYS_PERF_OP_MAX;
+        }
     }
+    b->dirty = 1u;
+}
+
+void dsys_perf_metric_set(dsys_perf_lane lane, dsys_perf_metric metric, u64 value)
+{
+    dsys_perf_record(lane, metric, value, DSYS_PERF_OP_SET);
+}
+
+void dsys_perf_metric_add(dsys_perf_lane lane, dsys_perf_metric metric, u64 value)
+{
+    dsys_perf_record(lane, metric, value, DSYS_PERF_OP_ADD);
+}
+
+void dsys_perf_metric_max(dsys_perf_lane lane, dsys_perf_metric metric, u64 value)
+{
+    dsys_perf_record(lane, metric, value, DSYS_PERF_OP_MAX);
 }
 
 u64 dsys_perf_metric_last(dsys_perf_lane lane, dsys_perf_metric metric)
 {
-    if ((u32)lane >= DSYS_PERF_LANE_COUNT || (u32)metric >= DSYS_PERF_METRIC_COUNT) {
+    if (!dsys_perf_valid(lane, metric)) {
         return 0u;
     }
     return g_perf_last[lane][metric];
@@ -222,7 +558,7 @@ u64 dsys_perf_metric_last(dsys_perf_lane lane, dsys_perf_metric metric)
 
 u64 dsys_perf_metric_max_seen(dsys_perf_lane lane, dsys_perf_metric metric)
 {
-    if ((u32)lane >= DSYS_PERF_LANE_COUNT || (u32)metric >= DSYS_PERF_METRIC_COUNT) {
+    if (!dsys_perf_valid(lane, metric)) {
         return 0u;
     }
     return g_perf_max[lane][metric];
@@ -254,16 +590,82 @@ void dsys_perf_timer_end(dsys_perf_timer* timer)
     }
     end_us = dsys_perf_clock_now();
     if (end_us >= timer->start_us) {
-        dsys_perf_metric_add(timer->lane, timer->metric, end_us - timer->start_us);
+        dsys_perf_timer_record(timer->lane, timer->metric, end_us - timer->start_us);
     }
     timer->active = 0;
 }
 
+void dsys_perf_timer_record(dsys_perf_lane lane, dsys_perf_metric metric, u64 elapsed_us)
+{
+    dsys_perf_thread_block* b;
+    u32 h;
+    if (!g_perf_enabled || !dsys_perf_valid(lane, metric)) {
+        return;
+    }
+    dsys_perf_record(lane, metric, elapsed_us, DSYS_PERF_OP_ADD);
+    if (g_perf_timer_slot[metric] == 0u) {
+        return;
+    }
+    b = dsys_perf_block();
+    if (!b) {
+        return;
+    }
+    h = ((u32)(g_perf_timer_slot[metric] - 1u) * DSYS_PERF_LANE_COUNT) + (u32)lane;
+    b->hist[h][dsys_perf_hist_bucket(elapsed_us)] += 1u;
+    b->hist_dirty |= (u64)1u << h;
+}
+
+static int dsys_perf_hist_index(dsys_perf_lane lane, dsys_perf_metric metric, u32* out_h)
+{
+    if (!dsys_perf_valid(lane, metric) || g_perf_timer_slot[metric] == 0u) {
+        return 0;
+    }
+    *out_h = ((u32)(g_perf_timer_slot[metric] - 1u) * DSYS_PERF_LANE_COUNT) + (u32)lane;
+    return 1;
+}
+
+u64 dsys_perf_timer_percentile(dsys_perf_lane lane, dsys_perf_metric metric, u32 ppm)
+{
+    u64 rank;
+    u64 seen = 0u;
+    u32 h;
+    u32 bucket;
+    if (!dsys_perf_hist_index(lane, metric, &h) || g_perf_hist_total[h] == 0u) {
+        return 0u;
+    }
+    if (ppm > 1000000u) {
+        ppm = 1000000u;
+    }
+    rank = (g_perf_hist_total[h] * (u64)ppm + 999999u) / 1000000u;
+    if (rank == 0u) {
+        rank = 1u;
+    }
+    for (bucket = 0u; bucket < DSYS_PERF_HIST_BUCKETS; ++bucket) {
+        seen += g_perf_hist[h][bucket];
+        if (seen >= rank) {
+            return dsys_perf_hist_upper(bucket);
+        }
+    }
+    return dsys_perf_hist_upper(DSYS_PERF_HIST_BUCKETS - 1u);
+}
+
+u64 dsys_perf_timer_count(dsys_perf_lane lane, dsys_perf_metric metric)
+{
+    u32 h;
+    if (!dsys_perf_hist_index(lane, metric, &h)) {
+        return 0u;
+    }
+    return g_perf_hist_total[h];
+}
+
 const char* dsys_perf_metric_name(dsys_perf_metric metric)
 {
-    if ((u32)metric >= DSYS_PERF_METRIC_COUNT) {
+    if ((u32)metric >= g_perf_metric_total) {
         return "unknown";
     }
+    if ((u32)metric >= DSYS_PERF_METRIC_COUNT) {
+        return g_perf_dyn_names[(u32)metric - DSYS_PERF_METRIC_COUNT];
+    }
     return g_metric_names[metric];
 }
 
@@ -275,6 +677,52 @@ const char* dsys_perf_lane_name(dsys_perf_lane lane)
     return g_lane_names[lane];
 }
 
+static void dsys_perf_copy_label(char* dst, const char* src)
+{
+    dst[0] = '\0';
+    if (src) {
+        strncpy(dst, src, DSYS_PERF_MAX_NAME - 1u);
+        dst[DSYS_PERF_MAX_NAME - 1u] = '\0';
+    }
+}
+
+void dsys_perf_set_sink(dsys_perf_sink_fn fn, void* user, const char* fixture, const char* tier)
+{
+    dsys_perf_sink_drain();
+    g_perf_sink_fn = fn;
+    g_perf_sink_user = user;
+    dsys_perf_copy_label(g_perf_sink_fixture, fixture);
+    dsys_perf_copy_label(g_perf_sink_tier, tier);
+    /* Samples already in the ring predate the sink. */
+    g_perf_sample_unsent = 0u;
+}
+
+void dsys_perf_sink_drain(void)
+{
+    dsys_perf_sink_drain_count(g_perf_sample_unsent);
+}
+
+u64 dsys_perf_samples_dropped(void)
+{
+    return g_perf_sample_dropped;
+}
+
+void dsys_perf_thread_release(void)
+{
+    dsys_perf_thread_block* b = t_perf_block;
+    if (!b) {
+        return;
+    }
+    t_perf_block = NULL;
+    (void)DSYS_PERF_ATOMIC_CAS(&b->owned, DSYS_PERF_BLOCK_OWNED, DSYS_PERF_BLOCK_RELEASED);
+    (void)DSYS_PERF_ATOMIC_INC(&g_perf_block_releases);
+}
+
+u32 dsys_perf_threads_denied(void)
+{
+    return (u32)g_perf_threads_denied;
+}
+
 static void dsys_perf_mkdir(const char* path)
 {
     if (!path || !path[0]) {
@@ -466,7 +914,7 @@ static int dsys_perf_build_report_path(
 
 static void dsys_perf_write_json_u64(FILE* fp, const char* key, u64 value, int comma)
 {
-    char line[160];
+    char line[256];
     size_t pos = 0u;
     if (!fp || !key) {
         return;
@@ -505,58 +953,97 @@ static void dsys_perf_write_json_str(FILE* fp, const char* key, const char* valu
     fputs(line, fp);
 }
 
-static void dsys_perf_write_telemetry(FILE* fp, const char* fixture, const char* tier)
+static void dsys_perf_emit_sample(const dsys_perf_sample* sample, const char* fixture, const char* tier,
+                                  FILE* fp, dsys_perf_sink_fn sink, void* sink_user)
 {
-    u32 s;
     u32 lane;
     u32 metric;
-    char line[2048];
+    char line[8192];
+
+    for (lane = 0u; lane < DSYS_PERF_LANE_COUNT; ++lane) {
+        size_t pos = 0u;
+        line[0] = '\0';
+        pos = dsys_perf_append(line, sizeof(line), pos, "{\"tick\":");
+        pos = dsys_perf_append_u64(line, sizeof(line), pos, sample->tick_index);
+        pos = dsys_perf_append(line, sizeof(line), pos, ",\"act\":");
+        pos = dsys_perf_append_i64(line, sizeof(line), pos, (i64)sample->act);
+        pos = dsys_perf_append(line, sizeof(line), pos, ",\"lane\":\"");
+        pos = dsys_perf_append(line, sizeof(line), pos, dsys_perf_lane_name((dsys_perf_lane)lane));
+        pos = dsys_perf_append(line, sizeof(line), pos, "\"");
+        if (fixture && fixture[0]) {
+            pos = dsys_perf_append(line, sizeof(line), pos, ",\"fixture\":\"");
+            pos = dsys_perf_append(line, sizeof(line), pos, fixture);
+            pos = dsys_perf_append(line, sizeof(line), pos, "\"");
+        }
+        if (tier && tier[0]) {
+            pos = dsys_perf_append(line, sizeof(line), pos, ",\"tier\":\"");
+            pos = dsys_perf_append(line, sizeof(line), pos, tier);
+            pos = dsys_perf_append(line, sizeof(line), pos, "\"");
+        }
+        for (metric = 0u; metric < g_perf_metric_total; ++metric) {
+            pos = dsys_perf_append(line, sizeof(line), pos, ",\"");
+            pos = dsys_perf_append(line, sizeof(line), pos, dsys_perf_metric_name((dsys_perf_metric)metric));
+            pos = dsys_perf_append(line, sizeof(line), pos, "\":");
+            pos = dsys_perf_append_u64(line, sizeof(line), pos, sample->values[lane][metric]);
+        }
+        pos = dsys_perf_append_char(line, sizeof(line), pos, '}');
+        pos = dsys_perf_append_char(line, sizeof(line), pos, '\n');
+        if (fp) {
+            fputs(line, fp);
+        }
+        if (sink) {
+            sink(sink_user, line, (u32)pos);
+        }
+    }
+}
+
+static void dsys_perf_write_telemetry(FILE* fp, const char* fixture, const char* tier)
+{
+    u32 s;
 
     if (!fp) {
         return;
     }
 
     for (s = 0u; s < g_perf_sample_count; ++s) {
-        const dsys_perf_sample* sample = &g_perf_samples[s];
-        for (lane = 0u; lane < DSYS_PERF_LANE_COUNT; ++lane) {
-            size_t pos = 0u;
-            line[0] = '\0';
-            pos = dsys_perf_append(line, sizeof(line), pos, "{\"tick\":");
-            pos = dsys_perf_append_u64(line, sizeof(line), pos, sample->tick_index);
-            pos = dsys_perf_append(line, sizeof(line), pos, ",\"act\":");
-            pos = dsys_perf_append_i64(line, sizeof(line), pos, (i64)sample->act);
-            pos = dsys_perf_append(line, sizeof(line), pos, ",\"lane\":\"");
-            pos = dsys_perf_append(line, sizeof(line), pos, dsys_perf_lane_name((dsys_perf_lane)lane));
-            pos = dsys_perf_append(line, sizeof(line), pos, "\"");
-            if (fixture && fixture[0]) {
-                pos = dsys_perf_append(line, sizeof(line), pos, ",\"fixture\":\"");
-                pos = dsys_perf_append(line, sizeof(line), pos, fixture);
-                pos = dsys_perf_append(line, sizeof(line), pos, "\"");
-            }
-            if (tier && tier[0]) {
-                pos = dsys_perf_append(line, sizeof(line), pos, ",\"tier\":\"");
-                pos = dsys_perf_append(line, sizeof(line), pos, tier);
-                pos = dsys_perf_append(line, sizeof(line), pos, "\"");
-            }
-            for (metric = 0u; metric < DSYS_PERF_METRIC_COUNT; ++metric) {
-                pos = dsys_perf_append(line, sizeof(line), pos, ",\"");
-                pos = dsys_perf_append(line, sizeof(line), pos, dsys_perf_metric_name((dsys_perf_metric)metric));
-                pos = dsys_perf_append(line, sizeof(line), pos, "\":");
-                pos = dsys_perf_append_u64(line, sizeof(line), pos, sample->values[lane][metric]);
-            }
-            pos = dsys_perf_append_char(line, sizeof(line), pos, '}');
-            pos = dsys_perf_append_char(line, sizeof(line), pos, '\n');
-            (void)pos;
-            fputs(line, fp);
-        }
+        const dsys_perf_sample* sample = &g_perf_samples[(g_perf_sample_head + s) % DSYS_PERF_RING_SAMPLES];
+        dsys_perf_emit_sample(sample, fixture, tier, fp, NULL, NULL);
     }
 }
 
+/* Holds back one metric line so the last one is written without a comma. */
+typedef struct dsys_perf_report_writer {
+    FILE* fp;
+    char key[160];
+    u64 value;
+    int pending;
+} dsys_perf_report_writer;
+
+static void dsys_perf_report_metric(dsys_perf_report_writer* w, const char* lane, const char* metric,
+                                    const char* suffix, u64 value)
+{
+    size_t pos = 0u;
+    if (w->pending) {
+        dsys_perf_write_json_u64(w->fp, w->key, w->value, 1);
+    }
+    w->key[0] = '\0';
+    pos = dsys_perf_append(w->key, sizeof(w->key), pos, lane);
+    pos = dsys_perf_append_char(w->key, sizeof(w->key), pos, '_');
+    pos = dsys_perf_append(w->key, sizeof(w->key), pos, metric);
+    pos = dsys_perf_append(w->key, sizeof(w->key), pos, suffix);
+    (void)pos;
+    w->value = value;
+    w->pending = 1;
+}
+
 static void dsys_perf_write_budget_report(FILE* fp, const char* fixture, const char* tier)
 {
+    static const u32 k_ppm[3] = { 500000u, 990000u, 999000u };
+    static const char* k_ppm_suffix[3] = { "_p50", "_p99", "_p999" };
+    dsys_perf_report_writer writer;
     u32 lane;
     u32 metric;
-    char key[DSYS_PERF_MAX_NAME];
+    u32 q;
 
     if (!fp) {
         return;
@@ -566,27 +1053,36 @@ static void dsys_perf_write_budget_report(FILE* fp, const char* fixture, const c
     dsys_perf_write_json_str(fp, "check_id", "PERF-BUDGET-002", 1);
     dsys_perf_write_json_str(fp, "fixture", fixture ? fixture : "unknown", 1);
     dsys_perf_write_json_str(fp, "tier", tier ? tier : "unknown", 1);
-    dsys_perf_write_json_u64(fp, "samples", g_perf_sample_count, 1);
-    dsys_perf_write_json_u64(fp, "overflow", g_perf_sample_overflow, 1);
+    dsys_perf_write_json_u64(fp, "samples", g_perf_sample_total, 1);
+    dsys_perf_write_json_u64(fp, "overflow", g_perf_sample_dropped, 1);
+    dsys_perf_write_json_u64(fp, "threads_unrecorded", (u64)dsys_perf_threads_denied(), 1);
     fputs("  \"metrics\": {\n", fp);
 
+    memset(&writer, 0, sizeof(writer));
+    writer.fp = fp;
     for (lane = 0u; lane < DSYS_PERF_LANE_COUNT; ++lane) {
-        for (metric = 0u; metric < DSYS_PERF_METRIC_COUNT; ++metric) {
-            size_t pos = 0u;
-            key[0] = '\0';
-            pos = dsys_perf_append(key, sizeof(key), pos, dsys_perf_lane_name((dsys_perf_lane)lane));
-            pos = dsys_perf_append_char(key, sizeof(key), pos, '_');
-            pos = dsys_perf_append(key, sizeof(key), pos, dsys_perf_metric_name((dsys_perf_metric)metric));
-            pos = dsys_perf_append(key, sizeof(key), pos, "_max");
-            (void)pos;
-            dsys_perf_write_json_u64(
-                fp,
-                key,
-                g_perf_max[lane][metric],
-                (lane != (DSYS_PERF_LANE_COUNT - 1u) || metric != (DSYS_PERF_METRIC_COUNT - 1u))
-            );
+        for (metric = 0u; metric < g_perf_metric_total; ++metric) {
+            dsys_perf_report_metric(&writer, dsys_perf_lane_name((dsys_perf_lane)lane),
+                                    dsys_perf_metric_name((dsys_perf_metric)metric), "_max",
+                                    g_perf_max[lane][metric]);
         }
     }
+    for (lane = 0u; lane < DSYS_PERF_LANE_COUNT; ++lane) {
+        for (metric = 0u; metric < g_perf_metric_total; ++metric) {
+            if (dsys_perf_timer_count((dsys_perf_lane)lane, (dsys_perf_metric)metric) == 0u) {
+                continue;
+            }
+            for (q = 0u; q < 3u; ++q) {
+                dsys_perf_report_metric(&writer, dsys_perf_lane_name((dsys_perf_lane)lane),
+                                        dsys_perf_metric_name((dsys_perf_metric)metric), k_ppm_suffix[q],
+                                        dsys_perf_timer_percentile((dsys_perf_lane)lane,
+                                                                   (dsys_perf_metric)metric, k_ppm[q]));
+            }
+        }
+    }
+    if (writer.pending) {
+        dsys_perf_write_json_u64(fp, writer.key, writer.value, 0);
+    }
 
     fputs("  }\n", fp);
     fputs("}\n", fp);
@@ -608,6 +1104,7 @@ int dsys_perf_flush(const dsys_perf_flush_desc* desc)
         return -1;
     }
 
+    dsys_perf_sink_drain();
     root = dsys_perf_get_run_root(desc);
     fixture = desc->fixture && desc->fixture[0] ? desc->fixture : "unknown";
     tier = desc->tier && desc->tier[0] ? desc->tier : "unknown";
@@ -23,8 +23,8 @@ EXTENSION POINTS: Replace stubs with real platform backends behind same contract
 #if defined(_WIN32)
 #include <windows.h>
 #else
-#include <select.h>
-#include <time.h>
+#include <sys/select.h>
+#include <sys/time.h>
 #include <unistd.h>
 #endif
 
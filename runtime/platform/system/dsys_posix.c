@@ -20,8 +20,8 @@ EXTENSION POINTS: Replace with windowed POSIX backends (X11/Wayland) behind same
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <select.h>
-#include <time.h>
+#include <sys/select.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 static dsys_caps dsys_posix_get_caps(void)
@@ -23,8 +23,8 @@ EXTENSION POINTS: Replace with real SDL2 backend behind same contract.
 #if defined(_WIN32)
 #include <windows.h>
 #else
-#include <select.h>
-#include <time.h>
+#include <sys/select.h>
+#include <sys/time.h>
 #include <unistd.h>
 #endif
 
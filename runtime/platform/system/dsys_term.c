@@ -20,9 +20,9 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 
 #include <unistd.h>
 #include <termios.h>
-#include <ioctl.h>
-#include <time.h>
-#include <select.h>
+#include <sys/ioctl.h>
+#include <sys/time.h>
+#include <sys/select.h>
 
 static struct termios g_dsys_term_orig;
 static int g_dsys_term_active = 0;
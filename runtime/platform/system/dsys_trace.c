@@ -0,0 +1,458 @@
+/*
+FILE: source/domino/system/dsys_trace.c
+MODULE: Domino
+LAYER / SUBSYSTEM: Domino impl / system/dsys_trace
+RESPONSIBILITY: Implements the span tracer and Chrome trace export.
+ALLOWED DEPENDENCIES: `include/domino/**`, `source/domino/**`, and C89 headers.
+FORBIDDEN DEPENDENCIES: `include/dominium/**`, `source/dominium/**`.
+THREADING MODEL: Each thread appends to its own ring; dumps read the rings while recording threads are quiescent.
+ERROR MODEL: Return codes; no exceptions.
+DETERMINISM: Tracing is non-authoritative and must not influence simulation.
+*/
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "domino/system/dsys_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define DSYS_TRACE_MAX_THREADS 64u
+#define DSYS_TRACE_MAX_PATH 260u
+#define DSYS_TRACE_OUT_CHUNK 4096u
+
+#define DSYS_TRACE_PH_BEGIN 0u
+#define DSYS_TRACE_PH_END 1u
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define DSYS_TRACE_TLS __declspec(thread)
+#define DSYS_TRACE_ATOMIC_INC(p) ((long)_InterlockedIncrement((volatile long*)(p)))
+#elif defined(__GNUC__) || defined(__clang__)
+#define DSYS_TRACE_TLS __thread
+#define DSYS_TRACE_ATOMIC_INC(p) (__sync_add_and_fetch((p), 1L))
+#else
+/* No TLS: all recording shares ring 0 and must be serialized. */
+#define DSYS_TRACE_TLS
+#define DSYS_TRACE_ATOMIC_INC(p) (++(*(p)))
+#endif
+
+typedef struct dsys_trace_record {
+    u64 ts_ns;
+    const char* name;
+    u64 arg;
+    u32 phase;
+} dsys_trace_record;
+
+/* Written only by the owning thread; `count` is the total ever appended. */
+typedef struct dsys_trace_ring {
+    dsys_trace_record* records;
+    u32 mask;
+    u64 count;
+} dsys_trace_ring;
+
+typedef struct dsys_trace_out {
+    dsys_trace_write_fn fn;
+    void* user;
+    char buf[DSYS_TRACE_OUT_CHUNK];
+    u32 len;
+} dsys_trace_out;
+
+volatile int g_dsys_trace_enabled = 0;
+
+static dsys_trace_clock_fn g_trace_clock_fn = NULL;
+static void* g_trace_clock_user = NULL;
+static u32 g_trace_capacity = DSYS_TRACE_DEFAULT_RECORDS;
+
+static dsys_trace_ring g_trace_rings[DSYS_TRACE_MAX_THREADS];
+static volatile long g_trace_ring_count = 0;
+static DSYS_TRACE_TLS dsys_trace_ring* t_trace_ring = NULL;
+static DSYS_TRACE_TLS int t_trace_ring_denied = 0;
+
+static u64 g_trace_budget_us = 0u;
+static char g_trace_dump_prefix[DSYS_TRACE_MAX_PATH];
+static u32 g_trace_dumps_left = 0u;
+static u32 g_trace_tick_depth = 0u;
+static u64 g_trace_tick_index = 0u;
+static u64 g_trace_tick_start_ns = 0u;
+
+static u64 dsys_trace_default_clock(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (u64)((double)now.QuadPart * (1000000000.0 / (double)freq.QuadPart));
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ull + (u64)ts.tv_nsec;
+#endif
+}
+
+static u64 dsys_trace_now(void)
+{
+    if (g_trace_clock_fn) {
+        return g_trace_clock_fn(g_trace_clock_user);
+    }
+    return dsys_trace_default_clock();
+}
+
+static u32 dsys_trace_ring_count(void)
+{
+    long count = g_trace_ring_count;
+    if (count < 0) {
+        return 0u;
+    }
+    return ((u32)count < DSYS_TRACE_MAX_THREADS) ? (u32)count : DSYS_TRACE_MAX_THREADS;
+}
+
+/* Claims and allocates this thread's ring on its first span. Threads beyond
+ * DSYS_TRACE_MAX_THREADS, or whose allocation fails, record nothing. */
+static dsys_trace_ring* dsys_trace_ring_get(void)
+{
+    dsys_trace_ring* ring;
+    long idx;
+    if (t_trace_ring) {
+        return t_trace_ring;
+    }
+    if (t_trace_ring_denied) {
+        return NULL;
+    }
+    idx = DSYS_TRACE_ATOMIC_INC(&g_trace_ring_count) - 1L;
+    if (idx < 0 || (u32)idx >= DSYS_TRACE_MAX_THREADS) {
+        t_trace_ring_denied = 1;
+        return NULL;
+    }
+    ring = &g_trace_rings[idx];
+    ring->records = (dsys_trace_record*)malloc(sizeof(dsys_trace_record) * (size_t)g_trace_capacity);
+    ring->mask = ring->records ? (g_trace_capacity - 1u) : 0u;
+    ring->count = 0u;
+    if (!ring->records) {
+        t_trace_ring_denied = 1;
+        return NULL;
+    }
+    t_trace_ring = ring;
+    return ring;
+}
+
+static void dsys_trace_push(const char* name, u64 arg, u32 phase)
+{
+    dsys_trace_ring* ring = dsys_trace_ring_get();
+    dsys_trace_record* rec;
+    if (!ring) {
+        return;
+    }
+    rec = &ring->records[(u32)ring->count & ring->mask];
+    rec->ts_ns = dsys_trace_now();
+    rec->name = name;
+    rec->arg = arg;
+    rec->phase = phase;
+    ring->count += 1u;
+}
+
+void dsys_trace_set_enabled(int enabled)
+{
+    g_dsys_trace_enabled = enabled ? 1 : 0;
+}
+
+int dsys_trace_is_enabled(void)
+{
+    return g_dsys_trace_enabled ? 1 : 0;
+}
+
+int dsys_trace_configure(u32 records_per_thread)
+{
+    u32 cap = 16u;
+    if (g_dsys_trace_enabled) {
+        return -1;
+    }
+    while (cap < records_per_thread && cap < 0x80000000u) {
+        cap <<= 1;
+    }
+    g_trace_capacity = cap;
+    return 0;
+}
+
+void dsys_trace_set_clock(dsys_trace_clock_fn fn, void* user)
+{
+    g_trace_clock_fn = fn;
+    g_trace_clock_user = user;
+}
+
+void dsys_trace_begin(const char* name, u64 arg)
+{
+    if (!g_dsys_trace_enabled || !name) {
+        return;
+    }
+    dsys_trace_push(name, arg, DSYS_TRACE_PH_BEGIN);
+}
+
+void dsys_trace_end(const char* name)
+{
+    if (!g_dsys_trace_enabled || !name) {
+        return;
+    }
+    dsys_trace_push(name, 0u, DSYS_TRACE_PH_END);
+}
+
+void dsys_trace_reset(void)
+{
+    u32 count = dsys_trace_ring_count();
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        g_trace_rings[i].count = 0u;
+    }
+    g_trace_tick_depth = 0u;
+}
+
+u64 dsys_trace_dropped(void)
+{
+    u32 count = dsys_trace_ring_count();
+    u64 dropped = 0u;
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        const dsys_trace_ring* ring = &g_trace_rings[i];
+        if (ring->records && ring->count > (u64)ring->mask + 1u) {
+            dropped += ring->count - ((u64)ring->mask + 1u);
+        }
+    }
+    return dropped;
+}
+
+static void dsys_trace_out_flush(dsys_trace_out* out)
+{
+    if (out->len > 0u) {
+        out->fn(out->user, out->buf, out->len);
+        out->len = 0u;
+    }
+}
+
+static void dsys_trace_out_str(dsys_trace_out* out, const char* s)
+{
+    while (*s) {
+        if (out->len == DSYS_TRACE_OUT_CHUNK) {
+            dsys_trace_out_flush(out);
+        }
+        out->buf[out->len++] = *s++;
+    }
+}
+
+/* Names are identifiers; anything that would break the JSON string is replaced. */
+static void dsys_trace_out_name(dsys_trace_out* out, const char* s)
+{
+    char ch[2];
+    ch[1] = '\0';
+    while (*s) {
+        unsigned char c = (unsigned char)*s++;
+        ch[0] = (c < 0x20u || c == '"' || c == '\\' || c >= 0x7Fu) ? '_' : (char)c;
+        dsys_trace_out_str(out, ch);
+    }
+}
+
+/* Decimal digits of value, written to the tail of tmp. */
+static const char* dsys_trace_u64_text(char tmp[24], u64 value)
+{
+    u32 pos = 23u;
+    tmp[pos] = '\0';
+    do {
+        tmp[--pos] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while (value > 0u);
+    return &tmp[pos];
+}
+
+static void dsys_trace_out_u64(dsys_trace_out* out, u64 value)
+{
+    char tmp[24];
+    dsys_trace_out_str(out, dsys_trace_u64_text(tmp, value));
+}
+
+/* Microseconds with nanosecond fraction, as Chrome expects for "ts". */
+static void dsys_trace_out_ts(dsys_trace_out* out, u64 ns)
+{
+    char frac[5];
+    u32 rem = (u32)(ns % 1000u);
+    dsys_trace_out_u64(out, ns / 1000u);
+    frac[0] = '.';
+    frac[1] = (char)('0' + rem / 100u);
+    frac[2] = (char)('0' + (rem / 10u) % 10u);
+    frac[3] = (char)('0' + rem % 10u);
+    frac[4] = '\0';
+    dsys_trace_out_str(out, frac);
+}
+
+static void dsys_trace_out_event_head(dsys_trace_out* out, int* first, const char* name,
+                                      const char* ph, u32 tid)
+{
+    dsys_trace_out_str(out, *first ? "\n" : ",\n");
+    *first = 0;
+    dsys_trace_out_str(out, "{\"name\":\"");
+    dsys_trace_out_name(out, name);
+    dsys_trace_out_str(out, "\",\"ph\":\"");
+    dsys_trace_out_str(out, ph);
+    dsys_trace_out_str(out, "\",\"pid\":1,\"tid\":");
+    dsys_trace_out_u64(out, (u64)tid);
+}
+
+int dsys_trace_write_chrome(dsys_trace_write_fn fn, void* user)
+{
+    dsys_trace_out* out;
+    u32 ring_count = dsys_trace_ring_count();
+    u64 base = ~(u64)0u;
+    int first = 1;
+    u32 r;
+    if (!fn) {
+        return -1;
+    }
+    out = (dsys_trace_out*)malloc(sizeof(dsys_trace_out));
+    if (!out) {
+        return -2;
+    }
+    out->fn = fn;
+    out->user = user;
+    out->len = 0u;
+
+    /* Timestamps are relative to the oldest retained record. */
+    for (r = 0u; r < ring_count; ++r) {
+        const dsys_trace_ring* ring = &g_trace_rings[r];
+        u64 cap = (u64)ring->mask + 1u;
+        if (ring->records && ring->count > 0u) {
+            u64 start = (ring->count > cap) ? ring->count - cap : 0u;
+            u64 ts = ring->records[(u32)start & ring->mask].ts_ns;
+            if (ts < base) {
+                base = ts;
+            }
+        }
+    }
+
+    dsys_trace_out_str(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (r = 0u; r < ring_count; ++r) {
+        const dsys_trace_ring* ring = &g_trace_rings[r];
+        u64 cap = (u64)ring->mask + 1u;
+        u64 i;
+        u32 depth = 0u;
+        if (!ring->records || ring->count == 0u) {
+            continue;
+        }
+        dsys_trace_out_event_head(out, &first, "thread_name", "M", r);
+        dsys_trace_out_str(out, ",\"args\":{\"name\":\"");
+        dsys_trace_out_str(out, "thread ");
+        dsys_trace_out_u64(out, (u64)r);
+        dsys_trace_out_str(out, "\"}}");
+        for (i = (ring->count > cap) ? ring->count - cap : 0u; i < ring->count; ++i) {
+            const dsys_trace_record* rec = &ring->records[(u32)i & ring->mask];
+            if (rec->phase == DSYS_TRACE_PH_END) {
+                /* Its begin was overwritten. */
+                if (depth == 0u) {
+                    continue;
+                }
+                depth -= 1u;
+            } else {
+                depth += 1u;
+            }
+            dsys_trace_out_event_head(out, &first, rec->name,
+                                      (rec->phase == DSYS_TRACE_PH_END) ? "E" : "B", r);
+            dsys_trace_out_str(out, ",\"ts\":");
+            dsys_trace_out_ts(out, rec->ts_ns - base);
+            if (rec->phase == DSYS_TRACE_PH_BEGIN) {
+                dsys_trace_out_str(out, ",\"args\":{\"arg\":");
+                dsys_trace_out_u64(out, rec->arg);
+                dsys_trace_out_str(out, "}");
+            }
+            dsys_trace_out_str(out, "}");
+        }
+    }
+    dsys_trace_out_str(out, "\n]}\n");
+    dsys_trace_out_flush(out);
+    free(out);
+    return 0;
+}
+
+static void dsys_trace_file_write(void* user, const char* data, u32 length)
+{
+    (void)fwrite(data, 1u, (size_t)length, (FILE*)user);
+}
+
+int dsys_trace_dump_chrome(const char* path)
+{
+    FILE* fp;
+    int rc;
+    if (!path || !path[0]) {
+        return -1;
+    }
+    fp = fopen(path, "wb");
+    if (!fp) {
+        return -3;
+    }
+    rc = dsys_trace_write_chrome(dsys_trace_file_write, fp);
+    if (fclose(fp) != 0 && rc == 0) {
+        rc = -4;
+    }
+    return rc;
+}
+
+void dsys_trace_set_overrun_dump(u64 budget_us, const char* path_prefix, u32 max_dumps)
+{
+    g_trace_budget_us = budget_us;
+    g_trace_dump_prefix[0] = '\0';
+    if (path_prefix) {
+        strncpy(g_trace_dump_prefix, path_prefix, DSYS_TRACE_MAX_PATH - 1u);
+        g_trace_dump_prefix[DSYS_TRACE_MAX_PATH - 1u] = '\0';
+    }
+    g_trace_dumps_left = max_dumps;
+}
+
+void dsys_trace_tick_begin(u64 tick_index)
+{
+    if (!g_dsys_trace_enabled) {
+        return;
+    }
+    if (g_trace_tick_depth == 0u) {
+        g_trace_tick_index = tick_index;
+        g_trace_tick_start_ns = dsys_trace_now();
+    }
+    g_trace_tick_depth += 1u;
+    dsys_trace_push("tick", tick_index, DSYS_TRACE_PH_BEGIN);
+}
+
+int dsys_trace_tick_end(void)
+{
+    char path[DSYS_TRACE_MAX_PATH + 32u];
+    char digits[24];
+    u64 elapsed_ns;
+    if (g_trace_tick_depth == 0u) {
+        return 0;
+    }
+    /* Unwind even when tracing was turned off mid-tick, or later ticks
+     * would never be outermost again. */
+    g_trace_tick_depth -= 1u;
+    if (!g_dsys_trace_enabled) {
+        return 0;
+    }
+    dsys_trace_push("tick", 0u, DSYS_TRACE_PH_END);
+    if (g_trace_tick_depth != 0u || g_trace_budget_us == 0u ||
+        g_trace_dumps_left == 0u || !g_trace_dump_prefix[0]) {
+        return 0;
+    }
+    elapsed_ns = dsys_trace_now() - g_trace_tick_start_ns;
+    if (elapsed_ns <= g_trace_budget_us * 1000u) {
+        return 0;
+    }
+    sprintf(path, "%s_%s.json", g_trace_dump_prefix, dsys_trace_u64_text(digits, g_trace_tick_index));
+    if (dsys_trace_dump_chrome(path) != 0) {
+        return 0;
+    }
+    g_trace_dumps_left -= 1u;
+    return 1;
+}
@@ -22,13 +22,20 @@ EXTENSION POINTS: Extend via public headers and relevant `docs/reference/specs/S
 #include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
-#include <time.h>
+#include <sys/time.h>
 #include <ctype.h>
 #include <signal.h>
 
 #if defined(_WIN32)
 #include <windows.h>
 #endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DSYS_HAS_FILE_MAP 1
+#endif
 
 static const dsys_caps g_null_caps = {
     "null",
@@ -1649,6 +1656,80 @@ int dsys_file_close(void* fh)
     return -1;
 }
 
+typedef struct dsys_file_mapping {
+    void*  base;
+    size_t size;
+} dsys_file_mapping;
+
+void* dsys_file_map(const char* path, const void** out_data, size_t* out_size)
+{
+#if defined(DSYS_HAS_FILE_MAP)
+    dsys_file_mapping* map;
+    struct stat st;
+    void* base;
+    int fd;
+#endif
+    if (out_data) {
+        *out_data = NULL;
+    }
+    if (out_size) {
+        *out_size = 0u;
+    }
+    if (!path || !out_data || !out_size) {
+        return NULL;
+    }
+    if (dsys_guard_io_blocked("file_map", path, NULL, 0u)) {
+        return NULL;
+    }
+#if defined(DSYS_HAS_FILE_MAP)
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        dsys_set_last_error(DSYS_ERR_NOT_FOUND, "file_map: open failed");
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (unsigned long long)st.st_size > (unsigned long long)((size_t)-1)) {
+        close(fd);
+        dsys_set_last_error(DSYS_ERR_IO, "file_map: not a mappable file");
+        return NULL;
+    }
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    /* The mapping keeps its own reference to the file. */
+    close(fd);
+    if (base == MAP_FAILED) {
+        dsys_set_last_error(DSYS_ERR_IO, "file_map: mmap failed");
+        return NULL;
+    }
+    map = (dsys_file_mapping*)malloc(sizeof(*map));
+    if (!map) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    map->base = base;
+    map->size = (size_t)st.st_size;
+    *out_data = base;
+    *out_size = map->size;
+    return map;
+#else
+    dsys_set_last_error(DSYS_ERR_UNSUPPORTED, "file_map: unsupported");
+    return NULL;
+#endif
+}
+
+void dsys_file_unmap(void* map)
+{
+#if defined(DSYS_HAS_FILE_MAP)
+    dsys_file_mapping* m = (dsys_file_mapping*)map;
+    if (!m) {
+        return;
+    }
+    munmap(m->base, m->size);
+    free(m);
+#else
+    (void)map;
+#endif
+}
+
 dsys_dir_iter* dsys_dir_open(const char* path)
 {
     const dsys_backend_vtable* backend;
@@ -5,6 +5,17 @@ RESPONSIBILITY: Deterministic fixed-size thread pool.
 */
 #include "thread_pool.h"
 
+#include "domino/system/dsys_perf.h"
+
+#if defined(_MSC_VER)
+#define DOM_THREAD_POOL_TLS __declspec(thread)
+#else
+#define DOM_THREAD_POOL_TLS __thread
+#endif
+
+/* Pool whose worker loop runs on this thread, if any. */
+static DOM_THREAD_POOL_TLS const dom_thread_pool *t_worker_pool = 0;
+
 typedef struct dom_thread_pool_worker {
     dom_thread thread;
     u32 index;
@@ -53,7 +64,9 @@ void dom_cond_broadcast(dom_cond *c) {
 }
 
 static d_bool pool_has_pending(dom_thread_pool *pool) {
-    return (pool->active_tasks > 0u) ? D_TRUE : D_FALSE;
+    /* Only queued work wakes idle workers; tasks already running elsewhere
+       must not keep them spinning. */
+    return (pool->queued_tasks > 0u) ? D_TRUE : D_FALSE;
 }
 
 static d_bool pool_try_steal(dom_thread_pool *pool,
@@ -92,6 +105,7 @@ static void *dom_thread_pool_entry(void *arg)
         return 0;
 #endif
     }
+    t_worker_pool = pool;
 
     for (;;) {
         d_bool got = D_FALSE;
@@ -102,6 +116,11 @@ static void *dom_thread_pool_entry(void *arg)
         }
 
         if (got == D_TRUE) {
+            dom_mutex_lock(&pool->mutex);
+            if (pool->queued_tasks > 0u) {
+                pool->queued_tasks -= 1u;
+            }
+            dom_mutex_unlock(&pool->mutex);
             if (task.fn) {
                 task.fn(task.user_data);
             }
@@ -127,6 +146,9 @@ static void *dom_thread_pool_entry(void *arg)
         dom_mutex_unlock(&pool->mutex);
     }
 
+    /* Hand the perf counter block to whichever thread starts next. */
+    dsys_perf_thread_release();
+    t_worker_pool = 0;
 #ifdef _WIN32
     return 0;
 #else
@@ -144,10 +166,12 @@ d_bool dom_thread_pool_init(dom_thread_pool *pool, u32 worker_count, u32 queue_c
     pool->queue_capacity = queue_capacity == 0u ? 1u : queue_capacity;
     pool->shutting_down = D_FALSE;
     pool->active_tasks = 0u;
+    pool->queued_tasks = 0u;
     pool->next_submit = 0u;
     dom_mutex_init(&pool->mutex);
     dom_cond_init(&pool->cond);
 
+    /* Every deque must exist before any worker starts stealing from it. */
     for (i = 0u; i < worker_count; ++i) {
         dom_thread_pool_worker *w = &pool->workers[i];
         w->index = i;
@@ -155,6 +179,9 @@ d_bool dom_thread_pool_init(dom_thread_pool *pool, u32 worker_count, u32 queue_c
         if (dom_ws_deque_init(&w->deque, pool->queue_capacity) == D_FALSE) {
             return D_FALSE;
         }
+    }
+    for (i = 0u; i < worker_count; ++i) {
+        dom_thread_pool_worker *w = &pool->workers[i];
 #ifdef _WIN32
         w->thread = CreateThread(0, 0, dom_thread_pool_entry, w, 0, 0);
         if (!w->thread) {
@@ -204,13 +231,26 @@ d_bool dom_thread_pool_submit_to(dom_thread_pool *pool,
         return D_FALSE;
     }
     worker_index = worker_index % pool->worker_count;
+    /* Count the task before publishing it so a worker that finishes it
+       immediately cannot decrement ahead of the increment. */
+    dom_mutex_lock(&pool->mutex);
+    pool->active_tasks += 1u;
+    pool->queued_tasks += 1u;
+    dom_mutex_unlock(&pool->mutex);
     if (dom_ws_deque_push_bottom(&pool->workers[worker_index].deque, task) == D_TRUE) {
-        dom_mutex_lock(&pool->mutex);
-        pool->active_tasks += 1u;
-        dom_cond_signal(&pool->cond);
-        dom_mutex_unlock(&pool->mutex);
         ok = D_TRUE;
     }
+    dom_mutex_lock(&pool->mutex);
+    if (ok == D_TRUE) {
+        dom_cond_broadcast(&pool->cond);
+    } else {
+        pool->active_tasks -= 1u;
+        pool->queued_tasks -= 1u;
+        if (pool->active_tasks == 0u) {
+            dom_cond_broadcast(&pool->cond);
+        }
+    }
+    dom_mutex_unlock(&pool->mutex);
     return ok;
 }
 
@@ -236,3 +276,7 @@ void dom_thread_pool_wait(dom_thread_pool *pool) {
     }
     dom_mutex_unlock(&pool->mutex);
 }
+
+d_bool dom_thread_pool_on_worker(const dom_thread_pool *pool) {
+    return (pool && t_worker_pool == pool) ? D_TRUE : D_FALSE;
+}
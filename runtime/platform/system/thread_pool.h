@@ -33,6 +33,7 @@ typedef struct dom_thread_pool {
     dom_cond cond;
     d_bool shutting_down;
     u32 active_tasks;
+    u32 queued_tasks;
     u32 next_submit;
 } dom_thread_pool;
 
@@ -43,7 +44,12 @@ d_bool dom_thread_pool_submit(dom_thread_pool *pool, const dom_thread_pool_task
 d_bool dom_thread_pool_submit_to(dom_thread_pool *pool,
                                 const dom_thread_pool_task *task,
                                 u32 worker_index);
+/* Waits until every task submitted to the pool has finished, whoever
+   submitted it. Calling it from one of the pool's own workers deadlocks,
+   because that worker's task is counted too. */
 void dom_thread_pool_wait(dom_thread_pool *pool);
+/* D_TRUE when the calling thread is one of `pool`'s workers. */
+d_bool dom_thread_pool_on_worker(const dom_thread_pool *pool);
 
 void dom_cond_init(dom_cond *c);
 void dom_cond_destroy(dom_cond *c);
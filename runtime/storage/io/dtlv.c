@@ -228,7 +228,11 @@ static void dtlv_reader_reset(dtlv_reader* r) {
     r->file_size = 0u;
     r->dir_offset = 0u;
     r->chunk_count = 0u;
+    r->map = (void*)0;
     r->entries = (dtlv_dir_entry*)0;
+    r->type_slots = (u32*)0;
+    r->type_next = (u32*)0;
+    r->type_slot_capacity = 0u;
 }
 
 void dtlv_reader_init(dtlv_reader* r) {
@@ -243,12 +247,65 @@ void dtlv_reader_dispose(dtlv_reader* r) {
         free(r->entries);
     }
     r->entries = (dtlv_dir_entry*)0;
+    if (r->type_slots) {
+        free(r->type_slots); /* type_next shares the block */
+    }
     if (r->owns_fh && r->fh) {
         (void)dsys_file_close(r->fh);
     }
+    if (r->map) {
+        dsys_file_unmap(r->map);
+    }
     dtlv_reader_reset(r);
 }
 
+static u32 dtlv_type_slot_home(u32 type_id, u32 mask) {
+    u32 h = type_id * 0x9E3779B1u;
+    h ^= h >> 16;
+    return h & mask;
+}
+
+static u32 dtlv_type_slot_find(const dtlv_reader* r, u32 type_id) {
+    u32 mask = r->type_slot_capacity - 1u;
+    u32 s = dtlv_type_slot_home(type_id, mask);
+    while (r->type_slots[s] != 0u &&
+           r->entries[r->type_slots[s] - 1u].type_id != type_id) {
+        s = (s + 1u) & mask;
+    }
+    return s;
+}
+
+/* Build the type_id index over the parsed directory. On allocation failure
+ * the reader keeps working with a linear find_first. */
+static void dtlv_reader_build_type_index(dtlv_reader* r) {
+    u32 cap = 16u;
+    u32* block;
+    u32 i;
+    if (!r->entries || r->chunk_count == 0u || r->chunk_count > 0x3FFFFFFFu) {
+        return;
+    }
+    while (cap < r->chunk_count * 2u) {
+        cap <<= 1;
+    }
+    block = (u32*)malloc(sizeof(u32) * ((size_t)cap + (size_t)r->chunk_count));
+    if (!block) {
+        return;
+    }
+    memset(block, 0, sizeof(u32) * (size_t)cap);
+    r->type_slots = block;
+    r->type_next = block + cap;
+    r->type_slot_capacity = cap;
+    /* Walk backwards so each chain ends up in directory order. */
+    i = r->chunk_count;
+    while (i > 0u) {
+        u32 s;
+        i -= 1u;
+        s = dtlv_type_slot_find(r, r->entries[i].type_id);
+        r->type_next[i] = r->type_slots[s];
+        r->type_slots[s] = i + 1u;
+    }
+}
+
 static int dtlv_reader_parse_from_bytes(
     dtlv_reader*          r,
     const unsigned char*  bytes,
@@ -345,6 +402,7 @@ static int dtlv_reader_parse_from_bytes(
             p += DTLV_DIR_ENTRY_SIZE_V1;
         }
         r->entries = entries;
+        dtlv_reader_build_type_index(r);
     }
 
     return 0;
@@ -502,6 +560,7 @@ int dtlv_reader_init_file(dtlv_reader* r, void* fh) {
         }
         free(dir);
         r->entries = entries;
+        dtlv_reader_build_type_index(r);
     }
 
     return 0;
@@ -527,6 +586,31 @@ int dtlv_reader_open_file(dtlv_reader* r, const char* path) {
     return 0;
 }
 
+int dtlv_reader_open_mapped(dtlv_reader* r, const char* path) {
+    const void* data;
+    size_t size;
+    void* map;
+    int rc;
+    if (!r || !path) {
+        return -1;
+    }
+    dtlv_reader_dispose(r);
+    map = dsys_file_map(path, &data, &size);
+    if (!map) {
+        return -2;
+    }
+    r->map = map;
+    r->mem = (const unsigned char*)data;
+    r->mem_size = (u64)size;
+    r->file_size = (u64)size;
+    rc = dtlv_reader_parse_from_bytes(r, r->mem, r->mem_size);
+    if (rc != 0) {
+        dtlv_reader_dispose(r);
+        return rc;
+    }
+    return 0;
+}
+
 u32 dtlv_reader_chunk_count(const dtlv_reader* r) {
     return r ? r->chunk_count : 0u;
 }
@@ -550,6 +634,17 @@ const dtlv_dir_entry* dtlv_reader_find_first(
     if (!r || !r->entries) {
         return (const dtlv_dir_entry*)0;
     }
+    if (r->type_slots) {
+        i = r->type_slots[dtlv_type_slot_find(r, type_id)];
+        while (i != 0u) {
+            const dtlv_dir_entry* e = &r->entries[i - 1u];
+            if (version == 0u || e->version == version) {
+                return e;
+            }
+            i = r->type_next[i - 1u];
+        }
+        return (const dtlv_dir_entry*)0;
+    }
     for (i = 0u; i < r->chunk_count; ++i) {
         const dtlv_dir_entry* e = &r->entries[i];
         if (e->type_id != type_id) {
@@ -14,8 +14,9 @@ RESPONSIBILITY: Checkpoint policy and trigger definitions shared across ops surf
 extern "C" {
 #endif
 
-#define DOM_CHECKPOINT_SCHEMA_VERSION 1u
+#define DOM_CHECKPOINT_SCHEMA_VERSION 2u
 #define DOM_CHECKPOINT_MAX_RECORDS 32u
+#define DOM_CHECKPOINT_DEFAULT_BASE_INTERVAL 8u
 
 typedef enum dom_checkpoint_trigger_reason {
     DOM_CHECKPOINT_TRIGGER_POLICY_TICK = 1,
@@ -30,6 +31,9 @@ typedef struct dom_checkpoint_policy {
     u32 macro_event_stride;
     u32 checkpoint_before_transfer;
     u32 max_records;
+    /* Checkpoints per full base record; the ones in between share unchanged
+       pages with their predecessor. 0 or 1 makes every checkpoint a base. */
+    u32 base_interval;
 } dom_checkpoint_policy;
 
 void dom_checkpoint_policy_default(dom_checkpoint_policy* policy);
@@ -8,10 +8,12 @@ RESPONSIBILITY: Deterministic MMO checkpoint capture, storage, and recovery.
 
 #include "dom_server_runtime.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 enum {
-    DOM_CHECKPOINT_HASH_WORKERS = 1u
+    DOM_CHECKPOINT_HASH_WORKERS = 1u,
+    DOM_CHECKPOINT_RECORD_SECTIONS = 6u
 };
 
 static u64 dom_checkpoint_hash_mix(u64 hash, u64 value)
@@ -24,15 +26,176 @@ static u64 dom_checkpoint_hash_mix(u64 hash, u64 value)
     return hash;
 }
 
-static void dom_checkpoint_clear_worlds(dom_checkpoint_record* record)
+/* Word-at-a-time; page hashes only guard pages held in this process. */
+static u64 dom_checkpoint_page_hash(const unsigned char* data, u32 bytes)
+{
+    u64 hash = 1469598103934665603ULL;
+    u32 i = 0u;
+    for (; i + 8u <= bytes; i += 8u) {
+        u64 word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+        hash ^= hash >> 32u;
+    }
+    for (; i < bytes; ++i) {
+        hash = (hash ^ (u64)data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void dom_checkpoint_pages_release(dom_checkpoint_pages* pages)
 {
     u32 i;
-    if (!record) {
+    if (!pages) {
         return;
     }
-    for (i = 0u; i < DOM_SERVER_MAX_SHARDS; ++i) {
-        record->world_clones[i] = (d_world*)0;
+    for (i = 0u; i < pages->page_count; ++i) {
+        dom_checkpoint_page* page = pages->pages[i];
+        if (page && --page->refs == 0u) {
+            free(page);
+        }
+    }
+    free(pages->pages);
+    memset(pages, 0, sizeof(*pages));
+}
+
+/*
+Pages `bytes` of `src`. A page whose bytes match the same page of `prev` is
+shared by reference; everything else is copied and hashed.
+*/
+static int dom_checkpoint_pages_capture(dom_checkpoint_pages* out,
+                                        const void* src,
+                                        u32 bytes,
+                                        const dom_checkpoint_pages* prev,
+                                        dom_checkpoint_manifest* stats)
+{
+    const unsigned char* data = (const unsigned char*)src;
+    u32 count;
+    u32 i;
+    memset(out, 0, sizeof(*out));
+    if (bytes == 0u) {
+        return 0;
+    }
+    if (!src) {
+        return -1;
+    }
+    count = (bytes + (DOM_CHECKPOINT_PAGE_BYTES - 1u)) / DOM_CHECKPOINT_PAGE_BYTES;
+    out->pages = (dom_checkpoint_page**)malloc(sizeof(out->pages[0]) * (size_t)count);
+    if (!out->pages) {
+        return -1;
+    }
+    out->bytes = bytes;
+    for (i = 0u; i < count; ++i) {
+        const u32 offset = i * DOM_CHECKPOINT_PAGE_BYTES;
+        const u32 len = (bytes - offset < DOM_CHECKPOINT_PAGE_BYTES)
+            ? (bytes - offset)
+            : DOM_CHECKPOINT_PAGE_BYTES;
+        dom_checkpoint_page* page = (prev && i < prev->page_count) ? prev->pages[i] : 0;
+        if (page && page->bytes == len && memcmp(page->data, data + offset, len) == 0) {
+            page->refs += 1u;
+            stats->pages_shared += 1u;
+        } else {
+            page = (dom_checkpoint_page*)malloc(sizeof(*page));
+            if (!page) {
+                return -1;
+            }
+            page->refs = 1u;
+            page->bytes = len;
+            memcpy(page->data, data + offset, len);
+            page->hash = dom_checkpoint_page_hash(page->data, len);
+            stats->pages_written += 1u;
+        }
+        out->pages[i] = page;
+        out->page_count = i + 1u;
+    }
+    return 0;
+}
+
+static int dom_checkpoint_pages_verify(const dom_checkpoint_pages* pages, size_t expected_bytes)
+{
+    u32 expected_count;
+    u32 i;
+    if (!pages || (size_t)pages->bytes != expected_bytes) {
+        return -1;
+    }
+    expected_count = (pages->bytes + (DOM_CHECKPOINT_PAGE_BYTES - 1u)) / DOM_CHECKPOINT_PAGE_BYTES;
+    if (pages->page_count != expected_count || (expected_count > 0u && !pages->pages)) {
+        return -2;
+    }
+    for (i = 0u; i < pages->page_count; ++i) {
+        const dom_checkpoint_page* page = pages->pages[i];
+        const u32 offset = i * DOM_CHECKPOINT_PAGE_BYTES;
+        const u32 len = (pages->bytes - offset < DOM_CHECKPOINT_PAGE_BYTES)
+            ? (pages->bytes - offset)
+            : DOM_CHECKPOINT_PAGE_BYTES;
+        if (!page || page->bytes != len) {
+            return -3;
+        }
+        if (page->hash != dom_checkpoint_page_hash(page->data, page->bytes)) {
+            return -4;
+        }
+    }
+    return 0;
+}
+
+static void dom_checkpoint_pages_read(const dom_checkpoint_pages* pages, void* dst)
+{
+    unsigned char* out = (unsigned char*)dst;
+    u32 i;
+    for (i = 0u; i < pages->page_count; ++i) {
+        memcpy(out + (size_t)i * DOM_CHECKPOINT_PAGE_BYTES,
+               pages->pages[i]->data,
+               pages->pages[i]->bytes);
+    }
+}
+
+/* Runtime-wide sections; each shard checkpoint adds scale_events and world_image. */
+static void dom_checkpoint_record_sections(dom_checkpoint_record* record,
+                                           dom_checkpoint_pages** out_sections)
+{
+    out_sections[0] = &record->intents;
+    out_sections[1] = &record->deferred;
+    out_sections[2] = &record->events;
+    out_sections[3] = &record->owners;
+    out_sections[4] = &record->messages;
+    out_sections[5] = &record->idempotency;
+}
+
+/* One block holds the slots followed by the per-domain hashes and capsule ids. */
+static int dom_checkpoint_domains_alloc(dom_shard_checkpoint* chk, u32 count)
+{
+    unsigned char* block;
+    chk->domains = 0;
+    chk->domain_hashes = 0;
+    chk->capsule_ids = 0;
+    if (count == 0u) {
+        return 0;
+    }
+    block = (unsigned char*)calloc(count, sizeof(dom_scale_domain_slot) + 2u * sizeof(u64));
+    if (!block) {
+        return -1;
     }
+    chk->domains = (dom_scale_domain_slot*)block;
+    chk->domain_hashes = (u64*)(block + sizeof(dom_scale_domain_slot) * (size_t)count);
+    chk->capsule_ids = chk->domain_hashes + count;
+    return 0;
+}
+
+static d_world* dom_checkpoint_load_world(const dom_checkpoint_pages* image)
+{
+    unsigned char* bytes;
+    d_world* world;
+    if (!image || image->bytes == 0u) {
+        return (d_world*)0;
+    }
+    bytes = (unsigned char*)malloc(image->bytes);
+    if (!bytes) {
+        return (d_world*)0;
+    }
+    dom_checkpoint_pages_read(image, bytes);
+    world = d_world_load_image(bytes, image->bytes);
+    free(bytes);
+    return world;
 }
 
 static void dom_checkpoint_destroy_worlds(d_world** worlds, u32 count)
@@ -174,7 +337,7 @@ static u64 dom_checkpoint_shard_hash(const dom_shard_checkpoint* shard,
     hash = dom_checkpoint_hash_mix(hash, shard->baseline_hash);
     hash = dom_checkpoint_hash_mix(hash, shard->world_checksum);
     hash = dom_checkpoint_hash_mix(hash, shard->domain_count);
-    for (i = 0u; i < shard->domain_count && i < DOM_SERVER_MAX_DOMAINS_PER_SHARD; ++i) {
+    for (i = 0u; i < shard->domain_count; ++i) {
         hash = dom_checkpoint_hash_mix(hash, shard->domain_hashes[i]);
         hash = dom_checkpoint_hash_mix(hash, shard->capsule_ids[i]);
     }
@@ -186,50 +349,6 @@ static u64 dom_checkpoint_shard_hash(const dom_shard_checkpoint* shard,
     return hash;
 }
 
-static void dom_checkpoint_fixup_domain_pointers(dom_shard_checkpoint* shard)
-{
-    u32 i;
-    u32 res_off = 0u;
-    u32 node_off = 0u;
-    u32 edge_off = 0u;
-    u32 agent_off = 0u;
-    const u32 res_cap = (u32)(sizeof(shard->resource_entries) / sizeof(shard->resource_entries[0]));
-    const u32 node_cap = (u32)(sizeof(shard->network_nodes) / sizeof(shard->network_nodes[0]));
-    const u32 edge_cap = (u32)(sizeof(shard->network_edges) / sizeof(shard->network_edges[0]));
-    const u32 agent_cap = (u32)(sizeof(shard->agent_entries) / sizeof(shard->agent_entries[0]));
-
-    if (!shard) {
-        return;
-    }
-    if (shard->domain_count > DOM_SERVER_MAX_DOMAINS_PER_SHARD) {
-        shard->domain_count = DOM_SERVER_MAX_DOMAINS_PER_SHARD;
-    }
-
-    for (i = 0u; i < shard->domain_count; ++i) {
-        dom_scale_domain_slot* slot = &shard->domains[i];
-        if (slot->domain_kind == DOM_SCALE_DOMAIN_RESOURCES) {
-            const u32 count = slot->resources.count;
-            slot->resources.entries = &shard->resource_entries[res_off];
-            slot->resources.capacity = res_cap - res_off;
-            res_off += count;
-        } else if (slot->domain_kind == DOM_SCALE_DOMAIN_NETWORK) {
-            const u32 node_count = slot->network.node_count;
-            const u32 edge_count = slot->network.edge_count;
-            slot->network.nodes = &shard->network_nodes[node_off];
-            slot->network.node_capacity = node_cap - node_off;
-            slot->network.edges = &shard->network_edges[edge_off];
-            slot->network.edge_capacity = edge_cap - edge_off;
-            node_off += node_count;
-            edge_off += edge_count;
-        } else if (slot->domain_kind == DOM_SCALE_DOMAIN_AGENTS) {
-            const u32 count = slot->agents.count;
-            slot->agents.entries = &shard->agent_entries[agent_off];
-            slot->agents.capacity = agent_cap - agent_off;
-            agent_off += count;
-        }
-    }
-}
-
 static int dom_checkpoint_copy_domains(dom_shard_checkpoint* out,
                                        const dom_server_shard* shard,
                                        dom_act_time_t tick)
@@ -248,8 +367,9 @@ static int dom_checkpoint_copy_domains(dom_shard_checkpoint* out,
         return -1;
     }
     out->domain_count = shard->scale_ctx.domain_count;
-    if (out->domain_count > DOM_SERVER_MAX_DOMAINS_PER_SHARD) {
-        out->domain_count = DOM_SERVER_MAX_DOMAINS_PER_SHARD;
+    if (dom_checkpoint_domains_alloc(out, out->domain_count) != 0) {
+        out->domain_count = 0u;
+        return -6;
     }
 
     for (i = 0u; i < out->domain_count; ++i) {
@@ -322,11 +442,6 @@ static int dom_checkpoint_copy_domains(dom_shard_checkpoint* out,
         out->domain_hashes[i] = dom_scale_domain_hash(dst, tick, DOM_CHECKPOINT_HASH_WORKERS);
     }
 
-    for (; i < DOM_SERVER_MAX_DOMAINS_PER_SHARD; ++i) {
-        out->capsule_ids[i] = 0u;
-        out->domain_hashes[i] = 0u;
-    }
-
     return 0;
 }
 
@@ -348,10 +463,10 @@ static int dom_checkpoint_restore_domains(dom_server_shard* shard,
         return -1;
     }
 
-    shard->scale_ctx.domain_count = chk->domain_count;
-    if (shard->scale_ctx.domain_count > DOM_SERVER_MAX_DOMAINS_PER_SHARD) {
-        shard->scale_ctx.domain_count = DOM_SERVER_MAX_DOMAINS_PER_SHARD;
+    if (chk->domain_count > shard->domain_capacity) {
+        return -7;
     }
+    shard->scale_ctx.domain_count = chk->domain_count;
 
     for (i = 0u; i < shard->scale_ctx.domain_count; ++i) {
         const dom_scale_domain_slot* src = &chk->domains[i];
@@ -442,6 +557,7 @@ void dom_checkpoint_policy_default(dom_checkpoint_policy* policy)
     policy->macro_event_stride = 128u;
     policy->checkpoint_before_transfer = 1u;
     policy->max_records = DOM_CHECKPOINT_MAX_RECORDS;
+    policy->base_interval = DOM_CHECKPOINT_DEFAULT_BASE_INTERVAL;
 }
 
 void dom_checkpoint_store_init(dom_checkpoint_store* store,
@@ -461,7 +577,6 @@ void dom_checkpoint_store_init(dom_checkpoint_store* store,
     }
     for (i = 0u; i < capacity; ++i) {
         memset(&storage[i], 0, sizeof(storage[i]));
-        dom_checkpoint_clear_worlds(&storage[i]);
     }
 }
 
@@ -482,6 +597,7 @@ int dom_checkpoint_store_record(dom_checkpoint_store* store,
                                 dom_checkpoint_record* record)
 {
     dom_checkpoint_record* dst;
+    dom_checkpoint_pages* sections[DOM_CHECKPOINT_RECORD_SECTIONS];
     u32 i;
     if (!store || !store->records || store->capacity == 0u || !record) {
         return -1;
@@ -495,14 +611,13 @@ int dom_checkpoint_store_record(dom_checkpoint_store* store,
         store->count += 1u;
     }
 
+    /* The store takes over the record's pages and shard checkpoints. */
     memcpy(dst, record, sizeof(*dst));
-    for (i = 0u; i < DOM_SERVER_MAX_SHARDS; ++i) {
-        dst->world_clones[i] = record->world_clones[i];
-        record->world_clones[i] = (d_world*)0;
-    }
-    for (i = 0u; i < dst->manifest.shard_count && i < DOM_SERVER_MAX_SHARDS; ++i) {
-        dom_checkpoint_fixup_domain_pointers(&dst->shards[i]);
+    dom_checkpoint_record_sections(record, sections);
+    for (i = 0u; i < DOM_CHECKPOINT_RECORD_SECTIONS; ++i) {
+        memset(sections[i], 0, sizeof(*sections[i]));
     }
+    record->shards = 0;
 
     store->head += 1u;
     if (store->head >= store->capacity) {
@@ -566,11 +681,12 @@ u64 dom_checkpoint_store_hash(const dom_checkpoint_store* store)
         hash = dom_checkpoint_hash_mix(hash, rec->owner_count);
         hash = dom_checkpoint_hash_mix(hash, rec->message_count);
         hash = dom_checkpoint_hash_mix(hash, rec->idempotency_count);
-        for (s = 0u; s < rec->manifest.shard_count && s < DOM_SERVER_MAX_SHARDS; ++s) {
+        for (s = 0u; rec->shards && s < rec->manifest.shard_count; ++s) {
             const dom_shard_checkpoint* shard = &rec->shards[s];
             hash = dom_checkpoint_hash_mix(hash, shard->shard_hash);
-            if (rec->world_clones[s]) {
-                hash = dom_checkpoint_hash_mix(hash, d_world_checksum(rec->world_clones[s]));
+            if (shard->world_image.page_count > 0u) {
+                /* The image was taken from the world this checksum describes. */
+                hash = dom_checkpoint_hash_mix(hash, shard->world_checksum);
             }
         }
     }
@@ -578,7 +694,8 @@ u64 dom_checkpoint_store_hash(const dom_checkpoint_store* store)
 }
 
 static u64 dom_checkpoint_make_id(const dom_server_runtime* runtime,
-                                  u32 trigger_reason)
+                                  u32 trigger_reason,
+                                  u64 runtime_hash)
 {
     u64 hash = 1469598103934665603ULL;
     u64 lifecycle_hash;
@@ -594,10 +711,25 @@ static u64 dom_checkpoint_make_id(const dom_server_runtime* runtime,
     hash = dom_checkpoint_hash_mix(hash, runtime->message_sequence);
     hash = dom_checkpoint_hash_mix(hash, runtime->message_applied);
     hash = dom_checkpoint_hash_mix(hash, runtime->macro_events_executed);
-    hash = dom_checkpoint_hash_mix(hash, dom_server_runtime_hash(runtime));
+    hash = dom_checkpoint_hash_mix(hash, runtime_hash);
     return hash;
 }
 
+/* Record whose pages the next capture may share, or null when a base is due. */
+static const dom_checkpoint_record* dom_checkpoint_share_source(const dom_server_runtime* runtime)
+{
+    const dom_checkpoint_record* prev = dom_checkpoint_store_last(&runtime->checkpoint_store);
+    const u32 interval = runtime->config.checkpoint_policy.base_interval;
+    if (!prev || interval <= 1u) {
+        return 0;
+    }
+    if (prev->manifest.schema_version != DOM_CHECKPOINT_SCHEMA_VERSION ||
+        prev->manifest.chain_length + 1u >= interval) {
+        return 0;
+    }
+    return prev;
+}
+
 int dom_checkpoint_capture(dom_checkpoint_record* out_record,
                            const dom_server_runtime* runtime,
                            u32 trigger_reason)
@@ -605,29 +737,41 @@ int dom_checkpoint_capture(dom_checkpoint_record* out_record,
     u32 i;
     u32 lifecycle_cap;
     u64 lifecycle_hash;
+    u64 runtime_hash;
+    const dom_checkpoint_record* prev;
+    dom_checkpoint_manifest* manifest;
     if (!out_record || !runtime) {
         return -1;
     }
 
     memset(out_record, 0, sizeof(*out_record));
-    dom_checkpoint_clear_worlds(out_record);
+    manifest = &out_record->manifest;
+    prev = dom_checkpoint_share_source(runtime);
 
     lifecycle_hash = dom_shard_lifecycle_log_hash(&runtime->lifecycle_log);
-
-    out_record->manifest.schema_version = DOM_CHECKPOINT_SCHEMA_VERSION;
-    out_record->manifest.tick = runtime->now_tick;
-    out_record->manifest.trigger_reason = trigger_reason;
-    out_record->manifest.worlddef_hash = runtime->config.worlddef_hash;
-    out_record->manifest.capability_lock_hash = runtime->config.capability_lock_hash;
-    out_record->manifest.runtime_hash = dom_server_runtime_hash(runtime);
-    out_record->manifest.lifecycle_hash = lifecycle_hash;
-    out_record->manifest.message_sequence = runtime->message_sequence;
-    out_record->manifest.message_applied = runtime->message_applied;
-    out_record->manifest.macro_events_executed = runtime->macro_events_executed;
-    out_record->manifest.event_count = runtime->event_count;
-    out_record->manifest.event_overflow = runtime->event_overflow;
-    out_record->manifest.shard_count = runtime->shard_count;
-    out_record->manifest.checkpoint_id = dom_checkpoint_make_id(runtime, trigger_reason);
+    runtime_hash = dom_server_runtime_hash(runtime);
+
+    manifest->schema_version = DOM_CHECKPOINT_SCHEMA_VERSION;
+    manifest->tick = runtime->now_tick;
+    manifest->trigger_reason = trigger_reason;
+    manifest->worlddef_hash = runtime->config.worlddef_hash;
+    manifest->capability_lock_hash = runtime->config.capability_lock_hash;
+    manifest->runtime_hash = runtime_hash;
+    manifest->lifecycle_hash = lifecycle_hash;
+    manifest->message_sequence = runtime->message_sequence;
+    manifest->message_applied = runtime->message_applied;
+    manifest->macro_events_executed = runtime->macro_events_executed;
+    manifest->event_count = runtime->event_count;
+    manifest->event_overflow = runtime->event_overflow;
+    manifest->shard_count = runtime->shard_count;
+    manifest->checkpoint_id = dom_checkpoint_make_id(runtime, trigger_reason, runtime_hash);
+    if (prev) {
+        manifest->base_checkpoint_id = prev->manifest.base_checkpoint_id;
+        manifest->chain_length = prev->manifest.chain_length + 1u;
+    } else {
+        manifest->base_checkpoint_id = manifest->checkpoint_id;
+        manifest->chain_length = 0u;
+    }
 
     lifecycle_cap = (u32)(sizeof(out_record->lifecycle_entries) /
                           sizeof(out_record->lifecycle_entries[0]));
@@ -645,69 +789,82 @@ int dom_checkpoint_capture(dom_checkpoint_record* out_record,
 
     out_record->intent_count = runtime->intent_count;
     out_record->intent_overflow = runtime->intent_overflow;
-    if (out_record->intent_count > DOM_SERVER_MAX_INTENTS) {
+    if (out_record->intent_count > runtime->intent_capacity) {
         return -21;
     }
-    if (out_record->intent_count > 0u) {
-        memcpy(out_record->intents,
-               runtime->intents,
-               sizeof(out_record->intents[0]) * (size_t)out_record->intent_count);
-    }
-
     out_record->deferred_count = runtime->deferred_count;
     out_record->deferred_overflow = runtime->deferred_overflow;
-    if (out_record->deferred_count > DOM_SERVER_MAX_DEFERRED) {
+    if (out_record->deferred_count > runtime->deferred_capacity) {
         return -22;
     }
-    for (i = 0u; i < out_record->deferred_count; ++i) {
-        out_record->deferred[i].intent = runtime->deferred[i].intent;
-        out_record->deferred[i].refusal_code = runtime->deferred[i].refusal_code;
-    }
-
     out_record->event_count = runtime->event_count;
     out_record->event_overflow = runtime->event_overflow;
-    if (out_record->event_count > DOM_SERVER_MAX_EVENTS) {
+    if (out_record->event_count > runtime->event_capacity) {
         return -2;
     }
-    if (out_record->event_count > 0u) {
-        memcpy(out_record->events,
-               runtime->events,
-               sizeof(out_record->events[0]) * (size_t)out_record->event_count);
-    }
-
     out_record->owner_count = runtime->owner_count;
-    if (out_record->owner_count > DOM_SERVER_MAX_DOMAIN_OWNERS) {
+    if (out_record->owner_count > runtime->owner_capacity) {
         return -3;
     }
-    if (out_record->owner_count > 0u) {
-        memcpy(out_record->owners,
-               runtime->owners,
-               sizeof(out_record->owners[0]) * (size_t)out_record->owner_count);
-    }
-
     out_record->message_count = runtime->message_log.message_count;
-    if (out_record->message_count > DOM_SERVER_MAX_MESSAGES) {
+    if (out_record->message_count > runtime->message_log.message_capacity) {
         return -4;
     }
-    if (out_record->message_count > 0u) {
-        memcpy(out_record->messages,
-               runtime->message_storage,
-               sizeof(out_record->messages[0]) * (size_t)out_record->message_count);
-    }
-
     out_record->idempotency_count = runtime->message_log.idempotency_count;
-    if (out_record->idempotency_count > DOM_SERVER_MAX_IDEMPOTENCY) {
+    if (out_record->idempotency_count > runtime->message_log.idempotency_capacity) {
         return -5;
     }
-    if (out_record->idempotency_count > 0u) {
-        memcpy(out_record->idempotency,
-               runtime->message_idempotency,
-               sizeof(out_record->idempotency[0]) * (size_t)out_record->idempotency_count);
-    }
 
-    for (i = 0u; i < runtime->shard_count && i < DOM_SERVER_MAX_SHARDS; ++i) {
+    if (dom_checkpoint_pages_capture(&out_record->intents,
+                                     runtime->intents,
+                                     (u32)(sizeof(runtime->intents[0]) * out_record->intent_count),
+                                     prev ? &prev->intents : 0,
+                                     manifest) != 0 ||
+        dom_checkpoint_pages_capture(&out_record->deferred,
+                                     runtime->deferred,
+                                     (u32)(sizeof(runtime->deferred[0]) * out_record->deferred_count),
+                                     prev ? &prev->deferred : 0,
+                                     manifest) != 0 ||
+        dom_checkpoint_pages_capture(&out_record->events,
+                                     runtime->events,
+                                     (u32)(sizeof(runtime->events[0]) * out_record->event_count),
+                                     prev ? &prev->events : 0,
+                                     manifest) != 0 ||
+        dom_checkpoint_pages_capture(&out_record->owners,
+                                     runtime->owners,
+                                     (u32)(sizeof(runtime->owners[0]) * out_record->owner_count),
+                                     prev ? &prev->owners : 0,
+                                     manifest) != 0 ||
+        dom_checkpoint_pages_capture(&out_record->messages,
+                                     runtime->message_storage,
+                                     (u32)(sizeof(runtime->message_storage[0]) * out_record->message_count),
+                                     prev ? &prev->messages : 0,
+                                     manifest) != 0 ||
+        dom_checkpoint_pages_capture(&out_record->idempotency,
+                                     runtime->message_idempotency,
+                                     (u32)(sizeof(runtime->message_idempotency[0]) *
+                                           out_record->idempotency_count),
+                                     prev ? &prev->idempotency : 0,
+                                     manifest) != 0) {
+        return -10;
+    }
+
+    if (runtime->shard_count > 0u) {
+        out_record->shards = (dom_shard_checkpoint*)calloc(runtime->shard_count,
+                                                            sizeof(dom_shard_checkpoint));
+        if (!out_record->shards) {
+            return -11;
+        }
+    }
+    for (i = 0u; i < runtime->shard_count; ++i) {
         const dom_server_shard* shard = &runtime->shards[i];
         dom_shard_checkpoint* chk = &out_record->shards[i];
+        const dom_shard_checkpoint* prev_chk =
+            (prev && prev->shards && i < prev->manifest.shard_count) ? &prev->shards[i] : 0;
+        unsigned char* image = (unsigned char*)0;
+        u32 image_len = 0u;
+        u32 written;
+        int image_rc;
         dom_scale_budget_snapshot_current(&shard->scale_ctx, &chk->budget_snapshot);
         chk->shard_id = shard->shard_id;
         chk->tick = runtime->now_tick;
@@ -726,15 +883,25 @@ int dom_checkpoint_capture(dom_checkpoint_record* out_record,
         chk->scale_event_count = shard->scale_event_log.count;
         chk->scale_event_overflow = shard->scale_event_log.overflow;
         if (chk->scale_event_count >
-            (u32)(sizeof(chk->scale_events) / sizeof(chk->scale_events[0]))) {
+            (u32)(sizeof(shard->scale_events) / sizeof(shard->scale_events[0]))) {
             return -7;
         }
-        if (chk->scale_event_count > 0u) {
-            memcpy(chk->scale_events,
-                   shard->scale_events,
-                   sizeof(chk->scale_events[0]) * (size_t)chk->scale_event_count);
+        written = manifest->pages_written;
+        if (dom_checkpoint_pages_capture(&chk->scale_events,
+                                         shard->scale_events,
+                                         (u32)(sizeof(shard->scale_events[0]) * chk->scale_event_count),
+                                         prev_chk ? &prev_chk->scale_events : 0,
+                                         manifest) != 0) {
+            return -10;
+        }
+        if (prev_chk && written == manifest->pages_written &&
+            prev_chk->scale_events.bytes == chk->scale_events.bytes &&
+            prev_chk->scale_event_count == chk->scale_event_count &&
+            prev_chk->scale_event_overflow == chk->scale_event_overflow) {
+            chk->scale_event_hash = prev_chk->scale_event_hash;
+        } else {
+            chk->scale_event_hash = dom_checkpoint_scale_event_hash(&shard->scale_event_log);
         }
-        chk->scale_event_hash = dom_checkpoint_scale_event_hash(&shard->scale_event_log);
         chk->shard_hash = dom_checkpoint_shard_hash(chk,
                                                     runtime->now_tick,
                                                     shard->scale_ctx.worker_count);
@@ -742,8 +909,16 @@ int dom_checkpoint_capture(dom_checkpoint_record* out_record,
         if (!shard->world) {
             return -8;
         }
-        out_record->world_clones[i] = d_world_clone(shard->world);
-        if (!out_record->world_clones[i]) {
+        if (d_world_save_image(shard->world, &image, &image_len) != 0) {
+            return -9;
+        }
+        image_rc = dom_checkpoint_pages_capture(&chk->world_image,
+                                                image,
+                                                image_len,
+                                                prev_chk ? &prev_chk->world_image : 0,
+                                                manifest);
+        free(image);
+        if (image_rc != 0 || chk->world_image.page_count == 0u) {
             return -9;
         }
     }
@@ -772,7 +947,8 @@ int dom_checkpoint_recover(dom_server_runtime* runtime,
     u32 lifecycle_cap;
     u64 lifecycle_hash;
     dom_shard_lifecycle_log log_view;
-    d_world* new_worlds[DOM_SERVER_MAX_SHARDS];
+    d_world** new_worlds;
+    dom_scale_domain_slot* shadow_domains;
     dom_server_shard shadow;
     int pre_rc;
     if (out_refusal_code) {
@@ -784,9 +960,6 @@ int dom_checkpoint_recover(dom_server_runtime* runtime,
         }
         return -1;
     }
-    for (i = 0u; i < DOM_SERVER_MAX_SHARDS; ++i) {
-        new_worlds[i] = (d_world*)0;
-    }
 
     if (record->manifest.schema_version != DOM_CHECKPOINT_SCHEMA_VERSION) {
         if (out_refusal_code) {
@@ -824,65 +997,114 @@ int dom_checkpoint_recover(dom_server_runtime* runtime,
     }
 
     if (record->manifest.shard_count != runtime->shard_count ||
-        record->manifest.shard_count > DOM_SERVER_MAX_SHARDS) {
+        (runtime->shard_count > 0u && !record->shards)) {
         if (out_refusal_code) {
             *out_refusal_code = DOM_SERVER_REFUSE_INVALID_INTENT;
         }
         return -5;
     }
 
-    if (record->intent_count > DOM_SERVER_MAX_INTENTS ||
-        record->deferred_count > DOM_SERVER_MAX_DEFERRED ||
-        record->event_count > DOM_SERVER_MAX_EVENTS ||
-        record->owner_count > DOM_SERVER_MAX_DOMAIN_OWNERS ||
-        record->message_count > DOM_SERVER_MAX_MESSAGES ||
-        record->idempotency_count > DOM_SERVER_MAX_IDEMPOTENCY) {
+    if (record->intent_count > runtime->intent_capacity ||
+        record->deferred_count > runtime->deferred_capacity ||
+        record->event_count > runtime->event_capacity ||
+        record->owner_count > runtime->owner_capacity ||
+        record->message_count > runtime->config.max_messages ||
+        record->idempotency_count > runtime->config.max_idempotency) {
         if (out_refusal_code) {
             *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
         }
         return -6;
     }
 
+    /* Every page is checked before anything in the runtime is touched. */
+    if (dom_checkpoint_pages_verify(&record->intents,
+                                    sizeof(runtime->intents[0]) * (size_t)record->intent_count) != 0 ||
+        dom_checkpoint_pages_verify(&record->deferred,
+                                    sizeof(runtime->deferred[0]) * (size_t)record->deferred_count) != 0 ||
+        dom_checkpoint_pages_verify(&record->events,
+                                    sizeof(runtime->events[0]) * (size_t)record->event_count) != 0 ||
+        dom_checkpoint_pages_verify(&record->owners,
+                                    sizeof(runtime->owners[0]) * (size_t)record->owner_count) != 0 ||
+        dom_checkpoint_pages_verify(&record->messages,
+                                    sizeof(runtime->message_storage[0]) *
+                                        (size_t)record->message_count) != 0 ||
+        dom_checkpoint_pages_verify(&record->idempotency,
+                                    sizeof(runtime->message_idempotency[0]) *
+                                        (size_t)record->idempotency_count) != 0) {
+        if (out_refusal_code) {
+            *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
+        }
+        return -9;
+    }
+
+    new_worlds = (d_world**)calloc(runtime->shard_count + 1u, sizeof(d_world*));
+    shadow_domains = (dom_scale_domain_slot*)malloc(
+        sizeof(dom_scale_domain_slot) * ((size_t)runtime->config.domains_per_shard + 1u));
+    if (!new_worlds || !shadow_domains) {
+        free(new_worlds);
+        free(shadow_domains);
+        if (out_refusal_code) {
+            *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
+        }
+        return -16;
+    }
+
     for (i = 0u; i < runtime->shard_count; ++i) {
         const dom_shard_checkpoint* chk = &record->shards[i];
         const dom_server_shard* shard = &runtime->shards[i];
         const u32 scale_cap = (u32)(sizeof(shard->scale_events) / sizeof(shard->scale_events[0]));
-        if (!record->world_clones[i]) {
+        if (chk->world_image.page_count == 0u ||
+            dom_checkpoint_pages_verify(&chk->world_image, chk->world_image.bytes) != 0) {
             if (out_refusal_code) {
                 *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
             }
-            dom_checkpoint_destroy_worlds(new_worlds, DOM_SERVER_MAX_SHARDS);
+            dom_checkpoint_destroy_worlds(new_worlds, runtime->shard_count);
+            free(new_worlds);
+            free(shadow_domains);
             return -7;
         }
         if (chk->shard_id != shard->shard_id) {
             if (out_refusal_code) {
                 *out_refusal_code = DOM_SERVER_REFUSE_INVALID_INTENT;
             }
-            dom_checkpoint_destroy_worlds(new_worlds, DOM_SERVER_MAX_SHARDS);
+            dom_checkpoint_destroy_worlds(new_worlds, runtime->shard_count);
+            free(new_worlds);
+            free(shadow_domains);
             return -8;
         }
-        if (chk->scale_event_count > scale_cap) {
+        if (chk->scale_event_count > scale_cap ||
+            dom_checkpoint_pages_verify(&chk->scale_events,
+                                        sizeof(shard->scale_events[0]) *
+                                            (size_t)chk->scale_event_count) != 0) {
             if (out_refusal_code) {
                 *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
             }
-            dom_checkpoint_destroy_worlds(new_worlds, DOM_SERVER_MAX_SHARDS);
+            dom_checkpoint_destroy_worlds(new_worlds, runtime->shard_count);
+            free(new_worlds);
+            free(shadow_domains);
             return -13;
         }
+        /* Dry run into scratch slots; the live shard stays untouched. */
         shadow = *shard;
+        shadow.domain_storage = shadow_domains;
         pre_rc = dom_checkpoint_restore_domains(&shadow, chk, record->manifest.tick);
         if (pre_rc != 0) {
             if (out_refusal_code) {
                 *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
             }
-            dom_checkpoint_destroy_worlds(new_worlds, DOM_SERVER_MAX_SHARDS);
+            dom_checkpoint_destroy_worlds(new_worlds, runtime->shard_count);
+            free(new_worlds);
+            free(shadow_domains);
             return -14;
         }
-        new_worlds[i] = d_world_clone(record->world_clones[i]);
+        new_worlds[i] = dom_checkpoint_load_world(&chk->world_image);
         if (!new_worlds[i]) {
             if (out_refusal_code) {
                 *out_refusal_code = DOM_SERVER_REFUSE_INTEGRITY_VIOLATION;
             }
-            dom_checkpoint_destroy_worlds(new_worlds, DOM_SERVER_MAX_SHARDS);
+            dom_checkpoint_destroy_worlds(new_worlds, runtime->shard_count);
+            free(new_worlds);
+            free(shadow_domains);
             return -15;
         }
     }
@@ -903,14 +1125,12 @@ int dom_checkpoint_recover(dom_server_runtime* runtime,
 
         shard->scale_event_log.count = chk->scale_event_count;
         shard->scale_event_log.overflow = chk->scale_event_overflow;
-        if (shard->scale_event_log.count > 0u) {
-            memcpy(shard->scale_events,
-                   chk->scale_events,
-                   sizeof(shard->scale_events[0]) * (size_t)shard->scale_event_log.count);
-        }
+        dom_checkpoint_pages_read(&chk->scale_events, shard->scale_events);
 
         (void)dom_checkpoint_restore_domains(shard, chk, record->manifest.tick);
     }
+    free(new_worlds);
+    free(shadow_domains);
 
     runtime->now_tick = record->manifest.tick;
     runtime->message_sequence = record->manifest.message_sequence;
@@ -919,51 +1139,32 @@ int dom_checkpoint_recover(dom_server_runtime* runtime,
 
     runtime->intent_count = record->intent_count;
     runtime->intent_overflow = record->intent_overflow;
-    if (runtime->intent_count > 0u) {
-        memcpy(runtime->intents,
-               record->intents,
-               sizeof(runtime->intents[0]) * (size_t)runtime->intent_count);
-    }
+    dom_checkpoint_pages_read(&record->intents, runtime->intents);
 
     runtime->deferred_count = record->deferred_count;
     runtime->deferred_overflow = record->deferred_overflow;
-    for (i = 0u; i < runtime->deferred_count; ++i) {
-        runtime->deferred[i].intent = record->deferred[i].intent;
-        runtime->deferred[i].refusal_code = record->deferred[i].refusal_code;
-    }
+    dom_checkpoint_pages_read(&record->deferred, runtime->deferred);
 
     runtime->event_count = record->event_count;
     runtime->event_overflow = record->event_overflow;
-    if (runtime->event_count > 0u) {
-        memcpy(runtime->events,
-               record->events,
-               sizeof(runtime->events[0]) * (size_t)runtime->event_count);
-    }
+    dom_checkpoint_pages_read(&record->events, runtime->events);
 
     runtime->owner_count = record->owner_count;
-    if (runtime->owner_count > 0u) {
-        memcpy(runtime->owners,
-               record->owners,
-               sizeof(runtime->owners[0]) * (size_t)runtime->owner_count);
-    }
+    dom_checkpoint_pages_read(&record->owners, runtime->owners);
+    dom_server_runtime_reindex(runtime);
 
     dom_cross_shard_log_init(&runtime->message_log,
                              runtime->message_storage,
-                             DOM_SERVER_MAX_MESSAGES,
+                             runtime->config.max_messages,
                              runtime->message_idempotency,
-                             DOM_SERVER_MAX_IDEMPOTENCY);
+                             runtime->config.max_idempotency);
     runtime->message_log.message_count = record->message_count;
     runtime->message_log.idempotency_count = record->idempotency_count;
-    if (record->message_count > 0u) {
-        memcpy(runtime->message_storage,
-               record->messages,
-               sizeof(runtime->message_storage[0]) * (size_t)record->message_count);
-    }
-    if (record->idempotency_count > 0u) {
-        memcpy(runtime->message_idempotency,
-               record->idempotency,
-               sizeof(runtime->message_idempotency[0]) * (size_t)record->idempotency_count);
-    }
+    dom_checkpoint_pages_read(&record->messages, runtime->message_storage);
+    dom_checkpoint_pages_read(&record->idempotency, runtime->message_idempotency);
+    (void)dom_cross_shard_log_attach_index(&runtime->message_log,
+                                           runtime->message_idempotency_index,
+                                           runtime->message_idempotency_index_capacity);
 
     lifecycle_cap = (u32)(sizeof(runtime->lifecycle_entries) / sizeof(runtime->lifecycle_entries[0]));
     dom_shard_lifecycle_log_init(&runtime->lifecycle_log,
@@ -986,14 +1187,26 @@ int dom_checkpoint_recover(dom_server_runtime* runtime,
 
 void dom_checkpoint_record_dispose(dom_checkpoint_record* record)
 {
+    dom_checkpoint_pages* sections[DOM_CHECKPOINT_RECORD_SECTIONS];
     u32 i;
     if (!record) {
         return;
     }
-    for (i = 0u; i < DOM_SERVER_MAX_SHARDS; ++i) {
-        if (record->world_clones[i]) {
-            d_world_destroy_instance(record->world_clones[i]);
-            record->world_clones[i] = (d_world*)0;
+    dom_checkpoint_record_sections(record, sections);
+    for (i = 0u; i < DOM_CHECKPOINT_RECORD_SECTIONS; ++i) {
+        dom_checkpoint_pages_release(sections[i]);
+    }
+    if (record->shards) {
+        for (i = 0u; i < record->manifest.shard_count; ++i) {
+            dom_shard_checkpoint* chk = &record->shards[i];
+            dom_checkpoint_pages_release(&chk->scale_events);
+            dom_checkpoint_pages_release(&chk->world_image);
+            free(chk->domains);
+            chk->domains = 0;
+            chk->domain_hashes = 0;
+            chk->capsule_ids = 0;
         }
+        free(record->shards);
+        record->shards = 0;
     }
 }
@@ -12,8 +12,8 @@ RESPONSIBILITY: Deterministic MMO checkpoint capture and recovery helpers.
 #include "domino/sim/sim.h"
 
 #include "persistence/dom_checkpoint_policy.h"
-#include "dom_server_protocol.h"
-#include "dom_server_types.h"
+#include "dom_server_protocol.h"
+#include "dom_server_types.h"
 #include "shard/dom_cross_shard_log.h"
 #include "shard/dom_shard_lifecycle.h"
 
@@ -23,6 +23,30 @@ extern "C" {
 
 typedef struct dom_server_runtime dom_server_runtime;
 
+#define DOM_CHECKPOINT_PAGE_BYTES 4096u
+
+/* Immutable, refcounted slice of a checkpoint image. */
+typedef struct dom_checkpoint_page {
+    u32 refs;
+    u32 bytes;
+    u64 hash;
+    unsigned char data[DOM_CHECKPOINT_PAGE_BYTES];
+} dom_checkpoint_page;
+
+/*
+Byte image of one runtime array or world, split into pages. Records captured
+incrementally point at the previous record's pages wherever the bytes did not
+change, so only dirty pages are copied and hashed. Dirty pages are found by
+comparing against the previous record, not tracked at write time: a capture
+still serializes each world and reads every page, so its cost is O(state
+size); storage and hashing are what scale with the dirty pages.
+*/
+typedef struct dom_checkpoint_pages {
+    u32 bytes;
+    u32 page_count;
+    dom_checkpoint_page** pages;
+} dom_checkpoint_pages;
+
 typedef struct dom_checkpoint_manifest {
     u32 schema_version;
     u64 checkpoint_id;
@@ -38,6 +62,10 @@ typedef struct dom_checkpoint_manifest {
     u32 event_count;
     u32 event_overflow;
     u32 shard_count;
+    u64 base_checkpoint_id; /* own id for base records */
+    u32 chain_length;       /* records since the last base; 0 for a base */
+    u32 pages_written;
+    u32 pages_shared;
 } dom_checkpoint_manifest;
 
 typedef struct dom_shard_checkpoint {
@@ -49,30 +77,26 @@ typedef struct dom_shard_checkpoint {
     u64 baseline_hash;
     u64 world_checksum;
     u32 domain_count;
-    dom_scale_domain_slot domains[DOM_SERVER_MAX_DOMAINS_PER_SHARD];
+    dom_scale_domain_slot* domains; /* owns domain_hashes and capsule_ids too */
+    u64* domain_hashes;
+    u64* capsule_ids;
     dom_scale_resource_entry resource_entries[8];
     dom_scale_network_node network_nodes[8];
     dom_scale_network_edge network_edges[8];
     dom_scale_agent_entry agent_entries[16];
-    u64 domain_hashes[DOM_SERVER_MAX_DOMAINS_PER_SHARD];
-    u64 capsule_ids[DOM_SERVER_MAX_DOMAINS_PER_SHARD];
     dom_scale_budget_state budget_state;
     dom_scale_budget_snapshot budget_snapshot;
     u64 scale_event_hash;
     u32 scale_event_count;
     u32 scale_event_overflow;
-    dom_scale_event scale_events[256];
+    dom_checkpoint_pages scale_events;
+    dom_checkpoint_pages world_image;
     u64 shard_hash;
 } dom_shard_checkpoint;
 
-typedef struct dom_checkpoint_deferred_intent {
-    dom_server_intent intent;
-    u32 refusal_code;
-} dom_checkpoint_deferred_intent;
-
 typedef struct dom_checkpoint_record {
     dom_checkpoint_manifest manifest;
-    dom_shard_checkpoint shards[DOM_SERVER_MAX_SHARDS];
+    dom_shard_checkpoint* shards; /* manifest.shard_count entries */
 
     u32 lifecycle_count;
     u32 lifecycle_overflow;
@@ -80,25 +104,23 @@ typedef struct dom_checkpoint_record {
 
     u32 intent_count;
     u32 intent_overflow;
-    dom_server_intent intents[DOM_SERVER_MAX_INTENTS];
+    dom_checkpoint_pages intents;
 
     u32 deferred_count;
     u32 deferred_overflow;
-    dom_checkpoint_deferred_intent deferred[DOM_SERVER_MAX_DEFERRED];
+    dom_checkpoint_pages deferred;
 
     u32 event_count;
     u32 event_overflow;
-    dom_server_event events[DOM_SERVER_MAX_EVENTS];
+    dom_checkpoint_pages events;
 
     u32 owner_count;
-    dom_server_domain_owner owners[DOM_SERVER_MAX_DOMAIN_OWNERS];
+    dom_checkpoint_pages owners;
 
     u32 message_count;
-    dom_cross_shard_message messages[DOM_SERVER_MAX_MESSAGES];
+    dom_checkpoint_pages messages;
     u32 idempotency_count;
-    dom_cross_shard_idempotency_entry idempotency[DOM_SERVER_MAX_IDEMPOTENCY];
-
-    d_world* world_clones[DOM_SERVER_MAX_SHARDS];
+    dom_checkpoint_pages idempotency;
 } dom_checkpoint_record;
 
 typedef struct dom_checkpoint_store {
@@ -117,6 +139,7 @@ int dom_checkpoint_store_record(dom_checkpoint_store* store,
                                 dom_checkpoint_record* record);
 u64 dom_checkpoint_store_hash(const dom_checkpoint_store* store);
 
+/* Shares unchanged pages with the store's last record unless a base is due. */
 int dom_checkpoint_capture(dom_checkpoint_record* out_record,
                            const dom_server_runtime* runtime,
                            u32 trigger_reason);
@@ -110,6 +110,9 @@ def test_crash_recovery(tools_path):
     if after_1 != after_4:
         sys.stderr.write("FAIL: recovery hash differs across worker counts\n")
         raise SystemExit(1)
+    if as_int(data_1, "recover.chain_length") <= 0 or as_int(data_1, "recover.pages_shared") <= 0:
+        sys.stderr.write("FAIL: recovered checkpoint was not incremental\n")
+        raise SystemExit(1)
 
 
 def test_rolling_updates(tools_path):
@@ -0,0 +1,267 @@
+/*
+Content startup benchmark: full pack parse (cold) versus binary cache (warm).
+
+Usage: content_cache_bench [--quick]
+Builds a synthetic pack set close to the registry capacities, then times:
+  cold  d_content_init + hash packs + d_content_load_pack for every pack
+  save  d_content_cache_save of the resolved registries
+  warm  d_content_init + hash packs + d_content_cache_load
+plus id and name lookups over the adopted registries. Prints milliseconds.
+--quick shrinks the pack set so the run can double as a smoke test; the run
+fails if the warm registries differ from the cold ones.
+*/
+#include "d_content.h"
+#include "d_content_schema.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_CACHE_PATH "content_cache_bench.dcc"
+#define BENCH_PACKS 4u
+
+typedef std::vector<unsigned char> bench_bytes;
+
+/* Wall clock; the dsys timer is deterministic under the headless backend. */
+static u64 bench_now_ns(void)
+{
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double bench_ms(u64 ns)
+{
+    return (double)ns / 1000000.0;
+}
+
+static void put(bench_bytes& out, u32 tag, const void* data, u32 n)
+{
+    size_t at = out.size();
+    out.resize(at + 8u + n);
+    memcpy(&out[at], &tag, 4u);
+    memcpy(&out[at + 4u], &n, 4u);
+    if (n > 0u) {
+        memcpy(&out[at + 8u], data, n);
+    }
+}
+
+static void put_u32(bench_bytes& out, u32 tag, u32 v)
+{
+    put(out, tag, &v, 4u);
+}
+
+static void put_name(bench_bytes& out, u32 tag, const char* prefix, u32 i)
+{
+    char name[48];
+    sprintf(name, "%s.%u", prefix, (unsigned int)i);
+    put(out, tag, name, (u32)strlen(name) + 1u);
+}
+
+static void put_params(bench_bytes& out, u32 tag, u32 seed)
+{
+    unsigned char bytes[64];
+    u32 len = 16u + seed % 48u;
+    u32 b;
+    for (b = 0u; b < len; ++b) {
+        bytes[b] = (unsigned char)(seed * 31u + b);
+    }
+    put(out, tag, bytes, len);
+}
+
+static void end_record(bench_bytes& pack, bench_bytes& rec, u32 schema_id)
+{
+    put(pack, schema_id, rec.data(), (u32)rec.size());
+    rec.clear();
+}
+
+/* Spreads each kind across the packs so every pack carries a mix. */
+static void build_packs(std::vector<bench_bytes>& packs, u32 scale_div)
+{
+    bench_bytes rec;
+    bench_bytes nest;
+    u32 materials = 4000u / scale_div;
+    u32 items = 8000u / scale_div;
+    u32 processes = 4000u / scale_div;
+    u32 structures = 2000u / scale_div;
+    u32 research = 4000u / scale_div;
+    u32 i;
+    u32 j;
+    packs.assign(BENCH_PACKS, bench_bytes());
+    for (i = 0u; i < materials; ++i) {
+        bench_bytes& pack = packs[i % BENCH_PACKS];
+        put_u32(rec, D_FIELD_MATERIAL_ID, 1u + i);
+        put_name(rec, D_FIELD_MATERIAL_NAME, "material", i);
+        put_u32(rec, D_FIELD_MATERIAL_DENSITY, i * 7u);
+        put_u32(rec, D_FIELD_MATERIAL_HARDNESS, i * 3u);
+        end_record(pack, rec, D_TLV_SCHEMA_MATERIAL_V1);
+    }
+    for (i = 0u; i < items; ++i) {
+        bench_bytes& pack = packs[i % BENCH_PACKS];
+        put_u32(rec, D_FIELD_ITEM_ID, 1u + i);
+        put_name(rec, D_FIELD_ITEM_NAME, "item", i);
+        put_u32(rec, D_FIELD_ITEM_MATERIAL, 1u + i % materials);
+        put_u32(rec, D_FIELD_ITEM_UNIT_MASS, 65536u + i);
+        end_record(pack, rec, D_TLV_SCHEMA_ITEM_V1);
+    }
+    for (i = 0u; i < structures; ++i) {
+        bench_bytes& pack = packs[i % BENCH_PACKS];
+        put_u32(rec, D_FIELD_STRUCTURE_ID, 1u + i);
+        put_name(rec, D_FIELD_STRUCTURE_NAME, "structure", i);
+        put_params(rec, D_FIELD_STRUCTURE_LAYOUT, i);
+        put_params(rec, D_FIELD_STRUCTURE_IO, i + 1u);
+        end_record(pack, rec, D_TLV_SCHEMA_STRUCTURE_V1);
+    }
+    for (i = 0u; i < processes; ++i) {
+        bench_bytes& pack = packs[i % BENCH_PACKS];
+        put_u32(rec, D_FIELD_PROCESS_ID, 1u + i);
+        put_name(rec, D_FIELD_PROCESS_NAME, "process", i);
+        put_params(rec, D_FIELD_PROCESS_PARAMS, i);
+        for (j = 0u; j < 4u; ++j) {
+            u16 kind = (u16)(1u + j % 2u);
+            nest.clear();
+            put(nest, D_FIELD_PROCESS_IO_KIND, &kind, 2u);
+            put_u32(nest, D_FIELD_PROCESS_IO_ITEM_ID, 1u + (i + j) % items);
+            put_u32(nest, D_FIELD_PROCESS_IO_RATE, 65536u);
+            put(rec, D_FIELD_PROCESS_IO_TERM, nest.data(), (u32)nest.size());
+        }
+        end_record(pack, rec, D_TLV_SCHEMA_PROCESS_V1);
+    }
+    for (i = 0u; i < research; ++i) {
+        bench_bytes& pack = packs[i % BENCH_PACKS];
+        put_u32(rec, D_FIELD_RESEARCH_ID, 1u + i);
+        put_name(rec, D_FIELD_RESEARCH_NAME, "research", i);
+        for (j = 0u; j < 3u && j < i; ++j) {
+            put_u32(rec, D_FIELD_RESEARCH_PREREQ_ID, i - j);
+        }
+        put_params(rec, D_FIELD_RESEARCH_COST, i);
+        end_record(pack, rec, D_TLV_SCHEMA_RESEARCH_V1);
+    }
+}
+
+static u64 hash_packs(const std::vector<d_proto_pack_manifest>& manifests)
+{
+    u64 hash = D_CONTENT_HASH_SEED;
+    size_t i;
+    for (i = 0u; i < manifests.size(); ++i) {
+        hash = d_content_hash_pack(hash, &manifests[i]);
+    }
+    return hash;
+}
+
+/* Order-sensitive digest of what the registries resolve to. */
+static u64 registry_digest(void)
+{
+    u64 h = 1469598103934665603ULL;
+    u32 i;
+    u32 j;
+    for (i = 0u; i < d_content_process_count(); ++i) {
+        const d_proto_process* p = d_content_get_process_by_index(i);
+        h = (h ^ p->id) * 1099511628211ULL;
+        h = (h ^ (u64)strlen(p->name)) * 1099511628211ULL;
+        h = (h ^ p->params.len) * 1099511628211ULL;
+        for (j = 0u; j < p->io_count; ++j) {
+            h = (h ^ p->io_terms[j].item_id) * 1099511628211ULL;
+        }
+    }
+    for (i = 0u; i < d_content_research_count(); ++i) {
+        const d_proto_research* r = d_content_get_research_by_index(i);
+        h = (h ^ r->id) * 1099511628211ULL;
+        for (j = 0u; j < r->prereq_count; ++j) {
+            h = (h ^ r->prereq_ids[j]) * 1099511628211ULL;
+        }
+    }
+    h = (h ^ d_content_material_count()) * 1099511628211ULL;
+    h = (h ^ d_content_item_count()) * 1099511628211ULL;
+    h = (h ^ d_content_structure_count()) * 1099511628211ULL;
+    return h;
+}
+
+int main(int argc, char** argv)
+{
+    const bool quick = (argc > 1 && strcmp(argv[1], "--quick") == 0);
+    std::vector<bench_bytes> packs;
+    std::vector<d_proto_pack_manifest> manifests;
+    size_t total_bytes = 0u;
+    u64 start;
+    u64 cold_ns;
+    u64 save_ns;
+    u64 warm_ns;
+    u64 lookup_ns;
+    u64 cold_digest;
+    u64 hash;
+    u32 items;
+    u32 found = 0u;
+    u32 i;
+    char name[48];
+
+    d_content_register_schemas();
+    build_packs(packs, quick ? 16u : 1u);
+    manifests.resize(packs.size());
+    for (i = 0u; i < (u32)packs.size(); ++i) {
+        memset(&manifests[i], 0, sizeof(manifests[i]));
+        manifests[i].id = 1u + i;
+        manifests[i].version = 1u;
+        manifests[i].content_tlv.ptr = packs[i].data();
+        manifests[i].content_tlv.len = (u32)packs[i].size();
+        total_bytes += packs[i].size();
+    }
+
+    start = bench_now_ns();
+    d_content_init();
+    hash = hash_packs(manifests);
+    for (i = 0u; i < (u32)manifests.size(); ++i) {
+        if (d_content_load_pack(&manifests[i]) != 0) {
+            fprintf(stderr, "content_cache_bench: pack %u failed to load\n", (unsigned int)i);
+            return 1;
+        }
+    }
+    cold_ns = bench_now_ns() - start;
+    cold_digest = registry_digest();
+
+    start = bench_now_ns();
+    if (d_content_cache_save(BENCH_CACHE_PATH, hash) != 0) {
+        fprintf(stderr, "content_cache_bench: cache save failed\n");
+        return 1;
+    }
+    save_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    d_content_init();
+    hash = hash_packs(manifests);
+    if (d_content_cache_load(BENCH_CACHE_PATH, hash) != 0) {
+        fprintf(stderr, "content_cache_bench: cache load missed\n");
+        remove(BENCH_CACHE_PATH);
+        return 1;
+    }
+    warm_ns = bench_now_ns() - start;
+    if (registry_digest() != cold_digest) {
+        fprintf(stderr, "content_cache_bench: warm registries differ from cold\n");
+        remove(BENCH_CACHE_PATH);
+        return 1;
+    }
+
+    items = d_content_item_count();
+    start = bench_now_ns();
+    for (i = 0u; i < items; ++i) {
+        sprintf(name, "item.%u", (unsigned int)i);
+        if (d_content_get_item(1u + i) == d_content_get_item_by_name(name)) {
+            found += 1u;
+        }
+    }
+    lookup_ns = bench_now_ns() - start;
+    d_content_shutdown();
+    remove(BENCH_CACHE_PATH);
+    if (found != items) {
+        fprintf(stderr, "content_cache_bench: id and name lookups disagree\n");
+        return 1;
+    }
+
+    printf("content_cache_bench: %u packs, %.1f KiB TLV, %u items\n",
+           (unsigned int)manifests.size(), (double)total_bytes / 1024.0, (unsigned int)items);
+    printf("  cold (parse)      %9.3f ms\n", bench_ms(cold_ns));
+    printf("  cache save        %9.3f ms\n", bench_ms(save_ns));
+    printf("  warm (cache)      %9.3f ms\n", bench_ms(warm_ns));
+    printf("  id+name lookups   %9.1f ns/item\n", (double)lookup_ns / (double)(items ? items : 1u));
+    return 0;
+}
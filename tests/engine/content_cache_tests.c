@@ -0,0 +1,381 @@
+/*
+Content registry tests: hashed id/name lookup, binary cache round trip
+against a full parse, and cache rejection (stale hash, corruption, missing).
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "d_content.h"
+#include "d_content_schema.h"
+#include "d_registry.h"
+
+#define CACHE_PATH "content_cache_test.dcc"
+#define MATERIALS 400u
+#define ITEMS 600u
+#define STRUCTURES 150u
+#define PROCESSES 200u
+#define RESEARCH 120u
+
+static unsigned char g_content[1u << 20];
+static u32 g_content_len;
+static unsigned char g_rec[4096];
+static u32 g_rec_len;
+static unsigned char g_nest[256];
+static u32 g_nest_len;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static void put(unsigned char* buf, u32* len, u32 tag, const void* data, u32 n)
+{
+    memcpy(buf + *len, &tag, 4u);
+    memcpy(buf + *len + 4u, &n, 4u);
+    if (n > 0u) {
+        memcpy(buf + *len + 8u, data, n);
+    }
+    *len += 8u + n;
+}
+
+static void put_u32(unsigned char* buf, u32* len, u32 tag, u32 v)
+{
+    put(buf, len, tag, &v, 4u);
+}
+
+static void put_u16(unsigned char* buf, u32* len, u32 tag, u16 v)
+{
+    put(buf, len, tag, &v, 2u);
+}
+
+static void put_name(u32 tag, const char* name)
+{
+    put(g_rec, &g_rec_len, tag, name, (u32)strlen(name) + 1u);
+}
+
+static void end_record(u32 schema_id)
+{
+    put(g_content, &g_content_len, schema_id, g_rec, g_rec_len);
+    g_rec_len = 0u;
+}
+
+/* Deterministic blob bytes; length 0 means the field is absent. */
+static u32 blob_len(u32 seed)
+{
+    return (seed % 5u == 0u) ? 0u : 1u + seed % 23u;
+}
+
+static void fill_blob(unsigned char* out, u32 seed, u32 len)
+{
+    u32 b;
+    for (b = 0u; b < len; ++b) {
+        out[b] = (unsigned char)((seed * 13u + b * 7u) & 0xFFu);
+    }
+}
+
+static void put_blob(u32 tag, u32 seed)
+{
+    unsigned char bytes[32];
+    u32 len = blob_len(seed);
+    if (len > 0u) {
+        fill_blob(bytes, seed, len);
+        put(g_rec, &g_rec_len, tag, bytes, len);
+    }
+}
+
+static void item_name(char* out, u32 i)
+{
+    if (i == 7u || i == 8u) {
+        strcpy(out, "item.dup");
+    } else {
+        sprintf(out, "item.%u", (unsigned int)i);
+    }
+}
+
+static void build_content(void)
+{
+    char name[32];
+    u32 i;
+    u32 j;
+    g_content_len = 0u;
+    for (i = 0u; i < MATERIALS; ++i) {
+        sprintf(name, "mat.%u", (unsigned int)i);
+        put_u32(g_rec, &g_rec_len, D_FIELD_MATERIAL_ID, 1000u + i);
+        put_name(D_FIELD_MATERIAL_NAME, name);
+        put_u32(g_rec, &g_rec_len, D_FIELD_MATERIAL_DENSITY, i * 3u);
+        end_record(D_TLV_SCHEMA_MATERIAL_V1);
+    }
+    for (i = 0u; i < ITEMS; ++i) {
+        item_name(name, i);
+        put_u32(g_rec, &g_rec_len, D_FIELD_ITEM_ID, 5000u + i);
+        put_name(D_FIELD_ITEM_NAME, name);
+        put_u32(g_rec, &g_rec_len, D_FIELD_ITEM_MATERIAL, 1000u + i % MATERIALS);
+        end_record(D_TLV_SCHEMA_ITEM_V1);
+    }
+    for (i = 0u; i < STRUCTURES; ++i) {
+        sprintf(name, "st.%u", (unsigned int)i);
+        put_u32(g_rec, &g_rec_len, D_FIELD_STRUCTURE_ID, 9000u + i);
+        put_name(D_FIELD_STRUCTURE_NAME, name);
+        put_blob(D_FIELD_STRUCTURE_LAYOUT, i);
+        put_blob(D_FIELD_STRUCTURE_IO, i + 1u);
+        put_blob(D_FIELD_STRUCTURE_PROCESSES, i + 2u);
+        end_record(D_TLV_SCHEMA_STRUCTURE_V1);
+    }
+    for (i = 0u; i < PROCESSES; ++i) {
+        sprintf(name, "proc.%u", (unsigned int)i);
+        put_u32(g_rec, &g_rec_len, D_FIELD_PROCESS_ID, 20000u + i);
+        put_name(D_FIELD_PROCESS_NAME, name);
+        put_blob(D_FIELD_PROCESS_PARAMS, i + 3u);
+        for (j = 0u; j < i % 4u; ++j) {
+            g_nest_len = 0u;
+            put_u16(g_nest, &g_nest_len, D_FIELD_PROCESS_IO_KIND, (u16)(1u + j % 2u));
+            put_u32(g_nest, &g_nest_len, D_FIELD_PROCESS_IO_ITEM_ID, 5000u + (i + j) % ITEMS);
+            put_u32(g_nest, &g_nest_len, D_FIELD_PROCESS_IO_RATE, i * 16u + j);
+            put(g_rec, &g_rec_len, D_FIELD_PROCESS_IO_TERM, g_nest, g_nest_len);
+        }
+        for (j = 0u; j < i % 3u; ++j) {
+            q32_32 amount = (q32_32)(i * 100u + j);
+            g_nest_len = 0u;
+            put_u16(g_nest, &g_nest_len, D_FIELD_RY_KIND, (u16)j);
+            put(g_nest, &g_nest_len, D_FIELD_RY_AMOUNT, &amount, 8u);
+            put(g_rec, &g_rec_len, D_FIELD_PROCESS_RESEARCH_YIELD, g_nest, g_nest_len);
+        }
+        end_record(D_TLV_SCHEMA_PROCESS_V1);
+    }
+    for (i = 0u; i < RESEARCH; ++i) {
+        sprintf(name, "res.%u", (unsigned int)i);
+        put_u32(g_rec, &g_rec_len, D_FIELD_RESEARCH_ID, 30000u + i);
+        put_name(D_FIELD_RESEARCH_NAME, name);
+        for (j = 0u; j < i % 4u && j < i; ++j) {
+            put_u32(g_rec, &g_rec_len, D_FIELD_RESEARCH_PREREQ_ID, 30000u + i - 1u - j);
+        }
+        put_blob(D_FIELD_RESEARCH_UNLOCKS, i + 4u);
+        end_record(D_TLV_SCHEMA_RESEARCH_V1);
+    }
+}
+
+static int blob_matches(const d_tlv_blob* blob, u32 seed)
+{
+    unsigned char bytes[32];
+    u32 len = blob_len(seed);
+    if (len == 0u) {
+        return blob->ptr == (unsigned char*)0 && blob->len == 0u;
+    }
+    fill_blob(bytes, seed, len);
+    return blob->ptr && blob->len == len && memcmp(blob->ptr, bytes, len) == 0;
+}
+
+static int verify_content(void)
+{
+    char name[32];
+    u32 i;
+    u32 j;
+    if (d_content_material_count() != MATERIALS || d_content_item_count() != ITEMS ||
+        d_content_structure_count() != STRUCTURES || d_content_process_count() != PROCESSES ||
+        d_content_research_count() != RESEARCH) {
+        return fail("registry counts");
+    }
+    for (i = 0u; i < MATERIALS; ++i) {
+        const d_proto_material* m = d_content_get_material(1000u + i);
+        sprintf(name, "mat.%u", (unsigned int)i);
+        if (!m || m != d_content_get_material_by_index(i) || m != d_content_get_material_by_name(name) ||
+            strcmp(m->name, name) != 0 || m->density != (q16_16)(i * 3u)) {
+            return fail("material lookup");
+        }
+    }
+    for (i = 0u; i < ITEMS; ++i) {
+        const d_proto_item* it = d_content_get_item(5000u + i);
+        item_name(name, i);
+        if (!it || it != d_content_get_item_by_index(i) || strcmp(it->name, name) != 0 ||
+            it->material_id != 1000u + i % MATERIALS) {
+            return fail("item lookup");
+        }
+        if (i != 8u && it != d_content_get_item_by_name(name)) {
+            return fail("item name lookup");
+        }
+    }
+    /* Duplicate names resolve to the first registration. */
+    if (d_content_get_item_by_name("item.dup") != d_content_get_item(5007u)) {
+        return fail("duplicate name keeps first");
+    }
+    for (i = 0u; i < STRUCTURES; ++i) {
+        const d_proto_structure* st = d_content_get_structure(9000u + i);
+        sprintf(name, "st.%u", (unsigned int)i);
+        if (!st || st != d_content_get_structure_by_name(name) ||
+            !blob_matches(&st->layout, i) || !blob_matches(&st->io, i + 1u) ||
+            !blob_matches(&st->processes, i + 2u)) {
+            return fail("structure blobs");
+        }
+    }
+    for (i = 0u; i < PROCESSES; ++i) {
+        const d_proto_process* p = d_content_get_process(20000u + i);
+        sprintf(name, "proc.%u", (unsigned int)i);
+        if (!p || p != d_content_get_process_by_name(name) || !blob_matches(&p->params, i + 3u) ||
+            p->io_count != i % 4u || p->research_yield_count != i % 3u ||
+            (p->io_count == 0u) != (p->io_terms == (d_process_io_term*)0) ||
+            (p->research_yield_count == 0u) != (p->research_yields == (d_research_point_yield*)0)) {
+            return fail("process lookup");
+        }
+        for (j = 0u; j < p->io_count; ++j) {
+            if (p->io_terms[j].kind != 1u + j % 2u || p->io_terms[j].item_id != 5000u + (i + j) % ITEMS ||
+                p->io_terms[j].rate != (q16_16)(i * 16u + j)) {
+                return fail("process io terms");
+            }
+        }
+        for (j = 0u; j < p->research_yield_count; ++j) {
+            if (p->research_yields[j].kind != j || p->research_yields[j].amount != (q32_32)(i * 100u + j)) {
+                return fail("process research yields");
+            }
+        }
+    }
+    for (i = 0u; i < RESEARCH; ++i) {
+        const d_proto_research* r = d_content_get_research(30000u + i);
+        u32 prereqs = (i % 4u < i) ? i % 4u : i;
+        sprintf(name, "res.%u", (unsigned int)i);
+        if (!r || r != d_content_get_research_by_name(name) || r->prereq_count != prereqs ||
+            !blob_matches(&r->unlocks, i + 4u)) {
+            return fail("research lookup");
+        }
+        for (j = 0u; j < prereqs; ++j) {
+            if (r->prereq_ids[j] != 30000u + i - 1u - j) {
+                return fail("research prereqs");
+            }
+        }
+    }
+    if (d_content_get_material(999u) || d_content_get_material_by_name("mat.missing") ||
+        d_content_get_material_by_name("") || d_content_get_material_by_name((const char*)0) ||
+        d_content_get_blueprint_by_name("mat.0")) {
+        return fail("lookup misses");
+    }
+    return 0;
+}
+
+static int load_packs(d_proto_pack_manifest* pack)
+{
+    memset(pack, 0, sizeof(*pack));
+    pack->id = 1u;
+    pack->version = 3u;
+    pack->content_tlv.ptr = g_content;
+    pack->content_tlv.len = g_content_len;
+    d_content_init();
+    return d_content_load_pack(pack);
+}
+
+static int test_registry_index(void)
+{
+    d_registry reg;
+    d_registry_entry entries[8];
+    u32 slots[16];
+    int values[8];
+    u32 i;
+    d_registry_init(&reg, entries, 8u, 1u);
+    for (i = 0u; i < 3u; ++i) {
+        (void)d_registry_add_with_id(&reg, 100u + i * 16u, &values[i]);
+    }
+    if (d_registry_attach_index(&reg, slots, 8u) == 0 || d_registry_attach_index(&reg, slots, 12u) == 0) {
+        return fail("index capacity must be a larger power of two");
+    }
+    if (d_registry_attach_index(&reg, slots, 16u) != 0) {
+        return fail("attach index");
+    }
+    /* Entries added before the attach are indexed too. */
+    for (i = 0u; i < 3u; ++i) {
+        if (d_registry_get(&reg, 100u + i * 16u) != &values[i]) {
+            return fail("indexed get");
+        }
+    }
+    if (d_registry_add_with_id(&reg, 116u, &values[3]) != 0u ||
+        d_registry_add(&reg, &values[3]) != 133u || d_registry_get(&reg, 133u) != &values[3] ||
+        d_registry_get(&reg, 117u) != (void*)0) {
+        return fail("indexed add");
+    }
+    return 0;
+}
+
+static int test_cache_round_trip(void)
+{
+    d_proto_pack_manifest pack;
+    u64 hash;
+    u64 stale;
+    FILE* fp;
+    long size;
+    int c;
+
+    build_content();
+    if (load_packs(&pack) != 0) {
+        return fail("parse packs");
+    }
+    hash = d_content_hash_pack(D_CONTENT_HASH_SEED, &pack);
+    if (verify_content() != 0) {
+        return fail("parsed content");
+    }
+    if (d_content_cache_save(CACHE_PATH, hash) != 0) {
+        return fail("cache save");
+    }
+
+    /* Warm start: the registries come from the cache alone. */
+    d_content_init();
+    memset(g_content, 0, sizeof(g_content));
+    if (d_content_cache_load(CACHE_PATH, hash) != 0) {
+        return fail("cache load");
+    }
+    if (verify_content() != 0) {
+        return fail("adopted content");
+    }
+
+    /* Saving adopted content reproduces an equivalent cache. */
+    if (d_content_cache_save(CACHE_PATH, hash) != 0 || d_content_cache_load(CACHE_PATH, hash) != 0 ||
+        verify_content() != 0) {
+        return fail("re-save adopted content");
+    }
+
+    /* A different pack set is a miss and leaves the registries alone. */
+    build_content();
+    pack.version = 4u;
+    stale = d_content_hash_pack(D_CONTENT_HASH_SEED, &pack);
+    if (stale == hash || d_content_cache_load(CACHE_PATH, stale) != 1 || verify_content() != 0) {
+        return fail("stale hash rejected");
+    }
+    if (d_content_cache_load("content_cache_missing.dcc", hash) != 1) {
+        return fail("missing cache rejected");
+    }
+
+    /* Flip a byte near the end of the payload; the checksum catches it. */
+    fp = fopen(CACHE_PATH, "r+b");
+    if (!fp) {
+        return fail("open cache");
+    }
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, size / 3L, SEEK_SET);
+    c = fgetc(fp);
+    fseek(fp, size / 3L, SEEK_SET);
+    fputc((c ^ 0x5A) & 0xFF, fp);
+    fclose(fp);
+    if (d_content_cache_load(CACHE_PATH, hash) != 1) {
+        return fail("corrupt cache rejected");
+    }
+
+    d_content_shutdown();
+    if (d_content_material_count() != 0u || d_content_get_material_by_name("mat.0")) {
+        return fail("shutdown clears registries and names");
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int rc;
+    d_content_register_schemas();
+    rc = test_registry_index();
+    if (rc == 0) {
+        rc = test_cache_round_trip();
+    }
+    remove(CACHE_PATH);
+    if (rc != 0) {
+        return 1;
+    }
+    printf("content_cache tests passed\n");
+    return 0;
+}
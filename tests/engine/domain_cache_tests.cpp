@@ -0,0 +1,281 @@
+/*
+Shared domain tile cache tests (DOMAIN1).
+
+Covers hashed lookup at scale, LRU eviction order, time-windowed keys, the
+byte budget, typed tile ops, invalidation and hit/miss/eviction reporting.
+*/
+#include "domino/world/domain_cache.h"
+#include "domino/system/dsys_perf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+static dom_domain_tile* make_tile(dom_domain_tile* tile, u64 tile_id, u32 sample_count)
+{
+    u32 i;
+    dom_domain_tile_init(tile);
+    tile->tile_id = tile_id;
+    tile->resolution = DOM_DOMAIN_RES_FULL;
+    tile->authoring_version = 1u;
+    tile->sample_count = sample_count;
+    tile->samples = sample_count ? (q16_16*)malloc(sizeof(q16_16) * sample_count) : (q16_16*)0;
+    for (i = 0u; i < sample_count; ++i) {
+        tile->samples[i] = (q16_16)(tile_id * 1000u + i);
+    }
+    return tile;
+}
+
+static d_bool has_tile(const dom_domain_cache* cache, dom_domain_id domain_id, u64 tile_id)
+{
+    return dom_domain_cache_peek(cache, domain_id, tile_id, DOM_DOMAIN_RES_FULL, 1u) != 0;
+}
+
+static int test_lookup_at_scale(void)
+{
+    dom_domain_cache cache;
+    dom_domain_tile tile;
+    u32 i;
+
+    dom_domain_cache_init(&cache);
+    EXPECT(dom_domain_cache_reserve(&cache, 64u) == 0, "reserve");
+    for (i = 0u; i < 64u; ++i) {
+        EXPECT(dom_domain_cache_put(&cache, 7u, make_tile(&tile, i, 4u)) != 0, "put");
+        EXPECT(tile.samples == 0, "put takes ownership");
+    }
+    /* Growing rehashes live entries in place. */
+    EXPECT(dom_domain_cache_reserve(&cache, 4096u) == 0, "grow");
+    for (i = 64u; i < 4096u; ++i) {
+        EXPECT(dom_domain_cache_put(&cache, 7u, make_tile(&tile, i, 4u)) != 0, "put after grow");
+    }
+    EXPECT(cache.count == 4096u, "count");
+    for (i = 0u; i < 4096u; ++i) {
+        const dom_domain_tile* hit = dom_domain_cache_get(&cache, 7u, i, DOM_DOMAIN_RES_FULL, 1u);
+        EXPECT(hit && hit->tile_id == i && hit->samples[3] == (q16_16)(i * 1000u + 3u), "hit");
+    }
+    EXPECT(dom_domain_cache_get(&cache, 8u, 5u, DOM_DOMAIN_RES_FULL, 1u) == 0, "other domain");
+    EXPECT(dom_domain_cache_get(&cache, 7u, 5u, DOM_DOMAIN_RES_COARSE, 1u) == 0, "other resolution");
+    EXPECT(dom_domain_cache_get(&cache, 7u, 5u, DOM_DOMAIN_RES_FULL, 2u) == 0, "other version");
+    EXPECT(cache.stats.hits == 4096u && cache.stats.misses == 3u, "stats");
+    dom_domain_cache_free(&cache);
+    EXPECT(cache.entries == 0 && cache.count == 0u, "free");
+    return 0;
+}
+
+static int test_lru_order(void)
+{
+    dom_domain_cache cache;
+    dom_domain_tile tile;
+
+    dom_domain_cache_init(&cache);
+    EXPECT(dom_domain_cache_reserve(&cache, 3u) == 0, "reserve");
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 10u, 1u));
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 11u, 1u));
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 12u, 1u));
+
+    /* A hit refreshes 10, so 11 is the least recently used. */
+    EXPECT(dom_domain_cache_get(&cache, 1u, 10u, DOM_DOMAIN_RES_FULL, 1u) != 0, "get 10");
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 13u, 1u));
+    EXPECT(!has_tile(&cache, 1u, 11u), "11 evicted");
+    EXPECT(cache.stats.evictions == 1u, "eviction counted");
+
+    /* Peeking does not refresh; replacing an entry does. */
+    EXPECT(has_tile(&cache, 1u, 12u), "peek 12");
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 10u, 2u));
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 14u, 1u));
+    EXPECT(!has_tile(&cache, 1u, 12u), "12 evicted");
+    EXPECT(has_tile(&cache, 1u, 10u) && has_tile(&cache, 1u, 13u) && has_tile(&cache, 1u, 14u),
+           "survivors");
+    EXPECT(dom_domain_cache_peek(&cache, 1u, 10u, DOM_DOMAIN_RES_FULL, 1u)->sample_count == 2u,
+           "replaced in place");
+    EXPECT(cache.count == 3u, "count");
+    dom_domain_cache_free(&cache);
+    return 0;
+}
+
+static int test_window_keys(void)
+{
+    dom_domain_cache cache;
+    dom_domain_cache_key key;
+    dom_domain_tile tile;
+    const dom_domain_tile* hit;
+
+    dom_domain_cache_init(&cache);
+    EXPECT(dom_domain_cache_reserve(&cache, 8u) == 0, "reserve");
+    dom_domain_cache_key_init(&key, 3u, 40u, DOM_DOMAIN_RES_FULL, 1u);
+    key.window_start = 0u;
+    key.window_ticks = 100u;
+    EXPECT(dom_domain_cache_put_tile(&cache, &key, make_tile(&tile, 40u, 1u)) != 0, "put w0");
+    key.window_start = 100u;
+    EXPECT(dom_domain_cache_put_tile(&cache, &key, make_tile(&tile, 40u, 2u)) != 0, "put w1");
+    EXPECT(cache.count == 2u, "windows are distinct entries");
+
+    hit = (const dom_domain_tile*)dom_domain_cache_get_tile(&cache, &key);
+    EXPECT(hit && hit->sample_count == 2u, "window 1 hit");
+    key.window_start = 0u;
+    hit = (const dom_domain_tile*)dom_domain_cache_get_tile(&cache, &key);
+    EXPECT(hit && hit->sample_count == 1u, "window 0 hit");
+    EXPECT(!has_tile(&cache, 3u, 40u), "unwindowed key misses");
+
+    dom_domain_cache_invalidate_tile(&cache, 3u, 40u);
+    EXPECT(cache.count == 0u, "invalidate tile drops every window");
+    dom_domain_cache_free(&cache);
+    return 0;
+}
+
+static int test_budget(void)
+{
+    dom_domain_cache cache;
+    dom_domain_tile tile;
+    const u64 tile_bytes = (u64)sizeof(dom_domain_tile) + 16u * sizeof(q16_16);
+    u32 i;
+
+    dom_domain_cache_init(&cache);
+    EXPECT(dom_domain_cache_reserve(&cache, 16u) == 0, "reserve");
+    for (i = 0u; i < 8u; ++i) {
+        dom_domain_cache_put(&cache, 2u, make_tile(&tile, i, 16u));
+    }
+    EXPECT(cache.memory_used == 8u * tile_bytes, "charged bytes");
+
+    /* Lowering the budget trims least recently used tiles first. */
+    dom_domain_cache_set_budget(&cache, 5u * tile_bytes);
+    EXPECT(cache.count == 5u && cache.memory_used == 5u * tile_bytes, "trimmed to budget");
+    EXPECT(!has_tile(&cache, 2u, 2u) && has_tile(&cache, 2u, 3u), "oldest trimmed");
+
+    /* A tile bigger than the budget still lands; it only pushes out older ones. */
+    dom_domain_cache_put(&cache, 2u, make_tile(&tile, 99u, 128u));
+    EXPECT(cache.count == 1u && has_tile(&cache, 2u, 99u), "oversized tile kept alone");
+    dom_domain_cache_put(&cache, 2u, make_tile(&tile, 100u, 16u));
+    EXPECT(cache.count == 1u && has_tile(&cache, 2u, 100u), "oversized tile evicted next");
+
+    dom_domain_cache_set_budget(&cache, 0u);
+    for (i = 0u; i < 16u; ++i) {
+        dom_domain_cache_put(&cache, 2u, make_tile(&tile, 200u + i, 16u));
+    }
+    EXPECT(cache.count == 16u, "unbudgeted cache fills its slots");
+    dom_domain_cache_free(&cache);
+    return 0;
+}
+
+typedef struct test_typed_tile {
+    u64 tile_id;
+    u32 count;
+    u32* values;
+} test_typed_tile;
+
+static u32 g_released;
+
+static void test_typed_release(void* tile)
+{
+    test_typed_tile* t = (test_typed_tile*)tile;
+    if (t->values) {
+        free(t->values);
+        g_released += 1u;
+    }
+    memset(t, 0, sizeof(*t));
+}
+
+static u32 test_typed_bytes(const void* tile)
+{
+    return ((const test_typed_tile*)tile)->count * (u32)sizeof(u32);
+}
+
+static const dom_domain_cache_tile_ops g_test_typed_ops = {
+    (u32)sizeof(test_typed_tile),
+    0,
+    test_typed_release,
+    test_typed_bytes
+};
+
+static int test_typed_ops(void)
+{
+    dom_domain_cache cache;
+    dom_domain_cache_key key;
+    test_typed_tile tile;
+    test_typed_tile* stored;
+    u32 i;
+
+    g_released = 0u;
+    dom_domain_cache_init_typed(&cache, &g_test_typed_ops);
+    EXPECT(dom_domain_cache_reserve(&cache, 4u) == 0, "reserve");
+    for (i = 0u; i < 6u; ++i) {
+        tile.tile_id = i;
+        tile.count = 8u;
+        tile.values = (u32*)calloc(8u, sizeof(u32));
+        tile.values[7] = i;
+        dom_domain_cache_key_init(&key, (i & 1u) ? 5u : 6u, i, DOM_DOMAIN_RES_MEDIUM, 1u);
+        stored = (test_typed_tile*)dom_domain_cache_put_tile(&cache, &key, &tile);
+        EXPECT(stored && stored->values[7] == i, "typed put");
+        EXPECT(tile.values == 0 && tile.count == 0u, "source reset");
+    }
+    EXPECT(g_released == 2u, "evicted tiles released");
+    EXPECT(cache.memory_used == 4u * (sizeof(test_typed_tile) + 8u * sizeof(u32)), "typed charge");
+
+    dom_domain_cache_invalidate_domain(&cache, 5u);
+    EXPECT(cache.count == 2u && g_released == 4u, "invalidate domain");
+    dom_domain_cache_key_init(&key, 6u, 4u, DOM_DOMAIN_RES_MEDIUM, 1u);
+    EXPECT(dom_domain_cache_peek_tile(&cache, &key) != 0, "other domain kept");
+    dom_domain_cache_invalidate_version(&cache, 1u);
+    EXPECT(cache.count == 0u && cache.memory_used == 0u && g_released == 6u, "invalidate version");
+
+    /* Freed slots are reused. */
+    for (i = 0u; i < 4u; ++i) {
+        tile.tile_id = 50u + i;
+        tile.count = 1u;
+        tile.values = (u32*)calloc(1u, sizeof(u32));
+        dom_domain_cache_key_init(&key, 6u, tile.tile_id, DOM_DOMAIN_RES_MEDIUM, 1u);
+        EXPECT(dom_domain_cache_put_tile(&cache, &key, &tile) != 0, "reuse slot");
+    }
+    EXPECT(cache.stats.evictions == 2u, "no eviction while slots are free");
+    dom_domain_cache_free(&cache);
+    EXPECT(g_released == 10u, "free releases live tiles");
+    return 0;
+}
+
+static int test_perf_counters(void)
+{
+    dom_domain_cache cache;
+    dom_domain_tile tile;
+
+    dsys_perf_reset();
+    dsys_perf_set_enabled(1);
+    dsys_perf_tick_begin(0, 0u);
+    dom_domain_cache_init(&cache);
+    EXPECT(dom_domain_cache_reserve(&cache, 2u) == 0, "reserve");
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 1u, 1u));
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 2u, 1u));
+    dom_domain_cache_get(&cache, 1u, 1u, DOM_DOMAIN_RES_FULL, 1u);
+    dom_domain_cache_get(&cache, 1u, 1u, DOM_DOMAIN_RES_FULL, 1u);
+    dom_domain_cache_get(&cache, 1u, 3u, DOM_DOMAIN_RES_FULL, 1u);
+    dom_domain_cache_put(&cache, 1u, make_tile(&tile, 3u, 1u));
+    dsys_perf_tick_end();
+    EXPECT(dsys_perf_metric_last(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_HITS) == 2u,
+           "perf hits");
+    EXPECT(dsys_perf_metric_last(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_MISSES) == 1u,
+           "perf misses");
+    EXPECT(dsys_perf_metric_last(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_EVICTIONS) == 1u,
+           "perf evictions");
+    EXPECT(cache.stats.inserts == 3u, "inserts");
+    dom_domain_cache_free(&cache);
+    dsys_perf_set_enabled(0);
+    dsys_perf_reset();
+    return 0;
+}
+
+int main(void)
+{
+    if (test_lookup_at_scale() != 0) return 1;
+    if (test_lru_order() != 0) return 1;
+    if (test_window_keys() != 0) return 1;
+    if (test_budget() != 0) return 1;
+    if (test_typed_ops() != 0) return 1;
+    if (test_perf_counters() != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,239 @@
+/*
+Macro capsule spatial index tests (DOMAIN1).
+
+Checks grid lookups against a linear scan across inserts, swap-removes, wide
+capsules and cell size changes, then the growable per-domain capsule limit.
+*/
+#include "domino/world/domain_capsule_index.h"
+#include "domino/world/terrain_surface.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+#define CAPSULE_TEST_MAX 600u
+
+static u32 g_rng = 0x1234567u;
+
+static u32 next_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static q16_16 rand_coord(i32 span_units)
+{
+    return (q16_16)(((i32)(next_rand() % (u32)(span_units * 2)) - span_units) * 65536);
+}
+
+static dom_domain_aabb rand_box(i32 span_units, i32 max_extent)
+{
+    dom_domain_aabb box;
+    box.min.x = rand_coord(span_units);
+    box.min.y = rand_coord(span_units);
+    box.min.z = rand_coord(span_units);
+    box.max.x = (q16_16)(box.min.x + (q16_16)((next_rand() % (u32)max_extent) << 16));
+    box.max.y = (q16_16)(box.min.y + (q16_16)((next_rand() % (u32)max_extent) << 16));
+    box.max.z = (q16_16)(box.min.z + (q16_16)((next_rand() % (u32)max_extent) << 16));
+    return box;
+}
+
+static u32 linear_find(const dom_domain_aabb* boxes, u32 count, const dom_domain_point* point)
+{
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        if (dom_domain_aabb_contains(&boxes[i], point)) {
+            return i;
+        }
+    }
+    return DOM_DOMAIN_CAPSULE_NONE;
+}
+
+static int check_against_scan(const dom_domain_capsule_index* index,
+                              const dom_domain_aabb* boxes,
+                              u32 count,
+                              u32 probes)
+{
+    u32 i;
+    u32 hits = 0u;
+    for (i = 0u; i < probes; ++i) {
+        dom_domain_point p;
+        u32 expected;
+        if (count > 0u && (i & 1u)) {
+            /* Probe corners of live boxes so boundaries get exercised. */
+            const dom_domain_aabb* box = &boxes[next_rand() % count];
+            p.x = (i & 2u) ? box->min.x : box->max.x;
+            p.y = (i & 4u) ? box->min.y : box->max.y;
+            p.z = (i & 8u) ? box->min.z : box->max.z;
+        } else {
+            p.x = rand_coord(64);
+            p.y = rand_coord(64);
+            p.z = rand_coord(64);
+        }
+        expected = linear_find(boxes, count, &p);
+        EXPECT(dom_domain_capsule_index_find(index, &p) == expected, "find matches scan");
+        if (expected != DOM_DOMAIN_CAPSULE_NONE) {
+            hits += 1u;
+        }
+    }
+    EXPECT(count == 0u || hits > 0u, "probes hit capsules");
+    return 0;
+}
+
+/* Cells stay sorted by (code, slot) and wide slots ascend, which is what
+ * makes the first hit the lowest slot. */
+static int check_order(const dom_domain_capsule_index* index)
+{
+    u32 i;
+    for (i = 1u; i < index->cell_count; ++i) {
+        const dom_domain_capsule_cell* a = &index->cells[i - 1u];
+        const dom_domain_capsule_cell* b = &index->cells[i];
+        EXPECT(a->code < b->code || (a->code == b->code && a->slot < b->slot), "cells ordered");
+    }
+    for (i = 0u; i < index->cell_count; ++i) {
+        EXPECT(index->cells[i].slot < index->count, "cell slot live");
+    }
+    for (i = 1u; i < index->wide_count; ++i) {
+        EXPECT(index->wide[i - 1u] < index->wide[i], "wide ordered");
+    }
+    return 0;
+}
+
+static int test_matches_linear_scan(void)
+{
+    static dom_domain_aabb boxes[CAPSULE_TEST_MAX];
+    dom_domain_capsule_index index;
+    u32 count = 0u;
+    u32 i;
+
+    dom_domain_capsule_index_init(&index, d_q16_16_from_int(8), 0u);
+    for (i = 0u; i < CAPSULE_TEST_MAX; ++i) {
+        /* Every seventh capsule spans far more cells than the grid keys. */
+        boxes[count] = (i % 7u == 0u) ? rand_box(64, 96) : rand_box(64, 12);
+        EXPECT(dom_domain_capsule_index_insert(&index, &boxes[count]) == 0, "insert");
+        count += 1u;
+    }
+    EXPECT(index.count == count && index.wide_count > 0u && index.cell_count > 0u, "keyed");
+    if (check_order(&index) != 0) return 1;
+    if (check_against_scan(&index, boxes, count, 4000u) != 0) return 1;
+
+    /* Swap-remove mirrors the owning arrays. */
+    for (i = 0u; i < 200u; ++i) {
+        const u32 slot = next_rand() % count;
+        boxes[slot] = boxes[count - 1u];
+        count -= 1u;
+        EXPECT(dom_domain_capsule_index_remove(&index, slot) == 0, "remove");
+        if ((i % 25u) == 0u && check_order(&index) != 0) return 1;
+    }
+    if (check_order(&index) != 0) return 1;
+    EXPECT(dom_domain_capsule_index_remove(&index, count) != 0, "remove out of range");
+    if (check_against_scan(&index, boxes, count, 4000u) != 0) return 1;
+
+    EXPECT(dom_domain_capsule_index_set_cell_size(&index, d_q16_16_from_int(3)) == 0, "shrink cells");
+    if (check_order(&index) != 0) return 1;
+    if (check_against_scan(&index, boxes, count, 4000u) != 0) return 1;
+    EXPECT(dom_domain_capsule_index_set_cell_size(&index, 0) == 0, "disable grid");
+    EXPECT(index.cell_count == 0u && index.wide_count == count, "all wide");
+    if (check_against_scan(&index, boxes, count, 2000u) != 0) return 1;
+    EXPECT(dom_domain_capsule_index_set_cell_size(&index, d_q16_16_from_int(32)) == 0, "grow cells");
+    if (check_against_scan(&index, boxes, count, 4000u) != 0) return 1;
+
+    dom_domain_capsule_index_clear(&index);
+    if (check_against_scan(&index, boxes, 0u, 100u) != 0) return 1;
+    dom_domain_capsule_index_free(&index);
+    EXPECT(index.bounds == 0 && index.cells == 0 && index.wide == 0, "free");
+    return 0;
+}
+
+static int test_limit(void)
+{
+    dom_domain_capsule_index index;
+    dom_domain_aabb box = rand_box(8, 4);
+    u32 i;
+
+    dom_domain_capsule_index_init(&index, d_q16_16_from_int(4), 3u);
+    for (i = 0u; i < 3u; ++i) {
+        EXPECT(dom_domain_capsule_index_insert(&index, &box) == 0, "insert under limit");
+    }
+    EXPECT(dom_domain_capsule_index_insert(&index, &box) == -2, "limit refuses");
+    dom_domain_capsule_index_set_limit(&index, 0u);
+    EXPECT(dom_domain_capsule_index_insert(&index, &box) == 0, "unbounded");
+    dom_domain_capsule_index_set_limit(&index, 2u);
+    EXPECT(index.count == 4u, "lowered limit keeps capsules");
+    EXPECT(dom_domain_capsule_index_insert(&index, &box) == -2, "lowered limit refuses");
+    dom_domain_capsule_index_free(&index);
+    return 0;
+}
+
+static void terrain_tile_desc(const dom_terrain_domain* domain, i32 tx, i32 ty,
+                              dom_domain_tile_desc* out_desc)
+{
+    const q16_16 tile_size = domain->volume.policy.tile_size;
+    const dom_domain_aabb* bounds = &domain->surface.sdf_source.bounds;
+    dom_domain_tile_desc_init(out_desc);
+    out_desc->resolution = DOM_DOMAIN_RES_MEDIUM;
+    out_desc->sample_dim = domain->volume.policy.sample_dim_medium;
+    out_desc->tile_id = dom_domain_tile_id_from_coord(tx, ty, 0, DOM_DOMAIN_RES_MEDIUM);
+    out_desc->authoring_version = domain->volume.authoring_version;
+    out_desc->bounds.min.x = (q16_16)(bounds->min.x + (q16_16)((i64)tx * (i64)tile_size));
+    out_desc->bounds.min.y = (q16_16)(bounds->min.y + (q16_16)((i64)ty * (i64)tile_size));
+    out_desc->bounds.min.z = bounds->min.z;
+    out_desc->bounds.max.x = (q16_16)(out_desc->bounds.min.x + tile_size);
+    out_desc->bounds.max.y = (q16_16)(out_desc->bounds.min.y + tile_size);
+    out_desc->bounds.max.z = (q16_16)(out_desc->bounds.min.z + tile_size);
+}
+
+static int test_domain_limit_grows(void)
+{
+    dom_terrain_surface_desc desc;
+    dom_terrain_domain domain;
+    dom_domain_tile_desc tile;
+    u32 i;
+
+    dom_terrain_surface_desc_init(&desc);
+    desc.domain_id = 11u;
+    dom_terrain_domain_init(&domain, &desc, 0u);
+    for (i = 0u; i < DOM_TERRAIN_MAX_CAPSULES; ++i) {
+        terrain_tile_desc(&domain, (i32)(i % 20u), (i32)(i / 20u), &tile);
+        EXPECT(dom_terrain_domain_collapse_tile(&domain, &tile) == 0, "collapse default");
+    }
+    terrain_tile_desc(&domain, 0, 30, &tile);
+    EXPECT(dom_terrain_domain_collapse_tile(&domain, &tile) == -2, "default limit");
+
+    dom_domain_capsule_index_set_limit(&domain.capsule_index, 400u);
+    for (i = DOM_TERRAIN_MAX_CAPSULES; i < 400u; ++i) {
+        terrain_tile_desc(&domain, (i32)(i % 20u), (i32)(i / 20u), &tile);
+        EXPECT(dom_terrain_domain_collapse_tile(&domain, &tile) == 0, "collapse raised");
+    }
+    EXPECT(dom_terrain_domain_capsule_count(&domain) == 400u, "grown past default");
+    EXPECT(domain.capsule_capacity >= 400u && domain.capsule_index.count == 400u, "storage grew");
+
+    terrain_tile_desc(&domain, 3, 5, &tile);
+    EXPECT(dom_terrain_domain_expand_tile(&domain, tile.tile_id) == 0, "expand");
+    for (i = 0u; i < dom_terrain_domain_capsule_count(&domain); ++i) {
+        const dom_terrain_macro_capsule* capsule = dom_terrain_domain_capsule_at(&domain, i);
+        dom_domain_point center;
+        center.x = (q16_16)(capsule->bounds.min.x + ((capsule->bounds.max.x - capsule->bounds.min.x) >> 1));
+        center.y = (q16_16)(capsule->bounds.min.y + ((capsule->bounds.max.y - capsule->bounds.min.y) >> 1));
+        center.z = (q16_16)(capsule->bounds.min.z + ((capsule->bounds.max.z - capsule->bounds.min.z) >> 1));
+        EXPECT(dom_domain_capsule_index_find(&domain.capsule_index, &center) == i, "index tracks slots");
+        EXPECT(capsule->tile_id != tile.tile_id, "expanded capsule gone");
+    }
+    dom_terrain_domain_free(&domain);
+    EXPECT(domain.capsules == 0 && domain.capsule_index.count == 0u, "domain free");
+    return 0;
+}
+
+int main(void)
+{
+    if (test_matches_linear_scan() != 0) return 1;
+    if (test_limit() != 0) return 1;
+    if (test_domain_limit_grows() != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,244 @@
+/*
+DTLV reader tests: mapped reader against the file and memory readers,
+zero-copy chunk views and the hashed type_id lookup.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "domino/io/container.h"
+#include "domino/sys.h"
+
+#define CONTAINER_PATH "dtlv_mapped_test.dtlv"
+#define TRUNCATED_PATH "dtlv_mapped_truncated.dtlv"
+#define CHUNKS 700u
+#define TYPES 97u
+
+static unsigned char g_payload[4096];
+static unsigned char g_copy[4096];
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static u32 chunk_type(u32 i)
+{
+    return 0x1000u + (i * 31u) % TYPES;
+}
+
+static u16 chunk_version(u32 i)
+{
+    return (u16)(1u + (i % 3u));
+}
+
+static u32 chunk_size(u32 i)
+{
+    return 4u + (i * 37u) % 512u;
+}
+
+static void fill_payload(u32 i, u32 size)
+{
+    u32 b;
+    dtlv_le_write_u32(g_payload, i);
+    for (b = 4u; b < size; ++b) {
+        g_payload[b] = (unsigned char)((i * 7u + b) & 0xFFu);
+    }
+}
+
+static int write_container(void)
+{
+    dtlv_writer w;
+    u32 i;
+    dtlv_writer_init(&w);
+    if (dtlv_writer_open_file(&w, CONTAINER_PATH) != 0) {
+        return fail("writer open");
+    }
+    for (i = 0u; i < CHUNKS; ++i) {
+        u32 size = chunk_size(i);
+        fill_payload(i, size);
+        if (dtlv_writer_begin_chunk(&w, chunk_type(i), chunk_version(i), 0u) != 0 ||
+            dtlv_writer_write(&w, g_payload, size) != 0 ||
+            dtlv_writer_end_chunk(&w) != 0) {
+            dtlv_writer_dispose(&w);
+            return fail("writer chunk");
+        }
+    }
+    if (dtlv_writer_finalize(&w) != 0) {
+        dtlv_writer_dispose(&w);
+        return fail("writer finalize");
+    }
+    dtlv_writer_dispose(&w);
+    return 0;
+}
+
+/* The pre-index find_first: first directory entry in order. */
+static const dtlv_dir_entry* linear_find(const dtlv_reader* r, u32 type_id, u16 version)
+{
+    u32 i;
+    for (i = 0u; i < dtlv_reader_chunk_count(r); ++i) {
+        const dtlv_dir_entry* e = dtlv_reader_chunk_at(r, i);
+        if (e->type_id == type_id && (version == 0u || e->version == version)) {
+            return e;
+        }
+    }
+    return (const dtlv_dir_entry*)0;
+}
+
+static int check_lookup(const dtlv_reader* r)
+{
+    u32 t;
+    u16 v;
+    for (t = 0x0FF0u; t < 0x1000u + TYPES + 16u; ++t) {
+        for (v = 0u; v < 5u; ++v) {
+            if (dtlv_reader_find_first(r, t, v) != linear_find(r, t, v)) {
+                return fail("hashed find_first matches directory scan");
+            }
+        }
+    }
+    return 0;
+}
+
+/* dsys_file_map is POSIX-only; elsewhere open_mapped always refuses. */
+static int mapping_supported(void)
+{
+    const void* data;
+    size_t size;
+    void* map = dsys_file_map(CONTAINER_PATH, &data, &size);
+    if (map) {
+        dsys_file_unmap(map);
+        return 1;
+    }
+    return (dsys_last_error_code() == DSYS_ERR_UNSUPPORTED) ? 0 : 1;
+}
+
+static int test_mapped_matches_file(void)
+{
+    dtlv_reader file_r;
+    dtlv_reader map_r;
+    u32 i;
+    int rc = 0;
+    if (!mapping_supported()) {
+        printf("dtlv_mapped: file mapping unsupported, skipping mapped comparison\n");
+        return 0;
+    }
+    dtlv_reader_init(&file_r);
+    dtlv_reader_init(&map_r);
+    if (dtlv_reader_open_file(&file_r, CONTAINER_PATH) != 0) {
+        return fail("open_file");
+    }
+    if (dtlv_reader_open_mapped(&map_r, CONTAINER_PATH) != 0) {
+        dtlv_reader_dispose(&file_r);
+        return fail("open_mapped");
+    }
+    if (dtlv_reader_chunk_count(&map_r) != CHUNKS || dtlv_reader_chunk_count(&file_r) != CHUNKS) {
+        rc = fail("chunk count");
+    }
+    for (i = 0u; i < CHUNKS && rc == 0; ++i) {
+        const dtlv_dir_entry* fe = dtlv_reader_chunk_at(&file_r, i);
+        const dtlv_dir_entry* me = dtlv_reader_chunk_at(&map_r, i);
+        const unsigned char* view = (const unsigned char*)0;
+        u32 view_size = 0u;
+        u32 id;
+        u32 size;
+        if (memcmp(fe, me, sizeof(*fe)) != 0) {
+            rc = fail("directory entries match");
+            break;
+        }
+        if (dtlv_reader_chunk_memview(&map_r, me, &view, &view_size) != 0 || view_size < 4u) {
+            rc = fail("mapped view");
+            break;
+        }
+        /* The directory is sorted by type/version; payloads carry their write index. */
+        id = dtlv_le_read_u32(view);
+        size = (id < CHUNKS) ? chunk_size(id) : 0u;
+        if (id < CHUNKS) {
+            fill_payload(id, size);
+        }
+        if (id >= CHUNKS || me->type_id != chunk_type(id) || me->version != chunk_version(id) ||
+            view_size != size || memcmp(view, g_payload, size) != 0) {
+            rc = fail("mapped view holds the payload");
+        } else if (dtlv_reader_read_chunk(&file_r, fe, g_copy, sizeof(g_copy)) != 0 ||
+                   memcmp(g_copy, g_payload, size) != 0) {
+            rc = fail("streaming read still works");
+        } else if (dtlv_reader_chunk_memview(&file_r, fe, &view, &view_size) == 0) {
+            rc = fail("file reader has no memview");
+        }
+    }
+    if (rc == 0) {
+        rc = check_lookup(&map_r);
+    }
+    if (rc == 0) {
+        rc = check_lookup(&file_r);
+    }
+    dtlv_reader_dispose(&file_r);
+    dtlv_reader_dispose(&map_r);
+    if (rc == 0 && (map_r.map != (void*)0 || map_r.type_slots != (u32*)0)) {
+        rc = fail("dispose releases mapping and index");
+    }
+    return rc;
+}
+
+static int test_memory_reader(void)
+{
+    FILE* fp = fopen(CONTAINER_PATH, "rb");
+    unsigned char* bytes;
+    long size;
+    dtlv_reader r;
+    int rc;
+    if (!fp) {
+        return fail("fopen");
+    }
+    fseek(fp, 0L, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0L, SEEK_SET);
+    bytes = (unsigned char*)malloc((size_t)size);
+    if (!bytes || fread(bytes, 1u, (size_t)size, fp) != (size_t)size) {
+        fclose(fp);
+        free(bytes);
+        return fail("fread");
+    }
+    fclose(fp);
+    dtlv_reader_init(&r);
+    rc = (dtlv_reader_init_mem(&r, bytes, (u64)size) != 0) ? fail("init_mem") : check_lookup(&r);
+    dtlv_reader_dispose(&r);
+
+    /* A truncated container is rejected and leaves nothing mapped. */
+    if (rc == 0) {
+        fp = fopen(TRUNCATED_PATH, "wb");
+        if (!fp || fwrite(bytes, 1u, (size_t)(size - 40), fp) != (size_t)(size - 40)) {
+            rc = fail("write truncated");
+        }
+        if (fp) {
+            fclose(fp);
+        }
+    }
+    free(bytes);
+    if (rc == 0 && (dtlv_reader_open_mapped(&r, TRUNCATED_PATH) == 0 || r.map != (void*)0)) {
+        rc = fail("truncated container rejected");
+    }
+    if (rc == 0 && dtlv_reader_open_mapped(&r, "dtlv_mapped_missing.dtlv") == 0) {
+        rc = fail("missing file rejected");
+    }
+    dtlv_reader_dispose(&r);
+    remove(TRUNCATED_PATH);
+    return rc;
+}
+
+int main(void)
+{
+    int rc = write_container();
+    if (rc == 0) {
+        rc = test_mapped_matches_file();
+    }
+    if (rc == 0) {
+        rc = test_memory_reader();
+    }
+    remove(CONTAINER_PATH);
+    if (rc != 0) {
+        return 1;
+    }
+    printf("dtlv_mapped tests passed\n");
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+Packed view delta codec throughput benchmark (ECSX3).
+
+Usage: ecs_delta_codec_bench [--quick]
+Prints one row per encoding and change rate with the delta size and build and
+apply throughput in MB/s of current-view bytes. "reference" is the previous
+row-by-row memcmp build kept here for comparison. --quick shrinks the views so
+the run can double as a smoke test; the run fails if an applied delta does not
+reproduce the current view.
+*/
+#include "domino/ecs/ecs_delta_codec.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_FIELDS 5u
+/* Not a codec flag; selects bench_reference_build. */
+#define BENCH_REFERENCE 0xFFFFFFFFu
+
+static u32 g_rng = 0x13579BDu;
+static volatile u32 g_sink;
+
+/* Wall clock; the dsys timer is deterministic under the headless backend. */
+static u64 bench_now_us(void)
+{
+    return (u64)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static u32 bench_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 4;
+}
+
+static void bench_fields(dom_packed_field_desc* fields)
+{
+    static const u32 sizes[BENCH_FIELDS] = { 4u, 4u, 4u, 2u, 8u };
+    static const u32 types[BENCH_FIELDS] = {
+        DOM_ECS_ELEM_I32, DOM_ECS_ELEM_I32, DOM_ECS_ELEM_I32, DOM_ECS_ELEM_U16, DOM_ECS_ELEM_U64
+    };
+    u32 i;
+    for (i = 0u; i < BENCH_FIELDS; ++i) {
+        fields[i].component_id = 1u;
+        fields[i].field_id = (dom_field_id)(i + 1u);
+        fields[i].element_type = types[i];
+        fields[i].element_size = sizes[i];
+        fields[i].flags = DOM_PACK_FIELD_NONE;
+        fields[i].quant_bits = 0u;
+    }
+}
+
+/* Old build: two memcmp passes per row, payload written row by row. */
+static u32 bench_reference_build(const dom_packed_view* base, const dom_packed_view* cur,
+                                 unsigned char* out)
+{
+    const u32 stride = cur->stride;
+    const u32 bitmask_bytes = (cur->entity_count + 7u) / 8u;
+    unsigned char* payload = out + DOM_DELTA_HEADER_BYTES + bitmask_bytes;
+    u32 changed = 0u;
+    u32 i;
+    for (i = 0u; i < cur->entity_count; ++i) {
+        if (memcmp(base->bytes + (size_t)i * stride, cur->bytes + (size_t)i * stride, stride) != 0) {
+            changed += 1u;
+        }
+    }
+    memset(out + DOM_DELTA_HEADER_BYTES, 0, bitmask_bytes);
+    for (i = 0u; i < cur->entity_count; ++i) {
+        const unsigned char* cur_ptr = cur->bytes + (size_t)i * stride;
+        if (memcmp(base->bytes + (size_t)i * stride, cur_ptr, stride) != 0) {
+            out[DOM_DELTA_HEADER_BYTES + i / 8u] |= (unsigned char)(1u << (i % 8u));
+            memcpy(payload, cur_ptr, stride);
+            payload += stride;
+        }
+    }
+    return changed;
+}
+
+/* Nudges position and health of `percent` of the rows, like a movement tick. */
+static void bench_mutate(const unsigned char* base, unsigned char* cur, u32 rows, u32 stride, u32 percent)
+{
+    u32 i;
+    memcpy(cur, base, (size_t)rows * stride);
+    for (i = 0u; i < rows; ++i) {
+        if ((bench_rand() % 100u) < percent) {
+            unsigned char* row = cur + (size_t)i * stride;
+            row[0] = (unsigned char)(row[0] + 1u + (bench_rand() & 3u));
+            row[4] = (unsigned char)(row[4] ^ (bench_rand() & 7u));
+            row[12] = (unsigned char)(row[12] - 1u);
+        }
+    }
+}
+
+static double bench_mb_per_s(u64 bytes, u64 elapsed_us)
+{
+    if (elapsed_us == 0u) {
+        elapsed_us = 1u;
+    }
+    return (double)bytes / (double)elapsed_us;
+}
+
+static int bench_case(const char* name, u32 flags, u32 base_rows, u32 cur_rows, u32 percent, u32 reps)
+{
+    dom_packed_field_desc fields[BENCH_FIELDS];
+    dom_packed_view base_view;
+    dom_packed_view cur_view;
+    dom_packed_view out_view;
+    dom_packed_delta_info info;
+    dom_packed_delta_info applied;
+    u32 stride;
+    u32 max_rows = (base_rows > cur_rows) ? base_rows : cur_rows;
+    u64 start;
+    u64 build_us;
+    u64 apply_us;
+    u32 r;
+    size_t i;
+
+    bench_fields(fields);
+    stride = dom_packed_view_calc_stride(fields, BENCH_FIELDS);
+    std::vector<unsigned char> base_bytes((size_t)max_rows * stride);
+    std::vector<unsigned char> cur_bytes((size_t)max_rows * stride);
+    std::vector<unsigned char> out_bytes((size_t)max_rows * stride);
+    std::vector<unsigned char> delta((size_t)max_rows * (stride + 32u) + 64u);
+    for (i = 0u; i < base_bytes.size(); ++i) {
+        base_bytes[i] = (unsigned char)bench_rand();
+    }
+    bench_mutate(&base_bytes[0], &cur_bytes[0], max_rows, stride, percent);
+    dom_packed_view_init(&base_view, 1u, fields, BENCH_FIELDS, base_rows, &base_bytes[0], (u32)base_bytes.size());
+    dom_packed_view_init(&cur_view, 1u, fields, BENCH_FIELDS, cur_rows, &cur_bytes[0], (u32)cur_bytes.size());
+    dom_packed_view_init(&out_view, 1u, fields, BENCH_FIELDS, 0u, &out_bytes[0], (u32)out_bytes.size());
+
+    start = bench_now_us();
+    for (r = 0u; r < reps; ++r) {
+        if (flags == BENCH_REFERENCE) {
+            g_sink = bench_reference_build(&base_view, &cur_view, &delta[0]);
+        } else if (dom_delta_build_ex(&base_view, &cur_view, flags, &delta[0], (u32)delta.size(), &info) != 0) {
+            fprintf(stderr, "ecs_delta_codec_bench: %s build failed\n", name);
+            return 1;
+        }
+    }
+    build_us = bench_now_us() - start;
+    if (flags == BENCH_REFERENCE) {
+        printf("%-12s %4u%% %9u %12s %10.1f %10s\n", name, percent, cur_rows, "-",
+               bench_mb_per_s((u64)cur_view.byte_count * reps, build_us), "-");
+        return 0;
+    }
+
+    start = bench_now_us();
+    for (r = 0u; r < reps; ++r) {
+        if (dom_delta_apply(&base_view, &delta[0], info.total_bytes, &out_view, &applied) != 0) {
+            fprintf(stderr, "ecs_delta_codec_bench: %s apply failed\n", name);
+            return 1;
+        }
+    }
+    apply_us = bench_now_us() - start;
+    if (out_view.byte_count != cur_view.byte_count ||
+        memcmp(out_view.bytes, cur_view.bytes, cur_view.byte_count) != 0) {
+        fprintf(stderr, "ecs_delta_codec_bench: %s round trip mismatch\n", name);
+        return 1;
+    }
+    printf("%-12s %4u%% %9u %12u %10.1f %10.1f\n", name, percent, cur_rows, info.total_bytes,
+           bench_mb_per_s((u64)cur_view.byte_count * reps, build_us),
+           bench_mb_per_s((u64)cur_view.byte_count * reps, apply_us));
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    static const u32 percents[3] = { 1u, 10u, 50u };
+    u32 rows = 1000000u;
+    u32 reps = 10u;
+    u32 p;
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+        rows = 20000u;
+        reps = 2u;
+    }
+    printf("%-12s %5s %9s %12s %10s %10s\n", "encoding", "chg", "rows", "delta_bytes", "build_MB/s", "apply_MB/s");
+    for (p = 0u; p < 3u; ++p) {
+        if (bench_case("reference", BENCH_REFERENCE, rows, rows, percents[p], reps) != 0) {
+            return 1;
+        }
+        if (bench_case("raw", DOM_DELTA_BUILD_NONE, rows, rows, percents[p], reps) != 0) {
+            return 1;
+        }
+        if (bench_case("xor_varint", DOM_DELTA_BUILD_XOR_VARINT, rows, rows, percents[p], reps) != 0) {
+            return 1;
+        }
+    }
+    if (bench_case("raw_grow", DOM_DELTA_BUILD_RESIZE, rows, rows + rows / 20u, 10u, reps) != 0) {
+        return 1;
+    }
+    if (bench_case("raw_shrink", DOM_DELTA_BUILD_RESIZE, rows, rows - rows / 20u, 10u, reps) != 0) {
+        return 1;
+    }
+    if (bench_case("xor_grow", DOM_DELTA_BUILD_RESIZE | DOM_DELTA_BUILD_XOR_VARINT,
+                   rows, rows + rows / 20u, 10u, reps) != 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -90,6 +90,182 @@ static int test_deterministic_delta_output(void)
     TEST_CHECK(info_a.changed_count == 2u);
     TEST_CHECK(info_a.total_bytes == info_b.total_bytes);
     TEST_CHECK(memcmp(delta_a, delta_b, info_a.total_bytes) == 0);
+    /* Short header, bitmask 0b110, then rows 1 and 2 verbatim. */
+    TEST_CHECK(info_a.total_bytes == DOM_DELTA_HEADER_BYTES + 1u + 2u * 6u);
+    TEST_CHECK(delta_a[20] == 6u && delta_a[23] == 0u);
+    TEST_CHECK(delta_a[DOM_DELTA_HEADER_BYTES] == 0x06u);
+    TEST_CHECK(memcmp(delta_a + DOM_DELTA_HEADER_BYTES + 1u, cur_buf + 6, 12u) == 0);
+    return 0;
+}
+
+#define DELTA_TEST_ROWS 300u
+#define DELTA_TEST_STRIDE 14u
+
+static u32 g_delta_rng = 0x9E3779B9u;
+
+static u32 delta_rand(void)
+{
+    g_delta_rng = g_delta_rng * 1664525u + 1013904223u;
+    return g_delta_rng >> 8;
+}
+
+static void delta_fields(dom_packed_field_desc* fields)
+{
+    fields[0] = make_field(1u, 1u, DOM_ECS_ELEM_U32, sizeof(u32));
+    fields[1] = make_field(1u, 2u, DOM_ECS_ELEM_U16, sizeof(u16));
+    fields[2] = make_field(2u, 1u, DOM_ECS_ELEM_U64, sizeof(u64));
+}
+
+/* Copies base into cur for `rows` rows, then nudges a few bytes of some rows. */
+static void delta_mutate(const unsigned char* base, unsigned char* cur, u32 rows)
+{
+    u32 i;
+    memcpy(cur, base, (size_t)rows * DELTA_TEST_STRIDE);
+    for (i = 0u; i < rows; ++i) {
+        if ((delta_rand() % 5u) == 0u) {
+            cur[i * DELTA_TEST_STRIDE + (delta_rand() % DELTA_TEST_STRIDE)] += (unsigned char)(1u + (delta_rand() % 7u));
+        }
+    }
+    /* Dense tail so runs cross bitmask words. */
+    for (i = (rows > 70u) ? rows - 70u : 0u; i < rows; ++i) {
+        cur[i * DELTA_TEST_STRIDE] ^= 0x01u;
+    }
+}
+
+static int delta_roundtrip(const dom_packed_view* base_view,
+                           const dom_packed_view* cur_view,
+                           u32 flags)
+{
+    static unsigned char delta[DELTA_TEST_ROWS * (DELTA_TEST_STRIDE + 16u) + 64u];
+    static unsigned char out_buf[DELTA_TEST_ROWS * 2u * DELTA_TEST_STRIDE];
+    static unsigned char inplace_buf[DELTA_TEST_ROWS * 2u * DELTA_TEST_STRIDE];
+    dom_packed_delta_info info;
+    dom_packed_delta_info applied;
+    dom_packed_view out_view;
+    dom_packed_view inplace_view;
+    u32 i;
+    u32 changed = 0u;
+
+    TEST_CHECK(dom_delta_build_ex(base_view, cur_view, flags, delta, sizeof(delta), &info) == 0);
+    for (i = 0u; i < base_view->entity_count && i < cur_view->entity_count; ++i) {
+        if (memcmp(base_view->bytes + i * DELTA_TEST_STRIDE, cur_view->bytes + i * DELTA_TEST_STRIDE,
+                   DELTA_TEST_STRIDE) != 0) {
+            changed += 1u;
+        }
+    }
+    TEST_CHECK(info.changed_count == changed);
+    TEST_CHECK(info.appended_count == ((cur_view->entity_count > base_view->entity_count) ?
+                                       cur_view->entity_count - base_view->entity_count : 0u));
+    TEST_CHECK(info.removed_count == ((base_view->entity_count > cur_view->entity_count) ?
+                                      base_view->entity_count - cur_view->entity_count : 0u));
+    if ((flags & DOM_DELTA_BUILD_XOR_VARINT) != 0u) {
+        /* Small edits XOR down to one-byte varints; appended rows need not shrink. */
+        TEST_CHECK(changed == 0u || info.appended_count > 0u ||
+                   info.payload_bytes < changed * DELTA_TEST_STRIDE);
+    } else {
+        TEST_CHECK(info.payload_bytes == (changed + info.appended_count) * DELTA_TEST_STRIDE);
+    }
+    TEST_CHECK(dom_delta_build_ex(base_view, cur_view, flags, delta, info.total_bytes - 1u, &applied) == -6);
+
+    TEST_CHECK(dom_packed_view_init(&out_view, base_view->view_id, base_view->fields, base_view->field_count,
+                                    0u, out_buf, sizeof(out_buf)) == 0);
+    TEST_CHECK(dom_delta_apply(base_view, delta, info.total_bytes, &out_view, &applied) == 0);
+    TEST_CHECK(out_view.entity_count == cur_view->entity_count);
+    TEST_CHECK(out_view.byte_count == cur_view->entity_count * DELTA_TEST_STRIDE);
+    TEST_CHECK(memcmp(out_view.bytes, cur_view->bytes, out_view.byte_count) == 0);
+    TEST_CHECK((out_view.view_flags & DOM_PACKED_VIEW_VALID) != 0u);
+    TEST_CHECK(applied.changed_count == info.changed_count);
+    TEST_CHECK(applied.total_bytes == info.total_bytes);
+
+    /* Applying over a copy of the baseline in place gives the same rows. */
+    memcpy(inplace_buf, base_view->bytes, base_view->byte_count);
+    inplace_view = *base_view;
+    inplace_view.bytes = inplace_buf;
+    inplace_view.bytes_capacity = sizeof(inplace_buf);
+    TEST_CHECK(dom_delta_apply(&inplace_view, delta, info.total_bytes, &inplace_view, &applied) == 0);
+    TEST_CHECK(memcmp(inplace_buf, cur_view->bytes, cur_view->byte_count) == 0);
+
+    /* Truncated or mismatched deltas are refused. */
+    inplace_view = *base_view;
+    TEST_CHECK(dom_delta_apply(base_view, delta, info.total_bytes - 1u, &out_view, &applied) == -6);
+    TEST_CHECK(dom_delta_apply(base_view, delta, 10u, &out_view, &applied) == -6);
+    inplace_view.baseline_id += 1u;
+    TEST_CHECK(dom_delta_apply(&inplace_view, delta, info.total_bytes, &out_view, &applied) == -3);
+    out_view.bytes_capacity = (cur_view->entity_count > 0u) ? cur_view->byte_count - 1u : 0u;
+    if (cur_view->entity_count > 0u) {
+        TEST_CHECK(dom_delta_apply(base_view, delta, info.total_bytes, &out_view, &applied) == -5);
+    }
+    return 0;
+}
+
+static int test_delta_apply_roundtrip(void)
+{
+    static unsigned char base_buf[DELTA_TEST_ROWS * DELTA_TEST_STRIDE];
+    static unsigned char cur_buf[DELTA_TEST_ROWS * DELTA_TEST_STRIDE];
+    static unsigned char delta_raw[DELTA_TEST_ROWS * DELTA_TEST_STRIDE + 128u];
+    static unsigned char delta_legacy[DELTA_TEST_ROWS * DELTA_TEST_STRIDE + 128u];
+    dom_packed_field_desc fields[3];
+    dom_packed_view base_view;
+    dom_packed_view cur_view;
+    dom_packed_delta_info info_raw;
+    dom_packed_delta_info info_legacy;
+    u32 i;
+
+    delta_fields(fields);
+    TEST_CHECK(dom_packed_view_calc_stride(fields, 3u) == DELTA_TEST_STRIDE);
+    for (i = 0u; i < sizeof(base_buf); ++i) {
+        base_buf[i] = (unsigned char)delta_rand();
+    }
+    delta_mutate(base_buf, cur_buf, DELTA_TEST_ROWS);
+    TEST_CHECK(dom_packed_view_init(&base_view, 6u, fields, 3u, DELTA_TEST_ROWS, base_buf, sizeof(base_buf)) == 0);
+    TEST_CHECK(dom_packed_view_init(&cur_view, 6u, fields, 3u, DELTA_TEST_ROWS, cur_buf, sizeof(cur_buf)) == 0);
+    base_view.baseline_id = 9u;
+
+    /* RESIZE with equal counts keeps the short header. */
+    TEST_CHECK(dom_delta_build(&base_view, &cur_view, delta_legacy, sizeof(delta_legacy), &info_legacy) == 0);
+    TEST_CHECK(dom_delta_build_ex(&base_view, &cur_view, DOM_DELTA_BUILD_RESIZE,
+                                  delta_raw, sizeof(delta_raw), &info_raw) == 0);
+    TEST_CHECK(info_raw.total_bytes == info_legacy.total_bytes);
+    TEST_CHECK(memcmp(delta_raw, delta_legacy, info_raw.total_bytes) == 0);
+
+    if (delta_roundtrip(&base_view, &cur_view, DOM_DELTA_BUILD_NONE) != 0) return 1;
+    if (delta_roundtrip(&base_view, &cur_view, DOM_DELTA_BUILD_XOR_VARINT) != 0) return 1;
+    /* Identical views: empty payload. */
+    if (delta_roundtrip(&base_view, &base_view, DOM_DELTA_BUILD_NONE) != 0) return 1;
+    return 0;
+}
+
+static int test_delta_entity_count_changes(void)
+{
+    static unsigned char base_buf[DELTA_TEST_ROWS * DELTA_TEST_STRIDE];
+    static unsigned char cur_buf[(DELTA_TEST_ROWS + 77u) * DELTA_TEST_STRIDE];
+    static unsigned char delta[DELTA_TEST_ROWS * 2u * DELTA_TEST_STRIDE];
+    dom_packed_field_desc fields[3];
+    dom_packed_view base_view;
+    dom_packed_view cur_view;
+    dom_packed_delta_info info;
+    const u32 counts[4] = { DELTA_TEST_ROWS + 77u, DELTA_TEST_ROWS - 123u, 0u, 5u };
+    u32 c;
+    u32 i;
+
+    delta_fields(fields);
+    for (i = 0u; i < sizeof(base_buf); ++i) {
+        base_buf[i] = (unsigned char)delta_rand();
+    }
+    TEST_CHECK(dom_packed_view_init(&base_view, 7u, fields, 3u, DELTA_TEST_ROWS, base_buf, sizeof(base_buf)) == 0);
+    for (c = 0u; c < 4u; ++c) {
+        const u32 count = counts[c];
+        const u32 common = (count < DELTA_TEST_ROWS) ? count : DELTA_TEST_ROWS;
+        delta_mutate(base_buf, cur_buf, common);
+        for (i = common * DELTA_TEST_STRIDE; i < count * DELTA_TEST_STRIDE; ++i) {
+            cur_buf[i] = (unsigned char)(i & 0x3Fu);
+        }
+        TEST_CHECK(dom_packed_view_init(&cur_view, 7u, fields, 3u, count, cur_buf, sizeof(cur_buf)) == 0);
+        TEST_CHECK(dom_delta_build(&base_view, &cur_view, delta, sizeof(delta), &info) == -3);
+        if (delta_roundtrip(&base_view, &cur_view, DOM_DELTA_BUILD_RESIZE) != 0) return 1;
+        if (delta_roundtrip(&base_view, &cur_view,
+                            DOM_DELTA_BUILD_RESIZE | DOM_DELTA_BUILD_XOR_VARINT) != 0) return 1;
+    }
     return 0;
 }
 
@@ -179,6 +355,8 @@ int main(void)
 {
     if (test_deterministic_pack_output() != 0) return 1;
     if (test_deterministic_delta_output() != 0) return 1;
+    if (test_delta_apply_roundtrip() != 0) return 1;
+    if (test_delta_entity_count_changes() != 0) return 1;
     if (test_field_ordering_and_reject_unsorted() != 0) return 1;
     if (test_explicit_byte_order() != 0) return 1;
     if (test_incremental_rebuild_determinism() != 0) return 1;
@@ -0,0 +1,187 @@
+/*
+SoA archetype storage write commit benchmark (ECSX2).
+
+Usage: ecs_soa_commit_bench [--quick]
+Prints ns per write op for apply_writes on the calling thread and on a
+thread pool, for shuffled commit keys spread over many columns. --quick
+shrinks the buffers so the run can double as a smoke test; the run fails if
+the pooled commit diverges from the serial one.
+*/
+#include "ecs/soa_archetype_storage.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define BENCH_ARCHETYPES 8u
+#define BENCH_FIELDS 8u
+#define BENCH_ROWS 4096u
+#define BENCH_SPAN 8u
+#define BENCH_WORKERS 4u
+
+static u32 g_rng = 0x13579BDu;
+
+/* Wall clock; the dsys timer is deterministic under the headless backend. */
+static u64 bench_now_us(void)
+{
+    return (u64)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static u32 bench_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 4;
+}
+
+static void bench_build(dom_soa_archetype_storage* storage, dom_archetype_id* arch_ids)
+{
+    dom_soa_field_def fields[BENCH_FIELDS];
+    dom_soa_component_def components[1];
+    u32 a;
+    u32 f;
+    u32 e;
+    for (f = 0u; f < BENCH_FIELDS; ++f) {
+        fields[f].field_id = (dom_field_id)(f + 1u);
+        fields[f].element_type = DOM_ECS_ELEM_U64;
+        fields[f].element_size = sizeof(u64);
+    }
+    for (a = 0u; a < BENCH_ARCHETYPES; ++a) {
+        dom_component_id component_id = 100u + a;
+        components[0].component_id = component_id;
+        components[0].fields = fields;
+        components[0].field_count = BENCH_FIELDS;
+        storage->add_archetype(components, 1u, BENCH_ROWS);
+        arch_ids[a] = dom_soa_archetype_id_from_components(&component_id, 1u);
+        for (f = 0u; f < BENCH_FIELDS; ++f) {
+            storage->set_access_rule(arch_ids[a], component_id, f + 1u,
+                                     DOM_ECS_ACCESS_READWRITE | DOM_ECS_ACCESS_REDUCE);
+        }
+        for (e = 0u; e < BENCH_ROWS; ++e) {
+            storage->insert_entity(arch_ids[a], (dom_entity_id)(a * BENCH_ROWS + e + 1u));
+        }
+    }
+}
+
+static void bench_make_ops(std::vector<dom_ecs_write_op>& ops,
+                           std::vector<u64>& data,
+                           const dom_archetype_id* arch_ids,
+                           u32 count)
+{
+    u32 i;
+    ops.resize(count);
+    data.resize((size_t)count * BENCH_SPAN);
+    for (i = 0u; i < (u32)data.size(); ++i) {
+        data[i] = bench_rand();
+    }
+    for (i = 0u; i < count; ++i) {
+        dom_ecs_write_op* op = &ops[i];
+        const u32 a = bench_rand() % BENCH_ARCHETYPES;
+        const u32 begin = bench_rand() % (BENCH_ROWS - BENCH_SPAN);
+        const u32 kind = bench_rand() % 4u;
+        op->commit_key.phase_id = 0u;
+        op->commit_key.task_id = bench_rand() % 4096u;
+        op->commit_key.sub_index = bench_rand() % 16u;
+        op->archetype_id = arch_ids[a];
+        op->range.archetype_id = arch_ids[a];
+        op->range.begin_index = begin;
+        op->range.end_index = begin + 1u + bench_rand() % BENCH_SPAN;
+        op->component_id = 100u + a;
+        op->field_id = 1u + bench_rand() % BENCH_FIELDS;
+        op->element_type = DOM_ECS_ELEM_U64;
+        op->element_size = sizeof(u64);
+        op->reduction_op = (kind == 0u) ? DOM_REDUCE_INT_SUM : DOM_REDUCE_NONE;
+        op->access_mode = (kind == 0u) ? DOM_ECS_ACCESS_REDUCE : DOM_ECS_ACCESS_WRITE;
+        op->data = &data[(size_t)i * BENCH_SPAN];
+        op->stride = sizeof(u64);
+    }
+}
+
+static u64 bench_commit(dom_soa_archetype_storage* storage, const std::vector<dom_ecs_write_op>& ops)
+{
+    dom_ecs_write_buffer buffer;
+    dom_ecs_commit_context ctx;
+    u64 start;
+    buffer.ops = &ops[0];
+    buffer.count = (u32)ops.size();
+    ctx.epoch_id = 0u;
+    ctx.graph_id = 0u;
+    ctx.allow_rollback = D_FALSE;
+    ctx.status = 0;
+    start = bench_now_us();
+    storage->apply_writes(buffer, ctx);
+    return (ctx.status == 0) ? bench_now_us() - start : 0u;
+}
+
+static int bench_equal(const dom_soa_archetype_storage* lhs,
+                       const dom_soa_archetype_storage* rhs,
+                       const dom_archetype_id* arch_ids)
+{
+    u32 a;
+    u32 f;
+    u32 row;
+    for (a = 0u; a < BENCH_ARCHETYPES; ++a) {
+        for (f = 0u; f < BENCH_FIELDS; ++f) {
+            for (row = 0u; row < BENCH_ROWS; ++row) {
+                if (lhs->read_u64(arch_ids[a], 100u + a, f + 1u, row) !=
+                    rhs->read_u64(arch_ids[a], 100u + a, f + 1u, row)) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+static int bench_size(dom_thread_pool* pool, u32 count)
+{
+    dom_soa_archetype_storage* serial = new dom_soa_archetype_storage();
+    dom_soa_archetype_storage* pooled = new dom_soa_archetype_storage();
+    dom_archetype_id arch_ids[BENCH_ARCHETYPES];
+    std::vector<dom_ecs_write_op> ops;
+    std::vector<u64> data;
+    u64 serial_us;
+    u64 pooled_us;
+    int ok;
+
+    bench_build(serial, arch_ids);
+    bench_build(pooled, arch_ids);
+    pooled->set_thread_pool(pool);
+    bench_make_ops(ops, data, arch_ids, count);
+    serial_us = bench_commit(serial, ops);
+    pooled_us = bench_commit(pooled, ops);
+    printf("%-10s %9u %12.1f\n", "serial", count, (double)serial_us * 1000.0 / (double)count);
+    printf("%-10s %9u %12.1f\n", "pooled", count, (double)pooled_us * 1000.0 / (double)count);
+    ok = (serial_us > 0u && pooled_us > 0u && bench_equal(serial, pooled, arch_ids));
+    if (!ok) {
+        fprintf(stderr, "ecs_soa_commit_bench: pooled commit diverged at %u ops\n", count);
+    }
+    delete serial;
+    delete pooled;
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    dom_thread_pool pool;
+    u32 sizes[2] = { 100000u, 1000000u };
+    u32 size_count = 2u;
+    u32 i;
+    int rc = 0;
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+        sizes[0] = 20000u;
+        size_count = 1u;
+    }
+    if (dom_thread_pool_init(&pool, BENCH_WORKERS, 256u) != D_TRUE) {
+        fprintf(stderr, "ecs_soa_commit_bench: thread pool init failed\n");
+        return 1;
+    }
+    printf("%-10s %9s %12s\n", "mode", "writes", "ns/op");
+    for (i = 0u; i < size_count && rc == 0; ++i) {
+        rc = bench_size(&pool, sizes[i]);
+    }
+    dom_thread_pool_shutdown(&pool);
+    return rc;
+}
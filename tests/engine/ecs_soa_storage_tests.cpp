@@ -2,6 +2,7 @@
 ECS SoA storage backend tests (ECSX2).
 */
 #include "ecs/soa_archetype_storage.h"
+#include "thread_pool.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -329,6 +330,168 @@ static int test_access_enforcement(void)
     return 0;
 }
 
+static void write_u64_column(dom_soa_archetype_storage& backend,
+                             dom_archetype_id arch_id,
+                             dom_component_id component_id,
+                             const u64* values,
+                             u32 count)
+{
+    dom_ecs_write_op op;
+    dom_ecs_write_buffer buffer;
+    dom_ecs_commit_context ctx;
+    op.commit_key.phase_id = 0u;
+    op.commit_key.task_id = 1u;
+    op.commit_key.sub_index = 0u;
+    op.archetype_id = arch_id;
+    op.range.archetype_id = arch_id;
+    op.range.begin_index = 0u;
+    op.range.end_index = count;
+    op.component_id = component_id;
+    op.field_id = 1u;
+    op.element_type = DOM_ECS_ELEM_U64;
+    op.element_size = sizeof(u64);
+    op.access_mode = DOM_ECS_ACCESS_WRITE;
+    op.reduction_op = DOM_REDUCE_NONE;
+    op.data = values;
+    op.stride = sizeof(u64);
+    buffer.ops = &op;
+    buffer.count = 1u;
+    ctx.epoch_id = 0u;
+    ctx.graph_id = 0u;
+    ctx.allow_rollback = D_FALSE;
+    ctx.status = 0;
+    backend.apply_writes(buffer, ctx);
+}
+
+static int test_entity_location_index(void)
+{
+    dom_soa_archetype_storage backend;
+    dom_soa_field_def fields[2];
+    dom_soa_component_def components[2];
+    dom_component_id id_a = 70u;
+    dom_component_id ids_b[2] = { 71u, 72u };
+    dom_archetype_id arch_a;
+    dom_archetype_id arch_b;
+    dom_archetype_id found;
+    u32 row = 0u;
+    u32 i;
+
+    fields[0] = make_u64_field(1u);
+    fields[1] = make_u64_field(2u);
+    components[0] = make_component(id_a, fields, 1u);
+    TEST_CHECK(backend.add_archetype(components, 1u, 0u) == 0);
+    TEST_CHECK(backend.add_archetype(components, 1u, 0u) == -2);
+    components[0] = make_component(ids_b[1], fields, 2u);
+    components[1] = make_component(ids_b[0], fields, 1u);
+    TEST_CHECK(backend.add_archetype(components, 2u, 0u) == 0);
+    arch_a = dom_soa_archetype_id_from_components(&id_a, 1u);
+    arch_b = dom_soa_archetype_id_from_components(ids_b, 2u);
+
+    for (i = 0u; i < 1000u; ++i) {
+        TEST_CHECK(backend.insert_entity((i & 1u) ? arch_b : arch_a, 5000u + i) == 0);
+    }
+    TEST_CHECK(backend.insert_entity(arch_b, 5000u) == -2);
+    TEST_CHECK(backend.insert_entity(arch_a, DOM_SOA_ENTITY_TOMBSTONE) == -2);
+    TEST_CHECK(backend.remove_entity(arch_b, 5000u) == -2);
+    TEST_CHECK(backend.remove_entity(arch_a, 9999u) == -2);
+
+    TEST_CHECK(dom_archetype_id_equal(backend.get_archetype(5001u), arch_b) == D_TRUE);
+    TEST_CHECK(dom_archetype_id_equal(backend.get_archetype(5998u), arch_a) == D_TRUE);
+    TEST_CHECK(dom_archetype_id_is_valid(backend.get_archetype(4999u)) == D_FALSE);
+    TEST_CHECK(backend.locate(5998u, &found, &row) == 0);
+    TEST_CHECK(dom_archetype_id_equal(found, arch_a) == D_TRUE && row == 499u);
+    TEST_CHECK(backend.locate(4999u, &found, &row) != 0);
+
+    /* Stable removal outside a phase compacts at once and re-rows the tail. */
+    TEST_CHECK(backend.remove_entity(arch_a, 5000u) == 0);
+    TEST_CHECK(backend.locate(5998u, &found, &row) == 0 && row == 498u);
+    TEST_CHECK(backend.query_archetype(arch_a).end_index == 499u);
+    TEST_CHECK(dom_archetype_id_is_valid(backend.get_archetype(5000u)) == D_FALSE);
+    TEST_CHECK(backend.insert_entity(arch_b, 5000u) == 0);
+    TEST_CHECK(backend.query_archetype(arch_b).end_index == 501u);
+    return 0;
+}
+
+static int test_swap_remove(void)
+{
+    dom_soa_archetype_storage backend;
+    dom_soa_field_def fields[1];
+    dom_soa_component_def components[1];
+    dom_component_id component_id = 80u;
+    dom_archetype_id arch_id;
+    u64 values[5] = { 10u, 20u, 30u, 40u, 50u };
+    u32 row = 0u;
+    u32 i;
+
+    fields[0] = make_u64_field(1u);
+    components[0] = make_component(component_id, fields, 1u);
+    backend.add_archetype(components, 1u, 5u);
+    arch_id = dom_soa_archetype_id_from_components(&component_id, 1u);
+    backend.set_access_rule(arch_id, component_id, 1u, DOM_ECS_ACCESS_READWRITE);
+    for (i = 0u; i < 5u; ++i) {
+        backend.insert_entity(arch_id, 1u + i);
+    }
+    write_u64_column(backend, arch_id, component_id, values, 5u);
+
+    backend.set_remove_mode(DOM_SOA_REMOVE_SWAP);
+    TEST_CHECK(backend.remove_mode() == DOM_SOA_REMOVE_SWAP);
+    TEST_CHECK(backend.remove_entity(arch_id, 2u) == 0);
+    TEST_CHECK(backend.query_archetype(arch_id).end_index == 4u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 1u) == 50u);
+    TEST_CHECK(backend.locate(5u, 0, &row) == 0 && row == 1u);
+    TEST_CHECK(backend.remove_entity(arch_id, 4u) == 0);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 0u) == 10u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 1u) == 50u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 2u) == 30u);
+    TEST_CHECK(backend.locate(3u, 0, &row) == 0 && row == 2u);
+    return 0;
+}
+
+static int test_phase_tombstones(void)
+{
+    dom_soa_archetype_storage backend;
+    dom_soa_field_def fields[1];
+    dom_soa_component_def components[1];
+    dom_component_id component_id = 90u;
+    dom_archetype_id arch_id;
+    u64 values[6] = { 10u, 20u, 30u, 40u, 50u, 60u };
+    u32 row = 0u;
+    u32 i;
+
+    fields[0] = make_u64_field(1u);
+    components[0] = make_component(component_id, fields, 1u);
+    backend.add_archetype(components, 1u, 6u);
+    arch_id = dom_soa_archetype_id_from_components(&component_id, 1u);
+    backend.set_access_rule(arch_id, component_id, 1u, DOM_ECS_ACCESS_READWRITE);
+    for (i = 0u; i < 6u; ++i) {
+        backend.insert_entity(arch_id, 1u + i);
+    }
+    write_u64_column(backend, arch_id, component_id, values, 6u);
+
+    backend.begin_phase();
+    TEST_CHECK(backend.remove_entity(arch_id, 2u) == 0);
+    TEST_CHECK(backend.remove_entity(arch_id, 3u) == 0);
+    TEST_CHECK(backend.remove_entity(arch_id, 5u) == 0);
+    /* Rows stay addressable until the phase ends. */
+    TEST_CHECK(backend.query_archetype(arch_id).end_index == 6u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 5u) == 60u);
+    TEST_CHECK(backend.locate(6u, 0, &row) == 0 && row == 5u);
+    TEST_CHECK(dom_archetype_id_is_valid(backend.get_archetype(3u)) == D_FALSE);
+    TEST_CHECK(backend.remove_entity(arch_id, 3u) == -2);
+    backend.end_phase();
+
+    TEST_CHECK(backend.query_archetype(arch_id).end_index == 3u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 0u) == 10u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 1u) == 40u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 2u) == 60u);
+    TEST_CHECK(backend.locate(4u, 0, &row) == 0 && row == 1u);
+    TEST_CHECK(backend.locate(6u, 0, &row) == 0 && row == 2u);
+    TEST_CHECK(backend.insert_entity(arch_id, 2u) == 0);
+    TEST_CHECK(backend.locate(2u, 0, &row) == 0 && row == 3u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 3u) == 0u);
+    return 0;
+}
+
 class DummyBackend : public IEcsStorageBackend {
 public:
     DummyBackend() : count_(0u) {}
@@ -362,6 +525,442 @@ private:
     u32 count_;
 };
 
+static dom_commit_key make_key(u64 task_id)
+{
+    dom_commit_key key;
+    key.phase_id = 0u;
+    key.task_id = task_id;
+    key.sub_index = 0u;
+    return key;
+}
+
+static int apply_structural(dom_soa_archetype_storage& backend, const dom_soa_struct_buffer& changes)
+{
+    dom_ecs_commit_context ctx;
+    ctx.epoch_id = 0u;
+    ctx.graph_id = 0u;
+    ctx.allow_rollback = D_FALSE;
+    ctx.status = 0;
+    backend.apply_structural(changes, ctx);
+    return ctx.status;
+}
+
+static int test_structural_migration(void)
+{
+    dom_soa_archetype_storage backend;
+    dom_soa_field_def fields[1];
+    dom_soa_component_def components[1];
+    dom_soa_struct_op storage[8];
+    dom_soa_struct_buffer changes;
+    dom_component_id ids[2] = { 10u, 20u };
+    dom_archetype_id arch_a;
+    dom_archetype_id arch_b;
+    dom_archetype_id arch_ab;
+    dom_archetype_id resolved;
+    dom_commit_key key;
+    u64 values[4] = { 100u, 200u, 300u, 400u };
+    u64 b_values[1] = { 7u };
+    u32 row = 0u;
+    u32 i;
+
+    fields[0] = make_u64_field(1u);
+    components[0] = make_component(ids[0], fields, 1u);
+    backend.add_archetype(components, 1u, 4u);
+    components[0] = make_component(ids[1], fields, 1u);
+    backend.add_archetype(components, 1u, 1u);
+    arch_a = dom_soa_archetype_id_from_components(&ids[0], 1u);
+    arch_b = dom_soa_archetype_id_from_components(&ids[1], 1u);
+    arch_ab = dom_soa_archetype_id_from_components(ids, 2u);
+    backend.set_access_rule(arch_a, ids[0], 1u, DOM_ECS_ACCESS_READWRITE);
+    backend.set_access_rule(arch_b, ids[1], 1u, DOM_ECS_ACCESS_READWRITE);
+    for (i = 0u; i < 4u; ++i) {
+        backend.insert_entity(arch_a, 1u + i);
+    }
+    backend.insert_entity(arch_b, 9u);
+    write_u64_column(backend, arch_a, ids[0], values, 4u);
+    write_u64_column(backend, arch_b, ids[1], b_values, 1u);
+
+    /* Applied in commit key order: entity 4 lands before entity 2. */
+    dom_soa_struct_buffer_init(&changes, storage, 8u);
+    key = make_key(2u);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 2u, ids[1]) == 0);
+    key = make_key(1u);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 4u, ids[1]) == 0);
+    key = make_key(3u);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 3u, ids[1]) == 0);
+    key = make_key(4u);
+    TEST_CHECK(dom_soa_struct_buffer_remove_component(&changes, &key, 3u, ids[1]) == 0);
+    TEST_CHECK(dom_soa_struct_buffer_move(&changes, &key, 9u, arch_a) == 0);
+    TEST_CHECK(apply_structural(backend, changes) == 0);
+
+    TEST_CHECK(backend.query_archetype(arch_ab).end_index == 2u);
+    TEST_CHECK(backend.read_u64(arch_ab, ids[0], 1u, 0u) == 400u);
+    TEST_CHECK(backend.read_u64(arch_ab, ids[0], 1u, 1u) == 200u);
+    TEST_CHECK(backend.read_u64(arch_ab, ids[1], 1u, 0u) == 0u);
+    TEST_CHECK(backend.locate(2u, &resolved, &row) == 0 && row == 1u);
+    TEST_CHECK(dom_archetype_id_equal(resolved, arch_ab));
+    TEST_CHECK(backend.query_archetype(arch_a).end_index == 3u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 0u) == 100u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 1u) == 300u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 2u) == 0u);
+    TEST_CHECK(backend.locate(9u, 0, &row) == 0 && row == 2u);
+    TEST_CHECK(backend.query_archetype(arch_b).end_index == 0u);
+
+    /* The created archetype inherits access rules; edges resolve both ways. */
+    TEST_CHECK((backend.get_view(arch_ab, ids[0], 1u).view_flags & DOM_ECS_VIEW_VALID) != 0u);
+    TEST_CHECK(backend.prepare_transition(arch_a, DOM_SOA_STRUCT_ADD_COMPONENT, ids[1], &resolved) == 0);
+    TEST_CHECK(dom_archetype_id_equal(resolved, arch_ab));
+    TEST_CHECK(backend.prepare_transition(arch_ab, DOM_SOA_STRUCT_REMOVE_COMPONENT, ids[0], &resolved) == 0);
+    TEST_CHECK(dom_archetype_id_equal(resolved, arch_b));
+    TEST_CHECK(backend.prepare_transition(arch_a, DOM_SOA_STRUCT_REMOVE_COMPONENT, ids[0], &resolved) != 0);
+    TEST_CHECK(backend.prepare_transition(arch_a, DOM_SOA_STRUCT_ADD_COMPONENT, 99u, &resolved) != 0);
+
+    /* One bad op rejects the whole batch. */
+    dom_soa_struct_buffer_clear(&changes);
+    key = make_key(1u);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 1u, ids[1]) == 0);
+    TEST_CHECK(dom_soa_struct_buffer_remove_component(&changes, &key, 77u, ids[0]) == 0);
+    TEST_CHECK(apply_structural(backend, changes) == -1);
+    TEST_CHECK(dom_archetype_id_equal(backend.get_archetype(1u), arch_a));
+    TEST_CHECK(backend.query_archetype(arch_a).end_index == 3u);
+    TEST_CHECK(backend.query_archetype(arch_ab).end_index == 2u);
+    return 0;
+}
+
+static int test_structural_swap_and_phase(void)
+{
+    dom_soa_archetype_storage backend;
+    dom_soa_field_def fields[1];
+    dom_soa_component_def components[2];
+    dom_soa_struct_op storage[4];
+    dom_soa_struct_buffer changes;
+    dom_component_id ids[2] = { 10u, 20u };
+    dom_archetype_id arch_a;
+    dom_archetype_id arch_ab;
+    dom_commit_key key;
+    u64 values[6] = { 10u, 20u, 30u, 40u, 50u, 60u };
+    u32 row = 0u;
+    u32 i;
+
+    fields[0] = make_u64_field(1u);
+    components[0] = make_component(ids[0], fields, 1u);
+    components[1] = make_component(ids[1], fields, 1u);
+    backend.add_archetype(components, 1u, 6u);
+    backend.add_archetype(components, 2u, 2u);
+    arch_a = dom_soa_archetype_id_from_components(&ids[0], 1u);
+    arch_ab = dom_soa_archetype_id_from_components(ids, 2u);
+    backend.set_access_rule(arch_a, ids[0], 1u, DOM_ECS_ACCESS_READWRITE);
+    for (i = 0u; i < 6u; ++i) {
+        backend.insert_entity(arch_a, 1u + i);
+    }
+    write_u64_column(backend, arch_a, ids[0], values, 6u);
+
+    /* Swap mode fills holes from the tail, highest hole first. */
+    backend.set_remove_mode(DOM_SOA_REMOVE_SWAP);
+    dom_soa_struct_buffer_init(&changes, storage, 4u);
+    key = make_key(1u);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 2u, ids[1]) == 0);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 5u, ids[1]) == 0);
+    TEST_CHECK(apply_structural(backend, changes) == 0);
+    TEST_CHECK(backend.query_archetype(arch_a).end_index == 4u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 0u) == 10u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 1u) == 60u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 2u) == 30u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 3u) == 40u);
+    TEST_CHECK(backend.locate(6u, 0, &row) == 0 && row == 1u);
+    TEST_CHECK(backend.read_u64(arch_ab, ids[0], 1u, 0u) == 20u);
+    TEST_CHECK(backend.read_u64(arch_ab, ids[0], 1u, 1u) == 50u);
+
+    /* Stable mode inside a phase leaves the vacated row until end_phase. */
+    backend.set_remove_mode(DOM_SOA_REMOVE_STABLE);
+    backend.begin_phase();
+    dom_soa_struct_buffer_clear(&changes);
+    TEST_CHECK(dom_soa_struct_buffer_add_component(&changes, &key, 1u, ids[1]) == 0);
+    TEST_CHECK(apply_structural(backend, changes) == 0);
+    TEST_CHECK(backend.query_archetype(arch_a).end_index == 4u);
+    TEST_CHECK(backend.locate(3u, 0, &row) == 0 && row == 2u);
+    TEST_CHECK(backend.locate(1u, 0, &row) == 0 && row == 2u);
+    backend.end_phase();
+    TEST_CHECK(backend.query_archetype(arch_a).end_index == 3u);
+    TEST_CHECK(backend.read_u64(arch_a, ids[0], 1u, 0u) == 60u);
+    TEST_CHECK(backend.locate(3u, 0, &row) == 0 && row == 1u);
+    TEST_CHECK(backend.read_u64(arch_ab, ids[0], 1u, 2u) == 10u);
+    return 0;
+}
+
+#define PARITY_ARCHETYPES 3u
+#define PARITY_FIELDS 4u
+#define PARITY_ROWS 64u
+#define PARITY_SPAN 16u
+#define PARITY_OPS 6000u
+
+static u32 g_parity_rng = 0x5EED1234u;
+static u64 g_parity_data[PARITY_OPS][PARITY_SPAN];
+
+static u32 parity_rand(void)
+{
+    g_parity_rng = g_parity_rng * 1664525u + 1013904223u;
+    return g_parity_rng >> 8;
+}
+
+static void build_parity_backend(dom_soa_archetype_storage& backend, dom_archetype_id* arch_ids)
+{
+    dom_soa_field_def fields[PARITY_FIELDS];
+    dom_soa_component_def components[1];
+    u32 a;
+    u32 f;
+    u32 e;
+    for (f = 0u; f < PARITY_FIELDS; ++f) {
+        fields[f] = make_u64_field(1u + f);
+        if (f >= 2u) {
+            fields[f].element_type = DOM_ECS_ELEM_I64;
+        }
+    }
+    for (a = 0u; a < PARITY_ARCHETYPES; ++a) {
+        dom_component_id component_id = 500u + a;
+        components[0] = make_component(component_id, fields, PARITY_FIELDS);
+        backend.add_archetype(components, 1u, PARITY_ROWS);
+        arch_ids[a] = dom_soa_archetype_id_from_components(&component_id, 1u);
+        for (f = 0u; f < PARITY_FIELDS; ++f) {
+            backend.set_access_rule(arch_ids[a], component_id, 1u + f,
+                                    DOM_ECS_ACCESS_READWRITE | DOM_ECS_ACCESS_REDUCE);
+        }
+        for (e = 0u; e < PARITY_ROWS; ++e) {
+            backend.insert_entity(arch_ids[a], 1000u * (a + 1u) + e);
+        }
+    }
+}
+
+static int parity_backends_equal(const dom_soa_archetype_storage& lhs,
+                                 const dom_soa_archetype_storage& rhs,
+                                 const dom_archetype_id* arch_ids)
+{
+    u32 a;
+    u32 f;
+    u32 row;
+    for (a = 0u; a < PARITY_ARCHETYPES; ++a) {
+        for (f = 0u; f < PARITY_FIELDS; ++f) {
+            for (row = 0u; row < PARITY_ROWS; ++row) {
+                if (lhs.read_u64(arch_ids[a], 500u + a, 1u + f, row) !=
+                    rhs.read_u64(arch_ids[a], 500u + a, 1u + f, row)) {
+                    return 0;
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+typedef struct nested_apply {
+    dom_soa_archetype_storage* storage;
+    const dom_ecs_write_buffer* buffer;
+    dom_ecs_commit_context* ctx;
+} nested_apply;
+
+static void nested_apply_run(void* user)
+{
+    nested_apply* job = (nested_apply*)user;
+    job->storage->apply_writes(*job->buffer, *job->ctx);
+}
+
+static int test_commit_parity(void)
+{
+    static dom_ecs_write_op ops[PARITY_OPS];
+    static u32 order[PARITY_OPS];
+    dom_soa_archetype_storage reference;
+    dom_soa_archetype_storage serial;
+    dom_soa_archetype_storage pooled;
+    dom_soa_archetype_storage nested;
+    dom_archetype_id arch_ids[PARITY_ARCHETYPES];
+    dom_ecs_write_buffer buffer;
+    dom_ecs_commit_context ctx;
+    dom_ecs_commit_context nested_ctx;
+    dom_thread_pool pool;
+    dom_thread_pool_task task;
+    nested_apply job;
+    u32 i;
+
+    build_parity_backend(reference, arch_ids);
+    build_parity_backend(serial, arch_ids);
+    build_parity_backend(pooled, arch_ids);
+    build_parity_backend(nested, arch_ids);
+    for (i = 0u; i < PARITY_OPS; ++i) {
+        dom_ecs_write_op* op = &ops[i];
+        const u32 a = parity_rand() % PARITY_ARCHETYPES;
+        const u32 kind = parity_rand() % 4u;
+        const u32 begin = parity_rand() % (PARITY_ROWS - PARITY_SPAN);
+        u32 f = parity_rand() % PARITY_FIELDS;
+        u32 v;
+        op->commit_key.phase_id = parity_rand() % 2u;
+        op->commit_key.task_id = (u64)(parity_rand() % 8u) | ((parity_rand() & 1u) ? (1ULL << 40) : 0u);
+        op->commit_key.sub_index = parity_rand() % 3u;
+        op->archetype_id = arch_ids[a];
+        op->range.archetype_id = arch_ids[a];
+        op->range.begin_index = begin;
+        op->range.end_index = begin + 1u + parity_rand() % PARITY_SPAN;
+        op->reduction_op = (kind == 0u) ? DOM_REDUCE_NONE :
+                           (kind == 1u) ? DOM_REDUCE_INT_SUM :
+                           (kind == 2u) ? DOM_REDUCE_INT_MIN : DOM_REDUCE_INT_MAX;
+        if (a == 0u && (i & 1u)) {
+            /* A hot column taking only sums over one range forms long runs. */
+            f = 1u;
+            op->range.begin_index = 4u;
+            op->range.end_index = 12u;
+            op->reduction_op = DOM_REDUCE_INT_SUM;
+        } else if (a == 0u && f == 1u) {
+            f = 0u;
+        }
+        op->component_id = 500u + a;
+        op->field_id = 1u + f;
+        op->element_type = (f >= 2u) ? DOM_ECS_ELEM_I64 : DOM_ECS_ELEM_U64;
+        op->element_size = sizeof(u64);
+        op->access_mode = (op->reduction_op == DOM_REDUCE_NONE) ? DOM_ECS_ACCESS_WRITE : DOM_ECS_ACCESS_REDUCE;
+        for (v = 0u; v < PARITY_SPAN; ++v) {
+            g_parity_data[i][v] = ((u64)parity_rand() << 20) - 0x40000000ULL;
+        }
+        op->data = g_parity_data[i];
+        op->stride = sizeof(u64);
+        order[i] = i;
+    }
+
+    /* Reference: one op per commit, in stable commit key order. */
+    for (i = 1u; i < PARITY_OPS; ++i) {
+        u32 key = order[i];
+        u32 j = i;
+        while (j > 0u && dom_commit_key_compare(&ops[order[j - 1u]].commit_key, &ops[key].commit_key) > 0) {
+            order[j] = order[j - 1u];
+            --j;
+        }
+        order[j] = key;
+    }
+    ctx.epoch_id = 0u;
+    ctx.graph_id = 0u;
+    ctx.allow_rollback = D_FALSE;
+    for (i = 0u; i < PARITY_OPS; ++i) {
+        buffer.ops = &ops[order[i]];
+        buffer.count = 1u;
+        ctx.status = 0;
+        reference.apply_writes(buffer, ctx);
+        TEST_CHECK(ctx.status == 0);
+    }
+
+    buffer.ops = ops;
+    buffer.count = PARITY_OPS;
+    ctx.status = -5;
+    serial.apply_writes(buffer, ctx);
+    TEST_CHECK(ctx.status == 0);
+    TEST_CHECK(parity_backends_equal(reference, serial, arch_ids));
+
+    TEST_CHECK(dom_thread_pool_init(&pool, 4u, 64u) == D_TRUE);
+    pooled.set_thread_pool(&pool);
+    TEST_CHECK(pooled.thread_pool() == &pool);
+    ctx.status = -5;
+    pooled.apply_writes(buffer, ctx);
+
+    /* Applied from a task on the same pool: serial, not a self-wait. */
+    nested.set_thread_pool(&pool);
+    nested_ctx = ctx;
+    nested_ctx.status = -5;
+    job.storage = &nested;
+    job.buffer = &buffer;
+    job.ctx = &nested_ctx;
+    task.task_id = 0u;
+    task.fn = nested_apply_run;
+    task.user_data = &job;
+    TEST_CHECK(dom_thread_pool_submit(&pool, &task) == D_TRUE);
+    dom_thread_pool_wait(&pool);
+    TEST_CHECK(dom_thread_pool_on_worker(&pool) == D_FALSE);
+    dom_thread_pool_shutdown(&pool);
+    TEST_CHECK(ctx.status == 0);
+    TEST_CHECK(parity_backends_equal(reference, pooled, arch_ids));
+    TEST_CHECK(nested_ctx.status == 0);
+    TEST_CHECK(parity_backends_equal(reference, nested, arch_ids));
+    return 0;
+}
+
+static int test_chunked_columns(void)
+{
+    static u64 values[3000];
+    dom_soa_archetype_storage backend;
+    dom_soa_field_def fields[2];
+    dom_soa_component_def components[1];
+    dom_component_id component_id = 90u;
+    dom_archetype_id arch_id;
+    dom_component_view view;
+    u64 first_chunk;
+    u32 chunks = 0u;
+    u32 free_chunks = 0u;
+    u32 c;
+    u32 i;
+
+    fields[0] = make_u64_field(1u);
+    fields[1] = make_u64_field(2u);
+    fields[1].element_type = DOM_ECS_ELEM_U32;
+    fields[1].element_size = sizeof(u32);
+    components[0] = make_component(component_id, fields, 2u);
+    TEST_CHECK(backend.add_archetype(components, 1u, 0u) == 0);
+    arch_id = dom_soa_archetype_id_from_components(&component_id, 1u);
+    backend.set_access_rule(arch_id, component_id, 1u, DOM_ECS_ACCESS_READWRITE);
+    /* 12 bytes per row: 1024 rows use 12 KiB, 2048 would not fit 16 KiB. */
+    TEST_CHECK(backend.chunk_rows(arch_id) == 1024u);
+    for (i = 0u; i < 3000u; ++i) {
+        TEST_CHECK(backend.insert_entity(arch_id, 1u + i) == 0);
+        values[i] = 7u * i + 1u;
+    }
+    write_u64_column(backend, arch_id, component_id, values, 3000u);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 2500u) == values[2500]);
+    TEST_CHECK(backend.chunk_count(arch_id) == 3u);
+    for (c = 0u; c < 3u; ++c) {
+        const u64* data;
+        view = backend.get_chunk_view(arch_id, component_id, 1u, c);
+        TEST_CHECK(dom_component_view_is_valid(&view) == D_TRUE);
+        TEST_CHECK(view.count == ((c < 2u) ? 1024u : 952u));
+        TEST_CHECK(view.stride == sizeof(u64));
+        TEST_CHECK((view.backend_token % DOM_SOA_CHUNK_ALIGN) == 0u);
+        data = (const u64*)(size_t)view.backend_token;
+        for (i = 0u; i < view.count; ++i) {
+            TEST_CHECK(data[i] == values[c * 1024u + i]);
+        }
+    }
+    view = backend.get_chunk_view(arch_id, component_id, 1u, 3u);
+    TEST_CHECK(dom_component_view_is_valid(&view) == D_FALSE);
+    view = backend.get_chunk_view(arch_id, component_id, 2u, 0u);
+    TEST_CHECK(dom_component_view_is_valid(&view) == D_FALSE);
+
+    /* Growth adds chunks; existing rows stay where they are. */
+    first_chunk = backend.get_chunk_view(arch_id, component_id, 1u, 0u).backend_token;
+    for (i = 3000u; i < 9000u; ++i) {
+        TEST_CHECK(backend.insert_entity(arch_id, 1u + i) == 0);
+    }
+    TEST_CHECK(backend.get_chunk_view(arch_id, component_id, 1u, 0u).backend_token == first_chunk);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 1023u) == values[1023]);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 1024u) == values[1024]);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 8999u) == 0u);
+
+    /* Shrinking hands trailing chunks back to the pool; regrowth reuses them. */
+    backend.set_remove_mode(DOM_SOA_REMOVE_SWAP);
+    backend.chunk_pool_stats(&chunks, &free_chunks);
+    TEST_CHECK(chunks % DOM_SOA_CHUNKS_PER_SLAB == 0u && chunks - free_chunks >= 9u);
+    for (i = 1000u; i < 9000u; ++i) {
+        TEST_CHECK(backend.remove_entity(arch_id, 1u + i) == 0);
+    }
+    TEST_CHECK(backend.chunk_count(arch_id) == 1u);
+    backend.chunk_pool_stats(&c, &free_chunks);
+    TEST_CHECK(c == chunks && chunks - free_chunks == 2u);
+    for (i = 1000u; i < 9000u; ++i) {
+        TEST_CHECK(backend.insert_entity(arch_id, 1u + i) == 0);
+    }
+    backend.chunk_pool_stats(&c, 0);
+    TEST_CHECK(c == chunks);
+    TEST_CHECK(backend.read_u64(arch_id, component_id, 1u, 999u) == values[999]);
+
+    /* A row wider than a chunk cannot be laid out. */
+    fields[0].element_size = DOM_SOA_CHUNK_BYTES + 8u;
+    components[0] = make_component(91u, fields, 1u);
+    TEST_CHECK(backend.add_archetype(components, 1u, 0u) == -3);
+    return 0;
+}
+
 static int test_backend_equivalence_stub(void)
 {
     dom_soa_archetype_storage backend;
@@ -401,6 +1000,13 @@ int main(void)
     if (test_commit_order() != 0) return 1;
     if (test_reduction_ops() != 0) return 1;
     if (test_access_enforcement() != 0) return 1;
+    if (test_entity_location_index() != 0) return 1;
+    if (test_swap_remove() != 0) return 1;
+    if (test_phase_tombstones() != 0) return 1;
+    if (test_structural_migration() != 0) return 1;
+    if (test_structural_swap_and_phase() != 0) return 1;
+    if (test_commit_parity() != 0) return 1;
+    if (test_chunked_columns() != 0) return 1;
     if (test_backend_equivalence_stub() != 0) return 1;
     return 0;
 }
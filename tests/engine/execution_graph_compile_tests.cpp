@@ -0,0 +1,476 @@
+/*
+Compiled task graph and access conflict index tests.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "domino/execution/access_set.h"
+#include "execution/scheduler/scheduler_graph.h"
+#include "execution/scheduler/scheduler_single_thread.h"
+
+#define EXPECT(cond, msg) do { if (!(cond)) { \
+    fprintf(stderr, "FAIL: %s\n", msg); \
+    return 1; \
+} } while (0)
+
+#define POOL_SETS 400u
+#define POOL_RANGES 2400u
+#define GRAPH_TASKS 320u
+#define GRAPH_PHASES 4u
+#define GRAPH_EDGES 900u
+#define DISJOINT_SETS 4096u
+#define DISJOINT_STRIDE 8u
+
+static dom_access_set g_sets[POOL_SETS];
+static dom_access_range g_ranges[POOL_RANGES];
+static u32 g_range_count = 0u;
+static dom_access_set g_disjoint_sets[DISJOINT_SETS];
+static dom_access_range g_disjoint_ranges[DISJOINT_SETS];
+static u32 g_rng = 0x1234567u;
+
+static u32 rng_next(void) {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static dom_access_range *make_ranges(u32 count) {
+    dom_access_range *out = &g_ranges[g_range_count];
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        dom_access_range *r = &out[i];
+        u32 roll = rng_next() % 10u;
+        r->kind = (roll < 5u) ? DOM_RANGE_INDEX_RANGE :
+                  (roll < 8u) ? DOM_RANGE_SINGLE :
+                  (roll < 9u) ? DOM_RANGE_ENTITY_SET : DOM_RANGE_COMPONENT_SET;
+        r->component_id = rng_next() % 6u;
+        r->field_id = rng_next() % 2u;
+        r->start_id = rng_next() % 200u;
+        r->end_id = r->start_id + rng_next() % 12u;
+        r->set_id = rng_next() % 3u;
+    }
+    g_range_count += count;
+    return out;
+}
+
+/* Mostly plain readers/writers, some same-op reducers, a few oddities
+ * (mismatched or invalid ops, NULL range arrays). */
+static void build_sets(void) {
+    u32 i;
+    g_range_count = 0u;
+    for (i = 0u; i < POOL_SETS; ++i) {
+        dom_access_set *s = &g_sets[i];
+        u32 roll = rng_next() % 20u;
+        s->access_id = (u64)(i + 1u);
+        s->read_count = rng_next() % 3u;
+        s->read_ranges = make_ranges(s->read_count);
+        s->write_count = rng_next() % 2u;
+        s->write_ranges = make_ranges(s->write_count);
+        s->reduce_count = 0u;
+        s->reduce_ranges = 0;
+        s->reduction_op = DOM_REDUCE_NONE;
+        s->commutative = D_FALSE;
+        if (roll < 3u) {
+            s->reduce_count = 1u + rng_next() % 2u;
+            s->reduce_ranges = make_ranges(s->reduce_count);
+            s->reduction_op = (roll == 0u) ? DOM_REDUCE_INT_MAX : DOM_REDUCE_INT_SUM;
+            s->commutative = D_TRUE;
+        } else if (roll == 3u) {
+            s->reduction_op = DOM_REDUCE_INT_SUM;
+        } else if (roll == 4u && (rng_next() % 4u) == 0u) {
+            s->write_count = 1u;
+            s->write_ranges = 0;
+        }
+    }
+}
+
+static int test_conflict_index_matches_pairwise(void) {
+    dom_access_conflict_index idx;
+    const dom_access_set *group[64];
+    u32 round;
+    u32 conflicts = 0u;
+    u32 clean = 0u;
+    dom_access_conflict_index_init(&idx);
+    for (round = 0u; round < 200u; ++round) {
+        u32 group_count = 0u;
+        u32 n;
+        dom_access_conflict_index_clear(&idx);
+        for (n = 0u; n < 40u; ++n) {
+            const dom_access_set *cand = &g_sets[rng_next() % POOL_SETS];
+            d_bool expect = D_FALSE;
+            d_bool got;
+            u32 j;
+            for (j = 0u; j < group_count; ++j) {
+                if (dom_detect_access_conflicts(cand, group[j]) == D_TRUE) {
+                    expect = D_TRUE;
+                    break;
+                }
+            }
+            got = dom_access_conflict_index_conflicts(&idx, cand);
+            if (got != expect) {
+                dom_access_conflict_index_free(&idx);
+                EXPECT(0, "index answer matches pairwise scan");
+            }
+            if (expect == D_TRUE) {
+                conflicts += 1u;
+            } else {
+                clean += 1u;
+            }
+            /* Mostly admit like a scheduler, sometimes force conflicting sets in. */
+            if ((expect == D_FALSE || (rng_next() % 8u) == 0u) && group_count < 64u) {
+                group[group_count++] = cand;
+                dom_access_conflict_index_add(&idx, cand);
+            }
+        }
+    }
+    dom_access_conflict_index_free(&idx);
+    EXPECT(conflicts > 100u && clean > 100u, "both outcomes exercised");
+    return 0;
+}
+
+static void make_single_range_set(dom_access_set *s, dom_access_range *r, u64 id,
+                                  u64 start, u64 end, d_bool written) {
+    memset(s, 0, sizeof(*s));
+    r->kind = (start == end) ? DOM_RANGE_SINGLE : DOM_RANGE_INDEX_RANGE;
+    r->component_id = 3u;
+    r->field_id = 1u;
+    r->start_id = start;
+    r->end_id = end;
+    r->set_id = 0u;
+    s->access_id = id;
+    s->reduction_op = DOM_REDUCE_NONE;
+    if (written) {
+        s->write_ranges = r;
+        s->write_count = 1u;
+    } else {
+        s->read_ranges = r;
+        s->read_count = 1u;
+    }
+}
+
+/* Thousands of ranges on one (component, field): mostly disjoint, some
+ * adjacent, a few inverted. Queries (some inverted too) land in the gaps and
+ * on the edges, and must agree with the pairwise check. */
+static int test_conflict_index_disjoint_ranges(void) {
+    dom_access_conflict_index idx;
+    dom_access_set query;
+    dom_access_range query_range;
+    u32 conflicts = 0u;
+    u32 clean = 0u;
+    u32 i;
+    dom_access_conflict_index_init(&idx);
+    for (i = 0u; i < DISJOINT_SETS; ++i) {
+        const u64 base = (u64)i * DISJOINT_STRIDE;
+        u64 start = base;
+        u64 end = base + 2u;
+        if ((i % 5u) == 0u) {
+            end = base + DISJOINT_STRIDE - 1u;
+        } else if ((i % 97u) == 0u) {
+            start = base + 2u;
+            end = base;
+        }
+        make_single_range_set(&g_disjoint_sets[i], &g_disjoint_ranges[i], (u64)(i + 1u),
+                              start, end, (i & 1u) ? D_TRUE : D_FALSE);
+        dom_access_conflict_index_add(&idx, &g_disjoint_sets[i]);
+    }
+    for (i = 0u; i < 3000u; ++i) {
+        const u64 start = rng_next() % (DISJOINT_SETS * DISJOINT_STRIDE + 16u);
+        const u64 len = rng_next() % 6u;
+        const d_bool written = (rng_next() & 1u) ? D_TRUE : D_FALSE;
+        d_bool expect = D_FALSE;
+        d_bool got;
+        u32 j;
+        if ((i % 11u) == 0u && start >= len) {
+            make_single_range_set(&query, &query_range, 0u, start, start - len, written);
+        } else {
+            make_single_range_set(&query, &query_range, 0u, start, start + len, written);
+        }
+        for (j = 0u; j < DISJOINT_SETS; ++j) {
+            if (dom_detect_access_conflicts(&query, &g_disjoint_sets[j]) == D_TRUE) {
+                expect = D_TRUE;
+                break;
+            }
+        }
+        got = dom_access_conflict_index_conflicts(&idx, &query);
+        if (got != expect) {
+            dom_access_conflict_index_free(&idx);
+            EXPECT(0, "disjoint range answer matches pairwise scan");
+        }
+        if (expect == D_TRUE) {
+            conflicts += 1u;
+        } else {
+            clean += 1u;
+        }
+    }
+    dom_access_conflict_index_free(&idx);
+    EXPECT(conflicts > 100u && clean > 100u, "disjoint ranges hit and miss");
+    return 0;
+}
+
+static dom_task_node make_task(u64 task_id, u32 phase_id, u64 access_set_id) {
+    static const u32 law_targets[1] = { 1u };
+    dom_task_node node;
+    memset(&node, 0, sizeof(node));
+    node.task_id = task_id;
+    node.system_id = 1u;
+    node.category = DOM_TASK_AUTHORITATIVE;
+    node.determinism_class = DOM_DET_STRICT;
+    node.fidelity_tier = DOM_FID_MICRO;
+    node.next_due_tick = DOM_EXEC_TICK_INVALID;
+    node.access_set_id = access_set_id;
+    node.cost_model_id = 1u;
+    node.law_targets = law_targets;
+    node.law_target_count = 1u;
+    node.phase_id = phase_id;
+    node.commit_key.phase_id = phase_id;
+    node.commit_key.task_id = task_id;
+    node.law_scope_ref = 1u;
+    return node;
+}
+
+static dom_task_graph make_graph(const dom_task_node *tasks, u32 task_count,
+                                 const dom_dependency_edge *edges, u32 edge_count) {
+    dom_task_graph graph;
+    memset(&graph, 0, sizeof(graph));
+    graph.graph_id = 1u;
+    graph.epoch_id = 1u;
+    graph.tasks = tasks;
+    graph.task_count = task_count;
+    graph.dependency_edges = edges;
+    graph.dependency_count = edge_count;
+    return graph;
+}
+
+static dom_dependency_edge make_edge(u64 from, u64 to) {
+    dom_dependency_edge e;
+    e.from_task_id = from;
+    e.to_task_id = to;
+    e.reason_id = 0u;
+    return e;
+}
+
+static int test_compile_validation(void) {
+    dom_task_node tasks[5];
+    dom_dependency_edge edges[4];
+    dom_sched_graph g;
+    dom_task_graph graph;
+    const dom_sched_graph *got;
+    u64 fp;
+    tasks[0] = make_task(10u, 1u, 1u);
+    tasks[1] = make_task(11u, 1u, 1u);
+    tasks[2] = make_task(12u, 1u, 1u);
+    tasks[3] = make_task(20u, 2u, 1u);
+    tasks[4] = make_task(21u, 2u, 1u);
+    dom_sched_graph_init(&g);
+
+    edges[0] = make_edge(10u, 12u);
+    edges[1] = make_edge(11u, 12u);
+    edges[2] = make_edge(12u, 20u);
+    edges[3] = make_edge(20u, 21u);
+    graph = make_graph(tasks, 5u, edges, 4u);
+    EXPECT(dom_sched_graph_compile(graph, &g) == D_TRUE, "valid graph compiles");
+    EXPECT(g.indegree[2] == 2u && g.indegree[3] == 0u && g.indegree[4] == 1u,
+           "in-phase indegrees; cross-phase edge dropped");
+    EXPECT(g.succ_start[2] == g.succ_start[3] && g.succ[g.succ_start[3]] == 4u,
+           "successor lists");
+
+    /* Cached acquire leaves the compiled arrays alone. */
+    got = dom_sched_graph_acquire(&g, graph);
+    EXPECT(got == &g, "acquire valid graph");
+    fp = g.fingerprint;
+    {
+        const u32 *succ = g.succ;
+        EXPECT(dom_sched_graph_acquire(&g, graph) == &g && g.succ == succ,
+               "unchanged graph reuses compiled form");
+    }
+    edges[3] = make_edge(21u, 20u);
+    EXPECT(dom_sched_graph_acquire(&g, graph) == &g && g.fingerprint != fp &&
+           g.indegree[3] == 1u && g.indegree[4] == 0u, "changed edge recompiles");
+
+    edges[3] = make_edge(20u, 99u);
+    EXPECT(dom_sched_graph_acquire(&g, graph) == 0, "unknown task id rejected");
+    edges[3] = make_edge(20u, 11u);
+    EXPECT(dom_sched_graph_acquire(&g, graph) == 0, "backward phase edge rejected");
+    edges[3] = make_edge(12u, 10u);
+    EXPECT(dom_sched_graph_acquire(&g, graph) == 0, "cycle rejected");
+    edges[3] = make_edge(21u, 21u);
+    EXPECT(dom_sched_graph_acquire(&g, graph) == 0, "self edge rejected");
+    EXPECT(dom_sched_graph_acquire(&g, graph) == 0, "cached invalid graph stays invalid");
+    tasks[1].law_scope_ref = 0u;
+    edges[3] = make_edge(20u, 21u);
+    EXPECT(dom_sched_graph_acquire(&g, graph) == 0, "invalid node rejected");
+    tasks[1].law_scope_ref = 1u;
+    EXPECT(dom_sched_graph_acquire(&g, graph) == &g, "valid again");
+    dom_sched_graph_free(&g);
+    return 0;
+}
+
+typedef struct sched_ctx {
+    u64 order[GRAPH_TASKS * 2u];
+    u32 count;
+} sched_ctx;
+
+static const dom_access_set *lookup_set(const dom_execution_context *ctx, u64 id, void *user_data) {
+    (void)ctx;
+    (void)user_data;
+    return (id >= 1u && id <= POOL_SETS) ? &g_sets[id - 1u] : 0;
+}
+
+static dom_law_decision accept_all(const dom_execution_context *ctx,
+                                   const dom_task_node *node,
+                                   void *user_data) {
+    dom_law_decision d;
+    (void)ctx;
+    (void)node;
+    (void)user_data;
+    d.kind = DOM_LAW_ACCEPT;
+    d.refusal_code = 0u;
+    d.transformed_fidelity_tier = 0u;
+    d.transformed_next_due_tick = DOM_EXEC_TICK_INVALID;
+    return d;
+}
+
+class OrderSink : public IScheduleSink {
+public:
+    explicit OrderSink(sched_ctx *out) : m_out(out) {}
+    virtual void on_task(const dom_task_node &node, const dom_law_decision &) {
+        m_out->order[m_out->count++] = node.task_id;
+    }
+    virtual void on_commit(const dom_task_node &node) {
+        m_out->order[m_out->count++] = node.task_id | 0x8000000000000000ull;
+    }
+private:
+    sched_ctx *m_out;
+};
+
+/* The scheduler as it was before graph compilation: edge scans, a linear
+ * pick of the first ready task and pairwise conflict checks. */
+static void reference_schedule(const dom_task_graph &graph, sched_ctx *out) {
+    static u32 indegree[GRAPH_TASKS];
+    static d_bool scheduled[GRAPH_TASKS];
+    static const dom_access_set *admitted[GRAPH_TASKS];
+    static dom_task_node commits[GRAPH_TASKS];
+    u32 phase_start = 0u;
+    while (phase_start < graph.task_count) {
+        u32 phase_end = phase_start;
+        u32 count;
+        u32 n;
+        u32 i;
+        while (phase_end < graph.task_count &&
+               graph.tasks[phase_end].phase_id == graph.tasks[phase_start].phase_id) {
+            phase_end += 1u;
+        }
+        for (i = phase_start; i < phase_end; ++i) {
+            indegree[i] = 0u;
+            scheduled[i] = D_FALSE;
+        }
+        for (i = 0u; i < graph.dependency_count; ++i) {
+            u32 from = (u32)graph.dependency_edges[i].from_task_id - 1u;
+            u32 to = (u32)graph.dependency_edges[i].to_task_id - 1u;
+            if (from >= phase_start && from < phase_end && to >= phase_start && to < phase_end) {
+                indegree[to] += 1u;
+            }
+        }
+        count = 0u;
+        for (n = phase_start; n < phase_end; ++n) {
+            u32 pick = phase_end;
+            const dom_access_set *set;
+            d_bool conflict = D_FALSE;
+            for (i = phase_start; i < phase_end; ++i) {
+                if (!scheduled[i] && indegree[i] == 0u) {
+                    pick = i;
+                    break;
+                }
+            }
+            if (pick == phase_end) {
+                break;
+            }
+            scheduled[pick] = D_TRUE;
+            set = lookup_set(0, graph.tasks[pick].access_set_id, 0);
+            if (set && dom_verify_reduction_rules(set) == D_TRUE) {
+                for (i = 0u; i < count; ++i) {
+                    if (dom_detect_access_conflicts(set, admitted[i]) == D_TRUE) {
+                        conflict = D_TRUE;
+                        break;
+                    }
+                }
+                if (!conflict) {
+                    out->order[out->count++] = graph.tasks[pick].task_id;
+                    admitted[count] = set;
+                    commits[count] = graph.tasks[pick];
+                    count += 1u;
+                }
+            }
+            for (i = 0u; i < graph.dependency_count; ++i) {
+                u32 from = (u32)graph.dependency_edges[i].from_task_id - 1u;
+                u32 to = (u32)graph.dependency_edges[i].to_task_id - 1u;
+                if (from == pick && to >= phase_start && to < phase_end && indegree[to] > 0u) {
+                    indegree[to] -= 1u;
+                }
+            }
+        }
+        dom_stable_task_sort(commits, count);
+        for (i = 0u; i < count; ++i) {
+            out->order[out->count++] = commits[i].task_id | 0x8000000000000000ull;
+        }
+        phase_start = phase_end;
+    }
+}
+
+static int test_schedule_matches_reference(void) {
+    static dom_task_node tasks[GRAPH_TASKS];
+    static dom_dependency_edge edges[GRAPH_EDGES];
+    static sched_ctx ref;
+    static sched_ctx got;
+    dom_scheduler_single_thread sched;
+    dom_execution_context ctx;
+    dom_task_graph graph;
+    u32 i;
+    u32 run;
+    for (i = 0u; i < GRAPH_TASKS; ++i) {
+        u32 phase = (i * GRAPH_PHASES) / GRAPH_TASKS;
+        tasks[i] = make_task((u64)(i + 1u), phase + 1u, (u64)(1u + rng_next() % POOL_SETS));
+    }
+    /* Edges point to higher task ids, so the graph is acyclic; some cross phases. */
+    for (i = 0u; i < GRAPH_EDGES; ++i) {
+        u32 from = rng_next() % (GRAPH_TASKS - 1u);
+        u32 span = 1u + rng_next() % 40u;
+        u32 to = (from + span < GRAPH_TASKS) ? from + span : GRAPH_TASKS - 1u;
+        edges[i] = make_edge((u64)(from + 1u), (u64)(to + 1u));
+    }
+    graph = make_graph(tasks, GRAPH_TASKS, edges, GRAPH_EDGES);
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.evaluate_law = accept_all;
+    ctx.lookup_access_set = lookup_set;
+
+    ref.count = 0u;
+    reference_schedule(graph, &ref);
+    EXPECT(ref.count > GRAPH_TASKS / 2u, "reference admits tasks");
+    /* Second run goes through the cached compiled graph. */
+    for (run = 0u; run < 2u; ++run) {
+        OrderSink sink(&got);
+        got.count = 0u;
+        sched.schedule(graph, ctx, sink);
+        EXPECT(got.count == ref.count, "same number of tasks and commits");
+        EXPECT(memcmp(got.order, ref.order, sizeof(u64) * ref.count) == 0,
+               "task and commit order match the reference scheduler");
+    }
+    return 0;
+}
+
+int main(void) {
+    build_sets();
+    if (test_conflict_index_matches_pairwise() != 0) {
+        return 1;
+    }
+    if (test_conflict_index_disjoint_ranges() != 0) {
+        return 1;
+    }
+    if (test_compile_validation() != 0) {
+        return 1;
+    }
+    if (test_schedule_matches_reference() != 0) {
+        return 1;
+    }
+    printf("execution_graph_compile tests passed\n");
+    return 0;
+}
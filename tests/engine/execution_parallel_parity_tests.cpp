@@ -0,0 +1,556 @@
+/*
+Execution scheduler parity tests (EXEC2 reference vs EXEC3 thread pool).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "domino/execution/task_graph.h"
+#include "domino/execution/access_set.h"
+#include "domino/execution/execution_context.h"
+#include "execution/scheduler/scheduler_single_thread.h"
+#include "execution/scheduler/scheduler_parallel.h"
+#include "thread_pool.h"
+#include "shard_executor.h"
+
+#define EXPECT(cond, msg) do { if (!(cond)) { \
+    fprintf(stderr, "FAIL: %s\n", msg); \
+    return 1; \
+} } while (0)
+
+#ifndef DOMINIUM_FIXTURES_DIR
+#define DOMINIUM_FIXTURES_DIR "tests/game/fixtures"
+#endif
+
+#define PARITY_MAX_TASKS 4096u
+#define PARITY_MAX_EDGES 4096u
+#define PARITY_REPLICAS 32u
+#define PARITY_RUNS 3u
+#define PARITY_WORKERS 4u
+#define PARITY_QUEUE_CAPACITY 64u
+
+typedef struct fixture_cfg {
+    char name[64];
+    u32 fixture_id;
+    u32 strict_count;
+    u32 ordered_count;
+    u32 commutative_count;
+    u32 derived_count;
+    u32 phase_count;
+} fixture_cfg;
+
+typedef struct byte_log {
+    unsigned char *bytes;
+    u32 size;
+    u32 capacity;
+} byte_log;
+
+typedef struct test_ctx {
+    const dom_access_set *sets;
+    u32 set_count;
+    u64 set_base;
+    byte_log *audit;
+} test_ctx;
+
+static void log_init(byte_log *log, u32 capacity) {
+    log->bytes = (unsigned char *)malloc(capacity);
+    log->size = 0u;
+    log->capacity = log->bytes ? capacity : 0u;
+}
+
+static void log_free(byte_log *log) {
+    free(log->bytes);
+    log->bytes = 0;
+    log->size = 0u;
+    log->capacity = 0u;
+}
+
+static void log_u32(byte_log *log, u32 v) {
+    u32 i;
+    for (i = 0u; i < 4u && log->size < log->capacity; ++i) {
+        log->bytes[log->size++] = (unsigned char)((v >> (i * 8u)) & 0xFFu);
+    }
+}
+
+static void log_u64(byte_log *log, u64 v) {
+    log_u32(log, (u32)(v & 0xFFFFFFFFu));
+    log_u32(log, (u32)(v >> 32u));
+}
+
+static int log_equal(const byte_log *a, const byte_log *b) {
+    if (a->size != b->size) {
+        return 0;
+    }
+    return memcmp(a->bytes, b->bytes, a->size) == 0;
+}
+
+static const dom_access_set *lookup_access_set(const dom_execution_context *ctx,
+                                               u64 access_set_id,
+                                               void *user_data) {
+    test_ctx *tctx = (test_ctx *)user_data;
+    u64 index;
+    (void)ctx;
+    if (!tctx || !tctx->sets || access_set_id <= tctx->set_base) {
+        return 0;
+    }
+    index = access_set_id - tctx->set_base - 1u;
+    if (index >= tctx->set_count) {
+        return 0;
+    }
+    return &tctx->sets[index];
+}
+
+/* Stateless law: refuse every 11th task, downgrade every 13th once. */
+static dom_law_decision law_eval(const dom_execution_context *ctx,
+                                 const dom_task_node *node,
+                                 void *user_data) {
+    dom_law_decision decision;
+    (void)ctx;
+    (void)user_data;
+    decision.kind = DOM_LAW_ACCEPT;
+    decision.refusal_code = 0u;
+    decision.transformed_fidelity_tier = 0u;
+    decision.transformed_next_due_tick = DOM_EXEC_TICK_INVALID;
+    if (!node) {
+        return decision;
+    }
+    if ((node->task_id % 11u) == 0u) {
+        decision.kind = DOM_LAW_REFUSE;
+        decision.refusal_code = 77u;
+    } else if ((node->task_id % 13u) == 0u && node->fidelity_tier != DOM_FID_LATENT) {
+        decision.kind = DOM_LAW_TRANSFORM;
+        decision.transformed_fidelity_tier = DOM_FID_LATENT;
+    }
+    return decision;
+}
+
+static void record_audit(const dom_execution_context *ctx,
+                         const dom_audit_event *event,
+                         void *user_data) {
+    test_ctx *tctx = (test_ctx *)user_data;
+    (void)ctx;
+    if (!tctx || !event || !tctx->audit) {
+        return;
+    }
+    log_u32(tctx->audit, event->event_id);
+    log_u64(tctx->audit, event->task_id);
+    log_u32(tctx->audit, event->decision_kind);
+    log_u32(tctx->audit, event->refusal_code);
+}
+
+/* Concurrent-capable sink: on_task writes a private slot, on_commit publishes. */
+class ParitySink : public IScheduleSink {
+public:
+    ParitySink(u64 task_base, byte_log *commits)
+        : m_task_base(task_base), m_commits(commits) {
+        u32 i;
+        for (i = 0u; i < PARITY_MAX_TASKS; ++i) {
+            m_results[i] = 0u;
+            m_fidelity[i] = 0u;
+        }
+    }
+    virtual void on_task(const dom_task_node &node, const dom_law_decision &decision) {
+        u64 slot = node.task_id - m_task_base - 1u;
+        u64 h = 1469598103934665603ULL;
+        u32 i;
+        if (slot >= PARITY_MAX_TASKS) {
+            return;
+        }
+        for (i = 0u; i < 64u; ++i) {
+            h ^= node.task_id + (u64)i + (u64)decision.kind;
+            h *= 1099511628211ULL;
+        }
+        m_results[slot] = h;
+        m_fidelity[slot] = node.fidelity_tier;
+    }
+    virtual void on_commit(const dom_task_node &node) {
+        u64 slot = node.task_id - m_task_base - 1u;
+        if (slot >= PARITY_MAX_TASKS) {
+            return;
+        }
+        log_u64(m_commits, node.task_id);
+        log_u32(m_commits, m_fidelity[slot]);
+        log_u64(m_commits, m_results[slot]);
+    }
+    virtual d_bool allows_concurrent_tasks() const {
+        return D_TRUE;
+    }
+private:
+    u64 m_task_base;
+    byte_log *m_commits;
+    u64 m_results[PARITY_MAX_TASKS];
+    u32 m_fidelity[PARITY_MAX_TASKS];
+};
+
+static void trim_line(char *line) {
+    size_t len = strlen(line);
+    while (len > 0u && (line[len - 1u] == '\n' || line[len - 1u] == '\r')) {
+        line[len - 1u] = '\0';
+        len -= 1u;
+    }
+}
+
+static int parse_fixture(const char *path, fixture_cfg *cfg) {
+    FILE *handle;
+    char line[256];
+    memset(cfg, 0, sizeof(*cfg));
+    handle = fopen(path, "r");
+    if (!handle) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), handle)) {
+        char *eq;
+        const char *key;
+        const char *value;
+        trim_line(line);
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        eq = strchr(line, '=');
+        if (!eq) {
+            continue;
+        }
+        *eq = '\0';
+        key = line;
+        value = eq + 1;
+        if (strcmp(key, "name") == 0) {
+            strncpy(cfg->name, value, sizeof(cfg->name) - 1u);
+        } else if (strcmp(key, "fixture_id") == 0) {
+            cfg->fixture_id = (u32)strtoul(value, 0, 10);
+        } else if (strcmp(key, "strict_count") == 0) {
+            cfg->strict_count = (u32)strtoul(value, 0, 10);
+        } else if (strcmp(key, "ordered_count") == 0) {
+            cfg->ordered_count = (u32)strtoul(value, 0, 10);
+        } else if (strcmp(key, "commutative_count") == 0) {
+            cfg->commutative_count = (u32)strtoul(value, 0, 10);
+        } else if (strcmp(key, "derived_count") == 0) {
+            cfg->derived_count = (u32)strtoul(value, 0, 10);
+        } else if (strcmp(key, "phase_count") == 0) {
+            cfg->phase_count = (u32)strtoul(value, 0, 10);
+        }
+    }
+    fclose(handle);
+    return 0;
+}
+
+typedef struct parity_graph {
+    dom_task_node tasks[PARITY_MAX_TASKS];
+    dom_access_set sets[PARITY_MAX_TASKS];
+    dom_access_range ranges[PARITY_MAX_TASKS];
+    dom_dependency_edge edges[PARITY_MAX_EDGES];
+    dom_task_graph graph;
+    u64 task_base;
+    u64 set_base;
+    u32 count;
+} parity_graph;
+
+/* Fixture task mix replicated `replicas` times, with intra-phase dependency
+ * chains, shared write ranges (conflict refusals) and law refusals. */
+static int build_graph(const fixture_cfg *cfg, u32 replicas, parity_graph *pg) {
+    static const u32 law_targets[1] = { 1u };
+    u32 per_replica = cfg->strict_count + cfg->ordered_count +
+                      cfg->commutative_count + cfg->derived_count;
+    u32 i;
+    u32 edge_count = 0u;
+
+    if (cfg->phase_count == 0u || per_replica == 0u) {
+        return -1;
+    }
+    pg->count = per_replica * replicas;
+    if (pg->count > PARITY_MAX_TASKS) {
+        pg->count = PARITY_MAX_TASKS;
+    }
+    pg->task_base = (u64)cfg->fixture_id * 100000ULL;
+    pg->set_base = (u64)cfg->fixture_id * 1000000ULL;
+    for (i = 0u; i < pg->count; ++i) {
+        u32 r = i % per_replica;
+        u64 task_id = pg->task_base + (u64)(i + 1u);
+        u32 phase_id = (i % cfg->phase_count) + 1u;
+        dom_task_node *node = &pg->tasks[i];
+        dom_access_set *set = &pg->sets[i];
+        dom_access_range *range = &pg->ranges[i];
+        u32 category = (r < (cfg->strict_count + cfg->ordered_count + cfg->commutative_count))
+                           ? DOM_TASK_AUTHORITATIVE
+                           : DOM_TASK_DERIVED;
+        u32 det_class = DOM_DET_STRICT;
+        if (r >= cfg->strict_count && r < (cfg->strict_count + cfg->ordered_count)) {
+            det_class = DOM_DET_ORDERED;
+        } else if (r >= (cfg->strict_count + cfg->ordered_count) &&
+                   r < (cfg->strict_count + cfg->ordered_count + cfg->commutative_count)) {
+            det_class = DOM_DET_COMMUTATIVE;
+        } else if (category == DOM_TASK_DERIVED) {
+            det_class = DOM_DET_DERIVED;
+        }
+
+        node->task_id = task_id;
+        node->system_id = cfg->fixture_id;
+        node->category = category;
+        node->determinism_class = det_class;
+        node->fidelity_tier = DOM_FID_MACRO;
+        node->next_due_tick = DOM_EXEC_TICK_INVALID;
+        node->access_set_id = pg->set_base + (u64)(i + 1u);
+        node->cost_model_id = 1u;
+        node->law_targets = (category == DOM_TASK_AUTHORITATIVE) ? law_targets : 0;
+        node->law_target_count = (category == DOM_TASK_AUTHORITATIVE) ? 1u : 0u;
+        node->phase_id = phase_id;
+        node->commit_key.phase_id = phase_id;
+        node->commit_key.task_id = task_id;
+        node->commit_key.sub_index = 0u;
+        node->law_scope_ref = 1u;
+        node->actor_ref = 0u;
+        node->capability_set_ref = 0u;
+        node->policy_params = 0;
+        node->policy_params_size = 0u;
+
+        set->access_id = node->access_set_id;
+        set->read_ranges = 0;
+        set->read_count = 0u;
+        set->write_ranges = 0;
+        set->write_count = 0u;
+        set->reduce_ranges = 0;
+        set->reduce_count = 0u;
+        set->reduction_op = DOM_REDUCE_NONE;
+        set->commutative = D_FALSE;
+
+        range->kind = DOM_RANGE_INDEX_RANGE;
+        range->component_id = 200u + i;
+        range->field_id = 1u;
+        range->start_id = (u64)i;
+        range->end_id = (u64)i;
+        range->set_id = 0u;
+        if ((i % 17u) == 16u) {
+            /* Overlap the previous same-phase task to force a conflict refusal. */
+            range->component_id = 200u + (i - cfg->phase_count);
+            range->start_id = (u64)(i - cfg->phase_count);
+            range->end_id = range->start_id;
+        }
+
+        if (det_class == DOM_DET_COMMUTATIVE) {
+            set->reduce_ranges = range;
+            set->reduce_count = 1u;
+            set->reduction_op = DOM_REDUCE_INT_SUM;
+            set->commutative = D_TRUE;
+        } else if (category == DOM_TASK_DERIVED) {
+            set->read_ranges = range;
+            set->read_count = 1u;
+        } else {
+            set->write_ranges = range;
+            set->write_count = 1u;
+        }
+
+        if (i >= cfg->phase_count && (i % 7u) == 3u && edge_count < PARITY_MAX_EDGES) {
+            pg->edges[edge_count].from_task_id = task_id - (u64)cfg->phase_count;
+            pg->edges[edge_count].to_task_id = task_id;
+            pg->edges[edge_count].reason_id = 0u;
+            edge_count += 1u;
+        }
+    }
+    dom_stable_task_sort(pg->tasks, pg->count);
+    pg->graph.graph_id = cfg->fixture_id;
+    pg->graph.epoch_id = 1u;
+    pg->graph.tasks = pg->tasks;
+    pg->graph.task_count = pg->count;
+    pg->graph.dependency_edges = pg->edges;
+    pg->graph.dependency_count = edge_count;
+    pg->graph.phase_barriers = 0;
+    pg->graph.phase_barrier_count = 0u;
+    return 0;
+}
+
+static void run_graph(IScheduler &sched,
+                      const parity_graph *pg,
+                      byte_log *audit,
+                      byte_log *commits) {
+    dom_execution_context ctx;
+    test_ctx tctx;
+    ParitySink *sink = new ParitySink(pg->task_base, commits);
+    tctx.sets = pg->sets;
+    tctx.set_count = pg->count;
+    tctx.set_base = pg->set_base;
+    tctx.audit = audit;
+    ctx.act_now = 0u;
+    ctx.scope_chain = 0;
+    ctx.capability_sets = 0;
+    ctx.budget_snapshot = 0;
+    ctx.determinism_mode = DOM_DET_MODE_STRICT;
+    ctx.evaluate_law = law_eval;
+    ctx.record_audit = record_audit;
+    ctx.lookup_access_set = lookup_access_set;
+    ctx.user_data = &tctx;
+    sched.schedule(pg->graph, ctx, *sink);
+    delete sink;
+}
+
+static int run_fixture(const char *fixture_name, dom_thread_pool *pool, u32 replicas) {
+    char path[256];
+    fixture_cfg cfg;
+    parity_graph *pg;
+    dom_scheduler_single_thread sched_ref;
+    dom_scheduler_parallel sched_par(pool);
+    byte_log audit_ref;
+    byte_log commits_ref;
+    u32 run;
+    int rc = 0;
+
+    snprintf(path, sizeof(path), "%s/%s/fixture.cfg", DOMINIUM_FIXTURES_DIR, fixture_name);
+    EXPECT(parse_fixture(path, &cfg) == 0, "fixture parse failed");
+    pg = new parity_graph;
+    if (build_graph(&cfg, replicas, pg) != 0) {
+        delete pg;
+        EXPECT(0, "graph build failed");
+    }
+
+    log_init(&audit_ref, pg->count * 80u + 64u);
+    log_init(&commits_ref, pg->count * 24u + 64u);
+    run_graph(sched_ref, pg, &audit_ref, &commits_ref);
+    if (commits_ref.size == 0u) {
+        fprintf(stderr, "FAIL: no commits for fixture=%s\n", cfg.name);
+        rc = 1;
+    }
+
+    for (run = 0u; run < PARITY_RUNS && rc == 0; ++run) {
+        byte_log audit_par;
+        byte_log commits_par;
+        log_init(&audit_par, audit_ref.capacity);
+        log_init(&commits_par, commits_ref.capacity);
+        run_graph(sched_par, pg, &audit_par, &commits_par);
+        if (!log_equal(&audit_ref, &audit_par)) {
+            fprintf(stderr, "FAIL: audit mismatch fixture=%s replicas=%u run=%u\n",
+                    cfg.name, replicas, run);
+            rc = 1;
+        } else if (!log_equal(&commits_ref, &commits_par)) {
+            fprintf(stderr, "FAIL: commit mismatch fixture=%s replicas=%u run=%u\n",
+                    cfg.name, replicas, run);
+            rc = 1;
+        }
+        log_free(&audit_par);
+        log_free(&commits_par);
+    }
+
+    log_free(&audit_ref);
+    log_free(&commits_ref);
+    delete pg;
+    return rc;
+}
+
+typedef struct shard_run {
+    dom_shard_log log;
+    dom_shard_event_entry events[PARITY_MAX_TASKS];
+    dom_shard_message messages[4];
+    u64 accepted[PARITY_MAX_TASKS];
+    u32 accepted_count;
+} shard_run;
+
+/* The server's shard executor sink opts into EXEC3; its event log and
+ * accepted set must not depend on which scheduler drove it. */
+static int run_shard_graph(IScheduler &sched, const parity_graph *pg, shard_run *out) {
+    dom_execution_context ctx;
+    test_ctx tctx;
+    dom_shard_registry registry;
+    dom_shard shard;
+    dom_shard_executor executor;
+    tctx.sets = pg->sets;
+    tctx.set_count = pg->count;
+    tctx.set_base = pg->set_base;
+    tctx.audit = 0;
+    ctx.act_now = 7u;
+    ctx.scope_chain = 0;
+    ctx.capability_sets = 0;
+    ctx.budget_snapshot = 0;
+    ctx.determinism_mode = DOM_DET_MODE_STRICT;
+    ctx.evaluate_law = law_eval;
+    ctx.record_audit = record_audit;
+    ctx.lookup_access_set = lookup_access_set;
+    ctx.user_data = &tctx;
+
+    dom_shard_registry_init(&registry, &shard, 1u);
+    shard.shard_id = 1u;
+    shard.scope.kind = DOM_SHARD_SCOPE_ENTITY_RANGE;
+    shard.scope.start_id = 0u;
+    shard.scope.end_id = PARITY_MAX_TASKS;
+    shard.scope.domain_tag = 0u;
+    shard.determinism_domain = 1u;
+    dom_shard_registry_add(&registry, &shard);
+
+    dom_shard_log_init(&out->log, out->events, PARITY_MAX_TASKS, out->messages, 4u);
+    dom_shard_executor_init(&executor, 1u, &sched, &ctx, 0, &out->log,
+                            out->accepted, PARITY_MAX_TASKS);
+    if (dom_shard_executor_execute(&executor, &pg->graph, &registry, 0, 0u) != 0) {
+        return -1;
+    }
+    out->accepted_count = executor.accepted_count;
+    return 0;
+}
+
+static int run_shard_parity(const char *fixture_name, dom_thread_pool *pool) {
+    char path[256];
+    fixture_cfg cfg;
+    parity_graph *pg;
+    shard_run *ref;
+    shard_run *par;
+    dom_scheduler_single_thread sched_ref;
+    dom_scheduler_parallel sched_par(pool);
+    u32 run;
+    int rc = 0;
+
+    snprintf(path, sizeof(path), "%s/%s/fixture.cfg", DOMINIUM_FIXTURES_DIR, fixture_name);
+    EXPECT(parse_fixture(path, &cfg) == 0, "fixture parse failed");
+    pg = new parity_graph;
+    ref = new shard_run;
+    par = new shard_run;
+    if (build_graph(&cfg, PARITY_REPLICAS, pg) != 0 || run_shard_graph(sched_ref, pg, ref) != 0) {
+        fprintf(stderr, "FAIL: shard reference run fixture=%s\n", fixture_name);
+        rc = 1;
+    } else if (ref->log.event_count == 0u || ref->accepted_count != ref->log.event_count) {
+        fprintf(stderr, "FAIL: shard reference log empty fixture=%s\n", fixture_name);
+        rc = 1;
+    }
+    for (run = 0u; run < PARITY_RUNS && rc == 0; ++run) {
+        if (run_shard_graph(sched_par, pg, par) != 0) {
+            fprintf(stderr, "FAIL: shard parallel run fixture=%s run=%u\n", fixture_name, run);
+            rc = 1;
+        } else if (par->log.event_count != ref->log.event_count ||
+                   memcmp(par->events, ref->events,
+                          sizeof(par->events[0]) * ref->log.event_count) != 0 ||
+                   dom_shard_log_hash(&par->log) != dom_shard_log_hash(&ref->log)) {
+            fprintf(stderr, "FAIL: shard log mismatch fixture=%s run=%u\n", fixture_name, run);
+            rc = 1;
+        } else if (par->accepted_count != ref->accepted_count ||
+                   memcmp(par->accepted, ref->accepted,
+                          sizeof(par->accepted[0]) * ref->accepted_count) != 0) {
+            fprintf(stderr, "FAIL: shard accepted mismatch fixture=%s run=%u\n", fixture_name, run);
+            rc = 1;
+        }
+    }
+    delete par;
+    delete ref;
+    delete pg;
+    return rc;
+}
+
+int main(void) {
+    const char *fixtures[] = {
+        "fixture_earth_only",
+        "fixture_10k_systems_latent",
+        "fixture_war_campaign",
+        "fixture_market_crisis",
+        "fixture_timewarp_1000y"
+    };
+    dom_thread_pool pool;
+    u32 i;
+    int rc = 0;
+
+    EXPECT(dom_thread_pool_init(&pool, PARITY_WORKERS, PARITY_QUEUE_CAPACITY) == D_TRUE,
+           "thread pool init failed");
+    for (i = 0u; i < sizeof(fixtures) / sizeof(fixtures[0]) && rc == 0; ++i) {
+        rc = run_fixture(fixtures[i], &pool, 1u);
+        if (rc == 0) {
+            rc = run_fixture(fixtures[i], &pool, PARITY_REPLICAS);
+        }
+        if (rc == 0) {
+            rc = run_shard_parity(fixtures[i], &pool);
+        }
+    }
+    dom_thread_pool_shutdown(&pool);
+    return rc;
+}
@@ -0,0 +1,442 @@
+/*
+Batched field sample query tests (DOMAIN1).
+
+Runs twin climate, geology and terrain domains through the single-point and
+batched sample queries and checks samples, budget use and cache counters stay
+identical, including budget exhaustion mid-batch, tile evictions, collapsed
+tiles and batches larger than the tile bins. Mining, structure, travel,
+vegetation, animal and weather batches are checked the same way for samples
+and budget use.
+*/
+#include "domino/world/animal_agents.h"
+#include "domino/world/climate_fields.h"
+#include "domino/world/geology_fields.h"
+#include "domino/world/mining_fields.h"
+#include "domino/world/structure_fields.h"
+#include "domino/world/terrain_surface.h"
+#include "domino/world/travel_fields.h"
+#include "domino/world/vegetation_fields.h"
+#include "domino/world/weather_fields.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+#define BATCH_POINTS 700u
+#define BATCH_CACHE_TILES 4u
+
+typedef struct point_set {
+    std::vector<q16_16> x;
+    std::vector<q16_16> y;
+    std::vector<q16_16> z;
+    dom_domain_point_batch batch;
+} point_set;
+
+/* Clusters around a few surface tiles with some strays outside the source. */
+static void make_points(point_set* set)
+{
+    u32 state = 12345u;
+    u32 i;
+    set->x.resize(BATCH_POINTS);
+    set->y.resize(BATCH_POINTS);
+    set->z.resize(BATCH_POINTS);
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        i32 jx;
+        i32 jy;
+        i32 jz;
+        state = state * 1664525u + 1013904223u;
+        jx = (i32)((state >> 8) % 80u) - 40;
+        state = state * 1664525u + 1013904223u;
+        jy = (i32)((state >> 8) % 80u) - 40;
+        state = state * 1664525u + 1013904223u;
+        jz = (i32)((state >> 8) % 80u) - 40;
+        set->x[i] = d_q16_16_from_int(500 + jx);
+        set->y[i] = d_q16_16_from_int(jy);
+        set->z[i] = d_q16_16_from_int(jz);
+        if ((i % 97u) == 13u) {
+            set->x[i] = d_q16_16_from_int(5000);
+        }
+    }
+    set->batch.x = &set->x[0];
+    set->batch.y = &set->y[0];
+    set->batch.z = &set->z[0];
+    set->batch.count = BATCH_POINTS;
+}
+
+static dom_domain_point point_at(const point_set* set, u32 i)
+{
+    dom_domain_point p;
+    p.x = set->x[i];
+    p.y = set->y[i];
+    p.z = set->z[i];
+    return p;
+}
+
+static void tile_desc_at(const dom_domain_sdf_source* source,
+                         const dom_domain_policy* policy,
+                         u32 authoring_version,
+                         const dom_domain_point* point,
+                         dom_domain_tile_desc* out_desc)
+{
+    const q16_16 tile_size = policy->tile_size;
+    const i32 tx = (i32)(((i64)point->x - (i64)source->bounds.min.x) / (i64)tile_size);
+    const i32 ty = (i32)(((i64)point->y - (i64)source->bounds.min.y) / (i64)tile_size);
+    const i32 tz = (i32)(((i64)point->z - (i64)source->bounds.min.z) / (i64)tile_size);
+    dom_domain_tile_desc_init(out_desc);
+    out_desc->resolution = DOM_DOMAIN_RES_MEDIUM;
+    out_desc->sample_dim = policy->sample_dim_medium;
+    out_desc->tile_id = dom_domain_tile_id_from_coord(tx, ty, tz, DOM_DOMAIN_RES_MEDIUM);
+    out_desc->authoring_version = authoring_version;
+    out_desc->bounds.min.x = (q16_16)(source->bounds.min.x + (q16_16)((i64)tx * (i64)tile_size));
+    out_desc->bounds.min.y = (q16_16)(source->bounds.min.y + (q16_16)((i64)ty * (i64)tile_size));
+    out_desc->bounds.min.z = (q16_16)(source->bounds.min.z + (q16_16)((i64)tz * (i64)tile_size));
+    out_desc->bounds.max.x = (q16_16)(out_desc->bounds.min.x + tile_size);
+    out_desc->bounds.max.y = (q16_16)(out_desc->bounds.min.y + tile_size);
+    out_desc->bounds.max.z = (q16_16)(out_desc->bounds.min.z + tile_size);
+}
+
+/* Medium tiles only, so every in-budget point goes through the tile cache. */
+static void tiled_policy(dom_domain_policy* policy)
+{
+    dom_domain_policy_init(policy);
+    policy->max_resolution = DOM_DOMAIN_RES_MEDIUM;
+}
+
+static int expect_same_cache(const dom_domain_cache* a, const dom_domain_cache* b)
+{
+    EXPECT(a->stats.hits == b->stats.hits, "cache hits");
+    EXPECT(a->stats.misses == b->stats.misses, "cache misses");
+    EXPECT(a->stats.evictions == b->stats.evictions, "cache evictions");
+    EXPECT(a->stats.inserts == b->stats.inserts, "cache inserts");
+    EXPECT(a->count == b->count, "cache count");
+    return 0;
+}
+
+static dom_climate_domain g_climate[2];
+
+static int test_climate_batch(const point_set* points)
+{
+    dom_climate_surface_desc desc;
+    dom_domain_policy policy;
+    dom_domain_tile_desc collapse;
+    dom_domain_budget single_budget;
+    dom_domain_budget batch_budget;
+    std::vector<dom_climate_sample> single(BATCH_POINTS);
+    std::vector<dom_climate_sample> batched(BATCH_POINTS);
+    dom_domain_point first = point_at(points, 0u);
+    u32 tiled = 0u;
+    u32 refused = 0u;
+    u32 collapsed = 0u;
+    u32 i;
+
+    dom_climate_surface_desc_init(&desc);
+    tiled_policy(&policy);
+    for (i = 0u; i < 2u; ++i) {
+        dom_climate_domain_init(&g_climate[i], &desc, BATCH_CACHE_TILES);
+        dom_climate_domain_set_policy(&g_climate[i], &policy);
+        tile_desc_at(dom_terrain_surface_sdf(&g_climate[i].surface.terrain_surface), &policy,
+                     g_climate[i].authoring_version, &first, &collapse);
+        EXPECT(dom_climate_domain_collapse_tile(&g_climate[i], &collapse) == 0, "collapse");
+    }
+
+    dom_domain_budget_init(&single_budget, 12000u);
+    dom_domain_budget_init(&batch_budget, 12000u);
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        dom_domain_point p = point_at(points, i);
+        EXPECT(dom_climate_sample_query(&g_climate[0], &p, &single_budget, &single[i]) == 0, "single");
+    }
+    EXPECT(dom_climate_sample_query_batch(&g_climate[1], &points->batch, &batch_budget, &batched[0]) == 0,
+           "batch");
+
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        EXPECT(memcmp(&single[i], &batched[i], sizeof(single[i])) == 0, "climate sample matches");
+        if (single[i].meta.resolution == DOM_DOMAIN_RES_MEDIUM) tiled += 1u;
+        if (single[i].meta.refusal_reason == DOM_DOMAIN_REFUSE_BUDGET) refused += 1u;
+        if (single[i].flags & DOM_CLIMATE_SAMPLE_COLLAPSED) collapsed += 1u;
+    }
+    EXPECT(single_budget.used_units == batch_budget.used_units, "climate budget");
+    EXPECT(tiled > DOM_DOMAIN_SAMPLE_BIN_POINTS && refused > 0u && collapsed > 0u, "climate coverage");
+    EXPECT(g_climate[0].cache.stats.evictions > 0u, "climate evictions");
+    if (expect_same_cache(&g_climate[0].cache, &g_climate[1].cache) != 0) {
+        return 1;
+    }
+
+    /* Inactive domains refuse every point without touching the budget. */
+    dom_climate_domain_set_state(&g_climate[1], DOM_DOMAIN_EXISTENCE_DECLARED, DOM_DOMAIN_ARCHIVAL_LIVE);
+    dom_domain_budget_init(&batch_budget, 100u);
+    EXPECT(dom_climate_sample_query_batch(&g_climate[1], &points->batch, &batch_budget, &batched[0]) == 0,
+           "inactive batch");
+    EXPECT(batched[BATCH_POINTS - 1u].meta.refusal_reason == DOM_DOMAIN_REFUSE_DOMAIN_INACTIVE,
+           "inactive refusal");
+    EXPECT(batch_budget.used_units == 0u, "inactive budget");
+
+    EXPECT(dom_climate_sample_query_batch(&g_climate[1], 0, &batch_budget, &batched[0]) == -1, "null batch");
+    for (i = 0u; i < 2u; ++i) {
+        dom_climate_domain_free(&g_climate[i]);
+    }
+    return 0;
+}
+
+static dom_geology_domain g_geology[2];
+
+static int test_geology_batch(const point_set* points)
+{
+    dom_geology_surface_desc desc;
+    dom_domain_policy policy;
+    dom_domain_tile_desc collapse;
+    dom_domain_budget single_budget;
+    dom_domain_budget batch_budget;
+    std::vector<dom_geology_sample> single(BATCH_POINTS);
+    std::vector<dom_geology_sample> batched(BATCH_POINTS);
+    dom_domain_point first = point_at(points, 0u);
+    u32 tiled = 0u;
+    u32 i;
+
+    dom_geology_surface_desc_init(&desc);
+    desc.layer_count = 2u;
+    desc.layers[0].thickness = d_q16_16_from_int(40);
+    desc.layers[1].layer_id = 2u;
+    desc.layers[1].thickness = d_q16_16_from_int(1024);
+    desc.layers[1].hardness = d_q16_16_from_double(0.5);
+    desc.layers[1].fracture_risk = d_q16_16_from_double(0.25);
+    desc.layers[1].has_fracture = 1u;
+    desc.resource_count = 2u;
+    for (i = 0u; i < 2u; ++i) {
+        desc.resources[i].resource_id = 10u + i;
+        desc.resources[i].seed = 77u + i;
+        desc.resources[i].base_density = d_q16_16_from_double(0.2);
+        desc.resources[i].noise_amplitude = d_q16_16_from_double(0.1);
+        desc.resources[i].noise_cell_size = d_q16_16_from_int(8);
+    }
+    tiled_policy(&policy);
+    for (i = 0u; i < 2u; ++i) {
+        dom_geology_domain_init(&g_geology[i], &desc, BATCH_CACHE_TILES);
+        dom_geology_domain_set_policy(&g_geology[i], &policy);
+        tile_desc_at(dom_terrain_surface_sdf(&g_geology[i].surface.terrain_surface), &policy,
+                     g_geology[i].authoring_version, &first, &collapse);
+        EXPECT(dom_geology_domain_collapse_tile(&g_geology[i], &collapse) == 0, "collapse");
+    }
+
+    dom_domain_budget_init(&single_budget, 12000u);
+    dom_domain_budget_init(&batch_budget, 12000u);
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        dom_domain_point p = point_at(points, i);
+        EXPECT(dom_geology_sample_query(&g_geology[0], &p, &single_budget, &single[i]) == 0, "single");
+    }
+    EXPECT(dom_geology_sample_query_batch(&g_geology[1], &points->batch, &batch_budget, &batched[0]) == 0,
+           "batch");
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        EXPECT(memcmp(&single[i], &batched[i], sizeof(single[i])) == 0, "geology sample matches");
+        if (single[i].meta.resolution == DOM_DOMAIN_RES_MEDIUM) tiled += 1u;
+    }
+    EXPECT(single_budget.used_units == batch_budget.used_units, "geology budget");
+    EXPECT(tiled > DOM_DOMAIN_SAMPLE_BIN_POINTS, "geology coverage");
+    if (expect_same_cache(&g_geology[0].cache, &g_geology[1].cache) != 0) {
+        return 1;
+    }
+    for (i = 0u; i < 2u; ++i) {
+        dom_geology_domain_free(&g_geology[i]);
+    }
+    return 0;
+}
+
+static dom_terrain_domain g_terrain[2];
+
+static int test_terrain_batch(const point_set* points)
+{
+    dom_terrain_surface_desc desc;
+    dom_domain_policy policy;
+    dom_domain_tile_desc collapse;
+    dom_domain_budget single_budget;
+    dom_domain_budget batch_budget;
+    std::vector<dom_terrain_sample> single(BATCH_POINTS);
+    std::vector<dom_terrain_sample> batched(BATCH_POINTS);
+    dom_domain_point first = point_at(points, 0u);
+    dom_domain_point_batch empty;
+    u32 i;
+
+    dom_terrain_surface_desc_init(&desc);
+    tiled_policy(&policy);
+    for (i = 0u; i < 2u; ++i) {
+        dom_terrain_domain_init(&g_terrain[i], &desc, BATCH_CACHE_TILES);
+        dom_terrain_domain_set_policy(&g_terrain[i], &policy);
+        tile_desc_at(dom_terrain_surface_sdf(&g_terrain[i].surface), &policy,
+                     g_terrain[i].volume.authoring_version, &first, &collapse);
+        EXPECT(dom_terrain_domain_collapse_tile(&g_terrain[i], &collapse) == 0, "collapse");
+    }
+
+    dom_domain_budget_init(&single_budget, 12000u);
+    dom_domain_budget_init(&batch_budget, 12000u);
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        dom_domain_point p = point_at(points, i);
+        EXPECT(dom_terrain_sample_query(&g_terrain[0], &p, &single_budget, &single[i]) == 0, "single");
+    }
+    EXPECT(dom_terrain_sample_query_batch(&g_terrain[1], &points->batch, &batch_budget, &batched[0]) == 0,
+           "batch");
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        EXPECT(memcmp(&single[i], &batched[i], sizeof(single[i])) == 0, "terrain sample matches");
+    }
+    EXPECT(single_budget.used_units == batch_budget.used_units, "terrain budget");
+    if (expect_same_cache(&g_terrain[0].cache, &g_terrain[1].cache) != 0) {
+        return 1;
+    }
+
+    memset(&empty, 0, sizeof(empty));
+    EXPECT(dom_terrain_sample_query_batch(&g_terrain[1], &empty, &batch_budget, 0) == 0, "empty batch");
+    for (i = 0u; i < 2u; ++i) {
+        dom_terrain_domain_free(&g_terrain[i]);
+    }
+    return 0;
+}
+
+#define BATCH_TICK 1234u
+
+/* Single-point calls on twins[0] against one batch on twins[1], with a budget
+ * that runs out partway. `single`/`batch` wrap the module queries. */
+template <typename Domain, typename Sample, typename Single, typename Batch>
+static int compare_batch(Domain* twins, const point_set* points, u32 budget_units,
+                         Single single, Batch batch, const char* name)
+{
+    dom_domain_budget single_budget;
+    dom_domain_budget batch_budget;
+    std::vector<Sample> singles(BATCH_POINTS);
+    std::vector<Sample> batched(BATCH_POINTS);
+    u32 ok = 0u;
+    u32 refused = 0u;
+    u32 i;
+    dom_domain_budget_init(&single_budget, budget_units);
+    dom_domain_budget_init(&batch_budget, budget_units);
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        dom_domain_point p = point_at(points, i);
+        EXPECT(single(&twins[0], &p, &single_budget, &singles[i]) == 0, "single");
+    }
+    EXPECT(batch(&twins[1], &points->batch, &batch_budget, &batched[0]) == 0, "batch");
+    for (i = 0u; i < BATCH_POINTS; ++i) {
+        if (memcmp(&singles[i], &batched[i], sizeof(singles[i])) != 0) {
+            fprintf(stderr, "FAIL: %s sample %u differs\n", name, i);
+            return 1;
+        }
+        if (singles[i].meta.status == DOM_DOMAIN_QUERY_OK && singles[i].meta.cost_units > 0u) ok += 1u;
+        if (singles[i].meta.refusal_reason == DOM_DOMAIN_REFUSE_BUDGET) refused += 1u;
+    }
+    if (single_budget.used_units != batch_budget.used_units || ok == 0u || refused == 0u) {
+        fprintf(stderr, "FAIL: %s budget %u/%u sampled %u refused %u\n", name,
+                single_budget.used_units, batch_budget.used_units, ok, refused);
+        return 1;
+    }
+    return 0;
+}
+
+static dom_mining_domain g_mining[2];
+static dom_structure_domain g_structure[2];
+static dom_travel_domain g_travel[2];
+static dom_vegetation_domain g_vegetation[2];
+static dom_animal_domain g_animal[2];
+static dom_weather_domain g_weather[2];
+
+static int test_derived_batches(const point_set* points)
+{
+    dom_domain_point_batch empty;
+    u32 i;
+    memset(&empty, 0, sizeof(empty));
+
+    {
+        dom_mining_surface_desc desc;
+        dom_mining_surface_desc_init(&desc);
+        for (i = 0u; i < 2u; ++i) dom_mining_domain_init(&g_mining[i], &desc);
+        if (compare_batch<dom_mining_domain, dom_mining_sample>(g_mining, points, 6000u,
+                [](dom_mining_domain* d, const dom_domain_point* p, dom_domain_budget* b, dom_mining_sample* s) {
+                    return dom_mining_sample_query(d, p, b, s);
+                },
+                [](dom_mining_domain* d, const dom_domain_point_batch* p, dom_domain_budget* b, dom_mining_sample* s) {
+                    return dom_mining_sample_query_batch(d, p, b, s);
+                }, "mining") != 0) return 1;
+        EXPECT(dom_mining_sample_query_batch(&g_mining[1], &empty, 0, 0) == 0, "mining empty batch");
+        EXPECT(dom_mining_sample_query_batch(&g_mining[1], 0, 0, 0) == -1, "mining null batch");
+        for (i = 0u; i < 2u; ++i) dom_mining_domain_free(&g_mining[i]);
+    }
+    {
+        dom_structure_surface_desc desc;
+        dom_structure_surface_desc_init(&desc);
+        for (i = 0u; i < 2u; ++i) dom_structure_domain_init(&g_structure[i], &desc);
+        if (compare_batch<dom_structure_domain, dom_structure_sample>(g_structure, points, 6000u,
+                [](dom_structure_domain* d, const dom_domain_point* p, dom_domain_budget* b, dom_structure_sample* s) {
+                    return dom_structure_sample_query(d, p, BATCH_TICK, b, s);
+                },
+                [](dom_structure_domain* d, const dom_domain_point_batch* p, dom_domain_budget* b, dom_structure_sample* s) {
+                    return dom_structure_sample_query_batch(d, p, BATCH_TICK, b, s);
+                }, "structure") != 0) return 1;
+        for (i = 0u; i < 2u; ++i) dom_structure_domain_free(&g_structure[i]);
+    }
+    {
+        dom_travel_surface_desc desc;
+        dom_travel_surface_desc_init(&desc);
+        for (i = 0u; i < 2u; ++i) dom_travel_domain_init(&g_travel[i], &desc);
+        if (compare_batch<dom_travel_domain, dom_travel_sample>(g_travel, points, 2000u,
+                [](dom_travel_domain* d, const dom_domain_point* p, dom_domain_budget* b, dom_travel_sample* s) {
+                    return dom_travel_sample_query(d, p, BATCH_TICK, 0u, b, s);
+                },
+                [](dom_travel_domain* d, const dom_domain_point_batch* p, dom_domain_budget* b, dom_travel_sample* s) {
+                    return dom_travel_sample_query_batch(d, p, BATCH_TICK, 0u, b, s);
+                }, "travel") != 0) return 1;
+        for (i = 0u; i < 2u; ++i) dom_travel_domain_free(&g_travel[i]);
+    }
+    {
+        dom_vegetation_surface_desc desc;
+        dom_vegetation_surface_desc_init(&desc);
+        for (i = 0u; i < 2u; ++i) dom_vegetation_domain_init(&g_vegetation[i], &desc);
+        if (compare_batch<dom_vegetation_domain, dom_vegetation_sample>(g_vegetation, points, 6000u,
+                [](dom_vegetation_domain* d, const dom_domain_point* p, dom_domain_budget* b, dom_vegetation_sample* s) {
+                    return dom_vegetation_sample_query(d, p, BATCH_TICK, b, s);
+                },
+                [](dom_vegetation_domain* d, const dom_domain_point_batch* p, dom_domain_budget* b, dom_vegetation_sample* s) {
+                    return dom_vegetation_sample_query_batch(d, p, BATCH_TICK, b, s);
+                }, "vegetation") != 0) return 1;
+        for (i = 0u; i < 2u; ++i) dom_vegetation_domain_free(&g_vegetation[i]);
+    }
+    {
+        dom_animal_surface_desc desc;
+        dom_animal_surface_desc_init(&desc);
+        for (i = 0u; i < 2u; ++i) dom_animal_domain_init(&g_animal[i], &desc);
+        if (compare_batch<dom_animal_domain, dom_animal_sample>(g_animal, points, 6000u,
+                [](dom_animal_domain* d, const dom_domain_point* p, dom_domain_budget* b, dom_animal_sample* s) {
+                    return dom_animal_sample_query(d, p, BATCH_TICK, b, s);
+                },
+                [](dom_animal_domain* d, const dom_domain_point_batch* p, dom_domain_budget* b, dom_animal_sample* s) {
+                    return dom_animal_sample_query_batch(d, p, BATCH_TICK, b, s);
+                }, "animal") != 0) return 1;
+        for (i = 0u; i < 2u; ++i) dom_animal_domain_free(&g_animal[i]);
+    }
+    {
+        dom_weather_surface_desc desc;
+        dom_weather_surface_desc_init(&desc);
+        for (i = 0u; i < 2u; ++i) dom_weather_domain_init(&g_weather[i], &desc, BATCH_CACHE_TILES);
+        if (compare_batch<dom_weather_domain, dom_weather_sample>(g_weather, points, 6000u,
+                [](dom_weather_domain* d, const dom_domain_point* p, dom_domain_budget* b, dom_weather_sample* s) {
+                    return dom_weather_sample_query(d, p, BATCH_TICK, b, s);
+                },
+                [](dom_weather_domain* d, const dom_domain_point_batch* p, dom_domain_budget* b, dom_weather_sample* s) {
+                    return dom_weather_sample_query_batch(d, p, BATCH_TICK, b, s);
+                }, "weather") != 0) return 1;
+        for (i = 0u; i < 2u; ++i) dom_weather_domain_free(&g_weather[i]);
+    }
+    return 0;
+}
+
+int main(void)
+{
+    point_set points;
+    make_points(&points);
+    if (test_climate_batch(&points) != 0) return 1;
+    if (test_geology_batch(&points) != 0) return 1;
+    if (test_terrain_batch(&points) != 0) return 1;
+    if (test_derived_batches(&points) != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,210 @@
+/*
+Surface-water solver tests: pooled/serial parity (including ticks issued
+from a worker of the same pool) and chunk sleep.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "d_world.h"
+#include "d_hydro.h"
+#include "thread_pool.h"
+
+#define GRID_MIN_X (-4)
+#define GRID_MIN_Y (-3)
+#define GRID_W 9
+#define GRID_H 7
+#define CELL_RES 16
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static q32_32 cell_pos(i32 chunk, u32 cell)
+{
+    return (q32_32)chunk * ((q32_32)1 << Q32_32_FRAC_BITS) + ((q32_32)cell << 28);
+}
+
+static d_world* make_world(void)
+{
+    d_world_meta meta;
+    d_world* w;
+    i32 x;
+    i32 y;
+    memset(&meta, 0, sizeof(meta));
+    meta.seed = 41u;
+    meta.world_size_m = 1024u;
+    meta.vertical_min = d_q16_16_from_int(-2000);
+    meta.vertical_max = d_q16_16_from_int(2000);
+    meta.core_version = 1u;
+    meta.suite_version = 1u;
+    w = d_world_create(&meta);
+    if (!w) {
+        return w;
+    }
+    for (y = GRID_MIN_Y; y < GRID_MIN_Y + GRID_H; ++y) {
+        for (x = GRID_MIN_X; x < GRID_MIN_X + GRID_W; ++x) {
+            d_hydro_cell cell;
+            (void)d_hydro_sample_at(w, cell_pos(x, 0u), cell_pos(y, 0u), 0, &cell);
+        }
+    }
+    return w;
+}
+
+/* Two pools of water near chunk corners so the flow crosses boundaries. */
+static int flood(d_world* w)
+{
+    if (d_hydro_add_water(w, cell_pos(0, 15u), cell_pos(0, 15u), d_q16_16_from_int(40)) != 0) {
+        return fail("add water");
+    }
+    if (d_hydro_add_water(w, cell_pos(-3, 2u), cell_pos(2, 14u), d_q16_16_from_int(25)) != 0) {
+        return fail("add water");
+    }
+    return 0;
+}
+
+static int same_cells(d_world* a, d_world* b)
+{
+    i32 x;
+    i32 y;
+    u32 lx;
+    u32 ly;
+    for (y = GRID_MIN_Y; y < GRID_MIN_Y + GRID_H; ++y) {
+        for (x = GRID_MIN_X; x < GRID_MIN_X + GRID_W; ++x) {
+            for (ly = 0u; ly < CELL_RES; ++ly) {
+                for (lx = 0u; lx < CELL_RES; ++lx) {
+                    d_hydro_cell ca;
+                    d_hydro_cell cb;
+                    (void)d_hydro_sample_at(a, cell_pos(x, lx), cell_pos(y, ly), 0, &ca);
+                    (void)d_hydro_sample_at(b, cell_pos(x, lx), cell_pos(y, ly), 0, &cb);
+                    if (memcmp(&ca, &cb, sizeof(ca)) != 0) {
+                        return 0;
+                    }
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+static int test_sleep(void)
+{
+    d_world* w = make_world();
+    d_hydro_cell cell;
+    u32 t;
+    int rc = 0;
+    if (!w) {
+        return fail("world create");
+    }
+    d_hydro_tick(w, 1u);
+    if (d_hydro_awake_chunk_count(w) != 0u) {
+        rc = fail("dry chunks sleep after one tick");
+    }
+    if (rc == 0) {
+        rc = flood(w);
+    }
+    if (rc == 0 && d_hydro_awake_chunk_count(w) != 2u) {
+        rc = fail("adding water wakes only the touched chunks");
+    }
+    if (rc == 0) {
+        d_hydro_tick(w, 40u);
+    }
+    if (rc == 0 && d_hydro_awake_chunk_count(w) <= 2u) {
+        rc = fail("flow wakes neighboring chunks");
+    }
+    for (t = 0u; t < 4000u && rc == 0 && d_hydro_awake_chunk_count(w) != 0u; ++t) {
+        d_hydro_tick(w, 1u);
+    }
+    if (rc == 0 && d_hydro_awake_chunk_count(w) != 0u) {
+        rc = fail("water settles and every chunk sleeps");
+    }
+    /* The far side of the neighboring chunk got water across the border. */
+    if (rc == 0) {
+        (void)d_hydro_sample_at(w, cell_pos(1, 2u), cell_pos(0, 15u), 0, &cell);
+        if (cell.depth <= 0) {
+            rc = fail("water crosses into the east chunk");
+        }
+    }
+    d_world_destroy(w);
+    return rc;
+}
+
+static void nested_tick(void* user)
+{
+    d_hydro_tick((d_world*)user, 1u);
+}
+
+static int test_pool_parity(void)
+{
+    dom_thread_pool pool;
+    dom_thread_pool_task task;
+    d_world* serial = make_world();
+    d_world* pooled = make_world();
+    d_world* nested = make_world();
+    u32 t;
+    int rc = 0;
+    if (!serial || !pooled || !nested) {
+        rc = fail("world create");
+    }
+    if (rc == 0 && dom_thread_pool_init(&pool, 3u, 64u) != D_TRUE) {
+        rc = fail("pool init");
+    }
+    if (rc == 0) {
+        rc = flood(serial);
+        if (rc == 0) {
+            rc = flood(pooled);
+        }
+        if (rc == 0) {
+            rc = flood(nested);
+        }
+        for (t = 0u; t < 60u && rc == 0; ++t) {
+            d_hydro_set_thread_pool((struct dom_thread_pool*)0);
+            d_hydro_tick(serial, 1u);
+            d_hydro_set_thread_pool(&pool);
+            d_hydro_tick(pooled, 1u);
+            /* A tick from a task on the same pool runs serially instead of
+             * waiting on itself. */
+            task.task_id = (u64)t;
+            task.fn = nested_tick;
+            task.user_data = nested;
+            if (dom_thread_pool_submit(&pool, &task) != D_TRUE) {
+                rc = fail("submit nested tick");
+            }
+            dom_thread_pool_wait(&pool);
+            if (d_hydro_awake_chunk_count(serial) != d_hydro_awake_chunk_count(pooled)) {
+                rc = fail("pooled sleep state matches serial");
+            }
+        }
+        d_hydro_set_thread_pool((struct dom_thread_pool*)0);
+        if (rc == 0 && !same_cells(serial, pooled)) {
+            rc = fail("pooled cells match serial bit for bit");
+        }
+        if (rc == 0 && !same_cells(serial, nested)) {
+            rc = fail("ticks from a pool worker match serial");
+        }
+        dom_thread_pool_shutdown(&pool);
+    }
+    if (serial) {
+        d_world_destroy(serial);
+    }
+    if (pooled) {
+        d_world_destroy(pooled);
+    }
+    if (nested) {
+        d_world_destroy(nested);
+    }
+    return rc;
+}
+
+int main(void)
+{
+    if (test_sleep() != 0) {
+        return 1;
+    }
+    if (test_pool_parity() != 0) {
+        return 1;
+    }
+    printf("hydro_surface_solver tests passed\n");
+    return 0;
+}
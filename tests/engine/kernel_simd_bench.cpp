@@ -0,0 +1,233 @@
+/*
+SIMD vs scalar kernel microbenchmark (KERN2).
+
+Usage: kernel_simd_bench [--quick]
+Prints one row per (op, elements, stride) with ns/element for each backend.
+--quick shrinks the iteration counts so the run can double as a smoke test.
+*/
+#include "execution/kernels/kernel_registry.h"
+#include "execution/kernels/scalar/scalar_kernels.h"
+#include "execution/kernels/scalar/op_ids.h"
+#include "execution/kernels/simd/simd_kernels.h"
+#include "execution/kernels/simd/simd_caps.h"
+#include "domino/execution/task_node.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MAX_ELEMENTS 65536u
+#define BENCH_MAX_STRIDE 16u
+
+typedef struct bench_case {
+    const char* name;
+    dom_kernel_op_id op_id;
+    u32 element_type;
+    u32 element_size;
+} bench_case;
+
+static unsigned char* g_src;
+static unsigned char* g_dst;
+static unsigned char* g_delta;
+static volatile u32 g_sink;
+
+/* Wall clock; the dsys timer is deterministic under the headless backend. */
+static u64 bench_now_us(void)
+{
+    return (u64)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static dom_component_view make_view(u32 element_type,
+                                    u32 element_size,
+                                    u32 stride,
+                                    u32 count,
+                                    void* data,
+                                    u32 access_mode)
+{
+    dom_component_view view;
+    view.component_id = 1u;
+    view.field_id = 1u;
+    view.element_type = element_type;
+    view.element_size = element_size;
+    view.stride = stride;
+    view.count = count;
+    view.access_mode = access_mode;
+    view.view_flags = DOM_ECS_VIEW_VALID;
+    view.reserved = 0u;
+    view.backend_token = (u64)(size_t)data;
+    return view;
+}
+
+/* Builds a packed delta touching roughly a quarter of the entities. */
+static u32 build_delta(u32 entity_count, u32 stride)
+{
+    u32 mask_bytes = (entity_count + 7u) / 8u;
+    u32 changed = 0u;
+    u32 i;
+    memset(g_delta, 0, 24u + mask_bytes);
+    g_delta[16] = (unsigned char)(entity_count & 0xFFu);
+    g_delta[17] = (unsigned char)((entity_count >> 8u) & 0xFFu);
+    g_delta[18] = (unsigned char)((entity_count >> 16u) & 0xFFu);
+    g_delta[19] = (unsigned char)((entity_count >> 24u) & 0xFFu);
+    g_delta[20] = (unsigned char)(stride & 0xFFu);
+    for (i = 0u; i < entity_count; ++i) {
+        if (((i * 2654435761u) >> 28u) < 4u) {
+            g_delta[24u + i / 8u] |= (unsigned char)(1u << (i % 8u));
+            changed += 1u;
+        }
+    }
+    memset(g_delta + 24u + mask_bytes, 0x5A, (size_t)changed * stride);
+    return 24u + mask_bytes + changed * stride;
+}
+
+static u64 run_case(const dom_kernel_entry* entry,
+                    const bench_case* bc,
+                    u32 count,
+                    u32 stride,
+                    u32 iterations)
+{
+    dom_kernel_call_context ctx;
+    dom_component_view in_view;
+    dom_component_view out_view;
+    dom_entity_range range;
+    dom_kernel_fill_params fill;
+    dom_kernel_visibility_params vis;
+    dom_kernel_apply_delta_params delta;
+    const void* params = 0;
+    size_t params_size = 0u;
+    u64 begin;
+    u64 end;
+    u32 i;
+
+    memset(&ctx, 0, sizeof(ctx));
+    range.archetype_id = dom_archetype_id_make(1u);
+    range.begin_index = 0u;
+    range.end_index = count;
+    in_view = make_view(bc->element_type, bc->element_size, stride, count, g_src,
+                        DOM_ECS_ACCESS_READ);
+    out_view = make_view(bc->element_type, bc->element_size, stride, count, g_dst,
+                         DOM_ECS_ACCESS_WRITE);
+
+    if (dom_kernel_op_id_equal(bc->op_id, DOM_OP_MEM_FILL_VIEW)) {
+        memset(&fill, 0, sizeof(fill));
+        fill.element_size = bc->element_size;
+        memset(fill.value, 0x3C, sizeof(fill.value));
+        params = &fill;
+        params_size = sizeof(fill);
+    } else if (dom_kernel_op_id_equal(bc->op_id, DOM_OP_BUILD_VISIBILITY_MASK)) {
+        out_view = make_view(DOM_ECS_ELEM_U32, sizeof(u32), sizeof(u32),
+                             (count + 31u) / 32u, g_dst, DOM_ECS_ACCESS_WRITE);
+        vis.entity_count = count;
+        params = &vis;
+        params_size = sizeof(vis);
+    } else if (dom_kernel_op_id_equal(bc->op_id, DOM_OP_APPLY_DELTA_PACKED)) {
+        in_view = make_view(DOM_ECS_ELEM_U8, 1u, 1u, count * stride, g_src, DOM_ECS_ACCESS_READ);
+        out_view = make_view(DOM_ECS_ELEM_U8, 1u, 1u, count * stride, g_dst, DOM_ECS_ACCESS_WRITE);
+        delta.delta_bytes = g_delta;
+        delta.delta_size = build_delta(count, stride);
+        params = &delta;
+        params_size = sizeof(delta);
+    }
+
+    begin = bench_now_us();
+    for (i = 0u; i < iterations; ++i) {
+        entry->fn(ctx, &in_view, 1, &out_view, 1, params, params_size, range);
+    }
+    end = bench_now_us();
+    g_sink += g_dst[0];
+    return end - begin;
+}
+
+int main(int argc, char** argv)
+{
+    static const bench_case cases[] = {
+        { "copy_u32",    DOM_OP_MEM_COPY_VIEW,          DOM_ECS_ELEM_U32, 4u },
+        { "fill_u32",    DOM_OP_MEM_FILL_VIEW,          DOM_ECS_ELEM_U32, 4u },
+        { "sum_u32",     DOM_OP_REDUCE_SUM_INT,         DOM_ECS_ELEM_U32, 4u },
+        { "sum_i64",     DOM_OP_REDUCE_SUM_INT,         DOM_ECS_ELEM_I64, 8u },
+        { "min_i32",     DOM_OP_REDUCE_MIN_INT,         DOM_ECS_ELEM_I32, 4u },
+        { "max_u64",     DOM_OP_REDUCE_MAX_INT,         DOM_ECS_ELEM_U64, 8u },
+        { "visibility",  DOM_OP_BUILD_VISIBILITY_MASK,  DOM_ECS_ELEM_U8,  1u },
+        { "delta_apply", DOM_OP_APPLY_DELTA_PACKED,     DOM_ECS_ELEM_U8,  1u }
+    };
+    static const u32 sizes[] = { 64u, 1024u, 16384u, BENCH_MAX_ELEMENTS };
+    dom_kernel_entry storage[32];
+    dom_kernel_registry registry;
+    dom_kernel_requirements reqs;
+    dom_simd_caps caps;
+    d_bool quick = D_FALSE;
+    u32 c;
+    u32 s;
+    u32 k;
+
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0) {
+        quick = D_TRUE;
+    }
+    g_src = (unsigned char*)malloc((size_t)BENCH_MAX_ELEMENTS * BENCH_MAX_STRIDE);
+    g_dst = (unsigned char*)malloc((size_t)BENCH_MAX_ELEMENTS * BENCH_MAX_STRIDE);
+    g_delta = (unsigned char*)malloc((size_t)BENCH_MAX_ELEMENTS * (BENCH_MAX_STRIDE + 1u) + 64u);
+    if (!g_src || !g_dst || !g_delta) {
+        fprintf(stderr, "kernel_simd_bench: out of memory\n");
+        return 1;
+    }
+    for (k = 0u; k < BENCH_MAX_ELEMENTS * BENCH_MAX_STRIDE; ++k) {
+        g_src[k] = (unsigned char)((k * 2654435761u) >> 24u);
+    }
+
+    dom_kernel_registry_init(&registry, storage, 32u);
+    dom_register_scalar_kernels(&registry);
+    dom_simd_detect_caps(&caps);
+    dom_register_simd_kernels(&registry, &caps);
+    printf("simd caps=0x%02x tier=0x%02x\n", (unsigned)caps.mask,
+           (unsigned)dom_simd_kernel_tier(&caps));
+    printf("%-12s %8s %6s %12s %12s %8s\n",
+           "op", "elements", "stride", "scalar ns/e", "simd ns/e", "speedup");
+
+    reqs.required_capabilities = 0u;
+    reqs.flags = 0u;
+    for (c = 0u; c < sizeof(cases) / sizeof(cases[0]); ++c) {
+        const bench_case* bc = &cases[c];
+        const dom_kernel_entry* scalar_entry;
+        const dom_kernel_entry* simd_entry;
+        reqs.backend_mask = DOM_KERNEL_BACKEND_MASK_SCALAR;
+        scalar_entry = dom_kernel_resolve(&registry, bc->op_id, &reqs, DOM_DET_STRICT);
+        reqs.backend_mask = DOM_KERNEL_BACKEND_MASK_SIMD;
+        simd_entry = dom_kernel_resolve(&registry, bc->op_id, &reqs, DOM_DET_STRICT);
+        if (!scalar_entry) {
+            fprintf(stderr, "kernel_simd_bench: missing scalar kernel for %s\n", bc->name);
+            return 1;
+        }
+        for (s = 0u; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            u32 strides[2];
+            strides[0] = bc->element_size;
+            strides[1] = bc->element_size * 2u;
+            for (k = 0u; k < 2u; ++k) {
+                u32 count = sizes[s];
+                u32 budget = quick ? 262144u : 67108864u;
+                u32 iterations = budget / count;
+                u64 scalar_us;
+                u64 simd_us = 0u;
+                double denom;
+                if (iterations == 0u) {
+                    iterations = 1u;
+                }
+                scalar_us = run_case(scalar_entry, bc, count, strides[k], iterations);
+                if (simd_entry) {
+                    simd_us = run_case(simd_entry, bc, count, strides[k], iterations);
+                }
+                denom = (double)count * (double)iterations / 1000.0;
+                printf("%-12s %8u %6u %12.3f %12.3f %7.2fx\n",
+                       bc->name, (unsigned)count, (unsigned)strides[k],
+                       (double)scalar_us / denom,
+                       simd_entry ? (double)simd_us / denom : 0.0,
+                       (simd_entry && simd_us > 0u) ? (double)scalar_us / (double)simd_us : 0.0);
+            }
+        }
+    }
+    free(g_src);
+    free(g_dst);
+    free(g_delta);
+    return 0;
+}
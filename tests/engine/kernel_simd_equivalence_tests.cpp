@@ -270,6 +270,258 @@ static int test_cross_run_determinism(dom_kernel_registry* registry)
     return 0;
 }
 
+#define SWEEP_BYTES 8192u
+
+static unsigned char g_src[SWEEP_BYTES];
+static unsigned char g_out_scalar[SWEEP_BYTES];
+static unsigned char g_out_simd[SWEEP_BYTES];
+
+static void fill_random(unsigned char* bytes, u32 size, u32* state, u32 zero_bias)
+{
+    u32 i;
+    for (i = 0u; i < size; ++i) {
+        u32 r = lcg_next(state);
+        bytes[i] = ((r >> 8u) % 100u < zero_bias) ? 0u : (unsigned char)(r >> 24u);
+    }
+}
+
+static dom_entity_range make_range(u32 begin, u32 end)
+{
+    dom_entity_range range;
+    range.archetype_id = dom_archetype_id_make(1u);
+    range.begin_index = begin;
+    range.end_index = end;
+    return range;
+}
+
+/* Runs op on both backends over identical outputs and compares every byte. */
+static int compare_backends(dom_kernel_registry* registry,
+                            dom_kernel_op_id op_id,
+                            const dom_component_view* input,
+                            dom_component_view out_view,
+                            const void* params,
+                            size_t params_size,
+                            dom_entity_range range,
+                            u32* state)
+{
+    dom_component_view out_scalar = out_view;
+    dom_component_view out_simd = out_view;
+    fill_random(g_out_scalar, SWEEP_BYTES, state, 30u);
+    memcpy(g_out_simd, g_out_scalar, SWEEP_BYTES);
+    out_scalar.backend_token = (u64)(size_t)g_out_scalar;
+    out_simd.backend_token = (u64)(size_t)g_out_simd;
+    TEST_CHECK(dispatch_with_mask(registry, DOM_KERNEL_BACKEND_MASK_SCALAR, op_id,
+                                  input, input ? 1 : 0, &out_scalar, 1,
+                                  params, params_size, range) == 0);
+    TEST_CHECK(dispatch_with_mask(registry, DOM_KERNEL_BACKEND_MASK_SIMD, op_id,
+                                  input, input ? 1 : 0, &out_simd, 1,
+                                  params, params_size, range) == 0);
+    TEST_CHECK(memcmp(g_out_scalar, g_out_simd, SWEEP_BYTES) == 0);
+    return 0;
+}
+
+static int test_reduce_sweep(dom_kernel_registry* registry)
+{
+    static const u32 types[4] = { DOM_ECS_ELEM_U32, DOM_ECS_ELEM_I32,
+                                  DOM_ECS_ELEM_U64, DOM_ECS_ELEM_I64 };
+    static const u32 counts[6] = { 1u, 7u, 16u, 33u, 130u, 257u };
+    dom_kernel_op_id ops[3];
+    u32 state = 0x5eedu;
+    u32 t;
+    u32 c;
+    u32 o;
+    u32 pad;
+
+    ops[0] = DOM_OP_REDUCE_SUM_INT;
+    ops[1] = DOM_OP_REDUCE_MIN_INT;
+    ops[2] = DOM_OP_REDUCE_MAX_INT;
+    for (t = 0u; t < 4u; ++t) {
+        u32 width = (types[t] == DOM_ECS_ELEM_U32 || types[t] == DOM_ECS_ELEM_I32) ? 4u : 8u;
+        for (pad = 0u; pad <= 4u; pad += 4u) {
+            for (c = 0u; c < 6u; ++c) {
+                u32 stride = width + pad;
+                dom_component_view in_view;
+                dom_component_view out_view;
+                fill_random(g_src, SWEEP_BYTES, &state, 10u);
+                in_view = make_view(types[t], width, stride, counts[c], g_src, DOM_ECS_ACCESS_READ);
+                out_view = make_view(types[t], width, stride, counts[c], 0, DOM_ECS_ACCESS_WRITE);
+                for (o = 0u; o < 3u; ++o) {
+                    u32 begin = (counts[c] > 3u) ? (c % 3u) : 0u;
+                    TEST_CHECK(compare_backends(registry, ops[o], &in_view, out_view, 0, 0u,
+                                                make_range(begin, counts[c]), &state) == 0);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_fill_copy_sweep(dom_kernel_registry* registry)
+{
+    static const u32 sizes[5] = { 1u, 2u, 3u, 4u, 8u };
+    static const u32 counts[5] = { 1u, 5u, 31u, 64u, 301u };
+    u32 state = 0xf111u;
+    u32 s;
+    u32 c;
+    u32 pad;
+
+    for (s = 0u; s < 5u; ++s) {
+        for (pad = 0u; pad <= 3u; pad += 3u) {
+            for (c = 0u; c < 5u; ++c) {
+                u32 stride = sizes[s] + pad;
+                dom_component_view in_view;
+                dom_component_view out_view;
+                dom_kernel_fill_params fill;
+                u32 begin = (counts[c] > 2u) ? 2u : 0u;
+
+                fill_random(g_src, SWEEP_BYTES, &state, 0u);
+                memset(&fill, 0, sizeof(fill));
+                fill.element_size = sizes[s];
+                memcpy(fill.value, g_src, sizes[s]);
+                out_view = make_view(DOM_ECS_ELEM_U8, sizes[s], stride, counts[c], 0,
+                                     DOM_ECS_ACCESS_WRITE);
+                TEST_CHECK(compare_backends(registry, DOM_OP_MEM_FILL_VIEW, 0, out_view,
+                                            &fill, sizeof(fill),
+                                            make_range(begin, counts[c]), &state) == 0);
+
+                in_view = make_view(DOM_ECS_ELEM_U8, sizes[s], stride, counts[c], g_src,
+                                    DOM_ECS_ACCESS_READ);
+                TEST_CHECK(compare_backends(registry, DOM_OP_MEM_COPY_VIEW, &in_view, out_view,
+                                            0, 0u, make_range(begin, counts[c]), &state) == 0);
+            }
+        }
+    }
+    return 0;
+}
+
+static int test_visibility_sweep(dom_kernel_registry* registry)
+{
+    static const u32 types[4] = { DOM_ECS_ELEM_U8, DOM_ECS_ELEM_U16,
+                                  DOM_ECS_ELEM_I32, DOM_ECS_ELEM_U64 };
+    static const u32 widths[4] = { 1u, 2u, 4u, 8u };
+    static const u32 counts[5] = { 3u, 32u, 45u, 100u, 700u };
+    u32 state = 0x7157u;
+    u32 t;
+    u32 c;
+    u32 pad;
+
+    for (t = 0u; t < 4u; ++t) {
+        for (pad = 0u; pad <= 2u; pad += 2u) {
+            for (c = 0u; c < 5u; ++c) {
+                u32 words = (counts[c] + 31u) / 32u;
+                dom_component_view in_view;
+                dom_component_view out_view;
+                dom_kernel_visibility_params params;
+                fill_random(g_src, SWEEP_BYTES, &state, 60u);
+                in_view = make_view(types[t], widths[t], widths[t] + pad, counts[c], g_src,
+                                    DOM_ECS_ACCESS_READ);
+                out_view = make_view(DOM_ECS_ELEM_U32, sizeof(u32), sizeof(u32), words, 0,
+                                     DOM_ECS_ACCESS_WRITE);
+                params.entity_count = counts[c];
+                TEST_CHECK(compare_backends(registry, DOM_OP_BUILD_VISIBILITY_MASK, &in_view,
+                                            out_view, &params, sizeof(params),
+                                            make_range(c, counts[c] - (c & 1u)), &state) == 0);
+            }
+        }
+    }
+    return 0;
+}
+
+static void write_u32_le(unsigned char* bytes, u32 value)
+{
+    bytes[0] = (unsigned char)(value & 0xFFu);
+    bytes[1] = (unsigned char)((value >> 8u) & 0xFFu);
+    bytes[2] = (unsigned char)((value >> 16u) & 0xFFu);
+    bytes[3] = (unsigned char)((value >> 24u) & 0xFFu);
+}
+
+static int test_apply_delta_sweep(dom_kernel_registry* registry)
+{
+    static const u32 counts[5] = { 1u, 9u, 64u, 200u, 513u };
+    static const u32 strides[4] = { 1u, 3u, 4u, 12u };
+    static const u32 densities[3] = { 5u, 50u, 95u };
+    static unsigned char delta[SWEEP_BYTES * 2u];
+    u32 state = 0xde17u;
+    u32 c;
+    u32 s;
+    u32 d;
+
+    for (c = 0u; c < 5u; ++c) {
+        for (s = 0u; s < 4u; ++s) {
+            for (d = 0u; d < 3u; ++d) {
+                u32 entity_count = counts[c];
+                u32 stride = strides[s];
+                u32 mask_bytes = (entity_count + 7u) / 8u;
+                u32 changed = 0u;
+                u32 i;
+                u32 delta_size;
+                u32 total_bytes = entity_count * stride;
+                dom_component_view in_view;
+                dom_component_view out_view;
+                dom_kernel_apply_delta_params params;
+
+                if (total_bytes > SWEEP_BYTES) {
+                    continue;
+                }
+                memset(delta, 0, 24u + mask_bytes);
+                write_u32_le(delta + 16u, entity_count);
+                write_u32_le(delta + 20u, stride);
+                for (i = 0u; i < entity_count; ++i) {
+                    if ((lcg_next(&state) >> 8u) % 100u < densities[d]) {
+                        delta[24u + i / 8u] |= (unsigned char)(1u << (i % 8u));
+                        changed += 1u;
+                    }
+                }
+                delta_size = 24u + mask_bytes + changed * stride;
+                fill_random(delta + 24u + mask_bytes, changed * stride, &state, 0u);
+                fill_random(g_src, SWEEP_BYTES, &state, 0u);
+                params.delta_bytes = delta;
+                params.delta_size = delta_size;
+
+                in_view = make_view(DOM_ECS_ELEM_U8, 1u, 1u, total_bytes, g_src,
+                                    DOM_ECS_ACCESS_READ);
+                out_view = make_view(DOM_ECS_ELEM_U8, 1u, 1u, total_bytes, 0,
+                                     DOM_ECS_ACCESS_WRITE);
+                TEST_CHECK(compare_backends(registry, DOM_OP_APPLY_DELTA_PACKED, &in_view,
+                                            out_view, &params, sizeof(params),
+                                            make_range(0u, entity_count), &state) == 0);
+                TEST_CHECK(compare_backends(registry, DOM_OP_APPLY_DELTA_PACKED, &in_view,
+                                            out_view, &params, sizeof(params),
+                                            make_range(entity_count / 3u, entity_count - entity_count / 4u),
+                                            &state) == 0);
+            }
+        }
+    }
+    return 0;
+}
+
+/* Every detected instruction set gets its own registry so lower tiers stay covered. */
+static int test_all_tiers(const dom_simd_caps* detected)
+{
+    static const u32 tiers[3] = { DOM_SIMD_CAP_AVX2, DOM_SIMD_CAP_SSE2, DOM_SIMD_CAP_NEON };
+    u32 t;
+    for (t = 0u; t < 3u; ++t) {
+        dom_kernel_entry storage[32];
+        dom_kernel_registry registry;
+        dom_simd_caps caps;
+        if ((detected->mask & tiers[t]) == 0u) {
+            continue;
+        }
+        caps.mask = tiers[t];
+        if (dom_simd_kernel_tier(&caps) != tiers[t]) {
+            continue;
+        }
+        dom_kernel_registry_init(&registry, storage, 32u);
+        dom_register_scalar_kernels(&registry);
+        dom_register_simd_kernels(&registry, &caps);
+        if (test_reduce_sweep(&registry) != 0) return 1;
+        if (test_fill_copy_sweep(&registry) != 0) return 1;
+        if (test_visibility_sweep(&registry) != 0) return 1;
+        if (test_apply_delta_sweep(&registry) != 0) return 1;
+    }
+    return 0;
+}
+
 int main(void)
 {
     dom_kernel_entry storage[32];
@@ -300,5 +552,6 @@ int main(void)
     if (test_reduce_sum_equivalence(&registry) != 0) return 1;
     if (test_visibility_mask_equivalence(&registry) != 0) return 1;
     if (test_cross_run_determinism(&registry) != 0) return 1;
+    if (test_all_tiers(&caps) != 0) return 1;
     return 0;
 }
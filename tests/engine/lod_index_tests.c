@@ -0,0 +1,387 @@
+/*
+dg_lod_index tests: query/collect order against the reference flat sorted
+array, chunk bucket churn, apply_batch equivalence and capacity refusals.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "dg_lod_index.h"
+
+#define REF_CAP 2048u
+#define CHUNKS 40u
+#define BATCH_OPS 600u
+#define BATCH_CAP 700u
+
+typedef struct ref_index {
+    dg_lod_index_entry entries[REF_CAP];
+    u32 count;
+} ref_index;
+
+static ref_index g_ref;
+static dg_lod_candidate g_out_a[REF_CAP];
+static dg_lod_candidate g_out_b[REF_CAP];
+static dg_lod_index_op g_ops[BATCH_CAP];
+static u32 g_rng = 0x2545F491u;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static u32 rng_next(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static int cmp_u64(u64 a, u64 b)
+{
+    return (a < b) ? -1 : ((a > b) ? 1 : 0);
+}
+
+static int ref_cmp(dg_chunk_id chunk_id, dg_lod_class_id class_id,
+                   const dg_lod_obj_key* key, const dg_lod_index_entry* e)
+{
+    int c = cmp_u64(chunk_id, e->chunk_id);
+    if (c) return c;
+    c = cmp_u64(class_id, e->class_id);
+    if (c) return c;
+    c = cmp_u64(key->domain_id, e->key.domain_id);
+    if (c) return c;
+    c = cmp_u64(key->entity_id, e->key.entity_id);
+    if (c) return c;
+    return cmp_u64(key->sub_id, e->key.sub_id);
+}
+
+static u32 ref_find(dg_chunk_id chunk_id, dg_lod_class_id class_id, const dg_lod_obj_key* key)
+{
+    u32 i = 0u;
+    while (i < g_ref.count && ref_cmp(chunk_id, class_id, key, &g_ref.entries[i]) > 0) {
+        i += 1u;
+    }
+    return i;
+}
+
+/* The original flat array: presence only, positions come from the index. */
+static void ref_add(dg_chunk_id chunk_id, dg_lod_class_id class_id, const dg_lod_obj_key* key)
+{
+    u32 pos = ref_find(chunk_id, class_id, key);
+    if (pos < g_ref.count && ref_cmp(chunk_id, class_id, key, &g_ref.entries[pos]) == 0) {
+        return;
+    }
+    memmove(&g_ref.entries[pos + 1u], &g_ref.entries[pos],
+            sizeof(dg_lod_index_entry) * (size_t)(g_ref.count - pos));
+    memset(&g_ref.entries[pos], 0, sizeof(dg_lod_index_entry));
+    g_ref.entries[pos].chunk_id = chunk_id;
+    g_ref.entries[pos].class_id = class_id;
+    g_ref.entries[pos].key = *key;
+    g_ref.entries[pos].key.chunk_id = chunk_id;
+    g_ref.count += 1u;
+}
+
+static void ref_remove(dg_chunk_id chunk_id, dg_lod_class_id class_id, const dg_lod_obj_key* key)
+{
+    u32 pos = ref_find(chunk_id, class_id, key);
+    if (pos < g_ref.count && ref_cmp(chunk_id, class_id, key, &g_ref.entries[pos]) == 0) {
+        memmove(&g_ref.entries[pos], &g_ref.entries[pos + 1u],
+                sizeof(dg_lod_index_entry) * (size_t)(g_ref.count - pos - 1u));
+        g_ref.count -= 1u;
+    }
+}
+
+static dg_lod_obj_key random_key(void)
+{
+    dg_lod_obj_key key;
+    memset(&key, 0, sizeof(key));
+    key.domain_id = (dg_domain_id)(1u + rng_next() % 2u);
+    key.entity_id = (dg_entity_id)(1u + rng_next() % 30u);
+    key.sub_id = (u64)(rng_next() % 2u);
+    return key;
+}
+
+static int same_as_ref(const dg_lod_index* idx)
+{
+    static dg_chunk_id chunks[CHUNKS + 2u];
+    u32 chunk_count;
+    u32 i;
+    u32 r = 0u;
+    if (dg_lod_index_count(idx) != g_ref.count) {
+        return 0;
+    }
+    chunk_count = dg_lod_index_collect_chunks(idx, chunks, CHUNKS + 2u);
+    for (i = 0u; i < chunk_count; ++i) {
+        u32 got = dg_lod_index_query(idx, chunks[i], 0u, g_out_a, REF_CAP);
+        u32 j;
+        if (i > 0u && chunks[i - 1u] >= chunks[i]) {
+            return 0;
+        }
+        if (got == 0u) {
+            return 0;
+        }
+        for (j = 0u; j < got; ++j, ++r) {
+            const dg_lod_index_entry* e = &g_ref.entries[r];
+            if (r >= g_ref.count || e->chunk_id != chunks[i] || e->class_id != g_out_a[j].class_id ||
+                ref_cmp(e->chunk_id, e->class_id, &g_out_a[j].key, e) != 0 ||
+                g_out_a[j].key.chunk_id != chunks[i]) {
+                return 0;
+            }
+        }
+    }
+    return r == g_ref.count;
+}
+
+static int test_churn_matches_reference(void)
+{
+    dg_lod_index idx;
+    dg_lod_obj_pos pos;
+    u32 step;
+    int rc = 0;
+    dg_lod_index_init(&idx);
+    if (dg_lod_index_reserve(&idx, REF_CAP) != 0) {
+        return fail("reserve");
+    }
+    g_ref.count = 0u;
+    memset(&pos, 0, sizeof(pos));
+    for (step = 0u; step < 30000u && rc == 0; ++step) {
+        dg_chunk_id chunk_id = (dg_chunk_id)(1u + rng_next() % CHUNKS);
+        dg_lod_class_id class_id = (dg_lod_class_id)(1u + rng_next() % 3u);
+        dg_lod_obj_key key = random_key();
+        /* Bias towards removes once large so chunks empty out and come back. */
+        u32 add_bias = (g_ref.count > 600u) ? 3u : 6u;
+        if (rng_next() % 10u < add_bias) {
+            u32 found = ref_find(chunk_id, class_id, &key);
+            int expect = (found < g_ref.count &&
+                          ref_cmp(chunk_id, class_id, &key, &g_ref.entries[found]) == 0) ? 1 : 0;
+            pos.x = (q16_16)(rng_next() << 4);
+            if (dg_lod_index_add(&idx, chunk_id, &key, &pos, class_id) != expect) {
+                rc = fail("add result");
+            }
+            ref_add(chunk_id, class_id, &key);
+        } else {
+            u32 found;
+            if (g_ref.count > 0u && (rng_next() % 2u) == 0u) {
+                const dg_lod_index_entry* e = &g_ref.entries[rng_next() % g_ref.count];
+                chunk_id = e->chunk_id;
+                class_id = e->class_id;
+                key = e->key;
+            }
+            found = ref_find(chunk_id, class_id, &key);
+            int expect = (found < g_ref.count &&
+                          ref_cmp(chunk_id, class_id, &key, &g_ref.entries[found]) == 0) ? 0 : 1;
+            if (dg_lod_index_remove(&idx, chunk_id, &key, class_id) != expect) {
+                rc = fail("remove result");
+            }
+            ref_remove(chunk_id, class_id, &key);
+        }
+        if (rc == 0 && (step % 211u) == 0u && !same_as_ref(&idx)) {
+            rc = fail("query and chunk order match the flat array");
+        }
+    }
+    if (rc == 0 && !same_as_ref(&idx)) {
+        rc = fail("final state");
+    }
+    if (rc == 0) {
+        /* Class filter returns the matching sub-run only. */
+        dg_chunk_id cid = g_ref.entries[g_ref.count / 2u].chunk_id;
+        u32 all = dg_lod_index_query(&idx, cid, 0u, g_out_a, REF_CAP);
+        u32 c2 = dg_lod_index_query(&idx, cid, 2u, g_out_b, REF_CAP);
+        u32 i;
+        u32 first = all;
+        for (i = 0u; i < all; ++i) {
+            if (g_out_a[i].class_id == 2u && first == all) {
+                first = i;
+            }
+        }
+        if (c2 > 0u && (first + c2 > all ||
+                        memcmp(&g_out_a[first], g_out_b, sizeof(dg_lod_candidate) * c2) != 0)) {
+            rc = fail("class filtered query");
+        }
+        if (dg_lod_index_query(&idx, cid, 0u, g_out_b, 3u) != ((all < 3u) ? all : 3u)) {
+            rc = fail("max_out truncation");
+        }
+    }
+    dg_lod_index_clear(&idx);
+    if (rc == 0 && (dg_lod_index_count(&idx) != 0u ||
+                    dg_lod_index_collect_chunks(&idx, (dg_chunk_id*)g_out_b, 4u) != 0u)) {
+        rc = fail("clear");
+    }
+    dg_lod_index_free(&idx);
+    return rc;
+}
+
+static int op_cmp(const dg_lod_index_op* a, const dg_lod_index_op* b)
+{
+    int c = cmp_u64(a->chunk_id, b->chunk_id);
+    if (c) return c;
+    c = cmp_u64(a->class_id, b->class_id);
+    if (c) return c;
+    c = cmp_u64(a->key.domain_id, b->key.domain_id);
+    if (c) return c;
+    c = cmp_u64(a->key.entity_id, b->key.entity_id);
+    if (c) return c;
+    return cmp_u64(a->key.sub_id, b->key.sub_id);
+}
+
+/* Stable insertion sort keeps same-object ops in generation order. */
+static void sort_ops(dg_lod_index_op* ops, u32 count)
+{
+    u32 i;
+    for (i = 1u; i < count; ++i) {
+        dg_lod_index_op tmp = ops[i];
+        u32 j = i;
+        while (j > 0u && op_cmp(&ops[j - 1u], &tmp) > 0) {
+            ops[j] = ops[j - 1u];
+            j -= 1u;
+        }
+        ops[j] = tmp;
+    }
+}
+
+static int same_index(const dg_lod_index* a, const dg_lod_index* b)
+{
+    static dg_chunk_id ca[CHUNKS + 2u];
+    static dg_chunk_id cb[CHUNKS + 2u];
+    u32 n = dg_lod_index_collect_chunks(a, ca, CHUNKS + 2u);
+    u32 i;
+    if (n != dg_lod_index_collect_chunks(b, cb, CHUNKS + 2u) ||
+        memcmp(ca, cb, sizeof(dg_chunk_id) * n) != 0 ||
+        dg_lod_index_count(a) != dg_lod_index_count(b) ||
+        dg_lod_index_probe_refused(a) != dg_lod_index_probe_refused(b)) {
+        return 0;
+    }
+    for (i = 0u; i < n; ++i) {
+        u32 ga = dg_lod_index_query(a, ca[i], 0u, g_out_a, REF_CAP);
+        u32 gb = dg_lod_index_query(b, ca[i], 0u, g_out_b, REF_CAP);
+        if (ga != gb || memcmp(g_out_a, g_out_b, sizeof(dg_lod_candidate) * ga) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int test_apply_batch(void)
+{
+    dg_lod_index single;
+    dg_lod_index batch;
+    u32 round;
+    u32 refusals = 0u;
+    int rc = 0;
+    dg_lod_index_init(&single);
+    dg_lod_index_init(&batch);
+    /* Tight capacity so later rounds hit refusals. */
+    if (dg_lod_index_reserve(&single, BATCH_CAP) != 0 || dg_lod_index_reserve(&batch, BATCH_CAP) != 0) {
+        return fail("reserve");
+    }
+    for (round = 0u; round < 40u && rc == 0; ++round) {
+        u32 n = 50u + rng_next() % (BATCH_OPS - 50u);
+        u32 i;
+        int got;
+        int expect_refused = 0;
+        for (i = 0u; i < n; ++i) {
+            dg_lod_index_op* op = &g_ops[i];
+            memset(op, 0, sizeof(*op));
+            op->kind = (rng_next() % 10u < 6u) ? DG_LOD_INDEX_OP_ADD : DG_LOD_INDEX_OP_REMOVE;
+            op->chunk_id = (dg_chunk_id)(1u + rng_next() % CHUNKS);
+            op->class_id = (dg_lod_class_id)(1u + rng_next() % 3u);
+            op->key = random_key();
+            if ((rng_next() % 4u) == 0u) {
+                op->key.chunk_id = op->chunk_id;
+            }
+            op->pos.y = (q16_16)(rng_next() << 4);
+        }
+        /* Same object added, removed and re-added inside one batch. */
+        if (n >= 3u) {
+            g_ops[n - 2u] = g_ops[n - 3u];
+            g_ops[n - 2u].kind = DG_LOD_INDEX_OP_REMOVE;
+            g_ops[n - 1u] = g_ops[n - 3u];
+            g_ops[n - 1u].kind = DG_LOD_INDEX_OP_ADD;
+            g_ops[n - 1u].pos.z = (q16_16)(1 << 16);
+        }
+        sort_ops(g_ops, n);
+        for (i = 0u; i < n; ++i) {
+            const dg_lod_index_op* op = &g_ops[i];
+            if (op->kind == DG_LOD_INDEX_OP_ADD) {
+                if (dg_lod_index_add(&single, op->chunk_id, &op->key, &op->pos, op->class_id) == -5) {
+                    expect_refused += 1;
+                }
+            } else {
+                (void)dg_lod_index_remove(&single, op->chunk_id, &op->key, op->class_id);
+            }
+        }
+        got = dg_lod_index_apply_batch(&batch, g_ops, n);
+        if (got != expect_refused) {
+            rc = fail("apply_batch refusal count");
+        } else if (!same_index(&single, &batch)) {
+            rc = fail("apply_batch matches per-op add/remove");
+        }
+        refusals += (u32)expect_refused;
+    }
+    if (rc == 0 && refusals == 0u) {
+        rc = fail("refusal path exercised");
+    }
+    if (rc == 0) {
+        /* Unsorted or invalid lists are rejected without side effects. */
+        u32 before = dg_lod_index_count(&batch);
+        dg_lod_index_op bad[2];
+        memset(bad, 0, sizeof(bad));
+        bad[0].chunk_id = 9u;
+        bad[0].class_id = 1u;
+        bad[1].chunk_id = 3u;
+        bad[1].class_id = 1u;
+        if (dg_lod_index_apply_batch(&batch, bad, 2u) != -7) {
+            rc = fail("unsorted batch rejected");
+        }
+        bad[1].chunk_id = 0u;
+        if (rc == 0 && dg_lod_index_apply_batch(&batch, bad, 2u) != -3) {
+            rc = fail("zero chunk rejected");
+        }
+        bad[1].chunk_id = 9u;
+        bad[1].key.chunk_id = 4u;
+        if (rc == 0 && dg_lod_index_apply_batch(&batch, bad, 2u) != -4) {
+            rc = fail("key chunk mismatch rejected");
+        }
+        if (rc == 0 && dg_lod_index_count(&batch) != before) {
+            rc = fail("rejected batch applies nothing");
+        }
+    }
+    if (rc == 0) {
+        /* A remove-only batch for every object empties every chunk. */
+        static dg_chunk_id chunks[CHUNKS + 2u];
+        u32 n = dg_lod_index_collect_chunks(&batch, chunks, CHUNKS + 2u);
+        u32 total = 0u;
+        u32 i;
+        for (i = 0u; i < n; ++i) {
+            u32 got = dg_lod_index_query(&batch, chunks[i], 0u, g_out_a, REF_CAP);
+            u32 j;
+            for (j = 0u; j < got && total < BATCH_CAP; ++j) {
+                dg_lod_index_op* op = &g_ops[total++];
+                memset(op, 0, sizeof(*op));
+                op->kind = DG_LOD_INDEX_OP_REMOVE;
+                op->chunk_id = chunks[i];
+                op->class_id = g_out_a[j].class_id;
+                op->key = g_out_a[j].key;
+            }
+        }
+        if (dg_lod_index_apply_batch(&batch, g_ops, total) != 0 ||
+            dg_lod_index_count(&batch) != 0u ||
+            dg_lod_index_collect_chunks(&batch, chunks, CHUNKS + 2u) != 0u) {
+            rc = fail("batch remove drops empty chunks");
+        }
+    }
+    dg_lod_index_free(&single);
+    dg_lod_index_free(&batch);
+    return rc;
+}
+
+int main(void)
+{
+    if (test_churn_matches_reference() != 0) {
+        return 1;
+    }
+    if (test_apply_batch() != 0) {
+        return 1;
+    }
+    printf("lod_index tests passed\n");
+    return 0;
+}
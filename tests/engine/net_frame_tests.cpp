@@ -0,0 +1,215 @@
+/*
+Net frame encode/transport tests.
+
+Covers single-pass sizing, gather sends that borrow the payload, flattened
+sends through the pooled buffer, encode-once fan-out and borrowed decodes.
+*/
+#include "d_net_proto.h"
+#include "d_net_transport.h"
+#include "d_net_cmd.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+typedef struct capture_packet {
+    d_peer_id peer;
+    u32 part_count;
+    const unsigned char* tail_ptr;
+    std::vector<unsigned char> bytes;
+} capture_packet;
+
+static std::vector<capture_packet> g_packets;
+static u32 g_broadcasts;
+
+static void capture(d_peer_id peer, const d_net_frame_part* parts, u32 count, u32 total)
+{
+    capture_packet pkt;
+    u32 i;
+    pkt.peer = peer;
+    pkt.part_count = count;
+    pkt.tail_ptr = (count > 1u) ? parts[count - 1u].ptr : 0;
+    for (i = 0u; i < count; ++i) {
+        pkt.bytes.insert(pkt.bytes.end(), parts[i].ptr, parts[i].ptr + parts[i].len);
+    }
+    if (pkt.bytes.size() != total) {
+        pkt.bytes.clear();
+    }
+    g_packets.push_back(pkt);
+}
+
+static int flat_send(void* user, d_peer_id peer, const void* data, u32 size)
+{
+    d_net_frame_part part;
+    (void)user;
+    part.ptr = (const unsigned char*)data;
+    part.len = size;
+    capture(peer, &part, 1u, size);
+    return 0;
+}
+
+static int flat_broadcast(void* user, const void* data, u32 size)
+{
+    g_broadcasts += 1u;
+    return flat_send(user, 0u, data, size);
+}
+
+static int parts_send(void* user, d_peer_id peer, const d_net_frame_part* parts, u32 count, u32 total)
+{
+    (void)user;
+    capture(peer, parts, count, total);
+    return 0;
+}
+
+static int parts_broadcast(void* user, const d_net_frame_part* parts, u32 count, u32 total)
+{
+    (void)user;
+    g_broadcasts += 1u;
+    capture(0u, parts, count, total);
+    return 0;
+}
+
+static void fill_snapshot(d_net_snapshot* snap, std::vector<unsigned char>* storage, u32 len)
+{
+    u32 i;
+    storage->resize(len);
+    for (i = 0u; i < len; ++i) {
+        (*storage)[i] = (unsigned char)(i * 31u + 7u);
+    }
+    snap->tick = 42u;
+    snap->data.ptr = &(*storage)[0];
+    snap->data.len = len;
+}
+
+static int test_single_pass_sizing(void)
+{
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> buf;
+    d_net_snapshot snap;
+    d_net_snapshot back;
+    d_net_frame frame;
+    u32 need = 0u;
+    u32 out_size = 0u;
+
+    fill_snapshot(&snap, &data, 100000u);
+    EXPECT(d_net_frame_snapshot(&snap, &frame) == 0, "frame snapshot");
+    EXPECT(frame.part_count == 2u, "snapshot payload is a separate part");
+    EXPECT(frame.parts[1].ptr == snap.data.ptr, "snapshot payload borrowed");
+
+    buf.resize(64u);
+    EXPECT(d_net_encode_snapshot(&snap, &buf[0], (u32)buf.size(), &need) == -2, "too small");
+    EXPECT(need == frame.size, "required size reported");
+    buf.resize(need);
+    EXPECT(d_net_encode_snapshot(&snap, &buf[0], need, &out_size) == 0, "encode snapshot");
+    EXPECT(out_size == need, "encoded size");
+
+    EXPECT(d_net_decode_snapshot_view(&buf[0], out_size, &back) == 0, "view decode");
+    EXPECT(back.tick == 42u && back.data.len == snap.data.len, "view fields");
+    EXPECT(back.data.ptr > &buf[0] && back.data.ptr < &buf[0] + buf.size(), "view borrows buffer");
+    EXPECT(memcmp(back.data.ptr, snap.data.ptr, snap.data.len) == 0, "view bytes");
+
+    EXPECT(d_net_decode_snapshot(&buf[0], out_size, &back) == 0, "owned decode");
+    EXPECT(back.data.ptr < &buf[0] || back.data.ptr >= &buf[0] + buf.size(), "owned copy");
+    EXPECT(memcmp(back.data.ptr, snap.data.ptr, snap.data.len) == 0, "owned bytes");
+    d_net_snapshot_free(&back);
+    return 0;
+}
+
+static int test_gather_and_flat_sends_match(void)
+{
+    std::vector<unsigned char> data;
+    d_net_snapshot snap;
+    d_net_transport t;
+    const d_peer_id peers[3] = { 4u, 5u, 6u };
+    size_t i;
+
+    fill_snapshot(&snap, &data, 9000u);
+
+    memset(&t, 0, sizeof(t));
+    t.send_to_peer = flat_send;
+    t.broadcast = flat_broadcast;
+    t.send_parts_to_peer = parts_send;
+    t.broadcast_parts = parts_broadcast;
+    EXPECT(d_net_set_transport(&t) == 0, "set gather transport");
+    g_packets.clear();
+    EXPECT(d_net_send_snapshot(2u, &snap) == 0, "gather send");
+    EXPECT(g_packets.size() == 1u && g_packets[0].part_count == 2u, "gather parts");
+    EXPECT(g_packets[0].tail_ptr == snap.data.ptr, "gather payload not copied");
+
+    t.send_parts_to_peer = 0;
+    t.broadcast_parts = 0;
+    EXPECT(d_net_set_transport(&t) == 0, "set flat transport");
+    EXPECT(d_net_send_snapshot(2u, &snap) == 0, "flat send");
+    EXPECT(g_packets.size() == 2u && g_packets[1].part_count == 1u, "flat packet");
+    EXPECT(g_packets[0].bytes == g_packets[1].bytes, "gather and flat bytes match");
+
+    g_packets.clear();
+    EXPECT(d_net_send_snapshot_to_peers(peers, 3u, &snap) == 0, "fan-out");
+    EXPECT(g_packets.size() == 3u, "fan-out count");
+    for (i = 0u; i < g_packets.size(); ++i) {
+        EXPECT(g_packets[i].peer == peers[i], "fan-out peer order");
+        EXPECT(g_packets[i].bytes == g_packets[0].bytes, "fan-out bytes");
+    }
+
+    g_packets.clear();
+    g_broadcasts = 0u;
+    EXPECT(d_net_broadcast_snapshot(&snap) == 0, "broadcast");
+    EXPECT(g_broadcasts == 1u && g_packets.size() == 1u, "broadcast once");
+
+    EXPECT(d_net_set_transport(0) != 0, "reset transport");
+    EXPECT(d_net_send_snapshot(2u, &snap) != 0, "send without transport");
+    return 0;
+}
+
+static int test_cmd_receive_borrows(void)
+{
+    unsigned char payload[40];
+    unsigned char buf[256];
+    d_net_cmd cmd;
+    d_net_cmd view;
+    d_net_cmd out[4];
+    u32 out_size = 0u;
+    u32 count = 0u;
+    u32 i;
+
+    for (i = 0u; i < sizeof(payload); ++i) {
+        payload[i] = (unsigned char)(0xA0u + i);
+    }
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.id = 7u;
+    cmd.source_peer = 3u;
+    cmd.tick = 11u;
+    cmd.schema_id = 2u;
+    cmd.schema_ver = 1u;
+    cmd.payload.ptr = payload;
+    cmd.payload.len = (u32)sizeof(payload);
+    EXPECT(d_net_encode_cmd(&cmd, buf, (u32)sizeof(buf), &out_size) == 0, "encode cmd");
+    EXPECT(d_net_decode_cmd_view(buf, out_size, &view) == 0, "decode cmd view");
+    EXPECT(view.payload.ptr >= buf && view.payload.ptr < buf + out_size, "cmd view borrows");
+    EXPECT(view.id == 7u && view.tick == 11u && view.schema_ver == 1u, "cmd view fields");
+
+    EXPECT(d_net_cmd_queue_init() == 0, "queue init");
+    EXPECT(d_net_receive_packet(1u, 3u, buf, out_size) == 0, "receive cmd");
+    memset(buf, 0, sizeof(buf));
+    EXPECT(d_net_cmd_dequeue_for_tick(11u, out, 4u, &count) == 0 && count == 1u, "dequeue");
+    EXPECT(out[0].payload.len == sizeof(payload), "queued payload len");
+    EXPECT(memcmp(out[0].payload.ptr, payload, sizeof(payload)) == 0, "queued payload owned");
+    d_net_cmd_free(&out[0]);
+    d_net_cmd_queue_shutdown();
+    return 0;
+}
+
+int main(void)
+{
+    if (test_single_pass_sizing() != 0) return 1;
+    if (test_gather_and_flat_sends_match() != 0) return 1;
+    if (test_cmd_receive_borrows() != 0) return 1;
+    return 0;
+}
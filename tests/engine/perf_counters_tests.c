@@ -0,0 +1,255 @@
+/*
+dsys_perf tests: per-thread counter merge, timer histograms, registered
+metrics, counter block reuse across worker threads and the streaming sample
+sink.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "domino/system/dsys_perf.h"
+#include "thread_pool.h"
+
+#define WORKER_TASKS 16u
+#define WORKER_ADDS 1000u
+#define RECYCLE_POOLS 40u /* one worker each, more than there are blocks */
+
+static dsys_perf_metric g_rows_metric;
+static dsys_perf_metric g_job_metric;
+static u32 g_sink_lines = 0u;
+static u32 g_sink_bad = 0u;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static void worker_task(void* user)
+{
+    u32 task = (u32)(size_t)user;
+    u32 i;
+    for (i = 0u; i < WORKER_ADDS; ++i) {
+        dsys_perf_metric_add(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_HITS, 1u);
+        dsys_perf_timer_record(DSYS_PERF_LANE_MESO, g_job_metric, (u64)(i + 1u));
+    }
+    dsys_perf_metric_max(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_INTEREST_SET_SIZE, (u64)task * 10u);
+    dsys_perf_metric_add(DSYS_PERF_LANE_MESO, g_rows_metric, (u64)task);
+}
+
+static int test_single_thread_semantics(void)
+{
+    dsys_perf_reset();
+    dsys_perf_tick_begin(1, 1u);
+    dsys_perf_metric_set(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_STREAM_BYTES, 5u);
+    dsys_perf_metric_add(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_STREAM_BYTES, 2u);
+    dsys_perf_metric_add(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_NET_MSG_SENT, 2u);
+    dsys_perf_metric_set(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_NET_MSG_SENT, 9u);
+    dsys_perf_metric_max(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_EVENT_QUEUE_DEPTH, 3u);
+    dsys_perf_metric_max(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_EVENT_QUEUE_DEPTH, 1u);
+    dsys_perf_tick_end();
+    if (dsys_perf_metric_last(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_STREAM_BYTES) != 7u ||
+        dsys_perf_metric_last(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_NET_MSG_SENT) != 9u ||
+        dsys_perf_metric_last(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_EVENT_QUEUE_DEPTH) != 3u) {
+        return fail("set/add/max within one tick");
+    }
+    dsys_perf_tick_begin(2, 2u);
+    dsys_perf_tick_end();
+    if (dsys_perf_metric_last(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_STREAM_BYTES) != 0u ||
+        dsys_perf_metric_max_seen(DSYS_PERF_LANE_LOCAL, DSYS_PERF_METRIC_STREAM_BYTES) != 7u) {
+        return fail("counters reset per tick, max persists");
+    }
+    return 0;
+}
+
+static int test_registration(void)
+{
+    dsys_perf_metric again;
+    dsys_perf_metric builtin;
+    dsys_perf_metric m;
+    char name[32];
+    u32 i;
+    int rc = 0;
+    if (dsys_perf_metric_register("bench_rows", 0u, &g_rows_metric) != 0 ||
+        dsys_perf_metric_register("bench_job_us", DSYS_PERF_METRIC_FLAG_TIMER, &g_job_metric) != 0) {
+        return fail("register");
+    }
+    if ((u32)g_rows_metric < DSYS_PERF_METRIC_COUNT || g_rows_metric == g_job_metric ||
+        strcmp(dsys_perf_metric_name(g_job_metric), "bench_job_us") != 0) {
+        return fail("registered ids and names");
+    }
+    if (dsys_perf_metric_register("bench_rows", 0u, &again) != 0 || again != g_rows_metric ||
+        dsys_perf_metric_register("stream_bytes", 0u, &builtin) != 0 ||
+        builtin != DSYS_PERF_METRIC_STREAM_BYTES) {
+        return fail("re-registering returns the existing id");
+    }
+    if (dsys_perf_metric_register("", 0u, &m) != -1) {
+        return fail("empty name rejected");
+    }
+    for (i = 0u; rc == 0; ++i) {
+        sprintf(name, "filler_%u", i);
+        rc = dsys_perf_metric_register(name, 0u, &m);
+    }
+    if (rc != -2 || dsys_perf_metric_total() != DSYS_PERF_METRIC_CAPACITY) {
+        return fail("table fills up");
+    }
+    return 0;
+}
+
+static int test_worker_threads(void)
+{
+    dom_thread_pool pool;
+    u32 i;
+    u64 p50;
+    u64 p99;
+    u64 p999;
+    if (dom_thread_pool_init(&pool, 4u, 64u) != D_TRUE) {
+        return fail("pool init");
+    }
+    dsys_perf_reset();
+    dsys_perf_tick_begin(10, 10u);
+    for (i = 0u; i < WORKER_TASKS; ++i) {
+        dom_thread_pool_task task;
+        task.task_id = (u64)i;
+        task.fn = worker_task;
+        task.user_data = (void*)(size_t)(i + 1u);
+        if (dom_thread_pool_submit(&pool, &task) != D_TRUE) {
+            worker_task(task.user_data);
+        }
+    }
+    dom_thread_pool_wait(&pool);
+    dsys_perf_tick_end();
+    dom_thread_pool_shutdown(&pool);
+
+    if (dsys_perf_metric_last(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_DOMAIN_CACHE_HITS) !=
+        (u64)WORKER_TASKS * WORKER_ADDS) {
+        return fail("adds from every worker merge");
+    }
+    if (dsys_perf_metric_last(DSYS_PERF_LANE_MESO, DSYS_PERF_METRIC_INTEREST_SET_SIZE) != (u64)WORKER_TASKS * 10u) {
+        return fail("max merges across workers");
+    }
+    if (dsys_perf_metric_last(DSYS_PERF_LANE_MESO, g_rows_metric) !=
+        (u64)WORKER_TASKS * (WORKER_TASKS + 1u) / 2u) {
+        return fail("registered metric merges");
+    }
+    if (dsys_perf_timer_count(DSYS_PERF_LANE_MESO, g_job_metric) != (u64)WORKER_TASKS * WORKER_ADDS ||
+        dsys_perf_timer_count(DSYS_PERF_LANE_LOCAL, g_job_metric) != 0u ||
+        dsys_perf_timer_count(DSYS_PERF_LANE_MESO, g_rows_metric) != 0u) {
+        return fail("histogram counts per lane and timer metric");
+    }
+    /* Uniform 1..1000: buckets are at most 1/8 wide. */
+    p50 = dsys_perf_timer_percentile(DSYS_PERF_LANE_MESO, g_job_metric, 500000u);
+    p99 = dsys_perf_timer_percentile(DSYS_PERF_LANE_MESO, g_job_metric, 990000u);
+    p999 = dsys_perf_timer_percentile(DSYS_PERF_LANE_MESO, g_job_metric, 999000u);
+    if (p50 < 500u || p50 > 500u + 500u / 8u || p99 < 990u || p99 > 990u + 990u / 8u ||
+        p999 < 999u || p999 > 999u + 999u / 8u || p50 > p99 || p99 > p999) {
+        fprintf(stderr, "p50=%llu p99=%llu p999=%llu\n",
+                (unsigned long long)p50, (unsigned long long)p99, (unsigned long long)p999);
+        return fail("percentiles within bucket width");
+    }
+    if (dsys_perf_timer_percentile(DSYS_PERF_LANE_MESO, g_rows_metric, 500000u) != 0u) {
+        return fail("no percentile without histogram");
+    }
+    return 0;
+}
+
+static void recycle_task(void* user)
+{
+    (void)user;
+    dsys_perf_metric_add(DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_NET_MSG_RECV, 1u);
+}
+
+/* Pools started and shut down in turn hand their blocks on to the next one. */
+static int test_block_recycling(void)
+{
+    u32 round;
+    u32 i;
+    dsys_perf_reset();
+    for (round = 0u; round < RECYCLE_POOLS; ++round) {
+        dom_thread_pool pool;
+        if (dom_thread_pool_init(&pool, 1u, 64u) != D_TRUE) {
+            return fail("pool init");
+        }
+        dsys_perf_tick_begin((dom_act_time_t)round, (u64)round);
+        for (i = 0u; i < WORKER_TASKS; ++i) {
+            dom_thread_pool_task task;
+            task.task_id = (u64)i;
+            task.fn = recycle_task;
+            task.user_data = NULL;
+            if (dom_thread_pool_submit(&pool, &task) != D_TRUE) {
+                recycle_task(NULL);
+            }
+        }
+        dom_thread_pool_wait(&pool);
+        dom_thread_pool_shutdown(&pool);
+        dsys_perf_tick_end();
+        if (dsys_perf_metric_last(DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_NET_MSG_RECV) != (u64)WORKER_TASKS) {
+            return fail("every pool records after earlier workers exit");
+        }
+    }
+    if (dsys_perf_threads_denied() != 0u) {
+        return fail("no thread went without a block");
+    }
+    return 0;
+}
+
+static void count_sink(void* user, const char* line, u32 length)
+{
+    (void)user;
+    if (length == 0u || line[length - 1u] != '\n' || line[0] != '{' || strlen(line) != length) {
+        g_sink_bad += 1u;
+    }
+    g_sink_lines += 1u;
+}
+
+static int test_streaming_sink(void)
+{
+    u32 t;
+    dsys_perf_reset();
+    for (t = 0u; t < 300u; ++t) {
+        dsys_perf_tick_begin((dom_act_time_t)t, (u64)t);
+        dsys_perf_tick_end();
+    }
+    if (dsys_perf_samples_dropped() != 300u - 256u) {
+        return fail("ring without sink keeps the newest samples");
+    }
+    dsys_perf_reset();
+    dsys_perf_set_sink(count_sink, NULL, "perf_counters", "baseline");
+    for (t = 0u; t < 1000u; ++t) {
+        dsys_perf_tick_begin((dom_act_time_t)t, (u64)t);
+        dsys_perf_metric_add(DSYS_PERF_LANE_MACRO, DSYS_PERF_METRIC_MACRO_EVENTS, 1u);
+        dsys_perf_tick_end();
+    }
+    if (g_sink_lines == 0u || g_sink_lines >= 1000u * DSYS_PERF_LANE_COUNT) {
+        return fail("sink streams in batches");
+    }
+    dsys_perf_sink_drain();
+    dsys_perf_set_sink(NULL, NULL, NULL, NULL);
+    if (g_sink_lines != 1000u * DSYS_PERF_LANE_COUNT || g_sink_bad != 0u ||
+        dsys_perf_samples_dropped() != 0u) {
+        return fail("sink receives every sample once");
+    }
+    return 0;
+}
+
+int main(void)
+{
+    dsys_perf_set_enabled(1);
+    if (test_single_thread_semantics() != 0) {
+        return 1;
+    }
+    if (test_registration() != 0) {
+        return 1;
+    }
+    if (test_worker_threads() != 0) {
+        return 1;
+    }
+    if (test_block_recycling() != 0) {
+        return 1;
+    }
+    if (test_streaming_sink() != 0) {
+        return 1;
+    }
+    dsys_perf_set_enabled(0);
+    printf("perf_counters tests passed\n");
+    return 0;
+}
@@ -0,0 +1,376 @@
+/*
+Replay stream tests.
+
+Covers sorted in-memory frame lookup and serialization, streamed recording
+with keyframes, indexed frame lookup, seek-by-keyframe equivalence with a
+straight run, re-indexing a file whose recording was interrupted, and
+(with DOMINIUM_TEST_LARGE_FILES=1) reading chunks that sit past the 2 GiB
+mark of a sparse file, which is a full 2 GiB write on filesystems without
+holes.
+*/
+#include "replay/d_replay.h"
+#include "d_world.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+#define STREAM_TICKS 300u
+#define STREAM_KEYFRAME_INTERVAL 50u
+
+static const char* k_stream_path = "tmp_replay_stream.rpl";
+static const char* k_truncated_path = "tmp_replay_stream_cut.rpl";
+static const char* k_far_path = "tmp_replay_stream_far.rpl";
+
+/* Padding chunk that pushes every recorded chunk past 2^31. */
+#define FAR_PAD_BYTES 0x80000000u
+
+static u8 g_payload[4][8];
+
+static u32 make_inputs(u32 tick, d_net_input_frame* inputs)
+{
+    u32 count = 1u + (tick % 3u);
+    u32 i;
+    for (i = 0u; i < count; ++i) {
+        u32 b;
+        for (b = 0u; b < 8u; ++b) {
+            g_payload[i][b] = (u8)(tick * 7u + i * 13u + b);
+        }
+        inputs[i].tick_index = tick;
+        inputs[i].player_id = i + 1u;
+        inputs[i].payload_size = (tick + i) % 9u;
+        inputs[i].payload = inputs[i].payload_size ? g_payload[i] : (u8*)0;
+    }
+    return count;
+}
+
+/* Stand-in simulation. It touches only state that world images carry (the
+   RNG stream is not part of the image), so a restored keyframe must land on
+   the same checksum as the straight run. */
+static int step_world(void* user, d_world* w, const dreplay_frame* frame)
+{
+    const u32 tiles = w->width * w->height;
+    u32 i;
+    (void)user;
+    for (i = 0u; i < frame->input_count; ++i) {
+        const d_net_input_frame* in = &frame->inputs[i];
+        const u32 tile = (in->player_id * 31u + frame->tick_index) % tiles;
+        w->tile_height[tile] += (q24_8)(in->payload_size + (in->payload_size ? in->payload[0] : 0u));
+    }
+    w->tick_count += 1u;
+    return 0;
+}
+
+static int test_context_lookup(void)
+{
+    d_replay_context rec;
+    d_replay_context play;
+    d_net_input_frame inputs[4];
+    d_net_input_frame out[4];
+    d_tlv_blob blob;
+    u32 count;
+    u32 t;
+
+    memset(&rec, 0, sizeof(rec));
+    memset(&play, 0, sizeof(play));
+    EXPECT(d_replay_init_record(&rec, 0u) == 0, "init record");
+    for (t = 0u; t < 200u; t += 2u) {
+        count = make_inputs(t, inputs);
+        EXPECT(d_replay_record_frame(&rec, t, inputs, count) == 0, "record even");
+    }
+    /* Out-of-order and duplicate ticks keep the frames sorted. */
+    count = make_inputs(51u, inputs);
+    EXPECT(d_replay_record_frame(&rec, 51u, inputs, count) == 0, "record odd");
+    count = make_inputs(3u, inputs);
+    EXPECT(d_replay_record_frame(&rec, 100u, inputs, count) == 0, "replace");
+    EXPECT(rec.frame_count == 101u, "frame count");
+    for (t = 1u; t < rec.frame_count; ++t) {
+        EXPECT(rec.frames[t - 1u].tick_index < rec.frames[t].tick_index, "frames sorted");
+    }
+
+    EXPECT(d_replay_serialize(&rec, &blob) == 0, "serialize");
+    EXPECT(d_replay_deserialize(&blob, &play) == 0, "deserialize");
+    free(blob.ptr);
+    EXPECT(play.frame_count == rec.frame_count && play.frames_sorted == 1u, "deserialized");
+
+    count = 4u;
+    EXPECT(d_replay_get_frame(&play, 150u, out, &count) == 0, "seek forward");
+    EXPECT(play.cursor == 77u, "cursor after seek");
+    count = 4u;
+    EXPECT(d_replay_get_frame(&play, 152u, out, &count) == 0, "cursor hit");
+    count = 4u;
+    EXPECT(d_replay_get_frame(&play, 51u, out, &count) == 0, "seek back");
+    EXPECT(count == 1u + (51u % 3u) && out[0].tick_index == 51u, "odd frame inputs");
+    count = 4u;
+    EXPECT(d_replay_get_frame(&play, 100u, out, &count) == 0, "replaced frame");
+    EXPECT(count == 1u && out[0].tick_index == 3u, "replaced inputs");
+    count = 4u;
+    EXPECT(d_replay_get_frame(&play, 53u, out, &count) == -2, "missing tick");
+
+    d_replay_shutdown(&rec);
+    d_replay_shutdown(&play);
+    return 0;
+}
+
+static int record_stream(std::vector<u32>* checksums)
+{
+    d_world_config cfg;
+    d_replay_writer writer;
+    d_net_input_frame inputs[4];
+    dreplay_frame frame;
+    d_world* world;
+    u32 t;
+
+    cfg.seed = 99u;
+    cfg.width = 16u;
+    cfg.height = 16u;
+    world = d_world_create_from_config(&cfg);
+    EXPECT(world != 0, "world create");
+    EXPECT(d_replay_writer_open(&writer, k_stream_path, STREAM_KEYFRAME_INTERVAL) == 0, "writer open");
+    checksums->clear();
+    for (t = 0u; t < STREAM_TICKS; ++t) {
+        /* Tick 13 records no inputs; 77 is skipped entirely. */
+        if (t == 77u) {
+            checksums->push_back(d_world_checksum(world));
+            continue;
+        }
+        frame.tick_index = t;
+        frame.input_count = (t == 13u) ? 0u : make_inputs(t, inputs);
+        frame.inputs = inputs;
+        checksums->push_back(d_world_checksum(world));
+        EXPECT(d_replay_writer_record(&writer, t, inputs, frame.input_count, world) == 0, "record");
+        step_world(0, world, &frame);
+    }
+    EXPECT(d_replay_writer_record(&writer, 10u, inputs, 1u, world) != 0, "tick must increase");
+    EXPECT(writer.keyframe_count == STREAM_TICKS / STREAM_KEYFRAME_INTERVAL, "keyframe count");
+    EXPECT(writer.index_count < writer.frame_count / 4u, "index is sparse");
+    EXPECT(d_replay_writer_close(&writer) == 0, "writer close");
+    d_world_destroy_instance(world);
+    return 0;
+}
+
+static int check_reader(const char* path, const std::vector<u32>& checksums, u32 last_tick)
+{
+    d_replay_reader reader;
+    d_net_input_frame inputs[4];
+    const dreplay_frame* frame;
+    u32 t;
+
+    EXPECT(d_replay_reader_open(&reader, path) == 0, "reader open");
+    EXPECT(reader.keyframe_count > 0u, "keyframes indexed");
+
+    for (t = 0u; t <= last_tick; ++t) {
+        int rc = d_replay_reader_frame(&reader, t, &frame);
+        if (t == 77u) {
+            EXPECT(rc == -2, "skipped tick absent");
+            continue;
+        }
+        EXPECT(rc == 0 && frame->tick_index == t, "frame lookup");
+        if (t == 13u) {
+            EXPECT(frame->input_count == 0u, "empty frame");
+        } else {
+            u32 count = make_inputs(t, inputs);
+            u32 i;
+            EXPECT(frame->input_count == count, "input count");
+            for (i = 0u; i < count; ++i) {
+                EXPECT(frame->inputs[i].player_id == inputs[i].player_id, "input player");
+                EXPECT(frame->inputs[i].payload_size == inputs[i].payload_size, "input size");
+                EXPECT(memcmp(frame->inputs[i].payload, inputs[i].payload,
+                              inputs[i].payload_size) == 0, "input bytes");
+            }
+        }
+    }
+    EXPECT(d_replay_reader_frame(&reader, last_tick + 1u, &frame) == -2, "past end");
+
+    for (t = 0u; t <= last_tick; t += 7u) {
+        d_world* world = 0;
+        u32 key_tick = 0xFFFFFFFFu;
+        EXPECT(d_replay_reader_seek(&reader, t, step_world, 0, &world, &key_tick) == 0, "seek");
+        EXPECT(key_tick <= t && t - key_tick < STREAM_KEYFRAME_INTERVAL, "nearest keyframe");
+        EXPECT(d_world_checksum(world) == checksums[t], "seek matches straight run");
+        d_world_destroy_instance(world);
+    }
+    d_replay_reader_close(&reader);
+    return 0;
+}
+
+/* Copy the stream up to `cut` bytes, as if recording stopped mid-chunk. */
+static long truncate_copy(long cut)
+{
+    std::vector<unsigned char> bytes;
+    FILE* in = fopen(k_stream_path, "rb");
+    FILE* out;
+    long size;
+    if (!in) {
+        return -1;
+    }
+    fseek(in, 0L, SEEK_END);
+    size = ftell(in);
+    fseek(in, 0L, SEEK_SET);
+    bytes.resize((size_t)size);
+    if (fread(&bytes[0], 1u, bytes.size(), in) != bytes.size()) {
+        fclose(in);
+        return -1;
+    }
+    fclose(in);
+    if (cut > size) {
+        cut = size;
+    }
+    out = fopen(k_truncated_path, "wb");
+    if (!out) {
+        return -1;
+    }
+    fwrite(&bytes[0], 1u, (size_t)cut, out);
+    fclose(out);
+    return size;
+}
+
+static int seek_far(FILE* f, u64 offset)
+{
+#if defined(_WIN32)
+    return _fseeki64(f, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET);
+#endif
+}
+
+/* Rewrites the stream with an unknown-tag chunk after the header whose body
+ * is a hole, shifting every offset (index entries and trailer included) by
+ * more than 2 GiB. Without `indexed` the index and trailer are dropped, so
+ * the reader has to scan over the padding chunk. */
+static int write_far_copy(bool indexed)
+{
+    const u64 shift = 8u + (u64)FAR_PAD_BYTES;
+    std::vector<unsigned char> bytes;
+    unsigned char head[8];
+    u64 index_offset;
+    u32 pad_tag = 0u;
+    u32 pad_len = FAR_PAD_BYTES;
+    u32 count;
+    u32 i;
+    FILE* in = fopen(k_stream_path, "rb");
+    FILE* out;
+    long size;
+    EXPECT(in != 0, "open stream");
+    fseek(in, 0L, SEEK_END);
+    size = ftell(in);
+    fseek(in, 0L, SEEK_SET);
+    bytes.resize((size_t)size);
+    EXPECT(fread(&bytes[0], 1u, bytes.size(), in) == bytes.size(), "read stream");
+    fclose(in);
+
+    memcpy(&index_offset, &bytes[bytes.size() - 16u], sizeof(u64));
+    memcpy(&count, &bytes[(size_t)index_offset + 16u], sizeof(u32));
+    for (i = 0u; i < count; ++i) {
+        unsigned char* entry = &bytes[(size_t)index_offset + 24u + (size_t)i * 16u];
+        u64 offset;
+        memcpy(&offset, entry + 8u, sizeof(u64));
+        offset += shift;
+        memcpy(entry + 8u, &offset, sizeof(u64));
+    }
+    index_offset += shift;
+    memcpy(&bytes[bytes.size() - 16u], &index_offset, sizeof(u64));
+    if (!indexed) {
+        bytes.resize((size_t)(index_offset - shift));
+    }
+
+    memcpy(head, &pad_tag, sizeof(u32));
+    memcpy(head + 4u, &pad_len, sizeof(u32));
+    out = fopen(k_far_path, "wb");
+    EXPECT(out != 0, "open far copy");
+    EXPECT(fwrite(&bytes[0], 1u, 16u, out) == 16u, "write header");
+    EXPECT(fwrite(head, 1u, 8u, out) == 8u, "write padding head");
+    EXPECT(seek_far(out, 16u + shift) == 0, "seek past padding");
+    EXPECT(fwrite(&bytes[16], 1u, bytes.size() - 16u, out) == bytes.size() - 16u, "write body");
+    EXPECT(fclose(out) == 0, "close far copy");
+    return 0;
+}
+
+static int check_far_offsets(const std::vector<u32>& checksums)
+{
+    d_replay_reader reader;
+
+    if (write_far_copy(true) != 0) {
+        return 1;
+    }
+    EXPECT(d_replay_reader_open(&reader, k_far_path) == 0, "open far stream");
+    EXPECT(reader.data_end > (u64)FAR_PAD_BYTES, "index loaded past 2 GiB");
+    d_replay_reader_close(&reader);
+    if (check_reader(k_far_path, checksums, STREAM_TICKS - 1u) != 0) {
+        return 1;
+    }
+
+    if (write_far_copy(false) != 0) {
+        return 1;
+    }
+    EXPECT(d_replay_reader_open(&reader, k_far_path) == 0, "open far stream without index");
+    EXPECT(reader.frame_count == STREAM_TICKS - 1u, "scan crosses the padding chunk");
+    EXPECT(reader.data_end > (u64)FAR_PAD_BYTES, "scan ends past 2 GiB");
+    d_replay_reader_close(&reader);
+    if (check_reader(k_far_path, checksums, STREAM_TICKS - 1u) != 0) {
+        return 1;
+    }
+    return 0;
+}
+
+static int test_far_offsets(const std::vector<u32>& checksums)
+{
+    const char* opt = getenv("DOMINIUM_TEST_LARGE_FILES");
+    int rc;
+    if (!opt || !opt[0] || strcmp(opt, "0") == 0) {
+        printf("replay_stream: set DOMINIUM_TEST_LARGE_FILES=1 to read past 2 GiB\n");
+        return 0;
+    }
+    rc = check_far_offsets(checksums);
+    remove(k_far_path);
+    return rc;
+}
+
+static int test_stream(void)
+{
+    std::vector<u32> checksums;
+    d_replay_reader reader;
+    long size;
+    u32 last_tick;
+
+    if (record_stream(&checksums) != 0) {
+        return 1;
+    }
+    if (check_reader(k_stream_path, checksums, STREAM_TICKS - 1u) != 0) {
+        return 1;
+    }
+
+    /* Interrupted recording: no index, trailer or tail of the last chunks. */
+    size = truncate_copy(0x7FFFFFFFL);
+    EXPECT(size > 0, "read stream");
+    size = truncate_copy(size * 2L / 3L + 5L);
+    EXPECT(d_replay_reader_open(&reader, k_truncated_path) == 0, "open truncated");
+    EXPECT(reader.frame_count > 1u && reader.frame_count < STREAM_TICKS - 1u, "recovered frames");
+    last_tick = (reader.frame_count <= 77u) ? reader.frame_count - 1u : reader.frame_count;
+    d_replay_reader_close(&reader);
+    if (check_reader(k_truncated_path, checksums, last_tick) != 0) {
+        return 1;
+    }
+    if (test_far_offsets(checksums) != 0) {
+        return 1;
+    }
+
+    remove(k_stream_path);
+    remove(k_truncated_path);
+    return 0;
+}
+
+int main(void)
+{
+    if (test_context_lookup() != 0) return 1;
+    if (test_stream() != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,291 @@
+/*
+Timing wheel event queue tests: pop order parity with the binary heap.
+*/
+#include "domino/core/dom_time_events.h"
+#include "domino/sim/dg_due_sched.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_CAP 4096u
+#define TEST_OPS 200000u
+
+static dom_time_event g_heap_items[TEST_CAP];
+static dom_time_wheel g_wheel;
+static dom_time_wheel_node g_nodes[TEST_CAP];
+static dom_time_event_id g_live[TEST_CAP];
+static u32 g_live_handle[TEST_CAP];
+static u32 g_live_count = 0u;
+static u32 g_rng = 0x9E3779B9u;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static u32 test_rand(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+/* Mixes events in the past, at the cursor, across every wheel level and
+ * beyond the wheel horizon, with many ties on trigger_time and order_key. */
+static dom_act_time_t test_trigger(dom_act_time_t now)
+{
+    u32 kind = test_rand() % 8u;
+    switch (kind) {
+    case 0u: return now - (dom_act_time_t)(test_rand() % 100u);
+    case 1u: return now;
+    case 2u: return now + (dom_act_time_t)(test_rand() % 64u);
+    case 3u: return now + (dom_act_time_t)(test_rand() % 5000u);
+    case 4u: return now + (dom_act_time_t)(test_rand() % 300000u);
+    case 5u: return now + (dom_act_time_t)(test_rand() % 2000000u) * 1000;
+    case 6u: return now + ((dom_act_time_t)(test_rand() % 16u) << 40);
+    default: return now + (dom_act_time_t)(test_rand() % 4u);
+    }
+}
+
+static int same_event(const dom_time_event* a, const dom_time_event* b)
+{
+    return a->event_id == b->event_id && a->trigger_time == b->trigger_time &&
+           a->order_key == b->order_key && a->payload_id == b->payload_id;
+}
+
+static int test_parity(dom_act_time_t start)
+{
+    dom_time_event_queue heap;
+    dom_time_event_queue wheel;
+    dom_time_event_id_gen ids;
+    dom_act_time_t now = start;
+    dom_time_event a;
+    dom_time_event b;
+    int ra;
+    int rb;
+    u32 op;
+    if (dom_time_event_queue_init(&heap, g_heap_items, TEST_CAP) != DOM_TIME_OK ||
+        dom_time_event_queue_init_wheel(&wheel, &g_wheel, g_nodes, TEST_CAP, start) != DOM_TIME_OK ||
+        dom_time_event_id_init(&ids, 1u) != DOM_TIME_OK) {
+        return fail("init");
+    }
+    g_live_count = 0u;
+    for (op = 0u; op < TEST_OPS; ++op) {
+        u32 kind = test_rand() % 10u;
+        u32 hc;
+        u32 wc;
+        if (kind < 5u && g_live_count < TEST_CAP) {
+            dom_time_event ev;
+            u32 handle;
+            (void)dom_time_event_id_next(&ids, &ev.event_id);
+            ev.trigger_time = test_trigger(now);
+            ev.order_key = (u64)(test_rand() % 7u);
+            ev.payload_id = (u64)op;
+            ra = dom_time_event_schedule(&heap, &ev);
+            rb = dom_time_event_schedule_handle(&wheel, &ev, &handle);
+            if (ra != DOM_TIME_OK || rb != DOM_TIME_OK || handle == DOM_TIME_EVENT_HANDLE_NONE) {
+                return fail("schedule");
+            }
+            g_live[g_live_count] = ev.event_id;
+            g_live_handle[g_live_count] = handle;
+            g_live_count += 1u;
+        } else if (kind < 7u && g_live_count > 0u) {
+            u32 i = test_rand() % g_live_count;
+            ra = dom_time_event_cancel(&heap, g_live[i]);
+            if (kind == 5u) {
+                rb = dom_time_event_cancel(&wheel, g_live[i]);
+            } else {
+                rb = dom_time_event_cancel_handle(&wheel, g_live_handle[i], g_live[i]);
+            }
+            if (ra != rb) {
+                return fail("cancel result");
+            }
+            g_live[i] = g_live[g_live_count - 1u];
+            g_live_handle[i] = g_live_handle[g_live_count - 1u];
+            g_live_count -= 1u;
+        } else if (kind < 9u) {
+            ra = dom_time_event_pop(&heap, &a);
+            rb = dom_time_event_pop(&wheel, &b);
+            if (ra != rb || (ra == DOM_TIME_OK && !same_event(&a, &b))) {
+                return fail("pop order");
+            }
+            if (ra == DOM_TIME_OK) {
+                u32 i;
+                for (i = 0u; i < g_live_count; ++i) {
+                    if (g_live[i] == a.event_id) {
+                        g_live[i] = g_live[g_live_count - 1u];
+                        g_live_handle[i] = g_live_handle[g_live_count - 1u];
+                        g_live_count -= 1u;
+                        break;
+                    }
+                }
+                if (a.trigger_time > now) {
+                    now = a.trigger_time;
+                }
+            }
+        } else {
+            ra = dom_time_event_peek(&heap, &a);
+            rb = dom_time_event_peek(&wheel, &b);
+            if (ra != rb || (ra == DOM_TIME_OK && !same_event(&a, &b))) {
+                return fail("peek");
+            }
+        }
+        (void)dom_time_event_queue_size(&heap, &hc);
+        (void)dom_time_event_queue_size(&wheel, &wc);
+        if (hc != wc || hc != g_live_count) {
+            return fail("queue size");
+        }
+    }
+    if (dom_time_event_cancel(&wheel, 0xFFFFFFFFFFull) != DOM_TIME_NOT_FOUND ||
+        dom_time_event_cancel_handle(&wheel, TEST_CAP + 5u, 0xFFFFFFFFFFull) != DOM_TIME_NOT_FOUND) {
+        return fail("cancel missing id");
+    }
+    while (1) {
+        ra = dom_time_event_pop(&heap, &a);
+        rb = dom_time_event_pop(&wheel, &b);
+        if (ra != rb || (ra == DOM_TIME_OK && !same_event(&a, &b))) {
+            return fail("drain order");
+        }
+        if (ra != DOM_TIME_OK) {
+            break;
+        }
+    }
+    return 0;
+}
+
+static int test_full_and_stale_handle(void)
+{
+    dom_time_event_queue q;
+    dom_time_event ev;
+    u32 handle;
+    u32 reused;
+    u32 i;
+    if (dom_time_event_queue_init_wheel(&q, &g_wheel, g_nodes, 4u, 0) != DOM_TIME_OK) {
+        return fail("init small");
+    }
+    for (i = 0u; i < 4u; ++i) {
+        ev.event_id = (dom_time_event_id)(i + 1u);
+        ev.trigger_time = (dom_act_time_t)(10 - (int)i);
+        ev.order_key = 0u;
+        ev.payload_id = 0u;
+        if (dom_time_event_schedule_handle(&q, &ev, &handle) != DOM_TIME_OK) {
+            return fail("schedule small");
+        }
+    }
+    ev.event_id = 5u;
+    if (dom_time_event_schedule(&q, &ev) != DOM_TIME_FULL) {
+        return fail("full wheel");
+    }
+    /* Handle of event 4 is reused by event 6; the stale handle must not cancel it. */
+    if (dom_time_event_cancel_handle(&q, handle, 4u) != DOM_TIME_OK) {
+        return fail("cancel by handle");
+    }
+    ev.event_id = 6u;
+    if (dom_time_event_schedule_handle(&q, &ev, &reused) != DOM_TIME_OK || reused != handle) {
+        return fail("handle reuse");
+    }
+    if (dom_time_event_cancel_handle(&q, handle, 4u) != DOM_TIME_NOT_FOUND) {
+        return fail("stale handle");
+    }
+    if (dom_time_event_pop(&q, &ev) != DOM_TIME_OK || ev.event_id != 6u) {
+        return fail("stale cancel kept other events");
+    }
+    return 0;
+}
+
+typedef struct test_node {
+    u64 key;
+    dom_act_time_t next_due;
+    u32 period;
+} test_node;
+
+#define DUE_NODES 64u
+
+static test_node g_due_nodes[2][DUE_NODES];
+static u64 g_due_log[2][4096];
+static u32 g_due_log_count[2];
+static u32 g_due_side;
+static dom_time_event g_due_events[DUE_NODES];
+static dg_due_entry g_due_entries[2][DUE_NODES];
+
+static dom_act_time_t due_next(void* user, dom_act_time_t now_tick)
+{
+    (void)now_tick;
+    return ((test_node*)user)->next_due;
+}
+
+static int due_process(void* user, dom_act_time_t target_tick)
+{
+    test_node* node = (test_node*)user;
+    while (node->next_due <= target_tick) {
+        node->next_due += (dom_act_time_t)node->period;
+    }
+    if (g_due_log_count[g_due_side] < 4096u) {
+        g_due_log[g_due_side][g_due_log_count[g_due_side]++] = node->key;
+    }
+    return 0;
+}
+
+static int test_due_scheduler_parity(void)
+{
+    static const dg_due_vtable vt = { due_next, due_process };
+    dg_due_scheduler scheds[2];
+    dom_act_time_t t;
+    u32 side;
+    u32 i;
+    if (dg_due_scheduler_init(&scheds[0], g_due_events, DUE_NODES, g_due_entries[0], DUE_NODES, 0) != DG_DUE_OK ||
+        dg_due_scheduler_init_wheel(&scheds[1], &g_wheel, g_nodes, DUE_NODES, g_due_entries[1], DUE_NODES, 0) != DG_DUE_OK) {
+        return fail("due init");
+    }
+    for (side = 0u; side < 2u; ++side) {
+        g_due_log_count[side] = 0u;
+        for (i = 0u; i < DUE_NODES; ++i) {
+            test_node* node = &g_due_nodes[side][i];
+            node->key = (u64)((i * 37u) % DUE_NODES);
+            node->period = 1u + (i % 9u);
+            node->next_due = (dom_act_time_t)(i % 5u);
+            if (dg_due_scheduler_register(&scheds[side], &vt, node, node->key, (u32*)0) != DG_DUE_OK) {
+                return fail("due register");
+            }
+        }
+    }
+    for (t = 1; t <= 60; t += 3) {
+        for (side = 0u; side < 2u; ++side) {
+            g_due_side = side;
+            if (t == 31) {
+                (void)dg_due_scheduler_unregister(&scheds[side], 7u);
+                g_due_nodes[side][12].next_due = 100;
+                (void)dg_due_scheduler_refresh(&scheds[side], 12u);
+            }
+            if (dg_due_scheduler_advance(&scheds[side], t) != DG_DUE_OK) {
+                return fail("due advance");
+            }
+        }
+        if (dg_due_scheduler_pending(&scheds[0]) != dg_due_scheduler_pending(&scheds[1])) {
+            return fail("due pending");
+        }
+    }
+    if (g_due_log_count[0] == 0u || g_due_log_count[0] != g_due_log_count[1] ||
+        memcmp(g_due_log[0], g_due_log[1], sizeof(u64) * g_due_log_count[0]) != 0) {
+        return fail("due processing order");
+    }
+    return 0;
+}
+
+int main(void)
+{
+    if (test_parity(0) != 0) {
+        return 1;
+    }
+    if (test_parity(-((dom_act_time_t)1 << 45)) != 0) {
+        return 1;
+    }
+    if (test_full_and_stale_handle() != 0) {
+        return 1;
+    }
+    if (test_due_scheduler_parity() != 0) {
+        return 1;
+    }
+    printf("time_event_wheel tests passed\n");
+    return 0;
+}
@@ -0,0 +1,337 @@
+/*
+dsys_trace tests: disabled cost path, Chrome JSON output, ring wrap,
+per-thread rings, overrun dumps and the due scheduler spans.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "domino/sim/dg_due_sched.h"
+#include "domino/system/dsys_trace.h"
+#include "thread_pool.h"
+
+#define CAPTURE_BYTES (256u * 1024u)
+#define MAIN_RING 64u
+#define WORKER_TASKS 8u
+#define WORKER_SPANS 20u
+#define OVERRUN_PREFIX "trace_span_overrun"
+#define OVERRUN_FAR_TICK 0x100000002ull /* needs all 64 bits in the dump name */
+#define OVERRUN_FAR_PATH OVERRUN_PREFIX "_4294967298.json"
+
+static char g_capture[CAPTURE_BYTES];
+static u32 g_capture_len = 0u;
+static u64 g_clock_ns = 0u;
+static u64 g_clock_step = 0u;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static u64 manual_clock(void* user)
+{
+    u64 now = g_clock_ns;
+    (void)user;
+    g_clock_ns += g_clock_step;
+    return now;
+}
+
+static void capture_write(void* user, const char* data, u32 length)
+{
+    (void)user;
+    if (g_capture_len + length >= CAPTURE_BYTES) {
+        length = CAPTURE_BYTES - 1u - g_capture_len;
+    }
+    memcpy(&g_capture[g_capture_len], data, length);
+    g_capture_len += length;
+    g_capture[g_capture_len] = '\0';
+}
+
+static int capture(void)
+{
+    g_capture_len = 0u;
+    g_capture[0] = '\0';
+    return dsys_trace_write_chrome(capture_write, (void*)0);
+}
+
+static u32 count_of(const char* needle)
+{
+    const char* p = g_capture;
+    u32 count = 0u;
+    size_t len = strlen(needle);
+    while ((p = strstr(p, needle)) != 0) {
+        count += 1u;
+        p += len;
+    }
+    return count;
+}
+
+static int test_disabled(void)
+{
+    DSYS_TRACE_BEGIN("never", 1u);
+    DSYS_TRACE_END("never");
+    dsys_trace_begin("never", 2u);
+    dsys_trace_end("never");
+    if (dsys_trace_is_enabled() || capture() != 0) {
+        return fail("disabled capture");
+    }
+    if (count_of("\"ph\":") != 0u || strstr(g_capture, "\"traceEvents\":[") == 0) {
+        return fail("disabled tracer records nothing");
+    }
+    return 0;
+}
+
+static int test_chrome_output(void)
+{
+    dsys_trace_reset();
+    g_clock_ns = 1000000u;
+    g_clock_step = 1500u;
+    dsys_trace_set_clock(manual_clock, (void*)0);
+    dsys_trace_set_enabled(1);
+    if (dsys_trace_configure(MAIN_RING) != -1) {
+        return fail("configure refused while enabled");
+    }
+    DSYS_TRACE_BEGIN("outer", 7u);
+    DSYS_TRACE_BEGIN("inner", 8u);
+    DSYS_TRACE_END("inner");
+    DSYS_TRACE_END("outer");
+    dsys_trace_set_enabled(0);
+    if (capture() != 0) {
+        return fail("capture");
+    }
+    if (!strstr(g_capture, "{\"name\":\"outer\",\"ph\":\"B\",\"pid\":1,\"tid\":0,\"ts\":0.000,\"args\":{\"arg\":7}}") ||
+        !strstr(g_capture, "{\"name\":\"inner\",\"ph\":\"B\",\"pid\":1,\"tid\":0,\"ts\":1.500,\"args\":{\"arg\":8}}") ||
+        !strstr(g_capture, "{\"name\":\"inner\",\"ph\":\"E\",\"pid\":1,\"tid\":0,\"ts\":3.000}") ||
+        !strstr(g_capture, "{\"name\":\"outer\",\"ph\":\"E\",\"pid\":1,\"tid\":0,\"ts\":4.500}")) {
+        return fail("chrome event layout and relative timestamps");
+    }
+    if (count_of("\"thread_name\"") != 1u || count_of("\"ph\":\"B\"") != 2u) {
+        return fail("one thread with two spans");
+    }
+    return 0;
+}
+
+/* 202 records in a 64 record ring: the oldest kept record is an end whose
+ * begin was overwritten, and the final end closes a begin that was lost. */
+static int test_ring_wrap(void)
+{
+    u32 i;
+    dsys_trace_reset();
+    dsys_trace_set_enabled(1);
+    DSYS_TRACE_BEGIN("lost", 0u);
+    for (i = 0u; i < 100u; ++i) {
+        DSYS_TRACE_BEGIN("pair", i);
+        DSYS_TRACE_END("pair");
+    }
+    DSYS_TRACE_END("lost");
+    dsys_trace_set_enabled(0);
+    if (dsys_trace_dropped() != 202u - MAIN_RING) {
+        return fail("dropped count");
+    }
+    if (capture() != 0) {
+        return fail("capture");
+    }
+    if (count_of("\"ph\":\"B\"") != 31u || count_of("\"ph\":\"E\"") != 31u ||
+        count_of("\"lost\"") != 0u) {
+        return fail("orphaned ends are skipped");
+    }
+    return 0;
+}
+
+static void worker_task(void* user)
+{
+    u32 i;
+    for (i = 0u; i < WORKER_SPANS; ++i) {
+        DSYS_TRACE_BEGIN("worker.job", (u64)(size_t)user);
+        DSYS_TRACE_END("worker.job");
+    }
+}
+
+static int test_worker_threads(void)
+{
+    dom_thread_pool pool;
+    u32 i;
+    int rc = 0;
+    /* The main thread's ring is already claimed; workers get the new size. */
+    if (dsys_trace_configure(4096u) != 0) {
+        return fail("configure");
+    }
+    if (dom_thread_pool_init(&pool, 3u, 64u) != D_TRUE) {
+        return fail("pool init");
+    }
+    dsys_trace_set_clock((dsys_trace_clock_fn)0, (void*)0);
+    dsys_trace_reset();
+    dsys_trace_set_enabled(1);
+    for (i = 0u; i < WORKER_TASKS; ++i) {
+        dom_thread_pool_task task;
+        task.task_id = (u64)i;
+        task.fn = worker_task;
+        task.user_data = (void*)(size_t)i;
+        if (dom_thread_pool_submit(&pool, &task) != D_TRUE) {
+            worker_task(task.user_data);
+        }
+    }
+    dom_thread_pool_wait(&pool);
+    dsys_trace_set_enabled(0);
+    dom_thread_pool_shutdown(&pool);
+    if (capture() != 0) {
+        return fail("capture");
+    }
+    if (count_of("\"worker.job\",\"ph\":\"B\"") != WORKER_TASKS * WORKER_SPANS ||
+        count_of("\"worker.job\",\"ph\":\"E\"") != WORKER_TASKS * WORKER_SPANS) {
+        rc = fail("every worker span is kept");
+    }
+    if (rc == 0 && dsys_trace_dropped() != 0u) {
+        rc = fail("worker rings use the configured size");
+    }
+    return rc;
+}
+
+static int file_exists(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    fclose(fp);
+    return 1;
+}
+
+static int test_overrun_dump(void)
+{
+    u32 i;
+    int dumped;
+    int rc = 0;
+    remove(OVERRUN_PREFIX "_2.json");
+    remove(OVERRUN_PREFIX "_3.json");
+    remove(OVERRUN_FAR_PATH);
+    g_clock_ns = 0u;
+    g_clock_step = 1000u;
+    dsys_trace_set_clock(manual_clock, (void*)0);
+    dsys_trace_reset();
+    dsys_trace_set_overrun_dump(10u, OVERRUN_PREFIX, 2u);
+    dsys_trace_set_enabled(1);
+
+    dsys_trace_tick_begin(1u);
+    dumped = dsys_trace_tick_end();
+    if (dumped != 0) {
+        rc = fail("tick within budget does not dump");
+    }
+    dsys_trace_tick_begin(2u);
+    for (i = 0u; i < 6u; ++i) {
+        DSYS_TRACE_BEGIN("slow", i);
+        DSYS_TRACE_END("slow");
+    }
+    dumped = dsys_trace_tick_end();
+    if (rc == 0 && (dumped != 1 || !file_exists(OVERRUN_PREFIX "_2.json"))) {
+        rc = fail("overrun tick dumps");
+    }
+
+    /* Disabling mid-tick still unwinds the tick, so the next one dumps. */
+    dsys_trace_tick_begin(5u);
+    dsys_trace_set_enabled(0);
+    dumped = dsys_trace_tick_end();
+    dsys_trace_set_enabled(1);
+    if (rc == 0 && dumped != 0) {
+        rc = fail("disabled tick end does not dump");
+    }
+    dsys_trace_tick_begin(OVERRUN_FAR_TICK);
+    for (i = 0u; i < 6u; ++i) {
+        DSYS_TRACE_BEGIN("slow", i);
+        DSYS_TRACE_END("slow");
+    }
+    dumped = dsys_trace_tick_end();
+    if (rc == 0 && (dumped != 1 || !file_exists(OVERRUN_FAR_PATH))) {
+        rc = fail("tick after a disabled tick end is outermost and named by its full index");
+    }
+    dsys_trace_tick_begin(3u);
+    for (i = 0u; i < 6u; ++i) {
+        DSYS_TRACE_BEGIN("slow", i);
+        DSYS_TRACE_END("slow");
+    }
+    dumped = dsys_trace_tick_end();
+    if (rc == 0 && (dumped != 0 || file_exists(OVERRUN_PREFIX "_3.json"))) {
+        rc = fail("dump count is capped");
+    }
+    dsys_trace_set_enabled(0);
+    dsys_trace_set_overrun_dump(0u, (const char*)0, 0u);
+    dsys_trace_set_clock((dsys_trace_clock_fn)0, (void*)0);
+    remove(OVERRUN_PREFIX "_2.json");
+    remove(OVERRUN_FAR_PATH);
+    return rc;
+}
+
+static dom_act_time_t g_due_next = 3;
+
+static dom_act_time_t due_next(void* user, dom_act_time_t now_tick)
+{
+    (void)user;
+    (void)now_tick;
+    return g_due_next;
+}
+
+static int due_process(void* user, dom_act_time_t target_tick)
+{
+    (void)user;
+    (void)target_tick;
+    g_due_next = DG_DUE_TICK_NONE;
+    return 0;
+}
+
+static int test_due_spans(void)
+{
+    static dom_time_event events[8];
+    static dg_due_entry entries[4];
+    dg_due_scheduler sched;
+    dg_due_vtable vt;
+    vt.get_next_due_tick = due_next;
+    vt.process_until = due_process;
+    if (dg_due_scheduler_init(&sched, events, 8u, entries, 4u, 0) != DG_DUE_OK ||
+        dg_due_scheduler_register(&sched, &vt, (void*)0, 42u, (u32*)0) != DG_DUE_OK) {
+        return fail("due init");
+    }
+    dsys_trace_reset();
+    dsys_trace_set_enabled(1);
+    if (dg_due_scheduler_advance(&sched, 5) != DG_DUE_OK) {
+        dsys_trace_set_enabled(0);
+        return fail("due advance");
+    }
+    dsys_trace_set_enabled(0);
+    if (capture() != 0) {
+        return fail("capture");
+    }
+    if (count_of("\"due.advance\",\"ph\":\"B\"") != 1u ||
+        count_of("\"due.advance\",\"ph\":\"E\"") != 1u ||
+        count_of("\"due.process\",\"ph\":\"B\"") != 1u ||
+        !strstr(g_capture, "\"args\":{\"arg\":42}")) {
+        return fail("due scheduler spans");
+    }
+    return 0;
+}
+
+int main(void)
+{
+    if (dsys_trace_configure(MAIN_RING) != 0) {
+        return fail("configure");
+    }
+    if (test_disabled() != 0) {
+        return 1;
+    }
+    if (test_chrome_output() != 0) {
+        return 1;
+    }
+    if (test_ring_wrap() != 0) {
+        return 1;
+    }
+    if (test_worker_threads() != 0) {
+        return 1;
+    }
+    if (test_overrun_dump() != 0) {
+        return 1;
+    }
+    if (test_due_spans() != 0) {
+        return 1;
+    }
+    printf("trace_span tests passed\n");
+    return 0;
+}
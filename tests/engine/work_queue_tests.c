@@ -0,0 +1,296 @@
+/*
+dg_work_queue tests: pop/iteration order against the reference sorted-array
+queue, ring wrap, push_many and merge with capacity refusals.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "dg_work_queue.h"
+
+#define REF_CAP 4096u
+#define BULK_ITEMS 50000u
+
+typedef struct ref_queue {
+    dg_work_item items[REF_CAP];
+    u32 count;
+    u32 capacity;
+    u32 refused;
+} ref_queue;
+
+static ref_queue g_ref;
+static dg_work_item g_bulk[BULK_ITEMS];
+static u32 g_rng = 0x9E3779B9u;
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static u32 rng_next(void)
+{
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+/* Narrow key space so equal keys are common; cost_units tags push order. */
+static dg_work_item make_item(u32 serial)
+{
+    dg_work_item it;
+    memset(&it, 0, sizeof(it));
+    it.key.phase = 1u;
+    it.key.domain_id = (dg_domain_id)(rng_next() % 4u);
+    it.key.chunk_id = (dg_chunk_id)(rng_next() % 3u);
+    it.key.entity_id = (dg_entity_id)(rng_next() % 8u);
+    it.cost_units = serial;
+    it.payload_inline[0] = (unsigned char)(serial & 0xFFu);
+    it.payload_inline_len = 1u;
+    return it;
+}
+
+/* The original insertion-sorted array. */
+static void ref_init(ref_queue* r, u32 capacity)
+{
+    r->count = 0u;
+    r->capacity = capacity;
+    r->refused = 0u;
+}
+
+static int ref_push(ref_queue* r, const dg_work_item* it)
+{
+    u32 lo = 0u;
+    u32 hi = r->count;
+    if (r->count >= r->capacity) {
+        r->refused += 1u;
+        return -3;
+    }
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2u;
+        if (dg_order_key_cmp(&r->items[mid].key, &it->key) <= 0) {
+            lo = mid + 1u;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&r->items[lo + 1u], &r->items[lo], sizeof(dg_work_item) * (size_t)(r->count - lo));
+    r->items[lo] = *it;
+    r->count += 1u;
+    return 0;
+}
+
+static void ref_pop(ref_queue* r)
+{
+    memmove(&r->items[0], &r->items[1], sizeof(dg_work_item) * (size_t)(r->count - 1u));
+    r->count -= 1u;
+}
+
+/* Serials are unique, so key plus serial identifies the exact item. */
+static int same_item(const dg_work_item* a, const dg_work_item* b)
+{
+    return dg_order_key_cmp(&a->key, &b->key) == 0 && a->cost_units == b->cost_units;
+}
+
+static int same_as_ref(const dg_work_queue* q, const ref_queue* r)
+{
+    u32 i;
+    if (dg_work_queue_count(q) != r->count) {
+        return 0;
+    }
+    for (i = 0u; i < r->count; ++i) {
+        const dg_work_item* it = dg_work_queue_at(q, i);
+        if (!it || !same_item(it, &r->items[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int test_push_pop_parity(void)
+{
+    dg_work_queue q;
+    dg_work_item storage[64];
+    u32 step;
+    u32 serial = 0u;
+    dg_work_queue_init(&q);
+    if (dg_work_queue_use_storage(&q, storage, 64u) != 0) {
+        return fail("use_storage");
+    }
+    ref_init(&g_ref, 64u);
+    for (step = 0u; step < 20000u; ++step) {
+        u32 op = rng_next() % 8u;
+        if (op < 5u) {
+            dg_work_item it = make_item(serial++);
+            int a = dg_work_queue_push(&q, &it);
+            int b = ref_push(&g_ref, &it);
+            if (a != b) {
+                return fail("push result");
+            }
+        } else if (g_ref.count > 0u) {
+            dg_work_item out;
+            if (dg_work_queue_pop_next(&q, &out) != D_TRUE ||
+                !same_item(&out, &g_ref.items[0])) {
+                return fail("pop order");
+            }
+            ref_pop(&g_ref);
+        }
+        if ((step % 97u) == 0u && !same_as_ref(&q, &g_ref)) {
+            return fail("iteration order");
+        }
+    }
+    if (!same_as_ref(&q, &g_ref) || dg_work_queue_probe_refused(&q) != g_ref.refused) {
+        return fail("final state");
+    }
+    return 0;
+}
+
+static int test_push_many(void)
+{
+    dg_work_queue q;
+    dg_work_item batch[300];
+    u32 i;
+    u32 round;
+    dg_work_queue_init(&q);
+    if (dg_work_queue_reserve(&q, 1000u) != 0) {
+        return fail("reserve");
+    }
+    ref_init(&g_ref, 1000u);
+    for (round = 0u; round < 6u; ++round) {
+        /* Pop a few first so the ring head is not at zero. */
+        for (i = 0u; i < 37u && g_ref.count > 0u; ++i) {
+            (void)dg_work_queue_pop_next(&q, (dg_work_item*)0);
+            ref_pop(&g_ref);
+        }
+        for (i = 0u; i < 300u; ++i) {
+            batch[i] = make_item(round * 1000u + i);
+        }
+        if (round == 2u) {
+            /* Already sorted input takes the no-sort path. */
+            for (i = 0u; i < 300u; ++i) {
+                batch[i].key.domain_id = (dg_domain_id)(i / 100u);
+                batch[i].key.chunk_id = 0u;
+                batch[i].key.entity_id = 0u;
+            }
+        }
+        for (i = 0u; i < 300u; ++i) {
+            (void)ref_push(&g_ref, &batch[i]);
+        }
+        if (dg_work_queue_push_many(&q, batch, 300u) != ((g_ref.refused != 0u) ? 1 : 0)) {
+            dg_work_queue_free(&q);
+            return fail("push_many result");
+        }
+        if (!same_as_ref(&q, &g_ref) || dg_work_queue_probe_refused(&q) != g_ref.refused) {
+            dg_work_queue_free(&q);
+            return fail("push_many matches single pushes");
+        }
+    }
+    if (g_ref.refused == 0u) {
+        dg_work_queue_free(&q);
+        return fail("refusal path exercised");
+    }
+    dg_work_queue_free(&q);
+    return 0;
+}
+
+static int test_merge(void)
+{
+    dg_work_queue dst;
+    dg_work_queue src;
+    ref_queue* ref_src = &g_ref;
+    static ref_queue ref_dst;
+    u32 i;
+    int rc;
+    dg_work_queue_init(&dst);
+    dg_work_queue_init(&src);
+    if (dg_work_queue_reserve(&dst, 200u) != 0 || dg_work_queue_reserve(&src, 200u) != 0) {
+        return fail("reserve");
+    }
+    ref_init(&ref_dst, 200u);
+    ref_init(ref_src, 200u);
+    for (i = 0u; i < 150u; ++i) {
+        dg_work_item a = make_item(i);
+        dg_work_item b = make_item(1000u + i);
+        (void)dg_work_queue_push(&dst, &a);
+        (void)ref_push(&ref_dst, &a);
+        (void)dg_work_queue_push(&src, &b);
+        (void)ref_push(ref_src, &b);
+    }
+    /* The original merge: push src in order, stop when dst fills. */
+    while (ref_src->count > 0u) {
+        if (ref_push(&ref_dst, &ref_src->items[0]) != 0) {
+            ref_dst.refused += ref_src->count - 1u;
+            break;
+        }
+        ref_pop(ref_src);
+    }
+    rc = dg_work_queue_merge(&dst, &src);
+    if (rc != 1 || !same_as_ref(&dst, &ref_dst) || !same_as_ref(&src, ref_src) ||
+        dg_work_queue_probe_refused(&dst) != ref_dst.refused) {
+        rc = fail("partial merge matches");
+    } else {
+        rc = 0;
+    }
+    if (rc == 0) {
+        while (dg_work_queue_count(&dst) > 100u) {
+            (void)dg_work_queue_pop_next(&dst, (dg_work_item*)0);
+        }
+        if (dg_work_queue_merge(&dst, &src) != 0 || dg_work_queue_count(&src) != 0u ||
+            dg_work_queue_count(&dst) != 200u) {
+            rc = fail("full merge");
+        }
+    }
+    dg_work_queue_free(&dst);
+    dg_work_queue_free(&src);
+    return rc;
+}
+
+static int test_bulk_drain(void)
+{
+    dg_work_queue q;
+    dg_work_item prev;
+    dg_work_item out;
+    u32 i;
+    int rc = 0;
+    dg_work_queue_init(&q);
+    if (dg_work_queue_reserve(&q, BULK_ITEMS) != 0) {
+        return fail("reserve");
+    }
+    for (i = 0u; i < BULK_ITEMS; ++i) {
+        g_bulk[i] = make_item(i);
+        g_bulk[i].key.seq = rng_next();
+    }
+    if (dg_work_queue_push_many(&q, g_bulk, BULK_ITEMS) != 0 ||
+        dg_work_queue_count(&q) != BULK_ITEMS) {
+        rc = fail("bulk push");
+    }
+    for (i = 0u; i < BULK_ITEMS && rc == 0; ++i) {
+        if (dg_work_queue_pop_next(&q, &out) != D_TRUE) {
+            rc = fail("bulk pop");
+        } else if (i > 0u) {
+            int cmp = dg_order_key_cmp(&prev.key, &out.key);
+            if (cmp > 0 || (cmp == 0 && prev.cost_units > out.cost_units)) {
+                rc = fail("bulk drain is sorted and stable");
+            }
+        }
+        prev = out;
+    }
+    dg_work_queue_free(&q);
+    return rc;
+}
+
+int main(void)
+{
+    if (test_push_pop_parity() != 0) {
+        return 1;
+    }
+    if (test_push_many() != 0) {
+        return 1;
+    }
+    if (test_merge() != 0) {
+        return 1;
+    }
+    if (test_bulk_drain() != 0) {
+        return 1;
+    }
+    printf("work_queue tests passed\n");
+    return 0;
+}
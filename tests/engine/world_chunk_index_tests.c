@@ -0,0 +1,223 @@
+/*
+World chunk hash index and neighbor link tests.
+*/
+#include <stdio.h>
+#include <string.h>
+
+#include "d_world.h"
+#include "d_hydro.h"
+#include "d_env_field.h"
+#include "d_res.h"
+
+#define GRID_MIN_X (-5)
+#define GRID_MIN_Y (-3)
+#define GRID_W 10
+#define GRID_H 7
+
+static const i32 k_nbr_dx[D_CHUNK_NBR_COUNT] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+static const i32 k_nbr_dy[D_CHUNK_NBR_COUNT] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+static int fail(const char* msg)
+{
+    fprintf(stderr, "FAIL: %s\n", msg);
+    return 1;
+}
+
+static d_world* make_world(u64 seed)
+{
+    d_world_meta meta;
+    memset(&meta, 0, sizeof(meta));
+    meta.seed = seed;
+    meta.world_size_m = 1024u;
+    meta.vertical_min = d_q16_16_from_int(-2000);
+    meta.vertical_max = d_q16_16_from_int(2000);
+    meta.core_version = 1u;
+    meta.suite_version = 1u;
+    return d_world_create(&meta);
+}
+
+/* Creates the grid in a scrambled order so hash chains and links are built
+ * against partially populated neighborhoods. */
+static int populate(d_world* w)
+{
+    u32 order[GRID_W * GRID_H];
+    u32 rng = 0x2545F491u;
+    u32 i;
+    for (i = 0u; i < GRID_W * GRID_H; ++i) {
+        order[i] = i;
+    }
+    for (i = GRID_W * GRID_H - 1u; i > 0u; --i) {
+        u32 j;
+        u32 t;
+        rng = rng * 1664525u + 1013904223u;
+        j = (rng >> 8) % (i + 1u);
+        t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+    for (i = 0u; i < GRID_W * GRID_H; ++i) {
+        i32 cx = GRID_MIN_X + (i32)(order[i] % GRID_W);
+        i32 cy = GRID_MIN_Y + (i32)(order[i] / GRID_W);
+        d_chunk* c = d_world_get_or_create_chunk(w, cx, cy);
+        if (!c || c->cx != cx || c->cy != cy) {
+            return fail("get_or_create returns requested chunk");
+        }
+        if (d_world_get_or_create_chunk(w, cx, cy) != c) {
+            return fail("get_or_create is idempotent");
+        }
+    }
+    return 0;
+}
+
+static int test_lookup_and_links(void)
+{
+    d_world* w = make_world(7u);
+    u32 i;
+    i32 x;
+    i32 y;
+    if (!w) {
+        return fail("world create");
+    }
+    if (d_world_find_chunk(w, 0, 0) != 0) {
+        d_world_destroy(w);
+        return fail("empty world has no chunks");
+    }
+    if (populate(w) != 0) {
+        d_world_destroy(w);
+        return 1;
+    }
+    if (w->chunk_count != GRID_W * GRID_H) {
+        d_world_destroy(w);
+        return fail("chunk count");
+    }
+    for (y = GRID_MIN_Y - 1; y <= GRID_MIN_Y + GRID_H; ++y) {
+        for (x = GRID_MIN_X - 1; x <= GRID_MIN_X + GRID_W; ++x) {
+            int inside = (x >= GRID_MIN_X && x < GRID_MIN_X + GRID_W &&
+                          y >= GRID_MIN_Y && y < GRID_MIN_Y + GRID_H);
+            d_chunk* c = d_world_find_chunk(w, x, y);
+            if (inside != (c != 0)) {
+                d_world_destroy(w);
+                return fail("find_chunk membership");
+            }
+            if (c && (c->cx != x || c->cy != y)) {
+                d_world_destroy(w);
+                return fail("find_chunk coordinates");
+            }
+        }
+    }
+    for (i = 0u; i < w->chunk_count; ++i) {
+        d_chunk* c = d_world_chunk_at(w, i);
+        u32 dir;
+        if (!c || d_world_chunk_index(w, c) != i) {
+            d_world_destroy(w);
+            return fail("chunk index round trip");
+        }
+        for (dir = 0u; dir < D_CHUNK_NBR_COUNT; ++dir) {
+            d_chunk* expect = d_world_find_chunk(w, c->cx + k_nbr_dx[dir], c->cy + k_nbr_dy[dir]);
+            d_chunk* back;
+            if (d_world_chunk_neighbor(w, c, dir) != expect) {
+                d_world_destroy(w);
+                return fail("neighbor link matches find_chunk");
+            }
+            back = expect ? d_world_chunk_neighbor(w, expect, dir ^ 2u) : 0;
+            if (expect && back != c) {
+                d_world_destroy(w);
+                return fail("opposite link points back");
+            }
+        }
+    }
+    if (d_world_chunk_at(w, w->chunk_count) != 0 ||
+        d_world_chunk_neighbor(w, d_world_chunk_at(w, 0u), D_CHUNK_NBR_COUNT) != 0) {
+        d_world_destroy(w);
+        return fail("out of range lookups");
+    }
+    d_world_destroy(w);
+    return 0;
+}
+
+static int sample_grid(d_world* w)
+{
+    i32 x;
+    i32 y;
+    for (y = GRID_MIN_Y; y < GRID_MIN_Y + GRID_H; ++y) {
+        for (x = GRID_MIN_X; x < GRID_MIN_X + GRID_W; ++x) {
+            q32_32 px = (q32_32)x * ((q32_32)1 << Q32_32_FRAC_BITS);
+            q32_32 py = (q32_32)y * ((q32_32)1 << Q32_32_FRAC_BITS);
+            d_hydro_cell cell;
+            d_env_sample env[4];
+            dres_sample res[4];
+            u16 res_count = 4u;
+            if (d_hydro_sample_at(w, px, py, 0, &cell) != 0) {
+                return fail("hydro sample");
+            }
+            if (d_env_sample_at(w, px, py, 0, env, 4u) == 0u) {
+                return fail("env sample");
+            }
+            if (dres_sample_at(w, px, py, 0, 0u, res, &res_count) != 0) {
+                return fail("res sample");
+            }
+            if (res_count > 0u && res[0].chunk != d_world_find_chunk(w, x, y)) {
+                return fail("res sample chunk");
+            }
+        }
+    }
+    return 0;
+}
+
+/* Subsystem entries must survive chunk table growth and the compaction that
+ * runs when another world instance is reset. */
+static int test_subsystems_across_worlds(void)
+{
+    d_world* a = make_world(11u);
+    d_world* b = make_world(12u);
+    d_world* c;
+    u32 t;
+    int rc = 0;
+    if (!a || !b) {
+        if (a) d_world_destroy(a);
+        if (b) d_world_destroy(b);
+        return fail("world create");
+    }
+    if (populate(a) != 0 || populate(b) != 0) {
+        d_world_destroy(a);
+        d_world_destroy(b);
+        return 1;
+    }
+    for (t = 0u; t < 3u && rc == 0; ++t) {
+        d_hydro_tick(a, 1u);
+        d_env_tick(a, 1u);
+        d_hydro_tick(b, 1u);
+        d_env_tick(b, 1u);
+        rc = sample_grid(a);
+        if (rc == 0) {
+            rc = sample_grid(b);
+        }
+    }
+    d_world_destroy(a);
+    c = make_world(13u);
+    if (rc == 0 && !c) {
+        rc = fail("world create after destroy");
+    }
+    if (rc == 0) {
+        d_hydro_tick(b, 1u);
+        d_env_tick(b, 1u);
+        rc = sample_grid(b);
+    }
+    if (c) {
+        d_world_destroy(c);
+    }
+    d_world_destroy(b);
+    return rc;
+}
+
+int main(void)
+{
+    if (test_lookup_and_links() != 0) {
+        return 1;
+    }
+    if (test_subsystems_across_worlds() != 0) {
+        return 1;
+    }
+    printf("world_chunk_index tests passed\n");
+    return 0;
+}
@@ -0,0 +1,157 @@
+/*
+Incremental checkpoint tests.
+
+Builds a base checkpoint followed by a chain of delta records that share
+unchanged pages, captures one more delta outside the store, then diverges and
+recovers from it: the runtime hash must match the live runtime at capture. A
+corrupted shared page must be refused before recovery touches the runtime.
+*/
+#include "dom_server_runtime.h"
+#include "persistence/dom_checkpointing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+#define CHAIN_SHARDS 4u
+#define CHAIN_CLIENTS 256u
+#define CHAIN_ROUNDS 5u
+
+static void chain_config(dom_server_runtime_config* config)
+{
+    dom_server_runtime_config_default(config);
+    config->shard_count = CHAIN_SHARDS;
+    config->worker_count = 1u;
+    config->max_clients = CHAIN_CLIENTS;
+    config->max_intents = 4096u;
+    config->max_events = 8192u;
+    config->max_messages = 2048u;
+    config->max_idempotency = 2048u;
+    config->default_client_policy.intents_per_tick = 8u;
+    config->default_client_policy.bytes_per_tick = 4096u;
+    config->checkpoint_policy.interval_ticks = 0u;
+    config->checkpoint_policy.base_interval = 8u;
+}
+
+static int populate(dom_server_runtime* runtime)
+{
+    u32 i;
+    for (i = 0u; i < CHAIN_CLIENTS; ++i) {
+        const u64 client_id = 500u + (u64)i;
+        const dom_shard_id shard_id = (dom_shard_id)(1u + (i % CHAIN_SHARDS));
+        EXPECT(dom_server_runtime_add_client(runtime, client_id, shard_id, 0) == 0, "add client");
+    }
+    return 0;
+}
+
+/* Touches a few clients per round so most pages stay unchanged. */
+static int submit_round(dom_server_runtime* runtime, dom_act_time_t tick, u32 round)
+{
+    u32 i;
+    for (i = round; i < CHAIN_CLIENTS; i += 37u) {
+        const dom_shard_id shard_id = (dom_shard_id)(1u + (i % CHAIN_SHARDS));
+        dom_server_intent intent;
+        memset(&intent, 0, sizeof(intent));
+        intent.client_id = 500u + (u64)i;
+        intent.target_shard_id = shard_id;
+        intent.domain_id = runtime->shards[shard_id - 1u].domain_storage[0].domain_id;
+        intent.intent_kind = ((i + round) & 1u) ? DOM_SERVER_INTENT_COLLAPSE : DOM_SERVER_INTENT_EXPAND;
+        intent.detail_code = round;
+        intent.payload_bytes = 8u;
+        intent.idempotency_key = ((u64)(round + 1u) << 32u) | i;
+        intent.intent_tick = tick;
+        EXPECT(dom_server_runtime_submit_intent(runtime, &intent, 8u) == 0, "submit intent");
+    }
+    return 0;
+}
+
+/* Rounds of intents and ticks, each followed by a manual checkpoint. */
+static int run_chain(dom_server_runtime* runtime)
+{
+    const dom_checkpoint_record* record;
+    u32 chain = 0u;
+    u32 round;
+    for (round = 0u; round < CHAIN_ROUNDS; ++round) {
+        const dom_act_time_t tick = (dom_act_time_t)(2u * (round + 1u));
+        u64 live_hash;
+        EXPECT(submit_round(runtime, runtime->now_tick, round) == 0, "round");
+        EXPECT(dom_server_runtime_tick(runtime, tick) == 0, "tick");
+        live_hash = dom_server_runtime_hash(runtime);
+        EXPECT(dom_server_runtime_checkpoint(runtime, DOM_CHECKPOINT_TRIGGER_MANUAL) == 0, "checkpoint");
+        record = dom_server_runtime_last_checkpoint(runtime);
+        EXPECT(record != 0, "checkpoint record");
+        EXPECT(record->manifest.runtime_hash == live_hash, "manifest holds the live hash");
+        EXPECT(record->manifest.chain_length > chain, "chain grows");
+        EXPECT(record->manifest.pages_shared > 0u, "delta shares pages");
+        chain = record->manifest.chain_length;
+    }
+    return 0;
+}
+
+/* The tip is captured without storing it, so the store, checkpoint counters
+ * and event log (all part of the runtime hash) stay as they were. */
+static int test_recover_from_delta_chain(void)
+{
+    dom_server_runtime_config config;
+    dom_server_runtime* runtime = (dom_server_runtime*)calloc(1u, sizeof(*runtime));
+    dom_checkpoint_record* tip = (dom_checkpoint_record*)calloc(1u, sizeof(*tip));
+    const dom_checkpoint_record* record = tip;
+    dom_checkpoint_page* shared;
+    u64 live_hash;
+    u32 refusal = DOM_SERVER_REFUSE_NONE;
+    unsigned char saved;
+
+    EXPECT(runtime && tip, "alloc runtime");
+    chain_config(&config);
+    EXPECT(dom_server_runtime_init(runtime, &config) == 0, "init runtime");
+    EXPECT(populate(runtime) == 0, "populate");
+    EXPECT(run_chain(runtime) == 0, "chain");
+
+    EXPECT(submit_round(runtime, runtime->now_tick, CHAIN_ROUNDS) == 0, "tip round");
+    EXPECT(dom_server_runtime_tick(runtime, runtime->now_tick + 2) == 0, "tip tick");
+    live_hash = dom_server_runtime_hash(runtime);
+    EXPECT(dom_checkpoint_capture(tip, runtime, DOM_CHECKPOINT_TRIGGER_MANUAL) == 0, "capture tip");
+    EXPECT(tip->manifest.runtime_hash == live_hash, "tip holds the live hash");
+    EXPECT(tip->manifest.chain_length > CHAIN_ROUNDS, "tip extends the chain");
+    EXPECT(tip->manifest.base_checkpoint_id != tip->manifest.checkpoint_id, "tip is a delta");
+    EXPECT(tip->manifest.pages_shared > 0u, "tip shares pages");
+    EXPECT(dom_server_runtime_hash(runtime) == live_hash, "capture leaves the runtime untouched");
+
+    /* Diverge, then roll back to the newest delta. */
+    EXPECT(submit_round(runtime, runtime->now_tick, CHAIN_ROUNDS + 1u) == 0, "diverge");
+    EXPECT(dom_server_runtime_tick(runtime, runtime->now_tick + 3) == 0, "diverge tick");
+    EXPECT(dom_server_runtime_hash(runtime) != live_hash, "runtime diverged");
+    EXPECT(dom_checkpoint_recover(runtime, record, &refusal) == 0, "recover delta");
+    EXPECT(refusal == DOM_SERVER_REFUSE_NONE, "recover refusal");
+    EXPECT(dom_server_runtime_hash(runtime) == live_hash, "recovered hash matches live");
+
+    /* A page shared with the base is verified like any other. */
+    EXPECT(record->owners.page_count > 0u, "owner pages");
+    shared = record->owners.pages[0];
+    EXPECT(shared->refs > 1u, "owner page is shared along the chain");
+    saved = shared->data[0];
+    shared->data[0] = (unsigned char)(saved ^ 0xFFu);
+    EXPECT(dom_checkpoint_recover(runtime, record, &refusal) != 0, "corrupt page refused");
+    EXPECT(refusal != DOM_SERVER_REFUSE_NONE, "corrupt page refusal code");
+    shared->data[0] = saved;
+    EXPECT(dom_server_runtime_hash(runtime) == live_hash, "refused recovery left runtime intact");
+
+    dom_checkpoint_record_dispose(tip);
+    free(tip);
+    dom_server_runtime_dispose(runtime);
+    free(runtime);
+    return 0;
+}
+
+int main(void)
+{
+    if (test_recover_from_delta_chain() != 0) return 1;
+    return 0;
+}
@@ -0,0 +1,183 @@
+/*
+Server runtime capacity tests (MMO1).
+
+Runs the authoritative runtime with storage far beyond the defaults and checks
+client/owner lookups, capacity refusals and checkpoint recovery stay intact.
+*/
+#include "dom_server_runtime.h"
+#include "persistence/dom_checkpointing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPECT(cond, msg) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL: %s\n", msg); \
+        return 1; \
+    } \
+} while (0)
+
+#define CAP_SHARDS 16u
+#define CAP_CLIENTS 4096u
+
+static void capacity_config(dom_server_runtime_config* config)
+{
+    dom_server_runtime_config_default(config);
+    config->shard_count = CAP_SHARDS;
+    config->worker_count = 1u;
+    config->max_clients = CAP_CLIENTS;
+    config->max_intents = 8192u;
+    config->max_events = 65536u;
+    config->max_domain_owners = 256u;
+    config->max_messages = 4096u;
+    config->max_idempotency = 4096u;
+    config->domains_per_shard = 64u;
+    config->deferred_limit = 1024u;
+    config->default_client_policy.intents_per_tick = 8u;
+    config->default_client_policy.bytes_per_tick = 4096u;
+    config->checkpoint_policy.interval_ticks = 0u;
+}
+
+/* Simulation state only; checkpoint counters and the event log are excluded. */
+static u64 state_hash(const dom_server_runtime* runtime)
+{
+    u64 hash = 1469598103934665603ULL;
+    u32 i;
+    u32 d;
+    hash = (hash ^ (u64)runtime->now_tick) * 1099511628211ULL;
+    hash = (hash ^ runtime->message_sequence) * 1099511628211ULL;
+    hash = (hash ^ runtime->intent_count) * 1099511628211ULL;
+    for (i = 0u; i < runtime->owner_count; ++i) {
+        hash = (hash ^ runtime->owners[i].domain_id) * 1099511628211ULL;
+        hash = (hash ^ runtime->owners[i].owner_shard_id) * 1099511628211ULL;
+    }
+    for (i = 0u; i < runtime->shard_count; ++i) {
+        const dom_server_shard* shard = &runtime->shards[i];
+        for (d = 0u; d < shard->scale_ctx.domain_count; ++d) {
+            hash = (hash ^ dom_scale_domain_hash(&shard->scale_ctx.domains[d],
+                                                 runtime->now_tick, 1u)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+static int populate(dom_server_runtime* runtime)
+{
+    u32 i;
+    for (i = 0u; i < CAP_CLIENTS; ++i) {
+        const u64 client_id = 1000u + (u64)i * 7u;
+        const dom_shard_id shard_id = (dom_shard_id)(1u + (i % CAP_SHARDS));
+        EXPECT(dom_server_runtime_add_client(runtime, client_id, shard_id, 0) == 0, "add client");
+    }
+    return 0;
+}
+
+static int submit_round(dom_server_runtime* runtime, dom_act_time_t tick, u32 salt)
+{
+    u32 i;
+    for (i = 0u; i < CAP_CLIENTS; i += 3u) {
+        const dom_shard_id shard_id = (dom_shard_id)(1u + (i % CAP_SHARDS));
+        dom_server_intent intent;
+        memset(&intent, 0, sizeof(intent));
+        intent.client_id = 1000u + (u64)i * 7u;
+        intent.target_shard_id = shard_id;
+        intent.domain_id = runtime->shards[shard_id - 1u].domain_storage[0].domain_id;
+        intent.intent_kind = ((i + salt) & 1u) ? DOM_SERVER_INTENT_COLLAPSE : DOM_SERVER_INTENT_EXPAND;
+        intent.detail_code = salt;
+        intent.payload_bytes = 8u;
+        intent.idempotency_key = ((u64)salt << 32u) | i;
+        intent.intent_tick = tick;
+        EXPECT(dom_server_runtime_submit_intent(runtime, &intent, 8u) == 0, "submit intent");
+    }
+    return 0;
+}
+
+static int test_large_capacities(void)
+{
+    dom_server_runtime_config config;
+    dom_server_runtime* runtime = (dom_server_runtime*)calloc(1u, sizeof(*runtime));
+    dom_server_runtime* twin = (dom_server_runtime*)calloc(1u, sizeof(*twin));
+    dom_server_budget_state budget;
+    const dom_checkpoint_record* record;
+    u32 refusal = DOM_SERVER_REFUSE_NONE;
+    u32 i;
+
+    EXPECT(runtime && twin, "alloc runtimes");
+    capacity_config(&config);
+    EXPECT(dom_server_runtime_init(runtime, &config) == 0, "init runtime");
+    EXPECT(dom_server_runtime_init(twin, &config) == 0, "init twin");
+    EXPECT(runtime->shard_count == CAP_SHARDS, "shard count");
+    EXPECT(runtime->client_capacity == CAP_CLIENTS, "client capacity");
+    EXPECT(runtime->shards[CAP_SHARDS - 1u].domain_capacity == 64u, "domain capacity");
+    EXPECT(runtime->owner_count == CAP_SHARDS * DOM_SERVER_MIN_DOMAINS_PER_SHARD, "built-in owners");
+
+    EXPECT(populate(runtime) == 0, "populate runtime");
+    EXPECT(populate(twin) == 0, "populate twin");
+    EXPECT(dom_server_runtime_add_client(runtime, 1000u, 1u, 0) == -3, "duplicate client");
+    EXPECT(dom_server_runtime_add_client(runtime, 1u, 1u, 0) == -4, "client capacity");
+    for (i = 0u; i < CAP_CLIENTS; i += 97u) {
+        EXPECT(dom_server_runtime_budget_snapshot(runtime, 1000u + (u64)i * 7u, &budget) == 0,
+               "client lookup");
+    }
+    EXPECT(dom_server_runtime_budget_snapshot(runtime, 999u, &budget) != 0, "unknown client");
+
+    EXPECT(submit_round(runtime, 0, 1u) == 0, "round 1");
+    EXPECT(submit_round(twin, 0, 1u) == 0, "twin round 1");
+    EXPECT(dom_server_runtime_tick(runtime, 2) == 0, "tick");
+    EXPECT(dom_server_runtime_tick(twin, 2) == 0, "twin tick");
+    EXPECT(dom_server_runtime_hash(runtime) == dom_server_runtime_hash(twin), "twin hash");
+
+    EXPECT(dom_server_runtime_checkpoint(runtime, DOM_CHECKPOINT_TRIGGER_MANUAL) == 0, "checkpoint");
+    record = dom_server_runtime_last_checkpoint(runtime);
+    EXPECT(record != 0, "checkpoint record");
+    EXPECT(record->manifest.shard_count == CAP_SHARDS, "record shard count");
+    EXPECT(dom_server_runtime_checkpoint(twin, DOM_CHECKPOINT_TRIGGER_MANUAL) == 0, "twin checkpoint");
+
+    EXPECT(submit_round(runtime, 2, 2u) == 0, "round 2");
+    EXPECT(dom_server_runtime_tick(runtime, 5) == 0, "tick 2");
+    EXPECT(dom_server_runtime_recover_last(runtime, &refusal) == 0, "recover");
+    EXPECT(refusal == DOM_SERVER_REFUSE_NONE, "recover refusal");
+    EXPECT(runtime->now_tick == 2, "recover tick");
+    EXPECT(state_hash(runtime) == state_hash(twin), "recovered state");
+
+    /* Indexes are rebuilt: lookups and duplicate detection still hold. */
+    EXPECT(dom_server_runtime_budget_snapshot(runtime, 1000u + 7u * 4095u, &budget) == 0,
+           "client lookup after recover");
+    EXPECT(dom_server_runtime_add_client(runtime, 1007u, 2u, 0) == -3, "duplicate after recover");
+    EXPECT(submit_round(runtime, 2, 2u) == 0, "round after recover");
+
+    dom_server_runtime_dispose(runtime);
+    dom_server_runtime_dispose(twin);
+    free(runtime);
+    free(twin);
+    return 0;
+}
+
+static int test_defaults_match_legacy_limits(void)
+{
+    dom_server_runtime_config config;
+    dom_server_runtime* runtime = (dom_server_runtime*)calloc(1u, sizeof(*runtime));
+    EXPECT(runtime != 0, "alloc runtime");
+    dom_server_runtime_config_default(&config);
+    config.shard_count = 2u;
+    EXPECT(dom_server_runtime_init(runtime, &config) == 0, "init runtime");
+    EXPECT(runtime->client_capacity == DOM_SERVER_DEFAULT_CLIENTS, "default clients");
+    EXPECT(runtime->intent_capacity == DOM_SERVER_DEFAULT_INTENTS, "default intents");
+    EXPECT(runtime->event_capacity == DOM_SERVER_DEFAULT_EVENTS, "default events");
+    EXPECT(runtime->owner_capacity == DOM_SERVER_DEFAULT_DOMAIN_OWNERS, "default owners");
+    EXPECT(runtime->shards[0].domain_capacity == DOM_SERVER_DEFAULT_DOMAINS_PER_SHARD,
+           "default domains");
+    dom_server_runtime_dispose(runtime);
+    EXPECT(runtime->arena == 0 && runtime->shards == 0, "dispose clears runtime");
+    dom_server_runtime_dispose(runtime);
+    free(runtime);
+    return 0;
+}
+
+int main(void)
+{
+    if (test_defaults_match_legacy_limits() != 0) return 1;
+    if (test_large_capacities() != 0) return 1;
+    return 0;
+}
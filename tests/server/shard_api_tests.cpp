@@ -118,6 +118,32 @@ static int test_message_ordering(void)
     return 0;
 }
 
+static int test_message_equal_key_order(void)
+{
+    dom_shard_message_queue queue;
+    dom_shard_message storage[8];
+    dom_shard_message msg;
+    dom_shard_message out;
+    u32 i;
+
+    dom_shard_message_queue_init(&queue, storage, 8u);
+    memset(&msg, 0, sizeof(msg));
+    msg.source_shard = 1u;
+    msg.target_shard = 2u;
+    msg.arrival_tick = 7u;
+    msg.message_id = 4u;
+    for (i = 0u; i < 6u; ++i) {
+        msg.task_id = 100u + i;
+        EXPECT(dom_shard_message_queue_push(&queue, &msg) == 0, "push equal key");
+    }
+    for (i = 0u; i < 6u; ++i) {
+        EXPECT(dom_shard_message_queue_pop_ready(&queue, 7u, &out) == 0, "pop equal key");
+        EXPECT(out.task_id == 100u + i, "equal keys must pop in push order");
+    }
+    EXPECT(dom_shard_message_queue_pop_ready(&queue, 7u, &out) != 0, "queue drained");
+    return 0;
+}
+
 static int test_cross_shard_read_refusal(void)
 {
     dom_shard_registry registry;
@@ -192,6 +218,7 @@ int main(void)
 {
     if (test_deterministic_placement() != 0) return 1;
     if (test_message_ordering() != 0) return 1;
+    if (test_message_equal_key_order() != 0) return 1;
     if (test_cross_shard_read_refusal() != 0) return 1;
     if (test_replay_reconstruction() != 0) return 1;
     return 0;
@@ -247,14 +247,18 @@ static int mmo_run_two_node(u32 workers)
     b = (dom_server_runtime*)calloc(1u, sizeof(*b));
     if (!a || !b) {
         fprintf(stderr, "mmo: failed to allocate runtimes\n");
+        dom_server_runtime_dispose(a);
         free(a);
+        dom_server_runtime_dispose(b);
         free(b);
         return 2;
     }
     if (dom_server_runtime_init(a, &config) != 0 ||
         dom_server_runtime_init(b, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtimes\n");
+        dom_server_runtime_dispose(a);
         free(a);
+        dom_server_runtime_dispose(b);
         free(b);
         return 2;
     }
@@ -300,7 +304,9 @@ static int mmo_run_two_node(u32 workers)
            (unsigned int)b->event_count,
            (unsigned int)refusals_a,
            (unsigned int)refusals_b);
+    dom_server_runtime_dispose(a);
     free(a);
+    dom_server_runtime_dispose(b);
     free(b);
     return (hash_a == hash_b) ? 0 : 1;
 }
@@ -323,6 +329,7 @@ static int mmo_run_join_resync(u32 workers)
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 2;
     }
@@ -352,6 +359,7 @@ static int mmo_run_join_resync(u32 workers)
            (unsigned int)(hash_after == resync_bundle.world_hash ? 1u : 0u),
            (unsigned int)resync_bundle.event_tail_index,
            (unsigned int)resync_bundle.message_tail_index);
+    dom_server_runtime_dispose(runtime);
     free(runtime);
     return (hash_after == resync_bundle.world_hash) ? 0 : 1;
 }
@@ -374,6 +382,7 @@ static int mmo_run_abuse(u32 workers)
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 2;
     }
@@ -406,6 +415,7 @@ static int mmo_run_abuse(u32 workers)
            (unsigned int)scale_snapshot.macro_event_used,
            (unsigned int)scale_snapshot.macro_event_limit,
            (unsigned int)scale_snapshot.deferred_count);
+    dom_server_runtime_dispose(runtime);
     free(runtime);
     return (refusal_rate > 0u) ? 0 : 1;
 }
@@ -428,6 +438,7 @@ static int mmo_run_legacy(u32 workers)
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 2;
     }
@@ -455,6 +466,7 @@ static int mmo_run_legacy(u32 workers)
     printf("legacy.resync_refusal=%s legacy.world_hash=%llu\n",
            dom_server_refusal_to_string(resync_bundle.refusal_code),
            (unsigned long long)resync_bundle.world_hash);
+    dom_server_runtime_dispose(runtime);
     free(runtime);
     return (refusal_cap > 0u && resync_bundle.refusal_code != 0u) ? 0 : 1;
 }
@@ -478,6 +490,7 @@ static int mmo_run_ops_checkpoint(u32 workers)
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 2;
     }
@@ -493,12 +506,14 @@ static int mmo_run_ops_checkpoint(u32 workers)
 
     if (dom_server_runtime_checkpoint(runtime, DOM_CHECKPOINT_TRIGGER_MANUAL) != 0) {
         fprintf(stderr, "mmo: checkpoint refused\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 1;
     }
     record = dom_server_runtime_last_checkpoint(runtime);
     if (!record) {
         fprintf(stderr, "mmo: no checkpoint record\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 1;
     }
@@ -531,6 +546,7 @@ static int mmo_run_ops_checkpoint(u32 workers)
                (unsigned long long)shard->shard_hash,
                (unsigned long long)shard->world_checksum);
     }
+    dom_server_runtime_dispose(runtime);
     free(runtime);
     return 0;
 }
@@ -554,13 +570,17 @@ static int mmo_run_ops_recover(u32 workers)
     shadow = (dom_server_runtime*)calloc(1u, sizeof(*shadow));
     if (!runtime || !shadow) {
         fprintf(stderr, "mmo: failed to allocate runtimes\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
+        dom_server_runtime_dispose(shadow);
         free(shadow);
         return 2;
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
+        dom_server_runtime_dispose(shadow);
         free(shadow);
         return 2;
     }
@@ -569,18 +589,33 @@ static int mmo_run_ops_recover(u32 workers)
 
     (void)mmo_submit_intent(runtime, 901u, 1u, domain_id, DOM_SERVER_INTENT_COLLAPSE, 41u, 0u, 8u, 9101u, 0);
     (void)mmo_submit_intent(runtime, 901u, 1u, domain_id, DOM_SERVER_INTENT_EXPAND, 42u, 0u, 8u, 9102u, 1);
+    (void)dom_server_runtime_tick(runtime, 1);
+
+    /* Base first, so the checkpoint recovered below is an incremental one. */
+    if (dom_server_runtime_checkpoint(runtime, DOM_CHECKPOINT_TRIGGER_MANUAL) != 0) {
+        fprintf(stderr, "mmo: checkpoint refused\n");
+        dom_server_runtime_dispose(runtime);
+        free(runtime);
+        dom_server_runtime_dispose(shadow);
+        free(shadow);
+        return 1;
+    }
     (void)dom_server_runtime_tick(runtime, 3);
 
     if (dom_server_runtime_checkpoint(runtime, DOM_CHECKPOINT_TRIGGER_MANUAL) != 0) {
         fprintf(stderr, "mmo: checkpoint refused\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
+        dom_server_runtime_dispose(shadow);
         free(shadow);
         return 1;
     }
     record = dom_server_runtime_last_checkpoint(runtime);
     if (!record) {
         fprintf(stderr, "mmo: no checkpoint record\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
+        dom_server_runtime_dispose(shadow);
         free(shadow);
         return 1;
     }
@@ -595,7 +630,9 @@ static int mmo_run_ops_recover(u32 workers)
 
     if (dom_server_runtime_init(shadow, &config) != 0) {
         fprintf(stderr, "mmo: failed to init shadow runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
+        dom_server_runtime_dispose(shadow);
         free(shadow);
         return 2;
     }
@@ -615,6 +652,10 @@ static int mmo_run_ops_recover(u32 workers)
            (long long)runtime->now_tick,
            dom_server_refusal_to_string(refusal),
            dom_server_refusal_to_string(refusal_shadow));
+    printf("recover.chain_length=%u recover.pages_written=%u recover.pages_shared=%u\n",
+           (unsigned int)record->manifest.chain_length,
+           (unsigned int)record->manifest.pages_written,
+           (unsigned int)record->manifest.pages_shared);
     {
         const dom_act_time_t runtime_tick = runtime->now_tick;
         const dom_act_time_t checkpoint_tick = record->manifest.tick;
@@ -623,7 +664,9 @@ static int mmo_run_ops_recover(u32 workers)
                         runtime_tick == checkpoint_tick &&
                         state_hash_after == state_hash_shadow &&
                         state_hash_after == state_hash_checkpoint) ? 0 : 1;
+        dom_server_runtime_dispose(runtime);
         free(runtime);
+        dom_server_runtime_dispose(shadow);
         free(shadow);
         return ok;
     }
@@ -646,6 +689,7 @@ static int mmo_run_ops_shards(u32 workers)
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 2;
     }
@@ -686,6 +730,8 @@ static int mmo_run_ops_shards(u32 workers)
            (unsigned long long)runtime->shards[1].capability_mask,
            (unsigned long long)runtime->shards[1].baseline_hash);
 
+    dom_server_runtime_dispose(runtime);
+
     free(runtime);
     return (refusal_gap > 0u && owner_after == 2u) ? 0 : 1;
 }
@@ -707,6 +753,7 @@ static int mmo_run_ops_log(u32 workers)
     }
     if (dom_server_runtime_init(runtime, &config) != 0) {
         fprintf(stderr, "mmo: failed to init runtime\n");
+        dom_server_runtime_dispose(runtime);
         free(runtime);
         return 2;
     }
@@ -739,6 +786,8 @@ static int mmo_run_ops_log(u32 workers)
            (unsigned int)owner_after,
            (unsigned long long)runtime->message_applied);
 
+    dom_server_runtime_dispose(runtime);
+
     free(runtime);
     return (message_before > 0u && message_after == 0u && owner_after == 2u) ? 0 : 1;
 }